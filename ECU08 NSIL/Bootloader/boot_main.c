@@ -0,0 +1,218 @@
+/**
+  ******************************************************************************
+  * @file    boot_main.c
+  * @brief   ECU08 CAN-FD bootloader (flash sector 0).
+  *
+  * Starts the application in sectors 1-5 unless
+  *  - the application asked for an update (UDS programming session left
+  *    FWU_BOOT_MAGIC at FWU_BOOT_FLAG_ADDR before resetting), or
+  *  - there is no valid image (erased, or an update was interrupted).
+  * Otherwise it serves the fwu.h protocol on FDCAN3 (dashboard bus) in FD
+  * mode with bit-rate switching, 500 kbit/s arbitration / 2 Mbit/s data,
+  * polling: no RTOS, no interrupts.
+  *
+  * Build: a second image from this file, Core/Src/fwu.c, Core/Src/sha256.c,
+  * Core/Src/fdcan.c (MSP only), the HAL and the CMSIS startup, linked with
+  * Bootloader/STM32H733ZGTX_BOOT.ld. Flashed once with the debugger; from
+  * then on the application goes through ecu08_fwu.
+  ******************************************************************************
+  */
+
+#include "main.h"
+#include "fdcan.h"
+#include "fwu.h"
+
+/* FDCAN kernel clock: HSE, 24 MHz (HAL_FDCAN_MspInit) */
+#define BOOT_NOM_PRESCALER   6u    /* 24 MHz / 6 / (1 + 2 + 5) = 500 kbit/s */
+#define BOOT_NOM_SEG1        2u
+#define BOOT_NOM_SEG2        5u
+#define BOOT_DATA_PRESCALER  1u    /* 24 MHz / 1 / (1 + 8 + 3) = 2 Mbit/s   */
+#define BOOT_DATA_SEG1       8u
+#define BOOT_DATA_SEG2       3u
+#define BOOT_RX_FIFO_ELMTS   64u   /* ≥ the update window, in 64-byte frames */
+#define BOOT_TX_FIFO_ELMTS   16u
+
+static void boot_clock(void);
+static void boot_can(void);
+static int  boot_tx(uint32_t id, const uint8_t *data, uint8_t len);
+static uint32_t boot_now_us(void);
+static void boot_jump(void) __attribute__((noreturn));
+
+int main(void)
+{
+  volatile uint32_t *flag = (volatile uint32_t *)FWU_BOOT_FLAG_ADDR;
+  const uint8_t requested = (*flag == FWU_BOOT_MAGIC);
+  *flag = 0u;
+
+  if (!requested && Fwu_AppValid()) boot_jump();
+
+  HAL_Init();
+  boot_clock();
+  boot_can();
+  Fwu_Init(boot_tx);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0u;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  for (;;)
+  {
+    FDCAN_RxHeaderTypeDef h;
+    uint8_t d[FWU_FRAME_MAX];
+    while (HAL_FDCAN_GetRxFifoFillLevel(&hfdcan3, FDCAN_RX_FIFO0) > 0u &&
+           HAL_FDCAN_GetRxMessage(&hfdcan3, FDCAN_RX_FIFO0, &h, d) == HAL_OK)
+    {
+      if (h.IdType == FDCAN_STANDARD_ID)
+      {
+        (void)Fwu_OnFrame(h.Identifier, d, Fwu_DlcToLen((uint8_t)h.DataLength), boot_now_us());
+      }
+    }
+    Fwu_Poll(boot_now_us());
+
+    if (Fwu_ResetRequested())
+    {
+      /* RESET answered: give the frame time to leave, then start over */
+      const uint32_t t0 = boot_now_us();
+      while (HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan3) < BOOT_TX_FIFO_ELMTS &&
+             boot_now_us() - t0 < 10000u) {}
+      NVIC_SystemReset();
+    }
+  }
+}
+
+/* HSE straight to SYSCLK: enough for a 2 Mbit/s stream, no PLL to bring up */
+static void boot_clock(void)
+{
+  RCC_OscInitTypeDef osc = {0};
+  RCC_ClkInitTypeDef clk = {0};
+
+  HAL_PWREx_ConfigSupply(PWR_LDO_SUPPLY);
+  __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE1);
+  while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY)) {}
+
+  osc.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  osc.HSEState       = RCC_HSE_ON;
+  osc.PLL.PLLState   = RCC_PLL_NONE;
+  if (HAL_RCC_OscConfig(&osc) != HAL_OK) Error_Handler();
+
+  clk.ClockType      = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 |
+                       RCC_CLOCKTYPE_PCLK2 | RCC_CLOCKTYPE_D3PCLK1 | RCC_CLOCKTYPE_D1PCLK1;
+  clk.SYSCLKSource   = RCC_SYSCLKSOURCE_HSE;
+  clk.SYSCLKDivider  = RCC_SYSCLK_DIV1;
+  clk.AHBCLKDivider  = RCC_HCLK_DIV1;
+  clk.APB3CLKDivider = RCC_APB3_DIV1;
+  clk.APB1CLKDivider = RCC_APB1_DIV1;
+  clk.APB2CLKDivider = RCC_APB2_DIV1;
+  clk.APB4CLKDivider = RCC_APB4_DIV1;
+  if (HAL_RCC_ClockConfig(&clk, FLASH_LATENCY_1) != HAL_OK) Error_Handler();
+}
+
+/* FDCAN3 in FD + BRS, only FWU_CMD_ID accepted into FIFO0 */
+static void boot_can(void)
+{
+  hfdcan3.Instance                  = FDCAN3;
+  hfdcan3.Init.FrameFormat          = FDCAN_FRAME_FD_BRS;
+  hfdcan3.Init.Mode                 = FDCAN_MODE_NORMAL;
+  hfdcan3.Init.AutoRetransmission   = ENABLE;
+  hfdcan3.Init.TransmitPause        = DISABLE;
+  hfdcan3.Init.ProtocolException    = DISABLE;
+  hfdcan3.Init.NominalPrescaler     = BOOT_NOM_PRESCALER;
+  hfdcan3.Init.NominalSyncJumpWidth = 1;
+  hfdcan3.Init.NominalTimeSeg1      = BOOT_NOM_SEG1;
+  hfdcan3.Init.NominalTimeSeg2      = BOOT_NOM_SEG2;
+  hfdcan3.Init.DataPrescaler        = BOOT_DATA_PRESCALER;
+  hfdcan3.Init.DataSyncJumpWidth    = BOOT_DATA_SEG2;
+  hfdcan3.Init.DataTimeSeg1         = BOOT_DATA_SEG1;
+  hfdcan3.Init.DataTimeSeg2         = BOOT_DATA_SEG2;
+  hfdcan3.Init.MessageRAMOffset     = 0;
+  hfdcan3.Init.StdFiltersNbr        = 1;
+  hfdcan3.Init.ExtFiltersNbr        = 0;
+  hfdcan3.Init.RxFifo0ElmtsNbr      = BOOT_RX_FIFO_ELMTS;
+  hfdcan3.Init.RxFifo0ElmtSize      = FDCAN_DATA_BYTES_64;
+  hfdcan3.Init.RxFifo1ElmtsNbr      = 0;
+  hfdcan3.Init.RxFifo1ElmtSize      = FDCAN_DATA_BYTES_64;
+  hfdcan3.Init.RxBuffersNbr         = 0;
+  hfdcan3.Init.RxBufferSize         = FDCAN_DATA_BYTES_64;
+  hfdcan3.Init.TxEventsNbr          = 0;
+  hfdcan3.Init.TxBuffersNbr         = 0;
+  hfdcan3.Init.TxFifoQueueElmtsNbr  = BOOT_TX_FIFO_ELMTS;
+  hfdcan3.Init.TxFifoQueueMode      = FDCAN_TX_FIFO_OPERATION;
+  hfdcan3.Init.TxElmtSize           = FDCAN_DATA_BYTES_64;
+  if (HAL_FDCAN_Init(&hfdcan3) != HAL_OK) Error_Handler();
+
+  FDCAN_FilterTypeDef f = {0};
+  f.IdType       = FDCAN_STANDARD_ID;
+  f.FilterIndex  = 0;
+  f.FilterType   = FDCAN_FILTER_MASK;
+  f.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
+  f.FilterID1    = FWU_CMD_ID;
+  f.FilterID2    = 0x7FFu;
+  if (HAL_FDCAN_ConfigFilter(&hfdcan3, &f) != HAL_OK ||
+      HAL_FDCAN_ConfigGlobalFilter(&hfdcan3, FDCAN_REJECT, FDCAN_REJECT,
+                                   FDCAN_REJECT_REMOTE, FDCAN_REJECT_REMOTE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* Transmitter delay compensation, needed in the 2 Mbit/s data phase */
+  if (HAL_FDCAN_ConfigTxDelayCompensation(&hfdcan3, BOOT_DATA_PRESCALER * BOOT_DATA_SEG1, 0u) != HAL_OK ||
+      HAL_FDCAN_EnableTxDelayCompensation(&hfdcan3) != HAL_OK ||
+      HAL_FDCAN_Start(&hfdcan3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+static int boot_tx(uint32_t id, const uint8_t *data, uint8_t len)
+{
+  FDCAN_TxHeaderTypeDef h = {0};
+  h.Identifier          = id;
+  h.IdType              = FDCAN_STANDARD_ID;
+  h.TxFrameType         = FDCAN_DATA_FRAME;
+  h.DataLength          = Fwu_LenToDlc(len);
+  h.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
+  h.BitRateSwitch       = FDCAN_BRS_ON;
+  h.FDFormat            = FDCAN_FD_CAN;
+  h.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
+  h.MessageMarker       = 0;
+  if (HAL_FDCAN_GetTxFifoFreeLevel(&hfdcan3) == 0u) return -1;
+  return (HAL_FDCAN_AddMessageToTxFifoQ(&hfdcan3, &h, (uint8_t *)data) == HAL_OK) ? 0 : -1;
+}
+
+/* Microseconds from the cycle counter, wrapping at 2^32 us like CtrlExec_NowUs */
+static uint32_t boot_now_us(void)
+{
+  static uint32_t last, us, frac;
+  const uint32_t cyc = DWT->CYCCNT;
+  frac += cyc - last;
+  last = cyc;
+  us += frac / (HSE_VALUE / 1000000u);
+  frac %= (HSE_VALUE / 1000000u);
+  return us;
+}
+
+/* Application vector table right after the descriptor */
+static void boot_jump(void)
+{
+  const uint32_t *vt = (const uint32_t *)FWU_IMAGE_BASE;
+  __disable_irq();
+  SysTick->CTRL = 0u;
+  for (uint32_t i = 0; i < 8u; i++)
+  {
+    NVIC->ICER[i] = 0xFFFFFFFFu;
+    NVIC->ICPR[i] = 0xFFFFFFFFu;
+  }
+  SCB->VTOR = FWU_IMAGE_BASE;
+  __DSB();
+  __ISB();
+  __set_MSP(vt[0]);
+  __enable_irq();
+  ((void (*)(void))vt[1])();
+  for (;;) {}
+}
+
+void Error_Handler(void)
+{
+  __disable_irq();
+  for (;;) {}
+}
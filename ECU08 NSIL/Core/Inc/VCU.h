@@ -119,6 +119,9 @@ INT32U RX_SETPOINT_6 = 0x365;
 
 // --------- BMI088 ---------
 
+// IDs CAN de las ECUs: en el firmware son los valores por defecto del mapa
+// de IDs (can_map.c), calibrables sin recompilar (parámetros 0x0Axx)
+
 // IDs CAN Telemetría Generales
 INT32U ID_RTD_all = 0x80;
 
@@ -4,6 +4,77 @@
 #include <stdint.h>
 #include "cmsis_os2.h"
 
+/* Per-inverter feedback, indexed by position in the inverter layout
+ * (inverters.h). The scalar inv_* fields are the aggregate over drives. */
+#define INV_MAX 4u
+
+/* Shared inverter model: the quantities a drive reports, whatever its
+ * protocol (inv_backend.h). A backend fills the ones it has (Inv_FbSet);
+ * the rest keep seen bit 0. At most 16. */
+typedef enum
+{
+  INV_FB_RPM = 0,
+  INV_FB_I_ACTUAL,
+  INV_FB_T_MOTOR,
+  INV_FB_T_IGBT,
+  INV_FB_T_AIR,
+  INV_FB_DC_BUS,
+  INV_FB_TORQUE,
+  INV_FB_TORQUE_MAX,
+  INV_FB_TORQUE_MIN,
+  INV_FB_I_DC,
+  INV_FB_STATE,
+  INV_FB_ERROR,
+  INV_FB_WARNING,
+  INV_FB_DERATE,
+  INV_FB_FAULT_CODE,
+  INV_FB_ALIVE,
+  INV_FB_COUNT
+} inv_fb_field_t;
+
+typedef struct
+{
+  int16_t  rpm;
+  int16_t  i_actual;         /* A, phase current */
+  int16_t  motor_temp;       /* degC */
+  int16_t  igbt_temp;
+  int16_t  air_temp;
+  int16_t  dc_bus_v;         /* V, the drive's own DC link measurement */
+  int16_t  torque_dnm;       /* 0.1 Nm, actual */
+  int16_t  torque_max_dnm;   /* 0.1 Nm, available motoring (drive derating) */
+  int16_t  torque_min_dnm;   /* 0.1 Nm, available regen, <= 0 */
+  int16_t  i_dc;             /* A, DC link current */
+  uint16_t state;            /* drive state code, protocol specific */
+  uint16_t error;            /* error bits */
+  uint16_t warning;          /* warning bits */
+  uint16_t derate_pct;       /* drive's own derating, 100 = none */
+  uint16_t fault_code;       /* first fault latched by the drive */
+  uint16_t alive;            /* drive heartbeat counter */
+  uint8_t  seen;             /* 1 = at least one response decoded */
+  uint16_t fld_seen;         /* bit per inv_fb_field_t */
+  uint32_t rx_tick;          /* osKernelGetTickCount() of the last response */
+  uint32_t fld_tick[INV_FB_COUNT];  /* same, per field */
+} inv_fb_t;
+
+/* Signals written by CanRx_ParseAndUpdate, one freshness slot each
+ * (sig_tick, sig_seen; supervised by freshness.h). Inverter feedback has
+ * its own per-drive link supervision (inverters.h). At most 32. */
+typedef enum
+{
+  SIG_OK_PRECARGA = 0,
+  SIG_DC_BUS_VOLTAGE,
+  SIG_S1_ACELERACION,
+  SIG_S2_ACELERACION,
+  SIG_S_FRENO,
+  SIG_V_CELDA_MIN,
+  SIG_WHEEL_FRONT,
+  SIG_INV_STATE,
+  SIG_ACK_TELEMETRIA,        /* boot handshake acks (handshake.h): events */
+  SIG_ACK_CAJA_NEGRA,
+  SIG_ACK_PANTALLA,
+  SIG_COUNT
+} app_sig_t;
+
 /* Application-wide shared inputs/state (protected by g_inMutex). */
 typedef struct
 {
@@ -12,6 +83,8 @@ typedef struct
   uint16_t s2_aceleracion;   /* ADC raw */
   uint16_t s_freno;          /* ADC raw */
   uint8_t  boton_arranque;   /* 0/1 */
+  uint8_t  dash_input_1;     /* 0/1, DASH_INPUT_1 (launch arm) */
+  uint8_t  dash_input_2;     /* 0/1, DASH_INPUT_2 (launch cancel) */
 
   /* Inverter feedback */
   uint8_t  inv_state;        /* e.g. standby/ready/fault (project-specific) */
@@ -20,6 +93,19 @@ typedef struct
   int16_t  inv_igbt_temp;
   int16_t  inv_air_temp;
   int16_t  inv_rpm;
+  int16_t  inv_i_actual;     /* A, filtered actual current (BAMOCAR I_ACTUAL 0x5F) */
+  inv_fb_t inv[INV_MAX];     /* per drive; inv_rpm etc. above aggregate these */
+
+  /* Wheel speeds (undriven front axle) */
+  uint16_t wheel_fl_cmps;    /* cm/s */
+  uint16_t wheel_fr_cmps;    /* cm/s */
+  uint8_t  wheel_ok;         /* 1 = wheel speed source alive */
+
+  /* IMU (BMI088, latest sample) */
+  int16_t  imu_acc_mg[3];    /* x, y, z in mg */
+  int16_t  imu_gyr_ddps[3];  /* x, y, z in 0.1 deg/s */
+  uint32_t imu_t_us;         /* timestamp of the newest sample */
+  uint8_t  imu_ok;           /* 1 = fresh accel and gyro data */
 
   /* Battery / misc */
   uint16_t v_celda_min;      /* raw / scaled */
@@ -32,6 +118,10 @@ typedef struct
   /* Derived */
   uint16_t torque_total;     /* 0..100% */
 
+  /* Signal freshness */
+  uint32_t sig_tick[SIG_COUNT]; /* osKernelGetTickCount() of the last frame */
+  uint32_t sig_seen;         /* bit per app_sig_t: received at least once */
+
 } app_inputs_t;
 
 extern app_inputs_t g_in;
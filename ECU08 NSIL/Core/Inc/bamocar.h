@@ -0,0 +1,82 @@
+#ifndef BAMOCAR_H
+#define BAMOCAR_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "inverters.h"
+
+/* BAMOCAR D3 register subscriptions and response decode.
+ *
+ *  - BAMO_REGS lists every register the VCU needs from a drive, with its
+ *    transmit period. A READ request [0x3D, REGID, period ms] on the
+ *    drive's rxID makes it send [REGID, value LSB, value MSB] on its txID
+ *    every period from then on, until it resets. Nothing is polled.
+ *  - The subscriptions are armed on the first control step, so the drive
+ *    temperatures and DC link are known during precharge, not only from
+ *    ready-to-drive on.
+ *  - Each register is supervised on its own: one silent for
+ *    BAMO_REARM_PERIODS of its periods, counted from its last response or
+ *    its last request, is requested again. A drive that reset has lost all
+ *    of them and gets them all back this way; a drive that is not powered
+ *    yet is asked again at that pace until it answers. A register whose
+ *    period changed (calibration) is requested again with the new one.
+ *  - Responses are decoded through a 256-entry REGID → register table: one
+ *    load, then a linear scale into the inv_fb_t field, which is stamped
+ *    (fld_seen, fld_tick) for the supervision above. */
+
+#define BAMO_READ            0x3Du
+#define BAMO_REARM_PERIODS   4u
+
+/* Register IDs (VCU.h) */
+#define BAMO_REG_N_ACTUAL    0x30u
+#define BAMO_REG_T_MOTOR     0x49u
+#define BAMO_REG_T_IGBT      0x4Au
+#define BAMO_REG_T_AIR       0x4Bu
+#define BAMO_REG_I_ACTUAL    0x5Fu
+#define BAMO_REG_DC_BUS      0xEBu
+
+/* Period 0: the calibrated data period (control_cfg_t inv_read_period_ms) */
+#define BAMO_PERIOD_DATA     0u
+
+typedef struct
+{
+  uint8_t regid;
+  uint8_t field;           /* inv_fb_field_t                              */
+  uint8_t period_ms;       /* BAMO_PERIOD_DATA or a fixed period, 1..255  */
+  int32_t mul;             /* value = raw * mul / div                     */
+  int32_t div;
+} bamo_reg_t;
+
+#define BAMO_REG_COUNT  6u
+
+extern const bamo_reg_t BAMO_REGS[BAMO_REG_COUNT];
+
+/* Subscription state of one drive (plain data, part of ctrl_ctx_t) */
+typedef struct
+{
+  uint8_t  armed;                       /* bit per BAMO_REGS entry        */
+  uint8_t  period[BAMO_REG_COUNT];      /* period last requested, ms      */
+  uint32_t req_tick[BAMO_REG_COUNT];    /* ms, last request               */
+  uint32_t requests;                    /* READ frames, boot included     */
+  uint32_t rearms;                      /* of which for a silent register */
+} bamo_sub_t;
+
+void     Bamo_SubInit(bamo_sub_t *sub);
+
+/* Writes the READ requests drive nd needs at now_ms into msgs (at most
+ * room frames; the rest wait for the next call). data_period_ms stands for
+ * BAMO_PERIOD_DATA. Returns the number of frames written. */
+uint32_t Bamo_SubService(bamo_sub_t *sub, const inv_node_t *nd, const inv_fb_t *fb,
+                         uint8_t data_period_ms, uint32_t now_ms,
+                         can_msg_t *msgs, uint32_t room);
+
+/* Decodes a response of drive k into the shared model (Inv_FbSet).
+ * Returns the field bit it updated, 0 for a register the VCU did not
+ * subscribe to. */
+uint16_t Bamo_Decode(const can_msg_t *m, app_inputs_t *st, uint8_t k, uint32_t now_ms);
+
+/* Torque command frame of drive nd (one frame, cmd_id). */
+void     Bamo_BuildCmd(const inv_node_t *nd, int16_t torque_pct, can_msg_t *m);
+
+#endif /* BAMOCAR_H */
@@ -0,0 +1,86 @@
+#ifndef BMI088_H
+#define BMI088_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* BMI088 IMU on SPI1 (CS_ACC = PA4, CS_GYR = PA3, ACC INT1 = PE7,
+ * GYR INT3 = PE8). Both sensors buffer in their FIFOs (stream mode, so a
+ * late read drops the oldest samples) and raise a watermark interrupt. The
+ * EXTI ISR only queues a burst; the burst itself is two DMA transfers,
+ * FIFO length then FIFO data, chained from the SPI completion callback.
+ * The CPU touches the bus once per burst, never per byte, and no task ever
+ * waits on SPI after Bmi088_Init().
+ *
+ * Samples are timestamped backwards from the length read at the sensor
+ * ODR and pushed to a single-producer/single-consumer ring, which the
+ * control task drains every cycle through Bmi088_Fill(); the latest pair
+ * is also published lock-free (sequence counter) for freshness. Accel: 1600 Hz, +-6 g. Gyro: 2000 Hz (closest ODR to
+ * 1.6 kHz), +-2000 dps. */
+
+#ifndef BMI088_ENABLE
+#define BMI088_ENABLE          1
+#endif
+
+#define BMI088_ACC_ODR_HZ      1600u
+#define BMI088_GYR_ODR_HZ      2000u
+#define BMI088_ACC_WTM_FRAMES  8u      /* 5 ms per burst               */
+#define BMI088_GYR_WTM_FRAMES  10u     /* 5 ms per burst               */
+#define BMI088_RING_LEN        64u     /* samples, power of two        */
+#define BMI088_STALE_US        20000u  /* imu_ok drops after this      */
+
+/* Raw LSB to published units */
+#define BMI088_ACC_FS_MG       6000    /* +-6 g                        */
+#define BMI088_GYR_FS_DDPS     20000   /* +-2000 dps, in 0.1 dps       */
+
+typedef enum
+{
+  BMI088_ACC = 0,
+  BMI088_GYR
+} bmi088_sensor_t;
+
+typedef struct
+{
+  uint32_t t_us;       /* CtrlExec_NowUs() timebase                   */
+  int16_t  xyz[3];     /* raw LSB                                     */
+  uint8_t  sensor;     /* bmi088_sensor_t                             */
+} bmi088_sample_t;
+
+typedef struct
+{
+  uint32_t acc_samples;
+  uint32_t gyr_samples;
+  uint32_t bursts;
+  uint32_t ring_drops;     /* consumer too slow                       */
+  uint32_t fifo_overruns;  /* gyro FIFO overrun flag seen             */
+  uint32_t spi_errors;
+} bmi088_stats_t;
+
+/* Resets state; on target also probes both chip IDs and writes the FIFO,
+ * range, ODR and interrupt configuration (blocking, task context, before
+ * the loop). Returns 0 on success, -1 if a chip ID does not match. */
+int      Bmi088_Init(void);
+
+/* Hooks: EXTI (HAL_GPIO_EXTI_Callback) and SPI1 DMA completion / error. */
+void     Bmi088_ExtiIsr(uint16_t pin);
+void     Bmi088_SpiDoneIsr(void);
+void     Bmi088_SpiErrorIsr(void);
+
+/* FIFO decoders, called with the DMA buffer (data after the address and
+ * dummy bytes). t_last_us stamps the newest frame. Return frames taken. */
+uint32_t Bmi088_ParseAccFifo(const uint8_t *buf, uint32_t len, uint32_t t_last_us);
+uint32_t Bmi088_ParseGyrFifo(const uint8_t *buf, uint32_t frames, uint32_t t_last_us);
+
+/* Single consumer: pops up to max samples in arrival order. On target
+ * Bmi088_Fill() is that consumer; do not call both. */
+uint32_t Bmi088_ReadSamples(bmi088_sample_t *dst, uint32_t max);
+
+/* Accel/gyro into a control snapshot: drains the ring and publishes the
+ * per-sensor mean of the samples since the previous call, or holds the
+ * latest pair if none arrived. imu_t_us is the newest sample, imu_ok =
+ * both sensors fresh. */
+void     Bmi088_Fill(app_inputs_t *in, uint32_t now_us);
+
+void     Bmi088_GetStats(bmi088_stats_t *out);
+
+#endif /* BMI088_H */
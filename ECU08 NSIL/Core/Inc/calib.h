@@ -0,0 +1,132 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+#include <stdint.h>
+#include "control.h"
+#include "can_map.h"
+
+/* Calibration store: every tunable the car is set up with at the track,
+ * changeable without a rebuild.
+ *
+ *  - calib_data_t is the RAM image; CALIB_PARAMS[] describes its fields
+ *    (ID, type, range) for typed get/set by ID.
+ *  - Two RAM banks, A/B. Writers stage edits, Calib_Commit() copies the
+ *    stage into the idle bank and flips the live index. The control task
+ *    calls Calib_Acquire() once per cycle and applies a new sequence
+ *    number between cycles, so it never locks and never sees half an edit.
+ *  - Persistence: two flash sectors (6 and 7, 128 KB each), written
+ *    alternately. A slot holds (ID, type, value) records behind a header
+ *    with magic, format version, write counter and CRC-32; the header is
+ *    programmed last. On boot the newest valid slot wins and a torn write
+ *    falls back to the other one. Records are matched by ID, so a new
+ *    firmware keeps the old calibration for every parameter it still has.
+ *  - SIL: the two sectors live in a file (Calib_SilSetFlashFile).
+ *
+ * Writers (Set/Commit/Save...) are serialised by a mutex; Calib_Save()
+ * erases a sector (blocking, ~1 s) and must not run in the control task:
+ * Calib_RequestSave() defers it to Calib_Service() in the diag task. The
+ * erase stalls the whole core (single flash bank), so Calib_Save() refuses
+ * while the car is running (Control_IsRunning), for every caller. */
+
+#define CALIB_FORMAT_VERSION   1u
+#define CALIB_SLOT_SIZE        (128u * 1024u)
+#define CALIB_FLASH_WORD       32u                 /* STM32H7 program unit */
+
+#ifndef SIL_BUILD
+#define CALIB_FLASH_BASE       0x080C0000u         /* sectors 6 and 7     */
+#define CALIB_FLASH_SECTOR_A   6u
+#endif
+
+typedef struct
+{
+  apps_cal_t    apps;
+  control_cfg_t ctrl;
+  uint32_t      tel_period_ms;    /* telemetry frame period                */
+  canmap_ids_t  can;              /* CAN ID map, applied at boot           */
+} calib_data_t;
+
+typedef enum
+{
+  CALIB_T_U16 = 0,
+  CALIB_T_U32,
+  CALIB_T_I16,
+  CALIB_T_I32,
+  CALIB_T_F32
+} calib_type_t;
+
+typedef struct
+{
+  uint16_t    id;
+  uint8_t     type;       /* calib_type_t                                 */
+  uint16_t    offset;     /* in calib_data_t                              */
+  float       min;
+  float       max;
+  const char *name;
+} calib_param_t;
+
+extern const calib_param_t CALIB_PARAMS[];
+extern const uint32_t      CALIB_PARAM_COUNT;
+
+typedef enum
+{
+  CALIB_OK        =  0,
+  CALIB_ERR_ID    = -1,   /* unknown parameter                           */
+  CALIB_ERR_RANGE = -2,   /* outside min..max                            */
+  CALIB_ERR_BUSY  = -3,   /* control task still on the idle bank: retry  */
+  CALIB_ERR_FLASH = -4,   /* erase / program / verify failed             */
+  CALIB_ERR_RUNNING = -5  /* car running: the erase would stall the core */
+} calib_status_t;
+
+typedef struct
+{
+  uint32_t seq;           /* live bank sequence (0 = not initialised)    */
+  uint32_t commits;
+  uint32_t busy;
+  uint32_t saves;
+  uint32_t save_errors;
+  uint32_t flash_counter; /* write counter of the newest flash slot      */
+  int8_t   flash_slot;    /* slot loaded at boot, -1 = defaults          */
+  uint16_t records_loaded;
+  uint16_t records_skipped;  /* unknown ID, wrong type or out of range   */
+} calib_stats_t;
+
+/* Defaults, then the newest valid flash slot on top; publishes bank A. */
+void                Calib_Init(void);
+void                Calib_Defaults(calib_data_t *out);
+
+/* Control task only, once per cycle: live data and its sequence number.
+ * NULL before Calib_Init(). */
+const calib_data_t *Calib_Acquire(uint32_t *seq);
+
+/* Live data for other tasks: read single word-sized fields only. */
+const calib_data_t *Calib_Peek(void);
+
+const calib_param_t *Calib_FindParam(uint16_t id);
+
+/* Staged edits (not live until Calib_Commit). Get reads the stage.
+ * SetData stages a whole image, or returns CALIB_ERR_RANGE and keeps the
+ * stage if any CALIB_PARAMS field is outside its min..max. */
+int                 Calib_Set(uint16_t id, float value);
+int                 Calib_Get(uint16_t id, float *value);
+int                 Calib_SetData(const calib_data_t *data);
+void                Calib_Revert(void);         /* stage = live          */
+void                Calib_StageDefaults(void);  /* stage = defaults      */
+
+/* Stage → idle bank → live. CALIB_ERR_BUSY until the control task has
+ * acquired the previous commit. */
+int                 Calib_Commit(void);
+
+/* Live → flash (the older slot). Blocking. CALIB_ERR_RUNNING (counted as
+ * a save error) while the car is running. */
+int                 Calib_Save(void);
+void                Calib_RequestSave(void);
+void                Calib_Service(void);
+
+void                Calib_GetStats(calib_stats_t *out);
+
+#ifdef SIL_BUILD
+/* Backing file of the two flash slots (default "ecu08_calib_flash.bin"). */
+void                Calib_SilSetFlashFile(const char *path);
+#endif
+
+#endif /* CALIB_H */
@@ -10,9 +10,6 @@
 #include "main.h"  /* Core/Inc/main.h: stm32h7xx_hal.h + FDCAN real   */
 #endif
 
-/* CubeMX-friendly 16-byte queue item */
-typedef struct { uint32_t w[4]; } can_qitem16_t;
-
 typedef enum
 {
   CAN_BUS_INV  = 1,  /* inverter */
@@ -20,22 +17,47 @@ typedef enum
   CAN_BUS_DASH = 3   /* dashboard / misc */
 } can_bus_t;
 
+/* CAN-FD: a bus whose FDCAN instance is configured FD + BRS in fdcan.c
+ * (FDCAN3, dashboard / telemetry / logging: 500 kbit/s arbitration,
+ * 2 Mbit/s data) carries frames of up to 64 bytes when fd = 1, and still
+ * classic frames when fd = 0. On a classic bus (FDCAN1, inverter:
+ * the BAMOCAR is CAN 2.0 only) fd is ignored and more than 8 bytes is
+ * refused by CanTx_SendHal. */
+#define CAN_MAX_DLEN      64u
+#define CAN_CLASSIC_DLEN   8u
+
 typedef struct
 {
   can_bus_t bus;
   uint32_t id;
-  uint8_t  dlc;      /* 0..8 */
+  uint8_t  dlc;      /* payload bytes, not the DLC code: 0..8, FD also 12/16/20/24/32/48/64 */
   uint8_t  ide;      /* 0=std, 1=ext */
-  uint8_t  data[8];
+  uint8_t  burst;    /* frames in the synchronized burst this one belongs to (0/1 = single) */
+  uint8_t  fd;       /* 1 = CAN-FD frame with bit-rate switching */
+  uint8_t  data[CAN_MAX_DLEN];
 } can_msg_t;
 
+/* Queue item: two header words and the payload, sized for a 64-byte frame.
+ * Pack/unpack move only the words the frame uses (at least 8 bytes, so
+ * classic frames keep all of data[0..7]); the rest of data[] is undefined
+ * after CAN_Unpack. */
+typedef struct { uint32_t w[2u + CAN_MAX_DLEN / 4u]; } can_qitem_t;
+
 /* Queue handles are created in freertos.c USER CODE. */
 extern osMessageQueueId_t canRxQueueHandle;
 extern osMessageQueueId_t canTxQueueHandle;
 
 /* Pack/unpack helpers */
-void CAN_Pack16(const can_msg_t *m, can_qitem16_t *q);
-void CAN_Unpack16(const can_qitem16_t *q, can_msg_t *m);
+void CAN_Pack(const can_msg_t *m, can_qitem_t *q);
+void CAN_Unpack(const can_qitem_t *q, can_msg_t *m);
+
+/* DLC code (0..15) <-> payload bytes. Can_LenToDlc rounds up to the next
+ * valid length (10 -> 9, i.e. 12 bytes); above 64 it saturates at 15. */
+uint8_t Can_LenToDlc(uint8_t len);
+uint8_t Can_DlcToLen(uint8_t dlc);
+
+/* 1 if the bus runs FD + BRS (fdcan.c FrameFormat), 0 if classic only. */
+uint8_t Can_BusIsFd(can_bus_t bus);
 
 /* RX parsing: updates app state based on CAN IDs (called from CanRxTask under mutex). */
 void CanRx_ParseAndUpdate(const can_msg_t *m, app_inputs_t *st);
@@ -43,6 +65,20 @@ void CanRx_ParseAndUpdate(const can_msg_t *m, app_inputs_t *st);
 /* TX: central HAL sender (called only from CanTxTask). */
 HAL_StatusTypeDef CanTx_SendHal(const can_msg_t *m);
 
+/* TX: n frames placed back to back in the TX FIFOs, so they leave in the
+ * same bus slot (inverter command burst). All-or-nothing per bus when the
+ * FIFO has room; if it does not, falls back to frame by frame and counts
+ * a split. Called only from CanTxTask. */
+#define CAN_BURST_MAX  (2u * INV_MAX)   /* up to two command frames per drive */
+HAL_StatusTypeDef CanTx_SendBurst(const can_msg_t *m, uint32_t n);
+uint32_t          CanTx_GetBurstSplits(void);
+
+/* CanTxTask helper: m is the first frame of a burst (burst > 1) just taken
+ * from canTxQueueHandle; collects the rest (the producer queues them in
+ * one go, all tagged with the same count) and sends the lot with
+ * CanTx_SendBurst. Untagged frames met in between are sent on their own. */
+void CanTx_DrainBurst(const can_msg_t *m);
+
 /* ISR helper: call from HAL_FDCAN_RxFifo0Callback to enqueue into canRxQueueHandle. */
 void Can_ISR_PushRxFifo0(FDCAN_HandleTypeDef *hfdcan);
 
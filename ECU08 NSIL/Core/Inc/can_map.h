@@ -0,0 +1,108 @@
+#ifndef CAN_MAP_H
+#define CAN_MAP_H
+
+#include <stdint.h>
+
+/* CAN ID map: the IDs of the frames the VCU exchanges with the other ECUs
+ * of the car (VCU.h), set at boot instead of compiled in.
+ *
+ *  - One 11-bit ID per key. The table is part of the calibration store
+ *    (calib_data_t.can, parameters 0x0Axx): it lives in the calib flash
+ *    slots, is edited over XCP / UDS like any tunable and is saved with
+ *    them. An ID change on another ECU is a calibration write, not a
+ *    rebuild. It takes effect at the next boot.
+ *  - CanMap_Init validates the table and rejects it as a whole: a bad
+ *    table loads the compiled defaults, never half a map. Every ID must be
+ *    in 1..0x7FF, used once, and clear of the IDs the map does not own:
+ *    XCP, UDS and FWU, the frames of the inverter layout, and raw-ID
+ *    gateway routes that are transit only or remap. The log names the key
+ *    and what it collides with.
+ *  - RX: the IDs are hashed into CANMAP_HASH_SLOTS slots (multiplicative
+ *    hash, open addressing). Init picks the multiplier that gives the
+ *    fewest collisions - none for the car's table - so CanMap_RxKey costs
+ *    one multiply and at most max_probe + 1 compares, whatever the IDs.
+ *    CanRx_ParseAndUpdate then switches on the dense key.
+ *  - TX: tables of frames the VCU sends (handshake.c, tx_sched.c) hold
+ *    CANMAP_REF(key) instead of a raw ID; CanMap_Resolve gives the ID.
+ *  - SIL: the calib flash slots are a file (Calib_SilSetFlashFile), the
+ *    map is read from it the same way.
+ *
+ * Inverter IDs come from the inverter layout (inverters.c) and are not in
+ * the map; the layout must be set (Inv_SetLayout) before CanMap_Init.
+ * Gateway routes of map frames hold CANMAP_REF(key) too and are resolved
+ * by Gateway_Init, which runs after CanMap_Init. */
+
+typedef enum
+{
+  /* Received (dispatched by CanRx_ParseAndUpdate) */
+  CANMAP_ACK_PRECARGA = 0,
+  CANMAP_DC_BUS_VOLTAGE,
+  CANMAP_S1_ACELERACION,
+  CANMAP_S2_ACELERACION,
+  CANMAP_S_FRENO,
+  CANMAP_V_CELDA_MIN,
+  CANMAP_WHEEL_FRONT,
+  CANMAP_ACK_TELEMETRIA,
+  CANMAP_ACK_CAJA_NEGRA,
+  CANMAP_ACK_PANTALLA,
+  CANMAP_RX_COUNT,
+
+  /* Sent */
+  CANMAP_OK_TELEMETRIA = CANMAP_RX_COUNT,
+  CANMAP_OK_CAJA_NEGRA,
+  CANMAP_OK_PANTALLA,
+  CANMAP_RTD_ALL,
+  CANMAP_TORQUE_TOTAL,
+  CANMAP_T_MOTOR,
+  CANMAP_T_IGBT,
+  CANMAP_T_AIR,
+  CANMAP_N_ACTUAL,
+  CANMAP_I_ACTUAL,
+  CANMAP_COUNT
+} canmap_key_t;
+
+#define CANMAP_NONE        0xFFu
+
+#define CANMAP_HASH_SLOTS  32u      /* power of two, >= 3 x CANMAP_RX_COUNT */
+
+/* Reference to a map entry in a frame table's ID field */
+#define CANMAP_REF_FLAG    0x80000000u
+#define CANMAP_REF(k)      (CANMAP_REF_FLAG | (uint32_t)(k))
+
+typedef struct
+{
+  uint16_t id[CANMAP_COUNT];
+} canmap_ids_t;
+
+/* The car's IDs (VCU.h) */
+extern const canmap_ids_t CANMAP_DEFAULT;
+extern const char *const  CANMAP_NAMES[CANMAP_COUNT];
+
+typedef struct
+{
+  uint8_t  from_table;      /* 1 = the given table is live, 0 = defaults  */
+  uint8_t  bad_key;         /* first offending key of the last rejected
+                               table, CANMAP_NONE if none                 */
+  uint8_t  max_probe;       /* longest probe sequence past the home slot  */
+  uint8_t  used;            /* occupied hash slots                        */
+  uint32_t mult;            /* hash multiplier                            */
+  uint32_t rejected;        /* tables refused since boot                  */
+} canmap_stats_t;
+
+/* Validates ids (NULL = CANMAP_DEFAULT) and makes it the live map.
+ * Returns -1 and loads the defaults if an ID is out of range, used twice
+ * or reserved outside the map. Until the first call the defaults are used. */
+int      CanMap_Init(const canmap_ids_t *ids);
+
+/* Key of a received standard ID, CANMAP_NONE if it is not in the map. */
+uint8_t  CanMap_RxKey(uint32_t id);
+
+/* Live ID of a key (0 for an unknown key). */
+uint32_t CanMap_Id(uint32_t key);
+
+/* CANMAP_REF(key) → live ID; any other value is returned as is. */
+uint32_t CanMap_Resolve(uint32_t id);
+
+void     CanMap_GetStats(canmap_stats_t *out);
+
+#endif /* CAN_MAP_H */
@@ -4,17 +4,205 @@
 #include <stdint.h>
 #include "app_state.h"
 #include "can.h"
+#include "vehicle_state.h"
+#include "inverters.h"
+#include "inv_backend.h"
+#include "handshake.h"
+#include "power_limit.h"
+#include "thermal_derate.h"
+#include "torque_slew.h"
+#include "regen.h"
+#include "launch.h"
+#include "traction.h"
+#include "torque_vectoring.h"
+
+/* The first step arms every register of every inverter (BAMOCAR) and
+ * starts the boot handshakes; the RUN command burst is INV_BK_CMD_FRAMES
+ * per inverter. */
+#define CONTROL_OUT_MAX_MSGS  ((INV_BK_SETUP_MSGS + INV_BK_CMD_FRAMES) * INV_MAX + HS_NODE_COUNT)
 
 typedef struct
 {
-  can_msg_t msgs[8];
+  can_msg_t msgs[CONTROL_OUT_MAX_MSGS];
   uint8_t  count;
-  uint16_t torque_pct; /* 0..100 */
+  int16_t  torque_pct;          /* total, -100..100, negative = regen */
+  int16_t  motor_pct[INV_MAX];  /* per inverter (layout order)        */
 } control_out_t;
 
+/* Nominal control period when no executive has set one (legacy 100 Hz). */
+#define CONTROL_DEFAULT_PERIOD_US 10000u
+
+/* Inverter command rate. The step may run at 1 kHz; the drives get a new
+ * setpoint every cmd_period_ms and hold the last one in between (a drop
+ * to 0 goes out at once). The bursts may use CONTROL_CMD_BUS_PCT of the
+ * inverter bus (FDCAN1, classic 500 kbit/s, 8-byte frames with worst-case
+ * stuffing); a period shorter than the layout allows is raised to
+ * Control_CmdPeriodMinMs(). */
+#define CONTROL_CMD_PERIOD_MS      5u
+#define CONTROL_CMD_PERIOD_MAX_MS  50u
+#define CONTROL_INV_BUS_BPS        500000u
+#define CONTROL_CAN_FRAME_BITS     135u
+#define CONTROL_CMD_BUS_PCT        50u
+
+/* Pedal (APPS) map and brake threshold. Per sensor:
+ *   pct = (raw - offset) / adc_per_pct, clamped to 0..100
+ * torque = mean of both when both exceed deadband_pct; below min_pct → 0,
+ * above max_pct → 100 (only for a pedal that passed the first two).
+ * brake_adc is the pressed-brake threshold for the EV2.3 latch, the start
+ * condition and the drive-torque cut. */
+typedef struct
+{
+  float    s1_offset_adc;
+  float    s1_adc_per_pct;
+  float    s2_offset_adc;
+  float    s2_adc_per_pct;
+  float    deadband_pct;
+  int32_t  min_pct;
+  int32_t  max_pct;
+  uint16_t brake_adc;
+} apps_cal_t;
+
+extern const apps_cal_t APPS_CAL_DEFAULT;
+
+/* Stage configurations of one control instance. A fresh context gets the
+ * *_CFG_DEFAULT values (Control_CfgDefault); the calibration store
+ * (calib.h) replaces them at runtime. */
+typedef struct
+{
+  power_limit_cfg_t      power_limit;
+  thermal_derate_cfg_t   thermal;
+  torque_slew_cfg_t      slew;
+  regen_cfg_t            regen;
+  launch_cfg_t           launch;
+  traction_cfg_t         traction;
+  vehicle_state_cfg_t    vehicle;
+  torque_vectoring_cfg_t vectoring;
+  uint32_t               inv_read_period_ms;  /* BAMOCAR cyclic reads, 1..255 */
+  uint32_t               cmd_period_ms;       /* command burst, 1..CONTROL_CMD_PERIOD_MAX_MS */
+} control_cfg_t;
+
+void Control_CfgDefault(control_cfg_t *cfg);
+
+/* All state of one control instance. Control_StepCtx() touches nothing
+ * else that is mutable (its configs are copies held in the context, the
+ * inverter layout is set once at startup), so independent contexts can be
+ * stepped from different threads. Plain data, no pointers: a context can be copied, and
+ * checkpointed with Control_CtxSerialize(). Bump CONTROL_CTX_VERSION when
+ * a field or a stage state struct changes. */
+#define CONTROL_CTX_VERSION 9u
+
+typedef struct
+{
+  uint8_t            state;           /* FSM state (control.c)              */
+  uint8_t            lat_ev23;        /* EV2.3 brake + throttle latch       */
+  uint32_t           r2d_start_tick;  /* ms, start of the ready-to-drive wait */
+  uint32_t           period_us;       /* step period, stage dt              */
+  uint32_t           sig_stale;       /* Fresh_Check() of the last step     */
+  uint32_t           cmd_tick;        /* ms, last command burst             */
+  uint8_t            cmd_sent;        /* a burst went out since RUN         */
+  int16_t            cmd_pct[INV_MAX];/* setpoints of that burst            */
+  apps_cal_t         apps;            /* pedal map (APPS_CAL_DEFAULT)       */
+  control_cfg_t      cfg;             /* stage configs (Control_CfgDefault) */
+  power_limit_t      power_limit;
+  thermal_derate_t   thermal;
+  torque_slew_t      slew;
+  regen_t            regen;
+  launch_t           launch;
+  traction_t         traction;
+  vehicle_state_t    vehicle;
+  torque_vectoring_t vectoring;
+  inv_link_t         link[INV_MAX];
+#if INV_BACKEND == INV_BACKEND_BAMOCAR
+  bamo_sub_t         sub[INV_MAX];    /* register subscriptions per drive  */
+#endif
+  hs_t               hs;              /* boot handshakes with the other ECUs */
+} ctrl_ctx_t;
+
+/* Checkpoint size: 16-byte header (magic, version, size, CRC-32) + context */
+#define CONTROL_CTX_BLOB_SIZE (16u + (uint32_t)sizeof(ctrl_ctx_t))
+
+/* Resets a context to BOOT with the given step period (0 = default). */
+void     Control_CtxInit(ctrl_ctx_t *ctx, uint32_t period_us);
+
+/* Replaces ctx's pedal calibration. Returns -1 and keeps the old one if a
+ * span is not positive, deadband_pct >= min_pct or min_pct > max_pct. */
+int      Control_CtxSetAppsCal(ctrl_ctx_t *ctx, const apps_cal_t *cal);
+
+/* Replaces ctx's stage configs. Stage states are kept: the new values act
+ * from the next step on (a new launch profile once no launch is running). A read period outside 1..255 ms or a command
+ * period outside 1..CONTROL_CMD_PERIOD_MAX_MS is ignored. */
+void     Control_CtxSetCfg(ctrl_ctx_t *ctx, const control_cfg_t *cfg);
+
+/* Shortest command period [ms] that keeps the bursts of n_inv drives
+ * within CONTROL_CMD_BUS_PCT of the inverter bus. */
+uint32_t Control_CmdPeriodMinMs(uint8_t n_inv);
+
+/* One control cycle of ctx at time now_ms (ms timebase of the caller; the
+ * ready-to-drive delay and inverter timeouts use it). */
+void     Control_StepCtx(ctrl_ctx_t *ctx, const app_inputs_t *in, control_out_t *out,
+                         uint32_t now_ms);
+
+/* Pedal map and EV2.3 latch of ctx. */
+uint16_t Control_ComputeTorqueCtx(ctrl_ctx_t *ctx, const app_inputs_t *in,
+                                  uint8_t *flag_ev_2_3, uint8_t *flag_t11_8_9);
+
+/* Batch pedal map for calibration sweeps: structure-of-arrays inputs,
+ * n samples evaluated in order through ctx's EV2.3 latch (carried in and
+ * out, so a long record can be fed in chunks). Outputs torque[i] and
+ * flag_ev_2_3[i] equal n successive Control_ComputeTorqueCtx() calls bit
+ * for bit. All arrays must hold n elements and must not overlap. */
+typedef struct
+{
+  const uint16_t *s1_aceleracion;
+  const uint16_t *s2_aceleracion;
+  const uint16_t *s_freno;
+} control_batch_in_t;
+
+void     Control_ComputeTorqueBatch(ctrl_ctx_t *ctx, const control_batch_in_t *in, uint32_t n,
+                                    uint16_t *torque, uint8_t *flag_ev_2_3);
+
+/* Checkpoint: writes CONTROL_CTX_BLOB_SIZE bytes, returns that or 0 if buf
+ * is too small. Restore returns 0, or -1 (ctx untouched) on a bad magic,
+ * version, size or CRC. Same build only: the blob is the raw struct. */
+uint32_t Control_CtxSerialize(const ctrl_ctx_t *ctx, uint8_t *buf, uint32_t len);
+int      Control_CtxRestore(ctrl_ctx_t *ctx, const uint8_t *buf, uint32_t len);
+
+/* Legacy single-vehicle API: the functions below act on one built-in
+ * context (the control tasks' instance), stepped on osKernelGetTickCount(). */
+ctrl_ctx_t *Control_DefaultCtx(void);
+
 void Control_Init(void);
 void Control_Step10ms(const app_inputs_t *in, control_out_t *out);
 
+/* Period of one Control_Step10ms call; set once from the control executive.
+ * Not reset by Control_Init(). */
+void     Control_SetPeriodUs(uint32_t period_us);
+uint32_t Control_GetPeriodUs(void);
+
+/* 1 while the FSM is in RUN (drive torque enabled), for diagnostics. */
+uint8_t  Control_IsRunning(void);
+
+/* Current thermal derating limit (0..100 %), for diagnostics. */
+float    Control_GetThermalLimitPct(void);
+
+/* Last traction-control slip estimate, for diagnostics. */
+float    Control_GetTractionSlip(void);
+
+/* Estimated vehicle speed, slip and yaw-rate error (updated every cycle). */
+const vehicle_state_t *Control_GetVehicleState(void);
+
+/* Link state of inverter k (inv_link_state_t), for diagnostics. */
+uint8_t  Control_GetInverterLink(uint8_t k);
+
+/* Stale input signals at the last step (FRESH_BIT(app_sig_t) mask). */
+uint32_t Control_GetStaleSignals(void);
+
+/* Boot handshakes: per-node state, attempts and time to ready. */
+const hs_t *Control_GetHandshake(void);
+
+/* Last left/right yaw-moment offset applied by torque vectoring (%). */
+float    Control_GetVectoringOffsetPct(void);
+
 /* Computes torque percent and updates flags in a copy; caller decides what to store. */
 uint16_t Control_ComputeTorque(const app_inputs_t *in, uint8_t *flag_ev_2_3, uint8_t *flag_t11_8_9);
 
@@ -0,0 +1,61 @@
+#ifndef CTRL_EXEC_H
+#define CTRL_EXEC_H
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+
+/* Control executive: TIM16 update IRQ wakes ControlTask through a direct
+ * task notification at CTRL_EXEC_RATE_HZ. Replaces the osDelay/osDelayUntil
+ * pacing that tied the control loop to the 1 ms RTOS tick. */
+
+#define CTRL_EXEC_RATE_HZ      1000u   /* default control rate              */
+#define CTRL_EXEC_RATE_MIN_HZ  10u
+#define CTRL_EXEC_RATE_MAX_HZ  1000u
+
+/* TIM16 counts at 1 MHz so ARR = period in microseconds. */
+#define CTRL_EXEC_TIM_CLK_HZ   1000000u
+
+typedef struct
+{
+  uint32_t rate_hz;
+  uint32_t period_us;
+
+  uint32_t cycles;          /* completed control cycles                    */
+  uint32_t overruns;        /* cycles whose execution exceeded the period  */
+  uint32_t missed;          /* timer ticks lost while the task was busy    */
+
+  uint32_t jitter_last_us;  /* |wake-to-wake interval - period|            */
+  uint32_t jitter_max_us;
+  uint32_t exec_last_us;    /* wake-to-done execution time                 */
+  uint32_t exec_max_us;
+} ctrl_exec_stats_t;
+
+/* Selects the rate (clamped to [MIN, MAX]) and resets statistics. */
+void     CtrlExec_Init(uint32_t rate_hz);
+uint32_t CtrlExec_GetPeriodUs(void);
+
+/* Programs TIM16 for the selected rate and starts it; `task` is notified on
+ * every update event. Call from the control task itself before the loop. */
+void     CtrlExec_Start(osThreadId_t task);
+
+/* TIM16 update ISR hook (from HAL_TIM_PeriodElapsedCallback). */
+void     CtrlExec_TimerIsr(void);
+
+/* Blocks until the next timer tick. Returns the number of ticks consumed
+ * (1 normally, >1 when cycles were missed). */
+uint32_t CtrlExec_WaitCycle(void);
+
+/* Marks the end of the cycle body (execution time / overrun accounting). */
+void     CtrlExec_CycleDone(void);
+
+/* Microsecond timebase (TIM16 based; kernel tick in SIL). ISR-safe. */
+uint32_t CtrlExec_NowUs(void);
+
+/* Pure accounting, timestamps in microseconds. Used by the wrappers above
+ * and directly by the SIL tests with synthetic timestamps. */
+void     CtrlExec_OnWake(uint32_t now_us, uint32_t ticks);
+void     CtrlExec_OnDone(uint32_t now_us);
+
+void     CtrlExec_GetStats(ctrl_exec_stats_t *out);
+
+#endif /* CTRL_EXEC_H */
@@ -0,0 +1,89 @@
+#ifndef EPL_H
+#define EPL_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "inverters.h"
+
+/* ePowerLabs inverter protocol (VCU.h: TX_STATE_1..9, RX_SETPOINT_1..6).
+ *
+ *  - The drive sends TX_STATE_1..9 cyclically on fb_id .. fb_id + 8
+ *    (0x460..0x468), unasked. Every signal of every frame is decoded into
+ *    the shared model (inv_fb_t, Inv_FbSet) through a per-frame signal
+ *    table: first byte, width, sign, model field, scale. The frame is the
+ *    ID offset from fb_id, so finding its table is one subtraction.
+ *  - The VCU commands it with RX_SETPOINT_1..6 on cmd_id .. cmd_id + 5
+ *    (0x360..0x365; 0x364 is missing from VCU.h). epl_setpoint_t holds all
+ *    of them; one table per frame serves Epl_PackSetpoint and
+ *    Epl_DecodeSetpoint (SIL drive model, bus monitors).
+ *  - The control step sends RX_SETPOINT_1 (control word) and _2 (torque)
+ *    every RUN cycle in the command burst. Limits (3..6) keep the drive's
+ *    own parametrisation unless packed explicitly.
+ *
+ * Signal positions follow the drive's CAN matrix as configured on the car
+ * (little endian); a change there is a table row in epl.c. */
+
+#define EPL_TX_FRAMES    9u
+#define EPL_SP_FRAMES    6u
+#define EPL_CMD_FRAMES   2u      /* RX_SETPOINT_1 and _2, per drive per cycle */
+
+/* RX_SETPOINT_1 */
+#define EPL_CTRL_ENABLE     0x0001u
+#define EPL_CTRL_RUN        0x0002u
+#define EPL_CTRL_FAULT_RST  0x0004u
+#define EPL_MODE_TORQUE     1u
+
+/* Everything the VCU can command, in wire units */
+typedef struct
+{
+  uint16_t ctrl;            /* SP1: EPL_CTRL_* bits                        */
+  uint16_t mode;            /* SP1: EPL_MODE_*                             */
+  int16_t  torque_pmil;     /* SP2: request, 0.1 % of the drive's limit    */
+  int16_t  speed_max_rpm;   /* SP3 */
+  int16_t  speed_min_rpm;   /* SP3, <= 0                                   */
+  int16_t  torque_max_dnm;  /* SP4: 0.1 Nm                                 */
+  int16_t  torque_min_dnm;  /* SP4, <= 0                                   */
+  int16_t  idc_max_a;       /* SP5: discharge                              */
+  int16_t  idc_min_a;       /* SP5: charge, <= 0                           */
+  uint16_t vdc_min_v;       /* SP6 */
+  uint16_t vdc_max_v;       /* SP6 */
+} epl_setpoint_t;
+
+/* One signal: value = raw * mul / div on decode (the inverse on pack) */
+typedef struct
+{
+  uint8_t byte;             /* first byte                                  */
+  uint8_t bits;             /* 8 or 16                                     */
+  uint8_t sgn;              /* 1 = two's complement                        */
+  uint8_t dst;              /* TX: inv_fb_field_t; RX: epl_setpoint_t offset */
+  int16_t mul;
+  int16_t div;
+} epl_sig_t;
+
+typedef struct
+{
+  const epl_sig_t *sig;
+  uint8_t          n;
+} epl_frame_t;
+
+extern const epl_frame_t EPL_TX[EPL_TX_FRAMES];
+extern const epl_frame_t EPL_SP[EPL_SP_FRAMES];
+
+/* Decodes a TX_STATE frame of any layout drive into the shared model.
+ * Returns the fields it updated (bit per inv_fb_field_t), 0 if m is not a
+ * TX_STATE frame. */
+uint16_t Epl_Decode(const can_msg_t *m, app_inputs_t *st, uint32_t now_ms);
+
+/* RX_SETPOINT_<idx + 1> of drive nd from sp. */
+void     Epl_PackSetpoint(const inv_node_t *nd, const epl_setpoint_t *sp, uint8_t idx, can_msg_t *m);
+
+/* Decodes an RX_SETPOINT frame addressed to nd into sp (other members
+ * kept). Returns the frame index 0..5, or -1. */
+int      Epl_DecodeSetpoint(const can_msg_t *m, const inv_node_t *nd, epl_setpoint_t *sp);
+
+/* Command burst share of drive nd: enable + run in torque mode, torque
+ * request torque_pct (negative = regen), EPL_CMD_FRAMES frames. */
+void     Epl_BuildCmd(const inv_node_t *nd, int16_t torque_pct, can_msg_t *msgs);
+
+#endif /* EPL_H */
@@ -0,0 +1,42 @@
+#ifndef FRESHNESS_H
+#define FRESHNESS_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Freshness supervision of the CAN input signals.
+ *
+ *  - FRESH_SIGNALS gives every app_sig_t its expected period; a signal
+ *    silent for FRESH_MISSED_PERIODS periods is stale.
+ *  - CanRx_ParseAndUpdate stamps the signals a frame carries
+ *    (Fresh_Stamp: sig_tick, sig_seen bit).
+ *  - Fresh_Check is one pass over the signals building a packed bitmask,
+ *    no branches in the loop: cheap enough for every 1 kHz control cycle.
+ *    A signal never received is not stale: it still holds its AppState_Init
+ *    zero (pedal released, brake released), which cannot give torque or
+ *    start the car.
+ *  - Control_StepCtx: a stale FRESH_CRITICAL signal (APPS 1/2, brake)
+ *    forces zero torque (launch aborted, slew cut) until it comes back; a
+ *    stale brake also blocks the start; stale CAN wheel speeds count as no
+ *    wheel speed source. */
+
+#define FRESH_MISSED_PERIODS  3u
+#define FRESH_BIT(s)          (1u << (uint32_t)(s))
+#define FRESH_CRITICAL        (FRESH_BIT(SIG_S1_ACELERACION) | FRESH_BIT(SIG_S2_ACELERACION) | \
+                               FRESH_BIT(SIG_S_FRENO))
+
+typedef struct
+{
+  const char *name;
+  uint16_t    period_ms;    /* expected transmit period of the node */
+} fresh_sig_t;
+
+extern const fresh_sig_t FRESH_SIGNALS[SIG_COUNT];
+
+/* Marks signal s of st received at now_ms. */
+void     Fresh_Stamp(app_inputs_t *st, app_sig_t s, uint32_t now_ms);
+
+/* Stale signals of in at now_ms (same timebase as the stamps). */
+uint32_t Fresh_Check(const app_inputs_t *in, uint32_t now_ms);
+
+#endif /* FRESHNESS_H */
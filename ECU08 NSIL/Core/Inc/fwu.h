@@ -0,0 +1,145 @@
+#ifndef FWU_H
+#define FWU_H
+
+#include <stdint.h>
+
+/* Firmware update over CAN-FD: the protocol server of the bootloader and
+ * its streamed flash writer.
+ *
+ * Flash layout (1 MB, 128 KB sectors):
+ *   sector 0      bootloader (Bootloader/)
+ *   sectors 1-5   application region: FWU_HDR_SIZE of descriptor, then the
+ *                 image (vector table first, VTOR aligned)
+ *   sectors 6-7   calibration (calib.c)
+ *
+ * Descriptor, one flash word each: [0] magic, size, CRC-32  [1] SHA-256
+ * [2] valid marker, programmed only after the image read back from flash
+ * hashed right. A descriptor without the marker is an interrupted update:
+ * the bootloader stays and the host resumes it.
+ *
+ * Protocol (dashboard bus, FD frames with BRS, little endian). The ECU
+ * answers on the lower ID so its acks win arbitration over the stream.
+ *
+ *   01 CONNECT                         → 81 st ver buf_size(2) image_max(4)
+ *   02 START flags size(4) crc(4) sha(32)
+ *                                      → 82 st offset(4) prefix_crc(4) limit(4)
+ *   03 DATA seq payload(len-2)         → 83 st seq next(4) limit(4)
+ *   04 VERIFY                          → 84 st
+ *   05 RESET                           → 85 st, then start the application
+ *
+ * START with the image already described in flash resumes: offset is the
+ * end of the last programmed flash word and prefix_crc the CRC-32 of the
+ * image up to it, for the host to check against its file (flags bit 0
+ * forces a fresh erase). A different image erases the sectors it needs
+ * and writes the descriptor before answering.
+ *
+ * DATA: payload bytes follow each other from `offset`, seq counts frames.
+ * The host keeps sending while its position is below `limit`, which the
+ * ECU advances as receive buffers free up (acks every FWU_ACK_STEP bytes):
+ * the stream never outruns the flash. A gap in seq is answered once with
+ * FWU_ERR_SEQ and the position to go back to.
+ *
+ * Writer: two FWU_BUF_SIZE receive buffers, flash-word (256-bit) aligned.
+ * One fills from the bus while the other is programmed a flash word per
+ * Fwu_Poll(), without waiting for the flash: reception and programming
+ * overlap and the bus stays the bottleneck. Erased (all 0xFF) words are
+ * skipped, which is also what makes the resume point recoverable from
+ * flash alone.
+ *
+ * SIL: the region is a RAM array with program/erase times, survives
+ * Fwu_Init() (a reset) and is reachable through Fwu_SilFlash(). */
+
+#define FWU_CMD_ID          0x7F3u   /* host → ECU                         */
+#define FWU_RSP_ID          0x7F2u   /* ECU → host                         */
+#define FWU_FRAME_MAX       64u
+#define FWU_PROTO_VERSION   1u
+
+#define FWU_FLASH_WORD      32u
+#define FWU_SECTOR_SIZE     (128u * 1024u)
+#define FWU_REGION_BASE     0x08020000u   /* sectors 1-5                    */
+#define FWU_REGION_SECTOR   1u
+#define FWU_REGION_SIZE     (5u * FWU_SECTOR_SIZE)
+#define FWU_HDR_SIZE        0x400u
+#define FWU_IMAGE_BASE      (FWU_REGION_BASE + FWU_HDR_SIZE)
+#define FWU_IMAGE_MAX       (FWU_REGION_SIZE - FWU_HDR_SIZE)
+
+#define FWU_BUF_SIZE        2048u    /* each of the two receive buffers    */
+#define FWU_ACK_STEP        512u
+
+/* Application → bootloader: magic left in DTCM across the reset */
+#define FWU_BOOT_FLAG_ADDR  0x2001FFFCu
+#define FWU_BOOT_MAGIC      0xB007F00Du
+
+#define FWU_START_FORCE     0x01u
+
+enum
+{
+  FWU_CMD_CONNECT = 0x01,
+  FWU_CMD_START   = 0x02,
+  FWU_CMD_DATA    = 0x03,
+  FWU_CMD_VERIFY  = 0x04,
+  FWU_CMD_RESET   = 0x05
+};
+
+enum
+{
+  FWU_OK = 0,
+  FWU_ERR_SEQ,          /* frame lost: resend from `next`                */
+  FWU_ERR_RANGE,        /* image too large, write past the end           */
+  FWU_ERR_STATE,        /* no session (e.g. after a reset): START again   */
+  FWU_ERR_VERIFY,       /* CRC / SHA-256 of the flash contents differ    */
+  FWU_ERR_FLASH,        /* erase or program failed                       */
+  FWU_ERR_LENGTH
+};
+
+/* Frame sink: 0 = queued, else full (the frame is retried on the next
+ * Fwu_Poll). len is a valid FD length (0-8, 12, 16, ... 64). */
+typedef int (*fwu_tx_fn_t)(uint32_t id, const uint8_t *data, uint8_t len);
+
+typedef struct
+{
+  uint32_t frames;        /* DATA frames accepted                          */
+  uint32_t seq_errors;
+  uint32_t words;         /* flash words programmed                        */
+  uint32_t words_skipped; /* all 0xFF, left erased                         */
+  uint32_t sectors;       /* erased                                        */
+  uint32_t stalls;        /* polls with a full buffer waiting on the flash */
+  uint32_t resumes;
+} fwu_stats_t;
+
+/* Bootloader: session state reset (the flash is not touched). */
+void Fwu_Init(fwu_tx_fn_t tx);
+
+/* Returns 1 if the frame was for the updater. */
+int  Fwu_OnFrame(uint32_t id, const uint8_t *data, uint8_t len, uint32_t now_us);
+
+/* Main loop: erase, one flash word, verification, pending answers. */
+void Fwu_Poll(uint32_t now_us);
+
+/* RESET answered: the bootloader may start the application. */
+uint8_t Fwu_ResetRequested(void);
+
+/* Descriptor valid, or no descriptor but a plausible vector table (image
+ * loaded with a debugger). */
+uint8_t Fwu_AppValid(void);
+
+void Fwu_GetStats(fwu_stats_t *out);
+
+/* FD data length → DLC code and back (rounds up to the next FD length). */
+uint8_t Fwu_LenToDlc(uint8_t len);
+uint8_t Fwu_DlcToLen(uint8_t dlc);
+
+/* CRC-32 (IEEE) with a running value: crc = Fwu_Crc32(0, ...) to start. */
+uint32_t Fwu_Crc32(uint32_t crc, const uint8_t *p, uint32_t n);
+
+/* Application: reset into the bootloader and stay there. */
+void Fwu_EnterBootloader(void);
+
+#ifdef SIL_BUILD
+uint8_t *Fwu_SilFlash(void);                 /* FWU_REGION_SIZE bytes      */
+void     Fwu_SilErase(void);                 /* whole region to 0xFF       */
+void     Fwu_SilSetTiming(uint32_t word_us, uint32_t sector_us);
+uint8_t  Fwu_SilBootRequested(void);
+#endif
+
+#endif /* FWU_H */
@@ -0,0 +1,86 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <stdint.h>
+#include "can.h"
+
+/* Multi-bus CAN gateway driven by a routing table.
+ *
+ *  - Forwarding happens in the RX interrupt (Can_ISR_PushRxFifo0): the
+ *    frame the HAL just read out of the RX FIFO is handed to CanTx_SendHal
+ *    once per destination bus, with its bus and (if the route remaps it)
+ *    its ID rewritten in place. Nothing is parsed, nothing goes through
+ *    app_inputs_t, no queue hop: no CanRxTask / CanTxTask round trip.
+ *    The frame then goes on to the application as before, unless the
+ *    route is transit only (GW_NO_LOCAL).
+ *  - Route: source bus, ID / mask / IDE match, destination bus set,
+ *    optional remap (the bits under the mask replaced by `remap`, the
+ *    others kept: a mask route moves a whole block of IDs) and a minimum
+ *    interval between forwarded frames (rate limit, 0 = none). A frame can
+ *    match several routes; each forwards it.
+ *  - Gateway_Init indexes the table per source bus, so a frame costs one
+ *    pass over the routes of its own bus.
+ *  - A route id may be CANMAP_REF(key): Gateway_Init resolves it to the
+ *    live ID of the CAN map, so it must run after CanMap_Init. Routes of
+ *    map frames then follow a calibrated ID change.
+ *  - Counters per route: matched, forwarded (per destination), rate
+ *    limited, dropped (destination TX FIFO full, or an FD payload for a
+ *    classic bus), and the forwarding latency from the frame leaving the
+ *    RX FIFO to the last destination FIFO write, last and worst. The diag
+ *    task (StartDiagTask) logs them every second.
+ *
+ * TX FIFO writes are serialised in can.c (interrupts masked around the
+ * HAL call), since CanTxTask and the RX interrupts now both transmit. */
+
+#define GW_MAX_ROUTES   16u
+#define GW_NO_REMAP     0xFFFFFFFFu
+#define GW_BUS(b)       (1u << (uint32_t)(b))
+
+/* Route flags */
+#define GW_NO_LOCAL     0x01u    /* transit only: not queued to the application */
+
+typedef struct
+{
+  can_bus_t src;
+  uint8_t   ide;          /* 0 = standard, 1 = extended ID          */
+  uint8_t   dst;          /* GW_BUS() set; the source bus is skipped */
+  uint8_t   flags;
+  uint32_t  id;           /* match: (frame id & mask) == id, or a
+                             CANMAP_REF(key) resolved at init       */
+  uint32_t  mask;
+  uint32_t  remap;        /* GW_NO_REMAP or the new masked bits     */
+  uint32_t  min_gap_us;   /* rate limit, 0 = every frame            */
+} gw_route_t;
+
+typedef struct
+{
+  uint32_t matched;
+  uint32_t forwarded;     /* frames written to a destination FIFO   */
+  uint32_t limited;       /* matched but inside min_gap_us          */
+  uint32_t dropped;       /* destination refused the frame          */
+  uint32_t lat_last_us;
+  uint32_t lat_max_us;
+} gw_stats_t;
+
+/* The car's routing table (gateway.c) */
+extern const gw_route_t GW_ROUTES[];
+extern const uint32_t   GW_ROUTE_COUNT;
+
+/* Loads a table (NULL = GW_ROUTES) and clears the counters. Returns -1
+ * (and loads nothing) if it is too long, a route is malformed or names
+ * an unknown map key. */
+int  Gateway_Init(const gw_route_t *routes, uint32_t n);
+
+/* RX interrupt hook. Forwards m along every matching route; m is given
+ * back unchanged. Returns 1 if the application must not see the frame. */
+int  Gateway_Forward(can_msg_t *m);
+
+uint32_t Gateway_RouteCount(void);
+void     Gateway_GetStats(uint32_t route, gw_stats_t *out);
+void     Gateway_ResetStats(void);
+
+/* Microsecond clock for rate limits and latency (default CtrlExec_NowUs;
+ * the SIL tests drive it). */
+void     Gateway_SetClock(uint32_t (*now_us)(void));
+
+#endif /* GATEWAY_H */
@@ -0,0 +1,92 @@
+#ifndef HANDSHAKE_H
+#define HANDSHAKE_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "can_map.h"
+
+/* Boot handshakes with the other ECUs of the car (VCU.h ok / ack pairs).
+ *
+ *  - One sub-state machine per node, all stepped together from the control
+ *    step: every request goes out on the first step, so boot-to-ready is
+ *    the slowest node, not the sum of them. Nothing blocks.
+ *  - Active node: the VCU sends its ok frame (req_id) and waits for the
+ *    node's ack (a freshness signal stamped by CanRx_ParseAndUpdate). No
+ *    ack within timeout_ms → the request is repeated, up to `retries`
+ *    times; then the node is FAILED, diagnosed at once instead of the boot
+ *    hanging on it. A FAILED node still listens: a late ack makes it READY.
+ *  - AMS: passive, no request. Ready is the ACU's precharge flag
+ *    (ok_precarga); its timeout only diagnoses a precharge that never ends.
+ *  - HS_REQUIRED nodes gate the control FSM out of the precharge wait; the
+ *    others (telemetry, black box, dashboard screen) are reported but do
+ *    not keep the car from driving.
+ *  - Per node: state, attempts and time from the first request to ready.
+ *
+ * Plain data in ctrl_ctx_t, stepped with the context's clock. */
+
+typedef enum
+{
+  HS_NODE_AMS = 0,
+  HS_NODE_TELEMETRIA,
+  HS_NODE_CAJA_NEGRA,
+  HS_NODE_PANTALLA,
+  HS_NODE_COUNT
+} hs_node_id_t;
+
+typedef enum
+{
+  HS_IDLE = 0,
+  HS_WAIT,                  /* request out, waiting for the ack           */
+  HS_READY,
+  HS_FAILED                 /* retries exhausted, still listening         */
+} hs_state_t;
+
+/* Node flags */
+#define HS_REQUIRED    0x01u     /* control FSM waits for it              */
+#define HS_PRECHARGE   0x02u     /* passive: ready = ok_precarga          */
+
+#define HS_NO_REQ      0u
+
+typedef struct
+{
+  const char *name;
+  can_bus_t   bus;
+  uint32_t    req_id;       /* VCU ok frame (ID or CANMAP_REF), HS_NO_REQ = passive */
+  app_sig_t   ack;          /* signal of the node's ack frame             */
+  uint16_t    timeout_ms;   /* per attempt                                */
+  uint8_t     retries;      /* requests after the first                   */
+  uint8_t     flags;
+} hs_node_t;
+
+extern const hs_node_t HS_NODES[HS_NODE_COUNT];
+
+typedef struct
+{
+  uint8_t  state;           /* hs_state_t                                 */
+  uint8_t  attempts;        /* requests sent                              */
+  uint32_t t_start;         /* first request (ms, context clock)          */
+  uint32_t t_req;           /* last request                               */
+  uint32_t ready_ms;        /* first request → ready                      */
+} hs_node_state_t;
+
+typedef struct
+{
+  hs_node_state_t node[HS_NODE_COUNT];
+} hs_t;
+
+void     Hs_Init(hs_t *hs);
+
+/* One step at now_ms: starts, checks and repeats the handshakes; request
+ * frames go to msgs (at most room; the rest on the next step). Returns the
+ * frame count. */
+uint32_t Hs_Service(hs_t *hs, const app_inputs_t *in, uint32_t now_ms, can_msg_t *msgs, uint32_t room);
+
+/* 1 when every HS_REQUIRED node is READY. */
+uint8_t  Hs_RequiredReady(const hs_t *hs);
+
+/* Bit per hs_node_id_t: READY nodes / FAILED nodes. */
+uint32_t Hs_ReadyMask(const hs_t *hs);
+uint32_t Hs_FailedMask(const hs_t *hs);
+
+#endif /* HANDSHAKE_H */
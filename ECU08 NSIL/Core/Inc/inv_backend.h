@@ -0,0 +1,68 @@
+#ifndef INV_BACKEND_H
+#define INV_BACKEND_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "inverters.h"
+#include "bamocar.h"
+#include "epl.h"
+
+/* Inverter protocol, chosen at compile time:
+ *   INV_BACKEND_BAMOCAR  BAMOCAR D3, register subscriptions (bamocar.h)
+ *   INV_BACKEND_EPL      ePowerLabs, TX_STATE / RX_SETPOINT frames (epl.h)
+ * Build with -DINV_BACKEND=INV_BACKEND_EPL for the ePowerLabs drive.
+ *
+ * Both decode into the shared inverter model (inv_fb_t through
+ * Inv_FbSet), so power limit, derating, vectoring, link supervision and
+ * diagnostics do not know which drive is fitted. The CAN parser and the
+ * control step only call the InvBk_* wrappers below, which inline to the
+ * selected backend; the other backend's .c compiles to nothing. The SIL
+ * build defines INV_BACKEND_ALL to test both decoders in one binary. */
+
+#define INV_BACKEND_BAMOCAR  1
+#define INV_BACKEND_EPL      2
+
+#ifndef INV_BACKEND
+#define INV_BACKEND  INV_BACKEND_BAMOCAR
+#endif
+
+#if INV_BACKEND == INV_BACKEND_EPL
+#define INV_BK_SETUP_MSGS   0u               /* the drive streams unasked   */
+#define INV_BK_CMD_FRAMES   EPL_CMD_FRAMES   /* control word + torque       */
+#define INV_BK_CMD_IDS      EPL_SP_FRAMES    /* cmd_id .. cmd_id + 5        */
+#define INV_BK_FB_IDS       EPL_TX_FRAMES    /* fb_id .. fb_id + 8          */
+#elif INV_BACKEND == INV_BACKEND_BAMOCAR
+#define INV_BK_SETUP_MSGS   BAMO_REG_COUNT   /* READ subscriptions          */
+#define INV_BK_CMD_FRAMES   1u
+#define INV_BK_CMD_IDS      1u
+#define INV_BK_FB_IDS       1u
+#else
+#error "INV_BACKEND: INV_BACKEND_BAMOCAR or INV_BACKEND_EPL"
+#endif
+
+/* Decodes m if it comes from a layout inverter. Returns the shared model
+ * fields it updated (bit per inv_fb_field_t), 0 if it is not an inverter
+ * frame of this backend. */
+static inline uint16_t InvBk_Decode(const can_msg_t *m, app_inputs_t *st, uint32_t now_ms)
+{
+#if INV_BACKEND == INV_BACKEND_EPL
+  return Epl_Decode(m, st, now_ms);
+#else
+  const int k = Inv_IndexByFeedbackId(m->id);
+  return (k >= 0) ? Bamo_Decode(m, st, (uint8_t)k, now_ms) : 0u;
+#endif
+}
+
+/* Torque command of drive nd (pct of its torque, negative = regen):
+ * INV_BK_CMD_FRAMES frames into msgs. */
+static inline void InvBk_BuildCmd(const inv_node_t *nd, int16_t torque_pct, can_msg_t *msgs)
+{
+#if INV_BACKEND == INV_BACKEND_EPL
+  Epl_BuildCmd(nd, torque_pct, msgs);
+#else
+  Bamo_BuildCmd(nd, torque_pct, msgs);
+#endif
+}
+
+#endif /* INV_BACKEND_H */
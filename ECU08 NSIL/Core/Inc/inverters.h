@@ -0,0 +1,95 @@
+#ifndef INVERTERS_H
+#define INVERTERS_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+
+/* Inverter layout: how many drives the car has, where they sit and which
+ * CAN IDs they use. Everything per-inverter (feedback decode, link state,
+ * torque allocation, command frames) loops over the active layout with
+ * fixed INV_MAX arrays, so 1WD and 4WD run the same code path.
+ *
+ * Index order is the app_inputs_t inv[] / control_out_t motor_pct[] order.
+ * The default layout is the current car: one BAMOCAR on the rear axle
+ * (one ePowerLabs drive in INV_BACKEND_EPL builds, inv_backend.h). */
+
+typedef enum
+{
+  INV_AXLE_FRONT = 0,
+  INV_AXLE_REAR  = 1
+} inv_axle_t;
+
+typedef struct
+{
+  can_bus_t bus;
+  uint32_t  cmd_id;        /* torque command (EPL: RX_SETPOINT_1)         */
+  uint32_t  req_id;        /* BAMOCAR READ requests (rxID)                */
+  uint32_t  fb_id;         /* register responses (txID; EPL: TX_STATE_1)  */
+  int8_t    side;          /* -1 left, +1 right, 0 centre (single motor)  */
+  uint8_t   axle;          /* inv_axle_t                                  */
+} inv_node_t;
+
+typedef struct
+{
+  uint8_t    count;        /* 1..INV_MAX                                  */
+  float      front_share;  /* fraction of the total request on the front  */
+  inv_node_t node[INV_MAX];
+} inv_layout_t;
+
+extern const inv_layout_t INV_LAYOUT_1WD;
+extern const inv_layout_t INV_LAYOUT_4WD;
+extern const inv_layout_t INV_LAYOUT_EPL;   /* INV_BACKEND_EPL builds */
+
+/* Selects the layout (NULL or an invalid count → the backend's default,
+ * INV_LAYOUT_1WD or INV_LAYOUT_EPL). Set once at startup, before the
+ * control and CAN tasks run. */
+void                Inv_SetLayout(const inv_layout_t *layout);
+const inv_layout_t *Inv_GetLayout(void);
+
+/* Layout index of the inverter answering on fb_id, or -1. */
+int                 Inv_IndexByFeedbackId(uint32_t fb_id);
+
+/* Recomputes the legacy scalar inv_* field for one quantity from inv[]:
+ * rpm = mean, current = sum, temperatures = max (hottest drive), state =
+ * highest code. Only inverters that have reported that field take part.
+ * The other fields have no scalar (the drives' DC link reading included:
+ * inv_dc_bus_voltage is the ACU's). */
+void                Inv_Aggregate(app_inputs_t *st, inv_fb_field_t field);
+
+/* Backend entry into the shared model: stores v in field of inv[k],
+ * stamps it (fld_seen, fld_tick, seen, rx_tick) and refreshes the scalar. */
+void                Inv_FbSet(app_inputs_t *st, uint8_t k, inv_fb_field_t field, int16_t v, uint32_t now_tick);
+
+/* Current value of one field of a drive (0 if never reported). */
+int16_t             Inv_FbGet(const inv_fb_t *fb, inv_fb_field_t field);
+
+/* Per-inverter link state machine, stepped by the control task:
+ *   IDLE       → SUBSCRIBED  cyclic reads requested (first control step)
+ *   SUBSCRIBED → ONLINE      first fresh response
+ *   ONLINE     → LOST        no response for INV_FB_TIMEOUT_MS
+ *   LOST       → ONLINE      responses again
+ * A LOST drive gets zero torque. Its registers are re-armed one by one by
+ * the subscription engine as they go silent (bamocar.h), the link only
+ * decides who is commanded. A drive that never answered stays SUBSCRIBED
+ * and is still commanded, as the single-inverter firmware always was. */
+#define INV_FB_TIMEOUT_MS   100u
+
+typedef enum
+{
+  INV_LINK_IDLE = 0,
+  INV_LINK_SUBSCRIBED,
+  INV_LINK_ONLINE,
+  INV_LINK_LOST
+} inv_link_state_t;
+
+typedef struct
+{
+  uint8_t  state;          /* inv_link_state_t                            */
+} inv_link_t;
+
+void    Inv_LinkInit(inv_link_t *lk);
+void    Inv_LinkSubscribed(inv_link_t *lk);
+void    Inv_LinkUpdate(inv_link_t *lk, const inv_fb_t *fb, uint32_t now_tick);
+
+#endif /* INVERTERS_H */
@@ -0,0 +1,110 @@
+#ifndef ISOTP_H
+#define ISOTP_H
+
+#include <stdint.h>
+#include "can.h"
+
+/* ISO 15765-2 transport (ISO-TP), normal addressing, classic CAN frames
+ * padded to 8 bytes.
+ *
+ * Zero copy: messages live in a static pool of ISOTP_POOL_BUFS buffers of
+ * ISOTP_MAX_PAYLOAD bytes. Reassembly writes the frame payloads straight
+ * into a pool buffer that Isotp_Receive() hands to the upper layer; the
+ * upper layer builds its answer in another pool buffer and Isotp_Send()
+ * segments it in place. The only copies are the 7-byte frame payloads.
+ *
+ * Flow control we send while receiving: bs/stmin of the link,
+ * ISOTP_DEFAULT_BS / ISOTP_DEFAULT_STMIN unless changed. 0/0 (no further
+ * FC, back to back) is the fastest setting and safe here: a 500 kbit/s
+ * bus carries at most ~4.4 frames/ms, the 128-deep RX queue absorbs
+ * ~29 ms of that and CanRxTask drains it every 5 ms.
+ *
+ * A link is driven from one task only (CanRxTask). The pool is shared by
+ * all links of that task. Time is in microseconds (CtrlExec_NowUs). */
+
+#define ISOTP_MAX_PAYLOAD    4095u    /* 12-bit first frame length          */
+#define ISOTP_POOL_BUFS      6u
+#define ISOTP_PAD            0xCCu
+
+#define ISOTP_DEFAULT_BS     0u       /* consecutive frames per FC, 0 = all */
+#define ISOTP_DEFAULT_STMIN  0u       /* ms (0x00-0x7F) or 0xF1-0xF9 = 100-900 us */
+
+#define ISOTP_TIMEOUT_US     1000000u /* N_Bs (FC wait), N_Cr (CF wait)     */
+#define ISOTP_MAX_WFT        8u       /* FC WAIT frames accepted in a row   */
+
+/* Frame sink: 0 = queued, else full (the frame is retried on the next
+ * Isotp_Poll). */
+typedef int (*isotp_tx_fn_t)(const can_msg_t *m);
+
+typedef struct
+{
+  uint32_t rx_msgs;        /* messages reassembled                        */
+  uint32_t tx_msgs;        /* messages fully sent                         */
+  uint32_t rx_errors;      /* wrong SN, N_Cr timeout, no buffer, overrun  */
+  uint32_t tx_errors;      /* N_Bs timeout, overflow / bad FC             */
+  uint32_t fc_sent;
+  uint32_t fc_received;
+} isotp_stats_t;
+
+typedef struct
+{
+  can_bus_t      bus;
+  uint32_t       tx_id;
+  uint32_t       rx_id;
+  isotp_tx_fn_t  tx;
+  uint8_t        bs;          /* flow control sent while receiving        */
+  uint8_t        stmin;
+
+  /* Reception */
+  uint8_t        rx_state;
+  uint8_t        rx_sn;
+  uint8_t        rx_bs_cnt;
+  uint8_t       *rx_buf;
+  uint16_t       rx_len;
+  uint16_t       rx_pos;
+  uint32_t       rx_t_us;
+  uint8_t       *msg;         /* complete, not yet taken by Isotp_Receive */
+  uint16_t       msg_len;
+  uint8_t        fc_pending;  /* FC to send (0 = none, else FS + 1)       */
+
+  /* Transmission */
+  uint8_t        tx_state;
+  uint8_t        tx_sn;
+  uint8_t        tx_bs;
+  uint8_t        tx_bs_cnt;
+  uint8_t        tx_wft;
+  uint8_t       *tx_buf;
+  uint16_t       tx_len;
+  uint16_t       tx_pos;
+  uint32_t       tx_stmin_us;
+  uint32_t       tx_t_us;     /* FC wait start / earliest next CF         */
+
+  isotp_stats_t  stats;
+} isotp_link_t;
+
+/* Pool */
+uint8_t *Isotp_BufAlloc(void);
+void     Isotp_BufFree(uint8_t *buf);
+uint32_t Isotp_BufFreeCount(void);
+
+void     Isotp_Init(isotp_link_t *lk, can_bus_t bus, uint32_t tx_id, uint32_t rx_id,
+                    isotp_tx_fn_t tx);
+/* Drops any message in progress and returns its buffers to the pool. */
+void     Isotp_Reset(isotp_link_t *lk);
+
+/* Feeds a received frame. Returns 1 if it belonged to the link. */
+int      Isotp_OnFrame(isotp_link_t *lk, const can_msg_t *m, uint32_t now_us);
+
+/* Complete message (pool buffer, free it with Isotp_BufFree) or NULL. */
+uint8_t *Isotp_Receive(isotp_link_t *lk, uint16_t *len);
+
+/* Takes ownership of a pool buffer and starts sending it. -1 if a message
+ * is still in flight or len is 0 / too long (the buffer is freed). */
+int      Isotp_Send(isotp_link_t *lk, uint8_t *buf, uint16_t len, uint32_t now_us);
+uint8_t  Isotp_TxBusy(const isotp_link_t *lk);
+
+/* Pending flow control, consecutive frames (at most `budget`), timeouts.
+ * Returns the number of frames queued. */
+uint32_t Isotp_Poll(isotp_link_t *lk, uint32_t now_us, uint32_t budget);
+
+#endif /* ISOTP_H */
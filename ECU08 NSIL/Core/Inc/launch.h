@@ -0,0 +1,93 @@
+#ifndef LAUNCH_H
+#define LAUNCH_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Launch control for acceleration runs.
+ *   OFF    --DASH_INPUT_1 edge, stationary, brake held-->  ARMED
+ *   ARMED  --brake released, pedal >= go-->                ACTIVE
+ *   ACTIVE --duration elapsed / pedal lift / brake /
+ *            EV2.3 latch / DASH_INPUT_2-->                 OFF
+ * DASH_INPUT_2 or rolling away also disarms ARMED.
+ *
+ * While ACTIVE the stage owns the torque request (fast path, no slew
+ * limiter): a precomputed open-loop torque profile minus a proportional
+ * correction on (inv_rpm - target rpm), where the target rpm table is the
+ * ideal acceleration curve plus the target slip. Both tables are built
+ * in Launch_Init() and again by Launch_SetCfg() when the calibration
+ * changes, so each cycle is one table lookup. The power limit
+ * and thermal derating still apply downstream; the EV2.3 latch aborts.
+ *
+ * "Brake held" is s_freno above the calibrated threshold the caller passes
+ * (apps_cal_t.brake_adc, the one EV2.3 and the start sequence use).
+ *
+ * DASH_INPUT_1/2 reach the stage through app_inputs_t.dash_input_1/2, and
+ * nothing on this board samples them yet: the dashboard buttons have no
+ * pin in the CubeMX project. Until they are wired, and their reading is
+ * written to app_state, launch control never arms on the car. The SIL and
+ * the integration tests drive the fields directly. */
+
+#define LAUNCH_TAB_LEN 64u
+
+typedef enum
+{
+  LAUNCH_OFF = 0,
+  LAUNCH_ARMED,
+  LAUNCH_ACTIVE
+} launch_state_t;
+
+typedef struct
+{
+  /* Profile */
+  float duration_s;          /* launch length (table span)                */
+  float torque_start_pct;    /* open-loop torque at t = 0                 */
+  float torque_ramp_s;       /* time to reach 100 %                       */
+  float a_target_mps2;       /* ideal vehicle acceleration                */
+  float slip_target;         /* (wheel - vehicle) / vehicle               */
+  float rpm_offset;          /* target rpm at t = 0 (initial wheel spin)  */
+  float gear;                /* motor:wheel ratio                         */
+  float r_wheel_m;
+
+  /* Slip loop */
+  float kp_pct_per_rpm;      /* torque cut per rpm above target           */
+
+  /* Entry / exit */
+  int16_t  rpm_standstill;   /* |inv_rpm| below this counts as stopped    */
+  uint16_t throttle_go_pct;  /* driver request that triggers the launch   */
+  uint16_t throttle_abort_pct; /* lifting below this aborts               */
+} launch_cfg_t;
+
+typedef struct
+{
+  launch_state_t state;
+  uint8_t  dash1_prev;
+  float    t_s;                          /* time since launch              */
+  float    rpm_err;                      /* last inv_rpm - target          */
+  uint16_t torque_pct;                   /* last launch torque             */
+  uint8_t  tab_stale;                    /* cfg changed during a launch    */
+
+  /* Precomputed at Init, LAUNCH_TAB_LEN points over duration_s */
+  float    tab_inv_dt;                   /* 1 / table step                 */
+  float    tab_torque_pct[LAUNCH_TAB_LEN];
+  float    tab_rpm[LAUNCH_TAB_LEN];
+} launch_t;
+
+extern const launch_cfg_t LAUNCH_CFG_DEFAULT;
+
+/* Resets to OFF and builds the profile tables from cfg. */
+void Launch_Init(launch_t *lc, const launch_cfg_t *cfg);
+
+/* New profile for an initialised lc: rebuilds the tables and keeps the
+ * state machine (an ARMED launch stays armed). During a launch the running
+ * profile is kept and the rebuild happens when it ends. */
+void Launch_SetCfg(launch_t *lc, const launch_cfg_t *cfg);
+
+/* Runs the state machine. Returns 1 while ACTIVE, with *torque_pct replaced
+ * by the launch request; otherwise returns 0 and leaves it untouched.
+ * brake_adc is the pressed-brake threshold; driver_pct is the mapped pedal
+ * torque (EV2.3 already applied). */
+uint8_t Launch_Update(launch_t *lc, const launch_cfg_t *cfg, const app_inputs_t *in,
+                      uint16_t brake_adc, uint16_t driver_pct, uint8_t ev23, float dt_s, uint16_t *torque_pct);
+
+#endif /* LAUNCH_H */
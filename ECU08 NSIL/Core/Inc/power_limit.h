@@ -0,0 +1,64 @@
+#ifndef POWER_LIMIT_H
+#define POWER_LIMIT_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Power limiter (FS rules: 80 kW at the accumulator).
+ * Runs after torque mapping every control cycle:
+ *   T_lim = (P_target + Kp*e + I) * eff / w,   e = P_target - P_est
+ * The feedforward reacts immediately to motor speed; the PI trim corrects
+ * the feedforward using the electrical power measured from the drives'
+ * feedback. The trim acts in the power domain so the loop gain does not
+ * grow with speed.
+ *
+ * Measured power, per drive:
+ *  - V_dc * I_dc where the drive reports DC link current (INV_FB_I_DC,
+ *    ePowerLabs);
+ *  - otherwise from its phase current (INV_FB_I_ACTUAL, BAMOCAR 0x5F,
+ *    peak amplitude): kt * I * w / eff, the torque it actually produces,
+ *    capped at sqrt(3)/2 * V_dc * I, the most a drive can draw for that
+ *    current under space-vector modulation. In field weakening kt * I
+ *    overstates torque and the cap takes over; both err on the high side.
+ * The BAMOCAR path sees the drive's torque, not its losses: eff must be
+ * calibrated, the trim cannot correct it. */
+
+typedef struct
+{
+  float p_max_w;        /* hard limit (rules)                             */
+  float p_margin_w;     /* controller targets p_max_w - p_margin_w        */
+  float t_max_nm;       /* motor torque at torque_pct = 100               */
+  float eff;            /* motor + inverter efficiency for feedforward    */
+  float kp;             /* proportional trim gain [W/W]                   */
+  float ki_per_s;       /* integral trim gain [1/s]                       */
+  float trim_max_w;     /* |integral trim| clamp (anti-windup)            */
+  float w_min_rad_s;    /* below this speed the feedforward is inactive   */
+  float kt_nm_per_a;    /* motor torque per A of phase current (peak),
+                           0 = ignore phase current                        */
+} power_limit_cfg_t;
+
+typedef struct
+{
+  float   trim_w;       /* PI integrator state                             */
+  float   p_est_w;      /* last electrical power estimate                  */
+  float   t_limit_nm;   /* last torque limit                               */
+  float   t_cmd_nm;     /* last output torque                              */
+  uint8_t active;       /* 1 if the limit clipped the request this cycle   */
+} power_limit_t;
+
+extern const power_limit_cfg_t POWER_LIMIT_CFG_DEFAULT;
+
+void PowerLimit_Init(power_limit_t *pl);
+
+/* Electrical power estimate [W]: max of the measured power (summed over
+ * the drives, see above) and the mechanical power of the previous command
+ * over the efficiency (covers a stale reading). With no current reading
+ * at all it is the mechanical power alone. */
+float PowerLimit_EstimateW(const power_limit_cfg_t *cfg, const app_inputs_t *in, float t_cmd_nm);
+
+/* Clamps torque_pct (0..100) so that the estimated power stays below the
+ * target. dt_s is the control period. */
+uint16_t PowerLimit_Apply(power_limit_t *pl, const power_limit_cfg_t *cfg,
+                          const app_inputs_t *in, uint16_t torque_pct, float dt_s);
+
+#endif /* POWER_LIMIT_H */
@@ -0,0 +1,53 @@
+#ifndef REGEN_H
+#define REGEN_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "torque_slew.h"
+
+/* Regenerative braking. Brake pedal travel above the mechanical threshold
+ * maps to a negative torque request, faded out at low motor speed and
+ * limited by:
+ *   - the charge current: T <= I_chg_max * V_dc / (eff * w),
+ *   - cell voltage: taper to 0 as v_celda_min approaches full charge.
+ * The request has its own slew limiter, so it blends in and out smoothly
+ * against the driver's drive torque (regen is only requested while the
+ * drive torque is 0). */
+
+typedef struct
+{
+  float t_max_nm;          /* motor torque at 100 %                       */
+  float max_pct;           /* regen torque at full pedal (magnitude)      */
+  uint16_t brake_start_adc;/* s_freno where regen starts                  */
+  uint16_t brake_full_adc; /* s_freno for max_pct                         */
+  float rpm_fade_lo;       /* no regen below                              */
+  float rpm_fade_hi;       /* full regen above                            */
+  float i_chg_max_a;       /* accumulator charge current limit            */
+  float eff;               /* motor + inverter efficiency (generating)    */
+  uint16_t v_cell_taper_mv;/* regen starts tapering at this min cell V    */
+  uint16_t v_cell_full_mv; /* no regen from here                          */
+  torque_slew_cfg_t slew;  /* blend-in / blend-out shaping                */
+} regen_cfg_t;
+
+typedef struct
+{
+  torque_slew_t slew;
+  float   target_pct;      /* last request before shaping (magnitude)     */
+  float   limit_pct;       /* last current/voltage limit (magnitude)      */
+  uint16_t regen_pct;      /* shaped regen magnitude                      */
+} regen_t;
+
+extern const regen_cfg_t REGEN_CFG_DEFAULT;
+
+void Regen_Init(regen_t *rg);
+
+/* Regen torque limit (magnitude, 0..max_pct) from charge current, cell
+ * voltage and speed. */
+float Regen_LimitPct(const regen_cfg_t *cfg, const app_inputs_t *in);
+
+/* Blends regen into the shaped drive torque: returns drive_pct - regen,
+ * in -100..100 (negative = regen). */
+int16_t Regen_Apply(regen_t *rg, const regen_cfg_t *cfg, const app_inputs_t *in,
+                    uint16_t drive_pct, float dt_s);
+
+#endif /* REGEN_H */
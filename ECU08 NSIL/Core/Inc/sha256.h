@@ -0,0 +1,23 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+
+/* SHA-256 (FIPS 180-4), incremental. Used to verify firmware images; the
+ * host uploader links the same file. */
+
+#define SHA256_DIGEST_LEN  32u
+
+typedef struct
+{
+  uint32_t h[8];
+  uint64_t total;          /* bytes hashed                                 */
+  uint8_t  block[64];
+  uint32_t fill;
+} sha256_ctx_t;
+
+void Sha256_Init(sha256_ctx_t *c);
+void Sha256_Update(sha256_ctx_t *c, const void *data, uint32_t len);
+void Sha256_Final(sha256_ctx_t *c, uint8_t out[SHA256_DIGEST_LEN]);
+
+#endif /* SHA256_H */
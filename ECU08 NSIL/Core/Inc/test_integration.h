@@ -20,6 +20,23 @@
  *   S8  – Pipeline completo: sensor → control → CAN → telemetría
  *   S9  – Concurrencia FreeRTOS (sin deadlocks, sin race conditions)
  *   S10 – Estrés y casos límite
+ *   S11 – Ejecutivo de control TIM16 (jitter / overrun)
+ *   S12 – Límite de potencia 80 kW (feedforward + trim PI)
+ *   S13 – Derating térmico motor / IGBT / aire
+ *   S14 – Limitador de pendiente / jerk de par
+ *   S15 – Frenada regenerativa (límites de carga)
+ *   S16 – Launch control (armado, perfil, anulación)
+ *   S17 – Velocidad de rueda y control de tracción
+ *   S18 – IMU BMI088 (FIFO, marcas de tiempo, publicación)
+ *   S19 – Estimador de estado del vehículo (Kalman 2 estados)
+ *   S20 – N inversores: reparto, vectorización de par, enlace, ráfaga
+ *   S21 – Contextos de control reentrantes y checkpoint
+ *   S22 – Almacén de calibración (tabla, banco A/B, flash)
+ *   S23 – Frescura de señales CAN (timeout, corte de par)
+ *   S24 – Suscripción cíclica BAMOCAR (armado, tabla REGID, re-armado)
+ *   S25 – Backend ePowerLabs (TX_STATE al modelo, RX_SETPOINT)
+ *   S26 – Handshakes de arranque (concurrentes, reintentos, diagnóstico)
+ *   S27 – Mapa de IDs CAN (tabla en calibración, validación, hash de RX)
  ******************************************************************************
  */
 
@@ -44,7 +61,7 @@ extern "C" {
 #endif
 
 /* -------------------------------------------------------------------------- */
-/* CONSTANTES DE PROYECTO (alineadas con VCU.h / can.c)                      */
+/* CONSTANTES DE PROYECTO (alineadas con VCU.h / can_map.c por defecto)       */
 /* -------------------------------------------------------------------------- */
 
 /* IDs CAN Inversor BAMOCAR (desde perspectiva ECU) */
@@ -52,6 +69,7 @@ extern "C" {
 #define TINT_TXID_INV          0x181u   /* ECU envía al inversor              */
 
 /* IDs CAN estados inversor (TX_STATE_x del inversor) */
+#define TINT_TX_STATE_1        0x460u
 #define TINT_TX_STATE_2        0x461u
 #define TINT_TX_STATE_4        0x463u
 #define TINT_TX_STATE_5        0x464u
@@ -66,6 +84,15 @@ extern "C" {
 #define TINT_ID_S_FRENO        0x103u
 #define TINT_ID_V_CELDA_MIN    0x12Cu
 
+/* Handshakes de arranque (ok del VCU / ack del nodo) */
+#define TINT_ID_OK_TELEMETRIA  0x0A0u
+#define TINT_ID_ACK_TELEMETRIA 0x030u
+#define TINT_ID_OK_CAJA_NEGRA  0x0B0u
+#define TINT_ID_ACK_CAJA_NEGRA 0x040u
+#define TINT_ID_OK_PANTALLA    0x0E0u
+#define TINT_ID_ACK_PANTALLA   0x050u
+#define TINT_HS_REQS           3u      /* peticiones del primer paso         */
+
 /* Umbrales ADC (del sensor físico, alineados con Control_ComputeTorque) */
 /* s_pct = (raw - 2050) / 9  para s1; raw=2050 → 0%, raw=2950 → 100%  */
 #define TINT_ADC_S1_0PCT       2050u   /* 0% acelerador s1                   */
@@ -136,6 +163,57 @@ uint32_t test_suite_concurrency(void);
 /** S10: Estrés – transiciones rápidas, desbordamiento de cola, 1000ms */
 uint32_t test_suite_stress_testing(void);
 
+/** S11: Ejecutivo de control TIM16 – periodo, jitter, overrun */
+uint32_t test_suite_ctrl_exec(void);
+
+/** S12: Límite de potencia 80 kW – feedforward, trim PI, lectura BAMOCAR */
+uint32_t test_suite_power_limit(void);
+
+/** S13: Derating térmico – curvas, predicción, histéresis, rampa */
+uint32_t test_suite_thermal_derate(void);
+
+/** S14: Limitador de pendiente/jerk – escalón, inversión, corte */
+uint32_t test_suite_torque_slew(void);
+
+/** S15: Frenada regenerativa – mapa freno/velocidad, corriente y celdas */
+uint32_t test_suite_regen(void);
+
+/** S16: Launch control – armado, tablas, deslizamiento, EV2.3 */
+uint32_t test_suite_launch(void);
+
+/** S17: Velocidad de rueda (captura) y control de tracción por deslizamiento */
+uint32_t test_suite_traction(void);
+
+/** S18: IMU BMI088 – decodificación de FIFO, marcas de tiempo, anillo */
+uint32_t test_suite_imu(void);
+
+/** S19: Estimador de estado – bias IMU, velocidad, deslizamiento, guiñada */
+uint32_t test_suite_vehicle_state(void);
+
+/** S20: N inversores – reparto por motor, guiñada, estado de enlace, ráfaga */
+uint32_t test_suite_inverters(void);
+
+/** S21: Contextos de control – independencia, reloj propio, checkpoint */
+uint32_t test_suite_ctrl_ctx(void);
+
+/** S22: Calibración – tabla tipada, cambio A/B en caliente, slots en flash */
+uint32_t test_suite_calib(void);
+
+/** S23: Frescura de señales – marca por trama, timeout, par 0 si caduca */
+uint32_t test_suite_freshness(void);
+
+/** S24: BAMOCAR – armado al arrancar, decodificación por REGID, re-armado */
+uint32_t test_suite_bamocar(void);
+
+/** S25: ePowerLabs – decodificación por tabla de señales, consignas */
+uint32_t test_suite_epl(void);
+
+/** S26: Handshakes – todos a la vez, reintento por nodo, FAILED diagnosticado */
+uint32_t test_suite_handshake(void);
+
+/** S27: Mapa de IDs CAN – tabla desde calibración, rechazo, búsqueda en hash */
+uint32_t test_suite_can_map(void);
+
 #ifdef __cplusplus
 }
 #endif
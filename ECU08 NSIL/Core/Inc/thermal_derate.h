@@ -0,0 +1,77 @@
+#ifndef THERMAL_DERATE_H
+#define THERMAL_DERATE_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Thermal derating: motor, IGBT and inverter air temperatures each map to a
+ * torque limit (0..100 %) through a piecewise-linear curve; the lowest limit
+ * wins. Per channel:
+ *   - prediction: first-order model driven by I^2 and speed gives the
+ *     temperature `horizon_s` ahead; the curve sees max(measured, predicted)
+ *     so derating starts before the hard limit is reached,
+ *   - hysteresis: the curve input only falls once the temperature has dropped
+ *     hyst_c below its last peak (no chatter around a breakpoint),
+ *   - the combined limit is slew-limited (fast down, slow recovery). */
+
+#define THERMAL_CURVE_PTS 4u
+
+typedef enum
+{
+  THERMAL_CH_MOTOR = 0,
+  THERMAL_CH_IGBT,
+  THERMAL_CH_AIR,
+  THERMAL_CH_COUNT
+} thermal_ch_t;
+
+typedef struct
+{
+  /* Curve: temp_c ascending, limit_pct non-increasing. Below temp_c[0] the
+   * limit is limit_pct[0]; above the last point it is the last value. */
+  float temp_c[THERMAL_CURVE_PTS];
+  float limit_pct[THERMAL_CURVE_PTS];
+  float hyst_c;
+
+  /* Rise model: dT/dt = k_i2*I^2 + k_rpm*|n| - (T - t_cool_c)/tau_s.
+   * tau_s = 0 disables prediction for this channel. */
+  float k_i2;           /* degC/s per A^2 (phase current, peak) */
+  float k_rpm;          /* degC/s per rpm              */
+  float tau_s;          /* thermal time constant       */
+  float t_cool_c;       /* coolant / ambient reference */
+} thermal_ch_cfg_t;
+
+typedef struct
+{
+  thermal_ch_cfg_t ch[THERMAL_CH_COUNT];
+  float horizon_s;        /* prediction horizon                      */
+  float rate_down_pct_s;  /* max limit decrease rate                 */
+  float rate_up_pct_s;    /* max limit recovery rate                 */
+} thermal_derate_cfg_t;
+
+typedef struct
+{
+  float   t_pred_c[THERMAL_CH_COUNT];   /* predicted temperature          */
+  float   t_hyst_c[THERMAL_CH_COUNT];   /* curve input after hysteresis   */
+  float   ch_limit_pct[THERMAL_CH_COUNT];
+  float   limit_pct;                    /* slew-limited combined limit    */
+  uint8_t limiting_ch;                  /* lowest channel, COUNT if none */
+  uint8_t active;                       /* 1 if the limit clipped torque  */
+  uint8_t primed;
+} thermal_derate_t;
+
+extern const thermal_derate_cfg_t THERMAL_DERATE_CFG_DEFAULT;
+
+void ThermalDerate_Init(thermal_derate_t *td);
+
+/* Curve lookup (exposed for tests). */
+float ThermalDerate_Curve(const thermal_ch_cfg_t *c, float temp_c);
+
+/* Temperature expected horizon_s from now at the present current and speed. */
+float ThermalDerate_Predict(const thermal_ch_cfg_t *c, float temp_c,
+                            float i_a, float rpm, float horizon_s);
+
+/* Clamps torque_pct to the current thermal limit. dt_s is the control period. */
+uint16_t ThermalDerate_Apply(thermal_derate_t *td, const thermal_derate_cfg_t *cfg,
+                             const app_inputs_t *in, uint16_t torque_pct, float dt_s);
+
+#endif /* THERMAL_DERATE_H */
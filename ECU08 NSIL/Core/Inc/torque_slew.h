@@ -0,0 +1,40 @@
+#ifndef TORQUE_SLEW_H
+#define TORQUE_SLEW_H
+
+#include <stdint.h>
+
+/* Torque slew-rate and jerk limiter, last stage of the torque pipeline.
+ * The output moves toward the request at most rise_pct_s (up) or
+ * fall_pct_s (down); the rate itself builds up at most jerk_pct_s2 so a
+ * step starts with an S-curve instead of a kink (driveline backlash,
+ * inverter current spikes). Slowing down or stopping at the target is
+ * immediate, so the output never overshoots. Constant work per call, for
+ * any control period. A cut (EV2.3 latch, brake) zeroes the output and the
+ * rate in the same cycle. */
+
+typedef struct
+{
+  float rise_pct_s;     /* max increase rate          */
+  float fall_pct_s;     /* max decrease rate          */
+  float jerk_pct_s2;    /* max rate build-up          */
+} torque_slew_cfg_t;
+
+typedef struct
+{
+  float value_pct;      /* shaped torque              */
+  float rate_pct_s;     /* current slope              */
+} torque_slew_t;
+
+extern const torque_slew_cfg_t TORQUE_SLEW_CFG_DEFAULT;
+
+void TorqueSlew_Init(torque_slew_t *ts);
+
+/* Re-seeds the limiter at pct with zero slope, for stages that bypass it
+ * (launch control) so that handing back control causes no step. */
+void TorqueSlew_Track(torque_slew_t *ts, uint16_t pct);
+
+/* Returns the shaped torque (0..100). cut != 0 forces 0 immediately. */
+uint16_t TorqueSlew_Apply(torque_slew_t *ts, const torque_slew_cfg_t *cfg,
+                          uint16_t target_pct, uint8_t cut, float dt_s);
+
+#endif /* TORQUE_SLEW_H */
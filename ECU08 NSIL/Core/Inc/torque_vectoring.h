@@ -0,0 +1,49 @@
+#ifndef TORQUE_VECTORING_H
+#define TORQUE_VECTORING_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "inverters.h"
+#include "vehicle_state.h"
+
+/* Per-motor torque allocation for N inverters. The signed total request
+ * (-100..100 % of the car, after regen blending) is split by axle
+ * (front_share), then evenly between the available drives of that axle,
+ * in percent of one drive. A drive marked unavailable (link LOST) gets 0
+ * and its axle partner takes the axle share up to 100 %.
+ *
+ * Yaw-moment vectoring on top: a left/right offset
+ *   d = -k_yaw_pct * yaw_err_rad_s      (estimator, gyro - kinematic)
+ * is added on the right and subtracted on the left of every axle with
+ * both sides available, so the axle total is unchanged. d is bounded by
+ * dmax_pct and by every affected drive's headroom: no drive leaves
+ * -100..100 or reverses its sign, so a cut (total 0) stays 0 everywhere.
+ * Off below v_min_mps and with a single centred drive, where the result is
+ * exactly the total. */
+
+typedef struct
+{
+  float k_yaw_pct;         /* offset per rad/s of yaw-rate error          */
+  float dmax_pct;          /* offset ceiling per drive                    */
+  float v_min_mps;         /* no vectoring below                          */
+} torque_vectoring_cfg_t;
+
+typedef struct
+{
+  float   d_pct;           /* last applied left/right offset              */
+  uint8_t avail_mask;      /* drives used in the last allocation          */
+} torque_vectoring_t;
+
+extern const torque_vectoring_cfg_t TORQUE_VECTORING_CFG_DEFAULT;
+
+void TorqueVec_Init(torque_vectoring_t *tv);
+
+/* Fills motor_pct[0..layout->count-1]; entries up to INV_MAX are zeroed.
+ * avail_mask bit k = drive k may be commanded. vs may be NULL (no
+ * vectoring). */
+void TorqueVec_Allocate(torque_vectoring_t *tv, const torque_vectoring_cfg_t *cfg,
+                        const inv_layout_t *layout, uint8_t avail_mask,
+                        int16_t total_pct, const vehicle_state_t *vs,
+                        int16_t motor_pct[INV_MAX]);
+
+#endif /* TORQUE_VECTORING_H */
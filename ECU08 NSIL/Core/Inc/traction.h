@@ -0,0 +1,44 @@
+#ifndef TRACTION_H
+#define TRACTION_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Slip-based traction control. The driven (rear) wheel speed comes from
+ * inv_rpm through the gear ratio, the vehicle reference from the mean of
+ * the undriven front wheels:
+ *   slip = (v_driven - v_ref) / max(v_ref, v_min)
+ * Above slip_target the torque ceiling drops by a proportional term in the
+ * same cycle plus an integral term that holds the cut while the tyre
+ * recovers; below target the integral bleeds off at recover_pct_s. The
+ * ceiling sits after the slew limiter so the cut is never rate-limited.
+ * Inactive (pass-through) while wheel_ok is 0. A few multiplies per call. */
+
+typedef struct
+{
+  float slip_target;       /* allowed slip before cutting                 */
+  float kp_pct;            /* torque cut per unit slip error              */
+  float ki_pct_s;          /* integral build-up per unit slip error       */
+  float recover_pct_s;     /* integral bleed-off below target             */
+  float v_min_mps;         /* slip denominator floor (standstill)         */
+  float gear;              /* motor:wheel ratio                           */
+  float r_wheel_m;
+} traction_cfg_t;
+
+typedef struct
+{
+  float   slip;            /* last computed slip                          */
+  float   i_pct;           /* integral cut                                */
+  float   limit_pct;       /* last torque ceiling (100 = no cut)          */
+  uint8_t active;          /* 1 while cutting                             */
+} traction_t;
+
+extern const traction_cfg_t TRACTION_CFG_DEFAULT;
+
+void Traction_Init(traction_t *tc);
+
+/* Returns the torque request clipped to the traction ceiling. */
+uint16_t Traction_Apply(traction_t *tc, const traction_cfg_t *cfg, const app_inputs_t *in,
+                        uint16_t torque_pct, float dt_s);
+
+#endif /* TRACTION_H */
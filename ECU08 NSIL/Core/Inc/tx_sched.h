@@ -0,0 +1,82 @@
+#ifndef TX_SCHED_H
+#define TX_SCHED_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "control.h"
+#include "can_map.h"
+
+/* Time-triggered schedule of the periodic frames the VCU originates
+ * (ready-to-drive, torque request, inverter data mirrors; VCU.h). IDs
+ * are resolved through the CAN ID map when the table is loaded.
+ *
+ *  - Each frame has a period in 1 ms slots. TxSched_Init gives it a phase
+ *    offset inside its period: frames are placed shortest period first,
+ *    each on the phase whose slots are least loaded by the frames already
+ *    placed (worst slot first, then total). Over the hyperperiod (LCM of
+ *    the periods) the frames are spread as evenly as the periods allow,
+ *    instead of all leaving together at a task wakeup.
+ *  - Driven by one timer tick: the control task calls TxSched_Tick after
+ *    the control step, every TIM16 cycle. Due frames are packed from the
+ *    cycle's snapshot and queued with the control frames; there is no
+ *    task or timer per frame.
+ *  - A tick that comes late sends what is due and keeps the phase (the
+ *    next release stays on its slot); whole periods lost in a gap are
+ *    counted and skipped, not sent in a burst.
+ *
+ * Slots are 1 ms, the default control rate (ctrl_exec.h). At a lower rate
+ * the frames of the slots in between leave together on the next cycle. */
+
+#define TXS_MAX        16u
+#define TXS_HYPER_MAX  1000u   /* ms, LCM of the periods */
+#define TXS_TICK_MAX      4u   /* frames the control task takes per tick */
+
+typedef struct txs_entry_s txs_entry_t;
+
+/* Fills d[0 .. e->dlc - 1] from the cycle's inputs and control output. */
+typedef void (*txs_pack_fn)(const txs_entry_t *e, const app_inputs_t *in,
+                            const control_out_t *out, uint8_t *d);
+
+struct txs_entry_s
+{
+  can_bus_t   bus;
+  uint32_t    id;           /* standard ID or CANMAP_REF, resolved at init */
+  uint8_t     dlc;          /* 0..8                                       */
+  uint8_t     arg;          /* packer argument (inverter mirrors: field)  */
+  uint16_t    period_ms;
+  txs_pack_fn pack;
+};
+
+typedef struct
+{
+  uint32_t hyper_ms;        /* LCM of the periods                         */
+  uint32_t max_load;        /* frames in the busiest slot                 */
+  uint32_t sent;
+  uint32_t late;            /* sent on a later tick than their slot       */
+  uint32_t skipped;         /* releases lost in a gap between ticks       */
+} txs_stats_t;
+
+/* The car's schedule (tx_sched.c) */
+extern const txs_entry_t TXS_TABLE[];
+extern const uint32_t    TXS_TABLE_COUNT;
+
+/* Loads a table (NULL = TXS_TABLE), computes the phases and clears the
+ * counters; the first tick starts the schedule. Returns -1 (and loads
+ * nothing) if it is too long, an entry is malformed, a bus / ID appears
+ * twice or the hyperperiod exceeds TXS_HYPER_MAX. */
+int      TxSched_Init(const txs_entry_t *tab, uint32_t n);
+
+/* Packs into msgs (at most room) the frames due at now_ms. A frame that
+ * does not fit stays due for the next tick. Returns the frame count. */
+uint32_t TxSched_Tick(uint32_t now_ms, const app_inputs_t *in, const control_out_t *out,
+                      can_msg_t *msgs, uint32_t room);
+
+/* Phase of entry i (ms inside its period) and frames released in slot
+ * (0 .. hyper_ms - 1) of the hyperperiod. */
+uint32_t TxSched_Phase(uint32_t i);
+uint32_t TxSched_SlotLoad(uint32_t slot);
+
+void     TxSched_GetStats(txs_stats_t *out);
+
+#endif /* TX_SCHED_H */
@@ -0,0 +1,119 @@
+#ifndef UDS_H
+#define UDS_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "isotp.h"
+
+/* UDS (ISO 14229) diagnostic server on the dashboard bus, over ISO-TP.
+ *
+ *  0x10 DiagnosticSessionControl   default (01) / extended (03), S3 5 s;
+ *                                  programming (02) from extended with the
+ *                                  car stopped: reset into the bootloader
+ *  0x3E TesterPresent
+ *  0x22 ReadDataByIdentifier       app_inputs_t fields (UDS_DIDS, big
+ *                                  endian), 0x01FF whole snapshot (native
+ *                                  layout), 0xF1F0 4092-byte test pattern
+ *  0x19 ReadDTCInformation         01 count, 02 by status mask, 0A all
+ *  0x14 ClearDiagnosticInformation group 0xFFFFFF
+ *  0x31 RoutineControl             extended session only:
+ *                                  0x0201 save calibration to flash,
+ *                                  0x0301 pedal map self-test
+ *
+ * Fault memory: UDS_DTCS are evaluated by Uds_Monitor() (diag task) and
+ * kept in RAM with the ISO 14229 status byte; a fault is confirmed after
+ * UDS_DTC_CONFIRM failing runs in a row. Not persisted.
+ *
+ * Uds_Rx()/Uds_Service() run in CanRxTask. The response is built in an
+ * ISO-TP pool buffer and segmented in place. Consecutive frames go out
+ * from Uds_Service(), at most as many per call as the dashboard TX FIFO
+ * can take with canTxQueue's backlog (UDS_TX_FIFO_SHARE), so diagnostics
+ * never push the control frames out of the hardware FIFO. */
+
+#define UDS_REQ_ID          0x7E0u   /* physical request                   */
+#define UDS_RSP_ID          0x7E8u   /* response                           */
+#define UDS_FUNC_ID         0x7DFu   /* functional request (single frame) */
+
+#define UDS_S3_US           5000000u /* extended session → default        */
+#define UDS_P2_MS           50u
+#define UDS_P2_EXT_MS       5000u
+#define UDS_TX_FIFO_SHARE   12u      /* of the 16 FDCAN3 TX FIFO elements  */
+
+#define UDS_DID_SNAPSHOT    0x01FFu
+#define UDS_DID_PATTERN     0xF1F0u
+#define UDS_PATTERN_LEN     (ISOTP_MAX_PAYLOAD - 3u)
+
+#define UDS_RID_CALIB_SAVE  0x0201u
+#define UDS_RID_APPS_TEST   0x0301u
+
+#define UDS_DTC_CONFIRM     3u
+
+/* Negative response codes */
+#define UDS_NRC_SERVICE_NOT_SUPPORTED      0x11u
+#define UDS_NRC_SUBFUNCTION_NOT_SUPPORTED  0x12u
+#define UDS_NRC_INCORRECT_LENGTH           0x13u
+#define UDS_NRC_RESPONSE_TOO_LONG          0x14u
+#define UDS_NRC_CONDITIONS_NOT_CORRECT     0x22u
+#define UDS_NRC_REQUEST_SEQUENCE_ERROR     0x24u
+#define UDS_NRC_REQUEST_OUT_OF_RANGE       0x31u
+#define UDS_NRC_NOT_IN_ACTIVE_SESSION      0x7Fu
+
+/* DTC status bits (ISO 14229-1 D.2) */
+#define UDS_DTC_TEST_FAILED                0x01u
+#define UDS_DTC_FAILED_THIS_CYCLE          0x02u
+#define UDS_DTC_PENDING                    0x04u
+#define UDS_DTC_CONFIRMED                  0x08u
+#define UDS_DTC_NOT_COMPLETED_SINCE_CLEAR  0x10u
+#define UDS_DTC_FAILED_SINCE_CLEAR         0x20u
+#define UDS_DTC_NOT_COMPLETED_THIS_CYCLE   0x40u
+#define UDS_DTC_AVAILABILITY               0x7Fu
+
+typedef struct
+{
+  uint16_t did;
+  uint16_t offset;        /* in app_inputs_t                               */
+  uint8_t  size;          /* element size: 1, 2 or 4                       */
+  uint8_t  count;         /* elements (arrays)                             */
+} uds_did_t;
+
+extern const uds_did_t UDS_DIDS[];
+extern const uint32_t  UDS_DID_COUNT;
+
+typedef struct
+{
+  uint32_t code;          /* 3-byte DTC                                    */
+  const char *name;
+} uds_dtc_t;
+
+extern const uds_dtc_t UDS_DTCS[];
+extern const uint32_t  UDS_DTC_COUNT;
+
+typedef struct
+{
+  uint32_t requests;
+  uint32_t negative;
+  uint32_t bytes_out;     /* response payload bytes                        */
+  uint8_t  session;       /* 1 default, 3 extended                         */
+} uds_stats_t;
+
+/* Link on UDS_REQ_ID/UDS_RSP_ID, default session, fault memory cleared,
+ * frames to canTxQueue. */
+void Uds_Init(void);
+void Uds_SetTransport(isotp_tx_fn_t tx);   /* NULL = canTxQueue */
+
+/* CanRxTask: returns 1 if m was a diagnostic request frame. */
+int  Uds_Rx(const can_msg_t *m, uint32_t now_us);
+
+/* CanRxTask, every pass: pending requests, flow control, consecutive
+ * frames (at most `budget`; UINT32_MAX = derive it from canTxQueue),
+ * session timeout. */
+void Uds_Service(uint32_t now_us, uint32_t budget);
+
+/* Diag task: runs the DTC tests against a snapshot of the inputs. */
+void Uds_Monitor(const app_inputs_t *in);
+
+uint8_t Uds_GetDtcStatus(uint32_t index);
+void    Uds_GetStats(uds_stats_t *out);
+isotp_link_t *Uds_Link(void);
+
+#endif /* UDS_H */
@@ -0,0 +1,62 @@
+#ifndef VEHICLE_STATE_H
+#define VEHICLE_STATE_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Vehicle state estimator: two-state Kalman filter, x = [v, b_ax].
+ *   predict:  v += (ax_imu - b_ax) * dt          (IMU longitudinal accel)
+ *   update:   front wheel mean (undriven, trusted)
+ *             inv_rpm through the gear (driven wheel, variance inflated by
+ *             R + k*innovation^2 and ignored outside an innovation gate, so
+ *             wheelspin and lock-up do not drag the estimate; it corrects
+ *             the speed only, never the bias, which a slipping wheel would
+ *             teach wrong)
+ * Scalar sequential updates, 2x2 covariance written out by hand: no matrix
+ * library, no division by a matrix, no allocation. A missing source (wheel_ok
+ * or imu_ok clear) only swaps its variance for a huge one, so every call runs
+ * the same instructions whatever the inputs.
+ *
+ * Outputs each cycle: vehicle speed, longitudinal slip of the driven axle
+ * and yaw-rate error (gyro minus the kinematic yaw rate from the front wheel
+ * speed difference). */
+
+typedef struct
+{
+  float gear;              /* motor:wheel ratio                          */
+  float r_wheel_m;
+  float track_m;           /* front track, kinematic yaw rate            */
+  float q_v;               /* speed process noise with IMU [(m/s)^2/s]   */
+  float q_v_no_imu;        /* same, IMU missing (constant-speed model)   */
+  float q_b;               /* accel bias random walk [(m/s^2)^2/s]       */
+  float r_wheel;           /* front wheel speed variance [(m/s)^2]       */
+  float r_motor;           /* driven wheel speed variance                */
+  float k_motor;           /* innovation^2 gain on r_motor               */
+  float gate_mps;          /* motor innovation gate: gate_mps +          */
+  float gate_rel;          /*   gate_rel * v, beyond it = ignored        */
+  float r_missing;         /* variance used for a missing source         */
+  float v_min_mps;         /* slip denominator floor                     */
+} vehicle_state_cfg_t;
+
+typedef struct
+{
+  /* Filter */
+  float v_mps;             /* estimated vehicle speed                    */
+  float b_ax;              /* estimated IMU longitudinal bias [m/s^2]    */
+  float p00, p01, p11;     /* covariance (symmetric)                     */
+
+  /* Outputs */
+  float slip;              /* (v_driven - v) / max(v, v_min)             */
+  float yaw_rate_rad_s;    /* gyro z (0 without IMU)                     */
+  float yaw_err_rad_s;     /* gyro z - kinematic (0 if either missing)   */
+} vehicle_state_t;
+
+extern const vehicle_state_cfg_t VEHICLE_STATE_CFG_DEFAULT;
+
+void VehState_Init(vehicle_state_t *vs);
+
+/* One estimator step; constant execution time. */
+void VehState_Update(vehicle_state_t *vs, const vehicle_state_cfg_t *cfg,
+                     const app_inputs_t *in, float dt_s);
+
+#endif /* VEHICLE_STATE_H */
@@ -0,0 +1,60 @@
+#ifndef WHEEL_SPEED_H
+#define WHEEL_SPEED_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+/* Front (undriven) wheel speeds from hall sensors on TIM2 input capture:
+ * CH1 = PA0 front-left, CH2 = PA1 front-right. TIM2 is 32-bit and counts at
+ * 1 MHz, so a tooth period is a single subtraction with no overflow
+ * handling. The capture ISR converts period to speed (one integer division)
+ * and the control task only reads the result.
+ *
+ * Alternative source: a CAN hub node (ID_WHEEL_FRONT in can.c) writes the
+ * same app_inputs_t fields; set WHEEL_SPEED_USE_CAPTURE to 0 then. */
+
+#ifndef WHEEL_SPEED_USE_CAPTURE
+#define WHEEL_SPEED_USE_CAPTURE  1
+#endif
+
+#define WHEEL_SPEED_TEETH        20u        /* trigger wheel teeth          */
+#define WHEEL_SPEED_R_WHEEL_M    0.23f
+#define WHEEL_SPEED_TIM_CLK_HZ   1000000u   /* capture tick = 1 us          */
+#define WHEEL_SPEED_TIMEOUT_US   250000u    /* no edge for this long → 0    */
+#define WHEEL_SPEED_MIN_PERIOD_US 100u      /* shorter = noise (> 70 m/s)   */
+#define WHEEL_SPEED_STILL_RPM    50u        /* |inv_rpm| below: standstill  */
+
+typedef enum
+{
+  WHEEL_FL = 0,
+  WHEEL_FR,
+  WHEEL_N
+} wheel_id_t;
+
+void     WheelSpeed_Init(void);
+
+/* Configures TIM2 CH1/CH2 capture and its IRQ (firmware only). */
+void     WheelSpeed_Start(void);
+
+/* TIM2_IRQHandler body. */
+void     WheelSpeed_TimIrq(void);
+
+/* ISR path: capture timestamp of a tooth edge in TIM2 ticks. */
+void     WheelSpeed_OnCapture(wheel_id_t w, uint32_t capture_ticks);
+
+/* Speed in cm/s at now_ticks: 0 after the timeout, and never above the
+ * speed implied by the time since the last edge (fast decay to stop). */
+uint16_t WheelSpeed_GetCmps(wheel_id_t w, uint32_t now_ticks);
+
+/* Copies both front speeds into a control snapshot at now_ticks. wheel_ok
+ * is 1 only while both channels see edges within the timeout, or the
+ * drive is at standstill (inv_rpm), or both have stayed silent since it
+ * was (front wheels stopped, rears spinning at launch). A dead sensor or
+ * harness at speed clears it: traction control and the estimator then
+ * run without wheel speeds instead of reading 0 m/s. */
+void     WheelSpeed_FillAt(app_inputs_t *in, uint32_t now_ticks);
+
+/* WheelSpeed_FillAt at the TIM2 counter (capture source). */
+void     WheelSpeed_Fill(app_inputs_t *in);
+
+#endif /* WHEEL_SPEED_H */
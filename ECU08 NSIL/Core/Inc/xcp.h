@@ -0,0 +1,127 @@
+#ifndef XCP_H
+#define XCP_H
+
+#include <stdint.h>
+#include "app_state.h"
+#include "can.h"
+#include "control.h"
+
+/* XCP-on-CAN slave (ASAM XCP 1.x subset) on the dashboard bus.
+ *
+ *  - Measurement: dynamic DAQ lists (FREE/ALLOC_DAQ, ALLOC_ODT,
+ *    ALLOC_ODT_ENTRY, WRITE_DAQ) sampled by Xcp_Event() right after the
+ *    control step, so every DTO holds values of one and the same cycle.
+ *    Starting a list compiles its ODT entries into a flat copy list
+ *    (segment, source offset, frame offset, length; adjacent entries
+ *    merged) and prefills the PID of each frame: a sample is one memcpy
+ *    per run plus the frame sends.
+ *  - Calibration: DOWNLOAD into the calibration segment goes through the
+ *    typed parameter table of the calibration store (calib.h). The write
+ *    must cover whole parameters; values are range checked, then
+ *    committed (ERR_CMD_BUSY while the previous commit is not picked up
+ *    yet: the master retries). SET_REQUEST STORE_CAL_REQ saves to flash
+ *    (ERR_ACCESS_DENIED while the car is running).
+ *  - Intel byte order, byte granularity, CAN frames of 8 bytes (CRO, and
+ *    ODTs of up to 7 data bytes behind an absolute ODT number PID), no
+ *    timestamps, no seed & key, one event channel (control cycle) with a
+ *    prescaler.
+ *
+ * Address map (address extension 0):
+ *   XCP_ADDR_INPUTS + offsetof(app_inputs_t, f)    DAQ, UPLOAD (g_in)
+ *   XCP_ADDR_OUTPUT + offsetof(control_out_t, f)   DAQ only
+ *   XCP_ADDR_CALIB  + offsetof(calib_data_t, f)    DAQ, UPLOAD (live),
+ *                                                  DOWNLOAD (parameters)
+ *
+ * Xcp_Rx() runs in CanRxTask, Xcp_Event() in ControlTask. The control
+ * task has the higher priority, so on the single core a sample is never
+ * interleaved with a reconfiguration; the run mask is published last,
+ * behind a barrier. */
+
+#define XCP_CRO_ID          0x7F0u   /* master → slave                       */
+#define XCP_DTO_ID          0x7F1u   /* slave → master: RES/ERR/EV/DAQ       */
+
+#define XCP_ADDR_INPUTS     0x10000000u
+#define XCP_ADDR_OUTPUT     0x20000000u
+#define XCP_ADDR_CALIB      0x30000000u
+
+#define XCP_MAX_DAQ         8u       /* dynamic DAQ lists                    */
+#define XCP_MAX_ODT         32u      /* ODTs over all lists (= PIDs)         */
+#define XCP_MAX_ENTRIES     128u     /* ODT entries over all ODTs            */
+#define XCP_ODT_BYTES       7u       /* data bytes of one ODT (8 - PID)      */
+
+#define XCP_EVENT_CTRL      0u       /* control cycle (CtrlExec period)      */
+#define XCP_EVENT_COUNT     1u
+
+/* Command PIDs (CRO byte 0) */
+#define XCP_CMD_CONNECT                0xFFu
+#define XCP_CMD_DISCONNECT             0xFEu
+#define XCP_CMD_GET_STATUS             0xFDu
+#define XCP_CMD_SYNCH                  0xFCu
+#define XCP_CMD_SET_REQUEST            0xF9u
+#define XCP_CMD_SET_MTA                0xF6u
+#define XCP_CMD_UPLOAD                 0xF5u
+#define XCP_CMD_SHORT_UPLOAD           0xF4u
+#define XCP_CMD_DOWNLOAD               0xF0u
+#define XCP_CMD_CLEAR_DAQ_LIST         0xE3u
+#define XCP_CMD_SET_DAQ_PTR            0xE2u
+#define XCP_CMD_WRITE_DAQ              0xE1u
+#define XCP_CMD_SET_DAQ_LIST_MODE      0xE0u
+#define XCP_CMD_START_STOP_DAQ_LIST    0xDEu
+#define XCP_CMD_START_STOP_SYNCH       0xDDu
+#define XCP_CMD_GET_DAQ_PROCESSOR_INFO 0xDAu
+#define XCP_CMD_FREE_DAQ               0xD6u
+#define XCP_CMD_ALLOC_DAQ              0xD5u
+#define XCP_CMD_ALLOC_ODT              0xD4u
+#define XCP_CMD_ALLOC_ODT_ENTRY        0xD3u
+
+/* Response PIDs */
+#define XCP_PID_RES                    0xFFu
+#define XCP_PID_ERR                    0xFEu
+
+/* Error codes */
+#define XCP_ERR_CMD_SYNCH              0x00u
+#define XCP_ERR_CMD_BUSY               0x10u
+#define XCP_ERR_DAQ_ACTIVE             0x11u
+#define XCP_ERR_CMD_UNKNOWN            0x20u
+#define XCP_ERR_CMD_SYNTAX             0x21u
+#define XCP_ERR_OUT_OF_RANGE           0x22u
+#define XCP_ERR_WRITE_PROTECTED        0x23u
+#define XCP_ERR_ACCESS_DENIED          0x24u
+#define XCP_ERR_MODE_NOT_VALID         0x27u
+#define XCP_ERR_SEQUENCE               0x29u
+#define XCP_ERR_DAQ_CONFIG             0x2Au
+#define XCP_ERR_MEMORY_OVERFLOW        0x30u
+
+/* GET_STATUS session status bits */
+#define XCP_SESSION_STORE_CAL_REQ      0x01u
+#define XCP_SESSION_DAQ_RUNNING        0x40u
+
+/* Frame sink: RES/ERR from Xcp_Rx() and DAQ DTOs from Xcp_Event(). */
+typedef void (*xcp_tx_fn_t)(const can_msg_t *m);
+
+typedef struct
+{
+  uint32_t cro;            /* commands received                           */
+  uint32_t err;            /* ERR responses sent                          */
+  uint32_t samples;        /* DAQ list samples taken                      */
+  uint32_t dto;            /* DAQ frames sent                             */
+  uint32_t dto_dropped;    /* TX queue full (default sink)                */
+  uint32_t cal_writes;     /* parameters written by DOWNLOAD              */
+} xcp_stats_t;
+
+/* Disconnected, no DAQ lists, default sink (canTxQueueHandle). */
+void Xcp_Init(void);
+void Xcp_SetTransport(xcp_tx_fn_t tx);   /* NULL = default sink */
+
+/* CanRxTask: returns 1 if m was an XCP command (consumed). Call outside
+ * g_inMutex (UPLOAD of the inputs takes a snapshot). */
+int  Xcp_Rx(const can_msg_t *m);
+
+/* ControlTask, right after Control_Step10ms(): samples the running DAQ
+ * lists of this event from the cycle's inputs and outputs. */
+void Xcp_Event(uint8_t event, const app_inputs_t *in, const control_out_t *out);
+
+uint8_t Xcp_IsConnected(void);
+void    Xcp_GetStats(xcp_stats_t *out);
+
+#endif /* XCP_H */
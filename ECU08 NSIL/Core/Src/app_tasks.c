@@ -10,6 +10,16 @@
 #include "app_state.h"
 #include "can.h"
 #include "control.h"
+#include "calib.h"
+#include "can_map.h"
+#include "xcp.h"
+#include "uds.h"
+#include "gateway.h"
+#include "tx_sched.h"
+#include "freshness.h"
+#include "ctrl_exec.h"
+#include "wheel_speed.h"
+#include "bmi088.h"
 #include "telemetry.h"
 #include "diag.h"
 #include "FreeRTOS.h"
@@ -39,6 +49,24 @@ void App_InitTask(void *argument)
   /* Initialize shared state */
   AppState_Init();
 
+  /* Calibration: newest valid flash slot, else defaults */
+  Calib_Init();
+
+  /* CAN IDs from the calibration (before anything sends or parses frames) */
+  (void)CanMap_Init(&Calib_Peek()->can);
+
+  /* XCP measurement / calibration slave (dashboard bus) */
+  Xcp_Init();
+
+  /* UDS diagnostic server over ISO-TP (dashboard bus) */
+  Uds_Init();
+
+  /* Bus-to-bus forwarding from the RX interrupts (default routing table) */
+  (void)Gateway_Init(NULL, 0u);
+
+  /* Time-triggered periodic frames (phases spread over the hyperperiod) */
+  (void)TxSched_Init(NULL, 0u);
+
   /* Optional: initial diag line */
   Diag_Log("App_InitTask: init done\r\n");
 
@@ -56,21 +84,28 @@ void CanRxTask(void *argument)
 {
   (void)argument;
 
-  can_qitem16_t qi;
+  can_qitem_t qi;
   can_msg_t msg;
 
   for (;;)
   {
-    /* Block indefinitely waiting for RX items */
-    if (osMessageQueueGet(canRxQueueHandle, &qi, NULL, osWaitForever) == osOK)
+    /* Wait for RX items; wake at least every 5 ms for the UDS transmitter */
+    if (osMessageQueueGet(canRxQueueHandle, &qi, NULL, ms_to_ticks(5)) == osOK)
     {
-      CAN_Unpack16(&qi, &msg);
-
-      /* Update shared state under mutex */
-      osMutexAcquire(g_inMutex, osWaitForever);
-      CanRx_ParseAndUpdate(&msg, &g_in);
-      osMutexRelease(g_inMutex);
+      CAN_Unpack(&qi, &msg);
+
+      /* XCP / UDS requests: answered outside the mutex (they snapshot g_in) */
+      if (!Xcp_Rx(&msg) && !Uds_Rx(&msg, CtrlExec_NowUs()))
+      {
+        /* Update shared state under mutex */
+        osMutexAcquire(g_inMutex, osWaitForever);
+        CanRx_ParseAndUpdate(&msg, &g_in);
+        osMutexRelease(g_inMutex);
+      }
     }
+
+    /* UDS: pending request, flow control, next consecutive frames */
+    Uds_Service(CtrlExec_NowUs(), UINT32_MAX);
   }
 }
 
@@ -80,7 +115,7 @@ void CanTxTask(void *argument)
 {
   (void)argument;
 
-  can_qitem16_t qi;
+  can_qitem_t qi;
   can_msg_t msg;
 
   for (;;)
@@ -88,48 +123,77 @@ void CanTxTask(void *argument)
     /* Block indefinitely waiting for TX items */
     if (osMessageQueueGet(canTxQueueHandle, &qi, NULL, osWaitForever) == osOK)
     {
-      CAN_Unpack16(&qi, &msg);
+      CAN_Unpack(&qi, &msg);
 
-      /* Single point of HAL TX */
-      (void)CanTx_SendHal(&msg);
+      /* Single point of HAL TX; inverter commands leave as one burst */
+      if (msg.burst > 1u) CanTx_DrainBurst(&msg);
+      else (void)CanTx_SendHal(&msg);
     }
   }
 }
 
-/* -------------------- Task: ControlTask (10 ms) -------------------- */
+/* -------------------- Task: ControlTask (TIM16-paced) -------------------- */
 
 void ControlTask(void *argument)
 {
   (void)argument;
 
-  const uint32_t period = ms_to_ticks(10);
-  uint32_t next = osKernelGetTickCount();
-
   /* Local copies to minimize mutex holding time */
   app_inputs_t in_snap;
-  control_out_t out;
+  static control_out_t out;   /* ~1.8 KB with FD-sized frames: off the stack */
+  static can_msg_t sched[TXS_TICK_MAX];
+
+  CtrlExec_Init(CTRL_EXEC_RATE_HZ);
+  Control_SetPeriodUs(CtrlExec_GetPeriodUs());
+  CtrlExec_Start(osThreadGetId());
+#if WHEEL_SPEED_USE_CAPTURE
+  WheelSpeed_Init();
+  WheelSpeed_Start();
+#endif
+#if BMI088_ENABLE
+  (void)Bmi088_Init();
+#endif
 
   for (;;)
   {
-    next += period;
-    osDelayUntil(next);
+    /* Woken by the TIM16 update IRQ (direct task notification) */
+    (void)CtrlExec_WaitCycle();
 
     /* Snapshot inputs/state */
     osMutexAcquire(g_inMutex, osWaitForever);
     in_snap = g_in; /* structure copy */
     osMutexRelease(g_inMutex);
+#if WHEEL_SPEED_USE_CAPTURE
+    WheelSpeed_Fill(&in_snap);
+#endif
+#if BMI088_ENABLE
+    Bmi088_Fill(&in_snap, CtrlExec_NowUs());
+#endif
 
     /* Compute control step (pure logic) */
     Control_Step10ms(&in_snap, &out);
 
+    /* XCP DAQ lists sample this cycle's inputs and outputs */
+    Xcp_Event(XCP_EVENT_CTRL, &in_snap, &out);
+
     /* Enqueue any CAN frames generated by control */
     for (uint32_t i = 0; i < out.count; i++)
     {
-      can_qitem16_t qout;
-      CAN_Pack16(&out.msgs[i], &qout);
+      can_qitem_t qout;
+      CAN_Pack(&out.msgs[i], &qout);
+      (void)osMessageQueuePut(canTxQueueHandle, &qout, 0U, 0U);
+    }
+
+    /* Periodic VCU frames due on this tick, from the same snapshot */
+    const uint32_t ns = TxSched_Tick(osKernelGetTickCount(), &in_snap, &out, sched, TXS_TICK_MAX);
+    for (uint32_t i = 0; i < ns; i++)
+    {
+      can_qitem_t qout;
+      CAN_Pack(&sched[i], &qout);
       (void)osMessageQueuePut(canTxQueueHandle, &qout, 0U, 0U);
     }
 
+    CtrlExec_CycleDone();
   }
 }
 
@@ -139,7 +203,6 @@ void TelemetryTask(void *argument)
 {
   (void)argument;
 
-  const uint32_t period = ms_to_ticks(500);
   uint32_t next = osKernelGetTickCount();
 
   app_inputs_t in_snap;
@@ -147,7 +210,9 @@ void TelemetryTask(void *argument)
 
   for (;;)
   {
-    next += period;
+    /* Calibrated period, picked up on the next frame */
+    const calib_data_t *cal = Calib_Peek();
+    next += ms_to_ticks(cal ? cal->tel_period_ms : 500u);
     osDelayUntil(next);
 
     osMutexAcquire(g_inMutex, osWaitForever);
@@ -168,11 +233,22 @@ void DiagTask(void *argument)
   const uint32_t period = ms_to_ticks(1000);
   uint32_t next = osKernelGetTickCount();
 
+  app_inputs_t in_snap;
+
   for (;;)
   {
     next += period;
     osDelayUntil(next);
 
+    /* Deferred calibration flash write (sector erase blocks ~1 s) */
+    Calib_Service();
+
+    /* UDS fault memory */
+    osMutexAcquire(g_inMutex, osWaitForever);
+    in_snap = g_in;
+    osMutexRelease(g_inMutex);
+    Uds_Monitor(&in_snap);
+
     /* Queue metrics */
     uint32_t rx_cnt = osMessageQueueGetCount(canRxQueueHandle);
     uint32_t tx_cnt = osMessageQueueGetCount(canTxQueueHandle);
@@ -181,6 +257,10 @@ void DiagTask(void *argument)
     size_t free_heap = xPortGetFreeHeapSize();
     size_t min_ever  = xPortGetMinimumEverFreeHeapSize();
 
+    /* Control executive metrics */
+    ctrl_exec_stats_t ex;
+    CtrlExec_GetStats(&ex);
+
     char buf[160];
     (void)snprintf(buf, sizeof(buf),
                    "DIAG: rxQ=%lu txQ=%lu heap=%lu minEver=%lu\r\n",
@@ -190,5 +270,76 @@ void DiagTask(void *argument)
                    (unsigned long)min_ever);
 
     Diag_Log(buf);
+
+    (void)snprintf(buf, sizeof(buf),
+                   "CTRL: %luHz cyc=%lu ovr=%lu miss=%lu jit=%lu/%luus exec=%lu/%luus\r\n",
+                   (unsigned long)ex.rate_hz,
+                   (unsigned long)ex.cycles,
+                   (unsigned long)ex.overruns,
+                   (unsigned long)ex.missed,
+                   (unsigned long)ex.jitter_last_us,
+                   (unsigned long)ex.jitter_max_us,
+                   (unsigned long)ex.exec_last_us,
+                   (unsigned long)ex.exec_max_us);
+
+    Diag_Log(buf);
+
+    /* Stale input signals (freshness.h), by name */
+    const uint32_t stale = Control_GetStaleSignals();
+    if (stale != 0u)
+    {
+      size_t n = (size_t)snprintf(buf, sizeof(buf), "SIG: stale=0x%02lx", (unsigned long)stale);
+      for (uint32_t s = 0; s < (uint32_t)SIG_COUNT && n + 24u < sizeof(buf); s++)
+      {
+        if (stale & FRESH_BIT(s)) n += (size_t)snprintf(buf + n, sizeof(buf) - n, " %s", FRESH_SIGNALS[s].name);
+      }
+      (void)snprintf(buf + n, sizeof(buf) - n, "\r\n");
+      Diag_Log(buf);
+    }
+
+    /* Gateway, one line per route */
+    for (uint32_t r = 0; r < Gateway_RouteCount(); r++)
+    {
+      gw_stats_t gw;
+      Gateway_GetStats(r, &gw);
+      (void)snprintf(buf, sizeof(buf),
+                     "GW%lu: match=%lu fwd=%lu lim=%lu drop=%lu lat=%lu/%luus\r\n",
+                     (unsigned long)r,
+                     (unsigned long)gw.matched,
+                     (unsigned long)gw.forwarded,
+                     (unsigned long)gw.limited,
+                     (unsigned long)gw.dropped,
+                     (unsigned long)gw.lat_last_us,
+                     (unsigned long)gw.lat_max_us);
+      Diag_Log(buf);
+    }
+
+    /* Boot handshakes: state, attempts, time to ready per node */
+    {
+      static const char *const HS_STATE[] = { "idle", "wait", "ready", "FAILED" };
+      const hs_t *hs = Control_GetHandshake();
+      size_t n = (size_t)snprintf(buf, sizeof(buf), "HS:");
+      for (uint32_t i = 0; i < HS_NODE_COUNT && n + 40u < sizeof(buf); i++)
+      {
+        const hs_node_state_t *ns = &hs->node[i];
+        n += (size_t)snprintf(buf + n, sizeof(buf) - n, " %s=%s/%u",
+                              HS_NODES[i].name, HS_STATE[ns->state & 3u], (unsigned)ns->attempts);
+        if (ns->state == HS_READY) n += (size_t)snprintf(buf + n, sizeof(buf) - n, "/%lums", (unsigned long)ns->ready_ms);
+      }
+      (void)snprintf(buf + n, sizeof(buf) - n, "\r\n");
+      Diag_Log(buf);
+    }
+
+    /* Time-triggered TX schedule */
+    txs_stats_t ts;
+    TxSched_GetStats(&ts);
+    (void)snprintf(buf, sizeof(buf),
+                   "TXS: hyper=%lums maxSlot=%lu sent=%lu late=%lu skip=%lu\r\n",
+                   (unsigned long)ts.hyper_ms,
+                   (unsigned long)ts.max_load,
+                   (unsigned long)ts.sent,
+                   (unsigned long)ts.late,
+                   (unsigned long)ts.skipped);
+    Diag_Log(buf);
   }
 }
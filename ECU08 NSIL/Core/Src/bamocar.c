@@ -0,0 +1,103 @@
+#include "bamocar.h"
+#include "inv_backend.h"
+#include <string.h>
+
+#if (INV_BACKEND == INV_BACKEND_BAMOCAR) || defined(INV_BACKEND_ALL)
+
+/* Raw ±32767 is the drive full scale: I_max_pk 400 A, N_max 6500 rpm.
+ * Temperatures are configured at 0.1 degC per bit, the DC link at
+ * CONV_DC_BUS_VOLTAGE (55) counts per volt. */
+const bamo_reg_t BAMO_REGS[BAMO_REG_COUNT] =
+{
+  { BAMO_REG_I_ACTUAL, INV_FB_I_ACTUAL, BAMO_PERIOD_DATA, 400,  32767 },
+  { BAMO_REG_N_ACTUAL, INV_FB_RPM,      BAMO_PERIOD_DATA, 6500, 32767 },
+  { BAMO_REG_DC_BUS,   INV_FB_DC_BUS,   50u,              1,    55    },
+  { BAMO_REG_T_MOTOR,  INV_FB_T_MOTOR,  100u,             1,    10    },
+  { BAMO_REG_T_IGBT,   INV_FB_T_IGBT,   100u,             1,    10    },
+  { BAMO_REG_T_AIR,    INV_FB_T_AIR,    100u,             1,    10    },
+};
+
+/* REGID → BAMO_REGS index + 1 (0 = not subscribed) */
+static const uint8_t BAMO_SLOT[256] =
+{
+  [BAMO_REG_I_ACTUAL] = 1u,
+  [BAMO_REG_N_ACTUAL] = 2u,
+  [BAMO_REG_DC_BUS]   = 3u,
+  [BAMO_REG_T_MOTOR]  = 4u,
+  [BAMO_REG_T_IGBT]   = 5u,
+  [BAMO_REG_T_AIR]    = 6u,
+};
+
+void Bamo_SubInit(bamo_sub_t *sub)
+{
+  if (sub) memset(sub, 0, sizeof(*sub));
+}
+
+uint32_t Bamo_SubService(bamo_sub_t *sub, const inv_node_t *nd, const inv_fb_t *fb,
+                         uint8_t data_period_ms, uint32_t now_ms,
+                         can_msg_t *msgs, uint32_t room)
+{
+  if (!sub || !nd || !fb || !msgs) return 0;
+
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < BAMO_REG_COUNT && n < room; i++)
+  {
+    const bamo_reg_t *r = &BAMO_REGS[i];
+    const uint8_t bit = (uint8_t)(1u << i);
+    const uint8_t period = (r->period_ms != BAMO_PERIOD_DATA) ? r->period_ms : data_period_ms;
+
+    if ((sub->armed & bit) && sub->period[i] == period)
+    {
+      /* Silence since the later of last response and last request */
+      uint32_t quiet = now_ms - sub->req_tick[i];
+      if (fb->fld_seen & (1u << r->field))
+      {
+        const uint32_t rx = now_ms - fb->fld_tick[r->field];
+        if (rx < quiet) quiet = rx;
+      }
+      if (quiet < BAMO_REARM_PERIODS * (uint32_t)period) continue;
+      sub->rearms++;
+    }
+
+    can_msg_t *m = &msgs[n++];
+    memset(m, 0, sizeof(*m));
+    m->bus = nd->bus;
+    m->id  = nd->req_id;
+    m->dlc = 3;
+    m->data[0] = BAMO_READ;
+    m->data[1] = r->regid;
+    m->data[2] = period;
+
+    sub->armed |= bit;
+    sub->period[i] = period;
+    sub->req_tick[i] = now_ms;
+    sub->requests++;
+  }
+  return n;
+}
+
+uint16_t Bamo_Decode(const can_msg_t *m, app_inputs_t *st, uint8_t k, uint32_t now_ms)
+{
+  if (!m || !st || k >= INV_MAX) return 0;
+  const uint8_t slot = BAMO_SLOT[m->data[0]];
+  if (slot == 0u) return 0;
+
+  const bamo_reg_t *r = &BAMO_REGS[slot - 1u];
+  const int16_t raw = (int16_t)((uint16_t)m->data[1] | ((uint16_t)m->data[2] << 8));
+  Inv_FbSet(st, k, (inv_fb_field_t)r->field, (int16_t)(((int32_t)raw * r->mul) / r->div), now_ms);
+  return (uint16_t)(1u << r->field);
+}
+
+/* Build example inverter command frame: ID/format must be aligned to your inverter protocol. */
+void Bamo_BuildCmd(const inv_node_t *nd, int16_t torque_pct, can_msg_t *m)
+{
+  memset(m, 0, sizeof(*m));
+  m->bus = nd->bus;
+  m->id  = nd->cmd_id;    /* txID_inversor from vcu.txt on the 1WD car */
+  m->dlc = 8;
+  /* Example payload: [torque_pct, ...] - adjust to your real inverter protocol.
+   * Signed (two's complement): negative = regen. */
+  m->data[0] = (uint8_t)(int8_t)torque_pct;
+}
+
+#endif /* INV_BACKEND_BAMOCAR */
@@ -0,0 +1,526 @@
+#include "bmi088.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#include "spi.h"
+#include "cmsis_os2.h"
+#define BMI_DMB()  __DMB()
+#else
+#define BMI_DMB()  do { } while (0)
+#endif
+
+/* Accel registers */
+#define ACC_CHIP_ID          0x00u
+#define ACC_CHIP_ID_VAL      0x1Eu
+#define ACC_FIFO_LENGTH_0    0x24u
+#define ACC_FIFO_DATA        0x26u
+#define ACC_CONF             0x40u
+#define ACC_RANGE            0x41u
+#define ACC_FIFO_WTM_0       0x46u
+#define ACC_FIFO_WTM_1       0x47u
+#define ACC_FIFO_CONFIG_0    0x48u
+#define ACC_FIFO_CONFIG_1    0x49u
+#define ACC_INT1_IO_CONF     0x53u
+#define ACC_INT1_INT2_MAP    0x58u
+#define ACC_PWR_CONF         0x7Cu
+#define ACC_PWR_CTRL         0x7Du
+#define ACC_SOFTRESET        0x7Eu
+
+/* Accel FIFO frame headers (low two bits = INT pin tags, masked off) */
+#define ACC_HDR_MASK         0xFCu
+#define ACC_HDR_DATA         0x84u   /* + 6 bytes x/y/z            */
+#define ACC_HDR_SKIP         0x40u   /* + 1 byte                   */
+#define ACC_HDR_TIME         0x44u   /* + 3 bytes sensortime       */
+#define ACC_HDR_CFG_CHG      0x48u   /* + 1 byte                   */
+#define ACC_HDR_DROP         0x50u   /* + 1 byte                   */
+#define ACC_FRAME_LEN        7u
+
+/* Gyro registers */
+#define GYR_CHIP_ID          0x00u
+#define GYR_CHIP_ID_VAL      0x0Fu
+#define GYR_FIFO_STATUS      0x0Eu
+#define GYR_RANGE            0x0Fu
+#define GYR_BANDWIDTH        0x10u
+#define GYR_SOFTRESET        0x14u
+#define GYR_INT_CTRL         0x15u
+#define GYR_INT3_INT4_IO_CONF 0x16u
+#define GYR_INT3_INT4_IO_MAP 0x18u
+#define GYR_FIFO_WM_ENABLE   0x1Eu
+#define GYR_FIFO_CONFIG_0    0x3Du
+#define GYR_FIFO_CONFIG_1    0x3Eu
+#define GYR_FIFO_DATA        0x3Fu
+#define GYR_FRAME_LEN        6u
+#define GYR_FIFO_FRAMES      100u
+
+#define SOFTRESET_CMD        0xB6u
+#define SPI_READ             0x80u
+
+#define ACC_FIFO_BYTES       1024u
+#define ACC_PERIOD_US        (1000000u / BMI088_ACC_ODR_HZ)
+#define GYR_PERIOD_US        (1000000u / BMI088_GYR_ODR_HZ)
+
+/* -------------------- sample ring (ISR → one task) -------------------- */
+
+static bmi088_sample_t   s_ring[BMI088_RING_LEN];
+static volatile uint32_t s_head;   /* written by the SPI ISR   */
+static volatile uint32_t s_tail;   /* written by the consumer  */
+
+/* Latest pair, published with a sequence counter (odd = being written) */
+static volatile uint32_t s_seq;
+static int16_t  s_last_acc[3];
+static int16_t  s_last_gyr[3];
+static uint32_t s_last_acc_us;
+static uint32_t s_last_gyr_us;
+static uint8_t  s_have_acc;
+static uint8_t  s_have_gyr;
+
+static bmi088_stats_t s_stats;
+
+static void push_sample(bmi088_sensor_t sensor, const uint8_t *p, uint32_t t_us)
+{
+  int16_t xyz[3];
+  xyz[0] = (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+  xyz[1] = (int16_t)((uint16_t)p[2] | ((uint16_t)p[3] << 8));
+  xyz[2] = (int16_t)((uint16_t)p[4] | ((uint16_t)p[5] << 8));
+
+  uint32_t head = s_head;
+  if (head - s_tail >= BMI088_RING_LEN)
+  {
+    s_stats.ring_drops++;
+  }
+  else
+  {
+    bmi088_sample_t *s = &s_ring[head & (BMI088_RING_LEN - 1u)];
+    s->t_us = t_us;
+    s->xyz[0] = xyz[0]; s->xyz[1] = xyz[1]; s->xyz[2] = xyz[2];
+    s->sensor = (uint8_t)sensor;
+    BMI_DMB();
+    s_head = head + 1u;
+  }
+
+  s_seq++;
+  BMI_DMB();
+  if (sensor == BMI088_ACC)
+  {
+    memcpy(s_last_acc, xyz, sizeof(xyz));
+    s_last_acc_us = t_us;
+    s_have_acc = 1;
+    s_stats.acc_samples++;
+  }
+  else
+  {
+    memcpy(s_last_gyr, xyz, sizeof(xyz));
+    s_last_gyr_us = t_us;
+    s_have_gyr = 1;
+    s_stats.gyr_samples++;
+  }
+  BMI_DMB();
+  s_seq++;
+}
+
+/* Next accel data frame at *i, skipping control frames; NULL at the end
+ * (0x80 empty marker, unknown header or truncated frame). */
+static const uint8_t *acc_next(const uint8_t *buf, uint32_t len, uint32_t *i)
+{
+  while (*i < len)
+  {
+    uint8_t h = buf[*i] & ACC_HDR_MASK;
+    uint32_t skip;
+    switch (h)
+    {
+      case ACC_HDR_DATA:
+        if (*i + ACC_FRAME_LEN > len) return NULL;
+        *i += ACC_FRAME_LEN;
+        return &buf[*i - 6u];
+      case ACC_HDR_SKIP:
+      case ACC_HDR_CFG_CHG:
+      case ACC_HDR_DROP:
+        skip = 2u;
+        break;
+      case ACC_HDR_TIME:
+        skip = 4u;
+        break;
+      default:
+        return NULL;
+    }
+    *i += skip;
+  }
+  return NULL;
+}
+
+uint32_t Bmi088_ParseAccFifo(const uint8_t *buf, uint32_t len, uint32_t t_last_us)
+{
+  if (!buf) return 0;
+
+  uint32_t n = 0, i = 0;
+  while (acc_next(buf, len, &i)) n++;
+
+  const uint8_t *p;
+  uint32_t k = 0;
+  i = 0;
+  while ((p = acc_next(buf, len, &i)) != NULL)
+  {
+    push_sample(BMI088_ACC, p, t_last_us - (n - 1u - k) * ACC_PERIOD_US);
+    k++;
+  }
+  return n;
+}
+
+uint32_t Bmi088_ParseGyrFifo(const uint8_t *buf, uint32_t frames, uint32_t t_last_us)
+{
+  if (!buf) return 0;
+  for (uint32_t k = 0; k < frames; k++)
+  {
+    push_sample(BMI088_GYR, &buf[k * GYR_FRAME_LEN], t_last_us - (frames - 1u - k) * GYR_PERIOD_US);
+  }
+  return frames;
+}
+
+uint32_t Bmi088_ReadSamples(bmi088_sample_t *dst, uint32_t max)
+{
+  if (!dst) return 0;
+  uint32_t tail = s_tail;
+  uint32_t n = s_head - tail;
+  BMI_DMB();
+  if (n > max) n = max;
+  for (uint32_t k = 0; k < n; k++)
+  {
+    dst[k] = s_ring[(tail + k) & (BMI088_RING_LEN - 1u)];
+  }
+  BMI_DMB();
+  s_tail = tail + n;
+  return n;
+}
+
+void Bmi088_Fill(app_inputs_t *in, uint32_t now_us)
+{
+  if (!in) return;
+
+  /* Drain the ring: everything since the last call, summed per sensor */
+  int32_t  sum[2][3] = { { 0 } };
+  uint32_t cnt[2] = { 0u, 0u };
+  bmi088_sample_t chunk[16];
+  uint32_t n;
+  while ((n = Bmi088_ReadSamples(chunk, 16u)) != 0u)
+  {
+    for (uint32_t i = 0; i < n; i++)
+    {
+      const uint32_t sn = (chunk[i].sensor == BMI088_ACC) ? 0u : 1u;
+      for (uint32_t k = 0; k < 3u; k++) sum[sn][k] += chunk[i].xyz[k];
+      cnt[sn]++;
+    }
+  }
+
+  int16_t acc[3], gyr[3];
+  uint32_t t_acc, t_gyr, seq;
+  uint8_t have;
+  do
+  {
+    seq = s_seq;
+    BMI_DMB();
+    memcpy(acc, s_last_acc, sizeof(acc));
+    memcpy(gyr, s_last_gyr, sizeof(gyr));
+    t_acc = s_last_acc_us;
+    t_gyr = s_last_gyr_us;
+    have  = (uint8_t)(s_have_acc && s_have_gyr);
+    BMI_DMB();
+  } while ((seq & 1u) || seq != s_seq);
+
+  /* New samples: their mean (a boxcar over the FIFO burst); none: hold */
+  for (uint32_t k = 0; k < 3u; k++)
+  {
+    if (cnt[0]) acc[k] = (int16_t)(sum[0][k] / (int32_t)cnt[0]);
+    if (cnt[1]) gyr[k] = (int16_t)(sum[1][k] / (int32_t)cnt[1]);
+  }
+
+  for (uint32_t k = 0; k < 3u; k++)
+  {
+    in->imu_acc_mg[k]   = (int16_t)(((int32_t)acc[k] * BMI088_ACC_FS_MG) / 32768);
+    in->imu_gyr_ddps[k] = (int16_t)(((int32_t)gyr[k] * BMI088_GYR_FS_DDPS) / 32768);
+  }
+  in->imu_t_us = (t_acc - t_gyr < 0x80000000u) ? t_acc : t_gyr;   /* newest */
+  in->imu_ok = (uint8_t)(have &&
+                         now_us - t_acc < BMI088_STALE_US &&
+                         now_us - t_gyr < BMI088_STALE_US);
+}
+
+void Bmi088_GetStats(bmi088_stats_t *out)
+{
+  if (!out) return;
+  *out = s_stats;
+}
+
+static void bmi088_reset_state(void)
+{
+  s_head = 0;
+  s_tail = 0;
+  s_seq = 0;
+  memset(s_last_acc, 0, sizeof(s_last_acc));
+  memset(s_last_gyr, 0, sizeof(s_last_gyr));
+  s_last_acc_us = 0;
+  s_last_gyr_us = 0;
+  s_have_acc = 0;
+  s_have_gyr = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+#ifndef SIL_BUILD
+
+#include "ctrl_exec.h"
+
+#define CS_ACC_PORT   GPIOA
+#define CS_ACC_PIN    GPIO_PIN_4
+#define CS_GYR_PORT   GPIOA
+#define CS_GYR_PIN    GPIO_PIN_3
+#define INT_PORT      GPIOE
+#define INT_ACC_PIN   GPIO_PIN_7
+#define INT_GYR_PIN   GPIO_PIN_8
+
+typedef enum
+{
+  JOB_IDLE = 0,
+  JOB_ACC_LEN,
+  JOB_ACC_DATA,
+  JOB_GYR_LEN,
+  JOB_GYR_DATA
+} bmi_job_t;
+
+#define PEND_ACC  0x1u
+#define PEND_GYR  0x2u
+
+/* DMA buffers: AXI SRAM (.bss), reachable by DMA1. Header = address byte,
+ * plus the accel dummy byte. The TX side only ever carries the address. */
+#define XFER_MAX  (2u + ACC_FIFO_BYTES)
+
+static uint8_t s_tx[XFER_MAX] __attribute__((aligned(32)));
+static uint8_t s_rx[XFER_MAX] __attribute__((aligned(32)));
+
+static volatile bmi_job_t s_job;
+static volatile uint32_t  s_pending;
+static uint32_t           s_t_len_us;
+static uint32_t           s_xfer_len;
+static uint32_t           s_gyr_frames;
+
+static void cs_low(bmi088_sensor_t s)
+{
+  if (s == BMI088_ACC) HAL_GPIO_WritePin(CS_ACC_PORT, CS_ACC_PIN, GPIO_PIN_RESET);
+  else                 HAL_GPIO_WritePin(CS_GYR_PORT, CS_GYR_PIN, GPIO_PIN_RESET);
+}
+
+static void cs_high_all(void)
+{
+  HAL_GPIO_WritePin(CS_ACC_PORT, CS_ACC_PIN, GPIO_PIN_SET);
+  HAL_GPIO_WritePin(CS_GYR_PORT, CS_GYR_PIN, GPIO_PIN_SET);
+}
+
+static void start_xfer(bmi088_sensor_t s, bmi_job_t job, uint8_t reg, uint32_t len)
+{
+  s_job = job;
+  s_xfer_len = len;
+  s_tx[0] = (uint8_t)(reg | SPI_READ);
+  cs_low(s);
+  if (HAL_SPI_TransmitReceive_DMA(&hspi1, s_tx, s_rx, (uint16_t)len) != HAL_OK)
+  {
+    cs_high_all();
+    s_stats.spi_errors++;
+    s_job = JOB_IDLE;
+  }
+}
+
+/* Starts the next queued burst if the bus is free. ISR context only (EXTI
+ * and SPI/DMA share NVIC priority 5, so they never preempt each other). */
+static void kick(void)
+{
+  if (s_job != JOB_IDLE) return;
+
+  /* Gyro first: its FIFO is the smaller one */
+  if (s_pending & PEND_GYR)
+  {
+    s_pending &= ~PEND_GYR;
+    start_xfer(BMI088_GYR, JOB_GYR_LEN, GYR_FIFO_STATUS, 2u);
+  }
+  else if (s_pending & PEND_ACC)
+  {
+    s_pending &= ~PEND_ACC;
+    start_xfer(BMI088_ACC, JOB_ACC_LEN, ACC_FIFO_LENGTH_0, 4u);
+  }
+}
+
+void Bmi088_ExtiIsr(uint16_t pin)
+{
+  if (pin == INT_ACC_PIN)      s_pending |= PEND_ACC;
+  else if (pin == INT_GYR_PIN) s_pending |= PEND_GYR;
+  else return;
+  kick();
+}
+
+void Bmi088_SpiDoneIsr(void)
+{
+  cs_high_all();
+
+  switch (s_job)
+  {
+    case JOB_ACC_LEN:
+    {
+      uint32_t len = (uint32_t)s_rx[2] | ((uint32_t)(s_rx[3] & 0x3Fu) << 8);
+      s_t_len_us = CtrlExec_NowUs();
+      s_job = JOB_IDLE;
+      if (len > ACC_FIFO_BYTES) len = ACC_FIFO_BYTES;
+      if (len) start_xfer(BMI088_ACC, JOB_ACC_DATA, ACC_FIFO_DATA, 2u + len);
+      break;
+    }
+
+    case JOB_ACC_DATA:
+      s_job = JOB_IDLE;
+      s_stats.bursts++;
+      (void)Bmi088_ParseAccFifo(&s_rx[2], s_xfer_len - 2u, s_t_len_us);
+      break;
+
+    case JOB_GYR_LEN:
+    {
+      uint32_t frames = s_rx[1] & 0x7Fu;
+      if (s_rx[1] & 0x80u) s_stats.fifo_overruns++;
+      if (frames > GYR_FIFO_FRAMES) frames = GYR_FIFO_FRAMES;
+      s_t_len_us = CtrlExec_NowUs();
+      s_gyr_frames = frames;
+      s_job = JOB_IDLE;
+      if (frames) start_xfer(BMI088_GYR, JOB_GYR_DATA, GYR_FIFO_DATA, 1u + frames * GYR_FRAME_LEN);
+      break;
+    }
+
+    case JOB_GYR_DATA:
+      s_job = JOB_IDLE;
+      s_stats.bursts++;
+      (void)Bmi088_ParseGyrFifo(&s_rx[1], s_gyr_frames, s_t_len_us);
+      break;
+
+    default:
+      s_job = JOB_IDLE;
+      break;
+  }
+
+  kick();
+}
+
+void Bmi088_SpiErrorIsr(void)
+{
+  cs_high_all();
+  s_stats.spi_errors++;
+  s_job = JOB_IDLE;
+  kick();
+}
+
+/* -------------------- blocking configuration (Init only) -------------------- */
+
+static void reg_write(bmi088_sensor_t s, uint8_t reg, uint8_t val)
+{
+  uint8_t b[2] = { (uint8_t)(reg & 0x7Fu), val };
+  cs_low(s);
+  (void)HAL_SPI_Transmit(&hspi1, b, 2u, 10u);
+  cs_high_all();
+}
+
+static uint8_t reg_read(bmi088_sensor_t s, uint8_t reg)
+{
+  /* Accel answers after one dummy byte, gyro right away */
+  uint8_t tx[3] = { (uint8_t)(reg | SPI_READ), 0u, 0u };
+  uint8_t rx[3] = { 0u, 0u, 0u };
+  uint16_t n = (s == BMI088_ACC) ? 3u : 2u;
+  cs_low(s);
+  (void)HAL_SPI_TransmitReceive(&hspi1, tx, rx, n, 10u);
+  cs_high_all();
+  return rx[n - 1u];
+}
+
+static void bmi088_gpio_init(void)
+{
+  GPIO_InitTypeDef gpio = {0};
+
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOE_CLK_ENABLE();
+
+  cs_high_all();
+  gpio.Pin   = CS_ACC_PIN | CS_GYR_PIN;
+  gpio.Mode  = GPIO_MODE_OUTPUT_PP;
+  gpio.Pull  = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+  HAL_GPIO_Init(GPIOA, &gpio);
+
+  gpio.Pin  = INT_ACC_PIN | INT_GYR_PIN;
+  gpio.Mode = GPIO_MODE_IT_RISING;
+  gpio.Pull = GPIO_PULLDOWN;
+  HAL_GPIO_Init(INT_PORT, &gpio);
+}
+
+int Bmi088_Init(void)
+{
+  bmi088_reset_state();
+  s_job = JOB_IDLE;
+  s_pending = 0;
+  memset(s_tx, 0, sizeof(s_tx));
+
+  bmi088_gpio_init();
+
+  /* Accel: a rising CS edge switches it to SPI; the first read is garbage */
+  (void)reg_read(BMI088_ACC, ACC_CHIP_ID);
+  reg_write(BMI088_ACC, ACC_SOFTRESET, SOFTRESET_CMD);
+  osDelay(2);
+  (void)reg_read(BMI088_ACC, ACC_CHIP_ID);
+  if (reg_read(BMI088_ACC, ACC_CHIP_ID) != ACC_CHIP_ID_VAL) return -1;
+
+  reg_write(BMI088_GYR, GYR_SOFTRESET, SOFTRESET_CMD);
+  osDelay(30);
+  if (reg_read(BMI088_GYR, GYR_CHIP_ID) != GYR_CHIP_ID_VAL) return -1;
+
+  /* Accel: active, 1600 Hz normal filter, +-6 g, FIFO stream, WTM → INT1 */
+  reg_write(BMI088_ACC, ACC_PWR_CONF, 0x00u);
+  osDelay(1);
+  reg_write(BMI088_ACC, ACC_PWR_CTRL, 0x04u);
+  osDelay(5);
+  reg_write(BMI088_ACC, ACC_CONF, 0xACu);
+  reg_write(BMI088_ACC, ACC_RANGE, 0x01u);
+  reg_write(BMI088_ACC, ACC_FIFO_WTM_0, (uint8_t)((BMI088_ACC_WTM_FRAMES * ACC_FRAME_LEN) & 0xFFu));
+  reg_write(BMI088_ACC, ACC_FIFO_WTM_1, (uint8_t)((BMI088_ACC_WTM_FRAMES * ACC_FRAME_LEN) >> 8));
+  reg_write(BMI088_ACC, ACC_FIFO_CONFIG_0, 0x03u);   /* stream mode        */
+  reg_write(BMI088_ACC, ACC_FIFO_CONFIG_1, 0x50u);   /* accel data in FIFO */
+  reg_write(BMI088_ACC, ACC_INT1_IO_CONF, 0x0Au);    /* out, push-pull, high */
+  reg_write(BMI088_ACC, ACC_INT1_INT2_MAP, 0x02u);   /* FIFO WTM → INT1    */
+
+  /* Gyro: +-2000 dps, 2000 Hz / 230 Hz, FIFO stream, WTM → INT3 */
+  reg_write(BMI088_GYR, GYR_RANGE, 0x00u);
+  reg_write(BMI088_GYR, GYR_BANDWIDTH, 0x01u);
+  reg_write(BMI088_GYR, GYR_FIFO_CONFIG_0, (uint8_t)BMI088_GYR_WTM_FRAMES);
+  reg_write(BMI088_GYR, GYR_FIFO_CONFIG_1, 0x80u);   /* stream mode        */
+  reg_write(BMI088_GYR, GYR_FIFO_WM_ENABLE, 0x88u);
+  reg_write(BMI088_GYR, GYR_INT3_INT4_IO_CONF, 0x01u); /* push-pull, high  */
+  reg_write(BMI088_GYR, GYR_INT3_INT4_IO_MAP, 0x04u);  /* FIFO → INT3      */
+  reg_write(BMI088_GYR, GYR_INT_CTRL, 0x40u);          /* FIFO interrupt   */
+
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+  return 0;
+}
+
+#else /* SIL_BUILD: FIFO buffers are fed through the parse functions */
+
+int Bmi088_Init(void)
+{
+  bmi088_reset_state();
+  return 0;
+}
+
+void Bmi088_ExtiIsr(uint16_t pin)
+{
+  (void)pin;
+}
+
+void Bmi088_SpiDoneIsr(void)
+{
+}
+
+void Bmi088_SpiErrorIsr(void)
+{
+}
+
+#endif /* SIL_BUILD */
@@ -0,0 +1,630 @@
+#include "calib.h"
+#include "diag.h"
+#include "cmsis_os2.h"
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#define CAL_DMB()  __DMB()
+#else
+#include <stdio.h>
+#define CAL_DMB()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define CALIB_MAGIC  0x424C4143u   /* "CALB" */
+
+#define P(id_, type_, field_, lo_, hi_) \
+  { (id_), (type_), (uint16_t)offsetof(calib_data_t, field_), (lo_), (hi_), #field_ }
+
+const calib_param_t CALIB_PARAMS[] =
+{
+  /* Pedal map (apps_cal_t) */
+  P(0x0101u, CALIB_T_F32, apps.s1_offset_adc,              0.0f,  4095.0f),
+  P(0x0102u, CALIB_T_F32, apps.s1_adc_per_pct,             0.5f,   100.0f),
+  P(0x0103u, CALIB_T_F32, apps.s2_offset_adc,              0.0f,  4095.0f),
+  P(0x0104u, CALIB_T_F32, apps.s2_adc_per_pct,             0.5f,   100.0f),
+  P(0x0105u, CALIB_T_F32, apps.deadband_pct,               0.0f,    50.0f),
+  P(0x0106u, CALIB_T_I32, apps.min_pct,                    0.0f,    50.0f),
+  P(0x0107u, CALIB_T_I32, apps.max_pct,                   50.0f,   100.0f),
+  P(0x0108u, CALIB_T_U16, apps.brake_adc,                  0.0f,  4095.0f),
+
+  /* Periods (VCU.h periodo_inv / periodo_tel) */
+  P(0x0201u, CALIB_T_U32, ctrl.inv_read_period_ms,         1.0f,   255.0f),
+  P(0x0202u, CALIB_T_U32, tel_period_ms,                  10.0f, 10000.0f),
+  P(0x0203u, CALIB_T_U32, ctrl.cmd_period_ms,              1.0f,    50.0f),
+
+  /* Power limit */
+  P(0x0301u, CALIB_T_F32, ctrl.power_limit.p_max_w,        0.0f, 80000.0f),
+  P(0x0302u, CALIB_T_F32, ctrl.power_limit.p_margin_w,     0.0f, 20000.0f),
+  P(0x0303u, CALIB_T_F32, ctrl.power_limit.t_max_nm,       1.0f,  1000.0f),
+  P(0x0304u, CALIB_T_F32, ctrl.power_limit.eff,            0.5f,     1.0f),
+  P(0x0305u, CALIB_T_F32, ctrl.power_limit.kp,             0.0f,    10.0f),
+  P(0x0306u, CALIB_T_F32, ctrl.power_limit.ki_per_s,       0.0f,   100.0f),
+  P(0x0307u, CALIB_T_F32, ctrl.power_limit.trim_max_w,     0.0f, 40000.0f),
+  P(0x0308u, CALIB_T_F32, ctrl.power_limit.kt_nm_per_a,    0.0f,    10.0f),
+
+  /* Thermal derating */
+  P(0x0401u, CALIB_T_F32, ctrl.thermal.horizon_s,          0.0f,   120.0f),
+  P(0x0402u, CALIB_T_F32, ctrl.thermal.rate_down_pct_s,    0.0f,  1000.0f),
+  P(0x0403u, CALIB_T_F32, ctrl.thermal.rate_up_pct_s,      0.0f,  1000.0f),
+
+  /* Torque slew */
+  P(0x0501u, CALIB_T_F32, ctrl.slew.rise_pct_s,            1.0f, 10000.0f),
+  P(0x0502u, CALIB_T_F32, ctrl.slew.fall_pct_s,            1.0f, 10000.0f),
+  P(0x0503u, CALIB_T_F32, ctrl.slew.jerk_pct_s2,           0.0f, 1.0e6f),
+
+  /* Regen */
+  P(0x0601u, CALIB_T_F32, ctrl.regen.max_pct,              0.0f,   100.0f),
+  P(0x0602u, CALIB_T_U16, ctrl.regen.brake_start_adc,      0.0f,  4095.0f),
+  P(0x0603u, CALIB_T_U16, ctrl.regen.brake_full_adc,       0.0f,  4095.0f),
+  P(0x0604u, CALIB_T_F32, ctrl.regen.rpm_fade_lo,          0.0f, 20000.0f),
+  P(0x0605u, CALIB_T_F32, ctrl.regen.rpm_fade_hi,          0.0f, 20000.0f),
+  P(0x0606u, CALIB_T_F32, ctrl.regen.i_chg_max_a,          0.0f,   500.0f),
+
+  /* Launch */
+  P(0x0701u, CALIB_T_F32, ctrl.launch.torque_start_pct,    0.0f,   100.0f),
+  P(0x0702u, CALIB_T_F32, ctrl.launch.torque_ramp_s,       0.0f,     5.0f),
+  P(0x0703u, CALIB_T_F32, ctrl.launch.slip_target,         0.0f,     1.0f),
+  P(0x0704u, CALIB_T_F32, ctrl.launch.kp_pct_per_rpm,      0.0f,    10.0f),
+  P(0x0705u, CALIB_T_I16, ctrl.launch.rpm_standstill,      0.0f,  2000.0f),
+  P(0x0706u, CALIB_T_U16, ctrl.launch.throttle_go_pct,     0.0f,   100.0f),
+  P(0x0707u, CALIB_T_U16, ctrl.launch.throttle_abort_pct,  0.0f,   100.0f),
+
+  /* Traction control */
+  P(0x0801u, CALIB_T_F32, ctrl.traction.slip_target,       0.0f,     1.0f),
+  P(0x0802u, CALIB_T_F32, ctrl.traction.kp_pct,            0.0f,  1000.0f),
+  P(0x0803u, CALIB_T_F32, ctrl.traction.ki_pct_s,          0.0f, 10000.0f),
+  P(0x0804u, CALIB_T_F32, ctrl.traction.recover_pct_s,     0.0f,  1000.0f),
+
+  /* Torque vectoring */
+  P(0x0901u, CALIB_T_F32, ctrl.vectoring.k_yaw_pct,        0.0f,   500.0f),
+  P(0x0902u, CALIB_T_F32, ctrl.vectoring.dmax_pct,         0.0f,   100.0f),
+  P(0x0903u, CALIB_T_F32, ctrl.vectoring.v_min_mps,        0.0f,    30.0f),
+
+  /* CAN ID map (can_map.h), applied at boot */
+  P(0x0A01u, CALIB_T_U16, can.id[CANMAP_ACK_PRECARGA],       1.0f,  2047.0f),
+  P(0x0A02u, CALIB_T_U16, can.id[CANMAP_DC_BUS_VOLTAGE],     1.0f,  2047.0f),
+  P(0x0A03u, CALIB_T_U16, can.id[CANMAP_S1_ACELERACION],     1.0f,  2047.0f),
+  P(0x0A04u, CALIB_T_U16, can.id[CANMAP_S2_ACELERACION],     1.0f,  2047.0f),
+  P(0x0A05u, CALIB_T_U16, can.id[CANMAP_S_FRENO],            1.0f,  2047.0f),
+  P(0x0A06u, CALIB_T_U16, can.id[CANMAP_V_CELDA_MIN],        1.0f,  2047.0f),
+  P(0x0A07u, CALIB_T_U16, can.id[CANMAP_WHEEL_FRONT],        1.0f,  2047.0f),
+  P(0x0A08u, CALIB_T_U16, can.id[CANMAP_ACK_TELEMETRIA],     1.0f,  2047.0f),
+  P(0x0A09u, CALIB_T_U16, can.id[CANMAP_ACK_CAJA_NEGRA],     1.0f,  2047.0f),
+  P(0x0A0Au, CALIB_T_U16, can.id[CANMAP_ACK_PANTALLA],       1.0f,  2047.0f),
+  P(0x0A0Bu, CALIB_T_U16, can.id[CANMAP_OK_TELEMETRIA],      1.0f,  2047.0f),
+  P(0x0A0Cu, CALIB_T_U16, can.id[CANMAP_OK_CAJA_NEGRA],      1.0f,  2047.0f),
+  P(0x0A0Du, CALIB_T_U16, can.id[CANMAP_OK_PANTALLA],        1.0f,  2047.0f),
+  P(0x0A0Eu, CALIB_T_U16, can.id[CANMAP_RTD_ALL],            1.0f,  2047.0f),
+  P(0x0A0Fu, CALIB_T_U16, can.id[CANMAP_TORQUE_TOTAL],       1.0f,  2047.0f),
+  P(0x0A10u, CALIB_T_U16, can.id[CANMAP_T_MOTOR],            1.0f,  2047.0f),
+  P(0x0A11u, CALIB_T_U16, can.id[CANMAP_T_IGBT],             1.0f,  2047.0f),
+  P(0x0A12u, CALIB_T_U16, can.id[CANMAP_T_AIR],              1.0f,  2047.0f),
+  P(0x0A13u, CALIB_T_U16, can.id[CANMAP_N_ACTUAL],           1.0f,  2047.0f),
+  P(0x0A14u, CALIB_T_U16, can.id[CANMAP_I_ACTUAL],           1.0f,  2047.0f),
+};
+
+const uint32_t CALIB_PARAM_COUNT = sizeof(CALIB_PARAMS) / sizeof(CALIB_PARAMS[0]);
+
+#undef P
+
+/* Flash slot layout: header in the first flash word, records after it. */
+typedef struct
+{
+  uint32_t magic;
+  uint16_t format;
+  uint16_t count;       /* records                                     */
+  uint32_t counter;     /* write sequence, newest wins                 */
+  uint32_t crc;         /* CRC-32 of the records                       */
+  uint8_t  pad[CALIB_FLASH_WORD - 16u];
+} calib_slot_hdr_t;
+
+typedef struct
+{
+  uint16_t id;
+  uint8_t  type;
+  uint8_t  rsv;
+  uint32_t raw;         /* field bits: u16/i16 widened, f32 as is      */
+} calib_record_t;
+
+#define CALIB_MAX_RECORDS  ((CALIB_SLOT_SIZE - CALIB_FLASH_WORD) / sizeof(calib_record_t))
+/* Room for a slot written by a firmware with up to 4x today's table */
+#define CALIB_LOAD_RECORDS (4u * (sizeof(CALIB_PARAMS) / sizeof(CALIB_PARAMS[0])))
+#define CALIB_IMAGE_SIZE   (CALIB_FLASH_WORD + \
+                            (CALIB_LOAD_RECORDS * sizeof(calib_record_t) + \
+                             CALIB_FLASH_WORD - 1u) / CALIB_FLASH_WORD * CALIB_FLASH_WORD)
+
+/* RAM banks: the control task reads s_bank[s_live]; writers fill the other */
+typedef struct
+{
+  calib_data_t data;
+  uint32_t     seq;
+} calib_bank_t;
+
+static calib_bank_t      s_bank[2];
+static volatile uint32_t s_live;         /* bank the control task must use  */
+static volatile uint32_t s_reader;       /* bank the control task last took */
+static uint32_t          s_seq;
+static calib_data_t      s_stage;
+static osMutexId_t       s_mutex;
+static volatile uint32_t s_save_req;
+static calib_stats_t     s_stats;
+static uint8_t           s_init;
+
+/* Slot images are built and read here: flash-word aligned for HAL_FLASH_Program */
+static uint8_t s_image[CALIB_IMAGE_SIZE] __attribute__((aligned(CALIB_FLASH_WORD)));
+
+/* ---- Flash backend --------------------------------------------------- */
+
+#ifndef SIL_BUILD
+
+static int flash_read(uint32_t slot, uint32_t off, void *dst, uint32_t len)
+{
+  const uint8_t *src = (const uint8_t *)(CALIB_FLASH_BASE + slot * CALIB_SLOT_SIZE + off);
+  memcpy(dst, src, len);
+  return 0;
+}
+
+static int flash_erase(uint32_t slot)
+{
+  FLASH_EraseInitTypeDef er;
+  uint32_t bad = 0;
+  er.TypeErase    = FLASH_TYPEERASE_SECTORS;
+  er.Banks        = FLASH_BANK_1;
+  er.Sector       = CALIB_FLASH_SECTOR_A + slot;
+  er.NbSectors    = 1;
+  er.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+  HAL_FLASH_Unlock();
+  HAL_StatusTypeDef st = HAL_FLASHEx_Erase(&er, &bad);
+  HAL_FLASH_Lock();
+  SCB_InvalidateDCache_by_Addr((uint32_t *)(CALIB_FLASH_BASE + slot * CALIB_SLOT_SIZE),
+                               (int32_t)CALIB_SLOT_SIZE);
+  return (st == HAL_OK) ? 0 : -1;
+}
+
+/* len and off are multiples of CALIB_FLASH_WORD, src is word aligned */
+static int flash_program(uint32_t slot, uint32_t off, const uint8_t *src, uint32_t len)
+{
+  const uint32_t base = CALIB_FLASH_BASE + slot * CALIB_SLOT_SIZE + off;
+  HAL_StatusTypeDef st = HAL_OK;
+
+  HAL_FLASH_Unlock();
+  for (uint32_t i = 0; i < len && st == HAL_OK; i += CALIB_FLASH_WORD)
+  {
+    st = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, base + i, (uint32_t)(uintptr_t)(src + i));
+  }
+  HAL_FLASH_Lock();
+  SCB_InvalidateDCache_by_Addr((uint32_t *)base, (int32_t)len);
+  return (st == HAL_OK) ? 0 : -1;
+}
+
+#else /* SIL_BUILD: both slots in one file, erased = 0xFF, program = AND */
+
+static const char *s_flash_file = "ecu08_calib_flash.bin";
+static uint8_t     s_ff[1024];
+
+void Calib_SilSetFlashFile(const char *path)
+{
+  if (path) s_flash_file = path;
+}
+
+static int flash_read(uint32_t slot, uint32_t off, void *dst, uint32_t len)
+{
+  memset(dst, 0xFF, len);
+  FILE *f = fopen(s_flash_file, "rb");
+  if (!f) return 0;                       /* never written: all erased */
+  if (fseek(f, (long)(slot * CALIB_SLOT_SIZE + off), SEEK_SET) == 0)
+  {
+    size_t got = fread(dst, 1, len, f);
+    (void)got;
+  }
+  fclose(f);
+  return 0;
+}
+
+static FILE *flash_open_rw(void)
+{
+  FILE *f = fopen(s_flash_file, "r+b");
+  if (f) return f;
+  f = fopen(s_flash_file, "w+b");
+  if (!f) return NULL;
+  memset(s_ff, 0xFF, sizeof(s_ff));
+  for (uint32_t i = 0; i < 2u * CALIB_SLOT_SIZE; i += sizeof(s_ff)) fwrite(s_ff, 1, sizeof(s_ff), f);
+  return f;
+}
+
+static int flash_erase(uint32_t slot)
+{
+  FILE *f = flash_open_rw();
+  if (!f) return -1;
+  memset(s_ff, 0xFF, sizeof(s_ff));
+  int rc = fseek(f, (long)(slot * CALIB_SLOT_SIZE), SEEK_SET);
+  for (uint32_t i = 0; rc == 0 && i < CALIB_SLOT_SIZE; i += sizeof(s_ff))
+  {
+    if (fwrite(s_ff, 1, sizeof(s_ff), f) != sizeof(s_ff)) rc = -1;
+  }
+  fclose(f);
+  return rc;
+}
+
+static int flash_program(uint32_t slot, uint32_t off, const uint8_t *src, uint32_t len)
+{
+  FILE *f = flash_open_rw();
+  if (!f) return -1;
+  int rc = 0;
+  uint8_t word[CALIB_FLASH_WORD];
+  for (uint32_t i = 0; rc == 0 && i < len; i += CALIB_FLASH_WORD)
+  {
+    long pos = (long)(slot * CALIB_SLOT_SIZE + off + i);
+    if (fseek(f, pos, SEEK_SET) != 0 || fread(word, 1, sizeof(word), f) != sizeof(word))
+    {
+      rc = -1;
+      break;
+    }
+    for (uint32_t b = 0; b < CALIB_FLASH_WORD; b++) word[b] &= src[i + b];   /* 1 → 0 only */
+    if (fseek(f, pos, SEEK_SET) != 0 || fwrite(word, 1, sizeof(word), f) != sizeof(word)) rc = -1;
+  }
+  fclose(f);
+  return rc;
+}
+
+#endif /* SIL_BUILD */
+
+/* ---- Parameters ------------------------------------------------------ */
+
+/* Same CRC-32 as the control checkpoints (IEEE, reflected, bitwise) */
+static uint32_t crc32_ieee(const uint8_t *p, uint32_t n)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  while (n--)
+  {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8u; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+const calib_param_t *Calib_FindParam(uint16_t id)
+{
+  for (uint32_t i = 0; i < CALIB_PARAM_COUNT; i++)
+  {
+    if (CALIB_PARAMS[i].id == id) return &CALIB_PARAMS[i];
+  }
+  return NULL;
+}
+
+static float param_read(const calib_data_t *d, const calib_param_t *p)
+{
+  const uint8_t *f = (const uint8_t *)d + p->offset;
+  switch ((calib_type_t)p->type)
+  {
+    case CALIB_T_U16: { uint16_t v; memcpy(&v, f, sizeof v); return (float)v; }
+    case CALIB_T_U32: { uint32_t v; memcpy(&v, f, sizeof v); return (float)v; }
+    case CALIB_T_I16: { int16_t v;  memcpy(&v, f, sizeof v); return (float)v; }
+    case CALIB_T_I32: { int32_t v;  memcpy(&v, f, sizeof v); return (float)v; }
+    case CALIB_T_F32:
+    default:          { float v;    memcpy(&v, f, sizeof v); return v; }
+  }
+}
+
+static int param_write(calib_data_t *d, const calib_param_t *p, float value)
+{
+  if (!(value >= p->min && value <= p->max)) return CALIB_ERR_RANGE;   /* NaN too */
+  uint8_t *f = (uint8_t *)d + p->offset;
+  switch ((calib_type_t)p->type)
+  {
+    case CALIB_T_U16: { uint16_t v = (uint16_t)lrintf(value); memcpy(f, &v, sizeof v); break; }
+    case CALIB_T_U32: { uint32_t v = (uint32_t)lrintf(value); memcpy(f, &v, sizeof v); break; }
+    case CALIB_T_I16: { int16_t v  = (int16_t)lrintf(value);  memcpy(f, &v, sizeof v); break; }
+    case CALIB_T_I32: { int32_t v  = (int32_t)lrintf(value);  memcpy(f, &v, sizeof v); break; }
+    case CALIB_T_F32:
+    default:          memcpy(f, &value, sizeof value); break;
+  }
+  return CALIB_OK;
+}
+
+static uint32_t param_raw(const calib_data_t *d, const calib_param_t *p)
+{
+  const uint8_t *f = (const uint8_t *)d + p->offset;
+  switch ((calib_type_t)p->type)
+  {
+    case CALIB_T_U16: { uint16_t v; memcpy(&v, f, sizeof v); return v; }
+    case CALIB_T_I16: { int16_t v;  memcpy(&v, f, sizeof v); return (uint32_t)(int32_t)v; }
+    default:          { uint32_t v; memcpy(&v, f, sizeof v); return v; }
+  }
+}
+
+static float raw_value(uint8_t type, uint32_t raw)
+{
+  switch ((calib_type_t)type)
+  {
+    case CALIB_T_U16:
+    case CALIB_T_U32: return (float)raw;
+    case CALIB_T_I16:
+    case CALIB_T_I32: return (float)(int32_t)raw;
+    case CALIB_T_F32:
+    default:          { float v; memcpy(&v, &raw, sizeof v); return v; }
+  }
+}
+
+void Calib_Defaults(calib_data_t *out)
+{
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  out->apps = APPS_CAL_DEFAULT;
+  Control_CfgDefault(&out->ctrl);
+  out->tel_period_ms = 100u;
+  out->can = CANMAP_DEFAULT;
+}
+
+/* ---- Flash slots ----------------------------------------------------- */
+
+static int slot_header(uint32_t slot, calib_slot_hdr_t *h)
+{
+  flash_read(slot, 0u, h, sizeof(*h));
+  if (h->magic != CALIB_MAGIC || h->format != CALIB_FORMAT_VERSION) return 0;
+  if (h->count == 0u || h->count > CALIB_LOAD_RECORDS || h->count > CALIB_MAX_RECORDS) return 0;
+  return 1;
+}
+
+/* Reads and CRC-checks a slot's records into s_image; count on success, 0 if bad */
+static uint32_t slot_load(uint32_t slot, const calib_slot_hdr_t *h)
+{
+  uint32_t len = h->count * (uint32_t)sizeof(calib_record_t);
+  if (len > sizeof(s_image) - CALIB_FLASH_WORD) return 0;
+  flash_read(slot, CALIB_FLASH_WORD, s_image, len);
+  return (crc32_ieee(s_image, len) == h->crc) ? h->count : 0u;
+}
+
+/* Newest valid slot (-1 if none); its header in *h */
+static int newest_slot(calib_slot_hdr_t *h)
+{
+  calib_slot_hdr_t hs[2];
+  int ok[2];
+  for (uint32_t s = 0; s < 2u; s++) ok[s] = slot_header(s, &hs[s]) && slot_load(s, &hs[s]);
+
+  int best = -1;
+  if (ok[0] && ok[1]) best = ((int32_t)(hs[1].counter - hs[0].counter) > 0) ? 1 : 0;
+  else if (ok[0])     best = 0;
+  else if (ok[1])     best = 1;
+  if (best >= 0) *h = hs[best];
+  return best;
+}
+
+static void apply_records(calib_data_t *d, uint32_t count)
+{
+  const calib_record_t *r = (const calib_record_t *)(const void *)s_image;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const calib_param_t *p = Calib_FindParam(r[i].id);
+    if (p && p->type == r[i].type && param_write(d, p, raw_value(r[i].type, r[i].raw)) == CALIB_OK)
+      s_stats.records_loaded++;
+    else
+      s_stats.records_skipped++;
+  }
+}
+
+/* ---- Public API ------------------------------------------------------ */
+
+void Calib_Init(void)
+{
+  if (!s_mutex) s_mutex = osMutexNew(NULL);
+  memset(&s_stats, 0, sizeof(s_stats));
+
+  calib_data_t d;
+  Calib_Defaults(&d);
+
+  calib_slot_hdr_t h;
+  int slot = newest_slot(&h);
+  s_stats.flash_slot = (int8_t)slot;
+  if (slot >= 0)
+  {
+    /* newest_slot() checks both slots through s_image: reload the winner */
+    uint32_t n = slot_load((uint32_t)slot, &h);
+    apply_records(&d, n);
+    s_stats.flash_counter = h.counter;
+    Diag_Log("CALIB: slot %d (counter %lu), %u params, %u skipped\n", slot,
+             (unsigned long)h.counter, s_stats.records_loaded, s_stats.records_skipped);
+  }
+  else
+  {
+    Diag_Log("CALIB: no valid flash slot, defaults\n");
+  }
+
+  s_seq = 1u;
+  s_bank[0].data = d;
+  s_bank[0].seq = s_seq;
+  s_stage = d;
+  s_live = 0u;
+  s_reader = 0u;
+  s_save_req = 0u;
+  CAL_DMB();
+  s_init = 1u;
+  s_stats.seq = s_seq;
+}
+
+const calib_data_t *Calib_Acquire(uint32_t *seq)
+{
+  if (!s_init) return NULL;
+  uint32_t i = s_live;
+  s_reader = i;              /* tells writers the other bank is free */
+  CAL_DMB();
+  if (seq) *seq = s_bank[i].seq;
+  return &s_bank[i].data;
+}
+
+const calib_data_t *Calib_Peek(void)
+{
+  return s_init ? &s_bank[s_live].data : NULL;
+}
+
+static void lock(void)   { if (s_mutex) (void)osMutexAcquire(s_mutex, osWaitForever); }
+static void unlock(void) { if (s_mutex) (void)osMutexRelease(s_mutex); }
+
+int Calib_Set(uint16_t id, float value)
+{
+  const calib_param_t *p = Calib_FindParam(id);
+  if (!p) return CALIB_ERR_ID;
+  lock();
+  int rc = param_write(&s_stage, p, value);
+  unlock();
+  return rc;
+}
+
+int Calib_Get(uint16_t id, float *value)
+{
+  const calib_param_t *p = Calib_FindParam(id);
+  if (!p || !value) return CALIB_ERR_ID;
+  lock();
+  *value = param_read(&s_stage, p);
+  unlock();
+  return CALIB_OK;
+}
+
+int Calib_SetData(const calib_data_t *data)
+{
+  if (!data) return CALIB_ERR_RANGE;
+  /* Same limits as Calib_Set, for every parameter of the image */
+  for (uint32_t i = 0; i < CALIB_PARAM_COUNT; i++)
+  {
+    const float v = param_read(data, &CALIB_PARAMS[i]);
+    if (!(v >= CALIB_PARAMS[i].min && v <= CALIB_PARAMS[i].max)) return CALIB_ERR_RANGE;
+  }
+  lock();
+  s_stage = *data;
+  unlock();
+  return CALIB_OK;
+}
+
+void Calib_Revert(void)
+{
+  lock();
+  if (s_init) s_stage = s_bank[s_live].data;
+  unlock();
+}
+
+void Calib_StageDefaults(void)
+{
+  lock();
+  Calib_Defaults(&s_stage);
+  unlock();
+}
+
+int Calib_Commit(void)
+{
+  if (!s_init) return CALIB_ERR_BUSY;
+  lock();
+  const uint32_t live = s_live;
+  if (s_reader != live)
+  {
+    /* Control task may still be reading the idle bank (previous commit
+     * not picked up yet) */
+    s_stats.busy++;
+    unlock();
+    return CALIB_ERR_BUSY;
+  }
+  const uint32_t idle = live ^ 1u;
+  s_bank[idle].data = s_stage;
+  s_bank[idle].seq = ++s_seq;
+  CAL_DMB();
+  s_live = idle;
+  s_stats.commits++;
+  s_stats.seq = s_seq;
+  unlock();
+  return CALIB_OK;
+}
+
+int Calib_Save(void)
+{
+  if (!s_init) return CALIB_ERR_FLASH;
+  lock();
+
+  /* Single-bank flash: the erase stalls instruction fetch for ~1 s, the
+   * control loop and CAN with it. Whoever asked, never while driving. */
+  if (Control_IsRunning())
+  {
+    s_stats.save_errors++;
+    unlock();
+    return CALIB_ERR_RUNNING;
+  }
+
+  /* Overwrite the older slot (or slot 0 if none is valid); the newest stays
+   * intact until the new header is down. Before building the image:
+   * newest_slot() reads through s_image. */
+  calib_slot_hdr_t cur;
+  int newest = newest_slot(&cur);
+  uint32_t target = (newest == 0) ? 1u : 0u;
+
+  /* Records of the live bank, padded with 0xFF to whole flash words */
+  memset(s_image, 0xFF, sizeof(s_image));
+  const calib_data_t *d = &s_bank[s_live].data;
+  calib_record_t *r = (calib_record_t *)(void *)(s_image + CALIB_FLASH_WORD);
+  for (uint32_t i = 0; i < CALIB_PARAM_COUNT; i++)
+  {
+    r[i].id   = CALIB_PARAMS[i].id;
+    r[i].type = CALIB_PARAMS[i].type;
+    r[i].rsv  = 0xFFu;
+    r[i].raw  = param_raw(d, &CALIB_PARAMS[i]);
+  }
+  const uint32_t rec_len = CALIB_PARAM_COUNT * (uint32_t)sizeof(calib_record_t);
+  const uint32_t body = (rec_len + CALIB_FLASH_WORD - 1u) / CALIB_FLASH_WORD * CALIB_FLASH_WORD;
+
+  calib_slot_hdr_t h;
+  memset(&h, 0xFF, sizeof(h));
+  h.magic   = CALIB_MAGIC;
+  h.format  = CALIB_FORMAT_VERSION;
+  h.count   = (uint16_t)CALIB_PARAM_COUNT;
+  h.counter = (newest >= 0) ? cur.counter + 1u : 1u;
+  h.crc     = crc32_ieee(s_image + CALIB_FLASH_WORD, rec_len);
+  memcpy(s_image, &h, sizeof(h));
+
+  int rc = flash_erase(target);
+  if (rc == 0) rc = flash_program(target, CALIB_FLASH_WORD, s_image + CALIB_FLASH_WORD, body);
+  if (rc == 0) rc = flash_program(target, 0u, s_image, CALIB_FLASH_WORD);
+
+  /* Verify by reading back through the boot path */
+  calib_slot_hdr_t back;
+  if (rc == 0 && !(slot_header(target, &back) && slot_load(target, &back) == CALIB_PARAM_COUNT &&
+                   back.counter == h.counter))
+  {
+    rc = -1;
+  }
+
+  if (rc == 0)
+  {
+    s_stats.saves++;
+    s_stats.flash_counter = h.counter;
+    s_stats.flash_slot = (int8_t)target;
+  }
+  else
+  {
+    s_stats.save_errors++;
+  }
+  unlock();
+  return (rc == 0) ? CALIB_OK : CALIB_ERR_FLASH;
+}
+
+void Calib_RequestSave(void)
+{
+  s_save_req = 1u;
+}
+
+void Calib_Service(void)
+{
+  if (!s_save_req) return;
+  s_save_req = 0u;
+  const int rc = Calib_Save();
+  if (rc == CALIB_ERR_RUNNING) Diag_Log("CALIB: flash save refused, car running\n");
+  else if (rc != CALIB_OK) Diag_Log("CALIB: flash save failed\n");
+}
+
+void Calib_GetStats(calib_stats_t *out)
+{
+  if (!out) return;
+  lock();
+  *out = s_stats;
+  unlock();
+}
@@ -1,4 +1,9 @@
 #include "can.h"
+#include "inverters.h"
+#include "inv_backend.h"
+#include "gateway.h"
+#include "freshness.h"
+#include "can_map.h"
 #include <string.h>
 
 /* These handles must exist in your project (generated by CubeMX). */
@@ -6,61 +11,65 @@ extern FDCAN_HandleTypeDef hfdcan1;
 extern FDCAN_HandleTypeDef hfdcan2;
 extern FDCAN_HandleTypeDef hfdcan3;
 
-/* ==== Project CAN IDs (from your VCU header; keep as defines) ==== */
-#define ID_ACK_PRECARGA        0x20u
-#define ID_DC_BUS_VOLTAGE      0x100u
-#define ID_S1_ACELERACION      0x101u
-#define ID_S2_ACELERACION      0x102u
-#define ID_S_FRENO             0x103u
-#define ID_V_CELDA_MIN         0x12Cu
+/* Project CAN IDs (VCU.h) come from the CAN ID map, set at boot from the
+ * calibration store (can_map.h). */
 
-#define TX_STATE_2             0x461u
-#define TX_STATE_4             0x463u
-#define TX_STATE_5             0x464u
-#define TX_STATE_6             0x465u
-#define TX_STATE_7             0x466u
-
-/* Optional inverter command IDs (from vcu.txt). Adjust as needed. */
-#define TXID_INVERSOR          0x181u
-#define RXID_INVERSOR          0x201u
+/* Inverter IDs (txID 0x181 / rxID 0x201 on the 1WD car) come from the
+ * inverter layout, see inverters.c; their frames are decoded by the
+ * compiled-in backend (inv_backend.h: bamocar.c or epl.c). */
 
 /* Packing layout:
  * w0 = id
- * w1 = (dlc) | (bus<<8) | (ide<<16)
- * w2 = data[0..3] packed little-endian
- * w3 = data[4..7] packed little-endian
+ * w1 = (dlc) | (bus<<8) | (ide<<16) | (fd<<17) | (burst<<24)
+ * w2.. = data, max(dlc, 8) bytes rounded up to whole words
  */
-static uint32_t pack_u32_le(const uint8_t b[4])
-{
-  return ((uint32_t)b[0]) | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
-}
-static void unpack_u32_le(uint32_t w, uint8_t b[4])
+static uint32_t payload_words(uint8_t dlc)
 {
-  b[0] = (uint8_t)(w & 0xFFu);
-  b[1] = (uint8_t)((w >> 8) & 0xFFu);
-  b[2] = (uint8_t)((w >> 16) & 0xFFu);
-  b[3] = (uint8_t)((w >> 24) & 0xFFu);
+  const uint32_t n = (dlc < CAN_CLASSIC_DLEN) ? CAN_CLASSIC_DLEN : dlc;
+  return (n > CAN_MAX_DLEN) ? CAN_MAX_DLEN / 4u : (n + 3u) / 4u;
 }
 
-void CAN_Pack16(const can_msg_t *m, can_qitem16_t *q)
+void CAN_Pack(const can_msg_t *m, can_qitem_t *q)
 {
   if (!m || !q) return;
   q->w[0] = m->id;
-  q->w[1] = ((uint32_t)(m->dlc & 0xFu)) | (((uint32_t)m->bus & 0xFFu) << 8) | (((uint32_t)m->ide & 0x1u) << 16);
-  q->w[2] = pack_u32_le(&m->data[0]);
-  q->w[3] = pack_u32_le(&m->data[4]);
+  q->w[1] = (uint32_t)m->dlc | (((uint32_t)m->bus & 0xFFu) << 8) | (((uint32_t)m->ide & 0x1u) << 16) |
+            (((uint32_t)m->fd & 0x1u) << 17) | ((uint32_t)m->burst << 24);
+  memcpy(&q->w[2], m->data, payload_words(m->dlc) * 4u);
 }
 
-void CAN_Unpack16(const can_qitem16_t *q, can_msg_t *m)
+void CAN_Unpack(const can_qitem_t *q, can_msg_t *m)
 {
   if (!m || !q) return;
-  memset(m, 0, sizeof(*m));
-  m->id  = q->w[0];
-  m->dlc = (uint8_t)(q->w[1] & 0xFu);
-  m->bus = (can_bus_t)((q->w[1] >> 8) & 0xFFu);
-  m->ide = (uint8_t)((q->w[1] >> 16) & 0x1u);
-  unpack_u32_le(q->w[2], &m->data[0]);
-  unpack_u32_le(q->w[3], &m->data[4]);
+  m->id    = q->w[0];
+  m->dlc   = (uint8_t)(q->w[1] & 0xFFu);
+  m->bus   = (can_bus_t)((q->w[1] >> 8) & 0xFFu);
+  m->ide   = (uint8_t)((q->w[1] >> 16) & 0x1u);
+  m->fd    = (uint8_t)((q->w[1] >> 17) & 0x1u);
+  m->burst = (uint8_t)((q->w[1] >> 24) & 0xFFu);
+  memcpy(m->data, &q->w[2], payload_words(m->dlc) * 4u);
+}
+
+/* ISO 11898-1 DLC codes; the FDCAN HAL takes them unshifted (FDCAN_DLC_BYTES_x) */
+static const uint8_t DLC_LEN[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+static const uint8_t LEN_DLC[CAN_MAX_DLEN + 1] =
+{
+   0,  1,  2,  3,  4,  5,  6,  7,  8,                          /*  0..8  */
+   9,  9,  9,  9, 10, 10, 10, 10, 11, 11, 11, 11, 12, 12, 12, 12,  /*  9..24 */
+  13, 13, 13, 13, 13, 13, 13, 13,                              /* 25..32 */
+  14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,  /* 33..48 */
+  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15   /* 49..64 */
+};
+
+uint8_t Can_LenToDlc(uint8_t len)
+{
+  return (len > CAN_MAX_DLEN) ? 15u : LEN_DLC[len];
+}
+
+uint8_t Can_DlcToLen(uint8_t dlc)
+{
+  return DLC_LEN[dlc & 0x0Fu];
 }
 
 /* === RX parser: move your ISR switch() here === */
@@ -68,49 +77,100 @@ void CanRx_ParseAndUpdate(const can_msg_t *m, app_inputs_t *st)
 {
   if (!m || !st) return;
 
-  switch (m->id)
+  /* Inverter frames: any layout drive, decoded into the shared model */
+  const uint32_t now = osKernelGetTickCount();
+  const uint16_t fb = InvBk_Decode(m, st, now);
+  if (fb != 0u)
+  {
+    if (fb & (1u << INV_FB_STATE)) Fresh_Stamp(st, SIG_INV_STATE, now);
+    return;
+  }
+
+  /* Signal carried by the frame, stamped for the freshness check */
+  app_sig_t sig = SIG_COUNT;
+
+  switch (CanMap_RxKey(m->id))
   {
-    case ID_ACK_PRECARGA:
+    case CANMAP_ACK_PRECARGA:
       st->ok_precarga = m->data[0];
+      sig = SIG_OK_PRECARGA;
       break;
 
-    case ID_DC_BUS_VOLTAGE:
+    case CANMAP_DC_BUS_VOLTAGE:
       /* Example: voltage in first two bytes (little endian). Adjust to your real format. */
       st->inv_dc_bus_voltage = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      sig = SIG_DC_BUS_VOLTAGE;
       break;
 
-    case ID_S1_ACELERACION:
+    case CANMAP_S1_ACELERACION:
       st->s1_aceleracion = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      sig = SIG_S1_ACELERACION;
       break;
 
-    case ID_S2_ACELERACION:
+    case CANMAP_S2_ACELERACION:
       st->s2_aceleracion = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      sig = SIG_S2_ACELERACION;
       break;
 
-    case ID_S_FRENO:
+    case CANMAP_S_FRENO:
       st->s_freno = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      sig = SIG_S_FRENO;
       break;
 
-    case ID_V_CELDA_MIN:
+    case CANMAP_V_CELDA_MIN:
       st->v_celda_min = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      sig = SIG_V_CELDA_MIN;
       break;
 
-    case TX_STATE_2:
-    case TX_STATE_4:
-    case TX_STATE_5:
-    case TX_STATE_6:
-    case TX_STATE_7:
-      /* Example: state in byte0. Adjust to your real mapping. */
-      st->inv_state = m->data[0];
+    case CANMAP_WHEEL_FRONT:
+      /* Alternative to TIM2 capture (WHEEL_SPEED_USE_CAPTURE = 0) */
+      st->wheel_fl_cmps = (uint16_t)((uint16_t)m->data[0] | ((uint16_t)m->data[1] << 8));
+      st->wheel_fr_cmps = (uint16_t)((uint16_t)m->data[2] | ((uint16_t)m->data[3] << 8));
+      st->wheel_ok = 1;
+      sig = SIG_WHEEL_FRONT;
+      break;
+
+    case CANMAP_ACK_TELEMETRIA:
+      sig = SIG_ACK_TELEMETRIA;
+      break;
+
+    case CANMAP_ACK_CAJA_NEGRA:
+      sig = SIG_ACK_CAJA_NEGRA;
+      break;
+
+    case CANMAP_ACK_PANTALLA:
+      sig = SIG_ACK_PANTALLA;
       break;
 
     default:
       /* TODO: add remaining IDs from your current callback */
       break;
   }
+
+  if (sig != SIG_COUNT) Fresh_Stamp(st, sig, now);
 }
 
 /* === Central TX === */
+#define CAN_FD_PAD  0xCCu   /* fills a payload up to the next FD length */
+
+/* CanTxTask and the RX interrupts (gateway) both write the TX FIFOs: the
+ * HAL put index update must not be interleaved. */
+#ifndef SIL_BUILD
+static inline uint32_t tx_lock(void)
+{
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+static inline void tx_unlock(uint32_t primask)
+{
+  __set_PRIMASK(primask);
+}
+#else
+static inline uint32_t tx_lock(void) { return 0u; }
+static inline void tx_unlock(uint32_t primask) { (void)primask; }
+#endif
+
 static FDCAN_HandleTypeDef* bus_to_hfdcan(can_bus_t bus)
 {
   switch (bus)
@@ -122,69 +182,133 @@ static FDCAN_HandleTypeDef* bus_to_hfdcan(can_bus_t bus)
   }
 }
 
+uint8_t Can_BusIsFd(can_bus_t bus)
+{
+  return (bus_to_hfdcan(bus)->Init.FrameFormat == FDCAN_FRAME_FD_BRS) ? 1u : 0u;
+}
+
 HAL_StatusTypeDef CanTx_SendHal(const can_msg_t *m)
 {
   if (!m) return HAL_ERROR;
 
-  FDCAN_TxHeaderTypeDef txh;
-  memset(&txh, 0, sizeof(txh));
+  /* FD only where the controller runs FD; short frames fall back to classic */
+  const uint8_t fd = (m->fd && Can_BusIsFd(m->bus)) ? 1u : 0u;
+  if (m->dlc > (fd ? CAN_MAX_DLEN : CAN_CLASSIC_DLEN)) return HAL_ERROR;
 
-  txh.Identifier = m->id;
-  txh.IdType     = (m->ide ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID);
-  txh.TxFrameType= FDCAN_DATA_FRAME;
-  txh.DataLength = (m->dlc <= 8) ? ((uint32_t)m->dlc << 16) : FDCAN_DLC_BYTES_8; /* Cube HAL expects DLC enum; adjust if needed */
+  FDCAN_TxHeaderTypeDef txh;
+  txh.Identifier          = m->id;
+  txh.IdType              = (m->ide ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID);
+  txh.TxFrameType         = FDCAN_DATA_FRAME;
+  txh.DataLength          = Can_LenToDlc(m->dlc);
   txh.ErrorStateIndicator = FDCAN_ESI_ACTIVE;
-  txh.BitRateSwitch       = FDCAN_BRS_OFF;
-  txh.FDFormat            = FDCAN_CLASSIC_CAN;
+  txh.BitRateSwitch       = fd ? FDCAN_BRS_ON : FDCAN_BRS_OFF;
+  txh.FDFormat            = fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
   txh.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
   txh.MessageMarker       = 0;
 
-  /* NOTE: Some Cube HALs require DataLength to be one of FDCAN_DLC_BYTES_x.
-   * If your HAL complains, replace the DataLength assignment with a small mapping table.
-   */
+  /* The HAL copies the whole DLC length: pad lengths between FD steps */
+  const uint8_t len = Can_DlcToLen((uint8_t)txh.DataLength);
+  uint8_t buf[CAN_MAX_DLEN];
+  uint8_t *data = (uint8_t*)m->data;
+  if (len != m->dlc)
+  {
+    memcpy(buf, m->data, m->dlc);
+    memset(&buf[m->dlc], CAN_FD_PAD, (size_t)(len - m->dlc));
+    data = buf;
+  }
+
+  const uint32_t key = tx_lock();
+  const HAL_StatusTypeDef ret = HAL_FDCAN_AddMessageToTxFifoQ(bus_to_hfdcan(m->bus), &txh, data);
+  tx_unlock(key);
+  return ret;
+}
+
+static uint32_t s_burst_splits;
+
+HAL_StatusTypeDef CanTx_SendBurst(const can_msg_t *m, uint32_t n)
+{
+  if (!m || n == 0u) return HAL_ERROR;
+
+  /* Every bus FIFO must take its share of the burst at once. Interrupts
+   * stay masked until the last frame: a forwarded frame can neither take
+   * the room counted here nor land inside the burst. */
+  const uint32_t key = tx_lock();
+  uint32_t need[CAN_BUS_DASH + 1] = { 0u };
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if ((uint32_t)m[i].bus <= (uint32_t)CAN_BUS_DASH) need[m[i].bus]++;
+  }
+  for (uint32_t b = CAN_BUS_INV; b <= (uint32_t)CAN_BUS_DASH; b++)
+  {
+    if (need[b] != 0u &&
+        HAL_FDCAN_GetTxFifoFreeLevel(bus_to_hfdcan((can_bus_t)b)) < need[b])
+    {
+      s_burst_splits++;
+      break;
+    }
+  }
+
+  HAL_StatusTypeDef ret = HAL_OK;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (CanTx_SendHal(&m[i]) != HAL_OK) ret = HAL_ERROR;
+  }
+  tx_unlock(key);
+  return ret;
+}
+
+uint32_t CanTx_GetBurstSplits(void)
+{
+  return s_burst_splits;
+}
+
+void CanTx_DrainBurst(const can_msg_t *m)
+{
+  if (!m) return;
 
-  return HAL_FDCAN_AddMessageToTxFifoQ(bus_to_hfdcan(m->bus), &txh, (uint8_t*)m->data);
+  can_msg_t burst[CAN_BURST_MAX];
+  uint32_t want = (m->burst > CAN_BURST_MAX) ? CAN_BURST_MAX : m->burst;
+  uint32_t n = 0;
+  burst[n++] = *m;
+
+  can_qitem_t qi;
+  can_msg_t next;
+  while (n < want && osMessageQueueGet(canTxQueueHandle, &qi, NULL, 1u) == osOK)
+  {
+    CAN_Unpack(&qi, &next);
+    if (next.burst == m->burst) burst[n++] = next;
+    else (void)CanTx_SendHal(&next);   /* another producer's frame */
+  }
+
+  (void)CanTx_SendBurst(burst, n);
 }
 
 /* === ISR helper === */
 void Can_ISR_PushRxFifo0(FDCAN_HandleTypeDef *hfdcan)
 {
-  if (!hfdcan || !canRxQueueHandle) return;
+  if (!hfdcan) return;
 
+  /* The HAL writes up to 64 bytes straight into the message */
   FDCAN_RxHeaderTypeDef rxh;
-  uint8_t data[8];
-  if (HAL_FDCAN_GetRxMessage(hfdcan, FDCAN_RX_FIFO0, &rxh, data) != HAL_OK) return;
-
   can_msg_t m;
-  memset(&m, 0, sizeof(m));
+  if (HAL_FDCAN_GetRxMessage(hfdcan, FDCAN_RX_FIFO0, &rxh, m.data) != HAL_OK) return;
 
   if (hfdcan == &hfdcan1) m.bus = CAN_BUS_INV;
   else if (hfdcan == &hfdcan2) m.bus = CAN_BUS_ACU;
   else if (hfdcan == &hfdcan3) m.bus = CAN_BUS_DASH;
   else m.bus = CAN_BUS_INV;
 
-  m.id  = rxh.Identifier;
-  m.ide = (rxh.IdType == FDCAN_EXTENDED_ID) ? 1u : 0u;
-
-  /* DLC extraction varies by HAL; this is a common pattern for classic CAN <=8 bytes. */
-  switch (rxh.DataLength)
-  {
-    case FDCAN_DLC_BYTES_0: m.dlc = 0; break;
-    case FDCAN_DLC_BYTES_1: m.dlc = 1; break;
-    case FDCAN_DLC_BYTES_2: m.dlc = 2; break;
-    case FDCAN_DLC_BYTES_3: m.dlc = 3; break;
-    case FDCAN_DLC_BYTES_4: m.dlc = 4; break;
-    case FDCAN_DLC_BYTES_5: m.dlc = 5; break;
-    case FDCAN_DLC_BYTES_6: m.dlc = 6; break;
-    case FDCAN_DLC_BYTES_7: m.dlc = 7; break;
-    case FDCAN_DLC_BYTES_8: m.dlc = 8; break;
-    default: m.dlc = 8; break;
-  }
+  m.id    = rxh.Identifier;
+  m.ide   = (rxh.IdType == FDCAN_EXTENDED_ID) ? 1u : 0u;
+  m.dlc   = Can_DlcToLen((uint8_t)rxh.DataLength);
+  m.fd    = (rxh.FDFormat == FDCAN_FD_CAN) ? 1u : 0u;
+  m.burst = 0u;
 
-  memcpy(m.data, data, 8);
+  /* Gateway first: forwarded frames leave before the application sees them */
+  if (Gateway_Forward(&m) || !canRxQueueHandle) return;
 
-  can_qitem16_t q;
-  CAN_Pack16(&m, &q);
+  can_qitem_t q;
+  CAN_Pack(&m, &q);
 
   (void)osMessageQueuePut(canRxQueueHandle, &q, 0, 0);
 }
@@ -0,0 +1,290 @@
+#include "can_map.h"
+#include "diag.h"
+#include "inv_backend.h"
+#include "gateway.h"
+#include "xcp.h"
+#include "uds.h"
+#include "fwu.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#define CANMAP_DMB()  __DMB()
+#else
+#define CANMAP_DMB()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define HASH_MASK   (CANMAP_HASH_SLOTS - 1u)
+
+/* IDs of the car (VCU.h) */
+const canmap_ids_t CANMAP_DEFAULT =
+{
+  {
+    [CANMAP_ACK_PRECARGA]   = 0x020u,
+    [CANMAP_DC_BUS_VOLTAGE] = 0x100u,
+    [CANMAP_S1_ACELERACION] = 0x101u,
+    [CANMAP_S2_ACELERACION] = 0x102u,
+    [CANMAP_S_FRENO]        = 0x103u,
+    [CANMAP_V_CELDA_MIN]    = 0x12Cu,
+    [CANMAP_WHEEL_FRONT]    = 0x104u,   /* front hub node: FL, FR in cm/s */
+    [CANMAP_ACK_TELEMETRIA] = 0x030u,
+    [CANMAP_ACK_CAJA_NEGRA] = 0x040u,
+    [CANMAP_ACK_PANTALLA]   = 0x050u,
+
+    [CANMAP_OK_TELEMETRIA]  = 0x0A0u,
+    [CANMAP_OK_CAJA_NEGRA]  = 0x0B0u,
+    [CANMAP_OK_PANTALLA]    = 0x0E0u,
+    [CANMAP_RTD_ALL]        = 0x080u,
+    [CANMAP_TORQUE_TOTAL]   = 0x106u,
+    [CANMAP_T_MOTOR]        = 0x301u,
+    [CANMAP_T_IGBT]         = 0x302u,
+    [CANMAP_T_AIR]          = 0x303u,
+    [CANMAP_N_ACTUAL]       = 0x304u,
+    [CANMAP_I_ACTUAL]       = 0x305u,
+  }
+};
+
+const char *const CANMAP_NAMES[CANMAP_COUNT] =
+{
+  [CANMAP_ACK_PRECARGA]   = "ack_precarga",
+  [CANMAP_DC_BUS_VOLTAGE] = "dc_bus_voltage",
+  [CANMAP_S1_ACELERACION] = "s1_aceleracion",
+  [CANMAP_S2_ACELERACION] = "s2_aceleracion",
+  [CANMAP_S_FRENO]        = "s_freno",
+  [CANMAP_V_CELDA_MIN]    = "v_celda_min",
+  [CANMAP_WHEEL_FRONT]    = "wheel_front",
+  [CANMAP_ACK_TELEMETRIA] = "ack_telemetria",
+  [CANMAP_ACK_CAJA_NEGRA] = "ack_caja_negra",
+  [CANMAP_ACK_PANTALLA]   = "ack_pantalla",
+  [CANMAP_OK_TELEMETRIA]  = "ok_telemetria",
+  [CANMAP_OK_CAJA_NEGRA]  = "ok_caja_negra",
+  [CANMAP_OK_PANTALLA]    = "ok_pantalla",
+  [CANMAP_RTD_ALL]        = "rtd_all",
+  [CANMAP_TORQUE_TOTAL]   = "torque_total",
+  [CANMAP_T_MOTOR]        = "t_motor",
+  [CANMAP_T_IGBT]         = "t_igbt",
+  [CANMAP_T_AIR]          = "t_air",
+  [CANMAP_N_ACTUAL]       = "n_actual",
+  [CANMAP_I_ACTUAL]       = "i_actual",
+};
+
+/* Odd 16-bit multipliers tried in order; the first without collisions wins */
+static const uint16_t HASH_MULT[] = { 0x9E37u, 0x85EBu, 0xC2B3u, 0x27D5u, 0x165Bu, 0xD35Bu, 0x7FEBu, 0x94D1u };
+
+/* A live map: the IDs and the RX hash built from them */
+typedef struct
+{
+  uint16_t id[CANMAP_COUNT];
+  uint16_t slot_id[CANMAP_HASH_SLOTS];
+  uint8_t  slot_key[CANMAP_HASH_SLOTS];
+  uint32_t mult;
+  uint32_t max_probe;
+} map_bank_t;
+
+/* Init fills the bank not in use and publishes it: the RX task never sees
+ * a map half built */
+static map_bank_t                 s_bank[2];
+static const map_bank_t *volatile s_live;
+static canmap_stats_t             s_stats = { 0u, CANMAP_NONE, 0u, 0u, 0u, 0u };
+
+static inline uint32_t hash(uint32_t id, uint32_t mult)
+{
+  return ((id * mult) >> 7) & HASH_MASK;
+}
+
+/* IDs of the ECU's own protocols */
+static const struct
+{
+  uint16_t    id;
+  const char *name;
+} RESERVED[] =
+{
+  { XCP_CRO_ID,  "XCP CRO"  },
+  { XCP_DTO_ID,  "XCP DTO"  },
+  { UDS_REQ_ID,  "UDS request"  },
+  { UDS_RSP_ID,  "UDS response" },
+  { UDS_FUNC_ID, "UDS functional" },
+  { FWU_CMD_ID,  "FWU command"  },
+  { FWU_RSP_ID,  "FWU response" },
+};
+
+static inline int in_span(uint32_t id, uint32_t first, uint32_t n)
+{
+  return (id >= first) && (id - first < n);
+}
+
+/* What id collides with outside the map, NULL if nothing: the protocol IDs
+ * above, the frames of the layout inverters, and the gateway routes that
+ * take a frame away from the application (transit only) or put one on a
+ * bus under a new ID (remap). Routes that forward a map ID and still
+ * deliver it locally are how the car works and are not a clash; routes
+ * that name a map key follow the map and cannot clash with it. */
+static const char *clash(uint32_t id)
+{
+  for (uint32_t i = 0; i < sizeof(RESERVED) / sizeof(RESERVED[0]); i++)
+  {
+    if (RESERVED[i].id == id) return RESERVED[i].name;
+  }
+
+  const inv_layout_t *lay = Inv_GetLayout();
+  for (uint32_t k = 0; k < lay->count; k++)
+  {
+    const inv_node_t *nd = &lay->node[k];
+    if (in_span(id, nd->cmd_id, INV_BK_CMD_IDS) || in_span(id, nd->fb_id, INV_BK_FB_IDS) ||
+        id == nd->req_id) return "inverter";
+  }
+
+  for (uint32_t r = 0; r < GW_ROUTE_COUNT; r++)
+  {
+    const gw_route_t *rt = &GW_ROUTES[r];
+    if (rt->ide || (rt->id & CANMAP_REF_FLAG)) continue;
+    if ((rt->flags & GW_NO_LOCAL) && (id & rt->mask) == rt->id) return "gateway transit";
+    if (rt->remap != GW_NO_REMAP && (id & rt->mask) == (rt->remap & rt->mask)) return "gateway remap";
+  }
+  return NULL;
+}
+
+/* First key whose ID is out of range, used by an earlier key or taken
+ * outside the map; *why says which */
+static uint32_t check(const canmap_ids_t *ids, const char **why)
+{
+  for (uint32_t k = 0; k < CANMAP_COUNT; k++)
+  {
+    if (ids->id[k] == 0u || ids->id[k] > 0x7FFu)
+    {
+      *why = "out of range";
+      return k;
+    }
+    for (uint32_t j = 0; j < k; j++)
+    {
+      if (ids->id[j] == ids->id[k])
+      {
+        *why = CANMAP_NAMES[j];
+        return k;
+      }
+    }
+    if ((*why = clash(ids->id[k])) != NULL) return k;
+  }
+  return CANMAP_NONE;
+}
+
+/* Hashes the RX keys with mult; returns the longest probe sequence */
+static uint32_t fill(map_bank_t *b, uint32_t mult)
+{
+  uint32_t worst = 0;
+  memset(b->slot_key, CANMAP_NONE, sizeof(b->slot_key));
+  for (uint32_t k = 0; k < CANMAP_RX_COUNT; k++)
+  {
+    uint32_t s = hash(b->id[k], mult), p = 0;
+    while (b->slot_key[s] != CANMAP_NONE)
+    {
+      s = (s + 1u) & HASH_MASK;
+      p++;
+    }
+    b->slot_id[s] = b->id[k];
+    b->slot_key[s] = (uint8_t)k;
+    if (p > worst) worst = p;
+  }
+  b->mult = mult;
+  b->max_probe = worst;
+  return worst;
+}
+
+static void build(map_bank_t *b, const canmap_ids_t *ids)
+{
+  memcpy(b->id, ids->id, sizeof(b->id));
+
+  uint32_t best = 0, best_probe = UINT32_MAX;
+  for (uint32_t i = 0; i < sizeof(HASH_MULT) / sizeof(HASH_MULT[0]); i++)
+  {
+    const uint32_t p = fill(b, HASH_MULT[i]);
+    if (p < best_probe)
+    {
+      best = i;
+      best_probe = p;
+    }
+    if (p == 0u) return;
+  }
+  (void)fill(b, HASH_MULT[best]);
+}
+
+int CanMap_Init(const canmap_ids_t *ids)
+{
+  int rc = 0;
+  s_stats.bad_key = CANMAP_NONE;
+  s_stats.from_table = (ids != NULL) ? 1u : 0u;
+  if (!ids)
+  {
+    ids = &CANMAP_DEFAULT;
+  }
+  else
+  {
+    const char *why = NULL;
+    const uint32_t bad = check(ids, &why);
+    if (bad != CANMAP_NONE)
+    {
+      Diag_Log("CANMAP: %s 0x%03X rejected (%s), defaults loaded\n",
+               CANMAP_NAMES[bad], (unsigned)ids->id[bad], why);
+      s_stats.bad_key = (uint8_t)bad;
+      s_stats.from_table = 0u;
+      s_stats.rejected++;
+      ids = &CANMAP_DEFAULT;
+      rc = -1;
+    }
+  }
+
+  map_bank_t *b = (s_live == &s_bank[0]) ? &s_bank[1] : &s_bank[0];
+  build(b, ids);
+
+  uint8_t used = 0;
+  for (uint32_t s = 0; s < CANMAP_HASH_SLOTS; s++)
+  {
+    if (b->slot_key[s] != CANMAP_NONE) used++;
+  }
+  s_stats.used = used;
+  s_stats.max_probe = (uint8_t)b->max_probe;
+  s_stats.mult = b->mult;
+
+  CANMAP_DMB();
+  s_live = b;
+  return rc;
+}
+
+uint8_t CanMap_RxKey(uint32_t id)
+{
+  const map_bank_t *b = s_live;
+  if (!b)
+  {
+    (void)CanMap_Init(NULL);
+    b = s_live;
+  }
+  if (id > 0x7FFu) return CANMAP_NONE;
+
+  uint32_t s = hash(id, b->mult);
+  for (uint32_t p = 0; p <= b->max_probe; p++)
+  {
+    const uint8_t k = b->slot_key[s];
+    if (k == CANMAP_NONE) break;
+    if (b->slot_id[s] == id) return k;
+    s = (s + 1u) & HASH_MASK;
+  }
+  return CANMAP_NONE;
+}
+
+uint32_t CanMap_Id(uint32_t key)
+{
+  if (key >= CANMAP_COUNT) return 0u;
+  const map_bank_t *b = s_live;
+  return b ? b->id[key] : CANMAP_DEFAULT.id[key];
+}
+
+uint32_t CanMap_Resolve(uint32_t id)
+{
+  return (id & CANMAP_REF_FLAG) ? CanMap_Id(id & ~CANMAP_REF_FLAG) : id;
+}
+
+void CanMap_GetStats(canmap_stats_t *out)
+{
+  if (!out) return;
+  *out = s_stats;
+}
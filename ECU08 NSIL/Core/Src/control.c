@@ -1,8 +1,35 @@
 #include "control.h"
+#include "power_limit.h"
+#include "thermal_derate.h"
+#include "torque_slew.h"
+#include "regen.h"
+#include "launch.h"
+#include "traction.h"
+#include "vehicle_state.h"
+#include "inverters.h"
+#include "inv_backend.h"
+#include "torque_vectoring.h"
+#include "calib.h"
+#include "freshness.h"
+#include "handshake.h"
 #include <string.h>
 
-/* Thresholds from your VCU header */
-#define UMBRAL_FRENO_APPS 3000u
+/* Pedal calibration of a fresh context. Offsets and spans are the old
+ * literals, spelled the same way so the floats are identical. */
+const apps_cal_t APPS_CAL_DEFAULT =
+{
+  .s1_offset_adc = 2050.0f,
+  .s1_adc_per_pct = 29.5f - 20.5f,
+  .s2_offset_adc = 1915.0f,
+  .s2_adc_per_pct = 25.70f - 19.15f,
+  .deadband_pct  = 8.0f,
+  .min_pct       = 10,
+  .max_pct       = 90,
+  .brake_adc     = 3000u,     /* UMBRAL_FRENO_APPS in VCU.h */
+};
+
+/* Default period of the fast BAMOCAR registers (bamocar.h) */
+#define INV_DATA_PERIOD   0x19u   /* 25 ms */
 
 /* Very small helper */
 static void out_push(control_out_t *out, const can_msg_t *m)
@@ -23,110 +50,484 @@ typedef enum
   CTRL_ST_RUN
 } ctrl_state_t;
 
-static ctrl_state_t s_state;
-static uint32_t s_r2d_start_tick;
+/* Checkpoint blob: header, then the raw context bytes */
+#define CTRL_CTX_MAGIC    0x58544343u   /* "CCTX" */
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;      /* sizeof(ctrl_ctx_t) of the writer */
+  uint32_t crc;       /* CRC-32 of the context bytes      */
+} ctrl_ctx_hdr_t;
+
+/* Instance behind the legacy single-vehicle API (control tasks). */
+static ctrl_ctx_t s_ctx;
+static uint32_t s_period_us = CONTROL_DEFAULT_PERIOD_US;
+static uint32_t s_cal_seq;     /* calibration bank applied to s_ctx (0 = none) */
+
+void Control_CtxInit(ctrl_ctx_t *ctx, uint32_t period_us)
+{
+  if (!ctx) return;
+  memset(ctx, 0, sizeof(*ctx));   /* padding too: blobs compare bytewise */
+  ctx->state = CTRL_ST_BOOT;
+  ctx->period_us = (period_us != 0u) ? period_us : CONTROL_DEFAULT_PERIOD_US;
+  ctx->apps = APPS_CAL_DEFAULT;
+  Control_CfgDefault(&ctx->cfg);
+  PowerLimit_Init(&ctx->power_limit);
+  ThermalDerate_Init(&ctx->thermal);
+  TorqueSlew_Init(&ctx->slew);
+  Regen_Init(&ctx->regen);
+  Launch_Init(&ctx->launch, &ctx->cfg.launch);
+  Traction_Init(&ctx->traction);
+  VehState_Init(&ctx->vehicle);
+  TorqueVec_Init(&ctx->vectoring);
+  for (uint8_t k = 0; k < INV_MAX; k++)
+  {
+    Inv_LinkInit(&ctx->link[k]);
+#if INV_BACKEND == INV_BACKEND_BAMOCAR
+    Bamo_SubInit(&ctx->sub[k]);
+#endif
+  }
+  Hs_Init(&ctx->hs);
+}
+
+void Control_CfgDefault(control_cfg_t *cfg)
+{
+  if (!cfg) return;
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->power_limit = POWER_LIMIT_CFG_DEFAULT;
+  cfg->thermal     = THERMAL_DERATE_CFG_DEFAULT;
+  cfg->slew        = TORQUE_SLEW_CFG_DEFAULT;
+  cfg->regen       = REGEN_CFG_DEFAULT;
+  cfg->launch      = LAUNCH_CFG_DEFAULT;
+  cfg->traction    = TRACTION_CFG_DEFAULT;
+  cfg->vehicle     = VEHICLE_STATE_CFG_DEFAULT;
+  cfg->vectoring   = TORQUE_VECTORING_CFG_DEFAULT;
+  cfg->inv_read_period_ms = INV_DATA_PERIOD;
+  cfg->cmd_period_ms      = CONTROL_CMD_PERIOD_MS;
+}
+
+/* The default period must fit the largest layout */
+_Static_assert((uint64_t)INV_MAX * INV_BK_CMD_FRAMES * CONTROL_CAN_FRAME_BITS * 1000u / CONTROL_CMD_PERIOD_MS
+               <= (uint64_t)CONTROL_INV_BUS_BPS * CONTROL_CMD_BUS_PCT / 100u,
+               "CONTROL_CMD_PERIOD_MS overloads the inverter bus with INV_MAX drives");
+
+uint32_t Control_CmdPeriodMinMs(uint8_t n_inv)
+{
+  const uint32_t bits   = (uint32_t)n_inv * INV_BK_CMD_FRAMES * CONTROL_CAN_FRAME_BITS * 1000u;
+  const uint32_t budget = CONTROL_INV_BUS_BPS / 100u * CONTROL_CMD_BUS_PCT;
+  const uint32_t ms     = (bits + budget - 1u) / budget;
+  return (ms != 0u) ? ms : 1u;
+}
+
+void Control_CtxSetCfg(ctrl_ctx_t *ctx, const control_cfg_t *cfg)
+{
+  if (!ctx || !cfg) return;
+  if (cfg->inv_read_period_ms == 0u || cfg->inv_read_period_ms > 255u) return;
+  if (cfg->cmd_period_ms == 0u || cfg->cmd_period_ms > CONTROL_CMD_PERIOD_MAX_MS) return;
+  /* The launch profile lives in tables built from its config */
+  if (memcmp(&ctx->cfg.launch, &cfg->launch, sizeof(cfg->launch)) != 0)
+    Launch_SetCfg(&ctx->launch, &cfg->launch);
+  ctx->cfg = *cfg;
+}
+
+int Control_CtxSetAppsCal(ctrl_ctx_t *ctx, const apps_cal_t *cal)
+{
+  if (!ctx || !cal) return -1;
+  if (cal->s1_adc_per_pct <= 0.0f || cal->s2_adc_per_pct <= 0.0f) return -1;
+  /* A dead band reaching min_pct would let one sensor alone count as
+   * pressed; min_pct above max_pct inverts the map */
+  if (cal->deadband_pct >= (float)cal->min_pct || cal->min_pct > cal->max_pct) return -1;
+  ctx->apps = *cal;
+  return 0;
+}
+
+/* Bitwise CRC-32 (IEEE, reflected); checkpoints are rare, no table */
+static uint32_t crc32_ieee(const uint8_t *p, uint32_t n)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  while (n--)
+  {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8u; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+uint32_t Control_CtxSerialize(const ctrl_ctx_t *ctx, uint8_t *buf, uint32_t len)
+{
+  if (!ctx || !buf || len < CONTROL_CTX_BLOB_SIZE) return 0;
+
+  ctrl_ctx_hdr_t h;
+  h.magic   = CTRL_CTX_MAGIC;
+  h.version = CONTROL_CTX_VERSION;
+  h.size    = (uint32_t)sizeof(ctrl_ctx_t);
+  h.crc     = crc32_ieee((const uint8_t *)ctx, (uint32_t)sizeof(ctrl_ctx_t));
+  memcpy(buf, &h, sizeof(h));
+  memcpy(buf + sizeof(h), ctx, sizeof(ctrl_ctx_t));
+  return CONTROL_CTX_BLOB_SIZE;
+}
+
+int Control_CtxRestore(ctrl_ctx_t *ctx, const uint8_t *buf, uint32_t len)
+{
+  if (!ctx || !buf || len < CONTROL_CTX_BLOB_SIZE) return -1;
+
+  ctrl_ctx_hdr_t h;
+  memcpy(&h, buf, sizeof(h));
+  if (h.magic != CTRL_CTX_MAGIC || h.version != CONTROL_CTX_VERSION ||
+      h.size != (uint32_t)sizeof(ctrl_ctx_t)) return -1;
+  if (crc32_ieee(buf + sizeof(h), h.size) != h.crc) return -1;
+
+  ctrl_ctx_t tmp;
+  memcpy(&tmp, buf + sizeof(h), sizeof(tmp));
+  if (tmp.state > CTRL_ST_RUN || tmp.period_us == 0u) return -1;
+  *ctx = tmp;
+  return 0;
+}
+
+ctrl_ctx_t *Control_DefaultCtx(void)
+{
+  return &s_ctx;
+}
 
 void Control_Init(void)
 {
-  s_state = CTRL_ST_BOOT;
-  s_r2d_start_tick = 0;
+  Control_CtxInit(&s_ctx, s_period_us);
+  s_cal_seq = 0u;
+}
+
+void Control_SetPeriodUs(uint32_t period_us)
+{
+  if (period_us == 0u) period_us = CONTROL_DEFAULT_PERIOD_US;
+  s_period_us = period_us;
+  s_ctx.period_us = period_us;
+}
+
+uint32_t Control_GetPeriodUs(void)
+{
+  return s_period_us;
+}
+
+float Control_GetThermalLimitPct(void)
+{
+  return s_ctx.thermal.limit_pct;
+}
+
+float Control_GetTractionSlip(void)
+{
+  return s_ctx.traction.slip;
+}
+
+const vehicle_state_t *Control_GetVehicleState(void)
+{
+  return &s_ctx.vehicle;
+}
+
+uint8_t Control_IsRunning(void)
+{
+  return s_ctx.state == CTRL_ST_RUN;
+}
+
+uint8_t Control_GetInverterLink(uint8_t k)
+{
+  return (k < INV_MAX) ? s_ctx.link[k].state : (uint8_t)INV_LINK_IDLE;
+}
+
+uint32_t Control_GetStaleSignals(void)
+{
+  return s_ctx.sig_stale;
+}
+
+const hs_t *Control_GetHandshake(void)
+{
+  return &s_ctx.hs;
+}
+
+float Control_GetVectoringOffsetPct(void)
+{
+  return s_ctx.vectoring.d_pct;
 }
 
-/* Port of your torque mapping (simplified but consistent shape). */
 uint16_t Control_ComputeTorque(const app_inputs_t *in, uint8_t *flag_ev_2_3, uint8_t *flag_t11_8_9)
 {
-  if (!in) return 0;
+  return Control_ComputeTorqueCtx(&s_ctx, in, flag_ev_2_3, flag_t11_8_9);
+}
+
+/* Port of your torque mapping (simplified but consistent shape). Shared by
+ * the scalar and batch paths so both round identically. Branch-free once
+ * inlined (selects only), which lets the batch loop vectorize. */
+static inline uint16_t pedal_map(const apps_cal_t *cal, uint16_t s1, uint16_t s2)
+{
+  float s1_pct = ((float)s1 - cal->s1_offset_adc) / cal->s1_adc_per_pct;
+  float s2_pct = ((float)s2 - cal->s2_offset_adc) / cal->s2_adc_per_pct;
 
-  float s1_pct = ((float)in->s1_aceleracion - 2050.0f) / (29.5f - 20.5f);
-  float s2_pct = ((float)in->s2_aceleracion - 1915.0f) / (25.70f - 19.15f);
+  /* Both sensors above the dead band; same answer before or after the
+   * clamp, and testing it here keeps GCC from threading branches through it */
+  int32_t both_on = (s1_pct > cal->deadband_pct) & (s2_pct > cal->deadband_pct);
 
-  if (s1_pct < 0) s1_pct = 0;
-  if (s1_pct > 100) s1_pct = 100;
-  if (s2_pct < 0) s2_pct = 0;
-  if (s2_pct > 100) s2_pct = 100;
+  s1_pct = (s1_pct < 0) ? 0 : s1_pct;
+  s1_pct = (s1_pct > 100) ? 100 : s1_pct;
+  s2_pct = (s2_pct < 0) ? 0 : s2_pct;
+  s2_pct = (s2_pct > 100) ? 100 : s2_pct;
 
-  uint16_t torque = 0;
-  if (s1_pct > 8 && s2_pct > 8) torque = (uint16_t)((s1_pct + s2_pct) * 0.5f);
-  else torque = 0;
+  /* Both clamped to 0..100, so the truncation is always defined */
+  int32_t torque = (int32_t)((s1_pct + s2_pct) * 0.5f);
 
-  if (torque < 10) torque = 0;
-  else if (torque > 90) torque = 100;
+  /* Same flags-first form for the runtime limits (min_pct <= max_pct) */
+  int32_t keep = both_on & (torque >= cal->min_pct);
+  int32_t full = keep & (torque > cal->max_pct);   /* never for a rejected pedal */
+  torque = keep ? torque : 0;
+  torque = full ? 100 : torque;
+  return (uint16_t)torque;
+}
 
-  /* EV 2.3: brake + >25% throttle => latch until throttle <5% and brake released */
-  static uint8_t lat_ev23 = 0;
-  if (in->s_freno > UMBRAL_FRENO_APPS && torque > 25) lat_ev23 = 1;
-  else if (in->s_freno < UMBRAL_FRENO_APPS && torque < 5) lat_ev23 = 0;
+/* EV 2.3: brake + >25% throttle => latch until throttle <5% and brake released.
+ * Event for one sample: bit0 = set, bit1 = clear (never both). */
+#define EV23_SET  1u
+#define EV23_CLR  2u
+
+static inline uint8_t ev23_event(uint16_t brake_adc, uint16_t s_freno, uint16_t torque)
+{
+  uint8_t set = ((s_freno > brake_adc) & (torque > 25)) ? EV23_SET : 0u;
+  uint8_t clr = ((s_freno < brake_adc) & (torque < 5)) ? EV23_CLR : 0u;
+  return (uint8_t)(set | clr);
+}
+
+static inline uint8_t ev23_next(uint8_t latch, uint8_t ev)
+{
+  return (uint8_t)((ev & EV23_SET) | (latch & (uint8_t)~(ev >> 1)));
+}
+
+uint16_t Control_ComputeTorqueCtx(ctrl_ctx_t *ctx, const app_inputs_t *in,
+                                  uint8_t *flag_ev_2_3, uint8_t *flag_t11_8_9)
+{
+  if (!ctx || !in) return 0;
 
-  if (flag_ev_2_3) *flag_ev_2_3 = lat_ev23;
+  uint16_t torque = pedal_map(&ctx->apps, in->s1_aceleracion, in->s2_aceleracion);
+  ctx->lat_ev23 = ev23_next(ctx->lat_ev23, ev23_event(ctx->apps.brake_adc, in->s_freno, torque));
+
+  if (flag_ev_2_3) *flag_ev_2_3 = ctx->lat_ev23;
 
   /* Placeholder for T11.8.9 logic; keep 0 unless you implement full plausibility checks. */
   if (flag_t11_8_9) *flag_t11_8_9 = 0;
 
-  if (lat_ev23) torque = 0;
+  if (ctx->lat_ev23) torque = 0;
   return torque;
 }
 
-/* Build example inverter command frame: ID/format must be aligned to your inverter protocol. */
-static void build_inv_cmd(uint16_t torque_pct, can_msg_t *m)
+/* Separate passes so each loop has one element width and no carried state:
+ * the map and the latch events are independent per sample (vectorized);
+ * the latch itself is a serial recurrence, one byte op per sample; the cut
+ * is independent again. flag_ev_2_3 doubles as the event scratch. */
+void Control_ComputeTorqueBatch(ctrl_ctx_t *ctx, const control_batch_in_t *in, uint32_t n,
+                                uint16_t *torque, uint8_t *flag_ev_2_3)
 {
-  memset(m, 0, sizeof(*m));
-  m->bus = CAN_BUS_INV;
-  m->id  = 0x181u;    /* txID_inversor from vcu.txt */
-  m->dlc = 8;
-  /* Example payload: [torque_pct, ...] - adjust to your real inverter protocol */
-  m->data[0] = (uint8_t)torque_pct;
+  if (!ctx || !in || !in->s1_aceleracion || !in->s2_aceleracion || !in->s_freno ||
+      !torque || !flag_ev_2_3) return;
+
+  const uint16_t *restrict s1 = in->s1_aceleracion;
+  const uint16_t *restrict s2 = in->s2_aceleracion;
+  const uint16_t *restrict fr = in->s_freno;
+  uint16_t *restrict tq = torque;
+  uint8_t  *restrict ev = flag_ev_2_3;
+  const apps_cal_t cal = ctx->apps;   /* local copy: loop-invariant loads */
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    tq[i] = pedal_map(&cal, s1[i], s2[i]);
+  }
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    ev[i] = ev23_event(cal.brake_adc, fr[i], tq[i]);
+  }
+
+  uint8_t latch = ctx->lat_ev23;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    latch = ev23_next(latch, ev[i]);
+    ev[i] = latch;
+  }
+  ctx->lat_ev23 = latch;
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    tq[i] = ev[i] ? 0u : tq[i];
+  }
 }
 
-/* Main 10ms step */
+/* Main control step (one executive cycle, see Control_SetPeriodUs) */
 void Control_Step10ms(const app_inputs_t *in, control_out_t *out)
 {
-  if (!in || !out) return;
+  /* Calibration hot reload: a committed bank is taken here, between
+   * cycles, without a lock (calib.h) */
+  uint32_t seq = 0;
+  const calib_data_t *cal = Calib_Acquire(&seq);
+  if (cal && seq != s_cal_seq)
+  {
+    Control_CtxSetAppsCal(&s_ctx, &cal->apps);
+    Control_CtxSetCfg(&s_ctx, &cal->ctrl);
+    s_cal_seq = seq;
+  }
+
+  Control_StepCtx(&s_ctx, in, out, osKernelGetTickCount());
+}
+
+void Control_StepCtx(ctrl_ctx_t *ctx, const app_inputs_t *in, control_out_t *out, uint32_t now)
+{
+  if (!ctx || !in || !out) return;
   memset(out, 0, sizeof(*out));
 
+  /* Signal freshness, every cycle: a silent pedal or brake node means zero
+   * torque; stale CAN wheel speeds are no wheel speed source */
+  ctx->sig_stale = Fresh_Check(in, now);
+  const uint8_t sig_lost = (ctx->sig_stale & FRESH_CRITICAL) ? 1u : 0u;
+  app_inputs_t in_deg;
+  if ((ctx->sig_stale & FRESH_BIT(SIG_WHEEL_FRONT)) && in->wheel_ok)
+  {
+    in_deg = *in;
+    in_deg.wheel_ok = 0;
+    in = &in_deg;
+  }
+
   /* Torque computation from inputs (used only in RUN state) */
   uint8_t ev23 = 0, t1189 = 0;
-  uint16_t torque = Control_ComputeTorque(in, &ev23, &t1189);
+  uint16_t torque = Control_ComputeTorqueCtx(ctx, in, &ev23, &t1189);
   /* out->torque_pct stays 0 until state reaches CTRL_ST_RUN */
 
-  switch (s_state)
+  /* Vehicle state estimate, every cycle in every state */
+  VehState_Update(&ctx->vehicle, &ctx->cfg.vehicle, in, (float)ctx->period_us * 1e-6f);
+
+  /* Inverter register subscriptions: all armed on the first step, then a
+   * register is re-armed when it goes silent (drive reset). Room is kept
+   * for the RUN command burst. An ePowerLabs drive streams unasked. */
+  const inv_layout_t *lay = Inv_GetLayout();
+  for (uint8_t k = 0; k < lay->count; k++)
+  {
+#if INV_BACKEND == INV_BACKEND_BAMOCAR
+    const uint32_t room = CONTROL_OUT_MAX_MSGS - out->count - lay->count * INV_BK_CMD_FRAMES;
+    out->count += (uint8_t)Bamo_SubService(&ctx->sub[k], &lay->node[k], &in->inv[k],
+                                           (uint8_t)ctx->cfg.inv_read_period_ms, now,
+                                           &out->msgs[out->count], room);
+    if (ctx->sub[k].armed) Inv_LinkSubscribed(&ctx->link[k]);
+#else
+    Inv_LinkSubscribed(&ctx->link[k]);
+#endif
+  }
+
+  /* Boot handshakes, all nodes at once; the FSM waits for the required ones */
+  out->count += (uint8_t)Hs_Service(&ctx->hs, in, now, &out->msgs[out->count],
+                                    CONTROL_OUT_MAX_MSGS - out->count - lay->count * INV_BK_CMD_FRAMES);
+  const uint8_t nodes_ok = Hs_RequiredReady(&ctx->hs);
+
+  switch ((ctrl_state_t)ctx->state)
   {
     case CTRL_ST_BOOT:
-      if (in->ok_precarga) s_state = CTRL_ST_WAIT_START_BRAKE;
-      else s_state = CTRL_ST_WAIT_PRECHARGE_ACK;
+      if (nodes_ok) ctx->state = CTRL_ST_WAIT_START_BRAKE;
+      else ctx->state = CTRL_ST_WAIT_PRECHARGE_ACK;
       break;
 
     case CTRL_ST_WAIT_PRECHARGE_ACK:
-      /* TODO: enqueue precharge request frames here if required by your ACU. */
-      if (in->ok_precarga) s_state = CTRL_ST_WAIT_START_BRAKE;
+      /* Precharge (AMS) and any other HS_REQUIRED node */
+      if (nodes_ok) ctx->state = CTRL_ST_WAIT_START_BRAKE;
       break;
 
     case CTRL_ST_WAIT_START_BRAKE:
-      if (in->boton_arranque && in->s_freno > UMBRAL_FRENO_APPS)
+      if (in->boton_arranque && in->s_freno > ctx->apps.brake_adc &&
+          !(ctx->sig_stale & FRESH_BIT(SIG_S_FRENO)))
       {
-        s_r2d_start_tick = osKernelGetTickCount();
-        s_state = CTRL_ST_R2D_DELAY;
+        ctx->r2d_start_tick = now;
+        ctx->state = CTRL_ST_R2D_DELAY;
       }
       break;
 
     case CTRL_ST_R2D_DELAY:
-      if ((osKernelGetTickCount() - s_r2d_start_tick) >= 2000u)
+      if ((now - ctx->r2d_start_tick) >= 2000u)
       {
-        s_state = CTRL_ST_READY;
+        ctx->state = CTRL_ST_READY;
       }
       break;
 
     case CTRL_ST_READY:
       /* TODO: send "ready" inverter command if needed. */
-      s_state = CTRL_ST_RUN;
+      ctx->state = CTRL_ST_RUN;
       break;
 
     case CTRL_ST_RUN:
     default:
     {
-      out->torque_pct = torque;   /* Only propagate torque in RUN state */
-      can_msg_t cmd;
-      build_inv_cmd(torque, &cmd);
-      out_push(out, &cmd);
+      const float dt_s = (float)ctx->period_us * 1e-6f;
+
+      /* Launch control fast path: replaces the pedal map while active and
+       * aborts itself on the EV2.3 latch or brake */
+      if (sig_lost) torque = 0;
+      uint8_t launch = Launch_Update(&ctx->launch, &ctx->cfg.launch, in, ctx->apps.brake_adc, torque, ev23 | sig_lost, dt_s, &torque);
+
+      /* Power limit, then thermal derating, after torque mapping */
+      torque = PowerLimit_Apply(&ctx->power_limit, &ctx->cfg.power_limit, in, torque, dt_s);
+      torque = ThermalDerate_Apply(&ctx->thermal, &ctx->cfg.thermal, in, torque, dt_s);
+
+      /* Slew/jerk shaping of drive torque; EV2.3 latch or brake cut it at once.
+       * Launch bypasses it and only keeps it seeded for the hand-back. */
+      if (launch)
+      {
+        TorqueSlew_Track(&ctx->slew, torque);
+      }
+      else
+      {
+        uint8_t cut = (ev23 || sig_lost || in->s_freno > ctx->apps.brake_adc) ? 1u : 0u;
+        torque = TorqueSlew_Apply(&ctx->slew, &ctx->cfg.slew, torque, cut, dt_s);
+
+        /* Traction control after the slew so a slip cut lands this cycle;
+         * the limiter is re-seeded at the cut to ramp back from there. */
+        torque = Traction_Apply(&ctx->traction, &ctx->cfg.traction, in, torque, dt_s);
+        if (ctx->traction.active) TorqueSlew_Track(&ctx->slew, torque);
+      }
+
+      /* Regen blended into the shaped drive torque */
+      int16_t cmd_pct = Regen_Apply(&ctx->regen, &ctx->cfg.regen, in, torque, dt_s);
+      if (sig_lost) cmd_pct = 0;   /* no regen on a frozen brake reading either */
+
+      out->torque_pct = cmd_pct;  /* Only propagate torque in RUN state */
+
+      /* Per-inverter link: a LOST drive is not commanded */
+      uint8_t avail = 0;
+      for (uint8_t k = 0; k < lay->count; k++)
+      {
+        Inv_LinkUpdate(&ctx->link[k], &in->inv[k], now);
+        if (ctx->link[k].state != INV_LINK_LOST) avail |= (uint8_t)(1u << k);
+      }
+
+      TorqueVec_Allocate(&ctx->vectoring, &ctx->cfg.vectoring, lay, avail,
+                         cmd_pct, &ctx->vehicle, out->motor_pct);
+
+      /* Command frames last and contiguous: one burst, all inverters, every
+       * cmd_period_ms (the drives hold the setpoint in between). A drive
+       * whose setpoint drops to 0 (cut, brake, latch) does not wait. */
+      uint32_t cmd_period = ctx->cfg.cmd_period_ms;
+      const uint32_t cmd_min = Control_CmdPeriodMinMs(lay->count);
+      if (cmd_period < cmd_min) cmd_period = cmd_min;
+      uint8_t send = (!ctx->cmd_sent || (now - ctx->cmd_tick) >= cmd_period) ? 1u : 0u;
+      for (uint8_t k = 0; k < lay->count; k++)
+      {
+        if (out->motor_pct[k] == 0 && ctx->cmd_pct[k] != 0) send = 1u;
+      }
+      if (!send) break;
+
+      ctx->cmd_sent = 1u;
+      ctx->cmd_tick = now;
+      for (uint8_t k = 0; k < lay->count; k++)
+      {
+        can_msg_t cmd[INV_BK_CMD_FRAMES];
+        InvBk_BuildCmd(&lay->node[k], out->motor_pct[k], cmd);
+        ctx->cmd_pct[k] = out->motor_pct[k];
+        for (uint8_t j = 0; j < INV_BK_CMD_FRAMES; j++)
+        {
+          cmd[j].burst = (uint8_t)(lay->count * INV_BK_CMD_FRAMES);
+          out_push(out, &cmd[j]);
+        }
+      }
       break;
     }
   }
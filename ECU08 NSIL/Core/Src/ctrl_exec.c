@@ -0,0 +1,179 @@
+#include "ctrl_exec.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#include "tim.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+static ctrl_exec_stats_t s_stats;
+static uint32_t s_wake_us;
+static uint32_t s_last_wake_us;
+static uint8_t  s_have_wake;
+
+#ifndef SIL_BUILD
+static TaskHandle_t      s_task;
+static volatile uint32_t s_timer_ticks;   /* TIM16 update events since start */
+#endif
+
+void CtrlExec_Init(uint32_t rate_hz)
+{
+  if (rate_hz < CTRL_EXEC_RATE_MIN_HZ) rate_hz = CTRL_EXEC_RATE_MIN_HZ;
+  if (rate_hz > CTRL_EXEC_RATE_MAX_HZ) rate_hz = CTRL_EXEC_RATE_MAX_HZ;
+
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats.rate_hz   = rate_hz;
+  s_stats.period_us = CTRL_EXEC_TIM_CLK_HZ / rate_hz;
+  s_wake_us = 0;
+  s_last_wake_us = 0;
+  s_have_wake = 0;
+}
+
+uint32_t CtrlExec_GetPeriodUs(void)
+{
+  return s_stats.period_us ? s_stats.period_us : (CTRL_EXEC_TIM_CLK_HZ / CTRL_EXEC_RATE_HZ);
+}
+
+/* -------------------- accounting -------------------- */
+
+void CtrlExec_OnWake(uint32_t now_us, uint32_t ticks)
+{
+  if (ticks > 1u) s_stats.missed += ticks - 1u;
+  if (ticks == 0u) ticks = 1u;
+
+  if (s_have_wake)
+  {
+    uint32_t interval = now_us - s_last_wake_us;
+    uint32_t expected = s_stats.period_us * ticks;
+    uint32_t jitter   = (interval > expected) ? (interval - expected) : (expected - interval);
+    s_stats.jitter_last_us = jitter;
+    if (jitter > s_stats.jitter_max_us) s_stats.jitter_max_us = jitter;
+  }
+
+  s_last_wake_us = now_us;
+  s_wake_us = now_us;
+  s_have_wake = 1;
+}
+
+void CtrlExec_OnDone(uint32_t now_us)
+{
+  uint32_t exec = now_us - s_wake_us;
+  s_stats.exec_last_us = exec;
+  if (exec > s_stats.exec_max_us) s_stats.exec_max_us = exec;
+  if (exec > s_stats.period_us) s_stats.overruns++;
+  s_stats.cycles++;
+}
+
+void CtrlExec_GetStats(ctrl_exec_stats_t *out)
+{
+  if (!out) return;
+  *out = s_stats;
+}
+
+/* -------------------- timebase / pacing -------------------- */
+
+#ifndef SIL_BUILD
+
+/* Microsecond timebase built from TIM16 itself: update count * period + CNT.
+ * Re-read if an update event lands between the two reads. From an ISR that
+ * masks the TIM16 IRQ the update may still be pending: count it here. */
+uint32_t CtrlExec_NowUs(void)
+{
+  uint32_t t0, cnt, t1, pend;
+  do
+  {
+    t0   = s_timer_ticks;
+    cnt  = __HAL_TIM_GET_COUNTER(&htim16);
+    pend = __HAL_TIM_GET_FLAG(&htim16, TIM_FLAG_UPDATE) ? 1u : 0u;
+    t1   = s_timer_ticks;
+  } while (t0 != t1);
+  /* A pending update with a large CNT was raised after the CNT read */
+  if (pend && cnt < (s_stats.period_us / 2u)) t0++;
+  return t0 * s_stats.period_us + cnt;
+}
+
+static uint32_t tim16_clock_hz(void)
+{
+  /* TIM16 sits on APB2; timer clock is 2x PCLK2 when APB2 is divided. */
+  uint32_t pclk = HAL_RCC_GetPCLK2Freq();
+  if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE2) != RCC_D2CFGR_D2PPRE2_DIV1) pclk *= 2u;
+  return pclk;
+}
+
+void CtrlExec_Start(osThreadId_t task)
+{
+  s_task = (TaskHandle_t)task;
+  s_timer_ticks = 0;
+
+  (void)HAL_TIM_Base_Stop_IT(&htim16);
+  htim16.Init.Prescaler = (tim16_clock_hz() / CTRL_EXEC_TIM_CLK_HZ) - 1u;
+  htim16.Init.Period    = CtrlExec_GetPeriodUs() - 1u;
+  if (HAL_TIM_Base_Init(&htim16) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  __HAL_TIM_CLEAR_FLAG(&htim16, TIM_FLAG_UPDATE);
+  if (HAL_TIM_Base_Start_IT(&htim16) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+void CtrlExec_TimerIsr(void)
+{
+  BaseType_t woken = pdFALSE;
+
+  s_timer_ticks++;
+  if (s_task == NULL) return;
+
+  vTaskNotifyGiveFromISR(s_task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+uint32_t CtrlExec_WaitCycle(void)
+{
+  /* Timeout of two periods (>= 2 ticks) only guards against a stopped timer. */
+  TickType_t timeout = pdMS_TO_TICKS((2u * CtrlExec_GetPeriodUs()) / 1000u) + 2u;
+  uint32_t ticks = ulTaskNotifyTake(pdTRUE, timeout);
+
+  CtrlExec_OnWake(CtrlExec_NowUs(), ticks);
+  return ticks;
+}
+
+void CtrlExec_CycleDone(void)
+{
+  CtrlExec_OnDone(CtrlExec_NowUs());
+}
+
+#else /* SIL_BUILD: pace on the simulated kernel tick */
+
+uint32_t CtrlExec_NowUs(void)
+{
+  return osKernelGetTickCount() * 1000u;
+}
+
+void CtrlExec_Start(osThreadId_t task)
+{
+  (void)task;
+}
+
+void CtrlExec_TimerIsr(void)
+{
+}
+
+uint32_t CtrlExec_WaitCycle(void)
+{
+  uint32_t ms = CtrlExec_GetPeriodUs() / 1000u;
+  osDelay(ms ? ms : 1u);
+  CtrlExec_OnWake(osKernelGetTickCount() * 1000u, 1u);
+  return 1u;
+}
+
+void CtrlExec_CycleDone(void)
+{
+  CtrlExec_OnDone(osKernelGetTickCount() * 1000u);
+}
+
+#endif /* SIL_BUILD */
@@ -0,0 +1,126 @@
+#include "epl.h"
+#include "inv_backend.h"
+#include <stddef.h>
+#include <string.h>
+
+#if (INV_BACKEND == INV_BACKEND_EPL) || defined(INV_BACKEND_ALL)
+
+#define U8(b, f)           { (b), 8u,  0u, (f), 1, 1 }
+#define U16(b, f, m, d)    { (b), 16u, 0u, (f), (m), (d) }
+#define S16(b, f, m, d)    { (b), 16u, 1u, (f), (m), (d) }
+#define SP(member)         ((uint8_t)offsetof(epl_setpoint_t, member))
+
+/* TX_STATE_1..9: drive → VCU. Temperatures, voltages and currents are
+ * sent in tenths. */
+static const epl_sig_t TX1[] = { U8(0, INV_FB_STATE), U16(2, INV_FB_ERROR, 1, 1), U16(4, INV_FB_WARNING, 1, 1) };
+static const epl_sig_t TX2[] = { S16(0, INV_FB_RPM, 1, 1), S16(2, INV_FB_TORQUE, 1, 1) };
+static const epl_sig_t TX3[] = { U16(0, INV_FB_DC_BUS, 1, 10), S16(2, INV_FB_I_DC, 1, 10) };
+static const epl_sig_t TX4[] = { S16(0, INV_FB_I_ACTUAL, 1, 10) };
+static const epl_sig_t TX5[] = { S16(0, INV_FB_T_MOTOR, 1, 10), S16(2, INV_FB_T_IGBT, 1, 10), S16(4, INV_FB_T_AIR, 1, 10) };
+static const epl_sig_t TX6[] = { S16(0, INV_FB_TORQUE_MAX, 1, 1), S16(2, INV_FB_TORQUE_MIN, 1, 1) };
+static const epl_sig_t TX7[] = { U8(0, INV_FB_DERATE) };
+static const epl_sig_t TX8[] = { U16(0, INV_FB_FAULT_CODE, 1, 1) };
+static const epl_sig_t TX9[] = { U8(0, INV_FB_ALIVE) };
+
+/* RX_SETPOINT_1..6: VCU → drive, wire units (no scaling) */
+static const epl_sig_t SP1[] = { U16(0, SP(ctrl), 1, 1), U8(2, SP(mode)) };
+static const epl_sig_t SP2[] = { S16(0, SP(torque_pmil), 1, 1) };
+static const epl_sig_t SP3[] = { S16(0, SP(speed_max_rpm), 1, 1), S16(2, SP(speed_min_rpm), 1, 1) };
+static const epl_sig_t SP4[] = { S16(0, SP(torque_max_dnm), 1, 1), S16(2, SP(torque_min_dnm), 1, 1) };
+static const epl_sig_t SP5[] = { S16(0, SP(idc_max_a), 1, 1), S16(2, SP(idc_min_a), 1, 1) };
+static const epl_sig_t SP6[] = { U16(0, SP(vdc_min_v), 1, 1), U16(2, SP(vdc_max_v), 1, 1) };
+
+#define FRAME(t)  { (t), (uint8_t)(sizeof(t) / sizeof((t)[0])) }
+
+const epl_frame_t EPL_TX[EPL_TX_FRAMES] =
+{
+  FRAME(TX1), FRAME(TX2), FRAME(TX3), FRAME(TX4), FRAME(TX5),
+  FRAME(TX6), FRAME(TX7), FRAME(TX8), FRAME(TX9),
+};
+
+const epl_frame_t EPL_SP[EPL_SP_FRAMES] =
+{
+  FRAME(SP1), FRAME(SP2), FRAME(SP3), FRAME(SP4), FRAME(SP5), FRAME(SP6),
+};
+
+static int32_t sig_get(const epl_sig_t *s, const uint8_t *d)
+{
+  if (s->bits == 8u) return s->sgn ? (int32_t)(int8_t)d[s->byte] : (int32_t)d[s->byte];
+  const uint16_t raw = (uint16_t)((uint16_t)d[s->byte] | ((uint16_t)d[s->byte + 1u] << 8));
+  return s->sgn ? (int32_t)(int16_t)raw : (int32_t)raw;
+}
+
+static void sig_put(const epl_sig_t *s, uint8_t *d, int32_t raw)
+{
+  d[s->byte] = (uint8_t)((uint32_t)raw & 0xFFu);
+  if (s->bits == 16u) d[s->byte + 1u] = (uint8_t)(((uint32_t)raw >> 8) & 0xFFu);
+}
+
+uint16_t Epl_Decode(const can_msg_t *m, app_inputs_t *st, uint32_t now_ms)
+{
+  if (!m || !st) return 0;
+
+  const inv_layout_t *lay = Inv_GetLayout();
+  for (uint8_t k = 0; k < lay->count; k++)
+  {
+    const uint32_t f = m->id - lay->node[k].fb_id;
+    if (f >= EPL_TX_FRAMES || m->bus != lay->node[k].bus) continue;
+
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < EPL_TX[f].n; i++)
+    {
+      const epl_sig_t *s = &EPL_TX[f].sig[i];
+      const int32_t v = (sig_get(s, m->data) * s->mul) / s->div;
+      Inv_FbSet(st, k, (inv_fb_field_t)s->dst, (int16_t)v, now_ms);
+      mask |= (uint16_t)(1u << s->dst);
+    }
+    return mask;
+  }
+  return 0;
+}
+
+void Epl_PackSetpoint(const inv_node_t *nd, const epl_setpoint_t *sp, uint8_t idx, can_msg_t *m)
+{
+  if (!nd || !sp || !m || idx >= EPL_SP_FRAMES) return;
+
+  memset(m, 0, sizeof(*m));
+  m->bus = nd->bus;
+  m->id  = nd->cmd_id + idx;
+  m->dlc = 8;
+  for (uint8_t i = 0; i < EPL_SP[idx].n; i++)
+  {
+    const epl_sig_t *s = &EPL_SP[idx].sig[i];
+    const uint8_t *src = (const uint8_t *)sp + s->dst;
+    int32_t v;
+    if (s->bits == 8u) v = (int32_t)*(const uint16_t *)src;
+    else v = s->sgn ? (int32_t)*(const int16_t *)src : (int32_t)*(const uint16_t *)src;
+    sig_put(s, m->data, v);
+  }
+}
+
+int Epl_DecodeSetpoint(const can_msg_t *m, const inv_node_t *nd, epl_setpoint_t *sp)
+{
+  if (!m || !nd || !sp) return -1;
+  const uint32_t f = m->id - nd->cmd_id;
+  if (f >= EPL_SP_FRAMES) return -1;
+
+  for (uint8_t i = 0; i < EPL_SP[f].n; i++)
+  {
+    const epl_sig_t *s = &EPL_SP[f].sig[i];
+    *(int16_t *)((uint8_t *)sp + s->dst) = (int16_t)sig_get(s, m->data);
+  }
+  return (int)f;
+}
+
+void Epl_BuildCmd(const inv_node_t *nd, int16_t torque_pct, can_msg_t *msgs)
+{
+  epl_setpoint_t sp;
+  memset(&sp, 0, sizeof(sp));
+  sp.ctrl = EPL_CTRL_ENABLE | EPL_CTRL_RUN;
+  sp.mode = EPL_MODE_TORQUE;
+  sp.torque_pmil = (int16_t)(torque_pct * 10);
+  Epl_PackSetpoint(nd, &sp, 0u, &msgs[0]);
+  Epl_PackSetpoint(nd, &sp, 1u, &msgs[1]);
+}
+
+#endif /* INV_BACKEND_EPL */
@@ -21,7 +21,11 @@
 #include "fdcan.h"
 
 /* USER CODE BEGIN 0 */
-
+/* Shared message RAM (2560 words), one block per instance:
+ *   FDCAN1    0..386  1 std + 1 ext filter, RX0/RX1/TX 32 x 4 words (8 B)
+ *   FDCAN2  387..581  same, 16 elements each
+ *   FDCAN3  582..1448 RX0/RX1/TX 16 x 18 words (64 B, CAN-FD)
+ * FDCAN1 (inverter) and FDCAN2 stay classic CAN; FDCAN3 runs FD + BRS. */
 /* USER CODE END 0 */
 
 FDCAN_HandleTypeDef hfdcan1;
@@ -101,7 +105,7 @@ void MX_FDCAN2_Init(void)
   hfdcan2.Init.DataSyncJumpWidth = 1;
   hfdcan2.Init.DataTimeSeg1 = 1;
   hfdcan2.Init.DataTimeSeg2 = 1;
-  hfdcan2.Init.MessageRAMOffset = 0;
+  hfdcan2.Init.MessageRAMOffset = 387;
   hfdcan2.Init.StdFiltersNbr = 1;
   hfdcan2.Init.ExtFiltersNbr = 1;
   hfdcan2.Init.RxFifo0ElmtsNbr = 16;
@@ -136,7 +140,7 @@ void MX_FDCAN3_Init(void)
 
   /* USER CODE END FDCAN3_Init 1 */
   hfdcan3.Instance = FDCAN3;
-  hfdcan3.Init.FrameFormat = FDCAN_FRAME_CLASSIC;
+  hfdcan3.Init.FrameFormat = FDCAN_FRAME_FD_BRS;
   hfdcan3.Init.Mode = FDCAN_MODE_NORMAL;
   hfdcan3.Init.AutoRetransmission = DISABLE;
   hfdcan3.Init.TransmitPause = DISABLE;
@@ -146,29 +150,36 @@ void MX_FDCAN3_Init(void)
   hfdcan3.Init.NominalTimeSeg1 = 2;
   hfdcan3.Init.NominalTimeSeg2 = 5;
   hfdcan3.Init.DataPrescaler = 1;
-  hfdcan3.Init.DataSyncJumpWidth = 1;
-  hfdcan3.Init.DataTimeSeg1 = 1;
-  hfdcan3.Init.DataTimeSeg2 = 1;
-  hfdcan3.Init.MessageRAMOffset = 0;
+  hfdcan3.Init.DataSyncJumpWidth = 3;
+  hfdcan3.Init.DataTimeSeg1 = 8;
+  hfdcan3.Init.DataTimeSeg2 = 3;
+  hfdcan3.Init.MessageRAMOffset = 582;
   hfdcan3.Init.StdFiltersNbr = 1;
   hfdcan3.Init.ExtFiltersNbr = 1;
   hfdcan3.Init.RxFifo0ElmtsNbr = 16;
-  hfdcan3.Init.RxFifo0ElmtSize = FDCAN_DATA_BYTES_8;
+  hfdcan3.Init.RxFifo0ElmtSize = FDCAN_DATA_BYTES_64;
   hfdcan3.Init.RxFifo1ElmtsNbr = 16;
-  hfdcan3.Init.RxFifo1ElmtSize = FDCAN_DATA_BYTES_8;
+  hfdcan3.Init.RxFifo1ElmtSize = FDCAN_DATA_BYTES_64;
   hfdcan3.Init.RxBuffersNbr = 0;
-  hfdcan3.Init.RxBufferSize = FDCAN_DATA_BYTES_8;
+  hfdcan3.Init.RxBufferSize = FDCAN_DATA_BYTES_64;
   hfdcan3.Init.TxEventsNbr = 0;
   hfdcan3.Init.TxBuffersNbr = 0;
   hfdcan3.Init.TxFifoQueueElmtsNbr = 16;
   hfdcan3.Init.TxFifoQueueMode = FDCAN_TX_FIFO_OPERATION;
-  hfdcan3.Init.TxElmtSize = FDCAN_DATA_BYTES_8;
+  hfdcan3.Init.TxElmtSize = FDCAN_DATA_BYTES_64;
   if (HAL_FDCAN_Init(&hfdcan3) != HAL_OK)
   {
     Error_Handler();
   }
   /* USER CODE BEGIN FDCAN3_Init 2 */
-
+  /* 2 Mbit/s data phase (24 MHz / 1 / (1 + 8 + 3), sample point 75 %):
+   * the transceiver loop delay exceeds a data bit, so the secondary sample
+   * point has to follow it (transmitter delay compensation). */
+  if (HAL_FDCAN_ConfigTxDelayCompensation(&hfdcan3, hfdcan3.Init.DataPrescaler * hfdcan3.Init.DataTimeSeg1, 0) != HAL_OK ||
+      HAL_FDCAN_EnableTxDelayCompensation(&hfdcan3) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE END FDCAN3_Init 2 */
 
 }
@@ -22,9 +22,19 @@
 #include "task.h"
 #include "main.h"
 #include "cmsis_os.h"
-#include "can.h"        /* can_qitem16_t, CAN_Pack16, etc.          */
+#include "can.h"        /* can_qitem_t, CAN_Pack, etc.            */
 #include "diag.h"        /* Diag_Log                                  */
 #include "telemetry.h"   /* Telemetry_Build32, Telemetry_Send32       */
+#include "control.h"     /* Control_Init, Control_Step10ms            */
+#include "calib.h"       /* Calib_Init, Calib_Service, Calib_Peek     */
+#include "can_map.h"     /* CanMap_Init: CAN IDs from the calibration  */
+#include "xcp.h"         /* Xcp_Init, Xcp_Rx, Xcp_Event               */
+#include "uds.h"         /* Uds_Init, Uds_Rx, Uds_Service, Uds_Monitor */
+#include "gateway.h"     /* Gateway_Init, Gateway_GetStats: forwarding  */
+#include "tx_sched.h"    /* TxSched_Init, TxSched_Tick: periodic frames */
+#include "ctrl_exec.h"   /* TIM16 control executive                   */
+#include "wheel_speed.h" /* TIM2 wheel-speed input capture             */
+#include "bmi088.h"      /* BMI088 IMU, SPI1 DMA FIFO bursts           */
 #include "test_integration.h"  /* Integration tests – modo HIL (hardware)  */
 
 /* Private includes ----------------------------------------------------------*/
@@ -33,6 +43,7 @@
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticQueue_t osStaticMessageQDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
@@ -49,7 +60,8 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+/* The CAN queues are Static in the .ioc (FREERTOS.Queues01): 72-byte
+ * items (64-byte CAN-FD payload) would take 13.8 KB of the FreeRTOS heap */
 /* USER CODE END Variables */
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
@@ -109,13 +121,25 @@ const osThreadAttr_t IntegrationTestTask_attributes = {
 };
 /* Definitions for canRxQueue */
 osMessageQueueId_t canRxQueueHandle;
+uint8_t canRxQueueBuffer[ 128 * sizeof( can_qitem_t ) ];
+osStaticMessageQDef_t canRxQueueControlBlock;
 const osMessageQueueAttr_t canRxQueue_attributes = {
-  .name = "canRxQueue"
+  .name = "canRxQueue",
+  .cb_mem = &canRxQueueControlBlock,
+  .cb_size = sizeof(canRxQueueControlBlock),
+  .mq_mem = &canRxQueueBuffer,
+  .mq_size = sizeof(canRxQueueBuffer)
 };
 /* Definitions for canTxQueue */
 osMessageQueueId_t canTxQueueHandle;
+uint8_t canTxQueueBuffer[ 64 * sizeof( can_qitem_t ) ];
+osStaticMessageQDef_t canTxQueueControlBlock;
 const osMessageQueueAttr_t canTxQueue_attributes = {
-  .name = "canTxQueue"
+  .name = "canTxQueue",
+  .cb_mem = &canTxQueueControlBlock,
+  .cb_size = sizeof(canTxQueueControlBlock),
+  .mq_mem = &canTxQueueBuffer,
+  .mq_size = sizeof(canTxQueueBuffer)
 };
 
 /* Private function prototypes -----------------------------------------------*/
@@ -160,11 +184,10 @@ void MX_FREERTOS_Init(void) {
 
   /* Create the queue(s) */
   /* creation of canRxQueue */
+  canRxQueueHandle = osMessageQueueNew (128, sizeof(can_qitem_t), &canRxQueue_attributes);
 
-
-canRxQueueHandle = osMessageQueueNew(128, sizeof(can_qitem16_t), NULL);
-canTxQueueHandle = osMessageQueueNew(64,  sizeof(can_qitem16_t), NULL);
-
+  /* creation of canTxQueue */
+  canTxQueueHandle = osMessageQueueNew (64, sizeof(can_qitem_t), &canTxQueue_attributes);
 
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
@@ -240,9 +263,27 @@ void StartAppInitTask(void *argument)
   AppState_Init();
   Diag_Log("State machine initialized (BOOT)\n");
   
+  // Calibration: newest valid flash slot, else defaults (before control)
+  Calib_Init();
+
+  // CAN IDs from the calibration (before anything sends or parses frames)
+  (void)CanMap_Init(&Calib_Peek()->can);
+
+  // Time-triggered periodic frames (IDs from the map, phases spread)
+  (void)TxSched_Init(NULL, 0u);
+
   // Initialize control logic
   Control_Init();
   Diag_Log("Control module initialized\n");
+
+  // XCP measurement / calibration slave (dashboard bus)
+  Xcp_Init();
+
+  // UDS diagnostic server over ISO-TP (dashboard bus)
+  Uds_Init();
+
+  // CAN gateway: forwarding from the RX interrupts (default routing table)
+  (void)Gateway_Init(NULL, 0u);
   
   Diag_Log("=== INITIALIZATION COMPLETE ===\n");
   
@@ -262,28 +303,63 @@ void StartAppInitTask(void *argument)
 void StartControlTask(void *argument)
 {
   /* USER CODE BEGIN StartControlTask */
-  /* Control loop: 10ms period (100Hz) */
+  /* Control loop: paced by TIM16 at CTRL_EXEC_RATE_HZ (1 kHz default).
+   * The timer ISR wakes this task with a direct notification, so the
+   * period no longer drifts with the execution time of the loop body. */
   
   app_inputs_t state_snapshot;
-  control_out_t control_output;
+  static control_out_t control_output;   /* ~1.8 KB with FD-sized frames */
+  static can_msg_t sched[TXS_TICK_MAX];  /* periodic frames due this tick */
+
+  CtrlExec_Init(CTRL_EXEC_RATE_HZ);
+  Control_SetPeriodUs(CtrlExec_GetPeriodUs());
+  CtrlExec_Start(osThreadGetId());
+#if WHEEL_SPEED_USE_CAPTURE
+  WheelSpeed_Init();
+  WheelSpeed_Start();
+#endif
+#if BMI088_ENABLE
+  if (Bmi088_Init() != 0) Diag_Log("BMI088: chip ID mismatch, IMU disabled\n");
+#endif
   
   for(;;)
   {
-    // 1. Take snapshot of application state (thread-safe via mutex)
+    // 1. Wait for the next TIM16 tick (jitter / missed ticks accounted)
+    (void)CtrlExec_WaitCycle();
+
+    // 2. Take snapshot of application state (thread-safe via mutex)
     AppState_Snapshot(&state_snapshot);
+#if WHEEL_SPEED_USE_CAPTURE
+    WheelSpeed_Fill(&state_snapshot);
+#endif
+#if BMI088_ENABLE
+    Bmi088_Fill(&state_snapshot, CtrlExec_NowUs());
+#endif
     
-    // 2. Execute control logic (10ms timestep)
+    // 3. Execute control logic (one executive period)
     Control_Step10ms(&state_snapshot, &control_output);
+
+    // 3b. XCP DAQ lists: same-cycle inputs and outputs
+    Xcp_Event(XCP_EVENT_CTRL, &state_snapshot, &control_output);
     
-    // 3. Process CAN messages to send (if any)
+    // 4. Process CAN messages to send (if any)
     for (uint8_t i = 0; i < control_output.count; i++) {
-      can_qitem16_t qitem;
-      CAN_Pack16(&control_output.msgs[i], &qitem);
+      can_qitem_t qitem;
+      CAN_Pack(&control_output.msgs[i], &qitem);
+      osMessageQueuePut(canTxQueueHandle, &qitem, 0, 0);
+    }
+
+    // 4b. Periodic VCU frames due on this tick, from the same snapshot
+    const uint32_t ns = TxSched_Tick(osKernelGetTickCount(), &state_snapshot, &control_output,
+                                     sched, TXS_TICK_MAX);
+    for (uint32_t i = 0; i < ns; i++) {
+      can_qitem_t qitem;
+      CAN_Pack(&sched[i], &qitem);
       osMessageQueuePut(canTxQueueHandle, &qitem, 0, 0);
     }
     
-    // 4. Sleep for 10ms (100Hz control loop)
-    osDelay(10);
+    // 5. Execution time / overrun accounting
+    CtrlExec_CycleDone();
   }
   /* USER CODE END StartControlTask */
 }
@@ -300,25 +376,30 @@ void StartCanRxTask(void *argument)
   /* USER CODE BEGIN StartCanRxTask */
   /* CAN Receive task: 5ms period */
   
-  can_qitem16_t rx_qitem;
+  can_qitem_t rx_qitem;
   can_msg_t rx_msg;
-  osStatus_t status;
-  app_inputs_t snapshot;
   
   for(;;)
   {
-    // Check if messages in queue (non-blocking)
-    status = osMessageQueueGet(canRxQueueHandle, &rx_qitem, NULL, 0);
-    
-    if (status == osOK) {
+    // Drain everything received since the last pass (an ISO-TP block
+    // arrives back to back: one frame per pass would cap it at 200/s)
+    while (osMessageQueueGet(canRxQueueHandle, &rx_qitem, NULL, 0) == osOK) {
       // Unpack queue item to CAN message
-      CAN_Unpack16(&rx_qitem, &rx_msg);
+      CAN_Unpack(&rx_qitem, &rx_msg);
       
-      // Take snapshot, parse and update
-      AppState_Snapshot(&snapshot);
-      CanRx_ParseAndUpdate(&rx_msg, &snapshot);
-      // (Caller should update shared state under mutex)
+      // XCP and UDS requests (dashboard bus) are answered here
+      if (!Xcp_Rx(&rx_msg) && !Uds_Rx(&rx_msg, CtrlExec_NowUs())) {
+        // Parse straight into the shared state, under its mutex: signal
+        // freshness stamps, handshake acks and inverter feedback all live
+        // in g_in and reach control only through its snapshot
+        osMutexAcquire(g_inMutex, osWaitForever);
+        CanRx_ParseAndUpdate(&rx_msg, &g_in);
+        osMutexRelease(g_inMutex);
+      }
     }
+
+    // UDS: pending request, flow control, next consecutive frames
+    Uds_Service(CtrlExec_NowUs(), UINT32_MAX);
     
     osDelay(5);  // 5ms polling rate (200Hz)
   }
@@ -335,28 +416,27 @@ void StartCanRxTask(void *argument)
 void StartCanTxTask(void *argument)
 {
   /* USER CODE BEGIN StartCanTxTask */
-  /* CAN Transmit task: 20ms period (50Hz) */
+  /* CAN Transmit task: woken by the first queued frame, then drains the
+   * queue (was a 20 ms poll: every frame waited up to one period) */
   
-  can_qitem16_t tx_qitem;
+  can_qitem_t tx_qitem;
   can_msg_t tx_msg;
   osStatus_t status;
   
   for(;;)
   {
-    // Check if messages pending in TX queue (non-blocking)
-    status = osMessageQueueGet(canTxQueueHandle, &tx_qitem, NULL, 0);
+    // Block until something is queued
+    status = osMessageQueueGet(canTxQueueHandle, &tx_qitem, NULL, osWaitForever);
     
     while (status == osOK) {
       // Unpack and transmit
-      CAN_Unpack16(&tx_qitem, &tx_msg);
-      CanTx_SendHal(&tx_msg);
+      CAN_Unpack(&tx_qitem, &tx_msg);
+      if (tx_msg.burst > 1u) CanTx_DrainBurst(&tx_msg);  /* inverter command burst */
+      else CanTx_SendHal(&tx_msg);
       
       // Check for next message (non-blocking)
       status = osMessageQueueGet(canTxQueueHandle, &tx_qitem, NULL, 0);
     }
-    
-    // Sleep for 20ms (50Hz TX rate)
-    osDelay(20);
   }
   /* USER CODE END StartCanTxTask */
 }
@@ -387,8 +467,9 @@ void StartTelemetryTask(void *argument)
     // Send telemetry (UART/nRF24/etc)
     Telemetry_Send32(payload32);
     
-    // Sleep for 100ms (10Hz logging rate)
-    osDelay(100);
+    // Sleep for the calibrated period (100ms / 10Hz by default)
+    const calib_data_t *cal = Calib_Peek();
+    osDelay(cal ? cal->tel_period_ms : 100u);
   }
   /* USER CODE END StartTelemetryTask */
 }
@@ -404,9 +485,50 @@ void StartDiagTask(void *argument)
 {
   /* USER CODE BEGIN StartDiagTask */
   /* Infinite loop */
+  app_inputs_t diag_snapshot;
+  uint32_t diag_ms = 0;
+  uint32_t hs_failed_seen = 0;
+  uint32_t diag_100ms = 0;
 
   for(;;)
   {
+    // Deferred calibration flash writes (sector erase blocks ~1 s)
+    Calib_Service();
+
+    // UDS fault memory: DTC tests every 100 ms
+    if (++diag_ms >= 100u) {
+      diag_ms = 0;
+      AppState_Snapshot(&diag_snapshot);
+      Uds_Monitor(&diag_snapshot);
+
+      // Boot handshakes: a node is reported as soon as it fails (DTC U1002)
+      const hs_t *hs = Control_GetHandshake();
+      const uint32_t hs_failed = Hs_FailedMask(hs);
+      for (uint32_t i = 0; i < HS_NODE_COUNT; i++) {
+        if ((hs_failed & ~hs_failed_seen) & (1u << i)) {
+          Diag_Log("HS: %s FAILED, %u requests unanswered\n",
+                   HS_NODES[i].name, (unsigned)hs->node[i].attempts);
+        }
+      }
+      hs_failed_seen = hs_failed;
+
+      // Gateway: one line per route every second
+      if (++diag_100ms >= 10u) {
+        diag_100ms = 0;
+        for (uint32_t r = 0; r < Gateway_RouteCount(); r++) {
+          gw_stats_t gw;
+          Gateway_GetStats(r, &gw);
+          Diag_Log("GW%lu: match=%lu fwd=%lu lim=%lu drop=%lu lat=%lu/%luus\n",
+                   (unsigned long)r,
+                   (unsigned long)gw.matched,
+                   (unsigned long)gw.forwarded,
+                   (unsigned long)gw.limited,
+                   (unsigned long)gw.dropped,
+                   (unsigned long)gw.lat_last_us,
+                   (unsigned long)gw.lat_max_us);
+        }
+      }
+    }
     osDelay(1);
   }
   /* USER CODE END StartDiagTask */
@@ -0,0 +1,60 @@
+#include "freshness.h"
+
+/* Periods of the sending nodes (VCU.h): pedal and brake sensors, DC bus
+ * and front hub stream at 100 Hz, the ACU and inverter status at 10 Hz.
+ * Handshake acks are events (period 0): stamped, never stale. */
+#define FAST_MS  10u
+#define SLOW_MS  100u
+
+const fresh_sig_t FRESH_SIGNALS[SIG_COUNT] =
+{
+  [SIG_OK_PRECARGA]    = { "ok_precarga",    SLOW_MS },
+  [SIG_DC_BUS_VOLTAGE] = { "dc_bus_voltage", FAST_MS },
+  [SIG_S1_ACELERACION] = { "s1_aceleracion", FAST_MS },
+  [SIG_S2_ACELERACION] = { "s2_aceleracion", FAST_MS },
+  [SIG_S_FRENO]        = { "s_freno",        FAST_MS },
+  [SIG_V_CELDA_MIN]    = { "v_celda_min",    SLOW_MS },
+  [SIG_WHEEL_FRONT]    = { "wheel_front",    FAST_MS },
+  [SIG_INV_STATE]      = { "inv_state",      SLOW_MS },
+  [SIG_ACK_TELEMETRIA] = { "ack_telemetria", 0u      },
+  [SIG_ACK_CAJA_NEGRA] = { "ack_caja_negra", 0u      },
+  [SIG_ACK_PANTALLA]   = { "ack_pantalla",   0u      },
+};
+
+/* Timeouts as a dense array of their own: the check loop is a subtract,
+ * a compare and a shift per signal */
+#define TMO(p)  ((uint32_t)FRESH_MISSED_PERIODS * (p))
+#define EVENT   UINT32_MAX
+
+static const uint32_t FRESH_TIMEOUT_MS[SIG_COUNT] =
+{
+  [SIG_OK_PRECARGA]    = TMO(SLOW_MS),
+  [SIG_DC_BUS_VOLTAGE] = TMO(FAST_MS),
+  [SIG_S1_ACELERACION] = TMO(FAST_MS),
+  [SIG_S2_ACELERACION] = TMO(FAST_MS),
+  [SIG_S_FRENO]        = TMO(FAST_MS),
+  [SIG_V_CELDA_MIN]    = TMO(SLOW_MS),
+  [SIG_WHEEL_FRONT]    = TMO(FAST_MS),
+  [SIG_INV_STATE]      = TMO(SLOW_MS),
+  [SIG_ACK_TELEMETRIA] = EVENT,
+  [SIG_ACK_CAJA_NEGRA] = EVENT,
+  [SIG_ACK_PANTALLA]   = EVENT,
+};
+
+void Fresh_Stamp(app_inputs_t *st, app_sig_t s, uint32_t now_ms)
+{
+  if (!st || (uint32_t)s >= (uint32_t)SIG_COUNT) return;
+  st->sig_tick[s] = now_ms;
+  st->sig_seen |= FRESH_BIT(s);
+}
+
+uint32_t Fresh_Check(const app_inputs_t *in, uint32_t now_ms)
+{
+  if (!in) return 0u;
+  uint32_t late = 0u;
+  for (uint32_t s = 0; s < (uint32_t)SIG_COUNT; s++)
+  {
+    late |= (uint32_t)((now_ms - in->sig_tick[s]) > FRESH_TIMEOUT_MS[s]) << s;
+  }
+  return late & in->sig_seen;
+}
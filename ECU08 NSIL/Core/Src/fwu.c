@@ -0,0 +1,705 @@
+#include "fwu.h"
+#include "sha256.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#endif
+
+#define FWU_DESC_MAGIC   0x31555746u   /* "FWU1" */
+#define FWU_VALID_MAGIC  0x4B4F5746u   /* "FWOK" */
+#define FWU_PAD          0xCCu
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t size;
+  uint32_t crc;
+  uint32_t rsv[5];
+} fwu_desc_t;                          /* one flash word */
+
+/* ---- Flash --------------------------------------------------------------
+ * Non-blocking: *_start() launches one operation, flash_busy() polls it
+ * and flash_finish() collects the result once it is done. Offsets are
+ * relative to FWU_REGION_BASE. */
+
+#ifndef SIL_BUILD
+
+static const uint8_t *flash_ptr(uint32_t off)
+{
+  return (const uint8_t *)(FWU_REGION_BASE + off);
+}
+
+/* The writer programs behind the D-cache: drop stale lines before reading */
+static void flash_sync(void)
+{
+  SCB_InvalidateDCache_by_Addr((uint32_t *)FWU_REGION_BASE, (int32_t)FWU_REGION_SIZE);
+}
+
+static uint8_t flash_busy(uint32_t now_us)
+{
+  (void)now_us;
+  return (FLASH->SR1 & (FLASH_SR_QW | FLASH_SR_BSY)) != 0u;
+}
+
+static void flash_erase_start(uint32_t sector, uint32_t now_us)
+{
+  (void)now_us;
+  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG_BANK1(FLASH_FLAG_ALL_ERRORS_BANK1);
+  FLASH_Erase_Sector(FWU_REGION_SECTOR + sector, FLASH_BANK_1, FLASH_VOLTAGE_RANGE_3);
+}
+
+/* One 256-bit flash word, as HAL_FLASH_Program() minus the wait */
+static void flash_program_start(uint32_t off, const uint8_t *src, uint32_t now_us)
+{
+  (void)now_us;
+  volatile uint32_t *dst = (volatile uint32_t *)(FWU_REGION_BASE + off);
+  const uint32_t *s = (const uint32_t *)(const void *)src;
+  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG_BANK1(FLASH_FLAG_ALL_ERRORS_BANK1);
+  SET_BIT(FLASH->CR1, FLASH_CR_PG);
+  __ISB();
+  __DSB();
+  for (uint32_t i = 0; i < FWU_FLASH_WORD / 4u; i++) dst[i] = s[i];
+  __ISB();
+  __DSB();
+}
+
+static int flash_finish(void)
+{
+  const int err = (FLASH->SR1 & FLASH_FLAG_ALL_ERRORS_BANK1) != 0u;
+  CLEAR_BIT(FLASH->CR1, FLASH_CR_PG | FLASH_CR_SER | FLASH_CR_SNB);
+  HAL_FLASH_Lock();
+  return err ? -1 : 0;
+}
+
+#else /* SIL_BUILD: region in RAM, erased = 0xFF, program = AND, timed */
+
+static uint8_t  s_flash[FWU_REGION_SIZE];
+static uint8_t  s_flash_init;
+static uint32_t s_flash_busy_until;
+static uint32_t s_word_us   = 16u;        /* 256-bit word program          */
+static uint32_t s_sector_us = 1000000u;   /* 128 KB sector erase           */
+static uint8_t  s_boot_req;
+
+uint8_t *Fwu_SilFlash(void)
+{
+  if (!s_flash_init)
+  {
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_flash_init = 1u;
+  }
+  return s_flash;
+}
+
+void Fwu_SilErase(void)
+{
+  memset(Fwu_SilFlash(), 0xFF, sizeof(s_flash));
+}
+
+void Fwu_SilSetTiming(uint32_t word_us, uint32_t sector_us)
+{
+  s_word_us   = word_us;
+  s_sector_us = sector_us;
+}
+
+uint8_t Fwu_SilBootRequested(void)
+{
+  return s_boot_req;
+}
+
+static const uint8_t *flash_ptr(uint32_t off)
+{
+  return Fwu_SilFlash() + off;
+}
+
+static void flash_sync(void)
+{
+}
+
+static uint8_t flash_busy(uint32_t now_us)
+{
+  return (int32_t)(now_us - s_flash_busy_until) < 0;
+}
+
+static void flash_erase_start(uint32_t sector, uint32_t now_us)
+{
+  memset(Fwu_SilFlash() + sector * FWU_SECTOR_SIZE, 0xFF, FWU_SECTOR_SIZE);
+  s_flash_busy_until = now_us + s_sector_us;
+}
+
+static void flash_program_start(uint32_t off, const uint8_t *src, uint32_t now_us)
+{
+  uint8_t *dst = Fwu_SilFlash() + off;
+  for (uint32_t i = 0; i < FWU_FLASH_WORD; i++) dst[i] &= src[i];   /* 1 → 0 only */
+  s_flash_busy_until = now_us + s_word_us;
+}
+
+static int flash_finish(void)
+{
+  return 0;
+}
+
+#endif /* SIL_BUILD */
+
+/* ---- Helpers ------------------------------------------------------------ */
+
+static const uint8_t FD_LEN[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+uint8_t Fwu_LenToDlc(uint8_t len)
+{
+  uint8_t dlc = 0;
+  while (dlc < 15u && FD_LEN[dlc] < len) dlc++;
+  return dlc;
+}
+
+uint8_t Fwu_DlcToLen(uint8_t dlc)
+{
+  return FD_LEN[dlc & 0x0Fu];
+}
+
+/* Nibble table: 16 words of table, two lookups per byte */
+uint32_t Fwu_Crc32(uint32_t crc, const uint8_t *p, uint32_t n)
+{
+  static const uint32_t T[16] =
+  {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+  };
+  crc = ~crc;
+  while (n--)
+  {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ T[crc & 0x0Fu];
+    crc = (crc >> 4) ^ T[crc & 0x0Fu];
+  }
+  return ~crc;
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t word_erased(const uint8_t *w)
+{
+  for (uint32_t i = 0; i < FWU_FLASH_WORD; i++)
+  {
+    if (w[i] != 0xFFu) return 0u;
+  }
+  return 1u;
+}
+
+/* ---- Session state ------------------------------------------------------ */
+
+enum { ST_IDLE = 0, ST_SYNC, ST_ERASE, ST_RECV, ST_VERIFY, ST_DONE };
+enum { B_FREE = 0, B_FILL, B_FULL, B_WRITE };
+
+static fwu_tx_fn_t s_tx;
+static uint8_t     s_state;
+static fwu_stats_t s_stats;
+
+/* START parameters */
+static uint8_t  s_flags;
+static uint32_t s_size;
+static uint32_t s_crc;
+static uint8_t  s_sha[SHA256_DIGEST_LEN];
+
+/* Stream */
+static uint32_t s_next;          /* image offset of the next DATA byte    */
+static uint8_t  s_seq;
+static uint8_t  s_nak;           /* error answered, waiting for a resync  */
+static uint32_t s_acked_limit;
+static uint8_t  s_ack_due;
+static uint8_t  s_ack_status;
+
+/* Double buffer */
+static uint8_t  s_buf[2][FWU_BUF_SIZE] __attribute__((aligned(FWU_FLASH_WORD)));
+static uint32_t s_buf_base[2];
+static uint32_t s_buf_len[2];
+static uint8_t  s_buf_state[2];
+static uint8_t  s_fill;
+static int8_t   s_wr;            /* buffer being programmed, -1 none      */
+static uint32_t s_wr_pos;
+static uint8_t  s_flash_op;      /* an operation is in flight             */
+static uint8_t  s_flash_err;
+
+/* Erase / descriptor / marker sequencing */
+static uint32_t s_erase_next;
+static uint32_t s_erase_end;
+static uint8_t  s_desc_step;
+static uint8_t  s_word[FWU_FLASH_WORD] __attribute__((aligned(4)));
+
+/* Command answer waiting for the TX sink */
+static uint8_t  s_rsp[FWU_FRAME_MAX];
+static uint8_t  s_rsp_len;
+static uint8_t  s_reset_armed;
+static uint8_t  s_reset_req;
+
+static void send_or_hold(const uint8_t *d, uint8_t n)
+{
+  const uint8_t len = Fwu_DlcToLen(Fwu_LenToDlc(n));
+  memset(s_rsp, FWU_PAD, len);
+  memcpy(s_rsp, d, n);
+  s_rsp_len = len;
+  if (s_tx && s_tx(FWU_RSP_ID, s_rsp, len) == 0) s_rsp_len = 0;
+}
+
+static void reply(uint8_t cmd, uint8_t status)
+{
+  const uint8_t r[2] = { (uint8_t)(cmd | 0x80u), status };
+  send_or_hold(r, 2u);
+}
+
+/* Stream position the receive buffers can take without blocking */
+static uint32_t rx_limit(void)
+{
+  uint32_t room = FWU_BUF_SIZE - s_buf_len[s_fill];
+  if (s_buf_state[s_fill] != B_FILL) room = 0;
+  if (s_buf_state[s_fill ^ 1u] == B_FREE) room += FWU_BUF_SIZE;
+  const uint32_t lim = s_next + room;
+  return (lim < s_size) ? lim : s_size;
+}
+
+static void buffers_reset(uint32_t offset)
+{
+  s_buf_state[0] = B_FILL;
+  s_buf_state[1] = B_FREE;
+  s_buf_base[0]  = offset;
+  s_buf_len[0]   = 0;
+  s_buf_len[1]   = 0;
+  s_fill         = 0;
+  s_wr           = -1;
+  s_next         = offset;
+  s_seq          = 0;
+  s_nak          = 0;
+  s_ack_due      = 0;
+  s_ack_status   = FWU_OK;
+}
+
+/* Move filling to the other buffer once the current one is full */
+static void fill_advance(void)
+{
+  const uint8_t o = (uint8_t)(s_fill ^ 1u);
+  if (s_buf_state[s_fill] != B_FULL || s_buf_state[o] != B_FREE || s_next >= s_size) return;
+  s_buf_state[o] = B_FILL;
+  s_buf_base[o]  = s_next;
+  s_buf_len[o]   = 0;
+  s_fill         = o;
+}
+
+static void buf_close(uint8_t b)
+{
+  /* Tail of the last buffer up to a flash word: erased value */
+  const uint32_t end = (s_buf_len[b] + FWU_FLASH_WORD - 1u) / FWU_FLASH_WORD * FWU_FLASH_WORD;
+  memset(&s_buf[b][s_buf_len[b]], 0xFF, end - s_buf_len[b]);
+  s_buf_state[b] = B_FULL;
+  fill_advance();
+}
+
+static uint8_t writer_idle(void)
+{
+  return s_wr < 0 && s_buf_state[0] != B_FULL && s_buf_state[1] != B_FULL && !s_flash_op;
+}
+
+/* End of the last programmed word of the described image */
+static uint32_t resume_point(void)
+{
+  const uint32_t words = (s_size + FWU_FLASH_WORD - 1u) / FWU_FLASH_WORD;
+  for (uint32_t w = words; w > 0u; w--)
+  {
+    if (!word_erased(flash_ptr(FWU_HDR_SIZE + (w - 1u) * FWU_FLASH_WORD)))
+    {
+      const uint32_t end = w * FWU_FLASH_WORD;
+      return (end < s_size) ? end : s_size;
+    }
+  }
+  return 0;
+}
+
+static void answer_start(uint8_t status, uint32_t offset, uint32_t prefix_crc)
+{
+  uint8_t r[14];
+  r[0] = FWU_CMD_START | 0x80u;
+  r[1] = status;
+  wr32(&r[2], offset);
+  wr32(&r[6], prefix_crc);
+  s_acked_limit = (status == FWU_OK) ? rx_limit() : 0u;
+  wr32(&r[10], s_acked_limit);
+  send_or_hold(r, sizeof(r));
+}
+
+/* START once the writer is drained: resume the described image or erase */
+static void session_start(void)
+{
+  flash_sync();
+  const fwu_desc_t *d = (const fwu_desc_t *)(const void *)flash_ptr(0);
+  const uint8_t same = d->magic == FWU_DESC_MAGIC && d->size == s_size && d->crc == s_crc &&
+                       memcmp(flash_ptr(FWU_FLASH_WORD), s_sha, SHA256_DIGEST_LEN) == 0;
+  if (same && !(s_flags & FWU_START_FORCE))
+  {
+    const uint8_t done = rd32(flash_ptr(2u * FWU_FLASH_WORD)) == FWU_VALID_MAGIC;
+    const uint32_t off = done ? s_size : resume_point();
+    buffers_reset(off);
+    s_state = ST_RECV;
+    s_stats.resumes += (off > 0u);
+    answer_start(FWU_OK, off, Fwu_Crc32(0u, flash_ptr(FWU_HDR_SIZE), off));
+    return;
+  }
+  s_erase_next = 0;
+  s_erase_end  = (FWU_HDR_SIZE + s_size + FWU_SECTOR_SIZE - 1u) / FWU_SECTOR_SIZE;
+  s_desc_step  = 0;
+  s_state      = ST_ERASE;
+}
+
+/* ---- Commands ----------------------------------------------------------- */
+
+static void on_start(const uint8_t *q, uint8_t n)
+{
+  if (n < 10u + SHA256_DIGEST_LEN)
+  {
+    reply(FWU_CMD_START, FWU_ERR_LENGTH);
+    return;
+  }
+  const uint32_t size = rd32(&q[2]);
+  if (size == 0u || size > FWU_IMAGE_MAX)
+  {
+    reply(FWU_CMD_START, FWU_ERR_RANGE);
+    return;
+  }
+  if (s_state == ST_ERASE) return;           /* answered when it ends */
+  s_flags = q[1];
+  s_size  = size;
+  s_crc   = rd32(&q[6]);
+  memcpy(s_sha, &q[10], SHA256_DIGEST_LEN);
+  /* Whatever sits in the fill buffer is dropped; full buffers are still
+   * programmed, then the resume point comes from flash */
+  if (s_buf_state[s_fill] == B_FILL) s_buf_state[s_fill] = B_FREE;
+  s_state = ST_SYNC;
+}
+
+static void on_data(const uint8_t *q, uint8_t n)
+{
+  if (s_state != ST_RECV)
+  {
+    if (s_state == ST_IDLE && !s_nak)       /* no session: host resyncs */
+    {
+      s_nak = 1u;
+      s_ack_status = FWU_ERR_STATE;
+      s_ack_due = 1u;
+    }
+    return;
+  }
+  const uint32_t len = (n > 2u) ? n - 2u : 0u;
+  if (q[1] != s_seq || s_next + len > rx_limit())
+  {
+    /* Lost frame (or a host ignoring the limit): one NAK, then silence
+     * until the host restarts at s_next with the expected seq */
+    if (!s_nak)
+    {
+      s_nak = 1u;
+      s_stats.seq_errors++;
+      s_ack_status = FWU_ERR_SEQ;
+      s_ack_due = 1u;
+    }
+    return;
+  }
+  s_nak = 0;
+  s_seq++;
+  s_stats.frames++;
+
+  const uint8_t *p = &q[2];
+  uint32_t left = len;
+  while (left)
+  {
+    const uint8_t b = s_fill;
+    uint32_t take = FWU_BUF_SIZE - s_buf_len[b];
+    if (take > left) take = left;
+    memcpy(&s_buf[b][s_buf_len[b]], p, take);
+    s_buf_len[b] += take;
+    s_next += take;
+    p += take;
+    left -= take;
+    if (s_buf_len[b] == FWU_BUF_SIZE || s_next == s_size) buf_close(b);
+  }
+  if (s_next == s_size)
+  {
+    s_ack_status = FWU_OK;
+    s_ack_due = 1u;
+  }
+}
+
+int Fwu_OnFrame(uint32_t id, const uint8_t *data, uint8_t len, uint32_t now_us)
+{
+  (void)now_us;
+  if (id != FWU_CMD_ID) return 0;
+  if (len == 0u) return 1;
+
+  switch (data[0])
+  {
+    case FWU_CMD_CONNECT:
+    {
+      uint8_t r[9];
+      r[0] = FWU_CMD_CONNECT | 0x80u;
+      r[1] = FWU_OK;
+      r[2] = FWU_PROTO_VERSION;
+      r[3] = (uint8_t)FWU_BUF_SIZE;
+      r[4] = (uint8_t)(FWU_BUF_SIZE >> 8);
+      wr32(&r[5], FWU_IMAGE_MAX);
+      send_or_hold(r, sizeof(r));
+      break;
+    }
+    case FWU_CMD_START:  on_start(data, len); break;
+    case FWU_CMD_DATA:   on_data(data, len);  break;
+    case FWU_CMD_VERIFY:
+      if (s_state == ST_DONE) reply(FWU_CMD_VERIFY, FWU_OK);
+      else if (s_state != ST_RECV || s_next != s_size) reply(FWU_CMD_VERIFY, FWU_ERR_STATE);
+      else
+      {
+        s_desc_step = 0;
+        s_state = ST_VERIFY;
+      }
+      break;
+    case FWU_CMD_RESET:
+      reply(FWU_CMD_RESET, FWU_OK);
+      s_reset_armed = 1u;
+      break;
+    default:
+      break;
+  }
+  return 1;
+}
+
+/* ---- Poll --------------------------------------------------------------- */
+
+static void send_ack(void)
+{
+  uint8_t r[12];                             /* 11 bytes, FD length 12 */
+  const uint32_t lim = rx_limit();
+  r[11] = FWU_PAD;
+  r[0] = FWU_CMD_DATA | 0x80u;
+  r[1] = s_ack_status;
+  r[2] = s_seq;
+  wr32(&r[3], s_next);
+  wr32(&r[7], lim);
+  if (s_tx && s_tx(FWU_RSP_ID, r, sizeof(r)) == 0)
+  {
+    s_acked_limit = lim;
+    s_ack_due = 0;
+    s_ack_status = FWU_OK;
+  }
+}
+
+/* Next word of the buffer being programmed, erased words skipped */
+static void writer_step(uint32_t now_us)
+{
+  if (s_wr < 0)
+  {
+    int8_t pick = -1;
+    for (int8_t b = 0; b < 2; b++)
+    {
+      if (s_buf_state[b] == B_FULL && (pick < 0 || s_buf_base[b] < s_buf_base[pick])) pick = b;
+    }
+    if (pick < 0) return;
+    s_wr = pick;
+    s_wr_pos = 0;
+    s_buf_state[pick] = B_WRITE;
+  }
+
+  const uint8_t b = (uint8_t)s_wr;
+  while (s_wr_pos < s_buf_len[b] && word_erased(&s_buf[b][s_wr_pos]))
+  {
+    s_wr_pos += FWU_FLASH_WORD;
+    s_stats.words_skipped++;
+  }
+  if (s_wr_pos < s_buf_len[b])
+  {
+    flash_program_start(FWU_HDR_SIZE + s_buf_base[b] + s_wr_pos, &s_buf[b][s_wr_pos], now_us);
+    s_flash_op = 1u;
+    s_wr_pos += FWU_FLASH_WORD;
+    s_stats.words++;
+    return;
+  }
+  s_buf_state[b] = B_FREE;
+  s_buf_len[b] = 0;
+  s_wr = -1;
+  fill_advance();
+}
+
+static void verify_step(uint32_t now_us)
+{
+  if (s_desc_step == 0u)
+  {
+    flash_sync();
+    sha256_ctx_t c;
+    uint8_t sha[SHA256_DIGEST_LEN];
+    Sha256_Init(&c);
+    Sha256_Update(&c, flash_ptr(FWU_HDR_SIZE), s_size);
+    Sha256_Final(&c, sha);
+    if (Fwu_Crc32(0u, flash_ptr(FWU_HDR_SIZE), s_size) != s_crc ||
+        memcmp(sha, s_sha, SHA256_DIGEST_LEN) != 0)
+    {
+      s_state = ST_IDLE;
+      reply(FWU_CMD_VERIFY, FWU_ERR_VERIFY);
+      return;
+    }
+    if (rd32(flash_ptr(2u * FWU_FLASH_WORD)) == FWU_VALID_MAGIC)
+    {
+      s_state = ST_DONE;                     /* same image again */
+      reply(FWU_CMD_VERIFY, FWU_OK);
+      return;
+    }
+    memset(s_word, 0xFF, sizeof(s_word));
+    wr32(s_word, FWU_VALID_MAGIC);
+    flash_program_start(2u * FWU_FLASH_WORD, s_word, now_us);
+    s_flash_op = 1u;
+    s_desc_step = 1u;
+    return;
+  }
+  s_state = ST_DONE;
+  reply(FWU_CMD_VERIFY, FWU_OK);
+}
+
+static void erase_step(uint32_t now_us)
+{
+  if (s_erase_next < s_erase_end)
+  {
+    flash_erase_start(s_erase_next++, now_us);
+    s_flash_op = 1u;
+    s_stats.sectors++;
+    return;
+  }
+  if (s_desc_step < 2u)
+  {
+    memset(s_word, 0xFF, sizeof(s_word));
+    if (s_desc_step == 0u)
+    {
+      fwu_desc_t *d = (fwu_desc_t *)(void *)s_word;
+      d->magic = FWU_DESC_MAGIC;
+      d->size  = s_size;
+      d->crc   = s_crc;
+    }
+    else
+    {
+      memcpy(s_word, s_sha, SHA256_DIGEST_LEN);
+    }
+    flash_program_start((uint32_t)s_desc_step * FWU_FLASH_WORD, s_word, now_us);
+    s_flash_op = 1u;
+    s_desc_step++;
+    return;
+  }
+  buffers_reset(0u);
+  s_state = ST_RECV;
+  answer_start(FWU_OK, 0u, 0u);
+}
+
+void Fwu_Poll(uint32_t now_us)
+{
+  if (s_rsp_len && s_tx && s_tx(FWU_RSP_ID, s_rsp, s_rsp_len) == 0) s_rsp_len = 0;
+  if (s_reset_armed && !s_rsp_len) s_reset_req = 1u;
+
+  if (!flash_busy(now_us))
+  {
+    if (s_flash_op)
+    {
+      s_flash_op = 0;
+      if (flash_finish() != 0) s_flash_err = 1u;
+    }
+    if (s_flash_err)
+    {
+      s_flash_err = 0;
+      buffers_reset(0u);
+      s_buf_state[0] = B_FREE;
+      if (s_state == ST_ERASE) answer_start(FWU_ERR_FLASH, 0u, 0u);
+      else if (s_state == ST_VERIFY) reply(FWU_CMD_VERIFY, FWU_ERR_FLASH);
+      s_state = ST_IDLE;
+    }
+    else if (s_state == ST_ERASE)
+    {
+      erase_step(now_us);
+    }
+    else if (!s_rsp_len)
+    {
+      writer_step(now_us);
+      if (!s_flash_op)
+      {
+        if (s_state == ST_SYNC && writer_idle()) session_start();
+        else if (s_state == ST_VERIFY && writer_idle()) verify_step(now_us);
+      }
+    }
+  }
+  else if (s_buf_state[s_fill] == B_FULL && s_next < s_size)
+  {
+    s_stats.stalls++;
+  }
+
+  if (s_state == ST_RECV && !s_nak && rx_limit() >= s_acked_limit + FWU_ACK_STEP) s_ack_due = 1u;
+  if (s_ack_due) send_ack();
+}
+
+/* ---- Public ------------------------------------------------------------- */
+
+void Fwu_Init(fwu_tx_fn_t tx)
+{
+  s_tx = tx;
+  s_state = ST_IDLE;
+  s_rsp_len = 0;
+  s_reset_armed = 0;
+  s_reset_req = 0;
+  s_ack_due = 0;
+  s_ack_status = FWU_OK;
+  s_flash_op = 0;
+  s_flash_err = 0;
+  s_size = 0;
+  buffers_reset(0u);
+  s_buf_state[0] = B_FREE;
+  memset(&s_stats, 0, sizeof(s_stats));
+#ifdef SIL_BUILD
+  s_flash_busy_until = 0;              /* a reset aborts the flash operation */
+#endif
+}
+
+uint8_t Fwu_ResetRequested(void)
+{
+  return s_reset_req;
+}
+
+uint8_t Fwu_AppValid(void)
+{
+  flash_sync();
+  const fwu_desc_t *d = (const fwu_desc_t *)(const void *)flash_ptr(0);
+  if (d->magic == FWU_DESC_MAGIC) return rd32(flash_ptr(2u * FWU_FLASH_WORD)) == FWU_VALID_MAGIC;
+  if (d->magic != 0xFFFFFFFFu) return 0u;
+
+  /* Loaded with a debugger: initial SP in RAM, reset vector in the image */
+  const uint32_t sp = rd32(flash_ptr(FWU_HDR_SIZE));
+  const uint32_t pc = rd32(flash_ptr(FWU_HDR_SIZE + 4u)) & ~1u;
+  const uint8_t sp_ok = (sp > 0x20000000u && sp <= 0x20020000u) ||
+                        (sp > 0x24000000u && sp <= 0x24050000u);
+  return sp_ok && pc >= FWU_IMAGE_BASE && pc < FWU_REGION_BASE + FWU_REGION_SIZE;
+}
+
+void Fwu_GetStats(fwu_stats_t *out)
+{
+  *out = s_stats;
+}
+
+void Fwu_EnterBootloader(void)
+{
+#ifndef SIL_BUILD
+  *(volatile uint32_t *)FWU_BOOT_FLAG_ADDR = FWU_BOOT_MAGIC;
+  __DSB();
+  NVIC_SystemReset();
+#else
+  s_boot_req = 1u;
+#endif
+}
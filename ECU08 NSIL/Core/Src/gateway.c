@@ -0,0 +1,163 @@
+#include "gateway.h"
+#include "can_map.h"
+#include "ctrl_exec.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#define GW_DMB()  __DMB()
+#else
+#define GW_DMB()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define GW_BUS_SLOTS  (CAN_BUS_DASH + 1)
+
+/* Routing table of the car. Inverter feedback (BAMOCAR REGID responses)
+ * for the dashboard; pedal and brake sensors for the telemetry logger on
+ * the ACU bus at 100 Hz each; minimum cell voltage for the dashboard.
+ * Frames of the CAN map are routed by key, so they follow the map. */
+const gw_route_t GW_ROUTES[] =
+{
+  { CAN_BUS_INV,  0u, GW_BUS(CAN_BUS_DASH), 0u, 0x180u, 0x7F8u, GW_NO_REMAP, 0u      },
+  { CAN_BUS_DASH, 0u, GW_BUS(CAN_BUS_ACU),  0u, CANMAP_REF(CANMAP_S1_ACELERACION), 0x7FFu, GW_NO_REMAP, 10000u  },
+  { CAN_BUS_DASH, 0u, GW_BUS(CAN_BUS_ACU),  0u, CANMAP_REF(CANMAP_S2_ACELERACION), 0x7FFu, GW_NO_REMAP, 10000u  },
+  { CAN_BUS_DASH, 0u, GW_BUS(CAN_BUS_ACU),  0u, CANMAP_REF(CANMAP_S_FRENO),        0x7FFu, GW_NO_REMAP, 10000u  },
+  { CAN_BUS_ACU,  0u, GW_BUS(CAN_BUS_DASH), 0u, CANMAP_REF(CANMAP_V_CELDA_MIN),    0x7FFu, GW_NO_REMAP, 100000u },
+};
+const uint32_t GW_ROUTE_COUNT = (uint32_t)(sizeof(GW_ROUTES) / sizeof(GW_ROUTES[0]));
+
+static gw_route_t s_routes[GW_MAX_ROUTES];
+static gw_stats_t s_stats[GW_MAX_ROUTES];
+static uint32_t   s_last_fwd[GW_MAX_ROUTES];
+static uint8_t    s_fwd_once[GW_MAX_ROUTES];
+static uint32_t   s_n;
+
+/* Per source bus: route indices, in table order */
+static uint8_t    s_by_bus[GW_BUS_SLOTS][GW_MAX_ROUTES];
+static uint8_t    s_by_bus_n[GW_BUS_SLOTS];
+
+static uint32_t (*s_now)(void) = CtrlExec_NowUs;
+
+static int route_ok(const gw_route_t *r)
+{
+  const uint32_t id_bits = r->ide ? 0x1FFFFFFFu : 0x7FFu;
+  if (r->src < CAN_BUS_INV || r->src > CAN_BUS_DASH) return 0;
+  if ((r->dst & (uint8_t)~(GW_BUS(CAN_BUS_INV) | GW_BUS(CAN_BUS_ACU) | GW_BUS(CAN_BUS_DASH))) != 0u) return 0;
+  if ((r->dst & (uint8_t)~GW_BUS(r->src)) == 0u) return 0;
+  if ((r->id & ~r->mask) != 0u || (r->mask & ~id_bits) != 0u) return 0;
+  if (r->remap != GW_NO_REMAP && (r->remap & ~r->mask) != 0u) return 0;
+  return 1;
+}
+
+int Gateway_Init(const gw_route_t *routes, uint32_t n)
+{
+  if (!routes)
+  {
+    routes = GW_ROUTES;
+    n = GW_ROUTE_COUNT;
+  }
+  if (n > GW_MAX_ROUTES) return -1;
+
+  /* Map keys become the live IDs here, so the map must be loaded first */
+  gw_route_t res[GW_MAX_ROUTES];
+  for (uint32_t i = 0; i < n; i++)
+  {
+    res[i] = routes[i];
+    res[i].id = CanMap_Resolve(routes[i].id);
+    if ((routes[i].id & CANMAP_REF_FLAG) && res[i].id == 0u) return -1;
+    if (!route_ok(&res[i])) return -1;
+  }
+
+  /* The RX interrupts may already run: hide the table while it changes */
+  memset(s_by_bus_n, 0, sizeof(s_by_bus_n));
+  GW_DMB();
+
+  memcpy(s_routes, res, n * sizeof(gw_route_t));
+  s_n = n;
+  Gateway_ResetStats();
+
+  uint8_t cnt[GW_BUS_SLOTS] = { 0u };
+  for (uint32_t i = 0; i < n; i++)
+  {
+    const uint32_t b = (uint32_t)s_routes[i].src;
+    s_by_bus[b][cnt[b]++] = (uint8_t)i;
+  }
+  GW_DMB();
+  memcpy(s_by_bus_n, cnt, sizeof(s_by_bus_n));
+  return 0;
+}
+
+int Gateway_Forward(can_msg_t *m)
+{
+  if (!m || (uint32_t)m->bus >= GW_BUS_SLOTS) return 0;
+  const uint32_t nr = s_by_bus_n[m->bus];
+  if (nr == 0u) return 0;
+
+  const uint32_t t0  = s_now();
+  const can_bus_t src = m->bus;
+  const uint32_t id  = m->id;
+  int no_local = 0;
+
+  for (uint32_t k = 0; k < nr; k++)
+  {
+    const uint32_t i = s_by_bus[src][k];
+    const gw_route_t *r = &s_routes[i];
+    if ((id & r->mask) != r->id || m->ide != r->ide) continue;
+
+    gw_stats_t *st = &s_stats[i];
+    st->matched++;
+    if (r->flags & GW_NO_LOCAL) no_local = 1;
+
+    if (r->min_gap_us != 0u && s_fwd_once[i] && t0 - s_last_fwd[i] < r->min_gap_us)
+    {
+      st->limited++;
+      continue;
+    }
+    s_last_fwd[i] = t0;
+    s_fwd_once[i] = 1u;
+
+    /* Same buffer for every destination: only the header changes */
+    m->id = (r->remap == GW_NO_REMAP) ? id : ((id & ~r->mask) | r->remap);
+    for (uint32_t b = CAN_BUS_INV; b <= (uint32_t)CAN_BUS_DASH; b++)
+    {
+      if (b == (uint32_t)src || (r->dst & GW_BUS(b)) == 0u) continue;
+      m->bus = (can_bus_t)b;
+      if (CanTx_SendHal(m) == HAL_OK) st->forwarded++;
+      else st->dropped++;
+    }
+    m->bus = src;
+    m->id  = id;
+
+    const uint32_t lat = s_now() - t0;
+    st->lat_last_us = lat;
+    if (lat > st->lat_max_us) st->lat_max_us = lat;
+  }
+  return no_local;
+}
+
+uint32_t Gateway_RouteCount(void)
+{
+  return s_n;
+}
+
+void Gateway_GetStats(uint32_t route, gw_stats_t *out)
+{
+  if (!out) return;
+  if (route >= s_n)
+  {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = s_stats[route];
+}
+
+void Gateway_ResetStats(void)
+{
+  memset(s_stats, 0, sizeof(s_stats));
+  memset(s_fwd_once, 0, sizeof(s_fwd_once));
+}
+
+void Gateway_SetClock(uint32_t (*now_us)(void))
+{
+  s_now = now_us ? now_us : CtrlExec_NowUs;
+}
@@ -0,0 +1,126 @@
+#include "handshake.h"
+#include "freshness.h"
+#include <string.h>
+
+/* Nodes of the car. Telemetry ECU and black box answer within a cycle of
+ * their own loop; the dashboard screen is a Raspberry Pi, up to ~30 s to
+ * boot. Precharge normally completes in a few seconds. */
+const hs_node_t HS_NODES[HS_NODE_COUNT] =
+{
+  [HS_NODE_AMS]        = { "ams",        CAN_BUS_ACU,  HS_NO_REQ,
+                           SIG_OK_PRECARGA,    10000u, 0u,  HS_REQUIRED | HS_PRECHARGE },
+  [HS_NODE_TELEMETRIA] = { "telemetria", CAN_BUS_DASH, CANMAP_REF(CANMAP_OK_TELEMETRIA),
+                           SIG_ACK_TELEMETRIA,   200u, 4u,  0u },
+  [HS_NODE_CAJA_NEGRA] = { "caja_negra", CAN_BUS_DASH, CANMAP_REF(CANMAP_OK_CAJA_NEGRA),
+                           SIG_ACK_CAJA_NEGRA,   200u, 4u,  0u },
+  [HS_NODE_PANTALLA]   = { "pantalla",   CAN_BUS_DASH, CANMAP_REF(CANMAP_OK_PANTALLA),
+                           SIG_ACK_PANTALLA,    1000u, 29u, 0u },
+};
+
+void Hs_Init(hs_t *hs)
+{
+  if (!hs) return;
+  memset(hs, 0, sizeof(*hs));
+}
+
+/* Ack received since the first request (a stale one from before does not count) */
+static uint8_t acked(const hs_node_t *nd, const hs_node_state_t *ns, const app_inputs_t *in)
+{
+  if (nd->flags & HS_PRECHARGE) return in->ok_precarga ? 1u : 0u;
+  if (!(in->sig_seen & FRESH_BIT(nd->ack))) return 0u;
+  return ((int32_t)(in->sig_tick[nd->ack] - ns->t_start) >= 0) ? 1u : 0u;
+}
+
+static void request(const hs_node_t *nd, can_msg_t *m)
+{
+  memset(m, 0, sizeof(*m));
+  m->bus = nd->bus;
+  m->id  = CanMap_Resolve(nd->req_id);
+  m->dlc = 1u;
+  m->data[0] = 1u;            /* VCU up */
+}
+
+uint32_t Hs_Service(hs_t *hs, const app_inputs_t *in, uint32_t now_ms, can_msg_t *msgs, uint32_t room)
+{
+  if (!hs || !in) return 0u;
+
+  uint32_t c = 0;
+  for (uint32_t i = 0; i < HS_NODE_COUNT; i++)
+  {
+    const hs_node_t *nd = &HS_NODES[i];
+    hs_node_state_t *ns = &hs->node[i];
+    const uint8_t active = (nd->req_id != HS_NO_REQ) ? 1u : 0u;
+
+    switch ((hs_state_t)ns->state)
+    {
+      case HS_IDLE:
+        if (active)
+        {
+          if (c >= room || !msgs) break;
+          request(nd, &msgs[c++]);
+          ns->attempts = 1u;
+        }
+        ns->t_start = now_ms;
+        ns->t_req = now_ms;
+        ns->state = HS_WAIT;
+        /* fall through - the ack may already be there (precharge done) */
+
+      case HS_WAIT:
+      case HS_FAILED:
+        if (acked(nd, ns, in))
+        {
+          ns->ready_ms = now_ms - ns->t_start;
+          ns->state = HS_READY;
+        }
+        else if (ns->state == HS_WAIT && now_ms - ns->t_req >= nd->timeout_ms)
+        {
+          if (!active || ns->attempts > nd->retries)
+          {
+            ns->state = HS_FAILED;
+          }
+          else if (c < room && msgs)
+          {
+            request(nd, &msgs[c++]);
+            ns->attempts++;
+            ns->t_req = now_ms;
+          }
+        }
+        break;
+
+      case HS_READY:
+      default:
+        break;
+    }
+  }
+  return c;
+}
+
+uint8_t Hs_RequiredReady(const hs_t *hs)
+{
+  if (!hs) return 0u;
+  for (uint32_t i = 0; i < HS_NODE_COUNT; i++)
+  {
+    if ((HS_NODES[i].flags & HS_REQUIRED) && hs->node[i].state != HS_READY) return 0u;
+  }
+  return 1u;
+}
+
+uint32_t Hs_ReadyMask(const hs_t *hs)
+{
+  uint32_t m = 0;
+  for (uint32_t i = 0; hs && i < HS_NODE_COUNT; i++)
+  {
+    if (hs->node[i].state == HS_READY) m |= 1u << i;
+  }
+  return m;
+}
+
+uint32_t Hs_FailedMask(const hs_t *hs)
+{
+  uint32_t m = 0;
+  for (uint32_t i = 0; hs && i < HS_NODE_COUNT; i++)
+  {
+    if (hs->node[i].state == HS_FAILED) m |= 1u << i;
+  }
+  return m;
+}
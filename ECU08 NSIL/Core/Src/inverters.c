@@ -0,0 +1,182 @@
+#include "inverters.h"
+#include "inv_backend.h"
+#include <stddef.h>
+
+/* Current car: one BAMOCAR driving the rear axle (txID 0x181, rxID 0x201). */
+const inv_layout_t INV_LAYOUT_1WD =
+{
+  .count       = 1u,
+  .front_share = 0.0f,
+  .node =
+  {
+    { CAN_BUS_INV, 0x181u, 0x201u, 0x181u, 0, INV_AXLE_REAR },
+  },
+};
+
+/* 4WD: one drive per wheel, BAMOCAR node IDs 1..4 (txID 0x180+n, rxID
+ * 0x200+n). Even axle split until the motor sizes are fixed. */
+const inv_layout_t INV_LAYOUT_4WD =
+{
+  .count       = 4u,
+  .front_share = 0.5f,
+  .node =
+  {
+    { CAN_BUS_INV, 0x181u, 0x201u, 0x181u, -1, INV_AXLE_FRONT },  /* FL */
+    { CAN_BUS_INV, 0x182u, 0x202u, 0x182u, +1, INV_AXLE_FRONT },  /* FR */
+    { CAN_BUS_INV, 0x183u, 0x203u, 0x183u, -1, INV_AXLE_REAR  },  /* RL */
+    { CAN_BUS_INV, 0x184u, 0x204u, 0x184u, +1, INV_AXLE_REAR  },  /* RR */
+  },
+};
+
+#if (INV_BACKEND == INV_BACKEND_EPL) || defined(INV_BACKEND_ALL)
+/* One ePowerLabs drive on the rear axle: RX_SETPOINT_1.. from 0x360,
+ * TX_STATE_1.. from 0x460 (epl.h). */
+const inv_layout_t INV_LAYOUT_EPL =
+{
+  .count       = 1u,
+  .front_share = 0.0f,
+  .node =
+  {
+    { CAN_BUS_INV, 0x360u, 0x360u, 0x460u, 0, INV_AXLE_REAR },
+  },
+};
+#endif
+
+#if INV_BACKEND == INV_BACKEND_EPL
+#define INV_LAYOUT_DEFAULT  (&INV_LAYOUT_EPL)
+#else
+#define INV_LAYOUT_DEFAULT  (&INV_LAYOUT_1WD)
+#endif
+
+static const inv_layout_t *s_layout = INV_LAYOUT_DEFAULT;
+
+void Inv_SetLayout(const inv_layout_t *layout)
+{
+  if (!layout || layout->count == 0u || layout->count > INV_MAX) layout = INV_LAYOUT_DEFAULT;
+  s_layout = layout;
+}
+
+const inv_layout_t *Inv_GetLayout(void)
+{
+  return s_layout;
+}
+
+int Inv_IndexByFeedbackId(uint32_t fb_id)
+{
+  for (uint8_t k = 0; k < s_layout->count; k++)
+  {
+    if (s_layout->node[k].fb_id == fb_id) return (int)k;
+  }
+  return -1;
+}
+
+/* inv_fb_field_t → inv_fb_t member; every member is 16 bits */
+static const uint8_t FB_OFFSET[INV_FB_COUNT] =
+{
+  [INV_FB_RPM]        = offsetof(inv_fb_t, rpm),
+  [INV_FB_I_ACTUAL]   = offsetof(inv_fb_t, i_actual),
+  [INV_FB_T_MOTOR]    = offsetof(inv_fb_t, motor_temp),
+  [INV_FB_T_IGBT]     = offsetof(inv_fb_t, igbt_temp),
+  [INV_FB_T_AIR]      = offsetof(inv_fb_t, air_temp),
+  [INV_FB_DC_BUS]     = offsetof(inv_fb_t, dc_bus_v),
+  [INV_FB_TORQUE]     = offsetof(inv_fb_t, torque_dnm),
+  [INV_FB_TORQUE_MAX] = offsetof(inv_fb_t, torque_max_dnm),
+  [INV_FB_TORQUE_MIN] = offsetof(inv_fb_t, torque_min_dnm),
+  [INV_FB_I_DC]       = offsetof(inv_fb_t, i_dc),
+  [INV_FB_STATE]      = offsetof(inv_fb_t, state),
+  [INV_FB_ERROR]      = offsetof(inv_fb_t, error),
+  [INV_FB_WARNING]    = offsetof(inv_fb_t, warning),
+  [INV_FB_DERATE]     = offsetof(inv_fb_t, derate_pct),
+  [INV_FB_FAULT_CODE] = offsetof(inv_fb_t, fault_code),
+  [INV_FB_ALIVE]      = offsetof(inv_fb_t, alive),
+};
+
+static int16_t fb_field(const inv_fb_t *fb, inv_fb_field_t field)
+{
+  return *(const int16_t *)((const uint8_t *)fb + FB_OFFSET[field]);
+}
+
+void Inv_FbSet(app_inputs_t *st, uint8_t k, inv_fb_field_t field, int16_t v, uint32_t now_tick)
+{
+  if (!st || k >= INV_MAX || (uint32_t)field >= INV_FB_COUNT) return;
+
+  inv_fb_t *fb = &st->inv[k];
+  *(int16_t *)((uint8_t *)fb + FB_OFFSET[field]) = v;
+  fb->fld_seen |= (uint16_t)(1u << field);
+  fb->fld_tick[field] = now_tick;
+  fb->seen = 1;
+  fb->rx_tick = now_tick;
+  Inv_Aggregate(st, field);
+}
+
+int16_t Inv_FbGet(const inv_fb_t *fb, inv_fb_field_t field)
+{
+  if (!fb || (uint32_t)field >= INV_FB_COUNT) return 0;
+  return fb_field(fb, field);
+}
+
+void Inv_Aggregate(app_inputs_t *st, inv_fb_field_t field)
+{
+  if (!st || (uint32_t)field >= INV_FB_COUNT) return;
+
+  int32_t sum = 0, max = INT16_MIN;
+  uint8_t n = 0;
+  for (uint8_t k = 0; k < s_layout->count; k++)
+  {
+    if (!(st->inv[k].fld_seen & (1u << field))) continue;
+    int16_t v = fb_field(&st->inv[k], field);
+    sum += v;
+    if (v > max) max = v;
+    n++;
+  }
+  if (n == 0u) return;
+
+  switch (field)
+  {
+    case INV_FB_RPM:      st->inv_rpm = (int16_t)(sum / n); break;
+    case INV_FB_I_ACTUAL:
+      if (sum > INT16_MAX) sum = INT16_MAX;
+      if (sum < INT16_MIN) sum = INT16_MIN;
+      st->inv_i_actual = (int16_t)sum;
+      break;
+    case INV_FB_T_MOTOR:  st->inv_motor_temp = (int16_t)max; break;
+    case INV_FB_T_IGBT:   st->inv_igbt_temp  = (int16_t)max; break;
+    case INV_FB_T_AIR:    st->inv_air_temp   = (int16_t)max; break;
+    case INV_FB_STATE:    st->inv_state      = (uint8_t)max; break;
+    default: break;
+  }
+}
+
+void Inv_LinkInit(inv_link_t *lk)
+{
+  if (!lk) return;
+  lk->state = INV_LINK_IDLE;
+}
+
+void Inv_LinkSubscribed(inv_link_t *lk)
+{
+  if (lk && lk->state == INV_LINK_IDLE) lk->state = INV_LINK_SUBSCRIBED;
+}
+
+void Inv_LinkUpdate(inv_link_t *lk, const inv_fb_t *fb, uint32_t now_tick)
+{
+  if (!lk || !fb) return;
+
+  const uint8_t fresh = (fb->seen && (now_tick - fb->rx_tick) <= INV_FB_TIMEOUT_MS) ? 1u : 0u;
+
+  switch ((inv_link_state_t)lk->state)
+  {
+    case INV_LINK_IDLE:
+      break;
+
+    case INV_LINK_SUBSCRIBED:
+    case INV_LINK_LOST:
+      if (fresh) lk->state = INV_LINK_ONLINE;
+      break;
+
+    case INV_LINK_ONLINE:
+    default:
+      if (!fresh) lk->state = INV_LINK_LOST;
+      break;
+  }
+}
@@ -0,0 +1,358 @@
+#include "isotp.h"
+#include <string.h>
+
+/* Protocol control information, high nibble of byte 0 */
+#define PCI_SF  0x00u
+#define PCI_FF  0x10u
+#define PCI_CF  0x20u
+#define PCI_FC  0x30u
+
+/* Flow status */
+#define FS_CTS    0u
+#define FS_WAIT   1u
+#define FS_OVFLW  2u
+
+enum { RX_IDLE = 0, RX_CF };
+enum { TX_IDLE = 0, TX_SF, TX_FF, TX_WAIT_FC, TX_CF };
+
+static uint8_t  s_pool[ISOTP_POOL_BUFS][ISOTP_MAX_PAYLOAD];
+static uint32_t s_pool_used;   /* bit per buffer */
+
+uint8_t *Isotp_BufAlloc(void)
+{
+  for (uint32_t i = 0; i < ISOTP_POOL_BUFS; i++)
+  {
+    if (!(s_pool_used & (1u << i)))
+    {
+      s_pool_used |= 1u << i;
+      return s_pool[i];
+    }
+  }
+  return NULL;
+}
+
+void Isotp_BufFree(uint8_t *buf)
+{
+  if (!buf) return;
+  const uint32_t i = (uint32_t)(buf - &s_pool[0][0]) / ISOTP_MAX_PAYLOAD;
+  if (i < ISOTP_POOL_BUFS) s_pool_used &= ~(1u << i);
+}
+
+uint32_t Isotp_BufFreeCount(void)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < ISOTP_POOL_BUFS; i++) n += !(s_pool_used & (1u << i));
+  return n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int due(uint32_t now_us, uint32_t t_us)
+{
+  return (int32_t)(now_us - t_us) >= 0;
+}
+
+static uint32_t stmin_us(uint8_t st)
+{
+  if (st <= 0x7Fu) return (uint32_t)st * 1000u;
+  if (st >= 0xF1u && st <= 0xF9u) return (uint32_t)(st - 0xF0u) * 100u;
+  return 127000u;                               /* reserved: slowest */
+}
+
+static int send_frame(isotp_link_t *lk, const uint8_t *pci, uint32_t npci,
+                      const uint8_t *data, uint32_t n)
+{
+  can_msg_t m;
+  m.bus   = lk->bus;
+  m.id    = lk->tx_id;
+  m.dlc   = 8u;
+  m.ide   = (lk->tx_id > 0x7FFu) ? 1u : 0u;
+  m.burst = 0u;
+  memcpy(m.data, pci, npci);
+  if (n) memcpy(&m.data[npci], data, n);
+  memset(&m.data[npci + n], ISOTP_PAD, 8u - npci - n);
+  return lk->tx(&m);
+}
+
+static int send_fc(isotp_link_t *lk, uint8_t fs)
+{
+  const uint8_t pci[3] = { (uint8_t)(PCI_FC | fs), lk->bs, lk->stmin };
+  if (send_frame(lk, pci, 3u, NULL, 0u) != 0) return -1;
+  lk->stats.fc_sent++;
+  return 0;
+}
+
+/* FC now, or from the next Isotp_Poll if the sink is full */
+static void queue_fc(isotp_link_t *lk, uint8_t fs)
+{
+  lk->fc_pending = (send_fc(lk, fs) == 0) ? 0u : (uint8_t)(fs + 1u);
+}
+
+static void rx_abort(isotp_link_t *lk)
+{
+  Isotp_BufFree(lk->rx_buf);
+  lk->rx_buf   = NULL;
+  lk->rx_state = RX_IDLE;
+  lk->stats.rx_errors++;
+}
+
+static void tx_done(isotp_link_t *lk, int ok)
+{
+  Isotp_BufFree(lk->tx_buf);
+  lk->tx_buf   = NULL;
+  lk->tx_state = TX_IDLE;
+  if (ok) lk->stats.tx_msgs++;
+  else    lk->stats.tx_errors++;
+}
+
+/* Message complete: hand it to the upper layer (one at a time) */
+static void rx_deliver(isotp_link_t *lk, uint8_t *buf, uint16_t len)
+{
+  if (lk->msg)
+  {
+    Isotp_BufFree(buf);             /* previous one not taken yet */
+    lk->stats.rx_errors++;
+    return;
+  }
+  lk->msg     = buf;
+  lk->msg_len = len;
+  lk->stats.rx_msgs++;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Isotp_Init(isotp_link_t *lk, can_bus_t bus, uint32_t tx_id, uint32_t rx_id,
+                isotp_tx_fn_t tx)
+{
+  memset(lk, 0, sizeof(*lk));
+  lk->bus   = bus;
+  lk->tx_id = tx_id;
+  lk->rx_id = rx_id;
+  lk->tx    = tx;
+  lk->bs    = ISOTP_DEFAULT_BS;
+  lk->stmin = ISOTP_DEFAULT_STMIN;
+}
+
+void Isotp_Reset(isotp_link_t *lk)
+{
+  Isotp_BufFree(lk->rx_buf);
+  Isotp_BufFree(lk->msg);
+  Isotp_BufFree(lk->tx_buf);
+  lk->rx_buf = lk->msg = lk->tx_buf = NULL;
+  lk->rx_state   = RX_IDLE;
+  lk->tx_state   = TX_IDLE;
+  lk->fc_pending = 0u;
+}
+
+int Isotp_OnFrame(isotp_link_t *lk, const can_msg_t *m, uint32_t now_us)
+{
+  if (!lk || !m || m->bus != lk->bus || m->id != lk->rx_id || m->dlc == 0u) return 0;
+
+  const uint8_t *d = m->data;
+  const uint8_t dlc = (m->dlc > 8u) ? 8u : m->dlc;
+
+  switch (d[0] & 0xF0u)
+  {
+    case PCI_SF:
+    {
+      const uint8_t n = d[0] & 0x0Fu;
+      if (n == 0u || n > dlc - 1u) break;
+      if (lk->rx_state != RX_IDLE) rx_abort(lk);    /* new message wins */
+      uint8_t *buf = Isotp_BufAlloc();
+      if (!buf) { lk->stats.rx_errors++; break; }
+      memcpy(buf, &d[1], n);
+      rx_deliver(lk, buf, n);
+      break;
+    }
+
+    case PCI_FF:
+    {
+      if (dlc < 8u) break;
+      const uint16_t n = (uint16_t)(((d[0] & 0x0Fu) << 8) | d[1]);
+      if (n < 8u) break;                            /* would fit an SF */
+      if (lk->rx_state != RX_IDLE) rx_abort(lk);
+      uint8_t *buf = Isotp_BufAlloc();
+      if (!buf)
+      {
+        lk->stats.rx_errors++;
+        queue_fc(lk, FS_OVFLW);
+        break;
+      }
+      memcpy(buf, &d[2], 6u);
+      lk->rx_buf    = buf;
+      lk->rx_len    = n;
+      lk->rx_pos    = 6u;
+      lk->rx_sn     = 1u;
+      lk->rx_bs_cnt = 0u;
+      lk->rx_t_us   = now_us;
+      lk->rx_state  = RX_CF;
+      queue_fc(lk, FS_CTS);
+      break;
+    }
+
+    case PCI_CF:
+    {
+      if (lk->rx_state != RX_CF) break;
+      if ((d[0] & 0x0Fu) != lk->rx_sn) { rx_abort(lk); break; }
+      uint32_t n = lk->rx_len - lk->rx_pos;
+      if (n > 7u) n = 7u;
+      if (n > (uint32_t)dlc - 1u) { rx_abort(lk); break; }
+      memcpy(&lk->rx_buf[lk->rx_pos], &d[1], n);
+      lk->rx_pos  = (uint16_t)(lk->rx_pos + n);
+      lk->rx_sn   = (uint8_t)((lk->rx_sn + 1u) & 0x0Fu);
+      lk->rx_t_us = now_us;
+      if (lk->rx_pos >= lk->rx_len)
+      {
+        uint8_t *buf = lk->rx_buf;
+        lk->rx_buf   = NULL;
+        lk->rx_state = RX_IDLE;
+        rx_deliver(lk, buf, lk->rx_len);
+      }
+      else if (lk->bs != 0u && ++lk->rx_bs_cnt >= lk->bs)
+      {
+        lk->rx_bs_cnt = 0u;
+        queue_fc(lk, FS_CTS);
+      }
+      break;
+    }
+
+    case PCI_FC:
+    {
+      if (lk->tx_state != TX_WAIT_FC || dlc < 3u) break;
+      lk->stats.fc_received++;
+      switch (d[0] & 0x0Fu)
+      {
+        case FS_CTS:
+          lk->tx_bs       = d[1];
+          lk->tx_bs_cnt   = 0u;
+          lk->tx_wft      = 0u;
+          lk->tx_stmin_us = stmin_us(d[2]);
+          lk->tx_t_us     = now_us;                 /* first CF right away */
+          lk->tx_state    = TX_CF;
+          break;
+        case FS_WAIT:
+          if (++lk->tx_wft > ISOTP_MAX_WFT) tx_done(lk, 0);
+          else lk->tx_t_us = now_us;
+          break;
+        default:                                    /* overflow / invalid */
+          tx_done(lk, 0);
+          break;
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+  return 1;
+}
+
+uint8_t *Isotp_Receive(isotp_link_t *lk, uint16_t *len)
+{
+  uint8_t *buf = lk->msg;
+  if (buf && len) *len = lk->msg_len;
+  lk->msg = NULL;
+  return buf;
+}
+
+/* Single or first frame; stays in TX_SF / TX_FF while the sink is full */
+static int tx_first(isotp_link_t *lk, uint32_t now_us)
+{
+  if (lk->tx_state == TX_SF)
+  {
+    const uint8_t pci[1] = { (uint8_t)(PCI_SF | lk->tx_len) };
+    if (send_frame(lk, pci, 1u, lk->tx_buf, lk->tx_len) != 0) return 0;
+    tx_done(lk, 1);
+    return 1;
+  }
+  const uint8_t pci[2] = { (uint8_t)(PCI_FF | (lk->tx_len >> 8)), (uint8_t)lk->tx_len };
+  if (send_frame(lk, pci, 2u, lk->tx_buf, 6u) != 0) return 0;
+  lk->tx_pos   = 6u;
+  lk->tx_sn    = 1u;
+  lk->tx_wft   = 0u;
+  lk->tx_t_us  = now_us;
+  lk->tx_state = TX_WAIT_FC;
+  return 1;
+}
+
+int Isotp_Send(isotp_link_t *lk, uint8_t *buf, uint16_t len, uint32_t now_us)
+{
+  if (lk->tx_state != TX_IDLE || len == 0u || len > ISOTP_MAX_PAYLOAD)
+  {
+    Isotp_BufFree(buf);
+    lk->stats.tx_errors++;
+    return -1;
+  }
+  lk->tx_buf   = buf;
+  lk->tx_len   = len;
+  lk->tx_state = (len <= 7u) ? TX_SF : TX_FF;
+  (void)tx_first(lk, now_us);
+  return 0;
+}
+
+uint8_t Isotp_TxBusy(const isotp_link_t *lk)
+{
+  return lk->tx_state != TX_IDLE;
+}
+
+uint32_t Isotp_Poll(isotp_link_t *lk, uint32_t now_us, uint32_t budget)
+{
+  uint32_t sent = 0;
+
+  if (lk->fc_pending && budget > 0u)
+  {
+    if (send_fc(lk, (uint8_t)(lk->fc_pending - 1u)) == 0)
+    {
+      lk->fc_pending = 0u;
+      sent++;
+    }
+  }
+
+  if (lk->rx_state == RX_CF && (int32_t)(now_us - lk->rx_t_us) > (int32_t)ISOTP_TIMEOUT_US)
+  {
+    rx_abort(lk);                                   /* N_Cr */
+  }
+
+  switch (lk->tx_state)
+  {
+    case TX_WAIT_FC:
+      if ((int32_t)(now_us - lk->tx_t_us) > (int32_t)ISOTP_TIMEOUT_US) tx_done(lk, 0);   /* N_Bs */
+      break;
+
+    case TX_SF:
+    case TX_FF:
+      if (sent < budget) sent += (uint32_t)tx_first(lk, now_us);
+      break;
+
+    case TX_CF:
+      while (sent < budget && lk->tx_state == TX_CF && due(now_us, lk->tx_t_us))
+      {
+        uint32_t n = lk->tx_len - lk->tx_pos;
+        if (n > 7u) n = 7u;
+        const uint8_t pci[1] = { (uint8_t)(PCI_CF | lk->tx_sn) };
+        if (send_frame(lk, pci, 1u, &lk->tx_buf[lk->tx_pos], n) != 0) break;
+        sent++;
+        lk->tx_pos = (uint16_t)(lk->tx_pos + n);
+        lk->tx_sn  = (uint8_t)((lk->tx_sn + 1u) & 0x0Fu);
+        if (lk->tx_pos >= lk->tx_len)
+        {
+          tx_done(lk, 1);
+        }
+        else if (lk->tx_bs != 0u && ++lk->tx_bs_cnt >= lk->tx_bs)
+        {
+          lk->tx_t_us  = now_us;
+          lk->tx_state = TX_WAIT_FC;
+        }
+        else
+        {
+          lk->tx_t_us = now_us + lk->tx_stmin_us;
+          if (lk->tx_stmin_us != 0u) break;         /* one per poll slot */
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+  return sent;
+}
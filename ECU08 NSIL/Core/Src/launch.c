@@ -0,0 +1,142 @@
+#include "launch.h"
+#include <string.h>
+
+#define RAD_S_TO_RPM   9.5492966f   /* 60/(2*pi) */
+
+const launch_cfg_t LAUNCH_CFG_DEFAULT =
+{
+  .duration_s         = 2.5f,
+  .torque_start_pct   = 70.0f,
+  .torque_ramp_s      = 0.6f,
+  .a_target_mps2      = 7.0f,      /* ~0.7 g */
+  .slip_target        = 0.10f,
+  .rpm_offset         = 50.0f,
+  .gear               = 3.5f,
+  .r_wheel_m          = 0.23f,
+  .kp_pct_per_rpm     = 0.5f,
+  .rpm_standstill     = 30,
+  .throttle_go_pct    = 90u,
+  .throttle_abort_pct = 50u,
+};
+
+/* Profile tables from cfg; zeroed (no launch torque) for a bad span */
+static void build_tables(launch_t *lc, const launch_cfg_t *cfg)
+{
+  lc->tab_inv_dt = 0.0f;
+  memset(lc->tab_torque_pct, 0, sizeof(lc->tab_torque_pct));
+  memset(lc->tab_rpm, 0, sizeof(lc->tab_rpm));
+  if (!cfg || cfg->duration_s <= 0.0f) return;
+
+  const float dt = cfg->duration_s / (float)(LAUNCH_TAB_LEN - 1u);
+  lc->tab_inv_dt = 1.0f / dt;
+
+  for (uint32_t i = 0; i < LAUNCH_TAB_LEN; i++)
+  {
+    float t = (float)i * dt;
+
+    float tq = 100.0f;
+    if (cfg->torque_ramp_s > 0.0f && t < cfg->torque_ramp_s)
+      tq = cfg->torque_start_pct + (100.0f - cfg->torque_start_pct) * (t / cfg->torque_ramp_s);
+    lc->tab_torque_pct[i] = tq;
+
+    /* Wheel speed for the ideal acceleration plus slip, at the motor */
+    float v = cfg->a_target_mps2 * t;
+    lc->tab_rpm[i] = cfg->rpm_offset
+                   + v * (1.0f + cfg->slip_target) / cfg->r_wheel_m * cfg->gear * RAD_S_TO_RPM;
+  }
+}
+
+void Launch_Init(launch_t *lc, const launch_cfg_t *cfg)
+{
+  if (!lc) return;
+  memset(lc, 0, sizeof(*lc));
+  build_tables(lc, cfg);
+}
+
+void Launch_SetCfg(launch_t *lc, const launch_cfg_t *cfg)
+{
+  if (!lc || !cfg) return;
+  if (lc->state == LAUNCH_ACTIVE)
+  {
+    lc->tab_stale = 1u;   /* Launch_Update rebuilds once the run ends */
+    return;
+  }
+  build_tables(lc, cfg);
+  lc->tab_stale = 0u;
+}
+
+static void launch_lookup(const launch_t *lc, float t, float *tq, float *rpm)
+{
+  float x = t * lc->tab_inv_dt;
+  uint32_t i = (uint32_t)x;
+  if (i >= LAUNCH_TAB_LEN - 1u)
+  {
+    *tq  = lc->tab_torque_pct[LAUNCH_TAB_LEN - 1u];
+    *rpm = lc->tab_rpm[LAUNCH_TAB_LEN - 1u];
+    return;
+  }
+  float f = x - (float)i;
+  *tq  = lc->tab_torque_pct[i] + f * (lc->tab_torque_pct[i + 1u] - lc->tab_torque_pct[i]);
+  *rpm = lc->tab_rpm[i]        + f * (lc->tab_rpm[i + 1u]        - lc->tab_rpm[i]);
+}
+
+uint8_t Launch_Update(launch_t *lc, const launch_cfg_t *cfg, const app_inputs_t *in,
+                      uint16_t brake_adc, uint16_t driver_pct, uint8_t ev23, float dt_s, uint16_t *torque_pct)
+{
+  if (!lc || !cfg || !in || !torque_pct) return 0;
+
+  if (lc->tab_stale && lc->state != LAUNCH_ACTIVE)
+  {
+    build_tables(lc, cfg);
+    lc->tab_stale = 0u;
+  }
+
+  const uint8_t arm_edge  = (in->dash_input_1 && !lc->dash1_prev) ? 1u : 0u;
+  const uint8_t braking   = (in->s_freno > brake_adc) ? 1u : 0u;
+  const uint8_t stopped   = (in->inv_rpm < cfg->rpm_standstill &&
+                             in->inv_rpm > -cfg->rpm_standstill) ? 1u : 0u;
+  lc->dash1_prev = in->dash_input_1;
+
+  switch (lc->state)
+  {
+    case LAUNCH_OFF:
+      if (arm_edge && stopped && braking) lc->state = LAUNCH_ARMED;
+      return 0;
+
+    case LAUNCH_ARMED:
+      if (in->dash_input_2 || !stopped || ev23)
+      {
+        lc->state = LAUNCH_OFF;
+        return 0;
+      }
+      if (braking || driver_pct < cfg->throttle_go_pct) return 0;
+      lc->state = LAUNCH_ACTIVE;
+      lc->t_s = 0.0f;
+      break;
+
+    case LAUNCH_ACTIVE:
+    default:
+      lc->t_s += dt_s;
+      break;
+  }
+
+  /* ACTIVE: safety and driver overrides first */
+  if (ev23 || braking || in->dash_input_2 ||
+      driver_pct < cfg->throttle_abort_pct || lc->t_s >= cfg->duration_s)
+  {
+    lc->state = LAUNCH_OFF;
+    return 0;
+  }
+
+  float tq, rpm_target;
+  launch_lookup(lc, lc->t_s, &tq, &rpm_target);
+
+  lc->rpm_err = (float)in->inv_rpm - rpm_target;
+  if (lc->rpm_err > 0.0f) tq -= cfg->kp_pct_per_rpm * lc->rpm_err;
+  if (tq < 0.0f)   tq = 0.0f;
+  if (tq > 100.0f) tq = 100.0f;
+
+  lc->torque_pct = (uint16_t)tq;
+  *torque_pct = lc->torque_pct;
+  return 1;
+}
@@ -30,7 +30,8 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "ctrl_exec.h"
+#include "bmi088.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -223,6 +224,51 @@ void PeriphCommonClock_Config(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+  * @brief  Timer update callback (HAL_TIM_IRQHandler).
+  *         TIM16 paces the control executive.
+  * @param  htim TIM handle
+  * @retval None
+  */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM16)
+  {
+    CtrlExec_TimerIsr();
+  }
+}
+
+/**
+  * @brief  EXTI callback: BMI088 FIFO watermark lines.
+  * @param  GPIO_Pin pin that triggered
+  * @retval None
+  */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  Bmi088_ExtiIsr(GPIO_Pin);
+}
+
+/**
+  * @brief  SPI transfer complete: SPI1 carries only the BMI088 DMA bursts.
+  * @param  hspi SPI handle
+  * @retval None
+  */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi->Instance == SPI1)
+  {
+    Bmi088_SpiDoneIsr();
+  }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi->Instance == SPI1)
+  {
+    Bmi088_SpiErrorIsr();
+  }
+}
+
 /* USER CODE END 4 */
 
 /**
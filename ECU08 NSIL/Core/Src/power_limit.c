@@ -0,0 +1,131 @@
+#include "power_limit.h"
+#include <string.h>
+
+#define RPM_TO_RAD_S  0.10471976f   /* 2*pi/60 */
+
+const power_limit_cfg_t POWER_LIMIT_CFG_DEFAULT =
+{
+  .p_max_w      = 80000.0f,
+  .p_margin_w   = 2000.0f,
+  .t_max_nm     = 230.0f,
+  .eff          = 0.93f,
+  .kp           = 0.3f,
+  .ki_per_s     = 5.0f,
+  .trim_max_w   = 10000.0f,
+  .w_min_rad_s  = 50.0f,
+  .kt_nm_per_a  = 0.68f,      /* EMRAX 228: 230 Nm at 340 A peak */
+};
+
+void PowerLimit_Init(power_limit_t *pl)
+{
+  if (!pl) return;
+  memset(pl, 0, sizeof(*pl));
+}
+
+static float motor_w(const app_inputs_t *in)
+{
+  float w = (float)in->inv_rpm * RPM_TO_RAD_S;
+  return (w < 0.0f) ? -w : w;
+}
+
+/* DC power a drive can draw per V_dc and A of phase current (peak
+ * amplitude): space-vector modulation caps the phase voltage amplitude at
+ * V_dc / sqrt(3), and P = 1.5 * V * I * cos(phi) <= sqrt(3)/2 * V_dc * I. */
+#define PHASE_V_MAX   0.8660254f
+
+/* Electrical power of drive k from its own feedback: V_dc * I_dc if it
+ * reports DC current, else from its phase current (torque it really
+ * produces times speed, capped by the modulation bound). Returns 0 with
+ * neither reading. */
+static int drive_power(const power_limit_cfg_t *cfg, const app_inputs_t *in, uint32_t k, float *p_w)
+{
+  const inv_fb_t *fb = &in->inv[k];
+  const float v_dc = (float)in->inv_dc_bus_voltage;
+
+  if (fb->fld_seen & (1u << INV_FB_I_DC))
+  {
+    *p_w = v_dc * (float)fb->i_dc;
+    return 1;
+  }
+  if ((fb->fld_seen & (1u << INV_FB_I_ACTUAL)) && cfg->kt_nm_per_a > 0.0f && cfg->eff > 0.0f)
+  {
+    const float i_ph = (float)fb->i_actual;
+    float p   = cfg->kt_nm_per_a * i_ph * motor_w(in) / cfg->eff;
+    float cap = PHASE_V_MAX * v_dc * ((i_ph < 0.0f) ? -i_ph : i_ph);
+    *p_w = (p > cap) ? cap : p;
+    return 1;
+  }
+  return 0;
+}
+
+float PowerLimit_EstimateW(const power_limit_cfg_t *cfg, const app_inputs_t *in, float t_cmd_nm)
+{
+  if (!cfg || !in) return 0.0f;
+
+  float p_mech = (cfg->eff > 0.0f) ? (t_cmd_nm * motor_w(in) / cfg->eff) : 0.0f;
+
+  float p_meas = 0.0f;
+  uint32_t n = 0;
+  for (uint32_t k = 0; k < INV_MAX; k++)
+  {
+    float p;
+    if (drive_power(cfg, in, k, &p))
+    {
+      p_meas += p;
+      n++;
+    }
+  }
+  if (n == 0u) return p_mech;
+  return (p_meas > p_mech) ? p_meas : p_mech;
+}
+
+uint16_t PowerLimit_Apply(power_limit_t *pl, const power_limit_cfg_t *cfg,
+                          const app_inputs_t *in, uint16_t torque_pct, float dt_s)
+{
+  if (!pl || !cfg || !in) return torque_pct;
+
+  const float p_target = cfg->p_max_w - cfg->p_margin_w;
+  const float w        = motor_w(in);
+  const float t_req    = (float)torque_pct * cfg->t_max_nm * 0.01f;
+
+  /* PI trim on the measured electrical power */
+  pl->p_est_w = PowerLimit_EstimateW(cfg, in, pl->t_cmd_nm);
+  float err = p_target - pl->p_est_w;
+
+  /* Below w_min the speed is too low to reach the limit: no clamp, no windup */
+  if (w <= cfg->w_min_rad_s)
+  {
+    pl->trim_w = 0.0f;
+    pl->t_limit_nm = cfg->t_max_nm;
+    pl->active = 0;
+    pl->t_cmd_nm = t_req;
+    return torque_pct;
+  }
+
+  const float nm_per_w = cfg->eff / w;
+
+  /* Conditional integration: only while limiting or above target. */
+  if (t_req >= (p_target + pl->trim_w) * nm_per_w || err < 0.0f)
+  {
+    pl->trim_w += cfg->ki_per_s * err * dt_s;
+    if (pl->trim_w >  cfg->trim_max_w) pl->trim_w =  cfg->trim_max_w;
+    if (pl->trim_w < -cfg->trim_max_w) pl->trim_w = -cfg->trim_max_w;
+  }
+
+  /* Feedforward (P_target at the current speed) plus trim */
+  float t_lim = (p_target + cfg->kp * err + pl->trim_w) * nm_per_w;
+  if (t_lim < 0.0f) t_lim = 0.0f;
+  if (t_lim > cfg->t_max_nm) t_lim = cfg->t_max_nm;
+  pl->t_limit_nm = t_lim;
+
+  if (t_req <= t_lim)
+  {
+    pl->active = 0;
+    pl->t_cmd_nm = t_req;
+    return torque_pct;
+  }
+
+  pl->active = 1;
+  pl->t_cmd_nm = t_lim;
+  return (uint16_t)(t_lim * 100.0f / cfg->t_max_nm);   /* floor: stay below */
+}
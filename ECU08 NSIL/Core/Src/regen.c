@@ -0,0 +1,89 @@
+#include "regen.h"
+#include <string.h>
+
+#define RPM_TO_RAD_S  0.10471976f   /* 2*pi/60 */
+
+const regen_cfg_t REGEN_CFG_DEFAULT =
+{
+  .t_max_nm        = 230.0f,
+  .max_pct         = 40.0f,
+  .brake_start_adc = 3000u,       /* UMBRAL_FRENO_APPS */
+  .brake_full_adc  = 3800u,
+  .rpm_fade_lo     = 300.0f,
+  .rpm_fade_hi     = 800.0f,
+  .i_chg_max_a     = 60.0f,
+  .eff             = 0.93f,
+  .v_cell_taper_mv = 4100u,
+  .v_cell_full_mv  = 4180u,
+  .slew =
+  {
+    .rise_pct_s  = 300.0f,
+    .fall_pct_s  = 600.0f,
+    .jerk_pct_s2 = 6000.0f,
+  },
+};
+
+void Regen_Init(regen_t *rg)
+{
+  if (!rg) return;
+  memset(rg, 0, sizeof(*rg));
+}
+
+/* 0 at lo, 1 at hi, linear in between */
+static float ramp01(float x, float lo, float hi)
+{
+  if (x <= lo) return 0.0f;
+  if (x >= hi) return 1.0f;
+  return (x - lo) / (hi - lo);
+}
+
+float Regen_LimitPct(const regen_cfg_t *cfg, const app_inputs_t *in)
+{
+  if (!cfg || !in || in->inv_rpm <= 0) return 0.0f;
+
+  const float rpm = (float)in->inv_rpm;
+  float lim = cfg->max_pct * ramp01(rpm, cfg->rpm_fade_lo, cfg->rpm_fade_hi);
+
+  /* Charge current: generated electrical power I*V = T*w*eff */
+  const float w = rpm * RPM_TO_RAD_S;
+  if (w > 0.0f && cfg->eff > 0.0f && cfg->t_max_nm > 0.0f)
+  {
+    float t_i = cfg->i_chg_max_a * (float)in->inv_dc_bus_voltage / (cfg->eff * w);
+    float pct_i = t_i * 100.0f / cfg->t_max_nm;
+    if (pct_i < lim) lim = pct_i;
+  }
+
+  /* Cell voltage: min cell near full means every cell is near full */
+  lim *= 1.0f - ramp01((float)in->v_celda_min,
+                       (float)cfg->v_cell_taper_mv, (float)cfg->v_cell_full_mv);
+  return lim;
+}
+
+int16_t Regen_Apply(regen_t *rg, const regen_cfg_t *cfg, const app_inputs_t *in,
+                    uint16_t drive_pct, float dt_s)
+{
+  if (!rg || !cfg || !in) return (int16_t)drive_pct;
+
+  float target = 0.0f;
+  rg->limit_pct = Regen_LimitPct(cfg, in);
+
+  if (drive_pct == 0u)
+  {
+    target = cfg->max_pct * ramp01((float)in->s_freno,
+                                   (float)cfg->brake_start_adc, (float)cfg->brake_full_adc);
+    if (target > rg->limit_pct) target = rg->limit_pct;
+  }
+  rg->target_pct = target;
+
+  rg->regen_pct = TorqueSlew_Apply(&rg->slew, &cfg->slew, (uint16_t)(target + 0.5f), 0u, dt_s);
+
+  /* Limits act immediately, not through the blend ramp */
+  if ((float)rg->regen_pct > rg->limit_pct + 0.5f)
+  {
+    rg->regen_pct = (uint16_t)rg->limit_pct;
+    rg->slew.value_pct = (float)rg->regen_pct;
+    rg->slew.rate_pct_s = 0.0f;
+  }
+
+  return (int16_t)((int16_t)drive_pct - (int16_t)rg->regen_pct);
+}
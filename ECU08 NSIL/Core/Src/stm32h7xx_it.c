@@ -24,6 +24,7 @@
 #include "task.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "wheel_speed.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -65,7 +66,8 @@ extern SPI_HandleTypeDef hspi1;
 extern TIM_HandleTypeDef htim16;
 extern UART_HandleTypeDef huart10;
 /* USER CODE BEGIN EV */
-
+extern DMA_HandleTypeDef hdma_spi1_rx;
+extern DMA_HandleTypeDef hdma_spi1_tx;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -287,5 +289,37 @@ void FDCAN3_IT0_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles TIM2 global interrupt (wheel-speed capture).
+  */
+void TIM2_IRQHandler(void)
+{
+  WheelSpeed_TimIrq();
+}
+
+/**
+  * @brief This function handles DMA1 stream0 global interrupt (SPI1 RX).
+  */
+void DMA1_Stream0_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_rx);
+}
+
+/**
+  * @brief This function handles DMA1 stream1 global interrupt (SPI1 TX).
+  */
+void DMA1_Stream1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_tx);
+}
+
+/**
+  * @brief This function handles EXTI lines 5..9 (BMI088 INT1 PE7, INT3 PE8).
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_7);
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_8);
+}
 
 /* USER CODE END 1 */
@@ -22,6 +22,27 @@
 #include "test_integration.h"
 #include "app_state.h"
 #include "control.h"
+#include "ctrl_exec.h"
+#include "power_limit.h"
+#include "thermal_derate.h"
+#include "torque_slew.h"
+#include "regen.h"
+#include "launch.h"
+#include "traction.h"
+#include "wheel_speed.h"
+#include "bmi088.h"
+#include "vehicle_state.h"
+#include "inverters.h"
+#include "inv_backend.h"
+#include "torque_vectoring.h"
+#include "calib.h"
+#include "freshness.h"
+#include "handshake.h"
+#include "uds.h"
+#include "xcp.h"
+#include "fwu.h"
+#include "can_map.h"
+#include "tx_sched.h"
 #include "can.h"
 #include "diag.h"
 #include "telemetry.h"
@@ -108,7 +129,7 @@ extern osMessageQueueId_t canTxQueueHandle;
 /** Limpia ambas colas vaciándolas por completo. */
 static void drain_queues(void)
 {
-  can_qitem16_t tmp;
+  can_qitem_t tmp;
   while (osMessageQueueGet(canRxQueueHandle, &tmp, NULL, 0) == osOK) {}
   while (osMessageQueueGet(canTxQueueHandle, &tmp, NULL, 0) == osOK) {}
 }
@@ -127,6 +148,15 @@ static can_msg_t make_can_msg(uint32_t id, can_bus_t bus,
   return m;
 }
 
+/** Simula un inversor que acaba de responder todos sus registros en now. */
+static void inv_fb_fresh(inv_fb_t *fb, uint32_t now)
+{
+  fb->seen = 1;
+  fb->rx_tick = now;
+  fb->fld_seen = (uint8_t)((1u << INV_FB_COUNT) - 1u);
+  for (uint32_t f = 0; f < INV_FB_COUNT; f++) fb->fld_tick[f] = now;
+}
+
 /* ============================================================================
    S1 – MUTEX Y SINCRONIZACION DE APPSTATE
    ========================================================================== */
@@ -197,60 +227,45 @@ uint32_t test_suite_inverter_state_machine(void)
   AppState_Snapshot(&st);
   ASSERT_EQUAL(st.inv_state, 0u, S, "2.1_inv_state_initial_zero");
 
-  /* S2.2 – Recibir TX_STATE_2 (0x461) → inv_state = byte0 */
-  {
-    uint8_t d[8] = {0x02, 0, 0, 0, 0, 0, 0, 0};
-    can_msg_t m = make_can_msg(TINT_TX_STATE_2, CAN_BUS_INV, d, 8);
-    if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
-    CanRx_ParseAndUpdate(&m, &g_in);
-    if (g_inMutex) osMutexRelease(g_inMutex);
-    AppState_Snapshot(&st);
-    ASSERT_EQUAL(st.inv_state, 0x02u, S, "2.2_inv_state_2");
-  }
-
-  /* S2.3 – Recibir TX_STATE_4 (0x463) → inv_state = byte0 */
+#if INV_BACKEND == INV_BACKEND_EPL
+  /* S2.2 – ePowerLabs: TX_STATE_1 (0x460) byte0 → inv_state; los demás
+   *        TX_STATE llevan otras magnitudes y no lo tocan */
   {
-    uint8_t d[8] = {0x04, 0, 0, 0, 0, 0, 0, 0};
-    can_msg_t m = make_can_msg(TINT_TX_STATE_4, CAN_BUS_INV, d, 8);
-    if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
-    CanRx_ParseAndUpdate(&m, &g_in);
-    if (g_inMutex) osMutexRelease(g_inMutex);
-    AppState_Snapshot(&st);
-    ASSERT_EQUAL(st.inv_state, 0x04u, S, "2.3_inv_state_4");
-  }
-
-  /* S2.4 – Recibir TX_STATE_5 (0x464) → inv_state = byte0 */
-  {
-    uint8_t d[8] = {0x05, 0, 0, 0, 0, 0, 0, 0};
-    can_msg_t m = make_can_msg(TINT_TX_STATE_5, CAN_BUS_INV, d, 8);
-    if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
-    CanRx_ParseAndUpdate(&m, &g_in);
-    if (g_inMutex) osMutexRelease(g_inMutex);
-    AppState_Snapshot(&st);
-    ASSERT_EQUAL(st.inv_state, 0x05u, S, "2.4_inv_state_5_ready");
-  }
-
-  /* S2.5 – Recibir TX_STATE_6 (0x465) → inv_state = byte0 */
-  {
-    uint8_t d[8] = {0x06, 0, 0, 0, 0, 0, 0, 0};
-    can_msg_t m = make_can_msg(TINT_TX_STATE_6, CAN_BUS_INV, d, 8);
-    if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
-    CanRx_ParseAndUpdate(&m, &g_in);
-    if (g_inMutex) osMutexRelease(g_inMutex);
-    AppState_Snapshot(&st);
-    ASSERT_EQUAL(st.inv_state, 0x06u, S, "2.5_inv_state_6_run");
+    const uint8_t states[] = { 0x02u, 0x04u, 0x05u, 0x06u, 0x07u };
+    uint8_t ok = 1;
+    for (uint32_t i = 0; i < sizeof(states); i++)
+    {
+      uint8_t d[8] = { states[i], 0, 0, 0, 0, 0, 0, 0 };
+      can_msg_t m = make_can_msg(TINT_TX_STATE_1, CAN_BUS_INV, d, 8);
+      if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
+      CanRx_ParseAndUpdate(&m, &g_in);
+      m = make_can_msg(TINT_TX_STATE_7, CAN_BUS_INV, d, 8);
+      CanRx_ParseAndUpdate(&m, &g_in);
+      if (g_inMutex) osMutexRelease(g_inMutex);
+      AppState_Snapshot(&st);
+      if (st.inv_state != states[i]) ok = 0;
+    }
+    ASSERT_TRUE(ok, S, "2.2_inv_state_tx_state_1");
+    ASSERT_TRUE(st.sig_seen & FRESH_BIT(SIG_INV_STATE), S, "2.2_inv_state_stamped");
   }
-
-  /* S2.6 – Recibir TX_STATE_7 (0x466) → inv_state = byte0 */
+#else
+  /* S2.2 – Backend BAMOCAR: las tramas de estado ePowerLabs (TX_STATE_1..9)
+   *        no son de ningún inversor del coche y no tocan inv_state */
   {
-    uint8_t d[8] = {0x07, 0, 0, 0, 0, 0, 0, 0};
-    can_msg_t m = make_can_msg(TINT_TX_STATE_7, CAN_BUS_INV, d, 8);
-    if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
-    CanRx_ParseAndUpdate(&m, &g_in);
-    if (g_inMutex) osMutexRelease(g_inMutex);
+    for (uint32_t id = TINT_TX_STATE_1; id < TINT_TX_STATE_1 + 9u; id++)
+    {
+      uint8_t d[8] = { 0x05u, 0x11u, 0x22u, 0x33u, 0, 0, 0, 0 };
+      can_msg_t m = make_can_msg(id, CAN_BUS_INV, d, 8);
+      if (g_inMutex) osMutexAcquire(g_inMutex, osWaitForever);
+      CanRx_ParseAndUpdate(&m, &g_in);
+      if (g_inMutex) osMutexRelease(g_inMutex);
+    }
     AppState_Snapshot(&st);
-    ASSERT_EQUAL(st.inv_state, 0x07u, S, "2.6_inv_state_7_fault");
+    ASSERT_EQUAL(st.inv_state, 0u, S, "2.2_epl_frames_ignored");
+    ASSERT_EQUAL(st.inv[0].seen, 0u, S, "2.2_no_feedback");
+    ASSERT_EQUAL(st.sig_seen & FRESH_BIT(SIG_INV_STATE), 0u, S, "2.2_not_stamped");
   }
+#endif
 
   /* S2.7 – DC Bus Voltage se decodifica correctamente (little-endian 2 bytes) */
   {
@@ -293,8 +308,13 @@ uint32_t test_suite_boot_sequence(void)
   in.s2_aceleracion  = TINT_ADC_S2_50PCT;
   Control_Step10ms(&in, &out);
   ASSERT_EQUAL(out.torque_pct, 0u, S, "3.1_boot_no_torque_without_precarga");
-  /* En BOOT no se envían tramas de torque */
-  ASSERT_EQUAL(out.count, 0u, S, "3.1_boot_no_can_frames");
+  /* En BOOT no se envían tramas de torque: sólo se arman las suscripciones
+   * y salen las peticiones de handshake */
+  ASSERT_EQUAL(out.count, BAMO_REG_COUNT + TINT_HS_REQS, S, "3.1_boot_only_subscriptions");
+  ASSERT_TRUE(out.msgs[0].data[0] == BAMO_READ &&
+              out.msgs[BAMO_REG_COUNT - 1u].data[0] == BAMO_READ, S, "3.1_boot_no_torque_frames");
+  ASSERT_TRUE(out.msgs[BAMO_REG_COUNT].id == TINT_ID_OK_TELEMETRIA &&
+              out.msgs[BAMO_REG_COUNT + 2u].id == TINT_ID_OK_PANTALLA, S, "3.1_boot_handshake_requests");
 
   /* S3.2 – Precarga completada (ok_precarga=1), todavía sin botón ni freno */
   {
@@ -457,9 +477,9 @@ uint32_t test_suite_can_tx_packing(void)
     orig.data[6] = 0x00;
     orig.data[7] = 0x00;
 
-    can_qitem16_t qi;
-    CAN_Pack16(&orig, &qi);
-    CAN_Unpack16(&qi, &decoded);
+    can_qitem_t qi;
+    CAN_Pack(&orig, &qi);
+    CAN_Unpack(&qi, &decoded);
 
     ASSERT_EQUAL(decoded.id,      orig.id,      S, "5.1_id_roundtrip");
     ASSERT_EQUAL(decoded.dlc,     orig.dlc,     S, "5.1_dlc_roundtrip");
@@ -469,7 +489,7 @@ uint32_t test_suite_can_tx_packing(void)
 
   /* S5.2 – Cola RX: put + get recupera datos intactos */
   {
-    can_qitem16_t put_item, get_item;
+    can_qitem_t put_item, get_item;
     memset(&put_item, 0, sizeof(put_item));
     put_item.w[0] = 0xDEADBEEF;
     put_item.w[1] = 0xCAFEBABE;
@@ -485,7 +505,7 @@ uint32_t test_suite_can_tx_packing(void)
 
   /* S5.3 – Cola TX: put + get recupera datos intactos */
   {
-    can_qitem16_t put_item, get_item;
+    can_qitem_t put_item, get_item;
     memset(&put_item, 0, sizeof(put_item));
     put_item.w[0] = 0x12345678;
     put_item.w[3] = 0xABCDEF01;
@@ -501,14 +521,14 @@ uint32_t test_suite_can_tx_packing(void)
 
   /* S5.4 – FIFO ordering: 3 mensajes distintos se recuperan en orden */
   {
-    can_qitem16_t items[3];
+    can_qitem_t items[3];
     for (int i = 0; i < 3; i++) {
       memset(&items[i], 0, sizeof(items[i]));
       items[i].w[0] = (uint32_t)(0x100 + i);
       osMessageQueuePut(canRxQueueHandle, &items[i], 0, 0);
     }
     for (int i = 0; i < 3; i++) {
-      can_qitem16_t got;
+      can_qitem_t got;
       osMessageQueueGet(canRxQueueHandle, &got, NULL, 5);
       ASSERT_EQUAL(got.w[0], (uint32_t)(0x100 + i), S, "5.4_fifo_ordering");
     }
@@ -523,9 +543,9 @@ uint32_t test_suite_can_tx_packing(void)
     orig.dlc = 8;
     for (int i = 0; i < 8; i++) orig.data[i] = (uint8_t)(0x10 + i);
 
-    can_qitem16_t qi;
-    CAN_Pack16(&orig, &qi);
-    CAN_Unpack16(&qi, &dec);
+    can_qitem_t qi;
+    CAN_Pack(&orig, &qi);
+    CAN_Unpack(&qi, &dec);
 
     for (int i = 0; i < 8; i++) {
       ASSERT_EQUAL(dec.data[i], orig.data[i], S, "5.5_all_8_bytes_ok");
@@ -585,12 +605,13 @@ uint32_t test_suite_control_logic(void)
   cq_torque = Control_ComputeTorque(&in, &ev23_f, &t11_f);
   ASSERT_RANGE(cq_torque, 80u, 100u, S, "6.4_100pct_throttle");
 
-  /* S6.5 – Control_Step10ms: count ∈ [0..8] siempre (en cualquier estado) */
+  /* S6.5 – Control_Step10ms: count ∈ [0..9] siempre (en cualquier estado):
+   *        como mucho las suscripciones y los handshakes del primer paso */
   Control_Init();
   AppState_Init();
   AppState_Snapshot(&in);
   Control_Step10ms(&in, &out);
-  ASSERT_RANGE(out.count, 0u, 8u, S, "6.5_output_count_valid");
+  ASSERT_RANGE(out.count, 0u, BAMO_REG_COUNT + TINT_HS_REQS, S, "6.5_output_count_valid");
 
   /* S6.6 – Control_ComputeTorque devuelve 0..100 en cualquier caso */
   {
@@ -733,9 +754,9 @@ uint32_t test_suite_full_pipeline(void)
   /* S8.3 – Mensajes CAN generados se encolan en TX */
   {
     uint32_t enqueued = 0;
-    for (uint8_t i = 0; i < out.count && i < 8; i++) {
-      can_qitem16_t qi;
-      CAN_Pack16(&out.msgs[i], &qi);
+    for (uint8_t i = 0; i < out.count; i++) {
+      can_qitem_t qi;
+      CAN_Pack(&out.msgs[i], &qi);
       if (osMessageQueuePut(canTxQueueHandle, &qi, 0, 0) == osOK) enqueued++;
     }
     /* Si hay tramas generadas, deben haberse encolado todas */
@@ -805,7 +826,7 @@ uint32_t test_suite_concurrency(void)
     for (int i = 0; i < 20; i++) {
       AppState_Snapshot(&in);
       Control_Step10ms(&in, &out);
-      if (out.torque_pct > 100u || out.count > 8u) { ok = 0; break; }
+      if (out.torque_pct > 100 || out.count > BAMO_REG_COUNT + TINT_HS_REQS) { ok = 0; break; }
       osDelay(1);
     }
     ASSERT_EQUAL(ok, 1u, S, "9.2_concurrent_control_steps_valid");
@@ -816,7 +837,7 @@ uint32_t test_suite_concurrency(void)
     drain_queues();
     /* Producir 10 items */
     for (int i = 0; i < 10; i++) {
-      can_qitem16_t qi;
+      can_qitem_t qi;
       qi.w[0] = (uint32_t)(0xAA00 + i);
       qi.w[1] = qi.w[2] = qi.w[3] = 0;
       osMessageQueuePut(canRxQueueHandle, &qi, 0, 0);
@@ -824,7 +845,7 @@ uint32_t test_suite_concurrency(void)
     /* Consumir y verificar integridad */
     int consumed = 0;
     uint8_t ok = 1;
-    can_qitem16_t got;
+    can_qitem_t got;
     while (osMessageQueueGet(canRxQueueHandle, &got, NULL, 0) == osOK) {
       if ((got.w[0] & 0xFF00u) != 0xAA00u) { ok = 0; break; }
       consumed++;
@@ -836,7 +857,7 @@ uint32_t test_suite_concurrency(void)
   /* S9.4 – RX y TX queues son independientes */
   {
     drain_queues();
-    can_qitem16_t rx_item, tx_item, got;
+    can_qitem_t rx_item, tx_item, got;
     rx_item.w[0] = 0xAAAAAAAA;
     tx_item.w[0] = 0xBBBBBBBB;
     rx_item.w[1] = rx_item.w[2] = rx_item.w[3] = 0;
@@ -886,7 +907,7 @@ uint32_t test_suite_stress_testing(void)
       in.s2_aceleracion = adc_vals[i % 6];
       in.s_freno        = TINT_ADC_FRENO_OFF;
       Control_Step10ms(&in, &out);
-      if (out.torque_pct > 100u) { ok = 0; break; }
+      if (out.torque_pct > 100) { ok = 0; break; }
     }
     ASSERT_EQUAL(ok, 1u, S, "10.1_100_cycles_torque_bounded");
   }
@@ -896,7 +917,7 @@ uint32_t test_suite_stress_testing(void)
     drain_queues();
     int successful = 0;
     for (int i = 0; i < 140; i++) { /* intenta 140 > capacidad 128 */
-      can_qitem16_t qi;
+      can_qitem_t qi;
       qi.w[0] = (uint32_t)i;
       qi.w[1] = qi.w[2] = qi.w[3] = 0;
       if (osMessageQueuePut(canRxQueueHandle, &qi, 0, 0) == osOK) successful++;
@@ -916,7 +937,7 @@ uint32_t test_suite_stress_testing(void)
       in.s2_aceleracion = extremes[e];
       in.s_freno        = extremes[e];
       Control_Step10ms(&in, &out);
-      if (out.torque_pct > 100u) { ok = 0; break; }
+      if (out.torque_pct > 100) { ok = 0; break; }
     }
     ASSERT_EQUAL(ok, 1u, S, "10.3_extreme_adc_values_safe");
   }
@@ -934,7 +955,7 @@ uint32_t test_suite_stress_testing(void)
       in.s2_aceleracion = TINT_ADC_S2_50PCT;
       in.s_freno        = TINT_ADC_FRENO_OFF;
       Control_Step10ms(&in, &out);
-      if (out.torque_pct > 100u) { ok = 0; break; }
+      if (out.torque_pct > 100) { ok = 0; break; }
       loops++;
       osDelay(10);
     }
@@ -954,6 +975,1828 @@ uint32_t test_suite_stress_testing(void)
   return (g_suite_errors == 0) ? 1u : 0u;
 }
 
+/* ============================================================================
+   S11 – EJECUTIVO DE CONTROL (TIM16): periodo, jitter y overrun
+   Contabilidad pura con marcas de tiempo sintéticas en microsegundos.
+   ========================================================================== */
+uint32_t test_suite_ctrl_exec(void)
+{
+  const char *S = "S11_CTRL_EXEC";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S11: Ejecutivo de control TIM16 ---");
+
+  ctrl_exec_stats_t st;
+
+  /* S11.1 – Frecuencia por encima del máximo se limita a 1 kHz */
+  CtrlExec_Init(5000u);
+  ASSERT_EQUAL(CtrlExec_GetPeriodUs(), 1000u, S, "11.1_rate_clamped_1khz");
+
+  /* S11.2 – 100 Hz → periodo 10000 us */
+  CtrlExec_Init(100u);
+  ASSERT_EQUAL(CtrlExec_GetPeriodUs(), 10000u, S, "11.2_rate_100hz_period");
+
+  /* S11.3 – Ciclo nominal: sin jitter ni overrun */
+  CtrlExec_Init(CTRL_EXEC_RATE_HZ);
+  CtrlExec_OnWake(0u, 1u);
+  CtrlExec_OnDone(200u);
+  CtrlExec_OnWake(1000u, 1u);
+  CtrlExec_OnDone(1150u);
+  CtrlExec_GetStats(&st);
+  ASSERT_EQUAL(st.cycles, 2u, S, "11.3_cycles_counted");
+  ASSERT_EQUAL(st.jitter_max_us, 0u, S, "11.3_no_jitter");
+  ASSERT_EQUAL(st.overruns, 0u, S, "11.3_no_overrun");
+  ASSERT_EQUAL(st.exec_max_us, 200u, S, "11.3_exec_max");
+
+  /* S11.4 – Despertar 50 us tarde + ejecución > periodo → jitter y overrun */
+  CtrlExec_OnWake(2050u, 1u);
+  CtrlExec_OnDone(3300u);
+  CtrlExec_GetStats(&st);
+  ASSERT_EQUAL(st.jitter_last_us, 50u, S, "11.4_jitter_measured");
+  ASSERT_EQUAL(st.overruns, 1u, S, "11.4_overrun_detected");
+
+  /* S11.5 – Dos ticks pendientes → un ciclo perdido */
+  CtrlExec_OnWake(4000u, 2u);
+  CtrlExec_OnDone(4100u);
+  CtrlExec_GetStats(&st);
+  ASSERT_EQUAL(st.missed, 1u, S, "11.5_missed_tick_counted");
+  ASSERT_EQUAL(st.jitter_last_us, 50u, S, "11.5_jitter_over_two_periods");
+
+  /* S11.6 – WaitCycle en SIL avanza exactamente un periodo de tick */
+  {
+    uint32_t t0 = osKernelGetTickCount();
+    uint32_t ticks = CtrlExec_WaitCycle();
+    CtrlExec_CycleDone();
+    ASSERT_EQUAL(ticks, 1u, S, "11.6_wait_cycle_one_tick");
+    ASSERT_EQUAL(osKernelGetTickCount() - t0, 1u, S, "11.6_wait_cycle_1ms");
+  }
+
+  CtrlExec_Init(CTRL_EXEC_RATE_HZ);
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S12 – LÍMITE DE POTENCIA 80 kW: feedforward, trim PI y lectura BAMOCAR
+   ========================================================================== */
+uint32_t test_suite_power_limit(void)
+{
+  const char *S = "S12_POWER_LIMIT";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S12: Limite de potencia 80 kW ---");
+
+  const power_limit_cfg_t *cfg = &POWER_LIMIT_CFG_DEFAULT;
+  power_limit_t pl;
+  app_inputs_t  in;
+  memset(&in, 0, sizeof(in));
+  in.inv_dc_bus_voltage = 550;
+
+  /* S12.1 – Vehículo parado: 100 % pasa sin recorte */
+  PowerLimit_Init(&pl);
+  ASSERT_EQUAL(PowerLimit_Apply(&pl, cfg, &in, 100u, 0.001f), 100u, S, "12.1_standstill_no_limit");
+  ASSERT_EQUAL(pl.active, 0u, S, "12.1_not_active");
+
+  /* S12.2 – 5000 rpm, 550 V x 142 A DC ≈ objetivo: feedforward
+   * 78 kW*0.93/w ≈ 138.5 Nm → 60 % */
+  PowerLimit_Init(&pl);
+  in.inv_rpm = 5000;
+  in.inv[0].fld_seen = (uint16_t)(1u << INV_FB_I_DC);
+  in.inv[0].i_dc = 142;
+  ASSERT_RANGE(PowerLimit_Apply(&pl, cfg, &in, 100u, 0.001f), 59u, 60u, S, "12.2_ff_clamp_5000rpm");
+  ASSERT_EQUAL(pl.active, 1u, S, "12.2_active");
+
+  /* S12.3 – Corriente DC medida 170 A (93.5 kW): el trim PI reduce el par */
+  {
+    uint16_t t_ff = PowerLimit_Apply(&pl, cfg, &in, 100u, 0.001f);
+    in.inv[0].i_dc = 170;
+    uint16_t t_pi = 0;
+    for (uint32_t i = 0; i < 100u; i++) t_pi = PowerLimit_Apply(&pl, cfg, &in, 100u, 0.001f);
+    ASSERT_TRUE(t_pi < t_ff, S, "12.3_pi_trim_reduces_torque");
+    ASSERT_TRUE(pl.trim_w < 0.0f, S, "12.3_trim_negative");
+    in.inv[0].i_dc = 0;
+    in.inv[0].fld_seen = 0;
+  }
+
+  /* S12.4 – Petición por debajo del límite se devuelve intacta */
+  PowerLimit_Init(&pl);
+  ASSERT_EQUAL(PowerLimit_Apply(&pl, cfg, &in, 30u, 0.001f), 30u, S, "12.4_low_request_passthrough");
+
+  /* S12.5 – Respuesta BAMOCAR I_ACTUAL (0x5F) en 0x181: 16383 → 200 A */
+  {
+    app_inputs_t st;
+    memset(&st, 0, sizeof(st));
+    uint8_t d_i[3] = { 0x5F, 0xFF, 0x3F };
+    can_msg_t m = make_can_msg(0x181u, CAN_BUS_INV, d_i, 3);
+    CanRx_ParseAndUpdate(&m, &st);
+    ASSERT_RANGE(st.inv_i_actual, 199, 200, S, "12.5_i_actual_scaled");
+
+    /* N_ACTUAL (0x30) negativo: -16384 → -3250 rpm */
+    uint8_t d_n[3] = { 0x30, 0x00, 0xC0 };
+    m = make_can_msg(0x181u, CAN_BUS_INV, d_n, 3);
+    CanRx_ParseAndUpdate(&m, &st);
+    ASSERT_RANGE(st.inv_rpm, -3251, -3249, S, "12.5_n_actual_signed");
+  }
+
+  /* S12.6 – El primer paso pide I_ACTUAL y N_ACTUAL cíclicos al inversor (0x201) */
+  {
+    control_out_t out;
+    app_inputs_t  ci;
+    memset(&ci, 0, sizeof(ci));
+    Control_Init();
+    Control_Step10ms(&ci, &out);
+
+    uint32_t reads = 0;
+    for (uint32_t i = 0; i < out.count; i++) {
+      if (out.msgs[i].id == 0x201u && out.msgs[i].data[0] == 0x3Du &&
+          (out.msgs[i].data[1] == 0x5Fu || out.msgs[i].data[1] == 0x30u)) reads++;
+    }
+    ASSERT_EQUAL(reads, 2u, S, "12.6_boot_requests_cyclic_reads");
+  }
+
+  /* S12.7 – Sin I_DC (BAMOCAR) la potencia sale de la corriente de fase
+   *         (I_ACTUAL por accionamiento): 0.68 Nm/A x 300 A = 204 Nm,
+   *         x 523.6 rad/s / 0.93 ≈ 114.9 kW, por encima de T·ω/eff del
+   *         comando (100 Nm ≈ 56.3 kW). El escalar inv_i_actual no cuenta. */
+  in.inv_rpm = 5000;
+  in.inv_i_actual = 300;
+  ASSERT_RANGE(PowerLimit_EstimateW(cfg, &in, 100.0f), 56000, 56500, S, "12.7_scalar_current_ignored");
+  in.inv[0].fld_seen = (uint16_t)(1u << INV_FB_I_ACTUAL);
+  in.inv[0].i_actual = 300;
+  ASSERT_RANGE(PowerLimit_EstimateW(cfg, &in, 100.0f), 114500, 115200, S, "12.7_phase_current_used");
+
+  /* Con I_DC en otro accionamiento se suman: 114.9 kW + 550 V x 200 A */
+  in.inv[1].fld_seen = (uint16_t)(1u << INV_FB_I_DC);
+  in.inv[1].i_dc = 200;
+  ASSERT_RANGE(PowerLimit_EstimateW(cfg, &in, 100.0f), 224500, 225200, S, "12.7_dc_current_used");
+  in.inv[1].fld_seen = 0; in.inv[1].i_dc = 0;
+
+  /* S12.8 – Debilitamiento de campo: a 9000 rpm kt·I·ω/eff (206.8 kW)
+   *         supera lo que 300 A pueden sacar del bus, queda la cota
+   *         √3/2 x 550 V x 300 A ≈ 142.9 kW */
+  in.inv_rpm = 9000;
+  ASSERT_RANGE(PowerLimit_EstimateW(cfg, &in, 0.0f), 142700, 143100, S, "12.8_phase_power_capped");
+
+  /* Sin kt calibrado la corriente de fase se ignora */
+  {
+    power_limit_cfg_t c0 = *cfg;
+    c0.kt_nm_per_a = 0.0f;
+    ASSERT_RANGE(PowerLimit_EstimateW(&c0, &in, 0.0f), 0, 1, S, "12.8_kt_zero_ignores_phase");
+  }
+  in.inv[0].fld_seen = 0; in.inv[0].i_actual = 0;
+  in.inv_i_actual = 0;
+
+  Control_Init();
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S13 – DERATING TÉRMICO: curvas, predicción, histéresis y rampa
+   ========================================================================== */
+uint32_t test_suite_thermal_derate(void)
+{
+  const char *S = "S13_THERMAL";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S13: Derating termico motor/IGBT/aire ---");
+
+  const thermal_derate_cfg_t *cfg = &THERMAL_DERATE_CFG_DEFAULT;
+  const thermal_ch_cfg_t *mot = &cfg->ch[THERMAL_CH_MOTOR];
+  thermal_derate_t td;
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  in.inv_motor_temp = 40; in.inv_igbt_temp = 40; in.inv_air_temp = 30;
+
+  /* S13.1 – Curva motor: 90 °C → 100 %, 95 °C → 85 %, >= 110 °C → 0 % */
+  ASSERT_RANGE(ThermalDerate_Curve(mot, 90.0f), 100, 100, S, "13.1_curve_start");
+  ASSERT_RANGE(ThermalDerate_Curve(mot, 95.0f), 85, 85, S, "13.1_curve_interp");
+  ASSERT_RANGE(ThermalDerate_Curve(mot, 130.0f), 0, 0, S, "13.1_curve_end");
+
+  /* S13.2 – Predicción: en reposo enfría, con 150 A calienta */
+  ASSERT_TRUE(ThermalDerate_Predict(mot, 80.0f, 0.0f, 0.0f, cfg->horizon_s) < 80.0f,
+              S, "13.2_predict_cooling");
+  ASSERT_TRUE(ThermalDerate_Predict(mot, 80.0f, 150.0f, 5000.0f, cfg->horizon_s) > 83.0f,
+              S, "13.2_predict_heating");
+
+  /* S13.3 – Frío: 100 % pasa sin recorte */
+  ThermalDerate_Init(&td);
+  ASSERT_EQUAL(ThermalDerate_Apply(&td, cfg, &in, 100u, 0.001f), 100u, S, "13.3_cold_passthrough");
+  ASSERT_EQUAL(td.limiting_ch, THERMAL_CH_COUNT, S, "13.3_no_limiting_channel");
+
+  /* S13.4 – IGBT a 80 °C: límite baja a 70 % con rampa de 50 %/s */
+  in.inv_igbt_temp = 80;
+  {
+    uint16_t t = ThermalDerate_Apply(&td, cfg, &in, 100u, 0.010f);
+    ASSERT_RANGE(t, 99, 99, S, "13.4_ramp_down_one_step");
+    for (uint32_t i = 0; i < 100u; i++) t = ThermalDerate_Apply(&td, cfg, &in, 100u, 0.010f);
+    ASSERT_RANGE(t, 69, 70, S, "13.4_igbt_limit_70");
+    ASSERT_EQUAL(td.limiting_ch, THERMAL_CH_IGBT, S, "13.4_limiting_igbt");
+  }
+
+  /* S13.5 – Histéresis: bajar 2 °C (< 3 °C) no recupera par */
+  in.inv_igbt_temp = 78;
+  {
+    uint16_t t = 0;
+    for (uint32_t i = 0; i < 100u; i++) t = ThermalDerate_Apply(&td, cfg, &in, 100u, 0.010f);
+    ASSERT_RANGE(t, 69, 70, S, "13.5_hysteresis_holds");
+  }
+
+  /* S13.6 – Enfriado: recupera a 10 %/s (1 s → +10 %) */
+  in.inv_igbt_temp = 50;
+  {
+    uint16_t t = 0;
+    for (uint32_t i = 0; i < 100u; i++) t = ThermalDerate_Apply(&td, cfg, &in, 100u, 0.010f);
+    ASSERT_RANGE(t, 79, 80, S, "13.6_recovery_rate_limited");
+  }
+
+  /* S13.7 – Temperaturas BAMOCAR (0.1 °C/bit) en 0x181 */
+  {
+    app_inputs_t st;
+    memset(&st, 0, sizeof(st));
+    uint8_t d_m[3] = { 0x49, 0x84, 0x03 };   /* 900 → 90 °C */
+    can_msg_t m = make_can_msg(0x181u, CAN_BUS_INV, d_m, 3);
+    CanRx_ParseAndUpdate(&m, &st);
+    ASSERT_EQUAL(st.inv_motor_temp, 90, S, "13.7_motor_temp_decoded");
+    uint8_t d_i[3] = { 0x4A, 0xEE, 0x02 };   /* 750 → 75 °C */
+    m = make_can_msg(0x181u, CAN_BUS_INV, d_i, 3);
+    CanRx_ParseAndUpdate(&m, &st);
+    ASSERT_EQUAL(st.inv_igbt_temp, 75, S, "13.7_igbt_temp_decoded");
+  }
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S14 – LIMITADOR DE PENDIENTE / JERK DE PAR
+   ========================================================================== */
+uint32_t test_suite_torque_slew(void)
+{
+  const char *S = "S14_TORQUE_SLEW";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S14: Limitador de pendiente y jerk ---");
+
+  const torque_slew_cfg_t *cfg = &TORQUE_SLEW_CFG_DEFAULT;
+  torque_slew_t ts;
+  uint16_t t = 0;
+
+  /* S14.1 – Escalón 0→100: arranque suave (jerk) y sin sobrepaso */
+  TorqueSlew_Init(&ts);
+  t = TorqueSlew_Apply(&ts, cfg, 100u, 0u, 0.001f);
+  ASSERT_EQUAL(t, 0u, S, "14.1_jerk_onset");
+  for (uint32_t i = 0; i < 400u; i++) t = TorqueSlew_Apply(&ts, cfg, 100u, 0u, 0.001f);
+  ASSERT_EQUAL(t, 100u, S, "14.1_reaches_target");
+  ASSERT_TRUE(ts.rate_pct_s == 0.0f, S, "14.1_settled_no_overshoot");
+
+  /* S14.2 – Pendiente acotada: 50 ms de arranque (10 %) + 100 ms a 400 %/s ≈ 50 % */
+  TorqueSlew_Init(&ts);
+  for (uint32_t i = 0; i < 150u; i++) t = TorqueSlew_Apply(&ts, cfg, 100u, 0u, 0.001f);
+  ASSERT_RANGE(t, 48, 52, S, "14.2_rise_rate_limited");
+
+  /* S14.3 – Inversión a la baja: la subida se detiene en el mismo ciclo */
+  {
+    uint16_t before = t;
+    t = TorqueSlew_Apply(&ts, cfg, 0u, 0u, 0.001f);
+    ASSERT_TRUE(t <= before, S, "14.3_reversal_no_overshoot");
+  }
+
+  /* S14.4 – Corte (EV2.3 / freno): 0 inmediato y pendiente reseteada */
+  t = TorqueSlew_Apply(&ts, cfg, 100u, 1u, 0.001f);
+  ASSERT_EQUAL(t, 0u, S, "14.4_cut_immediate");
+  ASSERT_TRUE(ts.rate_pct_s == 0.0f, S, "14.4_cut_resets_rate");
+
+  /* S14.5 – Objetivo pequeño alcanzado exactamente con dt grande (100 Hz) */
+  TorqueSlew_Init(&ts);
+  for (uint32_t i = 0; i < 20u; i++) t = TorqueSlew_Apply(&ts, cfg, 12u, 0u, 0.010f);
+  ASSERT_EQUAL(t, 12u, S, "14.5_lands_on_target_100hz");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S15 – FRENADA REGENERATIVA: mapa freno/velocidad y límites de carga
+   ========================================================================== */
+uint32_t test_suite_regen(void)
+{
+  const char *S = "S15_REGEN";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S15: Frenada regenerativa ---");
+
+  const regen_cfg_t *cfg = &REGEN_CFG_DEFAULT;
+  regen_t rg;
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  in.inv_dc_bus_voltage = 550;
+  in.v_celda_min = 3900;
+
+  /* S15.1 – Parado: sin regeneración */
+  ASSERT_RANGE(Regen_LimitPct(cfg, &in), 0, 0, S, "15.1_no_regen_standstill");
+
+  /* S15.2 – 2000 rpm: límite por corriente 60 A*550 V/(0.93*w) ≈ 169 Nm → max 40 % */
+  in.inv_rpm = 2000;
+  ASSERT_RANGE(Regen_LimitPct(cfg, &in), 40, 40, S, "15.2_limit_max_pct");
+
+  /* S15.3 – 6000 rpm: domina la corriente de carga (≈ 56 Nm → 24 %) */
+  in.inv_rpm = 6000;
+  ASSERT_RANGE(Regen_LimitPct(cfg, &in), 23, 25, S, "15.3_limit_charge_current");
+
+  /* S15.4 – Celdas a 4140 mV: mitad del límite; a 4180 mV nada */
+  in.inv_rpm = 2000;
+  in.v_celda_min = 4140;
+  ASSERT_RANGE(Regen_LimitPct(cfg, &in), 19, 21, S, "15.4_cell_taper_half");
+  in.v_celda_min = 4180;
+  ASSERT_RANGE(Regen_LimitPct(cfg, &in), 0, 0, S, "15.4_cell_full_no_regen");
+  in.v_celda_min = 3900;
+
+  /* S15.5 – Freno a fondo: par negativo con rampa hasta -40 % */
+  Regen_Init(&rg);
+  in.s_freno = 3800;
+  {
+    int16_t t = Regen_Apply(&rg, cfg, &in, 0u, 0.001f);
+    ASSERT_RANGE(t, -1, 0, S, "15.5_regen_blends_in");
+    for (uint32_t i = 0; i < 300u; i++) t = Regen_Apply(&rg, cfg, &in, 0u, 0.001f);
+    ASSERT_RANGE(t, -40, -40, S, "15.5_regen_full_pedal");
+  }
+
+  /* S15.6 – Pedal de acelerador: la regeneración sale con rampa */
+  in.s_freno = 0;
+  {
+    int16_t t = Regen_Apply(&rg, cfg, &in, 10u, 0.001f);
+    ASSERT_TRUE(t < 10, S, "15.6_regen_blends_out");
+    for (uint32_t i = 0; i < 300u; i++) t = Regen_Apply(&rg, cfg, &in, 10u, 0.001f);
+    ASSERT_EQUAL(t, 10, S, "15.6_drive_only_after_blend");
+  }
+
+  /* S15.7 – Trama al inversor: par negativo en complemento a dos */
+  {
+    control_out_t out;
+    app_inputs_t ci;
+    memset(&ci, 0, sizeof(ci));
+    Control_Init();
+    ci.ok_precarga = 1; ci.boton_arranque = 1; ci.s_freno = 3500;
+    Control_Step10ms(&ci, &out);
+    Control_Step10ms(&ci, &out);
+    osDelay(2100);
+    ci.boton_arranque = 0;
+    ci.inv_rpm = 2000; ci.inv_dc_bus_voltage = 550; ci.v_celda_min = 3900;
+    ci.s_freno = 3800;
+    Control_Step10ms(&ci, &out);
+    for (uint32_t i = 0; i < 50u; i++) Control_Step10ms(&ci, &out);
+    osDelay(CONTROL_CMD_PERIOD_MS);   /* next command burst */
+    Control_Step10ms(&ci, &out);
+    ASSERT_TRUE(out.torque_pct < 0, S, "15.7_control_negative_torque");
+    ASSERT_EQUAL(out.msgs[out.count - 1u].data[0], (uint8_t)(int8_t)out.torque_pct,
+                 S, "15.7_cmd_frame_signed");
+  }
+
+  Control_Init();
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S16 – LAUNCH CONTROL: armado, disparo, tablas y anulación por seguridad
+   ========================================================================== */
+uint32_t test_suite_launch(void)
+{
+  const char *S = "S16_LAUNCH";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S16: Launch control ---");
+
+  const launch_cfg_t *cfg = &LAUNCH_CFG_DEFAULT;
+  const uint16_t brake = APPS_CAL_DEFAULT.brake_adc;
+  launch_t lc;
+  app_inputs_t in;
+  uint16_t tq = 0;
+  memset(&in, 0, sizeof(in));
+  Launch_Init(&lc, cfg);
+
+  /* S16.1 – Tablas precalculadas: par inicial y rpm objetivo crecientes */
+  ASSERT_RANGE(lc.tab_torque_pct[0], 70, 70, S, "16.1_tab_torque_start");
+  ASSERT_RANGE(lc.tab_torque_pct[LAUNCH_TAB_LEN - 1u], 100, 100, S, "16.1_tab_torque_end");
+  ASSERT_TRUE(lc.tab_rpm[LAUNCH_TAB_LEN - 1u] > lc.tab_rpm[0], S, "16.1_tab_rpm_rising");
+
+  /* S16.2 – Sin freno no se arma */
+  in.dash_input_1 = 1;
+  ASSERT_EQUAL(Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq), 0u, S, "16.2_no_arm_without_brake");
+  ASSERT_EQUAL(lc.state, LAUNCH_OFF, S, "16.2_state_off");
+
+  /* S16.3 – Flanco DASH_INPUT_1 + freno + parado → ARMED */
+  in.dash_input_1 = 0;
+  (void)Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq);
+  in.dash_input_1 = 1; in.s_freno = 3500;
+  (void)Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq);
+  ASSERT_EQUAL(lc.state, LAUNCH_ARMED, S, "16.3_armed");
+
+  /* S16.4 – Soltar freno y pedal a fondo → ACTIVE con par del perfil */
+  in.s_freno = 0;
+  tq = 100u;
+  ASSERT_EQUAL(Launch_Update(&lc, cfg, &in, brake, 100u, 0u, 0.001f, &tq), 1u, S, "16.4_launch_active");
+  ASSERT_RANGE(tq, 69, 70, S, "16.4_profile_start_torque");
+
+  /* S16.5 – rpm por encima del objetivo recorta par (control de deslizamiento) */
+  in.inv_rpm = 250;
+  (void)Launch_Update(&lc, cfg, &in, brake, 100u, 0u, 0.001f, &tq);
+  ASSERT_TRUE(tq < 10u, S, "16.5_slip_cut");
+  in.inv_rpm = 0;
+
+  /* S16.6 – Latch EV2.3 aborta el launch en el mismo ciclo */
+  ASSERT_EQUAL(Launch_Update(&lc, cfg, &in, brake, 0u, 1u, 0.001f, &tq), 0u, S, "16.6_ev23_aborts");
+  ASSERT_EQUAL(lc.state, LAUNCH_OFF, S, "16.6_state_off");
+
+  /* S16.7 – Armado y vehículo en movimiento → se desarma */
+  in.dash_input_1 = 0; in.s_freno = 3500;
+  (void)Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq);
+  in.dash_input_1 = 1;
+  (void)Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq);
+  in.inv_rpm = 200;
+  (void)Launch_Update(&lc, cfg, &in, brake, 0u, 0u, 0.001f, &tq);
+  ASSERT_EQUAL(lc.state, LAUNCH_OFF, S, "16.7_rolling_disarms");
+
+  /* S16.8 – "Freno pisado" usa el umbral calibrado, no uno fijo: con
+   *         brake_adc = 3600, 3500 cuentas no arman; 3700 sí */
+  in.inv_rpm = 0; in.dash_input_1 = 0; in.s_freno = 3500;
+  (void)Launch_Update(&lc, cfg, &in, 3600u, 0u, 0u, 0.001f, &tq);
+  in.dash_input_1 = 1;
+  (void)Launch_Update(&lc, cfg, &in, 3600u, 0u, 0u, 0.001f, &tq);
+  ASSERT_EQUAL(lc.state, LAUNCH_OFF, S, "16.8_below_cal_threshold");
+  in.dash_input_1 = 0; in.s_freno = 3700;
+  (void)Launch_Update(&lc, cfg, &in, 3600u, 0u, 0u, 0.001f, &tq);
+  in.dash_input_1 = 1;
+  (void)Launch_Update(&lc, cfg, &in, 3600u, 0u, 0u, 0.001f, &tq);
+  ASSERT_EQUAL(lc.state, LAUNCH_ARMED, S, "16.8_above_cal_threshold");
+
+  /* S16.9 – Nuevo perfil calibrado: armado, las tablas se rehacen sin
+   *         desarmar; durante un launch se espera a que termine */
+  {
+    launch_cfg_t c2 = *cfg;
+    c2.torque_start_pct = 50.0f;
+    Launch_SetCfg(&lc, &c2);
+    ASSERT_EQUAL(lc.state, LAUNCH_ARMED, S, "16.9_still_armed");
+    ASSERT_RANGE(lc.tab_torque_pct[0], 50, 50, S, "16.9_tables_rebuilt");
+
+    in.s_freno = 0;
+    tq = 100u;
+    ASSERT_EQUAL(Launch_Update(&lc, &c2, &in, 3600u, 100u, 0u, 0.001f, &tq), 1u, S, "16.9_launch_active");
+    c2.torque_start_pct = 30.0f;
+    Launch_SetCfg(&lc, &c2);
+    ASSERT_RANGE(lc.tab_torque_pct[0], 50, 50, S, "16.9_running_profile_kept");
+    (void)Launch_Update(&lc, &c2, &in, 3600u, 0u, 0u, 0.001f, &tq);   /* pie fuera */
+    ASSERT_EQUAL(lc.state, LAUNCH_OFF, S, "16.9_launch_ended");
+    (void)Launch_Update(&lc, &c2, &in, 3600u, 0u, 0u, 0.001f, &tq);
+    ASSERT_RANGE(lc.tab_torque_pct[0], 30, 30, S, "16.9_rebuilt_after_launch");
+  }
+
+  /* Control_CtxSetCfg lleva el perfil nuevo al contexto */
+  {
+    static ctrl_ctx_t cx;
+    control_cfg_t cc;
+    Control_CtxInit(&cx, 1000u);
+    cc = cx.cfg;
+    cc.launch.torque_start_pct = 40.0f;
+    Control_CtxSetCfg(&cx, &cc);
+    ASSERT_RANGE(cx.launch.tab_torque_pct[0], 40, 40, S, "16.9_ctx_set_cfg_rebuilds");
+  }
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S17 – VELOCIDAD DE RUEDA Y CONTROL DE TRACCIÓN
+   ========================================================================== */
+uint32_t test_suite_traction(void)
+{
+  const char *S = "S17_TRACTION";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S17: Wheel speed + traction control ---");
+
+  /* S17.1 – Periodo de diente → velocidad (20 dientes, r = 0.23 m, 1 MHz):
+   *         7226 us por diente ≈ 10 m/s */
+  WheelSpeed_Init();
+  ASSERT_EQUAL(WheelSpeed_GetCmps(WHEEL_FL, 0u), 0u, S, "17.1_no_edges_zero");
+  WheelSpeed_OnCapture(WHEEL_FL, 1000u);
+  ASSERT_EQUAL(WheelSpeed_GetCmps(WHEEL_FL, 1000u), 0u, S, "17.1_single_edge_zero");
+  WheelSpeed_OnCapture(WHEEL_FL, 1000u + 7226u);
+  ASSERT_RANGE(WheelSpeed_GetCmps(WHEEL_FL, 1000u + 7226u), 995, 1005, S, "17.1_period_to_speed");
+
+  /* S17.2 – Desbordamiento del contador de 32 bits transparente */
+  WheelSpeed_OnCapture(WHEEL_FR, 0xFFFFF000u);
+  WheelSpeed_OnCapture(WHEEL_FR, 0xFFFFF000u + 7226u);
+  ASSERT_RANGE(WheelSpeed_GetCmps(WHEEL_FR, 0xFFFFF000u + 7226u), 995, 1005, S, "17.2_counter_wrap");
+
+  /* S17.3 – Glitch (< periodo mínimo) ignorado; sin flancos → decae y 0 */
+  WheelSpeed_OnCapture(WHEEL_FL, 1000u + 7226u + 20u);
+  ASSERT_RANGE(WheelSpeed_GetCmps(WHEEL_FL, 1000u + 7226u + 20u), 995, 1005, S, "17.3_glitch_rejected");
+  ASSERT_RANGE(WheelSpeed_GetCmps(WHEEL_FL, 1000u + 7226u + 14452u), 495, 505, S, "17.3_decay_bound");
+  ASSERT_EQUAL(WheelSpeed_GetCmps(WHEEL_FL, 1000u + 7226u + WHEEL_SPEED_TIMEOUT_US + 1u), 0u,
+               S, "17.3_timeout_zero");
+
+  /* S17.4 – Sin fuente de velocidad (wheel_ok = 0) el TC no actúa */
+  const traction_cfg_t *cfg = &TRACTION_CFG_DEFAULT;
+  traction_t tc;
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  Traction_Init(&tc);
+  in.inv_rpm = 3000;
+  ASSERT_EQUAL(Traction_Apply(&tc, cfg, &in, 100u, 0.001f), 100u, S, "17.4_no_source_passthrough");
+
+  /* S17.5 – Deslizamiento en objetivo: sin recorte.
+   *         10 m/s → 10/0.23*3.5*60/(2π) ≈ 1453 rpm; +10 % ≈ 1598 rpm */
+  in.wheel_ok = 1;
+  in.wheel_fl_cmps = 1000u; in.wheel_fr_cmps = 1000u;
+  in.inv_rpm = 1590;
+  ASSERT_EQUAL(Traction_Apply(&tc, cfg, &in, 100u, 0.001f), 100u, S, "17.5_on_target_no_cut");
+
+  /* S17.6 – 30 % de deslizamiento: recorte en el mismo ciclo (P = 300 %·0.2) */
+  in.inv_rpm = 1889;
+  uint16_t cut = Traction_Apply(&tc, cfg, &in, 100u, 0.001f);
+  ASSERT_RANGE(cut, 38, 41, S, "17.6_cut_same_cycle");
+  ASSERT_TRUE(tc.active, S, "17.6_active");
+
+  /* S17.7 – Recuperación: el integral se descarga a recover_pct_s */
+  in.inv_rpm = 1453;
+  uint16_t rec = Traction_Apply(&tc, cfg, &in, 100u, 0.001f);
+  ASSERT_TRUE(rec < 100u, S, "17.7_integral_holds");
+  for (uint32_t i = 0; i < 100u; i++) rec = Traction_Apply(&tc, cfg, &in, 100u, 0.01f);
+  ASSERT_EQUAL(rec, 100u, S, "17.7_recovered");
+
+  /* S17.8 – Sensor delantero derecho muerto a 10 m/s: wheel_ok = 0 y el
+   *         TC no corta el par por un falso 100 % de deslizamiento */
+  WheelSpeed_Init();
+  memset(&in, 0, sizeof(in));
+  uint32_t t = 0;
+  for (; t < 20u * 7226u; t += 7226u)
+  {
+    WheelSpeed_OnCapture(WHEEL_FL, t);
+    WheelSpeed_OnCapture(WHEEL_FR, t + 3000u);
+  }
+  in.inv_rpm = 1453;
+  WheelSpeed_FillAt(&in, t);
+  ASSERT_TRUE(in.wheel_ok == 1u && in.wheel_fr_cmps > 900u, S, "17.8_both_alive");
+  for (const uint32_t t_dead = t; t < t_dead + WHEEL_SPEED_TIMEOUT_US + 7226u; t += 7226u)
+  {
+    WheelSpeed_OnCapture(WHEEL_FL, t);                    /* FR sin flancos */
+  }
+  WheelSpeed_FillAt(&in, t);
+  ASSERT_TRUE(in.wheel_ok == 0u && in.wheel_fr_cmps == 0u && in.wheel_fl_cmps > 900u,
+              S, "17.8_dead_channel_not_ok");
+  Traction_Init(&tc);
+  ASSERT_EQUAL(Traction_Apply(&tc, cfg, &in, 100u, 0.001f), 100u, S, "17.8_no_false_cut");
+
+  /* S17.9 – Parado y luego patinando en la salida: las delanteras no giran,
+   *         los sensores siguen siendo válidos; mudos tras moverse → fallo */
+  WheelSpeed_Init();
+  in.inv_rpm = 0;
+  WheelSpeed_FillAt(&in, 0u);
+  ASSERT_EQUAL(in.wheel_ok, 1u, S, "17.9_standstill_ok");
+  in.inv_rpm = 2500;
+  WheelSpeed_FillAt(&in, 100000u);
+  ASSERT_TRUE(in.wheel_ok == 1u && in.wheel_fl_cmps == 0u, S, "17.9_launch_spin_ok");
+  WheelSpeed_OnCapture(WHEEL_FL, 200000u);
+  WheelSpeed_OnCapture(WHEEL_FR, 200000u);
+  WheelSpeed_FillAt(&in, 200000u);                        /* el coche se mueve */
+  WheelSpeed_FillAt(&in, 200000u + WHEEL_SPEED_TIMEOUT_US + 1u);
+  ASSERT_EQUAL(in.wheel_ok, 0u, S, "17.9_both_silent_moving");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S18 – IMU BMI088: decodificación de FIFO, marcas de tiempo y publicación
+   ========================================================================== */
+uint32_t test_suite_imu(void)
+{
+  const char *S = "S18_IMU";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S18: BMI088 FIFO ---");
+
+  bmi088_sample_t smp[BMI088_RING_LEN];
+  bmi088_stats_t st;
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  ASSERT_EQUAL(Bmi088_Init(), 0, S, "18.0_init");
+
+  /* S18.1 – FIFO acel.: 3 tramas de datos con una de skip y una de
+   *         sensortime intercaladas, terminado en 0x80 (vacío) */
+  static const uint8_t acc_fifo[] = {
+    0x84, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,   /* x = +4096 LSB (+750 mg) */
+    0x40, 0x01,                                 /* skip                    */
+    0x84, 0x00, 0xF0, 0x00, 0x00, 0x00, 0x00,   /* x = -4096 LSB           */
+    0x44, 0x11, 0x22, 0x33,                     /* sensortime              */
+    0x85, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,   /* z = +4096, tag INT1     */
+    0x80, 0x00
+  };
+  ASSERT_EQUAL(Bmi088_ParseAccFifo(acc_fifo, sizeof(acc_fifo), 10000u), 3u, S, "18.1_acc_frames");
+
+  /* S18.2 – Marcas de tiempo hacia atrás a 1600 Hz (625 us) */
+  ASSERT_EQUAL(Bmi088_ReadSamples(smp, BMI088_RING_LEN), 3u, S, "18.2_ring_count");
+  ASSERT_EQUAL(smp[0].t_us, 10000u - 2u * 625u, S, "18.2_first_ts");
+  ASSERT_EQUAL(smp[2].t_us, 10000u, S, "18.2_last_ts");
+  ASSERT_EQUAL(smp[1].xyz[0], -4096, S, "18.2_acc_sign");
+  ASSERT_EQUAL(smp[2].xyz[2], 4096, S, "18.2_acc_z");
+
+  /* S18.3 – Trama truncada al final del burst: se ignora */
+  ASSERT_EQUAL(Bmi088_ParseAccFifo(acc_fifo, 10u, 10000u), 1u, S, "18.3_truncated_frame");
+  (void)Bmi088_ReadSamples(smp, BMI088_RING_LEN);
+
+  /* S18.4 – FIFO gyro: tramas de 6 bytes sin cabecera, 2000 Hz (500 us) */
+  static const uint8_t gyr_fifo[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x08,         /* z = +2048 LSB (125 dps) */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x08,
+  };
+  ASSERT_EQUAL(Bmi088_ParseGyrFifo(gyr_fifo, 2u, 10200u), 2u, S, "18.4_gyr_frames");
+  ASSERT_EQUAL(Bmi088_ReadSamples(smp, BMI088_RING_LEN), 2u, S, "18.4_ring_count");
+  ASSERT_EQUAL(smp[0].t_us, 9700u, S, "18.4_gyr_ts");
+  ASSERT_EQUAL(smp[0].sensor, BMI088_GYR, S, "18.4_gyr_tag");
+
+  /* S18.5 – Publicación al snapshot: unidades físicas y frescura */
+  Bmi088_Fill(&in, 12000u);
+  ASSERT_EQUAL(in.imu_ok, 1u, S, "18.5_imu_ok");
+  ASSERT_EQUAL(in.imu_acc_mg[0], 750, S, "18.5_acc_mg");   /* última: trama de S18.3 */
+  ASSERT_EQUAL(in.imu_gyr_ddps[2], 1250, S, "18.5_gyr_ddps");
+  ASSERT_EQUAL(in.imu_t_us, 10200u, S, "18.5_newest_ts");
+  Bmi088_Fill(&in, 10200u + BMI088_STALE_US + 1u);
+  ASSERT_EQUAL(in.imu_ok, 0u, S, "18.5_stale");
+
+  /* S18.6 – Consumidor lento: el anillo no sobrescribe, cuenta pérdidas */
+  for (uint32_t i = 0; i < BMI088_RING_LEN / 2u + 8u; i++)
+    (void)Bmi088_ParseGyrFifo(gyr_fifo, 2u, 20000u + i * 1000u);
+  Bmi088_GetStats(&st);
+  ASSERT_EQUAL(st.ring_drops, 16u, S, "18.6_ring_drops");
+  ASSERT_EQUAL(Bmi088_ReadSamples(smp, BMI088_RING_LEN), BMI088_RING_LEN, S, "18.6_ring_full");
+
+  /* S18.7 – Bmi088_Fill vacía el anillo en cada ciclo: publica la media de
+   *         las muestras nuevas (+2048 y 0 → 625 dps·10) y sin muestras
+   *         nuevas mantiene el valor; el anillo ya no pierde muestras */
+  static const uint8_t gyr_step[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x08,         /* z = +2048 LSB */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,         /* z = 0         */
+  };
+  Bmi088_GetStats(&st);
+  const uint32_t drops = st.ring_drops;
+  (void)Bmi088_ParseGyrFifo(gyr_step, 2u, 60000u);
+  Bmi088_Fill(&in, 60000u);
+  ASSERT_EQUAL(in.imu_gyr_ddps[2], 625, S, "18.7_burst_mean");
+  ASSERT_EQUAL(Bmi088_ReadSamples(smp, BMI088_RING_LEN), 0u, S, "18.7_ring_drained");
+  Bmi088_Fill(&in, 60500u);
+  ASSERT_EQUAL(in.imu_gyr_ddps[2], 0, S, "18.7_hold_latest");
+  for (uint32_t i = 0; i < BMI088_RING_LEN; i++)
+  {
+    (void)Bmi088_ParseGyrFifo(gyr_fifo, 2u, 61000u + i * 1000u);
+    Bmi088_Fill(&in, 61000u + i * 1000u);
+  }
+  Bmi088_GetStats(&st);
+  ASSERT_EQUAL(st.ring_drops, drops, S, "18.7_no_drops_when_drained");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S19 – ESTIMADOR DE ESTADO: velocidad, deslizamiento, error de guiñada
+   ========================================================================== */
+uint32_t test_suite_vehicle_state(void)
+{
+  const char *S = "S19_VSTATE";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S19: Vehicle state estimator ---");
+
+  const vehicle_state_cfg_t *cfg = &VEHICLE_STATE_CFG_DEFAULT;
+  vehicle_state_t vs;
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  VehState_Init(&vs);
+
+  /* S19.1 – Parado con IMU desplazada 50 mg: aprende el bias en 2 s */
+  in.imu_ok = 1; in.wheel_ok = 1;
+  in.imu_acc_mg[0] = 50;
+  for (uint32_t i = 0; i < 2000u; i++) VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.b_ax * 1000.0f), 440, 540, S, "19.1_bias_learned_mmps2");
+  ASSERT_RANGE((int32_t)(vs.v_mps * 100.0f), 0, 2, S, "19.1_standstill");
+
+  /* S19.2 – Aceleración a 2 m/s² hasta 10 m/s (IMU = bias + 204 mg), ruedas
+   *         y motor coherentes: sigue la rampa y slip ≈ 0 */
+  for (uint32_t i = 1; i <= 5000u; i++)
+  {
+    float v = 0.002f * (float)i;
+    in.imu_acc_mg[0]  = 50 + 204;
+    in.wheel_fl_cmps  = (uint16_t)(v * 100.0f);
+    in.wheel_fr_cmps  = in.wheel_fl_cmps;
+    in.inv_rpm        = (int16_t)(v * 145.3f);   /* /r * gear * 60/2π */
+    VehState_Update(&vs, cfg, &in, 0.001f);
+  }
+  in.imu_acc_mg[0] = 50;
+  VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.v_mps * 100.0f), 995, 1005, S, "19.2_speed_cmps");
+  ASSERT_RANGE((int32_t)(vs.slip * 100.0f), -1, 1, S, "19.2_slip_zero");
+
+  /* S19.3 – Sin ruedas y rueda motriz patinando (+50 %): fuera de la
+   *         ventana, la velocidad no la sigue; el slip sí lo refleja */
+  in.wheel_ok = 0;
+  in.imu_acc_mg[0] = 50;                    /* solo el bias: v constante */
+  in.inv_rpm = 2180;
+  for (uint32_t i = 0; i < 200u; i++) VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.v_mps * 100.0f), 990, 1010, S, "19.3_spin_rejected");
+  ASSERT_RANGE((int32_t)(vs.slip * 100.0f), 48, 52, S, "19.3_slip_seen");
+
+  /* S19.4 – Error de guiñada: giroscopio 0 con ruedas FR - FL = 0.6 m/s
+   *         (r = 0.5 rad/s cinemático) → error -0.5 rad/s */
+  in.wheel_ok = 1;
+  in.inv_rpm = 1453;
+  in.wheel_fl_cmps = 970u; in.wheel_fr_cmps = 1030u;
+  VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.yaw_err_rad_s * 1000.0f), -502, -498, S, "19.4_yaw_err_mrad");
+  in.imu_gyr_ddps[2] = 286;                 /* 28.6 deg/s = 0.5 rad/s */
+  VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.yaw_err_rad_s * 1000.0f), -3, 3, S, "19.4_yaw_consistent");
+
+  /* S19.5 – Sin IMU no hay error de guiñada */
+  in.imu_ok = 0;
+  VehState_Update(&vs, cfg, &in, 0.001f);
+  ASSERT_RANGE((int32_t)(vs.yaw_err_rad_s * 1000.0f), 0, 0, S, "19.5_no_imu_no_yaw_err");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S20 – N INVERSORES: reparto por motor, vectorización de par, enlace y ráfaga
+   ========================================================================== */
+static uint32_t suite_inverters_body(void)
+{
+  const char *S = "S20_INVERTERS";
+  const torque_vectoring_cfg_t *cfg = &TORQUE_VECTORING_CFG_DEFAULT;
+  torque_vectoring_t tv;
+  vehicle_state_t vs;
+  int16_t mp[INV_MAX];
+  TorqueVec_Init(&tv);
+  memset(&vs, 0, sizeof(vs));
+
+  /* S20.1 – 4WD, reparto 50/50 sin vectorización: todos al total */
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_4WD, 0x0Fu, 60, NULL, mp);
+  ASSERT_TRUE(mp[0] == 60 && mp[1] == 60 && mp[2] == 60 && mp[3] == 60, S, "20.1_even_split");
+
+  /* S20.2 – Subviraje (error -0.25 rad/s a 10 m/s): +10 % derecha,
+   *         -10 % izquierda, total conservado */
+  vs.v_mps = 10.0f; vs.yaw_err_rad_s = -0.25f;
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_4WD, 0x0Fu, 60, &vs, mp);
+  ASSERT_TRUE(mp[0] == 50 && mp[2] == 50, S, "20.2_left_reduced");
+  ASSERT_TRUE(mp[1] == 70 && mp[3] == 70, S, "20.2_right_increased");
+  ASSERT_EQUAL(mp[0] + mp[1] + mp[2] + mp[3], 240, S, "20.2_total_kept");
+
+  /* S20.3 – Margen: a 90 % el reparto se limita a 10 % (sin saturar) */
+  vs.yaw_err_rad_s = -1.0f;
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_4WD, 0x0Fu, 90, &vs, mp);
+  ASSERT_TRUE(mp[1] == 100 && mp[0] == 80, S, "20.3_headroom_bound");
+
+  /* S20.4 – Corte (total 0): ningún motor recibe par aunque haya error */
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_4WD, 0x0Fu, 0, &vs, mp);
+  ASSERT_TRUE(mp[0] == 0 && mp[1] == 0 && mp[2] == 0 && mp[3] == 0, S, "20.4_cut_all_zero");
+
+  /* S20.5 – RL perdido: 0 en RL, RR asume el eje (saturado), eje trasero
+   *         sin vectorizar; el delantero sigue vectorizando */
+  vs.yaw_err_rad_s = 0.0f;
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_4WD, 0x0Bu, 40, &vs, mp);
+  ASSERT_EQUAL(mp[2], 0, S, "20.5_lost_zero");
+  ASSERT_EQUAL(mp[3], 80, S, "20.5_partner_takes_axle");
+  ASSERT_TRUE(mp[0] == 40 && mp[1] == 40, S, "20.5_front_unchanged");
+
+  /* S20.6 – 1WD: el motor recibe exactamente el total */
+  vs.yaw_err_rad_s = -1.0f;
+  TorqueVec_Allocate(&tv, cfg, &INV_LAYOUT_1WD, 0x01u, -37, &vs, mp);
+  ASSERT_EQUAL(mp[0], -37, S, "20.6_single_exact");
+
+  /* S20.7 – Realimentación por inversor (4WD): 0x182 → inv[1]; agregados
+   *         rpm = media, corriente = suma, temperatura = máxima */
+  Inv_SetLayout(&INV_LAYOUT_4WD);
+  app_inputs_t st;
+  memset(&st, 0, sizeof(st));
+  uint8_t n1[3] = { 0x30u, 0x00u, 0x40u };   /* 16384 → 3250 rpm */
+  uint8_t n3[3] = { 0x30u, 0x00u, 0x20u };   /*  8192 → 1625 rpm */
+  uint8_t i1[3] = { 0x5Fu, 0xFFu, 0x0Fu };   /*  4095 →   49 A   */
+  uint8_t i3[3] = { 0x5Fu, 0xFFu, 0x1Fu };   /*  8191 →   99 A   */
+  uint8_t t3[3] = { 0x49u, 0x84u, 0x03u };   /*   900 →   90 °C  */
+  can_msg_t m = make_can_msg(0x182u, CAN_BUS_INV, n1, 3);
+  CanRx_ParseAndUpdate(&m, &st);
+  m = make_can_msg(0x184u, CAN_BUS_INV, n3, 3);
+  CanRx_ParseAndUpdate(&m, &st);
+  m = make_can_msg(0x182u, CAN_BUS_INV, i1, 3);
+  CanRx_ParseAndUpdate(&m, &st);
+  m = make_can_msg(0x184u, CAN_BUS_INV, i3, 3);
+  CanRx_ParseAndUpdate(&m, &st);
+  m = make_can_msg(0x184u, CAN_BUS_INV, t3, 3);
+  CanRx_ParseAndUpdate(&m, &st);
+  ASSERT_EQUAL(st.inv[1].rpm, 3250, S, "20.7_per_inverter_rpm");
+  ASSERT_EQUAL(st.inv[0].seen, 0u, S, "20.7_others_untouched");
+  ASSERT_EQUAL(st.inv_rpm, 2437, S, "20.7_rpm_mean");
+  ASSERT_EQUAL(st.inv_i_actual, 148, S, "20.7_current_sum");
+  ASSERT_EQUAL(st.inv_motor_temp, 90, S, "20.7_temp_max");
+
+  /* S20.8 – El primer paso suscribe los 6 registros en cada inversor (rxID propio) */
+  control_out_t out;
+  app_inputs_t ci;
+  memset(&ci, 0, sizeof(ci));
+  Control_Init();
+  ci.ok_precarga = 1; ci.boton_arranque = 1; ci.s_freno = TINT_ADC_FRENO_ON;
+  Control_Step10ms(&ci, &out);
+  ASSERT_EQUAL(out.count, 24u + TINT_HS_REQS, S, "20.8_boot_reads_all");
+  ASSERT_TRUE(out.msgs[0].id == 0x201u && out.msgs[23].id == 0x204u &&
+              out.msgs[23].data[1] == 0x4Bu, S, "20.8_read_ids");
+  ASSERT_EQUAL(Control_GetInverterLink(3), (uint32_t)INV_LINK_SUBSCRIBED, S, "20.8_link_subscribed");
+  Control_Step10ms(&ci, &out);
+  osDelay(2100);
+  ci.boton_arranque = 0; ci.s_freno = TINT_ADC_FRENO_OFF;
+  Control_Step10ms(&ci, &out);                 /* R2D → READY */
+  Control_Step10ms(&ci, &out);
+
+  /* S20.9 – RUN: las 4 órdenes salen juntas al final, marcadas como ráfaga */
+  ci.s1_aceleracion = TINT_ADC_S1_100PCT;
+  ci.s2_aceleracion = TINT_ADC_S2_100PCT;
+  for (uint32_t i = 0; i < 50u; i++)
+  {
+    for (uint32_t k = 0; k < INV_MAX; k++) inv_fb_fresh(&ci.inv[k], osKernelGetTickCount());
+    Control_Step10ms(&ci, &out);
+    osDelay(10);
+  }
+  ASSERT_EQUAL(out.count, 4u, S, "20.9_one_frame_per_inverter");
+  uint8_t burst_ok = 1;
+  for (uint32_t k = 0; k < 4u; k++)
+  {
+    if (out.msgs[k].id != 0x181u + k || out.msgs[k].burst != 4u ||
+        out.msgs[k].data[0] != (uint8_t)(int8_t)out.motor_pct[k]) burst_ok = 0;
+  }
+  ASSERT_TRUE(burst_ok, S, "20.9_burst_frames");
+  ASSERT_EQUAL(Control_GetInverterLink(0), (uint32_t)INV_LINK_ONLINE, S, "20.9_link_online");
+  ASSERT_TRUE(out.motor_pct[2] > 0, S, "20.9_rl_driven");
+
+  /* S20.10 – RL sin respuestas: sus registros rápidos se re-arman a los
+   *          4 periodos (100 ms) y el enlace pasa a LOST con par 0 */
+  uint32_t rearm_rl = 0;
+  for (uint32_t i = 0; i < 15u; i++)
+  {
+    const uint32_t now = osKernelGetTickCount();
+    inv_fb_fresh(&ci.inv[0], now);
+    inv_fb_fresh(&ci.inv[1], now);
+    inv_fb_fresh(&ci.inv[3], now);
+    Control_Step10ms(&ci, &out);
+    for (uint32_t j = 0; j < out.count; j++)
+    {
+      if (out.msgs[j].id == 0x203u && out.msgs[j].data[0] == BAMO_READ) rearm_rl++;
+    }
+    if (Control_GetInverterLink(2) == INV_LINK_LOST) break;
+    osDelay(10);
+  }
+  ASSERT_EQUAL(Control_GetInverterLink(2), (uint32_t)INV_LINK_LOST, S, "20.10_link_lost");
+  ASSERT_EQUAL(rearm_rl, 2u, S, "20.10_fast_regs_rearmed");
+  /* En el bus de inversores sólo la ráfaga (los handshakes sin respuesta
+   * se repiten en el de telemetría) */
+  uint32_t inv_frames = 0;
+  for (uint32_t j = 0; j < out.count; j++) if (out.msgs[j].bus == CAN_BUS_INV) inv_frames++;
+  ASSERT_EQUAL(inv_frames, 4u, S, "20.10_burst_only");
+  ASSERT_EQUAL(out.motor_pct[2], 0, S, "20.10_lost_no_torque");
+  const can_msg_t *burst = &out.msgs[out.count - 4u];   /* la ráfaga va al final */
+  ASSERT_EQUAL(burst[2].data[0], 0u, S, "20.10_rl_frame_zero");
+
+  /* S20.11 – El marcador de ráfaga sobrevive a la cola de TX */
+  can_qitem_t qi;
+  can_msg_t back;
+  CAN_Pack(&burst[3], &qi);
+  CAN_Unpack(&qi, &back);
+  ASSERT_EQUAL(back.burst, 4u, S, "20.11_burst_packed");
+
+  /* S20.12 – Paso de 1 ms: la ráfaga sale cada cmd_period_ms (5 ms) y el
+   *          inversor mantiene la consigna entre medias */
+  uint32_t bursts = 0, t_prev = 0, gap_lo = 0xFFFFFFFFu, gap_hi = 0;
+  for (uint32_t i = 0; i < 30u; i++)
+  {
+    const uint32_t now = osKernelGetTickCount();
+    inv_fb_fresh(&ci.inv[0], now);
+    inv_fb_fresh(&ci.inv[1], now);
+    inv_fb_fresh(&ci.inv[3], now);
+    Control_Step10ms(&ci, &out);
+    for (uint32_t j = 0; j < out.count; j++)
+    {
+      if (out.msgs[j].id != 0x181u) continue;
+      if (bursts++ != 0u)
+      {
+        if (now - t_prev < gap_lo) gap_lo = now - t_prev;
+        if (now - t_prev > gap_hi) gap_hi = now - t_prev;
+      }
+      t_prev = now;
+    }
+    osDelay(1);
+  }
+  ASSERT_TRUE(bursts >= 30u / CONTROL_CMD_PERIOD_MS - 1u, S, "20.12_bursts_sent");
+  ASSERT_TRUE(gap_lo == CONTROL_CMD_PERIOD_MS && gap_hi == CONTROL_CMD_PERIOD_MS,
+              S, "20.12_burst_decimated");
+
+  /* Freno pisado: el corte a 0 no espera al periodo */
+  ci.s_freno = TINT_ADC_FRENO_ON;
+  Control_Step10ms(&ci, &out);
+  ASSERT_TRUE(out.count >= 4u && out.msgs[out.count - 4u].data[0] == 0u &&
+              out.msgs[out.count - 4u].id == 0x181u, S, "20.12_cut_sent_at_once");
+  ci.s_freno = TINT_ADC_FRENO_OFF;
+
+  /* S20.13 – Presupuesto de bus: 4 accionamientos no caben a 1 ms, el
+   *          periodo calibrado se sube al mínimo del layout */
+  ASSERT_EQUAL(Control_CmdPeriodMinMs(1u), 1u, S, "20.13_1wd_1ms");
+  const uint32_t min4 = Control_CmdPeriodMinMs(INV_MAX);
+  ASSERT_TRUE(min4 > 1u && min4 <= CONTROL_CMD_PERIOD_MS, S, "20.13_4wd_min_period");
+  {
+    control_cfg_t cc = Control_DefaultCtx()->cfg;
+    cc.cmd_period_ms = 0u;
+    Control_CtxSetCfg(Control_DefaultCtx(), &cc);
+    ASSERT_EQUAL(Control_DefaultCtx()->cfg.cmd_period_ms, CONTROL_CMD_PERIOD_MS, S, "20.13_zero_refused");
+    cc.cmd_period_ms = 1u;
+    Control_CtxSetCfg(Control_DefaultCtx(), &cc);
+    ASSERT_EQUAL(Control_DefaultCtx()->cfg.cmd_period_ms, 1u, S, "20.13_1ms_accepted");
+  }
+  uint32_t last = 0, gap_min = 0xFFFFFFFFu;
+  bursts = 0;
+  for (uint32_t i = 0; i < 30u; i++)
+  {
+    const uint32_t now = osKernelGetTickCount();
+    inv_fb_fresh(&ci.inv[0], now);
+    inv_fb_fresh(&ci.inv[1], now);
+    inv_fb_fresh(&ci.inv[3], now);
+    Control_Step10ms(&ci, &out);
+    for (uint32_t j = 0; j < out.count; j++)
+    {
+      if (out.msgs[j].id != 0x181u) continue;
+      if (bursts++ != 0u && now - last < gap_min) gap_min = now - last;
+      last = now;
+    }
+    osDelay(1);
+  }
+  ASSERT_EQUAL(gap_min, min4, S, "20.13_period_raised_to_budget");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+uint32_t test_suite_inverters(void)
+{
+  g_suite_errors = 0;
+  Diag_Log("\n--- S20: N inverters / torque vectoring ---");
+
+  uint32_t ok = suite_inverters_body();
+
+  /* El resto de suites asumen el coche actual */
+  Inv_SetLayout(&INV_LAYOUT_1WD);
+  Control_Init();
+  return ok;
+}
+
+/* ============================================================================
+   S21 – CONTEXTOS DE CONTROL: independencia y checkpoint
+   ========================================================================== */
+uint32_t test_suite_ctrl_ctx(void)
+{
+  const char *S = "S21_CTRL_CTX";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S21: Control contexts ---");
+
+  static ctrl_ctx_t a, b;
+  static uint8_t blob[CONTROL_CTX_BLOB_SIZE];
+  app_inputs_t in;
+  uint8_t ev23 = 0;
+  memset(&in, 0, sizeof(in));
+  Control_CtxInit(&a, 1000u);
+  Control_CtxInit(&b, 1000u);
+
+  /* S21.1 – El latch EV2.3 de un contexto no afecta a otro ni al global */
+  in.s1_aceleracion = TINT_ADC_S1_100PCT;
+  in.s2_aceleracion = TINT_ADC_S2_100PCT;
+  in.s_freno        = TINT_ADC_FRENO_ON;
+  (void)Control_ComputeTorqueCtx(&a, &in, &ev23, NULL);
+  ASSERT_EQUAL(ev23, 1u, S, "21.1_latch_set_in_a");
+  in.s_freno = TINT_ADC_FRENO_OFF;
+  ASSERT_EQUAL(Control_ComputeTorqueCtx(&b, &in, &ev23, NULL), 100u, S, "21.1_b_unlatched");
+  ASSERT_EQUAL(Control_ComputeTorque(&in, &ev23, NULL), 100u, S, "21.1_default_unlatched");
+  ASSERT_EQUAL(Control_ComputeTorqueCtx(&a, &in, &ev23, NULL), 0u, S, "21.1_a_still_latched");
+
+  /* S21.2 – Tiempo propio: el retardo R2D cuenta con now_ms del llamante */
+  control_out_t out;
+  in.s1_aceleracion = 0; in.s2_aceleracion = 0;
+  in.ok_precarga = 1; in.boton_arranque = 1; in.s_freno = TINT_ADC_FRENO_ON;
+  Control_StepCtx(&b, &in, &out, 100u);
+  Control_StepCtx(&b, &in, &out, 101u);
+  in.boton_arranque = 0; in.s_freno = TINT_ADC_FRENO_OFF;
+  Control_StepCtx(&b, &in, &out, 2000u);
+  Control_StepCtx(&b, &in, &out, 2001u);
+  ASSERT_EQUAL(out.count, 0u, S, "21.2_r2d_not_elapsed");
+  Control_StepCtx(&b, &in, &out, 2101u);
+  Control_StepCtx(&b, &in, &out, 2102u);
+  Control_StepCtx(&b, &in, &out, 2103u);
+  ASSERT_EQUAL(out.count, 1u, S, "21.2_run_after_own_delay");
+  ASSERT_EQUAL(out.msgs[0].id, 0x181u, S, "21.2_run_command_frame");
+
+  /* S21.3 – Checkpoint: copia exacta; cabecera o datos alterados → -1 */
+  uint32_t n = Control_CtxSerialize(&b, blob, sizeof(blob));
+  ASSERT_EQUAL(n, CONTROL_CTX_BLOB_SIZE, S, "21.3_blob_size");
+  ASSERT_EQUAL(Control_CtxSerialize(&b, blob, 16u), 0u, S, "21.3_short_buffer");
+  ASSERT_EQUAL((uint32_t)Control_CtxRestore(&a, blob, n), 0u, S, "21.3_restore_ok");
+  ASSERT_TRUE(memcmp(&a, &b, sizeof(a)) == 0, S, "21.3_identical");
+  blob[20] ^= 0x80u;
+  ASSERT_TRUE(Control_CtxRestore(&a, blob, n) != 0, S, "21.3_crc_rejected");
+  blob[20] ^= 0x80u;
+  blob[4] ^= 0x01u;   /* versión */
+  ASSERT_TRUE(Control_CtxRestore(&a, blob, n) != 0, S, "21.3_version_rejected");
+  ASSERT_TRUE(memcmp(&a, &b, sizeof(a)) == 0, S, "21.3_ctx_untouched_on_error");
+
+  /* S21.4 – Calibración de pedal por contexto: umbral de freno */
+  apps_cal_t cal = APPS_CAL_DEFAULT;
+  cal.brake_adc = 3600u;
+  Control_CtxInit(&a, 1000u);
+  Control_CtxSetAppsCal(&a, &cal);
+  in.s1_aceleracion = TINT_ADC_S1_100PCT;
+  in.s2_aceleracion = TINT_ADC_S2_100PCT;
+  in.s_freno        = TINT_ADC_FRENO_ON;       /* 3500 < 3600: sin freno */
+  ASSERT_EQUAL(Control_ComputeTorqueCtx(&a, &in, &ev23, NULL), 100u, S, "21.4_brake_threshold");
+  ASSERT_EQUAL(ev23, 0u, S, "21.4_no_latch");
+  cal.s1_adc_per_pct = 0.0f;
+  Control_CtxSetAppsCal(&a, &cal);
+  ASSERT_EQUAL((uint32_t)Control_CtxSetAppsCal(&a, &cal), (uint32_t)-1, S, "21.4_bad_span_refused");
+  ASSERT_EQUAL(a.apps.brake_adc, 3600u, S, "21.4_bad_span_ignored");
+
+  /* S21.5 – Un sensor al 100 % y el otro en la banda muerta con max_pct
+   *         bajo: la media (60 %) supera max_pct pero el pedal es
+   *         implausible → 0, no 100 %. Banda >= mínimo o mínimo > máximo
+   *         se rechazan */
+  cal = APPS_CAL_DEFAULT;
+  cal.deadband_pct = 30.0f;
+  cal.min_pct      = 40;
+  cal.max_pct      = 50;
+  Control_CtxInit(&a, 1000u);
+  ASSERT_EQUAL((uint32_t)Control_CtxSetAppsCal(&a, &cal), 0u, S, "21.5_low_max_accepted");
+  in.s_freno        = TINT_ADC_FRENO_OFF;
+  in.s1_aceleracion = TINT_ADC_S1_100PCT;
+  in.s2_aceleracion = (uint16_t)(cal.s2_offset_adc + 20.0f * cal.s2_adc_per_pct);
+  ASSERT_EQUAL(Control_ComputeTorqueCtx(&a, &in, &ev23, NULL), 0u, S, "21.5_one_sensor_in_deadband");
+  in.s2_aceleracion = TINT_ADC_S2_100PCT;
+  ASSERT_EQUAL(Control_ComputeTorqueCtx(&a, &in, &ev23, NULL), 100u, S, "21.5_both_on_full");
+  cal.deadband_pct = 40.0f;
+  ASSERT_EQUAL((uint32_t)Control_CtxSetAppsCal(&a, &cal), (uint32_t)-1, S, "21.5_deadband_ge_min_refused");
+  cal.deadband_pct = 30.0f;
+  cal.min_pct      = 60;
+  ASSERT_EQUAL((uint32_t)Control_CtxSetAppsCal(&a, &cal), (uint32_t)-1, S, "21.5_min_gt_max_refused");
+  ASSERT_EQUAL(a.apps.min_pct, 40u, S, "21.5_previous_cal_kept");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S22 – ALMACÉN DE CALIBRACIÓN
+   ========================================================================== */
+#ifdef SIL_BUILD
+#define TINT_CALIB_FILE "s22_calib_flash.bin"
+
+/* Altera un byte del fichero que hace de flash */
+static void calib_file_poke(uint32_t off, uint8_t xor_mask)
+{
+  FILE *f = fopen(TINT_CALIB_FILE, "r+b");
+  if (!f) return;
+  uint8_t b = 0;
+  if (fseek(f, (long)off, SEEK_SET) == 0 && fread(&b, 1, 1, f) == 1)
+  {
+    b ^= xor_mask;
+    fseek(f, (long)off, SEEK_SET);
+    fwrite(&b, 1, 1, f);
+  }
+  fclose(f);
+}
+#endif
+
+uint32_t test_suite_calib(void)
+{
+  const char *S = "S22_CALIB";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S22: Calibration store ---");
+
+  app_inputs_t in;
+  control_out_t out;
+  calib_stats_t st;
+  float v = 0.0f;
+  memset(&in, 0, sizeof(in));
+
+#ifdef SIL_BUILD
+  remove(TINT_CALIB_FILE);
+  Calib_SilSetFlashFile(TINT_CALIB_FILE);
+#endif
+  Calib_Init();
+  Control_Init();
+
+  /* S22.1 – Sin flash válida: valores por defecto, aplicados al control */
+  Calib_GetStats(&st);
+#ifdef SIL_BUILD
+  ASSERT_EQUAL((uint32_t)(int32_t)st.flash_slot, (uint32_t)-1, S, "22.1_no_slot");
+#endif
+  ASSERT_EQUAL(Calib_Peek()->apps.brake_adc, APPS_CAL_DEFAULT.brake_adc, S, "22.1_default_live");
+  Control_Step10ms(&in, &out);
+  ASSERT_EQUAL(Control_DefaultCtx()->apps.brake_adc, APPS_CAL_DEFAULT.brake_adc, S, "22.1_ctrl_default");
+
+  /* S22.2 – Tabla tipada: ID desconocido, rango, tipo entero redondeado */
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x7FFFu, 1.0f), (uint32_t)CALIB_ERR_ID, S, "22.2_unknown_id");
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x0301u, 90000.0f), (uint32_t)CALIB_ERR_RANGE, S, "22.2_p_max_range");
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x0108u, 3600.4f), (uint32_t)CALIB_OK, S, "22.2_brake_set");
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x0201u, 50.0f), (uint32_t)CALIB_OK, S, "22.2_inv_period_set");
+  Calib_Get(0x0108u, &v);
+  ASSERT_EQUAL((uint32_t)v, 3600u, S, "22.2_brake_staged");
+  ASSERT_EQUAL(Calib_Peek()->apps.brake_adc, APPS_CAL_DEFAULT.brake_adc, S, "22.2_live_untouched");
+
+  /* Imagen completa (Calib_SetData): mismos límites que Calib_Set; fuera
+   * de rango se rechaza entera y el stage no cambia */
+  {
+    calib_data_t d = *Calib_Peek();
+    d.apps.brake_adc = 3600u;
+    d.ctrl.inv_read_period_ms = 50u;
+    d.ctrl.launch.torque_start_pct = 50.0f;
+    d.ctrl.power_limit.p_max_w = 90000.0f;
+    ASSERT_EQUAL((uint32_t)Calib_SetData(&d), (uint32_t)CALIB_ERR_RANGE, S, "22.2_image_out_of_range");
+    Calib_Get(0x0701u, &v);
+    ASSERT_RANGE(v, 70, 70, S, "22.2_image_refused_stage_kept");
+    d.ctrl.power_limit.p_max_w = 80000.0f;
+    ASSERT_EQUAL((uint32_t)Calib_SetData(&d), (uint32_t)CALIB_OK, S, "22.2_image_staged");
+    Calib_Get(0x0701u, &v);
+    ASSERT_RANGE(v, 50, 50, S, "22.2_image_launch_staged");
+  }
+
+  /* S22.3 – Commit A/B: el control lo toma en el siguiente ciclo; un
+   * segundo commit espera a que el control haya soltado el banco viejo */
+  ASSERT_EQUAL((uint32_t)Calib_Commit(), (uint32_t)CALIB_OK, S, "22.3_commit");
+  ASSERT_EQUAL(Calib_Peek()->apps.brake_adc, 3600u, S, "22.3_live_new");
+  ASSERT_EQUAL(Control_DefaultCtx()->apps.brake_adc, APPS_CAL_DEFAULT.brake_adc, S, "22.3_ctrl_not_yet");
+  ASSERT_EQUAL((uint32_t)Calib_Commit(), (uint32_t)CALIB_ERR_BUSY, S, "22.3_busy_until_acquired");
+  Control_Step10ms(&in, &out);
+  ASSERT_EQUAL(Control_DefaultCtx()->apps.brake_adc, 3600u, S, "22.3_ctrl_hot_reload");
+  ASSERT_EQUAL(Control_DefaultCtx()->cfg.inv_read_period_ms, 50u, S, "22.3_ctrl_cfg_reload");
+  /* El perfil de launch son tablas: se reconstruyen con la calibración */
+  ASSERT_RANGE(Control_DefaultCtx()->launch.tab_torque_pct[0], 50, 50, S, "22.3_launch_tables_rebuilt");
+  ASSERT_EQUAL((uint32_t)Calib_Commit(), (uint32_t)CALIB_OK, S, "22.3_commit_after_acquire");
+  Control_Step10ms(&in, &out);
+
+#ifdef SIL_BUILD
+  /* S22.4 – Guardar: slots alternos con contador; el arranque toma el último */
+  ASSERT_EQUAL((uint32_t)Calib_Save(), (uint32_t)CALIB_OK, S, "22.4_save_1");
+  Calib_Set(0x0108u, 3700.0f);
+  Calib_Commit();
+  Control_Step10ms(&in, &out);
+  Calib_RequestSave();
+  Calib_Service();
+  Calib_GetStats(&st);
+  ASSERT_EQUAL(st.flash_slot, 1u, S, "22.4_second_slot");
+  ASSERT_EQUAL(st.flash_counter, 2u, S, "22.4_counter");
+  Calib_Init();
+  Calib_GetStats(&st);
+  ASSERT_EQUAL(st.flash_slot, 1u, S, "22.4_boot_newest");
+  ASSERT_EQUAL(st.records_loaded, CALIB_PARAM_COUNT, S, "22.4_all_records");
+  ASSERT_EQUAL(Calib_Peek()->apps.brake_adc, 3700u, S, "22.4_value_persisted");
+  ASSERT_EQUAL(Calib_Peek()->ctrl.inv_read_period_ms, 50u, S, "22.4_period_persisted");
+
+  /* S22.5 – Registro corrupto en el slot nuevo (CRC) → vuelve al anterior */
+  calib_file_poke(CALIB_SLOT_SIZE + CALIB_FLASH_WORD + 4u, 0x01u);
+  Calib_Init();
+  Calib_GetStats(&st);
+  ASSERT_EQUAL(st.flash_slot, 0u, S, "22.5_crc_fallback");
+  ASSERT_EQUAL(Calib_Peek()->apps.brake_adc, 3600u, S, "22.5_older_value");
+
+  /* S22.6 – Escritura cortada (sin cabecera): el siguiente guardado va al
+   * slot roto, el bueno queda intacto */
+  calib_file_poke(CALIB_SLOT_SIZE, 0xFFu);
+  ASSERT_EQUAL((uint32_t)Calib_Save(), (uint32_t)CALIB_OK, S, "22.6_save_over_broken");
+  Calib_GetStats(&st);
+  ASSERT_EQUAL(st.flash_slot, 1u, S, "22.6_target_broken_slot");
+  ASSERT_EQUAL(st.flash_counter, 2u, S, "22.6_counter_after_valid");
+
+  /* S22.7 – Con el coche en marcha no se borra flash (bloquea el núcleo ~1 s),
+   *         la pida quien la pida (umbral de freno calibrado arriba: 3600) */
+  Control_Init();
+  in.ok_precarga = 1; in.boton_arranque = 1; in.s_freno = 4000u;
+  Control_Step10ms(&in, &out);
+  Control_Step10ms(&in, &out);
+  osDelay(2100);
+  in.boton_arranque = 0; in.s_freno = TINT_ADC_FRENO_OFF;
+  Control_Step10ms(&in, &out);
+  Control_Step10ms(&in, &out);
+  ASSERT_EQUAL(Control_IsRunning(), 1u, S, "22.7_running");
+  const uint32_t errs = st.save_errors, saves = st.saves;
+  ASSERT_EQUAL((uint32_t)Calib_Save(), (uint32_t)CALIB_ERR_RUNNING, S, "22.7_save_refused");
+  Calib_RequestSave();
+  Calib_Service();
+  Calib_GetStats(&st);
+  ASSERT_TRUE(st.saves == saves && st.save_errors == errs + 2u && st.flash_counter == 2u,
+              S, "22.7_deferred_refused_too");
+  memset(&in, 0, sizeof(in));
+#endif
+
+  /* Restaurar: calibración por defecto en vivo para las suites siguientes */
+  Calib_StageDefaults();
+  Control_Step10ms(&in, &out);
+  Calib_Commit();
+  Control_Init();
+#ifdef SIL_BUILD
+  remove(TINT_CALIB_FILE);
+#endif
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S23 – FRESCURA DE SEÑALES: marca por trama, timeout, corte de par
+   ========================================================================== */
+
+/* Trama de 2 bytes LE al parser (sensores del dashboard) */
+static void fresh_feed(app_inputs_t *in, uint32_t id, uint16_t raw)
+{
+  uint8_t d[2] = { (uint8_t)(raw & 0xFFu), (uint8_t)(raw >> 8) };
+  can_msg_t m = make_can_msg(id, CAN_BUS_DASH, d, 2);
+  CanRx_ParseAndUpdate(&m, in);
+}
+
+uint32_t test_suite_freshness(void)
+{
+  const char *S = "S23_FRESH";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S23: Signal freshness ---");
+
+  app_inputs_t in;
+  control_out_t out;
+  memset(&in, 0, sizeof(in));
+
+  /* S23.1 – El parser marca la señal de cada trama; un ID ajeno no marca */
+  uint32_t t0 = osKernelGetTickCount();
+  fresh_feed(&in, TINT_ID_S1_ACEL, 2500u);
+  fresh_feed(&in, 0x7F0u, 1u);
+  ASSERT_EQUAL(in.sig_seen, FRESH_BIT(SIG_S1_ACELERACION), S, "23.1_seen_bit");
+  ASSERT_EQUAL(in.sig_tick[SIG_S1_ACELERACION], t0, S, "23.1_tick");
+
+  /* S23.2 – Timeout = 3 periodos; una señal nunca recibida no caduca */
+  const uint32_t tmo = FRESH_MISSED_PERIODS * FRESH_SIGNALS[SIG_S1_ACELERACION].period_ms;
+  ASSERT_EQUAL(Fresh_Check(&in, t0 + tmo), 0u, S, "23.2_fresh_at_timeout");
+  ASSERT_EQUAL(Fresh_Check(&in, t0 + tmo + 1u), FRESH_BIT(SIG_S1_ACELERACION), S, "23.2_stale_after");
+  fresh_feed(&in, TINT_ID_V_CELDA_MIN, 3300u);
+  ASSERT_EQUAL(Fresh_Check(&in, t0 + 3u * 100u) & FRESH_BIT(SIG_V_CELDA_MIN), 0u, S, "23.2_slow_period");
+  ASSERT_EQUAL(Fresh_Check(&in, t0 + 1000000u) & ~in.sig_seen, 0u, S, "23.2_unseen_never_stale");
+
+  /* S23.3 – Freno sin tramas: el arranque no avanza aunque marque pulsado */
+  memset(&in, 0, sizeof(in));
+  Control_Init();
+  in.ok_precarga = 1; in.boton_arranque = 1;
+  fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_ON);
+  Control_Step10ms(&in, &out);                 /* BOOT → WAIT_START_BRAKE */
+  osDelay(50);
+  Control_Step10ms(&in, &out);
+  ASSERT_TRUE(Control_GetStaleSignals() & FRESH_BIT(SIG_S_FRENO), S, "23.3_brake_stale");
+  ASSERT_EQUAL(Control_DefaultCtx()->state, 2u, S, "23.3_start_blocked");
+  fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_ON);
+  Control_Step10ms(&in, &out);
+  ASSERT_EQUAL(Control_DefaultCtx()->state, 3u, S, "23.3_start_when_fresh");
+
+  /* S23.4 – RUN con pedal y freno por CAN a 100 Hz: hay par */
+  osDelay(2100);
+  in.boton_arranque = 0;
+  fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_OFF);
+  Control_Step10ms(&in, &out);                 /* R2D → READY */
+  Control_Step10ms(&in, &out);                 /* READY → RUN */
+  for (uint32_t i = 0; i < 60u; i++)
+  {
+    fresh_feed(&in, TINT_ID_S1_ACEL, TINT_ADC_S1_100PCT);
+    fresh_feed(&in, TINT_ID_S2_ACEL, TINT_ADC_S2_100PCT);
+    fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_OFF);
+    Control_Step10ms(&in, &out);
+    osDelay(10);
+  }
+  ASSERT_TRUE(Control_IsRunning() && out.torque_pct > 50, S, "23.4_torque_with_fresh_apps");
+  ASSERT_EQUAL(Control_GetStaleSignals(), 0u, S, "23.4_nothing_stale");
+
+  /* S23.5 – El sensor S2 deja de emitir: par 0 en cuanto caduca (30 ms),
+   *         el último valor recibido sigue siendo 100 % */
+  int16_t tq_before = out.torque_pct;
+  uint32_t cut_ms = 0;
+  for (uint32_t i = 0; i < 10u; i++)
+  {
+    fresh_feed(&in, TINT_ID_S1_ACEL, TINT_ADC_S1_100PCT);
+    fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_OFF);
+    Control_Step10ms(&in, &out);
+    if (out.torque_pct == 0) break;
+    cut_ms += 10u;
+    osDelay(10);
+  }
+  ASSERT_TRUE(tq_before > 0 && out.torque_pct == 0, S, "23.5_stale_apps_zero_torque");
+  ASSERT_TRUE(cut_ms > tmo - 10u && cut_ms <= tmo + 10u, S, "23.5_cut_at_timeout");
+  ASSERT_EQUAL(Control_GetStaleSignals(), FRESH_BIT(SIG_S2_ACELERACION), S, "23.5_stale_mask");
+  ASSERT_TRUE(Control_IsRunning(), S, "23.5_still_run");
+
+  /* S23.6 – Vuelve S2: el par se recupera por la rampa, desde 0 */
+  fresh_feed(&in, TINT_ID_S2_ACEL, TINT_ADC_S2_100PCT);
+  fresh_feed(&in, TINT_ID_S1_ACEL, TINT_ADC_S1_100PCT);
+  fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_OFF);
+  Control_Step10ms(&in, &out);
+  int16_t tq_first = out.torque_pct;
+  for (uint32_t i = 0; i < 60u; i++)
+  {
+    osDelay(10);
+    fresh_feed(&in, TINT_ID_S1_ACEL, TINT_ADC_S1_100PCT);
+    fresh_feed(&in, TINT_ID_S2_ACEL, TINT_ADC_S2_100PCT);
+    fresh_feed(&in, TINT_ID_S_FRENO, TINT_ADC_FRENO_OFF);
+    Control_Step10ms(&in, &out);
+  }
+  ASSERT_TRUE(tq_first > 0 && tq_first < tq_before, S, "23.6_ramp_from_zero");
+  ASSERT_EQUAL(out.torque_pct, tq_before, S, "23.6_torque_restored");
+
+  /* S23.7 – Freno caduca en RUN: par 0 también */
+  for (uint32_t i = 0; i < 5u; i++)
+  {
+    osDelay(10);
+    fresh_feed(&in, TINT_ID_S1_ACEL, TINT_ADC_S1_100PCT);
+    fresh_feed(&in, TINT_ID_S2_ACEL, TINT_ADC_S2_100PCT);
+    Control_Step10ms(&in, &out);
+  }
+  ASSERT_EQUAL(out.torque_pct, 0, S, "23.7_stale_brake_zero_torque");
+
+  Control_Init();
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S24 – SUSCRIPCIÓN CÍCLICA BAMOCAR: armado, decodificación, re-armado
+   ========================================================================== */
+#if (INV_BACKEND == INV_BACKEND_BAMOCAR) || defined(INV_BACKEND_ALL)
+static void bamo_answer(app_inputs_t *st, uint8_t regid, int16_t raw, uint32_t now)
+{
+  uint8_t d[3] = { regid, (uint8_t)((uint16_t)raw & 0xFFu), (uint8_t)((uint16_t)raw >> 8) };
+  can_msg_t m = make_can_msg(0x181u, CAN_BUS_INV, d, 3);
+  (void)Bamo_Decode(&m, st, 0u, now);
+}
+
+uint32_t test_suite_bamocar(void)
+{
+  const char *S = "S24_BAMOCAR";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S24: BAMOCAR cyclic subscriptions ---");
+
+  Inv_SetLayout(&INV_LAYOUT_1WD);
+  const inv_node_t *nd = &Inv_GetLayout()->node[0];
+  app_inputs_t st;
+  bamo_sub_t sub;
+  can_msg_t msgs[BAMO_REG_COUNT];
+  memset(&st, 0, sizeof(st));
+  Bamo_SubInit(&sub);
+
+  /* S24.1 – Armado: un READ por registro al rxID, con su periodo */
+  uint32_t n = Bamo_SubService(&sub, nd, &st.inv[0], 25u, 1000u, msgs, BAMO_REG_COUNT);
+  ASSERT_EQUAL(n, BAMO_REG_COUNT, S, "24.1_all_armed");
+  ASSERT_TRUE(msgs[0].id == 0x201u && msgs[0].dlc == 3u && msgs[0].data[0] == BAMO_READ &&
+              msgs[0].data[1] == BAMO_REG_I_ACTUAL && msgs[0].data[2] == 25u, S, "24.1_read_frame");
+  ASSERT_TRUE(msgs[2].data[1] == BAMO_REG_DC_BUS && msgs[2].data[2] == 50u &&
+              msgs[5].data[1] == BAMO_REG_T_AIR && msgs[5].data[2] == 100u, S, "24.1_own_periods");
+  ASSERT_EQUAL(Bamo_SubService(&sub, nd, &st.inv[0], 25u, 1001u, msgs, BAMO_REG_COUNT), 0u, S, "24.1_once");
+
+  /* S24.2 – Decodificación por tabla REGID: escala de cada registro,
+   *         marca por campo; un REGID no suscrito no toca nada */
+  bamo_answer(&st, BAMO_REG_DC_BUS, 22000, 1010u);        /* /55 → 400 V  */
+  bamo_answer(&st, BAMO_REG_T_IGBT, 655, 1010u);          /* /10 → 65 °C  */
+  ASSERT_EQUAL(st.inv[0].dc_bus_v, 400, S, "24.2_dc_bus_scaled");
+  ASSERT_EQUAL(st.inv_dc_bus_voltage, 0u, S, "24.2_acu_scalar_untouched");
+  ASSERT_EQUAL(st.inv_igbt_temp, 65, S, "24.2_temp_aggregated");
+  ASSERT_EQUAL(st.inv[0].fld_seen, (uint32_t)((1u << INV_FB_DC_BUS) | (1u << INV_FB_T_IGBT)), S, "24.2_field_marks");
+  ASSERT_EQUAL(st.inv[0].fld_tick[INV_FB_DC_BUS], 1010u, S, "24.2_field_tick");
+  uint8_t d_x[3] = { 0x90u, 0x01u, 0x00u };
+  can_msg_t mx = make_can_msg(0x181u, CAN_BUS_INV, d_x, 3);
+  ASSERT_EQUAL((uint32_t)Bamo_Decode(&mx, &st, 0u, 1011u), 0u, S, "24.2_unknown_regid");
+  ASSERT_EQUAL(st.inv[0].rx_tick, 1010u, S, "24.2_unknown_no_mark");
+
+  /* S24.3 – Inversor respondiendo a su ritmo 1 s: ninguna petición más */
+  uint32_t extra = 0;
+  for (uint32_t t = 1000u; t <= 2000u; t += 5u)
+  {
+    for (uint32_t i = 0; i < BAMO_REG_COUNT; i++)
+    {
+      const uint32_t p = BAMO_REGS[i].period_ms ? BAMO_REGS[i].period_ms : 25u;
+      if (t % p == 0u) bamo_answer(&st, BAMO_REGS[i].regid, 100, t);
+    }
+    extra += Bamo_SubService(&sub, nd, &st.inv[0], 25u, t, msgs, BAMO_REG_COUNT);
+  }
+  ASSERT_EQUAL(extra, 0u, S, "24.3_no_polling");
+  ASSERT_EQUAL(sub.requests, BAMO_REG_COUNT, S, "24.3_requests_boot_only");
+
+  /* S24.4 – Reset del inversor en t=2000: cada registro se re-arma a los
+   *         4 periodos de silencio (100 / 200 / 400 ms), y de nuevo cada
+   *         4 periodos mientras siga callado: I/N ×4, DC ×2, temperaturas ×1 */
+  uint32_t rearm_at[BAMO_REG_COUNT] = { 0u };
+  uint32_t rearms = 0;
+  for (uint32_t t = 2005u; t <= 2450u; t += 5u)
+  {
+    n = Bamo_SubService(&sub, nd, &st.inv[0], 25u, t, msgs, BAMO_REG_COUNT);
+    for (uint32_t j = 0; j < n; j++)
+    {
+      for (uint32_t i = 0; i < BAMO_REG_COUNT; i++)
+      {
+        if (msgs[j].data[1] == BAMO_REGS[i].regid && rearm_at[i] == 0u) rearm_at[i] = t;
+      }
+    }
+    rearms += n;
+  }
+  ASSERT_EQUAL(rearm_at[0], 2100u, S, "24.4_fast_reg_rearm");
+  ASSERT_EQUAL(rearm_at[2], 2200u, S, "24.4_dc_bus_rearm");
+  ASSERT_EQUAL(rearm_at[5], 2400u, S, "24.4_temp_rearm");
+  ASSERT_EQUAL(sub.rearms, rearms, S, "24.4_rearm_counter");
+  ASSERT_EQUAL(rearms, 13u, S, "24.4_paced_while_silent");
+
+  /* S24.5 – Cambio de periodo calibrado: sólo I / N se piden de nuevo */
+  n = Bamo_SubService(&sub, nd, &st.inv[0], 50u, 2451u, msgs, BAMO_REG_COUNT);
+  ASSERT_EQUAL(n, 2u, S, "24.5_period_change_requests");
+  ASSERT_TRUE(msgs[0].data[2] == 50u && msgs[1].data[1] == BAMO_REG_N_ACTUAL, S, "24.5_new_period");
+
+  /* S24.6 – Sin hueco en la salida: lo que no cabe sale en la llamada siguiente */
+  Bamo_SubInit(&sub);
+  ASSERT_EQUAL(Bamo_SubService(&sub, nd, &st.inv[0], 25u, 3000u, msgs, 4u), 4u, S, "24.6_room_limited");
+  n = Bamo_SubService(&sub, nd, &st.inv[0], 25u, 3001u, msgs, BAMO_REG_COUNT);
+  ASSERT_TRUE(n == 2u && msgs[1].data[1] == BAMO_REG_T_AIR, S, "24.6_rest_next_call");
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+#endif
+
+/* ============================================================================
+   S25 – BACKEND ePowerLabs: TX_STATE al modelo, RX_SETPOINT ida y vuelta
+   ========================================================================== */
+#if (INV_BACKEND == INV_BACKEND_EPL) || defined(INV_BACKEND_ALL)
+uint32_t test_suite_epl(void)
+{
+  const char *S = "S25_EPL";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S25: ePowerLabs backend ---");
+
+  Inv_SetLayout(&INV_LAYOUT_EPL);
+  const inv_node_t *nd = &Inv_GetLayout()->node[0];
+  app_inputs_t st;
+  memset(&st, 0, sizeof(st));
+
+  /* S25.1 – TX_STATE_2: dos señales con signo en una trama */
+  uint8_t d2[8] = { 0x18u, 0xFCu, 0x9Cu, 0xFFu };          /* -1000 rpm, -10.0 Nm */
+  can_msg_t m = make_can_msg(0x461u, CAN_BUS_INV, d2, 8);
+  ASSERT_EQUAL((uint32_t)Epl_Decode(&m, &st, 500u),
+               (uint32_t)((1u << INV_FB_RPM) | (1u << INV_FB_TORQUE)), S, "25.1_fields_returned");
+  ASSERT_EQUAL(st.inv[0].rpm, -1000, S, "25.1_rpm_signed");
+  ASSERT_EQUAL(st.inv[0].torque_dnm, -100, S, "25.1_torque_signed");
+  ASSERT_EQUAL(st.inv_rpm, -1000, S, "25.1_aggregated");
+  ASSERT_EQUAL(st.inv[0].fld_tick[INV_FB_TORQUE], 500u, S, "25.1_field_tick");
+
+  /* S25.2 – Escala en décimas: DC link e intensidades */
+  uint8_t d3[8] = { 0x70u, 0x0Fu, 0x38u, 0xFFu };          /* 3952 → 395 V, -200 → -20 A */
+  m = make_can_msg(0x462u, CAN_BUS_INV, d3, 8);
+  (void)Epl_Decode(&m, &st, 510u);
+  ASSERT_EQUAL(st.inv[0].dc_bus_v, 395, S, "25.2_dc_bus_tenths");
+  ASSERT_EQUAL(st.inv[0].i_dc, -20, S, "25.2_idc_signed_tenths");
+
+  /* S25.3 – TX_STATE_1: palabra de estado a inv_state */
+  uint8_t d1[8] = { 0x04u, 0x00u, 0x21u, 0x00u, 0x00u, 0x01u };
+  m = make_can_msg(0x460u, CAN_BUS_INV, d1, 8);
+  (void)Epl_Decode(&m, &st, 520u);
+  ASSERT_TRUE(st.inv[0].state == 4u && st.inv[0].error == 0x21u && st.inv[0].warning == 0x100u,
+              S, "25.3_state_error_warning");
+  ASSERT_EQUAL(st.inv_state, 4u, S, "25.3_inv_state");
+
+  /* S25.4 – Fuera de TX_STATE_1..9, otro bus, remota: nada */
+  m = make_can_msg(0x469u, CAN_BUS_INV, d1, 8);
+  ASSERT_EQUAL((uint32_t)Epl_Decode(&m, &st, 530u), 0u, S, "25.4_past_last_frame");
+  m = make_can_msg(0x45Fu, CAN_BUS_INV, d1, 8);
+  ASSERT_EQUAL((uint32_t)Epl_Decode(&m, &st, 530u), 0u, S, "25.4_before_first_frame");
+  m = make_can_msg(0x460u, CAN_BUS_ACU, d1, 8);
+  ASSERT_EQUAL((uint32_t)Epl_Decode(&m, &st, 530u), 0u, S, "25.4_other_bus");
+  ASSERT_EQUAL(st.inv[0].rx_tick, 520u, S, "25.4_no_mark");
+
+  /* S25.5 – RX_SETPOINT_1..6: empaquetado y decodificación simétricos */
+  epl_setpoint_t a = { EPL_CTRL_ENABLE, EPL_MODE_TORQUE, -321, 7000, -500, 2300, -1200, 300, -40, 250u, 590u };
+  epl_setpoint_t b;
+  memset(&b, 0, sizeof(b));
+  uint32_t ok = 1u;
+  for (uint8_t i = 0; i < EPL_SP_FRAMES; i++)
+  {
+    Epl_PackSetpoint(nd, &a, i, &m);
+    ok = ok && m.id == 0x360u + i && m.bus == CAN_BUS_INV && Epl_DecodeSetpoint(&m, nd, &b) == (int)i;
+  }
+  ASSERT_TRUE(ok, S, "25.5_ids_in_order");
+  ASSERT_TRUE(memcmp(&a, &b, sizeof(a)) == 0, S, "25.5_round_trip");
+
+  /* S25.6 – Orden de par: habilitado, modo par, % en décimas */
+  can_msg_t cmd[EPL_CMD_FRAMES];
+  Epl_BuildCmd(nd, -35, cmd);
+  memset(&b, 0, sizeof(b));
+  ASSERT_TRUE(Epl_DecodeSetpoint(&cmd[0], nd, &b) == 0 && Epl_DecodeSetpoint(&cmd[1], nd, &b) == 1,
+              S, "25.6_two_frames");
+  ASSERT_TRUE(b.ctrl == (EPL_CTRL_ENABLE | EPL_CTRL_RUN) && b.mode == EPL_MODE_TORQUE, S, "25.6_enable_run");
+  ASSERT_EQUAL(b.torque_pmil, -350, S, "25.6_torque_pmil");
+
+  Inv_SetLayout(NULL);
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+#endif
+
+/* ============================================================================
+   S26 – HANDSHAKES DE ARRANQUE: concurrentes, reintentos, diagnóstico
+   ========================================================================== */
+uint32_t test_suite_handshake(void)
+{
+  const char *S = "S26_HANDSHAKE";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S26: boot handshakes ---");
+
+  hs_t hs;
+  app_inputs_t st;
+  can_msg_t msgs[HS_NODE_COUNT];
+  memset(&st, 0, sizeof(st));
+  Hs_Init(&hs);
+
+  /* S26.1 – Primer paso: los tres ok a la vez, la AMS sólo escucha */
+  Fresh_Stamp(&st, SIG_ACK_TELEMETRIA, 900u);             /* ack viejo */
+  uint32_t n = Hs_Service(&hs, &st, 1000u, msgs, HS_NODE_COUNT);
+  ASSERT_EQUAL(n, TINT_HS_REQS, S, "26.1_all_requests_at_once");
+  ASSERT_TRUE(msgs[0].id == TINT_ID_OK_TELEMETRIA && msgs[1].id == TINT_ID_OK_CAJA_NEGRA &&
+              msgs[2].id == TINT_ID_OK_PANTALLA && msgs[0].bus == CAN_BUS_DASH &&
+              msgs[0].dlc == 1u && msgs[0].data[0] == 1u, S, "26.1_request_frames");
+  ASSERT_TRUE(hs.node[HS_NODE_AMS].state == HS_WAIT && hs.node[HS_NODE_AMS].attempts == 0u,
+              S, "26.1_ams_passive");
+  ASSERT_EQUAL(hs.node[HS_NODE_TELEMETRIA].state, (uint32_t)HS_WAIT, S, "26.1_old_ack_ignored");
+  ASSERT_EQUAL(Hs_RequiredReady(&hs), 0u, S, "26.1_not_ready");
+
+  /* S26.2 – ACK por CAN (0x30 → señal), listo con su tiempo */
+  uint32_t reqs = 0;
+  for (uint32_t t = 1010u; t < 1050u; t += 10u) reqs += Hs_Service(&hs, &st, t, msgs, HS_NODE_COUNT);
+  app_inputs_t rx;
+  memset(&rx, 0, sizeof(rx));
+  uint8_t d[1] = { 0u };
+  can_msg_t ack = make_can_msg(TINT_ID_ACK_TELEMETRIA, CAN_BUS_DASH, d, 1);
+  CanRx_ParseAndUpdate(&ack, &rx);
+  ASSERT_TRUE(rx.sig_seen & FRESH_BIT(SIG_ACK_TELEMETRIA), S, "26.2_ack_parsed");
+  Fresh_Stamp(&st, SIG_ACK_TELEMETRIA, 1050u);            /* reloj del test */
+  reqs += Hs_Service(&hs, &st, 1050u, msgs, HS_NODE_COUNT);
+  ASSERT_EQUAL(hs.node[HS_NODE_TELEMETRIA].state, (uint32_t)HS_READY, S, "26.2_ready");
+  ASSERT_EQUAL(hs.node[HS_NODE_TELEMETRIA].ready_ms, 50u, S, "26.2_ready_time");
+  ASSERT_EQUAL(reqs, 0u, S, "26.2_no_repeat_inside_timeout");
+
+  /* S26.3 – Caja negra muda: 4 reintentos cada 200 ms, FAILED a los 1000 ms;
+   *         no bloquea (no es obligatoria) */
+  uint32_t bb_reqs = 0, failed_at = 0;
+  for (uint32_t t = 1060u; t <= 2100u; t += 10u)
+  {
+    n = Hs_Service(&hs, &st, t, msgs, HS_NODE_COUNT);
+    for (uint32_t j = 0; j < n; j++) if (msgs[j].id == TINT_ID_OK_CAJA_NEGRA) bb_reqs++;
+    if (!failed_at && hs.node[HS_NODE_CAJA_NEGRA].state == HS_FAILED) failed_at = t;
+  }
+  ASSERT_EQUAL(bb_reqs, 4u, S, "26.3_retries");
+  ASSERT_EQUAL(hs.node[HS_NODE_CAJA_NEGRA].attempts, 5u, S, "26.3_attempts");
+  ASSERT_EQUAL(failed_at, 2000u, S, "26.3_failed_at_timeout");
+  ASSERT_EQUAL(Hs_FailedMask(&hs), 1u << HS_NODE_CAJA_NEGRA, S, "26.3_failed_mask");
+  ASSERT_EQUAL(hs.node[HS_NODE_PANTALLA].attempts, 2u, S, "26.3_screen_own_pace");
+
+  /* S26.4 – Precarga (AMS): el FSM espera sólo a los nodos obligatorios */
+  st.ok_precarga = 1u;
+  (void)Hs_Service(&hs, &st, 2500u, msgs, HS_NODE_COUNT);
+  ASSERT_EQUAL(hs.node[HS_NODE_AMS].ready_ms, 1500u, S, "26.4_precharge_time");
+  ASSERT_EQUAL(Hs_RequiredReady(&hs), 1u, S, "26.4_required_ready");
+  ASSERT_EQUAL(Hs_ReadyMask(&hs), (1u << HS_NODE_AMS) | (1u << HS_NODE_TELEMETRIA), S, "26.4_ready_mask");
+
+  /* S26.5 – Un nodo FAILED que responde tarde pasa a READY */
+  Fresh_Stamp(&st, SIG_ACK_CAJA_NEGRA, 2600u);
+  (void)Hs_Service(&hs, &st, 2600u, msgs, HS_NODE_COUNT);
+  ASSERT_EQUAL(hs.node[HS_NODE_CAJA_NEGRA].state, (uint32_t)HS_READY, S, "26.5_late_ack");
+  ASSERT_EQUAL(hs.node[HS_NODE_CAJA_NEGRA].ready_ms, 1600u, S, "26.5_late_time");
+
+  /* S26.6 – Sin hueco en la salida: el resto de peticiones al paso siguiente */
+  Hs_Init(&hs);
+  ASSERT_EQUAL(Hs_Service(&hs, &st, 3000u, msgs, 1u), 1u, S, "26.6_room_limited");
+  n = Hs_Service(&hs, &st, 3001u, msgs, HS_NODE_COUNT);
+  ASSERT_TRUE(n == 2u && msgs[1].id == TINT_ID_OK_PANTALLA, S, "26.6_rest_next_step");
+
+  /* S26.7 – Control: sin precarga no sale de la espera aunque el resto esté */
+  control_out_t out;
+  app_inputs_t ci;
+  memset(&ci, 0, sizeof(ci));
+  Control_Init();
+  Control_Step10ms(&ci, &out);
+  const uint32_t t0 = osKernelGetTickCount();
+  Fresh_Stamp(&ci, SIG_ACK_TELEMETRIA, t0);
+  Fresh_Stamp(&ci, SIG_ACK_CAJA_NEGRA, t0);
+  Fresh_Stamp(&ci, SIG_ACK_PANTALLA, t0);
+  ci.boton_arranque = 1; ci.s_freno = TINT_ADC_FRENO_ON;
+  Control_Step10ms(&ci, &out);
+  ASSERT_EQUAL(Hs_ReadyMask(Control_GetHandshake()), 0x0Eu, S, "26.7_optional_ready");
+  ASSERT_EQUAL(Control_IsRunning(), 0u, S, "26.7_waits_precharge");
+  ci.ok_precarga = 1;
+  for (uint32_t i = 0; i < 3u; i++) Control_Step10ms(&ci, &out);
+  ASSERT_EQUAL(Control_GetHandshake()->node[HS_NODE_AMS].state, (uint32_t)HS_READY, S, "26.7_ams_ready");
+
+  /* S26.8 – Nodo mudo en el coche: DTC U1002 en la memoria de fallos UDS */
+  uint32_t dtc = UDS_DTC_COUNT;
+  for (uint32_t i = 0; i < UDS_DTC_COUNT; i++) if (UDS_DTCS[i].code == 0xD00200u) dtc = i;
+  ASSERT_TRUE(dtc < UDS_DTC_COUNT, S, "26.8_dtc_listed");
+  Uds_Monitor(&ci);
+  ASSERT_EQUAL(Uds_GetDtcStatus(dtc) & UDS_DTC_TEST_FAILED, 0u, S, "26.8_no_fault_yet");
+  Control_Init();
+  memset(&ci, 0, sizeof(ci));
+  for (uint32_t i = 0; i < 7u; i++)
+  {
+    Control_Step10ms(&ci, &out);
+    osDelay(210);
+  }
+  ASSERT_TRUE(Hs_FailedMask(Control_GetHandshake()) & (1u << HS_NODE_CAJA_NEGRA), S, "26.8_node_failed");
+  Uds_Monitor(&ci);
+  ASSERT_TRUE(Uds_GetDtcStatus(dtc) & UDS_DTC_TEST_FAILED, S, "26.8_dtc_failed");
+  Control_Init();
+  Uds_Monitor(&ci);
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
+/* ============================================================================
+   S27 – MAPA DE IDs CAN: tabla en calibración, validación, hash de RX
+   ========================================================================== */
+#define TINT_CANMAP_FILE "s27_calib_flash.bin"
+
+/* Trama de 2 bytes LE al parser; devuelve el app_inputs_t resultante */
+static app_inputs_t canmap_feed(uint32_t id, uint16_t raw)
+{
+  app_inputs_t rx;
+  memset(&rx, 0, sizeof(rx));
+  uint8_t d[2] = { (uint8_t)(raw & 0xFFu), (uint8_t)(raw >> 8) };
+  can_msg_t m = make_can_msg(id, CAN_BUS_DASH, d, 2);
+  CanRx_ParseAndUpdate(&m, &rx);
+  return rx;
+}
+
+uint32_t test_suite_can_map(void)
+{
+  const char *S = "S27_CAN_MAP";
+  g_suite_errors = 0;
+  Diag_Log("\n--- S27: CAN ID map ---");
+
+  canmap_stats_t st;
+  canmap_ids_t ids;
+  app_inputs_t rx;
+
+  /* S27.1 – Tabla por defecto = IDs del coche; hash sin colisiones */
+  ASSERT_EQUAL((uint32_t)CanMap_Init(NULL), 0u, S, "27.1_defaults");
+  CanMap_GetStats(&st);
+  ASSERT_TRUE(st.from_table == 0u && st.used == CANMAP_RX_COUNT, S, "27.1_stats");
+  ASSERT_EQUAL(st.max_probe, 0u, S, "27.1_perfect_hash");
+  ASSERT_TRUE(CanMap_Id(CANMAP_ACK_PRECARGA) == TINT_ID_ACK_PRECARGA &&
+              CanMap_Id(CANMAP_S1_ACELERACION) == TINT_ID_S1_ACEL &&
+              CanMap_Id(CANMAP_V_CELDA_MIN) == TINT_ID_V_CELDA_MIN &&
+              CanMap_Id(CANMAP_OK_PANTALLA) == TINT_ID_OK_PANTALLA &&
+              CanMap_Id(CANMAP_ACK_PANTALLA) == TINT_ID_ACK_PANTALLA, S, "27.1_car_ids");
+  uint32_t hits = 0;
+  for (uint32_t k = 0; k < CANMAP_RX_COUNT; k++)
+  {
+    if (CanMap_RxKey(CANMAP_DEFAULT.id[k]) == k) hits++;
+  }
+  ASSERT_EQUAL(hits, CANMAP_RX_COUNT, S, "27.1_rx_lookup");
+  ASSERT_TRUE(CanMap_RxKey(TINT_TXID_INV) == CANMAP_NONE && CanMap_RxKey(0x7FFu) == CANMAP_NONE &&
+              CanMap_RxKey(0x12345u) == CANMAP_NONE &&
+              CanMap_RxKey(TINT_ID_OK_TELEMETRIA) == CANMAP_NONE, S, "27.1_unknown_ids");
+
+  /* S27.2 – IDs cambiados en la tabla: el parser sigue a la tabla */
+  ids = CANMAP_DEFAULT;
+  ids.id[CANMAP_S1_ACELERACION] = 0x111u;
+  ids.id[CANMAP_S_FRENO]        = TINT_ID_V_CELDA_MIN;       /* intercambio */
+  ids.id[CANMAP_V_CELDA_MIN]    = TINT_ID_S_FRENO;
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), 0u, S, "27.2_accepted");
+  CanMap_GetStats(&st);
+  ASSERT_EQUAL(st.from_table, 1u, S, "27.2_from_table");
+  rx = canmap_feed(0x111u, TINT_ADC_S1_50PCT);
+  ASSERT_EQUAL(rx.s1_aceleracion, TINT_ADC_S1_50PCT, S, "27.2_new_id_parsed");
+  rx = canmap_feed(TINT_ID_S1_ACEL, TINT_ADC_S1_50PCT);
+  ASSERT_TRUE(rx.s1_aceleracion == 0u && rx.sig_seen == 0u, S, "27.2_old_id_ignored");
+  rx = canmap_feed(TINT_ID_V_CELDA_MIN, TINT_ADC_FRENO_ON);
+  ASSERT_TRUE(rx.s_freno == TINT_ADC_FRENO_ON && rx.v_celda_min == 0u &&
+              (rx.sig_seen & FRESH_BIT(SIG_S_FRENO)), S, "27.2_swapped_ids");
+
+  /* S27.3 – Tramas del VCU: handshake y planificador resuelven por la tabla */
+  ids.id[CANMAP_OK_TELEMETRIA] = 0x0A8u;
+  ids.id[CANMAP_RTD_ALL]       = 0x088u;
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), 0u, S, "27.3_accepted");
+  hs_t hs;
+  app_inputs_t in;
+  can_msg_t msgs[HS_NODE_COUNT];
+  memset(&in, 0, sizeof(in));
+  Hs_Init(&hs);
+  (void)Hs_Service(&hs, &in, 0u, msgs, HS_NODE_COUNT);
+  ASSERT_TRUE(msgs[0].id == 0x0A8u && msgs[1].id == TINT_ID_OK_CAJA_NEGRA, S, "27.3_handshake_id");
+  ASSERT_EQUAL((uint32_t)TxSched_Init(NULL, 0u), 0u, S, "27.3_sched_loads");
+  uint32_t rtd = 0, old_rtd = 0;
+  for (uint32_t t = 0; t < 100u; t++)
+  {
+    can_msg_t tm[TXS_TICK_MAX];
+    const uint32_t n = TxSched_Tick(t, &in, NULL, tm, TXS_TICK_MAX);
+    for (uint32_t j = 0; j < n; j++)
+    {
+      if (tm[j].id == 0x088u) rtd++;
+      if (tm[j].id == 0x080u) old_rtd++;
+    }
+  }
+  ASSERT_TRUE(rtd == 1u && old_rtd == 0u, S, "27.3_sched_id");
+
+  /* S27.4 – Tabla inválida: se rechaza entera y quedan los valores por defecto */
+  CanMap_GetStats(&st);
+  const uint32_t rejected = st.rejected;
+  ids.id[CANMAP_S2_ACELERACION] = 0x111u;                   /* = S1 */
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.4_duplicate_refused");
+  CanMap_GetStats(&st);
+  ASSERT_TRUE(st.bad_key == CANMAP_S2_ACELERACION && st.from_table == 0u &&
+              st.rejected == rejected + 1u, S, "27.4_bad_key");
+  ASSERT_TRUE(CanMap_RxKey(TINT_ID_S1_ACEL) == CANMAP_S1_ACELERACION &&
+              CanMap_RxKey(0x111u) == CANMAP_NONE &&
+              CanMap_Id(CANMAP_OK_TELEMETRIA) == TINT_ID_OK_TELEMETRIA, S, "27.4_defaults_live");
+  ids = CANMAP_DEFAULT;
+  ids.id[CANMAP_I_ACTUAL] = 0x800u;
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.4_range_refused");
+  ids.id[CANMAP_I_ACTUAL] = 0u;
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.4_zero_refused");
+  ids = CANMAP_DEFAULT;
+  ids.id[CANMAP_ACK_PANTALLA] = TINT_ID_OK_PANTALLA;        /* RX = TX */
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.4_rx_tx_clash_refused");
+
+  /* S27.5 – IDs en zancadas de 32 (peor caso para un hash por módulo):
+   *         búsqueda correcta con una sonda acotada */
+  ids = CANMAP_DEFAULT;
+  for (uint32_t k = 0; k < CANMAP_RX_COUNT; k++) ids.id[k] = (uint16_t)(0x500u + 32u * k);
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), 0u, S, "27.5_strided_accepted");
+  hits = 0;
+  for (uint32_t k = 0; k < CANMAP_RX_COUNT; k++)
+  {
+    if (CanMap_RxKey(ids.id[k]) == k) hits++;
+  }
+  uint32_t misses = 0;
+  for (uint32_t id = 0; id <= 0x7FFu; id++)
+  {
+    if (CanMap_RxKey(id) != CANMAP_NONE) misses++;
+  }
+  CanMap_GetStats(&st);
+  ASSERT_EQUAL(hits, CANMAP_RX_COUNT, S, "27.5_lookup");
+  ASSERT_EQUAL(misses, CANMAP_RX_COUNT, S, "27.5_no_false_hit");
+  ASSERT_RANGE(st.max_probe, 0u, 1u, S, "27.5_probe_bound");
+
+  /* S27.7 – IDs ajenos al mapa: inversor del layout, XCP, UDS y FWU se
+   *         rechazan como un duplicado, con la clave en bad_key */
+  {
+    const inv_node_t *nd = &Inv_GetLayout()->node[0];
+    static const struct { uint8_t key; uint32_t id; } CLASH[] =
+    {
+      { CANMAP_S_FRENO,       XCP_CRO_ID  },
+      { CANMAP_T_MOTOR,       XCP_DTO_ID  },
+      { CANMAP_ACK_PRECARGA,  UDS_FUNC_ID },
+      { CANMAP_RTD_ALL,       UDS_RSP_ID  },
+      { CANMAP_I_ACTUAL,      FWU_RSP_ID  },
+    };
+    uint32_t refused = 0;
+    for (uint32_t i = 0; i < sizeof(CLASH) / sizeof(CLASH[0]); i++)
+    {
+      ids = CANMAP_DEFAULT;
+      ids.id[CLASH[i].key] = (uint16_t)CLASH[i].id;
+      if (CanMap_Init(&ids) != -1) continue;
+      CanMap_GetStats(&st);
+      if (st.bad_key == CLASH[i].key) refused++;
+    }
+    ASSERT_EQUAL(refused, (uint32_t)(sizeof(CLASH) / sizeof(CLASH[0])), S, "27.7_protocol_ids_refused");
+
+    ids = CANMAP_DEFAULT;
+    ids.id[CANMAP_S_FRENO] = (uint16_t)nd->fb_id;
+    ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.7_inverter_fb_refused");
+    ids.id[CANMAP_S_FRENO] = (uint16_t)nd->req_id;
+    ASSERT_EQUAL((uint32_t)CanMap_Init(&ids), (uint32_t)-1, S, "27.7_inverter_req_refused");
+    CanMap_GetStats(&st);
+    ASSERT_TRUE(st.bad_key == CANMAP_S_FRENO && st.from_table == 0u &&
+                CanMap_RxKey(TINT_ID_S_FRENO) == CANMAP_S_FRENO, S, "27.7_defaults_live");
+  }
+
+#ifdef SIL_BUILD
+  /* S27.6 – Desde la flash de calibración (fichero en SIL): cambio guardado
+   *         → arranque con el ID nuevo; duplicado guardado → por defecto */
+  remove(TINT_CANMAP_FILE);
+  Calib_SilSetFlashFile(TINT_CANMAP_FILE);
+  Calib_Init();
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x0A03u, 0x800u), (uint32_t)CALIB_ERR_RANGE, S, "27.6_param_range");
+  ASSERT_EQUAL((uint32_t)Calib_Set(0x0A03u, (float)0x121u), (uint32_t)CALIB_OK, S, "27.6_param_set");
+  Calib_Commit();
+  ASSERT_EQUAL((uint32_t)Calib_Save(), (uint32_t)CALIB_OK, S, "27.6_saved");
+  Calib_Init();                                             /* arranque */
+  ASSERT_EQUAL(Calib_Peek()->can.id[CANMAP_S1_ACELERACION], 0x121u, S, "27.6_from_flash");
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&Calib_Peek()->can), 0u, S, "27.6_map_accepted");
+  rx = canmap_feed(0x121u, TINT_ADC_S1_25PCT);
+  ASSERT_EQUAL(rx.s1_aceleracion, TINT_ADC_S1_25PCT, S, "27.6_parsed");
+
+  Calib_Set(0x0A04u, (float)0x121u);                        /* S2 = S1 */
+  Calib_Commit();
+  Calib_Save();
+  Calib_Init();
+  ASSERT_EQUAL((uint32_t)CanMap_Init(&Calib_Peek()->can), (uint32_t)-1, S, "27.6_dup_refused");
+  ASSERT_EQUAL(CanMap_RxKey(TINT_ID_S1_ACEL), (uint32_t)CANMAP_S1_ACELERACION, S, "27.6_defaults");
+
+  remove(TINT_CANMAP_FILE);
+  Calib_Init();
+  Control_Init();
+#endif
+
+  /* Restaurar: IDs del coche para las suites siguientes */
+  (void)CanMap_Init(NULL);
+  (void)TxSched_Init(NULL, 0u);
+
+  return (g_suite_errors == 0) ? 1u : 0u;
+}
+
 /* ============================================================================
    RUNNER PRINCIPAL – genera informe completo
    ========================================================================== */
@@ -1009,6 +2852,27 @@ test_result_t Test_IntegrationRunAll(void)
     { test_suite_full_pipeline,        "S8  Pipeline completo"         },
     { test_suite_concurrency,          "S9  Concurrencia FreeRTOS"     },
     { test_suite_stress_testing,       "S10 Estrés / límites"          },
+    { test_suite_ctrl_exec,            "S11 Ejecutivo control TIM16"   },
+    { test_suite_power_limit,          "S12 Limite potencia 80 kW"     },
+    { test_suite_thermal_derate,       "S13 Derating termico"          },
+    { test_suite_torque_slew,          "S14 Pendiente/jerk de par"     },
+    { test_suite_regen,                "S15 Frenada regenerativa"      },
+    { test_suite_launch,               "S16 Launch control"            },
+    { test_suite_traction,             "S17 Traction control"          },
+    { test_suite_imu,                  "S18 IMU BMI088 FIFO"           },
+    { test_suite_vehicle_state,        "S19 Vehicle state estimator"   },
+    { test_suite_inverters,            "S20 N inversores / vectoring"  },
+    { test_suite_ctrl_ctx,             "S21 Contextos de control"      },
+    { test_suite_calib,                "S22 Calibración"               },
+    { test_suite_freshness,            "S23 Frescura de señales"       },
+#if (INV_BACKEND == INV_BACKEND_BAMOCAR) || defined(INV_BACKEND_ALL)
+    { test_suite_bamocar,              "S24 Suscripción BAMOCAR"       },
+#endif
+#if (INV_BACKEND == INV_BACKEND_EPL) || defined(INV_BACKEND_ALL)
+    { test_suite_epl,                  "S25 Backend ePowerLabs"        },
+#endif
+    { test_suite_handshake,            "S26 Handshakes de arranque"    },
+    { test_suite_can_map,              "S27 Mapa de IDs CAN"           },
   };
 
   const uint32_t NUM_SUITES = sizeof(suites) / sizeof(suites[0]);
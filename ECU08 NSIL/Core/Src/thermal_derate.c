@@ -0,0 +1,141 @@
+#include "thermal_derate.h"
+#include <math.h>
+#include <string.h>
+
+/* Limits below follow the EMRAX 228 (120 degC winding) and BAMOCAR D3
+ * (IGBT / internal air shutdown) datasheets with ~10 degC of margin.
+ * k_i2 is per A^2 of phase current (inv_i_actual, peak), which is what the
+ * drives report; IGBT losses grow slower than I^2, hence its small k_i2. */
+const thermal_derate_cfg_t THERMAL_DERATE_CFG_DEFAULT =
+{
+  .ch =
+  {
+    [THERMAL_CH_MOTOR] =
+    {
+      .temp_c    = {  90.0f, 100.0f, 105.0f, 110.0f },
+      .limit_pct = { 100.0f,  70.0f,  40.0f,   0.0f },
+      .hyst_c    = 3.0f,
+      .k_i2      = 9.6e-6f,
+      .k_rpm     = 6.0e-6f,
+      .tau_s     = 300.0f,
+      .t_cool_c  = 40.0f,
+    },
+    [THERMAL_CH_IGBT] =
+    {
+      .temp_c    = {  70.0f,  80.0f,  85.0f,  90.0f },
+      .limit_pct = { 100.0f,  70.0f,  40.0f,   0.0f },
+      .hyst_c    = 3.0f,
+      .k_i2      = 1.3e-5f,
+      .k_rpm     = 0.0f,
+      .tau_s     = 20.0f,
+      .t_cool_c  = 40.0f,
+    },
+    [THERMAL_CH_AIR] =
+    {
+      .temp_c    = {  55.0f,  65.0f,  70.0f,  75.0f },
+      .limit_pct = { 100.0f,  80.0f,  50.0f,   0.0f },
+      .hyst_c    = 2.0f,
+      .tau_s     = 0.0f,   /* no model: measured only */
+    },
+  },
+  .horizon_s       = 30.0f,
+  .rate_down_pct_s = 50.0f,
+  .rate_up_pct_s   = 10.0f,
+};
+
+void ThermalDerate_Init(thermal_derate_t *td)
+{
+  if (!td) return;
+  memset(td, 0, sizeof(*td));
+  td->limit_pct = 100.0f;
+}
+
+float ThermalDerate_Curve(const thermal_ch_cfg_t *c, float temp_c)
+{
+  if (!c) return 100.0f;
+  if (temp_c <= c->temp_c[0]) return c->limit_pct[0];
+
+  for (uint32_t i = 1; i < THERMAL_CURVE_PTS; i++)
+  {
+    if (temp_c < c->temp_c[i])
+    {
+      float span = c->temp_c[i] - c->temp_c[i - 1];
+      float f = (span > 0.0f) ? (temp_c - c->temp_c[i - 1]) / span : 1.0f;
+      return c->limit_pct[i - 1] + f * (c->limit_pct[i] - c->limit_pct[i - 1]);
+    }
+  }
+  return c->limit_pct[THERMAL_CURVE_PTS - 1u];
+}
+
+float ThermalDerate_Predict(const thermal_ch_cfg_t *c, float temp_c,
+                            float i_a, float rpm, float horizon_s)
+{
+  if (!c || c->tau_s <= 0.0f || horizon_s <= 0.0f) return temp_c;
+  if (rpm < 0.0f) rpm = -rpm;
+
+  /* Steady state at the present load, then the first-order step response */
+  float t_ss = c->t_cool_c + c->tau_s * (c->k_i2 * i_a * i_a + c->k_rpm * rpm);
+  return t_ss + (temp_c - t_ss) * expf(-horizon_s / c->tau_s);
+}
+
+uint16_t ThermalDerate_Apply(thermal_derate_t *td, const thermal_derate_cfg_t *cfg,
+                             const app_inputs_t *in, uint16_t torque_pct, float dt_s)
+{
+  if (!td || !cfg || !in) return torque_pct;
+
+  const float temps[THERMAL_CH_COUNT] =
+  {
+    [THERMAL_CH_MOTOR] = (float)in->inv_motor_temp,
+    [THERMAL_CH_IGBT]  = (float)in->inv_igbt_temp,
+    [THERMAL_CH_AIR]   = (float)in->inv_air_temp,
+  };
+
+  float target = 100.0f;
+  td->limiting_ch = THERMAL_CH_COUNT;
+  for (uint32_t k = 0; k < THERMAL_CH_COUNT; k++)
+  {
+    const thermal_ch_cfg_t *c = &cfg->ch[k];
+
+    float t_pred = ThermalDerate_Predict(c, temps[k], (float)in->inv_i_actual,
+                                         (float)in->inv_rpm, cfg->horizon_s);
+    td->t_pred_c[k] = t_pred;
+
+    /* Only ever derate earlier than the measurement would, never later */
+    float x = (t_pred > temps[k]) ? t_pred : temps[k];
+
+    if (!td->primed || x > td->t_hyst_c[k]) td->t_hyst_c[k] = x;
+    else if (x < td->t_hyst_c[k] - c->hyst_c) td->t_hyst_c[k] = x + c->hyst_c;
+
+    td->ch_limit_pct[k] = ThermalDerate_Curve(c, td->t_hyst_c[k]);
+    if (td->ch_limit_pct[k] < target)
+    {
+      target = td->ch_limit_pct[k];
+      td->limiting_ch = (uint8_t)k;
+    }
+  }
+
+  if (!td->primed)
+  {
+    td->limit_pct = target;
+    td->primed = 1;
+  }
+  else if (target < td->limit_pct)
+  {
+    float step = cfg->rate_down_pct_s * dt_s;
+    td->limit_pct = (td->limit_pct - target > step) ? (td->limit_pct - step) : target;
+  }
+  else
+  {
+    float step = cfg->rate_up_pct_s * dt_s;
+    td->limit_pct = (target - td->limit_pct > step) ? (td->limit_pct + step) : target;
+  }
+
+  if ((float)torque_pct <= td->limit_pct)
+  {
+    td->active = 0;
+    return torque_pct;
+  }
+
+  td->active = 1;
+  return (uint16_t)td->limit_pct;   /* floor: stay below */
+}
@@ -129,7 +129,8 @@ void MX_TIM16_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN TIM16_Init 2 */
-
+  /* Prescaler/period are reprogrammed by CtrlExec_Start() (1 MHz count,
+   * ARR = control period in us); the values above are CubeMX defaults. */
   /* USER CODE END TIM16_Init 2 */
 
 }
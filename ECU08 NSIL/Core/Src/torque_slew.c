@@ -0,0 +1,58 @@
+#include "torque_slew.h"
+#include <string.h>
+
+/* 0 → 100 % in ~0.28 s (50 ms jerk onset), 100 → 0 % in ~0.16 s */
+const torque_slew_cfg_t TORQUE_SLEW_CFG_DEFAULT =
+{
+  .rise_pct_s  = 400.0f,
+  .fall_pct_s  = 1000.0f,
+  .jerk_pct_s2 = 8000.0f,
+};
+
+void TorqueSlew_Init(torque_slew_t *ts)
+{
+  if (!ts) return;
+  memset(ts, 0, sizeof(*ts));
+}
+
+void TorqueSlew_Track(torque_slew_t *ts, uint16_t pct)
+{
+  if (!ts) return;
+  ts->value_pct = (float)pct;
+  ts->rate_pct_s = 0.0f;
+}
+
+uint16_t TorqueSlew_Apply(torque_slew_t *ts, const torque_slew_cfg_t *cfg,
+                          uint16_t target_pct, uint8_t cut, float dt_s)
+{
+  if (!ts || !cfg) return target_pct;
+
+  if (cut || dt_s <= 0.0f)
+  {
+    ts->value_pct = cut ? 0.0f : (float)target_pct;
+    ts->rate_pct_s = 0.0f;
+    return cut ? 0u : target_pct;
+  }
+
+  /* Rate that lands exactly on the target this cycle, within rise/fall */
+  float v_des = ((float)target_pct - ts->value_pct) / dt_s;
+  if (v_des >  cfg->rise_pct_s) v_des =  cfg->rise_pct_s;
+  if (v_des < -cfg->fall_pct_s) v_des = -cfg->fall_pct_s;
+
+  /* Reversal: restart from zero slope */
+  float rate = ts->rate_pct_s;
+  if ((rate > 0.0f && v_des < 0.0f) || (rate < 0.0f && v_des > 0.0f)) rate = 0.0f;
+
+  /* Jerk limit only while the slope grows; slowing down is immediate */
+  float dv = cfg->jerk_pct_s2 * dt_s;
+  if (v_des > 0.0f && v_des > rate + dv)      rate += dv;
+  else if (v_des < 0.0f && v_des < rate - dv) rate -= dv;
+  else                                        rate = v_des;
+
+  ts->rate_pct_s = rate;
+  ts->value_pct += rate * dt_s;
+  if (ts->value_pct < 0.0f)   ts->value_pct = 0.0f;
+  if (ts->value_pct > 100.0f) ts->value_pct = 100.0f;
+
+  return (uint16_t)(ts->value_pct + 0.5f);
+}
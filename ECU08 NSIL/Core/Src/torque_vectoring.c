@@ -0,0 +1,97 @@
+#include "torque_vectoring.h"
+#include <string.h>
+
+const torque_vectoring_cfg_t TORQUE_VECTORING_CFG_DEFAULT =
+{
+  .k_yaw_pct = 40.0f,       /* 0.25 rad/s error → 10 % per drive */
+  .dmax_pct  = 25.0f,
+  .v_min_mps = 3.0f,
+};
+
+void TorqueVec_Init(torque_vectoring_t *tv)
+{
+  if (!tv) return;
+  memset(tv, 0, sizeof(*tv));
+}
+
+static float fabs_f(float x)
+{
+  return (x < 0.0f) ? -x : x;
+}
+
+static int16_t round_pct(float x)
+{
+  if (x > 100.0f)  x = 100.0f;
+  if (x < -100.0f) x = -100.0f;
+  return (int16_t)((x >= 0.0f) ? (x + 0.5f) : (x - 0.5f));
+}
+
+void TorqueVec_Allocate(torque_vectoring_t *tv, const torque_vectoring_cfg_t *cfg,
+                        const inv_layout_t *layout, uint8_t avail_mask,
+                        int16_t total_pct, const vehicle_state_t *vs,
+                        int16_t motor_pct[INV_MAX])
+{
+  if (!motor_pct) return;
+  memset(motor_pct, 0, INV_MAX * sizeof(motor_pct[0]));
+  if (!tv || !cfg || !layout || layout->count == 0u || layout->count > INV_MAX) return;
+
+  /* Available drives per axle, and per side (both sides = vectoring) */
+  uint8_t n_axle[2] = { 0u, 0u }, left[2] = { 0u, 0u }, right[2] = { 0u, 0u };
+  avail_mask &= (uint8_t)((1u << layout->count) - 1u);
+  for (uint8_t k = 0; k < layout->count; k++)
+  {
+    if (!(avail_mask & (1u << k))) continue;
+    const inv_node_t *nd = &layout->node[k];
+    uint8_t a = (nd->axle == INV_AXLE_FRONT) ? 0u : 1u;
+    n_axle[a]++;
+    if (nd->side < 0) left[a] = 1u;
+    if (nd->side > 0) right[a] = 1u;
+  }
+  tv->avail_mask = avail_mask;
+  tv->d_pct = 0.0f;
+
+  float share[2] = { layout->front_share, 1.0f - layout->front_share };
+  if (n_axle[0] == 0u) { share[0] = 0.0f; share[1] = 1.0f; }
+  if (n_axle[1] == 0u) { share[1] = 0.0f; share[0] = (n_axle[0] != 0u) ? 1.0f : 0.0f; }
+
+  /* Base split, in percent of one drive */
+  float base[INV_MAX] = { 0.0f };
+  for (uint8_t k = 0; k < layout->count; k++)
+  {
+    if (!(avail_mask & (1u << k))) continue;
+    uint8_t a = (layout->node[k].axle == INV_AXLE_FRONT) ? 0u : 1u;
+    base[k] = (float)total_pct * share[a] * (float)layout->count / (float)n_axle[a];
+    if (base[k] > 100.0f)  base[k] = 100.0f;
+    if (base[k] < -100.0f) base[k] = -100.0f;
+  }
+
+  /* Yaw-moment offset, bounded by every affected drive's headroom */
+  float d = 0.0f;
+  if (vs && total_pct != 0 && vs->v_mps >= cfg->v_min_mps)
+  {
+    d = -cfg->k_yaw_pct * vs->yaw_err_rad_s;
+    float lim = cfg->dmax_pct;
+    for (uint8_t k = 0; k < layout->count; k++)
+    {
+      if (!(avail_mask & (1u << k)) || layout->node[k].side == 0) continue;
+      uint8_t a = (layout->node[k].axle == INV_AXLE_FRONT) ? 0u : 1u;
+      if (!(left[a] && right[a])) continue;
+      float b = fabs_f(base[k]);
+      if (b < lim) lim = b;                   /* no sign reversal */
+      if (100.0f - b < lim) lim = 100.0f - b; /* no saturation    */
+    }
+    if (d > lim)  d = lim;
+    if (d < -lim) d = -lim;
+    tv->d_pct = d;
+  }
+
+  for (uint8_t k = 0; k < layout->count; k++)
+  {
+    if (!(avail_mask & (1u << k))) continue;
+    const inv_node_t *nd = &layout->node[k];
+    uint8_t a = (nd->axle == INV_AXLE_FRONT) ? 0u : 1u;
+    float x = base[k];
+    if (nd->side != 0 && left[a] && right[a]) x += (float)nd->side * d;
+    motor_pct[k] = round_pct(x);
+  }
+}
@@ -0,0 +1,65 @@
+#include "traction.h"
+#include <string.h>
+
+#define RPM_TO_RAD_S   0.10471976f   /* 2*pi/60 */
+
+const traction_cfg_t TRACTION_CFG_DEFAULT =
+{
+  .slip_target   = 0.10f,
+  .kp_pct        = 300.0f,   /* 10 % over target → 30 % cut */
+  .ki_pct_s      = 1500.0f,
+  .recover_pct_s = 150.0f,
+  .v_min_mps     = 3.0f,
+  .gear          = 3.5f,
+  .r_wheel_m     = 0.23f,
+};
+
+void Traction_Init(traction_t *tc)
+{
+  if (!tc) return;
+  memset(tc, 0, sizeof(*tc));
+  tc->limit_pct = 100.0f;
+}
+
+uint16_t Traction_Apply(traction_t *tc, const traction_cfg_t *cfg, const app_inputs_t *in,
+                        uint16_t torque_pct, float dt_s)
+{
+  if (!tc || !cfg || !in) return torque_pct;
+
+  if (!in->wheel_ok)
+  {
+    Traction_Init(tc);
+    return torque_pct;
+  }
+
+  const float v_ref = ((float)in->wheel_fl_cmps + (float)in->wheel_fr_cmps) * 0.005f;
+  const float v_drv = (float)in->inv_rpm * RPM_TO_RAD_S / cfg->gear * cfg->r_wheel_m;
+  const float den   = (v_ref > cfg->v_min_mps) ? v_ref : cfg->v_min_mps;
+
+  tc->slip = (v_drv - v_ref) / den;
+  const float err = tc->slip - cfg->slip_target;
+
+  if (err > 0.0f)
+  {
+    tc->i_pct += cfg->ki_pct_s * err * dt_s;
+    if (tc->i_pct > 100.0f) tc->i_pct = 100.0f;
+  }
+  else
+  {
+    tc->i_pct -= cfg->recover_pct_s * dt_s;
+    if (tc->i_pct < 0.0f) tc->i_pct = 0.0f;
+  }
+
+  float lim = 100.0f - tc->i_pct;
+  if (err > 0.0f) lim -= cfg->kp_pct * err;
+  if (lim < 0.0f) lim = 0.0f;
+  tc->limit_pct = lim;
+
+  if ((float)torque_pct <= lim)
+  {
+    tc->active = 0;
+    return torque_pct;
+  }
+  tc->active = 1;
+  return (uint16_t)lim;
+}
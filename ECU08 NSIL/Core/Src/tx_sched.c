@@ -0,0 +1,216 @@
+#include "tx_sched.h"
+#include "inverters.h"
+#include <string.h>
+
+static void pack_rtd(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d);
+static void pack_torque(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d);
+static void pack_inv(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d);
+
+/* Frames the VCU originates on the telemetry / dashboard bus (IDs from the
+ * CAN ID map).
+ * Inverter mirrors: one little-endian int16 per drive, layout order. */
+const txs_entry_t TXS_TABLE[] =
+{
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_RTD_ALL),      1u, 0u,              100u, pack_rtd    },
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_TORQUE_TOTAL), 2u, 0u,               10u, pack_torque },
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_T_MOTOR),      8u, INV_FB_T_MOTOR,  200u, pack_inv    },  /* degC */
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_T_IGBT),       8u, INV_FB_T_IGBT,   200u, pack_inv    },
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_T_AIR),        8u, INV_FB_T_AIR,    200u, pack_inv    },
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_N_ACTUAL),     8u, INV_FB_RPM,       20u, pack_inv    },  /* rpm  */
+  { CAN_BUS_DASH, CANMAP_REF(CANMAP_I_ACTUAL),     8u, INV_FB_I_ACTUAL,  20u, pack_inv    },  /* A    */
+};
+const uint32_t TXS_TABLE_COUNT = (uint32_t)(sizeof(TXS_TABLE) / sizeof(TXS_TABLE[0]));
+
+static txs_entry_t s_tab[TXS_MAX];
+static uint32_t    s_n;
+static uint32_t    s_phase[TXS_MAX];
+static uint32_t    s_next[TXS_MAX];
+static uint8_t     s_started;
+static txs_stats_t s_stats;
+
+static void put16(uint8_t *d, int16_t v)
+{
+  d[0] = (uint8_t)((uint16_t)v & 0xFFu);
+  d[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+static void pack_rtd(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d)
+{
+  (void)e; (void)in; (void)out;
+  d[0] = Control_IsRunning();
+}
+
+static void pack_torque(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d)
+{
+  (void)e; (void)in;
+  put16(d, out ? out->torque_pct : 0);
+}
+
+static void pack_inv(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d)
+{
+  (void)out;
+  const uint8_t n = Inv_GetLayout()->count;
+  for (uint8_t k = 0; k < n && 2u * k + 1u < e->dlc; k++)
+  {
+    put16(&d[2u * k], in ? Inv_FbGet(&in->inv[k], (inv_fb_field_t)e->arg) : 0);
+  }
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+  while (b != 0u)
+  {
+    const uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/* Frames released in slot s by the first n entries of order[] */
+static uint32_t load_at(uint32_t s, const uint8_t *order, uint32_t n)
+{
+  uint32_t l = 0;
+  for (uint32_t j = 0; j < n; j++)
+  {
+    const uint32_t i = order[j];
+    if (s % s_tab[i].period_ms == s_phase[i]) l++;
+  }
+  return l;
+}
+
+static int entry_ok(const txs_entry_t *e)
+{
+  if (e->bus < CAN_BUS_INV || e->bus > CAN_BUS_DASH) return 0;
+  if (CanMap_Resolve(e->id) > 0x7FFu || e->dlc > CAN_CLASSIC_DLEN || !e->pack) return 0;
+  return e->period_ms != 0u && e->period_ms <= TXS_HYPER_MAX;
+}
+
+int TxSched_Init(const txs_entry_t *tab, uint32_t n)
+{
+  if (!tab)
+  {
+    tab = TXS_TABLE;
+    n = TXS_TABLE_COUNT;
+  }
+  if (n > TXS_MAX) return -1;
+
+  uint32_t hyper = 1u;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (!entry_ok(&tab[i])) return -1;
+    for (uint32_t j = 0; j < i; j++)
+    {
+      if (tab[j].bus == tab[i].bus && CanMap_Resolve(tab[j].id) == CanMap_Resolve(tab[i].id)) return -1;
+    }
+    hyper = hyper / gcd(hyper, tab[i].period_ms) * tab[i].period_ms;
+    if (hyper > TXS_HYPER_MAX) return -1;
+  }
+
+  memcpy(s_tab, tab, n * sizeof(txs_entry_t));
+  for (uint32_t i = 0; i < n; i++) s_tab[i].id = CanMap_Resolve(s_tab[i].id);
+  s_n = n;
+  s_started = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats.hyper_ms = hyper;
+
+  /* Placement order: shortest period first, table order among equals */
+  uint8_t order[TXS_MAX];
+  for (uint32_t i = 0; i < n; i++)
+  {
+    uint32_t k = i;
+    while (k > 0u && s_tab[order[k - 1u]].period_ms > s_tab[i].period_ms)
+    {
+      order[k] = order[k - 1u];
+      k--;
+    }
+    order[k] = (uint8_t)i;
+  }
+
+  /* Each frame on the phase whose slots the frames already placed load
+   * least: worst slot first, then total, then the earliest phase */
+  for (uint32_t j = 0; j < n; j++)
+  {
+    const uint32_t i = order[j];
+    const uint32_t p = s_tab[i].period_ms;
+    uint32_t best = 0, best_max = UINT32_MAX, best_sum = UINT32_MAX;
+    for (uint32_t ph = 0; ph < p; ph++)
+    {
+      uint32_t mx = 0, sum = 0;
+      for (uint32_t s = ph; s < hyper; s += p)
+      {
+        const uint32_t l = load_at(s, order, j);
+        sum += l;
+        if (l > mx) mx = l;
+      }
+      if (mx < best_max || (mx == best_max && sum < best_sum))
+      {
+        best = ph;
+        best_max = mx;
+        best_sum = sum;
+      }
+    }
+    s_phase[i] = best;
+  }
+
+  for (uint32_t s = 0; s < hyper; s++)
+  {
+    const uint32_t l = load_at(s, order, n);
+    if (l > s_stats.max_load) s_stats.max_load = l;
+  }
+  return 0;
+}
+
+uint32_t TxSched_Tick(uint32_t now_ms, const app_inputs_t *in, const control_out_t *out,
+                      can_msg_t *msgs, uint32_t room)
+{
+  if (!s_started)
+  {
+    for (uint32_t i = 0; i < s_n; i++) s_next[i] = now_ms + s_phase[i];
+    s_started = 1u;
+  }
+
+  uint32_t c = 0;
+  for (uint32_t i = 0; i < s_n; i++)
+  {
+    if ((int32_t)(now_ms - s_next[i]) < 0) continue;
+    if (c >= room || !msgs) break;
+
+    const txs_entry_t *e = &s_tab[i];
+    can_msg_t *m = &msgs[c++];
+    memset(m, 0, sizeof(*m));
+    m->bus = e->bus;
+    m->id  = e->id;
+    m->dlc = e->dlc;
+    e->pack(e, in, out, m->data);
+    s_stats.sent++;
+    if (now_ms != s_next[i]) s_stats.late++;
+
+    /* Next release on the same phase; periods lost in a gap are dropped */
+    const uint32_t behind = (now_ms - s_next[i]) / e->period_ms;
+    s_stats.skipped += behind;
+    s_next[i] += (behind + 1u) * e->period_ms;
+  }
+  return c;
+}
+
+uint32_t TxSched_Phase(uint32_t i)
+{
+  return (i < s_n) ? s_phase[i] : 0u;
+}
+
+uint32_t TxSched_SlotLoad(uint32_t slot)
+{
+  uint32_t l = 0;
+  for (uint32_t i = 0; i < s_n; i++)
+  {
+    if (slot % s_tab[i].period_ms == s_phase[i]) l++;
+  }
+  return l;
+}
+
+void TxSched_GetStats(txs_stats_t *out)
+{
+  if (!out) return;
+  *out = s_stats;
+}
@@ -0,0 +1,592 @@
+#include "uds.h"
+#include "calib.h"
+#include "control.h"
+#include "ctrl_exec.h"
+#include "fwu.h"
+#include "freshness.h"
+#include "handshake.h"
+#include <stddef.h>
+#include <string.h>
+
+#define SID_DSC     0x10u
+#define SID_CDTCI   0x14u
+#define SID_RDTCI   0x19u
+#define SID_RDBI    0x22u
+#define SID_RC      0x31u
+#define SID_TP      0x3Eu
+#define SID_NEG     0x7Fu
+#define SUPPRESS    0x80u   /* suppressPosRspMsgIndicationBit */
+
+#define SESSION_DEFAULT      1u
+#define SESSION_PROGRAMMING  2u   /* answered, then reset into the bootloader */
+#define SESSION_EXTENDED     3u
+
+#define BOOT_DELAY_US     20000u  /* let the response leave the FIFO first */
+
+#define D(did_, f_, n_) \
+  { (did_), (uint16_t)offsetof(app_inputs_t, f_), \
+    (uint8_t)(sizeof(((app_inputs_t *)0)->f_) / (n_)), (n_) }
+
+const uds_did_t UDS_DIDS[] =
+{
+  /* Driver inputs */
+  D(0x0100u, s1_aceleracion,     1u),
+  D(0x0101u, s2_aceleracion,     1u),
+  D(0x0102u, s_freno,            1u),
+  D(0x0103u, boton_arranque,     1u),
+  D(0x0104u, dash_input_1,       1u),
+  D(0x0105u, dash_input_2,       1u),
+
+  /* Inverter feedback (aggregate) */
+  D(0x0110u, inv_state,          1u),
+  D(0x0111u, inv_dc_bus_voltage, 1u),
+  D(0x0112u, inv_motor_temp,     1u),
+  D(0x0113u, inv_igbt_temp,      1u),
+  D(0x0114u, inv_air_temp,       1u),
+  D(0x0115u, inv_rpm,            1u),
+  D(0x0116u, inv_i_actual,       1u),
+
+  /* Wheel speeds */
+  D(0x0120u, wheel_fl_cmps,      1u),
+  D(0x0121u, wheel_fr_cmps,      1u),
+  D(0x0122u, wheel_ok,           1u),
+
+  /* IMU */
+  D(0x0130u, imu_acc_mg,         3u),
+  D(0x0131u, imu_gyr_ddps,       3u),
+  D(0x0132u, imu_t_us,           1u),
+  D(0x0133u, imu_ok,             1u),
+
+  /* Battery, safety flags */
+  D(0x0140u, v_celda_min,        1u),
+  D(0x0141u, ok_precarga,        1u),
+  D(0x0150u, flag_EV_2_3,        1u),
+  D(0x0151u, flag_T11_8_9,       1u),
+  D(0x0152u, torque_total,       1u),
+};
+
+const uint32_t UDS_DID_COUNT = sizeof(UDS_DIDS) / sizeof(UDS_DIDS[0]);
+
+/* ---------------------------------------------------------------------- */
+/* Fault memory                                                           */
+
+static uint32_t s_overruns_seen, s_save_errors_seen;
+
+static uint8_t dtc_ev23(const app_inputs_t *in)
+{
+  (void)in;
+  return Control_DefaultCtx()->lat_ev23;
+}
+
+static uint8_t dtc_inv_lost(const app_inputs_t *in)
+{
+  (void)in;
+  const uint8_t n = Inv_GetLayout()->count;
+  for (uint8_t k = 0; k < n; k++)
+  {
+    if (Control_GetInverterLink(k) == (uint8_t)INV_LINK_LOST) return 1u;
+  }
+  return 0u;
+}
+
+static uint8_t dtc_derate(const app_inputs_t *in)
+{
+  (void)in;
+  return Control_GetThermalLimitPct() < 100.0f;
+}
+
+static uint8_t dtc_overrun(const app_inputs_t *in)
+{
+  (void)in;
+  ctrl_exec_stats_t st;
+  CtrlExec_GetStats(&st);
+  const uint8_t fail = st.overruns != s_overruns_seen;
+  s_overruns_seen = st.overruns;
+  return fail;
+}
+
+static uint8_t dtc_calib_flash(const app_inputs_t *in)
+{
+  (void)in;
+  calib_stats_t st;
+  Calib_GetStats(&st);
+  const uint8_t fail = st.save_errors != s_save_errors_seen;
+  s_save_errors_seen = st.save_errors;
+  return fail;
+}
+
+static uint8_t dtc_sig_timeout(const app_inputs_t *in)
+{
+  (void)in;
+  return (Control_GetStaleSignals() & FRESH_CRITICAL) ? 1u : 0u;
+}
+
+static uint8_t dtc_handshake(const app_inputs_t *in)
+{
+  (void)in;
+  return (Hs_FailedMask(Control_GetHandshake()) != 0u) ? 1u : 0u;
+}
+
+static uint8_t (*const DTC_TEST[])(const app_inputs_t *in) =
+{
+  dtc_ev23,
+  dtc_inv_lost,
+  dtc_derate,
+  dtc_overrun,
+  dtc_calib_flash,
+  dtc_sig_timeout,
+  dtc_handshake,
+};
+
+const uds_dtc_t UDS_DTCS[] =
+{
+  { 0x229900u, "EV2.3 brake + throttle latch"      },   /* P2299 */
+  { 0xC29300u, "inverter link lost"                },   /* U0293 */
+  { 0x0A2F00u, "thermal derating active"           },   /* P0A2F */
+  { 0x060600u, "control cycle overrun"             },   /* P0606 */
+  { 0x060200u, "calibration flash write failed"    },   /* P0602 */
+  { 0xD00100u, "pedal / brake signal timeout"      },   /* U1001 */
+  { 0xD00200u, "ECU boot handshake failed"         },   /* U1002 */
+};
+
+const uint32_t UDS_DTC_COUNT = sizeof(UDS_DTCS) / sizeof(UDS_DTCS[0]);
+
+static uint8_t s_dtc_status[sizeof(UDS_DTCS) / sizeof(UDS_DTCS[0])];
+static uint8_t s_dtc_fails[sizeof(UDS_DTCS) / sizeof(UDS_DTCS[0])];
+
+static void dtc_clear(void)
+{
+  for (uint32_t i = 0; i < UDS_DTC_COUNT; i++)
+  {
+    s_dtc_status[i] = UDS_DTC_NOT_COMPLETED_SINCE_CLEAR | UDS_DTC_NOT_COMPLETED_THIS_CYCLE;
+    s_dtc_fails[i]  = 0u;
+  }
+}
+
+void Uds_Monitor(const app_inputs_t *in)
+{
+  for (uint32_t i = 0; i < UDS_DTC_COUNT; i++)
+  {
+    uint8_t st = (uint8_t)(s_dtc_status[i] &
+                 ~(UDS_DTC_NOT_COMPLETED_SINCE_CLEAR | UDS_DTC_NOT_COMPLETED_THIS_CYCLE));
+    if (DTC_TEST[i](in))
+    {
+      st |= UDS_DTC_TEST_FAILED | UDS_DTC_FAILED_THIS_CYCLE |
+            UDS_DTC_PENDING | UDS_DTC_FAILED_SINCE_CLEAR;
+      if (s_dtc_fails[i] < UDS_DTC_CONFIRM) s_dtc_fails[i]++;
+      if (s_dtc_fails[i] >= UDS_DTC_CONFIRM) st |= UDS_DTC_CONFIRMED;
+    }
+    else
+    {
+      st &= (uint8_t)~UDS_DTC_TEST_FAILED;
+      s_dtc_fails[i] = 0u;
+    }
+    s_dtc_status[i] = st;
+  }
+}
+
+uint8_t Uds_GetDtcStatus(uint32_t index)
+{
+  return (index < UDS_DTC_COUNT) ? s_dtc_status[index] : 0u;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Server state                                                           */
+
+static isotp_link_t s_link;
+static uint8_t      s_use_queue;      /* default sink: budget from canTxQueue */
+static uint8_t      s_session;
+static uint32_t     s_last_req_us;
+static uint8_t     *s_func;           /* functional request (single frame) */
+static uint16_t     s_func_len;
+static uds_stats_t  s_stats;
+static uint8_t      s_boot_pending;
+static uint32_t     s_boot_us;
+
+/* Routine results */
+static uint8_t      s_save_started;
+static uint32_t     s_save_mark, s_save_err_mark;
+static uint8_t      s_apps_done, s_apps_result, s_apps_fail_pct;
+
+static int tx_queue(const can_msg_t *m)
+{
+  can_qitem_t q;
+  CAN_Pack(m, &q);
+  return (canTxQueueHandle && osMessageQueuePut(canTxQueueHandle, &q, 0u, 0u) == osOK) ? 0 : -1;
+}
+
+static void wr16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static void wr24(uint8_t *p, uint32_t v) { p[0] = (uint8_t)(v >> 16); p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)v; }
+
+/* ---------------------------------------------------------------------- */
+/* Services: return the response length, 0 for no response, -NRC         */
+
+static int svc_session(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n != 2u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  const uint8_t sub = q[1] & 0x7Fu;
+  if (sub != SESSION_DEFAULT && sub != SESSION_EXTENDED && sub != SESSION_PROGRAMMING)
+  {
+    return -(int)UDS_NRC_SUBFUNCTION_NOT_SUPPORTED;
+  }
+  if (sub == SESSION_PROGRAMMING)
+  {
+    /* Reflash only from the extended session and with the car stopped */
+    if (s_session != SESSION_EXTENDED || Control_IsRunning()) return -(int)UDS_NRC_CONDITIONS_NOT_CORRECT;
+    s_boot_pending = 1u;
+    s_boot_us = 0u;
+  }
+  s_session = sub;
+  if (q[1] & SUPPRESS) return 0;
+  r[0] = SID_DSC + 0x40u;
+  r[1] = sub;
+  wr16(&r[2], UDS_P2_MS);
+  wr16(&r[4], UDS_P2_EXT_MS / 10u);
+  return 6;
+}
+
+static int svc_tester_present(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n != 2u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  if ((q[1] & 0x7Fu) != 0u) return -(int)UDS_NRC_SUBFUNCTION_NOT_SUPPORTED;
+  if (q[1] & SUPPRESS) return 0;
+  r[0] = SID_TP + 0x40u;
+  r[1] = 0u;
+  return 2;
+}
+
+static const uds_did_t *find_did(uint16_t did)
+{
+  for (uint32_t i = 0; i < UDS_DID_COUNT; i++)
+  {
+    if (UDS_DIDS[i].did == did) return &UDS_DIDS[i];
+  }
+  return NULL;
+}
+
+static int svc_rdbi(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n < 3u || (n & 1u) == 0u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+
+  app_inputs_t in;
+  AppState_Snapshot(&in);
+  const uint8_t *src = (const uint8_t *)&in;
+
+  uint32_t pos = 0;
+  r[pos++] = SID_RDBI + 0x40u;
+  for (uint32_t k = 1; k + 1u < n; k += 2u)
+  {
+    const uint16_t did = (uint16_t)((q[k] << 8) | q[k + 1u]);
+    const uds_did_t *d = find_did(did);
+    uint32_t len;
+    if (d)                      len = (uint32_t)d->size * d->count;
+    else if (did == UDS_DID_SNAPSHOT) len = sizeof(app_inputs_t);
+    else if (did == UDS_DID_PATTERN)  len = UDS_PATTERN_LEN;
+    else return -(int)UDS_NRC_REQUEST_OUT_OF_RANGE;
+    if (pos + 2u + len > ISOTP_MAX_PAYLOAD) return -(int)UDS_NRC_RESPONSE_TOO_LONG;
+
+    wr16(&r[pos], did);
+    pos += 2u;
+    if (d)
+    {
+      /* Elements big endian, as UDS data */
+      const uint8_t *f = src + d->offset;
+      for (uint32_t e = 0; e < d->count; e++, f += d->size)
+      {
+        for (uint32_t b = 0; b < d->size; b++) r[pos + b] = f[d->size - 1u - b];
+        pos += d->size;
+      }
+    }
+    else if (did == UDS_DID_SNAPSHOT)
+    {
+      memcpy(&r[pos], src, len);
+      pos += len;
+    }
+    else
+    {
+      for (uint32_t i = 0; i < len; i++) r[pos + i] = (uint8_t)(i ^ (i >> 8));
+      pos += len;
+    }
+  }
+  return (int)pos;
+}
+
+static int svc_rdtci(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n < 2u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  const uint8_t sub = q[1];
+  if (sub != 0x01u && sub != 0x02u && sub != 0x0Au) return -(int)UDS_NRC_SUBFUNCTION_NOT_SUPPORTED;
+  if (n != ((sub == 0x0Au) ? 2u : 3u)) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  const uint8_t mask = (sub == 0x0Au) ? 0xFFu : q[2];
+
+  r[0] = SID_RDTCI + 0x40u;
+  r[1] = sub;
+  r[2] = UDS_DTC_AVAILABILITY;
+  if (sub == 0x01u)
+  {
+    uint16_t cnt = 0;
+    for (uint32_t i = 0; i < UDS_DTC_COUNT; i++) cnt += (s_dtc_status[i] & mask) != 0u;
+    r[3] = 0x01u;                                 /* ISO 14229-1 DTC format */
+    wr16(&r[4], cnt);
+    return 6;
+  }
+
+  uint32_t pos = 3;
+  for (uint32_t i = 0; i < UDS_DTC_COUNT; i++)
+  {
+    if (sub == 0x02u && (s_dtc_status[i] & mask) == 0u) continue;
+    wr24(&r[pos], UDS_DTCS[i].code);
+    r[pos + 3u] = s_dtc_status[i];
+    pos += 4u;
+  }
+  return (int)pos;
+}
+
+static int svc_clear_dtc(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n != 4u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  if (q[1] != 0xFFu || q[2] != 0xFFu || q[3] != 0xFFu) return -(int)UDS_NRC_REQUEST_OUT_OF_RANGE;
+  dtc_clear();
+  r[0] = SID_CDTCI + 0x40u;
+  return 1;
+}
+
+/* Pedal map self-test on a scratch context with the live calibration:
+ * both sensors swept together from rest to full travel must give 0 at
+ * rest, a non-decreasing torque and 100 % at full travel. */
+static void apps_self_test(void)
+{
+  static ctrl_ctx_t ctx;
+  Control_CtxInit(&ctx, 0u);
+  Control_CtxSetAppsCal(&ctx, &Control_DefaultCtx()->apps);
+
+  app_inputs_t in;
+  memset(&in, 0, sizeof(in));
+  uint16_t prev = 0;
+  s_apps_result = 0u;
+  s_apps_fail_pct = 0u;
+  for (uint32_t p = 0; p <= 100u; p++)
+  {
+    const float s1 = ctx.apps.s1_offset_adc + (float)p * ctx.apps.s1_adc_per_pct;
+    const float s2 = ctx.apps.s2_offset_adc + (float)p * ctx.apps.s2_adc_per_pct;
+    in.s1_aceleracion = (uint16_t)((s1 > 4095.0f) ? 4095.0f : s1);
+    in.s2_aceleracion = (uint16_t)((s2 > 4095.0f) ? 4095.0f : s2);
+    uint8_t ev = 0;
+    const uint16_t tq = Control_ComputeTorqueCtx(&ctx, &in, &ev, NULL);
+    const int bad = (p == 0u && tq != 0u) || tq < prev || (p == 100u && tq != 100u) || ev;
+    if (bad)
+    {
+      s_apps_result = 1u;
+      s_apps_fail_pct = (uint8_t)p;
+      break;
+    }
+    prev = tq;
+  }
+  s_apps_done = 1u;
+}
+
+static int svc_routine(const uint8_t *q, uint16_t n, uint8_t *r)
+{
+  if (n < 4u) return -(int)UDS_NRC_INCORRECT_LENGTH;
+  const uint8_t sub = q[1] & 0x7Fu;
+  const uint16_t rid = (uint16_t)((q[2] << 8) | q[3]);
+  if (sub < 1u || sub > 3u) return -(int)UDS_NRC_SUBFUNCTION_NOT_SUPPORTED;
+  if (rid != UDS_RID_CALIB_SAVE && rid != UDS_RID_APPS_TEST) return -(int)UDS_NRC_REQUEST_OUT_OF_RANGE;
+  if (s_session != SESSION_EXTENDED) return -(int)UDS_NRC_NOT_IN_ACTIVE_SESSION;
+  if (sub == 2u) return -(int)UDS_NRC_SUBFUNCTION_NOT_SUPPORTED;   /* run to completion */
+
+  r[0] = SID_RC + 0x40u;
+  r[1] = sub;
+  wr16(&r[2], rid);
+  r[4] = 0x01u;                                   /* routine info */
+
+  if (rid == UDS_RID_CALIB_SAVE)
+  {
+    calib_stats_t cs;
+    Calib_GetStats(&cs);
+    if (sub == 1u)
+    {
+      /* The sector erase stalls flash reads: never while driving */
+      if (Control_IsRunning()) return -(int)UDS_NRC_CONDITIONS_NOT_CORRECT;
+      s_save_mark     = cs.saves + cs.save_errors;
+      s_save_err_mark = cs.save_errors;
+      s_save_started  = 1u;
+      Calib_RequestSave();
+      return 5;
+    }
+    if (!s_save_started) return -(int)UDS_NRC_REQUEST_SEQUENCE_ERROR;
+    /* 0 done, 1 in progress, 2 failed */
+    r[5] = (cs.saves + cs.save_errors == s_save_mark) ? 1u
+         : (cs.save_errors != s_save_err_mark)        ? 2u : 0u;
+    return 6;
+  }
+
+  if (sub == 1u) apps_self_test();
+  else if (!s_apps_done) return -(int)UDS_NRC_REQUEST_SEQUENCE_ERROR;
+  r[5] = s_apps_result;                           /* 0 pass, 1 fail */
+  r[6] = s_apps_fail_pct;
+  return 7;
+}
+
+/* One request → response in a pool buffer (NULL: no response) */
+static uint8_t *process(const uint8_t *q, uint16_t n, uint8_t functional, uint16_t *rlen)
+{
+  uint8_t *r = Isotp_BufAlloc();
+  if (!r) return NULL;
+  s_stats.requests++;
+
+  int len;
+  switch (q[0])
+  {
+    case SID_DSC:   len = svc_session(q, n, r);        break;
+    case SID_TP:    len = svc_tester_present(q, n, r); break;
+    case SID_RDBI:  len = svc_rdbi(q, n, r);           break;
+    case SID_RDTCI: len = svc_rdtci(q, n, r);          break;
+    case SID_CDTCI: len = svc_clear_dtc(q, n, r);      break;
+    case SID_RC:    len = svc_routine(q, n, r);        break;
+    default:        len = -(int)UDS_NRC_SERVICE_NOT_SUPPORTED; break;
+  }
+
+  if (len < 0)
+  {
+    const uint8_t nrc = (uint8_t)(-len);
+    /* Functional requests: no answer for "not supported / out of range" */
+    if (functional && (nrc == UDS_NRC_SERVICE_NOT_SUPPORTED ||
+                       nrc == UDS_NRC_SUBFUNCTION_NOT_SUPPORTED ||
+                       nrc == UDS_NRC_REQUEST_OUT_OF_RANGE ||
+                       nrc == UDS_NRC_NOT_IN_ACTIVE_SESSION))
+    {
+      len = 0;
+    }
+    else
+    {
+      r[0] = SID_NEG;
+      r[1] = q[0];
+      r[2] = nrc;
+      len = 3;
+      s_stats.negative++;
+    }
+  }
+  if (len == 0)
+  {
+    Isotp_BufFree(r);
+    return NULL;
+  }
+  s_stats.bytes_out += (uint32_t)len;
+  *rlen = (uint16_t)len;
+  return r;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Uds_Init(void)
+{
+  Isotp_Reset(&s_link);
+  Isotp_Init(&s_link, CAN_BUS_DASH, UDS_RSP_ID, UDS_REQ_ID, tx_queue);
+  s_use_queue = 1u;
+  Isotp_BufFree(s_func);
+  s_func = NULL;
+  s_session = SESSION_DEFAULT;
+  s_boot_pending = 0u;
+  s_save_started = 0u;
+  s_apps_done = 0u;
+  memset(&s_stats, 0, sizeof(s_stats));
+
+  ctrl_exec_stats_t es;
+  CtrlExec_GetStats(&es);
+  s_overruns_seen = es.overruns;
+  calib_stats_t cs;
+  Calib_GetStats(&cs);
+  s_save_errors_seen = cs.save_errors;
+  dtc_clear();
+}
+
+void Uds_SetTransport(isotp_tx_fn_t tx)
+{
+  s_use_queue = (tx == NULL);
+  s_link.tx = tx ? tx : tx_queue;
+}
+
+int Uds_Rx(const can_msg_t *m, uint32_t now_us)
+{
+  if (!m || m->bus != CAN_BUS_DASH) return 0;
+
+  if (m->id == UDS_FUNC_ID)
+  {
+    const uint8_t n = m->data[0];
+    if (m->dlc >= 2u && n >= 1u && n <= 7u && n < m->dlc && !s_func)
+    {
+      s_func = Isotp_BufAlloc();
+      if (s_func)
+      {
+        memcpy(s_func, &m->data[1], n);
+        s_func_len = n;
+      }
+    }
+    return 1;
+  }
+  return Isotp_OnFrame(&s_link, m, now_us);
+}
+
+void Uds_Service(uint32_t now_us, uint32_t budget)
+{
+  if (budget == UINT32_MAX)
+  {
+    const uint32_t queued = s_use_queue && canTxQueueHandle
+                          ? osMessageQueueGetCount(canTxQueueHandle) : 0u;
+    budget = (queued < UDS_TX_FIFO_SHARE) ? UDS_TX_FIFO_SHARE - queued : 0u;
+  }
+
+  /* A new request only once the previous response is out */
+  if (!Isotp_TxBusy(&s_link))
+  {
+    uint16_t n = 0;
+    uint8_t functional = 0u;
+    uint8_t *q = Isotp_Receive(&s_link, &n);
+    if (!q && s_func)
+    {
+      q = s_func;
+      n = s_func_len;
+      s_func = NULL;
+      functional = 1u;
+    }
+    if (q)
+    {
+      s_last_req_us = now_us;
+      uint16_t rn = 0;
+      uint8_t *r = process(q, n, functional, &rn);
+      Isotp_BufFree(q);
+      if (r) (void)Isotp_Send(&s_link, r, rn, now_us);
+    }
+  }
+
+  (void)Isotp_Poll(&s_link, now_us, budget);
+
+  if (s_boot_pending && !Isotp_TxBusy(&s_link))
+  {
+    if (s_boot_us == 0u) s_boot_us = now_us | 1u;
+    else if (now_us - s_boot_us >= BOOT_DELAY_US)
+    {
+      s_boot_pending = 0u;
+      Fwu_EnterBootloader();
+    }
+  }
+
+  if (s_session != SESSION_DEFAULT &&
+      (int32_t)(now_us - s_last_req_us) > (int32_t)UDS_S3_US)
+  {
+    s_session = SESSION_DEFAULT;
+  }
+}
+
+void Uds_GetStats(uds_stats_t *out)
+{
+  if (!out) return;
+  *out = s_stats;
+  out->session = s_session;
+}
+
+isotp_link_t *Uds_Link(void)
+{
+  return &s_link;
+}
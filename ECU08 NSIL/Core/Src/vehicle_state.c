@@ -0,0 +1,92 @@
+#include "vehicle_state.h"
+#include <string.h>
+#include <math.h>
+
+#define RPM_TO_RAD_S   0.10471976f   /* 2*pi/60 */
+#define MG_TO_MPS2     0.00980665f
+#define DDPS_TO_RAD_S  0.0017453293f /* 0.1 deg/s */
+
+const vehicle_state_cfg_t VEHICLE_STATE_CFG_DEFAULT =
+{
+  .gear        = 3.5f,
+  .r_wheel_m   = 0.23f,
+  .track_m     = 1.20f,
+  .q_v         = 0.05f,
+  .q_v_no_imu  = 25.0f,
+  .q_b         = 0.01f,
+  .r_wheel     = 0.01f,
+  .r_motor     = 0.04f,
+  .k_motor     = 20.0f,
+  .gate_mps    = 1.0f,
+  .gate_rel    = 0.15f,
+  .r_missing   = 1.0e6f,
+  .v_min_mps   = 1.0f,
+};
+
+void VehState_Init(vehicle_state_t *vs)
+{
+  if (!vs) return;
+  memset(vs, 0, sizeof(*vs));
+  vs->p00 = 1.0f;
+  vs->p11 = 0.25f;
+}
+
+/* Scalar measurement z of v (H = [1 0]) with variance r. bias = 0 keeps
+ * the bias out of the update (Schmidt "consider" form). */
+static inline void kf_update_v(vehicle_state_t *vs, float z, float r, float bias)
+{
+  const float y  = z - vs->v_mps;
+  const float si = 1.0f / (vs->p00 + r);
+  const float k0 = vs->p00 * si;
+  const float k1 = vs->p01 * si * bias;
+
+  vs->v_mps += k0 * y;
+  vs->b_ax  += k1 * y;
+
+  const float p00 = vs->p00, p01 = vs->p01;
+  vs->p00 = p00 - k0 * p00;
+  vs->p01 = p01 - k0 * p01;
+  vs->p11 = vs->p11 - k1 * p01;
+}
+
+void VehState_Update(vehicle_state_t *vs, const vehicle_state_cfg_t *cfg,
+                     const app_inputs_t *in, float dt_s)
+{
+  if (!vs || !cfg || !in) return;
+
+  const float imu   = in->imu_ok   ? 1.0f : 0.0f;
+  const float wheel = in->wheel_ok ? 1.0f : 0.0f;
+
+  /* Predict: F = [1 -dt; 0 1] */
+  const float ax = imu * (float)in->imu_acc_mg[0] * MG_TO_MPS2;
+  const float qv = in->imu_ok ? cfg->q_v : cfg->q_v_no_imu;
+  vs->v_mps += imu * (ax - vs->b_ax) * dt_s;
+
+  const float dt = dt_s * imu;   /* without IMU the bias is not observable */
+  const float p00 = vs->p00, p01 = vs->p01, p11 = vs->p11;
+  vs->p00 = p00 - 2.0f * dt * p01 + dt * dt * p11 + qv * dt_s;
+  vs->p01 = p01 - dt * p11;
+  vs->p11 = p11 + cfg->q_b * dt_s;
+
+  /* Undriven front wheels */
+  const float v_fl = (float)in->wheel_fl_cmps * 0.01f;
+  const float v_fr = (float)in->wheel_fr_cmps * 0.01f;
+  kf_update_v(vs, 0.5f * (v_fl + v_fr), in->wheel_ok ? cfg->r_wheel : cfg->r_missing, 1.0f);
+
+  /* Driven wheel from motor speed, robust to slip */
+  const float v_drv = (float)in->inv_rpm * RPM_TO_RAD_S / cfg->gear * cfg->r_wheel_m;
+  const float y_m   = v_drv - vs->v_mps;
+  const float gate  = cfg->gate_mps + cfg->gate_rel * vs->v_mps;
+  const float r_m   = (fabsf(y_m) > gate) ? cfg->r_missing : (cfg->r_motor + cfg->k_motor * y_m * y_m);
+  kf_update_v(vs, v_drv, r_m, 0.0f);
+
+  if (vs->v_mps < 0.0f) vs->v_mps = 0.0f;
+
+  /* Outputs */
+  const float den = (vs->v_mps > cfg->v_min_mps) ? vs->v_mps : cfg->v_min_mps;
+  vs->slip = (v_drv - vs->v_mps) / den;
+
+  const float yaw_kin = (v_fr - v_fl) / cfg->track_m;
+  vs->yaw_rate_rad_s = imu * (float)in->imu_gyr_ddps[2] * DDPS_TO_RAD_S;
+  vs->yaw_err_rad_s  = imu * wheel * (vs->yaw_rate_rad_s - yaw_kin);
+}
@@ -0,0 +1,185 @@
+#include "wheel_speed.h"
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#endif
+
+/* cm/s * ticks per tooth: circumference / teeth, in cm, times tick rate */
+#define WHEEL_K_CMPS_TICKS \
+  ((uint32_t)(6.2831853f * WHEEL_SPEED_R_WHEEL_M * 100.0f / (float)WHEEL_SPEED_TEETH * \
+              (float)WHEEL_SPEED_TIM_CLK_HZ))
+
+#define WHEEL_TIMEOUT_TICKS \
+  ((uint32_t)(((uint64_t)WHEEL_SPEED_TIMEOUT_US * WHEEL_SPEED_TIM_CLK_HZ) / 1000000u))
+
+typedef struct
+{
+  volatile uint32_t last_edge;   /* capture ticks of the last accepted edge */
+  volatile uint16_t cmps;        /* speed from the last full period         */
+  volatile uint8_t  have_edge;
+} wheel_ch_t;
+
+static wheel_ch_t s_ch[WHEEL_N];
+
+/* Both channels silent since the drive was last seen at standstill: the
+ * front wheels are stopped (launch wheelspin), not the sensors dead */
+static uint8_t    s_still;
+
+void WheelSpeed_Init(void)
+{
+  memset(s_ch, 0, sizeof(s_ch));
+  s_still = 0;
+}
+
+void WheelSpeed_OnCapture(wheel_id_t w, uint32_t capture_ticks)
+{
+  if ((uint32_t)w >= WHEEL_N) return;
+  wheel_ch_t *c = &s_ch[w];
+
+  uint32_t period = capture_ticks - c->last_edge;   /* modulo 2^32 */
+  if (c->have_edge && period < WHEEL_SPEED_MIN_PERIOD_US) return;   /* glitch */
+
+  c->last_edge = capture_ticks;
+  if (!c->have_edge || period > WHEEL_TIMEOUT_TICKS)
+  {
+    /* First edge (or first after standing still): no period yet */
+    c->have_edge = 1;
+    c->cmps = 0;
+    return;
+  }
+
+  uint32_t v = WHEEL_K_CMPS_TICKS / period;
+  c->cmps = (v > 0xFFFFu) ? 0xFFFFu : (uint16_t)v;
+}
+
+uint16_t WheelSpeed_GetCmps(wheel_id_t w, uint32_t now_ticks)
+{
+  if ((uint32_t)w >= WHEEL_N) return 0;
+  const wheel_ch_t *c = &s_ch[w];
+  if (!c->have_edge) return 0;
+
+  uint32_t since = now_ticks - c->last_edge;
+  if (since > WHEEL_TIMEOUT_TICKS) return 0;
+
+  /* While decelerating the next edge is late: bound by elapsed time */
+  uint16_t v = c->cmps;
+  if (since > 0u)
+  {
+    uint32_t bound = WHEEL_K_CMPS_TICKS / since;
+    if (bound < v) v = (uint16_t)bound;
+  }
+  return v;
+}
+
+static uint8_t alive(wheel_id_t w, uint32_t now_ticks)
+{
+  const wheel_ch_t *c = &s_ch[w];
+  return (c->have_edge && now_ticks - c->last_edge <= WHEEL_TIMEOUT_TICKS) ? 1u : 0u;
+}
+
+void WheelSpeed_FillAt(app_inputs_t *in, uint32_t now_ticks)
+{
+  if (!in) return;
+  in->wheel_fl_cmps = WheelSpeed_GetCmps(WHEEL_FL, now_ticks);
+  in->wheel_fr_cmps = WheelSpeed_GetCmps(WHEEL_FR, now_ticks);
+
+  const uint8_t fl = alive(WHEEL_FL, now_ticks);
+  const uint8_t fr = alive(WHEEL_FR, now_ticks);
+  const int32_t rpm = in->inv_rpm;
+  const uint8_t still = (rpm < (int32_t)WHEEL_SPEED_STILL_RPM && rpm > -(int32_t)WHEEL_SPEED_STILL_RPM) ? 1u : 0u;
+
+  if (fl || fr) s_still = 0;
+  else if (still) s_still = 1u;
+
+  /* A silent channel while the other turns, or both silent once the car
+   * has moved, is a sensor fault: 0 cm/s would read as full slip */
+  in->wheel_ok = ((fl && fr) || still || s_still) ? 1u : 0u;
+}
+
+#ifndef SIL_BUILD
+
+static TIM_HandleTypeDef s_htim2;
+
+static uint32_t tim2_clock_hz(void)
+{
+  /* TIM2 sits on APB1; timer clock is 2x PCLK1 when APB1 is divided. */
+  uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+  if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_D2CFGR_D2PPRE1_DIV1) pclk *= 2u;
+  return pclk;
+}
+
+void WheelSpeed_Start(void)
+{
+  GPIO_InitTypeDef gpio = {0};
+  TIM_IC_InitTypeDef ic = {0};
+
+  __HAL_RCC_TIM2_CLK_ENABLE();
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+
+  /* PA0 → TIM2_CH1 (FL), PA1 → TIM2_CH2 (FR); open-collector hall sensors */
+  gpio.Pin       = GPIO_PIN_0 | GPIO_PIN_1;
+  gpio.Mode      = GPIO_MODE_AF_PP;
+  gpio.Pull      = GPIO_PULLUP;
+  gpio.Speed     = GPIO_SPEED_FREQ_LOW;
+  gpio.Alternate = GPIO_AF1_TIM2;
+  HAL_GPIO_Init(GPIOA, &gpio);
+
+  s_htim2.Instance               = TIM2;
+  s_htim2.Init.Prescaler         = (tim2_clock_hz() / WHEEL_SPEED_TIM_CLK_HZ) - 1u;
+  s_htim2.Init.CounterMode       = TIM_COUNTERMODE_UP;
+  s_htim2.Init.Period            = 0xFFFFFFFFu;
+  s_htim2.Init.ClockDivision     = TIM_CLOCKDIVISION_DIV1;
+  s_htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_IC_Init(&s_htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  ic.ICPolarity  = TIM_ICPOLARITY_RISING;
+  ic.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  ic.ICPrescaler = TIM_ICPSC_DIV1;
+  ic.ICFilter    = 0x8u;   /* fDTS/8, N=6: rejects ringing on the sensor line */
+  if (HAL_TIM_IC_ConfigChannel(&s_htim2, &ic, TIM_CHANNEL_1) != HAL_OK ||
+      HAL_TIM_IC_ConfigChannel(&s_htim2, &ic, TIM_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  HAL_NVIC_SetPriority(TIM2_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(TIM2_IRQn);
+
+  (void)HAL_TIM_IC_Start_IT(&s_htim2, TIM_CHANNEL_1);
+  (void)HAL_TIM_IC_Start_IT(&s_htim2, TIM_CHANNEL_2);
+}
+
+void WheelSpeed_TimIrq(void)
+{
+  /* Direct register access: reading CCRx clears CCxIF */
+  uint32_t sr = TIM2->SR;
+  if (sr & TIM_SR_CC1IF) WheelSpeed_OnCapture(WHEEL_FL, TIM2->CCR1);
+  if (sr & TIM_SR_CC2IF) WheelSpeed_OnCapture(WHEEL_FR, TIM2->CCR2);
+  TIM2->SR = ~(TIM_SR_CC1OF | TIM_SR_CC2OF | TIM_SR_UIF);
+}
+
+void WheelSpeed_Fill(app_inputs_t *in)
+{
+  WheelSpeed_FillAt(in, TIM2->CNT);
+}
+
+#else /* SIL_BUILD: speeds come from the plant / CAN */
+
+void WheelSpeed_Start(void)
+{
+}
+
+void WheelSpeed_TimIrq(void)
+{
+}
+
+void WheelSpeed_Fill(app_inputs_t *in)
+{
+  (void)in;
+}
+
+#endif /* SIL_BUILD */
@@ -0,0 +1,676 @@
+#include "xcp.h"
+#include "calib.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifndef SIL_BUILD
+#include "main.h"
+#define XCP_DMB()  __DMB()
+#else
+#define XCP_DMB()  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* Memory segments behind the address map (xcp.h) */
+enum { SEG_INPUTS = 0, SEG_OUTPUT, SEG_CALIB, SEG_COUNT };
+
+static const uint32_t SEG_SIZE[SEG_COUNT] =
+{
+  (uint32_t)sizeof(app_inputs_t),
+  (uint32_t)sizeof(control_out_t),
+  (uint32_t)sizeof(calib_data_t),
+};
+
+/* MODE bits of SET_DAQ_LIST_MODE we do not support: alternating, STIM,
+ * timestamp, PID off */
+#define DAQ_MODE_UNSUPPORTED  0x33u
+
+typedef struct
+{
+  uint8_t  seg;
+  uint8_t  size;            /* 0 = not written yet                         */
+  uint16_t off;
+} xcp_entry_t;
+
+/* One memcpy of the compiled copy list: adjacent entries merged */
+typedef struct
+{
+  uint8_t  seg;
+  uint8_t  len;
+  uint8_t  dst;             /* byte in the DTO frame (1..7)                */
+  uint16_t src;             /* offset in the segment                       */
+} xcp_op_t;
+
+typedef struct
+{
+  uint16_t first_entry;     /* also the first op                           */
+  uint8_t  entry_count;
+  uint8_t  op_count;        /* compiled                                    */
+} xcp_odt_t;
+
+typedef struct
+{
+  uint8_t  first_odt;       /* absolute ODT number = PID of the first ODT  */
+  uint8_t  odt_count;
+  uint8_t  event;
+  uint8_t  prescaler;
+  uint8_t  prescale_cnt;
+} xcp_daq_t;
+
+/* Allocation sequence of dynamic DAQ (FREE → ALLOC_DAQ → ALLOC_ODT →
+ * ALLOC_ODT_ENTRY) */
+enum { ALLOC_FREE = 0, ALLOC_DAQ, ALLOC_ODT, ALLOC_ENTRY };
+
+static xcp_tx_fn_t s_tx;
+static uint8_t     s_connected;
+static uint32_t    s_mta;
+
+static xcp_daq_t   s_daq[XCP_MAX_DAQ];
+static xcp_odt_t   s_odt[XCP_MAX_ODT];
+static xcp_entry_t s_entry[XCP_MAX_ENTRIES];
+static xcp_op_t    s_op[XCP_MAX_ENTRIES];
+static can_msg_t   s_dto[XCP_MAX_ODT];      /* PID and DLC prefilled        */
+static uint8_t     s_daq_count, s_odt_count, s_alloc;
+static uint16_t    s_entry_count;
+
+static uint16_t    s_ptr, s_ptr_end;        /* SET_DAQ_PTR / WRITE_DAQ      */
+static uint32_t    s_selected;              /* START_STOP_DAQ_LIST select   */
+static volatile uint32_t s_run_mask;        /* read by Xcp_Event()          */
+
+static uint8_t     s_store_req;
+static uint32_t    s_store_mark;
+
+static app_inputs_t s_upload_in;
+static xcp_stats_t s_stats;
+
+/* ---------------------------------------------------------------------- */
+
+static void tx_queue(const can_msg_t *m)
+{
+  can_qitem_t q;
+  CAN_Pack(m, &q);
+  if (!canTxQueueHandle || osMessageQueuePut(canTxQueueHandle, &q, 0u, 0u) != osOK)
+  {
+    s_stats.dto_dropped++;
+  }
+}
+
+static void send(const uint8_t *d, uint8_t n)
+{
+  can_msg_t m;
+  memset(&m, 0, sizeof(m));
+  m.bus = CAN_BUS_DASH;
+  m.id  = XCP_DTO_ID;
+  m.dlc = n;
+  memcpy(m.data, d, n);
+  s_tx(&m);
+}
+
+static void send_err(uint8_t code)
+{
+  const uint8_t d[2] = { XCP_PID_ERR, code };
+  s_stats.err++;
+  send(d, 2u);
+}
+
+static void send_ok(void)
+{
+  const uint8_t d[1] = { XCP_PID_RES };
+  send(d, 1u);
+}
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | ((uint16_t)p[1] << 8)); }
+static uint32_t rd32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Address → segment and offset; the whole [addr, addr+size) must fit. */
+static int resolve(uint32_t addr, uint32_t size, uint8_t *seg, uint16_t *off)
+{
+  const uint32_t s = (addr >> 28) - 1u;
+  const uint32_t o = addr & 0x0FFFFFFFu;
+  if (s >= SEG_COUNT || size == 0u || o + size > SEG_SIZE[s]) return 0;
+  *seg = (uint8_t)s;
+  *off = (uint16_t)o;
+  return 1;
+}
+
+static void publish_run(uint32_t mask)
+{
+  XCP_DMB();
+  s_run_mask = mask;
+}
+
+static void daq_reset(void)
+{
+  publish_run(0u);
+  s_selected    = 0u;
+  s_daq_count   = 0u;
+  s_odt_count   = 0u;
+  s_entry_count = 0u;
+  s_alloc       = ALLOC_FREE;
+  s_ptr = s_ptr_end = 0u;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Memory access                                                          */
+
+static uint8_t upload(uint32_t addr, uint8_t n, uint8_t *dst)
+{
+  uint8_t seg;
+  uint16_t off;
+  if (!resolve(addr, n, &seg, &off)) return XCP_ERR_OUT_OF_RANGE;
+
+  const uint8_t *src;
+  switch (seg)
+  {
+    case SEG_INPUTS:
+      AppState_Snapshot(&s_upload_in);
+      src = (const uint8_t *)&s_upload_in;
+      break;
+    case SEG_CALIB:
+      src = (const uint8_t *)Calib_Peek();
+      if (!src) return XCP_ERR_ACCESS_DENIED;
+      break;
+    default:
+      return XCP_ERR_ACCESS_DENIED;     /* outputs: DAQ only */
+  }
+  memcpy(dst, src + off, n);
+  return 0u;
+}
+
+static uint32_t param_size(uint8_t type)
+{
+  return (type == CALIB_T_U16 || type == CALIB_T_I16) ? 2u : 4u;
+}
+
+static const calib_param_t *param_at(uint32_t off)
+{
+  for (uint32_t i = 0; i < CALIB_PARAM_COUNT; i++)
+  {
+    if (CALIB_PARAMS[i].offset == off) return &CALIB_PARAMS[i];
+  }
+  return NULL;
+}
+
+static float param_decode(const calib_param_t *p, const uint8_t *raw)
+{
+  switch ((calib_type_t)p->type)
+  {
+    case CALIB_T_U16: return (float)rd16(raw);
+    case CALIB_T_I16: return (float)(int16_t)rd16(raw);
+    case CALIB_T_U32: return (float)rd32(raw);
+    case CALIB_T_I32: return (float)(int32_t)rd32(raw);
+    case CALIB_T_F32:
+    default:
+    {
+      const uint32_t w = rd32(raw);
+      float f;
+      memcpy(&f, &w, sizeof f);
+      return f;
+    }
+  }
+}
+
+/* DOWNLOAD into the calibration segment: whole parameters only, all of
+ * them in range, then one commit. */
+static uint8_t download(uint32_t addr, uint8_t n, const uint8_t *src)
+{
+  uint8_t seg;
+  uint16_t off;
+  if (!resolve(addr, n, &seg, &off)) return XCP_ERR_OUT_OF_RANGE;
+  if (seg != SEG_CALIB) return XCP_ERR_WRITE_PROTECTED;
+
+  const calib_param_t *p[XCP_ODT_BYTES / 2u];
+  float v[XCP_ODT_BYTES / 2u];
+  uint32_t k = 0, pos = 0;
+  while (pos < n)
+  {
+    const calib_param_t *q = param_at(off + pos);
+    if (!q || pos + param_size(q->type) > n) return XCP_ERR_ACCESS_DENIED;
+    v[k] = param_decode(q, src + pos);
+    if (!(v[k] >= q->min && v[k] <= q->max)) return XCP_ERR_OUT_OF_RANGE;
+    p[k++] = q;
+    pos += param_size(q->type);
+  }
+
+  for (uint32_t i = 0; i < k; i++)
+  {
+    if (Calib_Set(p[i]->id, v[i]) != CALIB_OK) return XCP_ERR_OUT_OF_RANGE;
+  }
+  if (Calib_Commit() != CALIB_OK) return XCP_ERR_CMD_BUSY;   /* staged: retry */
+  s_stats.cal_writes += k;
+  return 0u;
+}
+
+/* ---------------------------------------------------------------------- */
+/* DAQ                                                                    */
+
+/* Flattens a list into copy ops and prefilled DTO frames. */
+static uint8_t daq_compile(uint32_t d)
+{
+  const xcp_daq_t *dq = &s_daq[d];
+  if (dq->odt_count == 0u) return XCP_ERR_DAQ_CONFIG;
+
+  for (uint32_t o = dq->first_odt; o < (uint32_t)dq->first_odt + dq->odt_count; o++)
+  {
+    xcp_odt_t *odt = &s_odt[o];
+    if (odt->entry_count == 0u) return XCP_ERR_DAQ_CONFIG;
+
+    xcp_op_t *ops = &s_op[odt->first_entry];
+    uint32_t nops = 0, pos = 1;                         /* byte 0: PID */
+    for (uint32_t e = 0; e < odt->entry_count; e++)
+    {
+      const xcp_entry_t *en = &s_entry[odt->first_entry + e];
+      if (en->size == 0u || pos + en->size > 8u) return XCP_ERR_DAQ_CONFIG;
+
+      xcp_op_t *last = nops ? &ops[nops - 1u] : NULL;
+      if (last && last->seg == en->seg && last->src + last->len == en->off)
+      {
+        last->len = (uint8_t)(last->len + en->size);
+      }
+      else
+      {
+        ops[nops].seg = en->seg;
+        ops[nops].len = en->size;
+        ops[nops].dst = (uint8_t)pos;
+        ops[nops].src = en->off;
+        nops++;
+      }
+      pos += en->size;
+    }
+    odt->op_count = (uint8_t)nops;
+
+    can_msg_t *m = &s_dto[o];
+    memset(m, 0, sizeof(*m));
+    m->bus     = CAN_BUS_DASH;
+    m->id      = XCP_DTO_ID;
+    m->dlc     = (uint8_t)pos;
+    m->data[0] = (uint8_t)o;                            /* absolute ODT number */
+  }
+  return 0u;
+}
+
+void Xcp_Event(uint8_t event, const app_inputs_t *in, const control_out_t *out)
+{
+  const uint32_t run = s_run_mask;
+  if (run == 0u) return;
+  XCP_DMB();
+
+  const uint8_t *base[SEG_COUNT] =
+  {
+    (const uint8_t *)in,
+    (const uint8_t *)out,
+    (const uint8_t *)Calib_Peek(),
+  };
+
+  for (uint32_t d = 0; d < s_daq_count; d++)
+  {
+    if (!(run & (1u << d))) continue;
+    xcp_daq_t *dq = &s_daq[d];
+    if (dq->event != event) continue;
+    if (++dq->prescale_cnt < dq->prescaler) continue;
+    dq->prescale_cnt = 0u;
+    s_stats.samples++;
+
+    for (uint32_t o = dq->first_odt; o < (uint32_t)dq->first_odt + dq->odt_count; o++)
+    {
+      const xcp_odt_t *odt = &s_odt[o];
+      const xcp_op_t *op = &s_op[odt->first_entry];
+      uint8_t *frame = s_dto[o].data;
+      for (uint32_t i = 0; i < odt->op_count; i++, op++)
+      {
+        if (base[op->seg]) memcpy(frame + op->dst, base[op->seg] + op->src, op->len);
+      }
+      s_tx(&s_dto[o]);
+      s_stats.dto++;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Command processor                                                      */
+
+static void cmd_connect(void)
+{
+  const uint8_t d[8] =
+  {
+    XCP_PID_RES,
+    0x05u,                /* RESOURCE: CAL/PAG, DAQ                        */
+    0x00u,                /* COMM_MODE_BASIC: Intel, byte granularity      */
+    8u,                   /* MAX_CTO                                       */
+    8u, 0u,               /* MAX_DTO                                       */
+    1u,                   /* protocol layer version                        */
+    1u                    /* transport layer version                       */
+  };
+  if (!s_connected) daq_reset();
+  s_connected = 1u;
+  send(d, sizeof d);
+}
+
+static void cmd_get_status(void)
+{
+  if (s_store_req)
+  {
+    calib_stats_t cs;
+    Calib_GetStats(&cs);
+    if (cs.saves + cs.save_errors != s_store_mark) s_store_req = 0u;
+  }
+  const uint8_t d[6] =
+  {
+    XCP_PID_RES,
+    (uint8_t)((s_run_mask ? XCP_SESSION_DAQ_RUNNING : 0u) |
+              (s_store_req ? XCP_SESSION_STORE_CAL_REQ : 0u)),
+    0u,                   /* resource protection: none                     */
+    0u,
+    0u, 0u                /* session configuration id                      */
+  };
+  send(d, sizeof d);
+}
+
+static void cmd_daq_processor_info(void)
+{
+  const uint8_t d[8] =
+  {
+    XCP_PID_RES,
+    0x03u,                /* dynamic DAQ, prescaler                        */
+    (uint8_t)XCP_MAX_DAQ, 0u,
+    (uint8_t)XCP_EVENT_COUNT, 0u,
+    0u,                   /* MIN_DAQ                                       */
+    0x00u                 /* DAQ_KEY: absolute ODT number, any extension   */
+  };
+  send(d, sizeof d);
+}
+
+static uint8_t cmd_alloc(const uint8_t *c, uint8_t dlc)
+{
+  switch (c[0])
+  {
+    case XCP_CMD_ALLOC_DAQ:
+    {
+      if (dlc < 4u) return XCP_ERR_CMD_SYNTAX;
+      const uint16_t n = rd16(&c[2]);
+      if (s_alloc != ALLOC_FREE) return XCP_ERR_SEQUENCE;
+      if (n > XCP_MAX_DAQ) return XCP_ERR_MEMORY_OVERFLOW;
+      memset(s_daq, 0, sizeof(s_daq));
+      for (uint32_t d = 0; d < n; d++) s_daq[d].prescaler = 1u;
+      s_daq_count = (uint8_t)n;
+      s_alloc = ALLOC_DAQ;
+      return 0u;
+    }
+    case XCP_CMD_ALLOC_ODT:
+    {
+      if (dlc < 5u) return XCP_ERR_CMD_SYNTAX;
+      const uint16_t d = rd16(&c[2]);
+      const uint8_t n = c[4];
+      if (s_alloc != ALLOC_DAQ && s_alloc != ALLOC_ODT) return XCP_ERR_SEQUENCE;
+      if (d >= s_daq_count) return XCP_ERR_OUT_OF_RANGE;
+      if (s_daq[d].odt_count != 0u) return XCP_ERR_SEQUENCE;
+      if ((uint32_t)s_odt_count + n > XCP_MAX_ODT) return XCP_ERR_MEMORY_OVERFLOW;
+      memset(&s_odt[s_odt_count], 0, n * sizeof(xcp_odt_t));
+      s_daq[d].first_odt = s_odt_count;
+      s_daq[d].odt_count = n;
+      s_odt_count = (uint8_t)(s_odt_count + n);
+      s_alloc = ALLOC_ODT;
+      return 0u;
+    }
+    case XCP_CMD_ALLOC_ODT_ENTRY:
+    default:
+    {
+      if (dlc < 6u) return XCP_ERR_CMD_SYNTAX;
+      const uint16_t d = rd16(&c[2]);
+      const uint8_t o = c[4], n = c[5];
+      if (s_alloc != ALLOC_ODT && s_alloc != ALLOC_ENTRY) return XCP_ERR_SEQUENCE;
+      if (d >= s_daq_count || o >= s_daq[d].odt_count) return XCP_ERR_OUT_OF_RANGE;
+      if (n == 0u || n > XCP_ODT_BYTES) return XCP_ERR_OUT_OF_RANGE;
+      xcp_odt_t *odt = &s_odt[s_daq[d].first_odt + o];
+      if (odt->entry_count != 0u) return XCP_ERR_SEQUENCE;
+      if ((uint32_t)s_entry_count + n > XCP_MAX_ENTRIES) return XCP_ERR_MEMORY_OVERFLOW;
+      memset(&s_entry[s_entry_count], 0, n * sizeof(xcp_entry_t));
+      odt->first_entry = s_entry_count;
+      odt->entry_count = n;
+      s_entry_count = (uint16_t)(s_entry_count + n);
+      s_alloc = ALLOC_ENTRY;
+      return 0u;
+    }
+  }
+}
+
+static uint8_t cmd_daq_ptr(const uint8_t *c, uint8_t dlc)
+{
+  if (dlc < 6u) return XCP_ERR_CMD_SYNTAX;
+  const uint16_t d = rd16(&c[2]);
+  const uint8_t o = c[4], e = c[5];
+  if (d >= s_daq_count || o >= s_daq[d].odt_count) return XCP_ERR_OUT_OF_RANGE;
+  if (s_run_mask & (1u << d)) return XCP_ERR_DAQ_ACTIVE;
+  const xcp_odt_t *odt = &s_odt[s_daq[d].first_odt + o];
+  if (e >= odt->entry_count) return XCP_ERR_OUT_OF_RANGE;
+  s_ptr     = (uint16_t)(odt->first_entry + e);
+  s_ptr_end = (uint16_t)(odt->first_entry + odt->entry_count);
+  return 0u;
+}
+
+static uint8_t cmd_write_daq(const uint8_t *c, uint8_t dlc)
+{
+  if (dlc < 8u) return XCP_ERR_CMD_SYNTAX;
+  const uint8_t bit = c[1], size = c[2], ext = c[3];
+  if (s_ptr >= s_ptr_end) return XCP_ERR_OUT_OF_RANGE;
+  if (bit != 0xFFu || ext != 0u || size > XCP_ODT_BYTES) return XCP_ERR_OUT_OF_RANGE;
+  xcp_entry_t *en = &s_entry[s_ptr];
+  if (!resolve(rd32(&c[4]), size, &en->seg, &en->off)) return XCP_ERR_OUT_OF_RANGE;
+  en->size = size;
+  s_ptr++;
+  return 0u;
+}
+
+static uint8_t cmd_daq_mode(const uint8_t *c, uint8_t dlc)
+{
+  if (dlc < 8u) return XCP_ERR_CMD_SYNTAX;
+  const uint8_t mode = c[1];
+  const uint16_t d = rd16(&c[2]), ev = rd16(&c[4]);
+  if (d >= s_daq_count || ev >= XCP_EVENT_COUNT) return XCP_ERR_OUT_OF_RANGE;
+  if (s_run_mask & (1u << d)) return XCP_ERR_DAQ_ACTIVE;
+  if (mode & DAQ_MODE_UNSUPPORTED) return XCP_ERR_MODE_NOT_VALID;
+  s_daq[d].event        = (uint8_t)ev;
+  s_daq[d].prescaler    = c[6] ? c[6] : 1u;
+  s_daq[d].prescale_cnt = 0u;
+  return 0u;
+}
+
+static void cmd_start_stop_list(const uint8_t *c, uint8_t dlc)
+{
+  if (dlc < 4u) { send_err(XCP_ERR_CMD_SYNTAX); return; }
+  const uint8_t mode = c[1];
+  const uint16_t d = rd16(&c[2]);
+  if (d >= s_daq_count || mode > 2u) { send_err(XCP_ERR_OUT_OF_RANGE); return; }
+  const uint32_t bit = 1u << d;
+
+  if (mode == 0u)
+  {
+    s_selected &= ~bit;
+    publish_run(s_run_mask & ~bit);
+  }
+  else
+  {
+    if (!(s_run_mask & bit))
+    {
+      const uint8_t rc = daq_compile(d);
+      if (rc) { send_err(rc); return; }
+      s_daq[d].prescale_cnt = 0u;
+    }
+    if (mode == 1u) publish_run(s_run_mask | bit);
+    else s_selected |= bit;
+  }
+  const uint8_t r[2] = { XCP_PID_RES, s_daq[d].first_odt };
+  send(r, sizeof r);
+}
+
+static uint8_t cmd_start_stop_synch(const uint8_t *c, uint8_t dlc)
+{
+  if (dlc < 2u) return XCP_ERR_CMD_SYNTAX;
+  switch (c[1])
+  {
+    case 0u: publish_run(0u);                        break;
+    case 1u: publish_run(s_run_mask | s_selected);   break;
+    case 2u: publish_run(s_run_mask & ~s_selected);  break;
+    default: return XCP_ERR_OUT_OF_RANGE;
+  }
+  s_selected = 0u;
+  return 0u;
+}
+
+int Xcp_Rx(const can_msg_t *m)
+{
+  if (!m || m->bus != CAN_BUS_DASH || m->id != XCP_CRO_ID || m->ide) return 0;
+  if (m->dlc == 0u) return 1;
+  if (!s_tx) s_tx = tx_queue;
+  s_stats.cro++;
+
+  const uint8_t *c = m->data;
+  const uint8_t dlc = (m->dlc > 8u) ? 8u : m->dlc;
+
+  /* Not connected: everything but CONNECT is ignored silently */
+  if (!s_connected && c[0] != XCP_CMD_CONNECT) return 1;
+
+  uint8_t rc = 0u;
+  switch (c[0])
+  {
+    case XCP_CMD_CONNECT:
+      cmd_connect();
+      return 1;
+
+    case XCP_CMD_DISCONNECT:
+      daq_reset();
+      s_connected = 0u;
+      break;
+
+    case XCP_CMD_GET_STATUS:
+      cmd_get_status();
+      return 1;
+
+    case XCP_CMD_SYNCH:
+      rc = XCP_ERR_CMD_SYNCH;
+      break;
+
+    case XCP_CMD_SET_REQUEST:
+      if (dlc < 2u) { rc = XCP_ERR_CMD_SYNTAX; break; }
+      if (c[1] & XCP_SESSION_STORE_CAL_REQ)
+      {
+        /* The sector erase stalls flash reads: never while driving */
+        if (Control_IsRunning()) { rc = XCP_ERR_ACCESS_DENIED; break; }
+        calib_stats_t cs;
+        Calib_GetStats(&cs);
+        s_store_mark = cs.saves + cs.save_errors;
+        s_store_req  = 1u;
+        Calib_RequestSave();
+      }
+      break;
+
+    case XCP_CMD_SET_MTA:
+      if (dlc < 8u) { rc = XCP_ERR_CMD_SYNTAX; break; }
+      if (c[3] != 0u) { rc = XCP_ERR_OUT_OF_RANGE; break; }
+      s_mta = rd32(&c[4]);
+      break;
+
+    case XCP_CMD_UPLOAD:
+    case XCP_CMD_SHORT_UPLOAD:
+    {
+      const uint8_t need = (c[0] == XCP_CMD_UPLOAD) ? 2u : 8u;
+      if (dlc < need) { rc = XCP_ERR_CMD_SYNTAX; break; }
+      const uint8_t n = c[1];
+      if (n == 0u || n > XCP_ODT_BYTES) { rc = XCP_ERR_OUT_OF_RANGE; break; }
+      if (c[0] == XCP_CMD_SHORT_UPLOAD)
+      {
+        if (c[3] != 0u) { rc = XCP_ERR_OUT_OF_RANGE; break; }
+        s_mta = rd32(&c[4]);
+      }
+      uint8_t r[8] = { XCP_PID_RES };
+      rc = upload(s_mta, n, &r[1]);
+      if (rc) break;
+      s_mta += n;
+      send(r, (uint8_t)(1u + n));
+      return 1;
+    }
+
+    case XCP_CMD_DOWNLOAD:
+    {
+      const uint8_t n = c[1];
+      if (dlc < 2u || n == 0u || n > 6u || dlc < 2u + n) { rc = XCP_ERR_CMD_SYNTAX; break; }
+      rc = download(s_mta, n, &c[2]);
+      if (!rc) s_mta += n;
+      break;
+    }
+
+    case XCP_CMD_GET_DAQ_PROCESSOR_INFO:
+      cmd_daq_processor_info();
+      return 1;
+
+    case XCP_CMD_FREE_DAQ:
+      daq_reset();
+      break;
+
+    case XCP_CMD_ALLOC_DAQ:
+    case XCP_CMD_ALLOC_ODT:
+    case XCP_CMD_ALLOC_ODT_ENTRY:
+      rc = (s_run_mask != 0u) ? XCP_ERR_DAQ_ACTIVE : cmd_alloc(c, dlc);
+      break;
+
+    case XCP_CMD_CLEAR_DAQ_LIST:
+    {
+      if (dlc < 4u) { rc = XCP_ERR_CMD_SYNTAX; break; }
+      const uint16_t d = rd16(&c[2]);
+      if (d >= s_daq_count) { rc = XCP_ERR_OUT_OF_RANGE; break; }
+      s_selected &= ~(1u << d);
+      publish_run(s_run_mask & ~(1u << d));
+      for (uint32_t o = s_daq[d].first_odt; o < (uint32_t)s_daq[d].first_odt + s_daq[d].odt_count; o++)
+      {
+        memset(&s_entry[s_odt[o].first_entry], 0, s_odt[o].entry_count * sizeof(xcp_entry_t));
+      }
+      break;
+    }
+
+    case XCP_CMD_SET_DAQ_PTR:         rc = cmd_daq_ptr(c, dlc);           break;
+    case XCP_CMD_WRITE_DAQ:           rc = cmd_write_daq(c, dlc);         break;
+    case XCP_CMD_SET_DAQ_LIST_MODE:   rc = cmd_daq_mode(c, dlc);          break;
+    case XCP_CMD_START_STOP_SYNCH:    rc = cmd_start_stop_synch(c, dlc);  break;
+
+    case XCP_CMD_START_STOP_DAQ_LIST:
+      cmd_start_stop_list(c, dlc);
+      return 1;
+
+    default:
+      rc = XCP_ERR_CMD_UNKNOWN;
+      break;
+  }
+
+  if (rc) send_err(rc);
+  else send_ok();
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Xcp_Init(void)
+{
+  daq_reset();
+  s_connected = 0u;
+  s_mta = 0u;
+  s_store_req = 0u;
+  s_tx = tx_queue;
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+void Xcp_SetTransport(xcp_tx_fn_t tx)
+{
+  s_tx = tx ? tx : tx_queue;
+}
+
+uint8_t Xcp_IsConnected(void)
+{
+  return s_connected;
+}
+
+void Xcp_GetStats(xcp_stats_t *out)
+{
+  if (out) *out = s_stats;
+}
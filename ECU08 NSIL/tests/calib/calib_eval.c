@@ -0,0 +1,113 @@
+/**
+ * calib_eval.c
+ * Reproducción de un registro con una calibración y cálculo de métricas.
+ */
+
+#include "calib_eval.h"
+
+#include <math.h>
+#include <string.h>
+
+const calib_weights_t CALIB_WEIGHTS_DEFAULT =
+{
+  .err   = 1.0f,
+  .tv    = 1.0f,
+  .fault = 2.0f,
+  .miss  = 1.0f,
+  .lat   = 1.0f,
+};
+
+void CalibEval_Run(const calib_log_t *log, const apps_cal_t *cal,
+                   const calib_weights_t *w, calib_scratch_t *scratch,
+                   calib_metrics_t *out)
+{
+  ctrl_ctx_t ctx;
+  Control_CtxInit(&ctx, log->period_ms * 1000u);
+  if (Control_CtxSetAppsCal(&ctx, cal) != 0)
+  {
+    /* El firmware la rechazaría (banda muerta >= mínimo...): nunca gana */
+    memset(out, 0, sizeof(*out));
+    out->score = INFINITY;
+    return;
+  }
+
+  /* Acumuladores enteros: mismo resultado sea cual sea el hilo */
+  uint64_t err2 = 0, tv = 0;
+  uint32_t faults = 0, brake_n = 0, brake_miss = 0;
+  uint32_t onsets = 0, lat_samples = 0;
+  uint32_t pending = 0, pending_age = 0;      /* arranque sin par todavía  */
+  const uint32_t lat_cap = CALIB_LAT_CAP_MS / log->period_ms;
+
+  uint16_t tq_prev = 0;
+  uint8_t  ev_prev = 0, ref_prev = 0;
+
+  for (uint32_t base = 0; base < log->n; base += CALIB_CHUNK)
+  {
+    uint32_t m = log->n - base;
+    if (m > CALIB_CHUNK) m = CALIB_CHUNK;
+
+    control_batch_in_t in =
+    {
+      .s1_aceleracion = &log->s1[base],
+      .s2_aceleracion = &log->s2[base],
+      .s_freno        = &log->freno[base],
+    };
+    Control_ComputeTorqueBatch(&ctx, &in, m, scratch->tq, scratch->ev);
+
+    const uint8_t *ref = &log->ref_pct[base];
+    const uint8_t *bon = &log->brake_on[base];
+    const uint16_t *fr = &log->freno[base];
+
+    for (uint32_t i = 0; i < m; i++)
+    {
+      uint16_t t = scratch->tq[i];
+      int32_t e = (int32_t)t - (int32_t)ref[i];
+      err2 += (uint64_t)(e * e);
+      tv += (t > tq_prev) ? (uint32_t)(t - tq_prev) : (uint32_t)(tq_prev - t);
+      tq_prev = t;
+
+      faults += (scratch->ev[i] & (uint8_t)~ev_prev) & 1u;
+      ev_prev = scratch->ev[i];
+
+      brake_n    += bon[i];
+      brake_miss += bon[i] & (fr[i] <= cal->brake_adc);
+
+      /* Latencia: de la intención (cruce de CALIB_ONSET_PCT) a par > 0 */
+      if (ref_prev < CALIB_ONSET_PCT && ref[i] >= CALIB_ONSET_PCT)
+      {
+        if (pending) lat_samples += lat_cap;
+        pending = 1u;
+        pending_age = 0u;
+        onsets++;
+      }
+      ref_prev = ref[i];
+      if (pending)
+      {
+        if (t > 0u)
+        {
+          lat_samples += pending_age;
+          pending = 0u;
+        }
+        else if (++pending_age >= lat_cap)
+        {
+          lat_samples += lat_cap;
+          pending = 0u;
+        }
+      }
+    }
+  }
+  if (pending) lat_samples += lat_cap;
+
+  const float dur_s = (float)log->n * (float)log->period_ms * 0.001f;
+  out->rms_err_pct = sqrtf((float)err2 / (float)log->n);
+  out->tv_pct_s    = (float)tv / dur_s;
+  out->faults      = faults;
+  out->miss_pct    = brake_n ? 100.0f * (float)brake_miss / (float)brake_n : 0.0f;
+  out->lat_ms      = onsets ? (float)lat_samples * (float)log->period_ms / (float)onsets : 0.0f;
+
+  out->score = w->err   * out->rms_err_pct
+             + w->tv    * out->tv_pct_s * 0.01f
+             + w->fault * (float)faults * 60.0f / dur_s
+             + w->miss  * out->miss_pct
+             + w->lat   * out->lat_ms * 0.1f;
+}
@@ -0,0 +1,54 @@
+/**
+ * calib_eval.h
+ * Evaluación de una calibración de pedal sobre un registro completo.
+ *
+ * Reproduce el registro con el código de control real
+ * (Control_ComputeTorqueBatch() sobre un ctrl_ctx_t propio, por trozos que
+ * caben en caché) y resume el par resultante en métricas objetivas. Cuanto
+ * menor la puntuación, mejor.
+ */
+
+#ifndef CALIB_EVAL_H
+#define CALIB_EVAL_H
+
+#include <stdint.h>
+#include "control.h"
+#include "calib_log.h"
+
+#define CALIB_CHUNK        4096u   /* muestras por llamada al lote          */
+#define CALIB_ONSET_PCT    5u      /* intención que cuenta como pisar       */
+#define CALIB_LAT_CAP_MS   300u    /* latencia de un arranque sin respuesta */
+
+typedef struct
+{
+  float err;        /* por % RMS de error de seguimiento                   */
+  float tv;         /* por 100 %/s de variación total del par (suavidad)   */
+  float fault;      /* por disparo EV2.3 y minuto                          */
+  float miss;       /* por % de muestras de freno pisado no detectadas     */
+  float lat;        /* por 10 ms de latencia media pedal → par             */
+} calib_weights_t;
+
+extern const calib_weights_t CALIB_WEIGHTS_DEFAULT;
+
+typedef struct
+{
+  float    rms_err_pct;   /* par frente a la intención del piloto          */
+  float    tv_pct_s;      /* sum |par[i] - par[i-1]| / duración            */
+  uint32_t faults;        /* flancos de subida del latch EV2.3             */
+  float    miss_pct;      /* freno pisado con freno <= brake_adc           */
+  float    lat_ms;        /* media desde la intención hasta par > 0        */
+  float    score;
+} calib_metrics_t;
+
+/* Buffers de trabajo de un hilo (CALIB_CHUNK muestras) */
+typedef struct
+{
+  uint16_t tq[CALIB_CHUNK];
+  uint8_t  ev[CALIB_CHUNK];
+} calib_scratch_t;
+
+void  CalibEval_Run(const calib_log_t *log, const apps_cal_t *cal,
+                    const calib_weights_t *w, calib_scratch_t *scratch,
+                    calib_metrics_t *out);
+
+#endif /* CALIB_EVAL_H */
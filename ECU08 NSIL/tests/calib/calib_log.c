@@ -0,0 +1,256 @@
+/**
+ * calib_log.c
+ * Carga/guardado CSV y generador de vueltas sintéticas para ecu08_calib.
+ */
+
+#include "calib_log.h"
+#include "control.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Sensores del generador: offsets reales desplazados respecto a los nominales
+ * (APPS_CAL_DEFAULT 2050 / 1915), misma pendiente ADC/% que el mapa. */
+#define SYNTH_S1_OFFSET    2090.0f
+#define SYNTH_S2_OFFSET    1880.0f
+#define SYNTH_ADC_NOISE    6.0f       /* sigma en cuentas                   */
+#define SYNTH_BRAKE_REST   1800.0f
+#define SYNTH_BRAKE_NOISE  25.0f
+
+static int log_alloc(calib_log_t *log, uint32_t cap)
+{
+  memset(log, 0, sizeof(*log));
+  log->s1       = malloc(cap * sizeof(uint16_t));
+  log->s2       = malloc(cap * sizeof(uint16_t));
+  log->freno    = malloc(cap * sizeof(uint16_t));
+  log->ref_pct  = malloc(cap);
+  log->brake_on = malloc(cap);
+  if (!log->s1 || !log->s2 || !log->freno || !log->ref_pct || !log->brake_on)
+  {
+    CalibLog_Free(log);
+    return -1;
+  }
+  log->period_ms = 10u;
+  return 0;
+}
+
+static int log_grow(calib_log_t *log, uint32_t cap)
+{
+  uint16_t *s1 = realloc(log->s1, cap * sizeof(uint16_t));
+  if (s1) log->s1 = s1;
+  uint16_t *s2 = realloc(log->s2, cap * sizeof(uint16_t));
+  if (s2) log->s2 = s2;
+  uint16_t *fr = realloc(log->freno, cap * sizeof(uint16_t));
+  if (fr) log->freno = fr;
+  uint8_t *rf = realloc(log->ref_pct, cap);
+  if (rf) log->ref_pct = rf;
+  uint8_t *bo = realloc(log->brake_on, cap);
+  if (bo) log->brake_on = bo;
+  return (s1 && s2 && fr && rf && bo) ? 0 : -1;
+}
+
+void CalibLog_Free(calib_log_t *log)
+{
+  if (!log) return;
+  free(log->s1);
+  free(log->s2);
+  free(log->freno);
+  free(log->ref_pct);
+  free(log->brake_on);
+  memset(log, 0, sizeof(*log));
+}
+
+static uint16_t clamp_adc(float v)
+{
+  if (v < 0.0f) return 0u;
+  if (v > 4095.0f) return 4095u;
+  return (uint16_t)lrintf(v);
+}
+
+/* Intención estimada con la calibración por defecto: media de ambos sensores
+ * sin banda muerta ni recortes */
+static uint8_t ref_from_adc(uint16_t s1, uint16_t s2)
+{
+  const apps_cal_t *c = &APPS_CAL_DEFAULT;
+  float p1 = ((float)s1 - c->s1_offset_adc) / c->s1_adc_per_pct;
+  float p2 = ((float)s2 - c->s2_offset_adc) / c->s2_adc_per_pct;
+  float p = 0.5f * (p1 + p2);
+  if (p < 0.0f) p = 0.0f;
+  if (p > 100.0f) p = 100.0f;
+  return (uint8_t)lrintf(p);
+}
+
+int CalibLog_LoadCsv(calib_log_t *log, const char *path)
+{
+  if (!log || !path) return -1;
+  FILE *f = fopen(path, "r");
+  if (!f) return -1;
+  if (log_alloc(log, 4096u) != 0)
+  {
+    fclose(f);
+    return -1;
+  }
+
+  uint32_t cap = 4096u;
+  uint32_t t_prev = 0;
+  char line[256];
+  while (fgets(line, sizeof line, f))
+  {
+    unsigned t, s1, s2, fr, ref = 1000u, bon = 2u;
+    int got = sscanf(line, "%u,%u,%u,%u,%u,%u", &t, &s1, &s2, &fr, &ref, &bon);
+    if (got < 4) continue;                  /* cabecera o línea vacía      */
+
+    if (log->n == cap)
+    {
+      cap *= 2u;
+      if (log_grow(log, cap) != 0)
+      {
+        fclose(f);
+        CalibLog_Free(log);
+        return -1;
+      }
+    }
+
+    uint32_t i = log->n++;
+    log->s1[i]       = (uint16_t)(s1 > 4095u ? 4095u : s1);
+    log->s2[i]       = (uint16_t)(s2 > 4095u ? 4095u : s2);
+    log->freno[i]    = (uint16_t)(fr > 4095u ? 4095u : fr);
+    log->ref_pct[i]  = (got >= 5 && ref <= 100u) ? (uint8_t)ref
+                                                  : ref_from_adc(log->s1[i], log->s2[i]);
+    log->brake_on[i] = (got >= 6) ? (bon != 0u)
+                                  : (log->freno[i] > APPS_CAL_DEFAULT.brake_adc);
+    if (i == 1u) log->period_ms = (t > t_prev) ? (t - t_prev) : 10u;
+    t_prev = t;
+  }
+  fclose(f);
+
+  if (log->n == 0u)
+  {
+    CalibLog_Free(log);
+    return -1;
+  }
+  return 0;
+}
+
+int CalibLog_SaveCsv(const calib_log_t *log, const char *path)
+{
+  if (!log || !path) return -1;
+  FILE *f = fopen(path, "w");
+  if (!f) return -1;
+  fprintf(f, "t_ms,s1,s2,freno,ref_pct,brake_on\n");
+  for (uint32_t i = 0; i < log->n; i++)
+  {
+    fprintf(f, "%u,%u,%u,%u,%u,%u\n", (unsigned)(i * log->period_ms),
+            log->s1[i], log->s2[i], log->freno[i], log->ref_pct[i], log->brake_on[i]);
+  }
+  fclose(f);
+  return 0;
+}
+
+/* ---- Generador -------------------------------------------------------- */
+
+static uint32_t rng_next(uint32_t *s)
+{
+  /* xorshift32: reproducible entre plataformas, sin estado global */
+  uint32_t x = *s;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *s = x;
+  return x;
+}
+
+static float rng_uniform(uint32_t *s)
+{
+  return (float)(rng_next(s) >> 8) * (1.0f / 16777216.0f);
+}
+
+static float rng_gauss(uint32_t *s)
+{
+  /* Suma de 4 uniformes: suficiente para ruido de ADC */
+  float u = rng_uniform(s) + rng_uniform(s) + rng_uniform(s) + rng_uniform(s);
+  return (u - 2.0f) * 1.7320508f;
+}
+
+typedef enum
+{
+  SEG_THROTTLE = 0,   /* rampa hasta un objetivo y mantiene                */
+  SEG_LIFT,           /* suelta el acelerador                              */
+  SEG_BRAKE,          /* frena con el pie derecho (acelerador a 0)         */
+  SEG_TRAIL,          /* freno suave cerca del umbral                      */
+  SEG_LEFT_FOOT,      /* solapa freno con algo de gas                      */
+  SEG_COUNT
+} synth_seg_t;
+
+int CalibLog_Synth(calib_log_t *log, uint32_t seconds, uint32_t seed)
+{
+  if (!log || seconds == 0u) return -1;
+  const uint32_t n = seconds * 100u;
+  if (log_alloc(log, n) != 0) return -1;
+
+  uint32_t rs = seed ? seed : 0x9E3779B9u;
+  const float span1 = APPS_CAL_DEFAULT.s1_adc_per_pct;
+  const float span2 = APPS_CAL_DEFAULT.s2_adc_per_pct;
+
+  float pedal = 0.0f, brake = SYNTH_BRAKE_REST;
+  float pedal_tgt = 0.0f, brake_tgt = SYNTH_BRAKE_REST;
+  uint8_t brake_on = 0;
+  uint32_t seg_left = 0;
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    if (seg_left == 0u)
+    {
+      synth_seg_t seg = (synth_seg_t)(rng_next(&rs) % SEG_COUNT);
+      seg_left = 50u + rng_next(&rs) % 300u;           /* 0.5 .. 3.5 s   */
+      switch (seg)
+      {
+        case SEG_THROTTLE:
+          pedal_tgt = 20.0f + 80.0f * rng_uniform(&rs);
+          brake_tgt = SYNTH_BRAKE_REST;
+          brake_on = 0;
+          break;
+        case SEG_LIFT:
+          pedal_tgt = 0.0f;
+          brake_tgt = SYNTH_BRAKE_REST;
+          brake_on = 0;
+          break;
+        case SEG_BRAKE:
+          pedal_tgt = 0.0f;
+          brake_tgt = 3400.0f + 600.0f * rng_uniform(&rs);
+          brake_on = 1;
+          break;
+        case SEG_TRAIL:
+          pedal_tgt = 0.0f;
+          brake_tgt = 3050.0f + 150.0f * rng_uniform(&rs);
+          brake_on = 1;
+          break;
+        case SEG_LEFT_FOOT:
+        default:
+          pedal_tgt = 5.0f + 15.0f * rng_uniform(&rs);
+          brake_tgt = 3100.0f + 300.0f * rng_uniform(&rs);
+          brake_on = 1;
+          seg_left = 20u + rng_next(&rs) % 30u;       /* 0.2 .. 0.5 s    */
+          break;
+      }
+    }
+    seg_left--;
+
+    /* Pie: ~250 %/s pisando, ~400 %/s soltando; freno ~20000 cuentas/s */
+    float dp = pedal_tgt - pedal;
+    float step = (dp > 0.0f) ? 2.5f : 4.0f;
+    pedal += (dp > step) ? step : (dp < -step ? -step : dp);
+    float db = brake_tgt - brake;
+    brake += (db > 200.0f) ? 200.0f : (db < -200.0f ? -200.0f : db);
+
+    log->ref_pct[i]  = (uint8_t)lrintf(pedal);
+    log->brake_on[i] = brake_on;
+    log->s1[i]    = clamp_adc(SYNTH_S1_OFFSET + pedal * span1 + SYNTH_ADC_NOISE * rng_gauss(&rs));
+    log->s2[i]    = clamp_adc(SYNTH_S2_OFFSET + pedal * span2 + SYNTH_ADC_NOISE * rng_gauss(&rs));
+    log->freno[i] = clamp_adc(brake + SYNTH_BRAKE_NOISE * rng_gauss(&rs));
+  }
+  log->n = n;
+  return 0;
+}
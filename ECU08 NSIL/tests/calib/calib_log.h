@@ -0,0 +1,38 @@
+/**
+ * calib_log.h
+ * Registros de conducción para ecu08_calib: carga CSV y generador sintético.
+ *
+ * El registro se guarda en arrays separados (SoA), tal cual los consume
+ * Control_ComputeTorqueBatch(). Una muestra por ciclo de control (10 ms).
+ */
+
+#ifndef CALIB_LOG_H
+#define CALIB_LOG_H
+
+#include <stdint.h>
+
+typedef struct
+{
+  uint32_t  n;
+  uint32_t  period_ms;    /* paso entre muestras                          */
+  uint16_t *s1;           /* ADC APPS1                                    */
+  uint16_t *s2;           /* ADC APPS2                                    */
+  uint16_t *freno;        /* ADC presión de freno                         */
+  uint8_t  *ref_pct;      /* intención del piloto 0..100 (pedal real)     */
+  uint8_t  *brake_on;     /* piloto pisando el freno (0/1)                */
+} calib_log_t;
+
+/* CSV: cabecera opcional, columnas t_ms,s1,s2,freno[,ref_pct[,brake_on]].
+ * Sin ref_pct se estima con la calibración por defecto sin banda muerta ni
+ * recorte; sin brake_on, freno > UMBRAL_FRENO_APPS. Devuelve 0 si va bien. */
+int  CalibLog_LoadCsv(calib_log_t *log, const char *path);
+int  CalibLog_SaveCsv(const calib_log_t *log, const char *path);
+
+/* Vuelta sintética de seconds segundos: aceleraciones, levantadas, frenadas
+ * con y sin pie izquierdo, ruido de ADC y offsets de sensor desplazados
+ * respecto a los nominales (el optimizador los tiene que encontrar). */
+int  CalibLog_Synth(calib_log_t *log, uint32_t seconds, uint32_t seed);
+
+void CalibLog_Free(calib_log_t *log);
+
+#endif /* CALIB_LOG_H */
@@ -0,0 +1,511 @@
+/**
+ * calib_main.c
+ * ecu08_calib: barrido y optimización de la calibración del pedal (APPS).
+ *
+ * Reproduce un registro de conducción (CSV o vuelta sintética) con el código
+ * de control real para cada candidato de apps_cal_t (offsets de APPS1/APPS2,
+ * banda muerta, recortes 10/90 y umbral de freno) y ordena los candidatos por
+ * una puntuación ponderada (calib_eval.h).
+ *
+ *   1. Rejilla gruesa sobre todo el espacio.
+ *   2. Descenso por coordenadas desde los K mejores, partiendo el paso a la
+ *      mitad cada ronda hasta el paso fino.
+ *
+ * Cada ronda se reparte en el pool con robo de trabajo (calib_pool.h).
+ *
+ * Uso:
+ *   ecu08_calib [--log f.csv | --synth SEG] [--seed N] [--save-log f.csv]
+ *               [--threads N] [--coarse N] [--top K] [--w-err X] [--w-tv X]
+ *               [--w-fault X] [--w-miss X] [--w-lat X]
+ *   ecu08_calib --check     autocomprobación para CTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "control.h"
+#include "calib_log.h"
+#include "calib_eval.h"
+#include "calib_pool.h"
+
+/* ---- Espacio de búsqueda (rejilla fina) -------------------------------- */
+
+typedef enum
+{
+  DIM_S1_OFFSET = 0,
+  DIM_S2_OFFSET,
+  DIM_DEADBAND,
+  DIM_MIN_PCT,
+  DIM_MAX_PCT,
+  DIM_BRAKE_ADC,
+  DIM_COUNT
+} calib_dim_id_t;
+
+typedef struct
+{
+  const char *name;
+  float       lo;
+  float       step;
+  uint32_t    points;     /* lo + k*step, k = 0..points-1                  */
+} calib_dim_t;
+
+static const calib_dim_t DIMS[DIM_COUNT] =
+{
+  [DIM_S1_OFFSET] = { "s1_off",   1950.0f, 10.0f, 21u },   /* 1950..2150 */
+  [DIM_S2_OFFSET] = { "s2_off",   1815.0f, 10.0f, 21u },   /* 1815..2015 */
+  [DIM_DEADBAND]  = { "banda",       2.0f,  1.0f, 13u },   /* 2..14 %    */
+  [DIM_MIN_PCT]   = { "min",         0.0f,  1.0f, 21u },   /* 0..20 %    */
+  [DIM_MAX_PCT]   = { "max",        80.0f,  1.0f, 21u },   /* 80..100 %  */
+  [DIM_BRAKE_ADC] = { "freno",    2700.0f, 25.0f, 29u },   /* 2700..3400 */
+};
+
+typedef struct
+{
+  uint8_t k[DIM_COUNT];
+} calib_point_t;
+
+static float dim_value(calib_dim_id_t d, uint8_t k)
+{
+  return DIMS[d].lo + DIMS[d].step * (float)k;
+}
+
+static apps_cal_t cal_from_point(const calib_point_t *p)
+{
+  apps_cal_t c = APPS_CAL_DEFAULT;
+  c.s1_offset_adc = dim_value(DIM_S1_OFFSET, p->k[DIM_S1_OFFSET]);
+  c.s2_offset_adc = dim_value(DIM_S2_OFFSET, p->k[DIM_S2_OFFSET]);
+  c.deadband_pct  = dim_value(DIM_DEADBAND,  p->k[DIM_DEADBAND]);
+  c.min_pct       = (int32_t)dim_value(DIM_MIN_PCT, p->k[DIM_MIN_PCT]);
+  c.max_pct       = (int32_t)dim_value(DIM_MAX_PCT, p->k[DIM_MAX_PCT]);
+  c.brake_adc     = (uint16_t)dim_value(DIM_BRAKE_ADC, p->k[DIM_BRAKE_ADC]);
+  return c;
+}
+
+static uint64_t point_key(const calib_point_t *p)
+{
+  uint64_t key = 0;
+  for (uint32_t d = 0; d < DIM_COUNT; d++) key = (key << 8) | p->k[d];
+  return key;
+}
+
+/* ---- Archivo de candidatos evaluados (sin repetir) --------------------- */
+
+typedef struct
+{
+  calib_point_t   pt;
+  apps_cal_t      cal;
+  calib_metrics_t m;
+} calib_entry_t;
+
+typedef struct
+{
+  calib_entry_t *e;
+  uint32_t       n, cap;
+  uint64_t      *keys;       /* hash abierto: key+1, 0 = libre            */
+  uint32_t       hcap;       /* potencia de dos                            */
+} calib_archive_t;
+
+static int archive_seen(calib_archive_t *a, const calib_point_t *p, int insert)
+{
+  uint64_t key = point_key(p) + 1u;
+  uint32_t h = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 40) & (a->hcap - 1u);
+  while (a->keys[h] != 0u)
+  {
+    if (a->keys[h] == key) return 1;
+    h = (h + 1u) & (a->hcap - 1u);
+  }
+  if (insert) a->keys[h] = key;
+  return 0;
+}
+
+static int archive_reserve(calib_archive_t *a, uint32_t extra)
+{
+  if (a->n + extra > a->cap)
+  {
+    uint32_t cap = a->cap ? a->cap : 1024u;
+    while (cap < a->n + extra) cap *= 2u;
+    calib_entry_t *e = realloc(a->e, cap * sizeof(*e));
+    if (!e) return -1;
+    a->e = e;
+    a->cap = cap;
+  }
+  /* Carga del hash <= 1/2 */
+  if ((a->n + extra) * 2u > a->hcap)
+  {
+    uint32_t hcap = a->hcap ? a->hcap : 2048u;
+    while ((a->n + extra) * 2u > hcap) hcap *= 2u;
+    uint64_t *keys = calloc(hcap, sizeof(uint64_t));
+    if (!keys) return -1;
+    free(a->keys);
+    a->keys = keys;
+    a->hcap = hcap;
+    for (uint32_t i = 0; i < a->n; i++) archive_seen(a, &a->e[i].pt, 1);
+  }
+  return 0;
+}
+
+static void archive_free(calib_archive_t *a)
+{
+  free(a->e);
+  free(a->keys);
+  memset(a, 0, sizeof(*a));
+}
+
+/* ---- Evaluación de una ronda ------------------------------------------- */
+
+typedef struct
+{
+  const calib_log_t     *log;
+  const calib_weights_t *w;
+  calib_entry_t         *e;
+  calib_scratch_t       *scratch;   /* uno por hilo                         */
+} calib_job_t;
+
+static void eval_range(void *arg, uint32_t worker, uint32_t lo, uint32_t hi)
+{
+  calib_job_t *job = arg;
+  for (uint32_t i = lo; i < hi; i++)
+  {
+    CalibEval_Run(job->log, &job->e[i].cal, job->w, &job->scratch[worker], &job->e[i].m);
+  }
+}
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef struct
+{
+  const calib_log_t     *log;
+  calib_weights_t        w;
+  calib_pool_t          *pool;
+  calib_scratch_t       *scratch;
+  calib_archive_t        ar;
+  uint64_t               steps;
+  double                 busy_s;
+} calib_run_t;
+
+/* Evalúa las entradas [first, ar.n) en el pool */
+static void run_round(calib_run_t *r, uint32_t first)
+{
+  uint32_t n = r->ar.n - first;
+  if (n == 0u) return;
+  calib_job_t job = { r->log, &r->w, &r->ar.e[first], r->scratch };
+
+  /* Grano: ~8 rangos por hilo para que haya qué robar al final */
+  uint32_t grain = n / (CalibPool_Workers(r->pool) * 8u);
+  if (grain == 0u) grain = 1u;
+
+  double t0 = now_s();
+  CalibPool_Run(r->pool, n, grain, eval_range, &job);
+  r->busy_s += now_s() - t0;
+  r->steps  += (uint64_t)n * r->log->n;
+}
+
+static int add_point(calib_run_t *r, const calib_point_t *p)
+{
+  if (archive_reserve(&r->ar, 1u) != 0) return -1;
+  if (archive_seen(&r->ar, p, 1)) return 0;
+  calib_entry_t *e = &r->ar.e[r->ar.n++];
+  e->pt = *p;
+  e->cal = cal_from_point(p);
+  memset(&e->m, 0, sizeof(e->m));
+  return 1;
+}
+
+/* Rejilla gruesa de per_dim puntos por dimensión (extremos incluidos) */
+static void coarse_grid(calib_run_t *r, uint32_t per_dim)
+{
+  if (per_dim < 2u) per_dim = 2u;
+  uint32_t total = 1u;
+  for (uint32_t d = 0; d < DIM_COUNT; d++) total *= per_dim;
+
+  for (uint32_t idx = 0; idx < total; idx++)
+  {
+    calib_point_t p;
+    uint32_t rem = idx;
+    for (uint32_t d = 0; d < DIM_COUNT; d++)
+    {
+      uint32_t j = rem % per_dim;
+      rem /= per_dim;
+      p.k[d] = (uint8_t)((j * (DIMS[d].points - 1u)) / (per_dim - 1u));
+    }
+    add_point(r, &p);
+  }
+}
+
+static int cmp_entry(const void *a, const void *b)
+{
+  const calib_entry_t *x = a, *y = b;
+  if (x->m.score < y->m.score) return -1;
+  if (x->m.score > y->m.score) return 1;
+  uint64_t kx = point_key(&x->pt), ky = point_key(&y->pt);
+  return (kx < ky) ? -1 : (kx > ky);
+}
+
+/* Descenso por coordenadas: vecinos ±paso de los top mejores en cada eje;
+ * el paso empieza en la separación de la rejilla gruesa y se parte a la
+ * mitad cuando una ronda no mejora. */
+static uint32_t refine(calib_run_t *r, uint32_t per_dim, uint32_t top)
+{
+  uint32_t step = 0, rounds = 0;
+  for (uint32_t d = 0; d < DIM_COUNT; d++)
+  {
+    uint32_t s = (DIMS[d].points - 1u) / (per_dim - 1u) / 2u;
+    if (s > step) step = s;
+  }
+  if (step == 0u) step = 1u;
+
+  float best = r->ar.e[0].m.score;
+  calib_point_t *seed = malloc(top * sizeof(*seed));
+  if (!seed) return 0;
+
+  for (;;)
+  {
+    uint32_t k_top = (r->ar.n < top) ? r->ar.n : top;
+    for (uint32_t t = 0; t < k_top; t++) seed[t] = r->ar.e[t].pt;
+
+    uint32_t first = r->ar.n;
+    for (uint32_t t = 0; t < k_top; t++)
+    {
+      for (uint32_t d = 0; d < DIM_COUNT; d++)
+      {
+        for (int sgn = -1; sgn <= 1; sgn += 2)
+        {
+          int32_t k = (int32_t)seed[t].k[d] + sgn * (int32_t)step;
+          if (k < 0 || k >= (int32_t)DIMS[d].points) continue;
+          calib_point_t p = seed[t];
+          p.k[d] = (uint8_t)k;
+          add_point(r, &p);
+        }
+      }
+    }
+    run_round(r, first);
+    qsort(r->ar.e, r->ar.n, sizeof(calib_entry_t), cmp_entry);
+    rounds++;
+
+    if (r->ar.e[0].m.score < best)
+    {
+      best = r->ar.e[0].m.score;
+      continue;                       /* mismo paso mientras mejore      */
+    }
+    if (step == 1u) break;
+    step /= 2u;
+  }
+  free(seed);
+  return rounds;
+}
+
+/* ---- Salida ------------------------------------------------------------ */
+
+static void print_header(void)
+{
+  printf("  %4s %8s %7s %7s %5s %4s %4s %6s | %6s %7s %6s %6s %6s\n",
+         "#", "punt.", "s1_off", "s2_off", "banda", "min", "max", "freno",
+         "rms%", "tv%/s", "EV2.3", "miss%", "lat ms");
+}
+
+static void print_entry(const char *tag, const apps_cal_t *c, const calib_metrics_t *m)
+{
+  printf("  %4s %8.3f %7.0f %7.0f %5.1f %4d %4d %6u | %6.2f %7.1f %6u %6.2f %6.1f\n",
+         tag, m->score, c->s1_offset_adc, c->s2_offset_adc, c->deadband_pct,
+         (int)c->min_pct, (int)c->max_pct, c->brake_adc,
+         m->rms_err_pct, m->tv_pct_s, m->faults, m->miss_pct, m->lat_ms);
+}
+
+/* ---- Programa ---------------------------------------------------------- */
+
+typedef struct
+{
+  const char     *log_path;
+  const char     *save_path;
+  uint32_t        synth_s;
+  uint32_t        seed;
+  uint32_t        threads;
+  uint32_t        coarse;
+  uint32_t        top;
+  int             check;
+  calib_weights_t w;
+} calib_opts_t;
+
+static void print_usage(const char *prog)
+{
+  printf("Uso: %s [opciones]\n", prog);
+  printf("  --log FICHERO.csv   registro t_ms,s1,s2,freno[,ref_pct[,brake_on]]\n");
+  printf("  --synth SEG         vuelta sintética de SEG segundos (defecto 300)\n");
+  printf("  --seed N            semilla del generador sintético\n");
+  printf("  --save-log F.csv    guarda el registro usado\n");
+  printf("  --threads N         hilos del pool (0 = uno por núcleo)\n");
+  printf("  --coarse N          puntos por eje de la rejilla gruesa (defecto 4)\n");
+  printf("  --top K             semillas del refinado y filas mostradas (defecto 10)\n");
+  printf("  --w-err/--w-tv/--w-fault/--w-miss/--w-lat X   pesos de la puntuación\n");
+  printf("  --check             autocomprobación (CTest)\n");
+}
+
+static int parse_args(int argc, char **argv, calib_opts_t *o)
+{
+  memset(o, 0, sizeof(*o));
+  o->synth_s = 300u;
+  o->seed    = 1u;
+  o->coarse  = 4u;
+  o->top     = 10u;
+  o->w       = CALIB_WEIGHTS_DEFAULT;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *a = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if      (strcmp(a, "--check") == 0) { o->check = 1; continue; }
+    else if (strcmp(a, "--help") == 0)  { print_usage(argv[0]); exit(0); }
+    if (!v) { print_usage(argv[0]); return -1; }
+    i++;
+    if      (strcmp(a, "--log") == 0)      o->log_path = v;
+    else if (strcmp(a, "--save-log") == 0) o->save_path = v;
+    else if (strcmp(a, "--synth") == 0)    o->synth_s = (uint32_t)strtoul(v, NULL, 0);
+    else if (strcmp(a, "--seed") == 0)     o->seed = (uint32_t)strtoul(v, NULL, 0);
+    else if (strcmp(a, "--threads") == 0)  o->threads = (uint32_t)strtoul(v, NULL, 0);
+    else if (strcmp(a, "--coarse") == 0)   o->coarse = (uint32_t)strtoul(v, NULL, 0);
+    else if (strcmp(a, "--top") == 0)      o->top = (uint32_t)strtoul(v, NULL, 0);
+    else if (strcmp(a, "--w-err") == 0)    o->w.err = strtof(v, NULL);
+    else if (strcmp(a, "--w-tv") == 0)     o->w.tv = strtof(v, NULL);
+    else if (strcmp(a, "--w-fault") == 0)  o->w.fault = strtof(v, NULL);
+    else if (strcmp(a, "--w-miss") == 0)   o->w.miss = strtof(v, NULL);
+    else if (strcmp(a, "--w-lat") == 0)    o->w.lat = strtof(v, NULL);
+    else { print_usage(argv[0]); return -1; }
+  }
+  if (o->coarse < 2u) o->coarse = 2u;
+  if (o->top == 0u) o->top = 1u;
+  return 0;
+}
+
+static int check_failures = 0;
+
+static void check(int ok, const char *what)
+{
+  printf("[CALIB] %s %s\n", ok ? "✅" : "❌", what);
+  if (!ok) check_failures++;
+}
+
+int main(int argc, char **argv)
+{
+  calib_opts_t o;
+  if (parse_args(argc, argv, &o) != 0) return 2;
+
+  if (o.check)
+  {
+    /* Registro corto y rejilla pequeña: cabe en el tiempo de CTest */
+    o.log_path = NULL;
+    o.synth_s  = 120u;
+    o.coarse   = 3u;
+    o.top      = 4u;
+    if (o.threads == 0u) o.threads = 4u;   /* robo de trabajo aun con 1 núcleo */
+  }
+
+  calib_log_t log;
+  int rc = o.log_path ? CalibLog_LoadCsv(&log, o.log_path)
+                      : CalibLog_Synth(&log, o.synth_s, o.seed);
+  if (rc != 0)
+  {
+    fprintf(stderr, "ecu08_calib: no se pudo %s el registro\n", o.log_path ? "leer" : "generar");
+    return 2;
+  }
+  if (o.save_path && CalibLog_SaveCsv(&log, o.save_path) != 0)
+  {
+    fprintf(stderr, "ecu08_calib: no se pudo escribir %s\n", o.save_path);
+  }
+
+  calib_run_t r;
+  memset(&r, 0, sizeof(r));
+  r.log  = &log;
+  r.w    = o.w;
+  r.pool = CalibPool_Create(o.threads);
+  if (!r.pool)
+  {
+    fprintf(stderr, "ecu08_calib: no se pudo crear el pool\n");
+    CalibLog_Free(&log);
+    return 2;
+  }
+  uint32_t workers = CalibPool_Workers(r.pool);
+  r.scratch = malloc(workers * sizeof(calib_scratch_t));
+
+  printf("[CALIB] registro: %u muestras (%.0f s) %s, %u hilos\n", log.n,
+         (double)log.n * log.period_ms * 1e-3, o.log_path ? o.log_path : "sintético", workers);
+
+  /* Referencia: calibración actual del coche */
+  calib_metrics_t m_def;
+  CalibEval_Run(&log, &APPS_CAL_DEFAULT, &r.w, &r.scratch[0], &m_def);
+
+  coarse_grid(&r, o.coarse);
+  uint32_t n_coarse = r.ar.n;
+  run_round(&r, 0u);
+  qsort(r.ar.e, r.ar.n, sizeof(calib_entry_t), cmp_entry);
+  uint32_t rounds = refine(&r, o.coarse, o.top);
+
+  calib_pool_stats_t ps;
+  CalibPool_GetStats(r.pool, &ps);
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t cores = (online > 0 && (uint32_t)online < workers) ? (uint32_t)online : workers;
+  double rate = (double)r.steps / r.busy_s / (double)cores;
+  printf("[CALIB] %u candidatos (%u rejilla + %u en %u rondas de refinado), %.1f M pasos/s por núcleo\n",
+         r.ar.n, n_coarse, r.ar.n - n_coarse, rounds, rate * 1e-6);
+  printf("[CALIB] pool: %llu rangos, %llu particiones, %llu robos\n",
+         (unsigned long long)ps.ranges, (unsigned long long)ps.splits,
+         (unsigned long long)ps.steals);
+
+  print_header();
+  print_entry("def", &APPS_CAL_DEFAULT, &m_def);
+  uint32_t shown = (r.ar.n < o.top) ? r.ar.n : o.top;
+  for (uint32_t i = 0; i < shown; i++)
+  {
+    char tag[12];
+    snprintf(tag, sizeof tag, "%u", i + 1u);
+    print_entry(tag, &r.ar.e[i].cal, &r.ar.e[i].m);
+  }
+
+  if (o.check)
+  {
+    /* Mismos candidatos en un solo hilo, sin pool: resultados idénticos */
+    uint32_t mismatches = 0;
+    double t0 = now_s();
+    for (uint32_t i = 0; i < r.ar.n; i++)
+    {
+      calib_metrics_t m;
+      CalibEval_Run(&log, &r.ar.e[i].cal, &r.w, &r.scratch[0], &m);
+      if (memcmp(&m, &r.ar.e[i].m, sizeof(m)) != 0) mismatches++;
+    }
+    double t_seq = now_s() - t0;
+    double seq_rate = (double)r.ar.n * log.n / t_seq;
+    printf("[CALIB] un hilo: %.1f M pasos/s, %u discrepancias\n", seq_rate * 1e-6, mismatches);
+
+    check(mismatches == 0u, "pool con robo de trabajo idéntico a la evaluación secuencial");
+    check(seq_rate >= 1e6, "más de 1 M pasos de control por segundo y núcleo");
+    check(r.ar.e[0].m.score <= m_def.score, "mejor candidato no peor que la calibración actual");
+
+    /* Ida y vuelta por CSV: el registro leído da las mismas métricas */
+    calib_log_t back;
+    calib_metrics_t m_back;
+    const char *tmp = "calib_check_log.csv";
+    int csv_ok = (CalibLog_SaveCsv(&log, tmp) == 0) && (CalibLog_LoadCsv(&back, tmp) == 0);
+    if (csv_ok)
+    {
+      CalibEval_Run(&back, &APPS_CAL_DEFAULT, &r.w, &r.scratch[0], &m_back);
+      csv_ok = (back.n == log.n) && (back.period_ms == log.period_ms) &&
+               (memcmp(&m_back, &m_def, sizeof(m_def)) == 0);
+      CalibLog_Free(&back);
+    }
+    check(csv_ok, "registro guardado y releído en CSV con métricas idénticas");
+    check(rounds > 0u, "refinado ejecutado");
+  }
+
+  CalibPool_Destroy(r.pool);
+  free(r.scratch);
+  archive_free(&r.ar);
+  CalibLog_Free(&log);
+  return check_failures ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * calib_pool.c
+ * Pool de hilos con robo de trabajo para ecu08_calib (ver calib_pool.h).
+ *
+ * Deque por hilo protegida por un mutex propio: el dueño empuja y saca por
+ * abajo, los ladrones sacan por arriba. Los rangos son gruesos (decenas de
+ * candidatos, cada uno un registro entero), así que el cerrojo no se nota y
+ * no hace falta una deque sin cerrojos tipo Chase-Lev.
+ */
+
+#define _GNU_SOURCE
+#include "calib_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Cada partición deja la mitad alta en la deque: con rangos de 32 bits no
+ * se acumulan más de 32 niveles por dueño. */
+#define DEQUE_CAP  64u
+
+typedef struct
+{
+  uint32_t lo, hi;
+} range_t;
+
+typedef struct
+{
+  pthread_mutex_t mtx;
+  range_t         slot[DEQUE_CAP];
+  uint32_t        top;       /* siguiente a robar (más antiguo)          */
+  uint32_t        bottom;    /* siguiente hueco libre del dueño          */
+  calib_pool_stats_t stats;
+} deque_t;
+
+typedef struct
+{
+  struct calib_pool *pool;
+  uint32_t           index;
+} worker_arg_t;
+
+struct calib_pool
+{
+  uint32_t        workers;
+  pthread_t       th[CALIB_POOL_MAX_WORKERS];
+  worker_arg_t    warg[CALIB_POOL_MAX_WORKERS];
+  deque_t         dq[CALIB_POOL_MAX_WORKERS];
+
+  pthread_mutex_t mtx;
+  pthread_cond_t  start_cv;
+  pthread_cond_t  done_cv;
+  uint32_t        generation;
+  uint32_t        active;
+  int             stop;
+
+  /* Ronda en curso */
+  calib_pool_fn_t fn;
+  void           *arg;
+  uint32_t        grain;
+  atomic_uint     pending;   /* índices sin terminar                     */
+};
+
+static int push_bottom(deque_t *d, range_t r)
+{
+  int ok = 0;
+  pthread_mutex_lock(&d->mtx);
+  if (d->bottom - d->top < DEQUE_CAP)
+  {
+    d->slot[d->bottom % DEQUE_CAP] = r;
+    d->bottom++;
+    ok = 1;
+  }
+  pthread_mutex_unlock(&d->mtx);
+  return ok;
+}
+
+static int pop_bottom(deque_t *d, range_t *r)
+{
+  int ok = 0;
+  pthread_mutex_lock(&d->mtx);
+  if (d->bottom != d->top)
+  {
+    d->bottom--;
+    *r = d->slot[d->bottom % DEQUE_CAP];
+    ok = 1;
+  }
+  pthread_mutex_unlock(&d->mtx);
+  return ok;
+}
+
+static int pop_top(deque_t *d, range_t *r)
+{
+  int ok = 0;
+  pthread_mutex_lock(&d->mtx);
+  if (d->bottom != d->top)
+  {
+    *r = d->slot[d->top % DEQUE_CAP];
+    d->top++;
+    ok = 1;
+  }
+  pthread_mutex_unlock(&d->mtx);
+  return ok;
+}
+
+static int steal(calib_pool_t *p, uint32_t self, range_t *r)
+{
+  for (uint32_t k = 1; k < p->workers; k++)
+  {
+    uint32_t victim = (self + k) % p->workers;
+    if (pop_top(&p->dq[victim], r)) return 1;
+  }
+  return 0;
+}
+
+static void run_round(calib_pool_t *p, uint32_t self)
+{
+  deque_t *own = &p->dq[self];
+  range_t r;
+
+  while (atomic_load_explicit(&p->pending, memory_order_acquire) != 0u)
+  {
+    if (!pop_bottom(own, &r))
+    {
+      if (!steal(p, self, &r))
+      {
+        sched_yield();          /* otro hilo aún termina su último rango */
+        continue;
+      }
+      own->stats.steals++;
+    }
+
+    /* Parte lo grande y deja la mitad alta a disposición de los ladrones */
+    while (r.hi - r.lo > p->grain)
+    {
+      uint32_t mid = r.lo + (r.hi - r.lo) / 2u;
+      if (!push_bottom(own, (range_t){ mid, r.hi })) break;
+      own->stats.splits++;
+      r.hi = mid;
+    }
+
+    p->fn(p->arg, self, r.lo, r.hi);
+    own->stats.ranges++;
+    atomic_fetch_sub_explicit(&p->pending, r.hi - r.lo, memory_order_release);
+  }
+}
+
+static void *worker_main(void *argp)
+{
+  worker_arg_t *wa = argp;
+  calib_pool_t *p = wa->pool;
+  uint32_t seen = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&p->mtx);
+    while (!p->stop && p->generation == seen) pthread_cond_wait(&p->start_cv, &p->mtx);
+    if (p->stop)
+    {
+      pthread_mutex_unlock(&p->mtx);
+      return NULL;
+    }
+    seen = p->generation;
+    pthread_mutex_unlock(&p->mtx);
+
+    run_round(p, wa->index);
+
+    pthread_mutex_lock(&p->mtx);
+    if (--p->active == 0u) pthread_cond_signal(&p->done_cv);
+    pthread_mutex_unlock(&p->mtx);
+  }
+}
+
+calib_pool_t *CalibPool_Create(uint32_t workers)
+{
+  if (workers == 0u)
+  {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = (cores > 0) ? (uint32_t)cores : 1u;
+  }
+  if (workers > CALIB_POOL_MAX_WORKERS) workers = CALIB_POOL_MAX_WORKERS;
+
+  calib_pool_t *p = calloc(1, sizeof(*p));
+  if (!p) return NULL;
+  pthread_mutex_init(&p->mtx, NULL);
+  pthread_cond_init(&p->start_cv, NULL);
+  pthread_cond_init(&p->done_cv, NULL);
+  atomic_init(&p->pending, 0u);
+
+  for (uint32_t w = 0; w < CALIB_POOL_MAX_WORKERS; w++) pthread_mutex_init(&p->dq[w].mtx, NULL);
+
+  for (uint32_t w = 0; w < workers; w++)
+  {
+    p->warg[w].pool = p;
+    p->warg[w].index = w;
+    if (pthread_create(&p->th[w], NULL, worker_main, &p->warg[w]) != 0) break;
+    p->workers++;
+  }
+  if (p->workers == 0u)
+  {
+    CalibPool_Destroy(p);
+    return NULL;
+  }
+  return p;
+}
+
+void CalibPool_Destroy(calib_pool_t *p)
+{
+  if (!p) return;
+  pthread_mutex_lock(&p->mtx);
+  p->stop = 1;
+  pthread_cond_broadcast(&p->start_cv);
+  pthread_mutex_unlock(&p->mtx);
+  for (uint32_t w = 0; w < p->workers; w++) pthread_join(p->th[w], NULL);
+  for (uint32_t w = 0; w < CALIB_POOL_MAX_WORKERS; w++) pthread_mutex_destroy(&p->dq[w].mtx);
+  pthread_cond_destroy(&p->start_cv);
+  pthread_cond_destroy(&p->done_cv);
+  pthread_mutex_destroy(&p->mtx);
+  free(p);
+}
+
+uint32_t CalibPool_Workers(const calib_pool_t *p)
+{
+  return p ? p->workers : 0u;
+}
+
+void CalibPool_Run(calib_pool_t *p, uint32_t n, uint32_t grain,
+                   calib_pool_fn_t fn, void *arg)
+{
+  if (!p || !fn || n == 0u) return;
+
+  p->fn = fn;
+  p->arg = arg;
+  p->grain = grain ? grain : 1u;
+
+  /* Reparto inicial contiguo: sin robos si todos los rangos cuestan igual */
+  uint32_t w_n = p->workers;
+  for (uint32_t w = 0; w < w_n; w++)
+  {
+    uint32_t lo = (uint32_t)(((uint64_t)n * w) / w_n);
+    uint32_t hi = (uint32_t)(((uint64_t)n * (w + 1u)) / w_n);
+    p->dq[w].top = p->dq[w].bottom = 0u;
+    if (hi > lo) push_bottom(&p->dq[w], (range_t){ lo, hi });
+  }
+  atomic_store_explicit(&p->pending, n, memory_order_release);
+
+  pthread_mutex_lock(&p->mtx);
+  p->active = w_n;
+  p->generation++;
+  pthread_cond_broadcast(&p->start_cv);
+  while (p->active != 0u) pthread_cond_wait(&p->done_cv, &p->mtx);
+  pthread_mutex_unlock(&p->mtx);
+}
+
+void CalibPool_GetStats(const calib_pool_t *p, calib_pool_stats_t *out)
+{
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  if (!p) return;
+  for (uint32_t w = 0; w < p->workers; w++)
+  {
+    out->ranges += p->dq[w].stats.ranges;
+    out->splits += p->dq[w].stats.splits;
+    out->steals += p->dq[w].stats.steals;
+  }
+}
@@ -0,0 +1,45 @@
+/**
+ * calib_pool.h
+ * Pool de hilos con robo de trabajo (work stealing) para ecu08_calib.
+ *
+ * Cada trabajo es un rango de índices [0, n). Cada hilo empieza con su
+ * porción en su propia deque; la parte baja la consume él (LIFO, partiendo
+ * el rango a la mitad mientras supere el grano) y, cuando se queda sin nada,
+ * roba el rango más antiguo (FIFO) de otro hilo. Así un candidato caro no
+ * deja a los demás núcleos parados al final de cada ronda.
+ *
+ * Los hilos se crean una vez y esperan entre rondas; la función de trabajo
+ * recibe el índice del hilo para usar buffers propios sin cerrojos.
+ */
+
+#ifndef CALIB_POOL_H
+#define CALIB_POOL_H
+
+#include <stdint.h>
+
+#define CALIB_POOL_MAX_WORKERS  64u
+
+typedef void (*calib_pool_fn_t)(void *arg, uint32_t worker, uint32_t lo, uint32_t hi);
+
+typedef struct calib_pool calib_pool_t;
+
+typedef struct
+{
+  uint64_t ranges;     /* rangos ejecutados                                */
+  uint64_t splits;     /* rangos partidos por su dueño                     */
+  uint64_t steals;     /* rangos robados a otro hilo                       */
+} calib_pool_stats_t;
+
+/* workers = 0 → un hilo por núcleo en línea. NULL si falla. */
+calib_pool_t *CalibPool_Create(uint32_t workers);
+void          CalibPool_Destroy(calib_pool_t *pool);
+uint32_t      CalibPool_Workers(const calib_pool_t *pool);
+
+/* Ejecuta fn sobre [0, n) en rangos de como mucho grain índices y vuelve
+ * cuando todos han terminado. Llamar desde un solo hilo. */
+void          CalibPool_Run(calib_pool_t *pool, uint32_t n, uint32_t grain,
+                            calib_pool_fn_t fn, void *arg);
+
+void          CalibPool_GetStats(const calib_pool_t *pool, calib_pool_stats_t *out);
+
+#endif /* CALIB_POOL_H */
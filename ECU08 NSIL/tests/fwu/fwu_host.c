@@ -0,0 +1,193 @@
+/**
+ * fwu_host.c
+ * Cargador de imágenes: cliente del protocolo de fwu.h.
+ */
+
+#include "fwu_host.h"
+#include "fwu.h"
+#include "sha256.h"
+#include <string.h>
+
+#define CONNECT_TIMEOUT_US   300000u
+#define START_TIMEOUT_US   20000000u   /* 5 sectores de borrado con margen   */
+#define ACK_TIMEOUT_US       300000u   /* sin crédito ni ack: resincronizar  */
+#define VERIFY_TIMEOUT_US   5000000u
+#define MAX_RESYNCS              16u
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Espera la respuesta a cmd; descarta acks atrasados y otras respuestas */
+static int wait_rsp(const fwu_link_t *lk, uint8_t cmd, uint8_t *r, uint32_t timeout_us)
+{
+  const uint32_t t0 = lk->now_us(lk->ctx);
+  for (;;)
+  {
+    const uint32_t el = lk->now_us(lk->ctx) - t0;
+    if (el >= timeout_us) return 0;
+    uint8_t n = 0;
+    if (!lk->recv(lk->ctx, r, &n, timeout_us - el)) return 0;
+    if (n >= 2u && r[0] == (uint8_t)(cmd | 0x80u)) return 1;
+  }
+}
+
+static int command(const fwu_link_t *lk, const uint8_t *q, uint8_t n, uint8_t *r, uint32_t timeout_us)
+{
+  uint8_t f[FWU_FRAME_MAX];
+  const uint8_t len = Fwu_DlcToLen(Fwu_LenToDlc(n));
+  memset(f, 0xCC, len);
+  memcpy(f, q, n);
+  if (lk->send(lk->ctx, f, len) != 0) return 0;
+  return wait_rsp(lk, q[0], r, timeout_us);
+}
+
+/* Mayor carga útil que cabe en una trama FD válida (2 bytes de cabecera) */
+static uint32_t fd_payload(uint32_t want)
+{
+  uint8_t dlc = Fwu_LenToDlc((uint8_t)(want + 2u));
+  while (Fwu_DlcToLen(dlc) > want + 2u) dlc--;
+  return Fwu_DlcToLen(dlc) - 2u;
+}
+
+int FwuHost_Upload(const fwu_link_t *lk, const uint8_t *img, uint32_t size,
+                   int reset, fwu_report_t *rep)
+{
+  memset(rep, 0, sizeof(*rep));
+  rep->size = size;
+  rep->status = FWU_ERR_STATE;
+  const uint32_t t_begin = lk->now_us(lk->ctx);
+  uint8_t r[FWU_FRAME_MAX];
+
+  const uint8_t conn = FWU_CMD_CONNECT;
+  int ok = 0;
+  for (uint32_t i = 0; i < 3u && !ok; i++) ok = command(lk, &conn, 1u, r, CONNECT_TIMEOUT_US);
+  if (!ok || r[1] != FWU_OK) return -1;
+  if (size == 0u || size > rd32(&r[5]))
+  {
+    rep->status = FWU_ERR_RANGE;
+    return -1;
+  }
+
+  uint8_t start[10u + SHA256_DIGEST_LEN];
+  sha256_ctx_t c;
+  start[0] = FWU_CMD_START;
+  start[1] = 0u;
+  wr32(&start[2], size);
+  wr32(&start[6], Fwu_Crc32(0u, img, size));
+  Sha256_Init(&c);
+  Sha256_Update(&c, img, size);
+  Sha256_Final(&c, &start[10]);
+
+  uint32_t pos = 0, limit = 0, t_stream0 = 0;
+  uint8_t seq = 0;
+  int need_start = 1;
+
+  for (;;)
+  {
+    if (need_start)
+    {
+      if (rep->resyncs > MAX_RESYNCS) return -1;
+      const uint32_t t0 = lk->now_us(lk->ctx);
+      if (!command(lk, start, sizeof(start), r, START_TIMEOUT_US))
+      {
+        rep->resyncs++;
+        continue;
+      }
+      if (r[1] != FWU_OK)
+      {
+        rep->status = r[1];
+        return -1;
+      }
+      pos   = rd32(&r[2]);
+      limit = rd32(&r[10]);
+      if (pos > size) return -1;
+      if (pos > 0u && rd32(&r[6]) != Fwu_Crc32(0u, img, pos))
+      {
+        /* Lo que hay en flash no es el principio de este fichero */
+        start[1] = FWU_START_FORCE;
+        rep->forced = 1u;
+        continue;
+      }
+      start[1] = 0u;
+      seq = 0;
+      need_start = 0;
+      if (t_stream0 == 0u)
+      {
+        rep->t_start_us = lk->now_us(lk->ctx) - t0;
+        rep->resumed_at = pos;
+        t_stream0 = lk->now_us(lk->ctx);
+      }
+      if (pos == size) break;
+    }
+
+    /* Una trama completa (o la última) si el crédito llega; si no, ack */
+    const uint32_t want = (size - pos < FWU_FRAME_MAX - 2u) ? size - pos : FWU_FRAME_MAX - 2u;
+    const uint32_t chunk = fd_payload(want);
+    const int can_send = pos < size && pos + chunk <= limit;
+    uint8_t n = 0;
+    if (lk->recv(lk->ctx, r, &n, can_send ? 0u : ACK_TIMEOUT_US))
+    {
+      if (n < 11u || r[0] != (FWU_CMD_DATA | 0x80u)) continue;
+      const uint32_t next = rd32(&r[3]);
+      if (r[1] == FWU_OK)
+      {
+        if (rd32(&r[7]) > limit) limit = rd32(&r[7]);
+        if (next == size) break;
+      }
+      else if (r[1] == FWU_ERR_SEQ)
+      {
+        rep->seq_errors++;
+        pos   = next;
+        seq   = r[2];
+        limit = rd32(&r[7]);
+      }
+      else
+      {
+        rep->resyncs++;                      /* la ECU perdió la sesión */
+        need_start = 1;
+      }
+      continue;
+    }
+    if (!can_send)
+    {
+      rep->resyncs++;
+      need_start = 1;
+      continue;
+    }
+
+    uint8_t f[FWU_FRAME_MAX];
+    f[0] = FWU_CMD_DATA;
+    f[1] = seq;
+    memcpy(&f[2], &img[pos], chunk);
+    if (lk->send(lk->ctx, f, (uint8_t)(chunk + 2u)) != 0) return -1;
+    pos += chunk;
+    seq++;
+    rep->frames++;
+  }
+  rep->t_stream_us = lk->now_us(lk->ctx) - t_stream0;
+
+  const uint32_t t_v = lk->now_us(lk->ctx);
+  const uint8_t verify = FWU_CMD_VERIFY;
+  if (!command(lk, &verify, 1u, r, VERIFY_TIMEOUT_US)) return -1;
+  rep->t_verify_us = lk->now_us(lk->ctx) - t_v;
+  rep->status = r[1];
+  if (r[1] != FWU_OK) return -1;
+
+  if (reset)
+  {
+    const uint8_t rst = FWU_CMD_RESET;
+    (void)command(lk, &rst, 1u, r, CONNECT_TIMEOUT_US);
+  }
+  rep->t_total_us = lk->now_us(lk->ctx) - t_begin;
+  return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * fwu_host.h
+ * Lado PC del protocolo de actualización por CAN-FD (Core/Inc/fwu.h).
+ *
+ * El cargador no sabe por dónde salen las tramas: recibe un fwu_link_t con
+ * envío, recepción con timeout y reloj. ecu08_fwu lo conecta a SocketCAN o
+ * al bus simulado (fwu_sim.h), así el mismo código se prueba en el PC y se
+ * usa en el coche.
+ */
+
+#ifndef FWU_HOST_H
+#define FWU_HOST_H
+
+#include <stdint.h>
+
+typedef struct
+{
+  /* Trama hacia la ECU (FWU_CMD_ID). len es una longitud FD válida.
+   * Bloquea mientras la cola de transmisión esté llena. 0 = enviada. */
+  int      (*send)(void *ctx, const uint8_t *data, uint8_t len);
+  /* Siguiente trama de la ECU (FWU_RSP_ID). 1 = recibida, 0 = timeout. */
+  int      (*recv)(void *ctx, uint8_t *data, uint8_t *len, uint32_t timeout_us);
+  uint32_t (*now_us)(void *ctx);
+  void     *ctx;
+} fwu_link_t;
+
+typedef struct
+{
+  int      status;         /* FWU_OK o el último error                     */
+  uint32_t size;
+  uint32_t resumed_at;     /* 0 = desde el principio                       */
+  uint32_t frames;         /* tramas DATA enviadas (con reenvíos)          */
+  uint32_t seq_errors;     /* NAK por trama perdida                        */
+  uint32_t resyncs;        /* START repetidos (timeout, ECU reiniciada)    */
+  uint8_t  forced;         /* prefijo en flash distinto: borrado forzado   */
+  uint32_t t_start_us;     /* START → respuesta (borrado incluido)         */
+  uint32_t t_stream_us;    /* datos                                        */
+  uint32_t t_verify_us;
+  uint32_t t_total_us;
+} fwu_report_t;
+
+/* CONNECT, START (reanuda si la ECU ya tiene parte de esta imagen), DATA
+ * con ventana de crédito, VERIFY y, si reset, RESET. 0 = imagen
+ * verificada en la ECU. */
+int FwuHost_Upload(const fwu_link_t *lk, const uint8_t *img, uint32_t size,
+                   int reset, fwu_report_t *rep);
+
+#endif /* FWU_HOST_H */
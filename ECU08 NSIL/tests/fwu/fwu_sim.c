@@ -0,0 +1,210 @@
+/**
+ * fwu_sim.c
+ * Bus CAN-FD y bootloader simulados en tiempo virtual (ver fwu_sim.h).
+ */
+
+#include "fwu_sim.h"
+#include "fwu.h"
+#include <string.h>
+
+#define HOST_TXQ   10u     /* txqueuelen por defecto de SocketCAN          */
+#define ECU_TXQ    16u     /* FIFO TX de FDCAN3                            */
+#define ECU_RXQ    64u     /* FIFO RX0 del bootloader                      */
+#define HOST_RXQ  256u
+#define QCAP      256u
+#define LOOP_US     5u     /* una vuelta del bucle del bootloader          */
+
+typedef struct
+{
+  uint8_t d[FWU_FRAME_MAX];
+  uint8_t len;
+} sim_frame_t;
+
+typedef struct
+{
+  sim_frame_t f[QCAP];
+  uint32_t    head, n, cap;
+} sim_queue_t;
+
+static fwu_sim_cfg_t   s_cfg;
+static fwu_sim_stats_t s_st;
+static sim_queue_t     s_host_tx, s_host_rx, s_ecu_tx, s_ecu_rx;
+static uint32_t        s_now;
+static uint32_t        s_bus_free_at;
+static sim_frame_t     s_on_bus;
+static uint8_t         s_on_bus_dir;    /* 0 libre, 1 PC → ECU, 2 ECU → PC */
+static uint32_t        s_data_bytes;
+static uint32_t        s_data_frames;
+static uint8_t         s_cut_done;
+static uint32_t        s_sectors_before;
+
+static int q_push(sim_queue_t *q, const uint8_t *d, uint8_t len)
+{
+  if (q->n >= q->cap) return -1;
+  sim_frame_t *f = &q->f[(q->head + q->n) % QCAP];
+  memcpy(f->d, d, len);
+  f->len = len;
+  q->n++;
+  return 0;
+}
+
+static int q_pop(sim_queue_t *q, sim_frame_t *f)
+{
+  if (q->n == 0u) return 0;
+  *f = q->f[q->head];
+  q->head = (q->head + 1u) % QCAP;
+  q->n--;
+  return 1;
+}
+
+static void q_init(sim_queue_t *q, uint32_t cap)
+{
+  q->head = 0;
+  q->n = 0;
+  q->cap = cap;
+}
+
+static int ecu_tx(uint32_t id, const uint8_t *data, uint8_t len)
+{
+  (void)id;
+  return q_push(&s_ecu_tx, data, len);
+}
+
+/* Trama FD con BRS e ID de 11 bits. Arbitraje, ACK, EOF e IFS a 500 kbit/s
+ * (32 bits con relleno); ESI, DLC, datos, contador de relleno, CRC (17/21)
+ * con sus bits fijos y delimitador a la velocidad de datos, más un bit de
+ * relleno de cada 10 en los datos. */
+uint32_t FwuSim_FrameUs(uint8_t len, uint32_t data_kbps)
+{
+  const uint32_t crc = (len > 16u) ? 21u : 17u;
+  uint32_t data_bits = 1u + 4u + 8u * len + 4u + crc + (crc + 4u + 3u) / 4u + 1u;
+  data_bits += (5u + 8u * len) / 10u;
+  const uint32_t nominal_bits = 17u + 3u + 12u;
+  return nominal_bits * 2u + (data_bits * 1000u + data_kbps - 1u) / data_kbps;
+}
+
+static void power_cut(void)
+{
+  fwu_stats_t fs;
+  Fwu_GetStats(&fs);
+  s_sectors_before += fs.sectors;
+  Fwu_Init(ecu_tx);
+  q_init(&s_ecu_tx, ECU_TXQ);
+  q_init(&s_ecu_rx, ECU_RXQ);
+  if (s_on_bus_dir == 2u) s_on_bus_dir = 0;
+  s_cut_done = 1u;
+  s_st.resets++;
+}
+
+static void sim_step(void)
+{
+  /* Fin de la trama en curso */
+  if (s_on_bus_dir && (int32_t)(s_now - s_bus_free_at) >= 0)
+  {
+    if (s_on_bus_dir == 1u)
+    {
+      int drop = 0;
+      if (s_on_bus.d[0] == FWU_CMD_DATA)
+      {
+        s_data_frames++;
+        drop = s_cfg.drop_every && (s_data_frames % s_cfg.drop_every) == 0u;
+        if (!drop) s_data_bytes += s_on_bus.len - 2u;
+      }
+      if (drop) s_st.dropped++;
+      else if (q_push(&s_ecu_rx, s_on_bus.d, s_on_bus.len) != 0) s_st.rx_overruns++;
+    }
+    else
+    {
+      (void)q_push(&s_host_rx, s_on_bus.d, s_on_bus.len);
+    }
+    s_on_bus_dir = 0;
+  }
+
+  /* Arbitraje: FWU_RSP_ID < FWU_CMD_ID, la ECU gana */
+  if (!s_on_bus_dir)
+  {
+    if (q_pop(&s_ecu_tx, &s_on_bus)) s_on_bus_dir = 2u;
+    else if (q_pop(&s_host_tx, &s_on_bus)) s_on_bus_dir = 1u;
+    if (s_on_bus_dir)
+    {
+      const uint32_t us = FwuSim_FrameUs(s_on_bus.len, s_cfg.data_kbps);
+      s_bus_free_at = s_now + us;
+      s_st.frames++;
+      s_st.busy_us += us;
+    }
+  }
+
+  /* Bucle del bootloader */
+  sim_frame_t f;
+  while (q_pop(&s_ecu_rx, &f)) (void)Fwu_OnFrame(FWU_CMD_ID, f.d, f.len, s_now);
+  Fwu_Poll(s_now);
+
+  if (s_cfg.cut_at && !s_cut_done && s_data_bytes >= s_cfg.cut_at) power_cut();
+  s_now += LOOP_US;
+}
+
+static int link_send(void *ctx, const uint8_t *data, uint8_t len)
+{
+  (void)ctx;
+  while (s_host_tx.n >= s_host_tx.cap) sim_step();
+  return q_push(&s_host_tx, data, len);
+}
+
+static int link_recv(void *ctx, uint8_t *data, uint8_t *len, uint32_t timeout_us)
+{
+  (void)ctx;
+  const uint32_t t0 = s_now;
+  sim_frame_t f;
+  for (;;)
+  {
+    if (q_pop(&s_host_rx, &f))
+    {
+      memcpy(data, f.d, f.len);
+      *len = f.len;
+      return 1;
+    }
+    if (s_now - t0 >= timeout_us) return 0;
+    sim_step();
+  }
+}
+
+static uint32_t link_now(void *ctx)
+{
+  (void)ctx;
+  return s_now;
+}
+
+void FwuSim_Init(const fwu_sim_cfg_t *cfg)
+{
+  memset(&s_cfg, 0, sizeof(s_cfg));
+  if (cfg) s_cfg = *cfg;
+  if (s_cfg.data_kbps == 0u) s_cfg.data_kbps = 2000u;
+  memset(&s_st, 0, sizeof(s_st));
+  q_init(&s_host_tx, HOST_TXQ);
+  q_init(&s_host_rx, HOST_RXQ);
+  q_init(&s_ecu_tx, ECU_TXQ);
+  q_init(&s_ecu_rx, ECU_RXQ);
+  s_now = 0;
+  s_on_bus_dir = 0;
+  s_data_bytes = 0;
+  s_data_frames = 0;
+  s_cut_done = 0;
+  s_sectors_before = 0;
+  Fwu_Init(ecu_tx);                    /* la flash simulada se conserva */
+}
+
+void FwuSim_Link(fwu_link_t *lk)
+{
+  lk->send   = link_send;
+  lk->recv   = link_recv;
+  lk->now_us = link_now;
+  lk->ctx    = NULL;
+}
+
+void FwuSim_GetStats(fwu_sim_stats_t *out)
+{
+  fwu_stats_t fs;
+  Fwu_GetStats(&fs);
+  *out = s_st;
+  out->sectors = s_sectors_before + fs.sectors;
+}
@@ -0,0 +1,45 @@
+/**
+ * fwu_sim.h
+ * ECU simulada para ecu08_fwu: el servidor de fwu.c con su flash SIL
+ * (tiempos de programación y borrado) detrás de un bus CAN-FD en tiempo
+ * virtual.
+ *
+ * Bus: 500 kbit/s en arbitraje, 2 Mbit/s en datos (BRS); cada trama ocupa
+ * su tiempo en bits (FwuSim_FrameUs) y gana la ID más baja. Colas: la del
+ * socket del PC (txqueuelen de SocketCAN), la FIFO TX de FDCAN3 y su FIFO
+ * RX, que el bucle del bootloader vacía en cada vuelta.
+ *
+ * Fallos inyectables: corte de alimentación tras N bytes de imagen
+ * recibidos (Fwu_Init de nuevo, la flash se conserva) y pérdida de una de
+ * cada N tramas DATA.
+ */
+
+#ifndef FWU_SIM_H
+#define FWU_SIM_H
+
+#include <stdint.h>
+#include "fwu_host.h"
+
+typedef struct
+{
+  uint32_t cut_at;         /* bytes DATA entregados antes del corte, 0 = no */
+  uint32_t drop_every;     /* pierde 1 de cada N tramas DATA, 0 = ninguna   */
+  uint32_t data_kbps;      /* fase de datos (defecto 2000)                  */
+} fwu_sim_cfg_t;
+
+typedef struct
+{
+  uint32_t frames;         /* tramas en el bus                              */
+  uint64_t busy_us;        /* tiempo de bus ocupado                         */
+  uint32_t resets;         /* cortes simulados                              */
+  uint32_t dropped;
+  uint32_t rx_overruns;    /* FIFO RX de la ECU llena                       */
+  uint32_t sectors;        /* borrados (sumados a través de los cortes)     */
+} fwu_sim_stats_t;
+
+void     FwuSim_Init(const fwu_sim_cfg_t *cfg);
+void     FwuSim_Link(fwu_link_t *lk);
+uint32_t FwuSim_FrameUs(uint8_t len, uint32_t data_kbps);
+void     FwuSim_GetStats(fwu_sim_stats_t *out);
+
+#endif /* FWU_SIM_H */
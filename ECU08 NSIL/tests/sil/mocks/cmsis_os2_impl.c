@@ -9,7 +9,7 @@
  */
 
 #include "cmsis_os2.h"
-#include "can.h"          /* canRxQueueHandle, canTxQueueHandle, can_qitem16_t */
+#include "can.h"          /* canRxQueueHandle, canTxQueueHandle, can_qitem_t */
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -169,8 +169,8 @@ osMessageQueueId_t canTxQueueHandle = NULL;
 void SIL_RTOS_Init(void)
 {
     /* Recrear si ya existían (entre test runs) */
-    canRxQueueHandle = osMessageQueueNew(128u, sizeof(can_qitem16_t), NULL);
-    canTxQueueHandle = osMessageQueueNew(64u,  sizeof(can_qitem16_t), NULL);
+    canRxQueueHandle = osMessageQueueNew(128u, sizeof(can_qitem_t), NULL);
+    canTxQueueHandle = osMessageQueueNew(64u,  sizeof(can_qitem_t), NULL);
 
     /* g_inMutex se define en app_state.c; se inicializa aquí */
     extern osMutexId_t g_inMutex;
@@ -3,7 +3,8 @@
  *
  * Define los objetos globales de handle FDCAN (hfdcan1/2/3) que can.c
  * declara como extern, y provee implementaciones stub de las funciones
- * HAL FDCAN que retornan HAL_ERROR (no hay hardware en SIL).
+ * HAL FDCAN (sin hardware: TX guarda las últimas tramas, RX entrega la que
+ * inyecta el test).
  */
 
 #include "main.h"
@@ -11,25 +12,59 @@
 #include <string.h>
 
 /* -------------------------------------------------------------------------
-   Handles FDCAN globales (extern en can.c, definidos aquí en SIL)
+   Handles FDCAN globales (extern en can.c, definidos aquí en SIL).
+   FrameFormat como en fdcan.c: FDCAN3 en FD + BRS, el resto clásico.
    ---------------------------------------------------------------------- */
-FDCAN_HandleTypeDef hfdcan1 = { .Instance = 0x40006400UL };
-FDCAN_HandleTypeDef hfdcan2 = { .Instance = 0x40006800UL };
-FDCAN_HandleTypeDef hfdcan3 = { .Instance = 0x40006C00UL };
+FDCAN_HandleTypeDef hfdcan1 = { .Instance = 0x40006400UL, .Init = { FDCAN_FRAME_CLASSIC } };
+FDCAN_HandleTypeDef hfdcan2 = { .Instance = 0x40006800UL, .Init = { FDCAN_FRAME_CLASSIC } };
+FDCAN_HandleTypeDef hfdcan3 = { .Instance = 0x40006C00UL, .Init = { FDCAN_FRAME_FD_BRS } };
+
+static const uint8_t DLC_BYTES[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+/* Últimas SIL_TX_LOG tramas TX, trama RX pendiente (una por handle) y
+ * handle con la FIFO TX llena */
+#define SIL_TX_LOG  16u
+
+typedef struct
+{
+    FDCAN_HandleTypeDef  *h;
+    FDCAN_TxHeaderTypeDef hdr;
+    uint8_t               data[64];
+} sil_tx_t;
+
+static sil_tx_t              s_tx_log[SIL_TX_LOG];
+static uint32_t              s_tx_count;
+static FDCAN_HandleTypeDef  *s_tx_full;
+
+static FDCAN_HandleTypeDef  *s_rx_h;
+static FDCAN_RxHeaderTypeDef s_rx_hdr;
+static uint8_t               s_rx_data[64];
 
 /* -------------------------------------------------------------------------
    Stubs HAL FDCAN
-   En SIL no hay hardware, así que estas funciones son no-ops seguros.
-   CanTx_SendHal() llama a HAL_FDCAN_AddMessageToTxFifoQ → retorna ERROR,
-   pero en los tests de integración no se llama a CanTx_SendHal directamente.
+   En SIL no hay hardware: TX acepta la trama y la guarda (copia la
+   longitud del DLC, como la HAL real); RX entrega la trama inyectada con
+   SIL_Fdcan_InjectRx, o HAL_ERROR si no hay ninguna.
    ---------------------------------------------------------------------- */
 HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan,
                                                   FDCAN_TxHeaderTypeDef *pTxHeader,
                                                   uint8_t *pTxData)
 {
-    (void)hfdcan; (void)pTxHeader; (void)pTxData;
-    /* SIL: TX hardware no disponible */
-    return HAL_ERROR;
+    if (!hfdcan || !pTxHeader || !pTxData || pTxHeader->DataLength > 15u) return HAL_ERROR;
+    if (hfdcan == s_tx_full) return HAL_ERROR;
+    sil_tx_t *t = &s_tx_log[s_tx_count % SIL_TX_LOG];
+    t->h   = hfdcan;
+    t->hdr = *pTxHeader;
+    memcpy(t->data, pTxData, DLC_BYTES[pTxHeader->DataLength]);
+    s_tx_count++;
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(FDCAN_HandleTypeDef *hfdcan)
+{
+    /* SIL: FIFO TX siempre vacía (profundidad de fdcan.c, FDCAN1) salvo la
+     * marcada llena con SIL_Fdcan_SetTxFull */
+    return (hfdcan && hfdcan == s_tx_full) ? 0u : 32u;
 }
 
 HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan,
@@ -37,10 +72,48 @@ HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan,
                                           FDCAN_RxHeaderTypeDef *pRxHeader,
                                           uint8_t *pRxData)
 {
-    (void)hfdcan; (void)RxLocation;
-    if (pRxHeader) memset(pRxHeader, 0, sizeof(*pRxHeader));
-    if (pRxData)   memset(pRxData,   0, 8);
-    return HAL_ERROR;
+    (void)RxLocation;
+    if (!pRxHeader || !pRxData || !hfdcan || hfdcan != s_rx_h) return HAL_ERROR;
+    *pRxHeader = s_rx_hdr;
+    memcpy(pRxData, s_rx_data, DLC_BYTES[s_rx_hdr.DataLength & 0xFu]);
+    s_rx_h = NULL;
+    return HAL_OK;
+}
+
+void SIL_Fdcan_InjectRx(FDCAN_HandleTypeDef *hfdcan, const FDCAN_RxHeaderTypeDef *h,
+                        const uint8_t *data)
+{
+    s_rx_h   = hfdcan;
+    s_rx_hdr = *h;
+    memcpy(s_rx_data, data, DLC_BYTES[h->DataLength & 0xFu]);
+}
+
+uint32_t SIL_Fdcan_LastTx(FDCAN_HandleTypeDef **hfdcan, FDCAN_TxHeaderTypeDef *h,
+                          uint8_t data[64])
+{
+    if (s_tx_count == 0u)
+    {
+        if (hfdcan) *hfdcan = NULL;
+        return 0u;
+    }
+    (void)SIL_Fdcan_TxAt(s_tx_count, hfdcan, h, data);
+    return s_tx_count;
+}
+
+int SIL_Fdcan_TxAt(uint32_t n, FDCAN_HandleTypeDef **hfdcan, FDCAN_TxHeaderTypeDef *h,
+                   uint8_t data[64])
+{
+    if (n == 0u || n > s_tx_count || s_tx_count - n >= SIL_TX_LOG) return 0;
+    const sil_tx_t *t = &s_tx_log[(n - 1u) % SIL_TX_LOG];
+    if (hfdcan) *hfdcan = t->h;
+    if (h)      *h = t->hdr;
+    if (data)   memcpy(data, t->data, sizeof(t->data));
+    return 1;
+}
+
+void SIL_Fdcan_SetTxFull(FDCAN_HandleTypeDef *hfdcan)
+{
+    s_tx_full = hfdcan;
 }
 
 /* -------------------------------------------------------------------------
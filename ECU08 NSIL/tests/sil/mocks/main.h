@@ -37,16 +37,28 @@ typedef enum {
 #define FDCAN_DATA_FRAME        0x00000000U
 #define FDCAN_REMOTE_FRAME      0x00000001U
 
-/* DLC → (dlc_bytes << 16), igual que en la HAL real del STM32H7 */
+/* Códigos DLC sin desplazar (0..15), igual que en la HAL real del STM32H7 */
 #define FDCAN_DLC_BYTES_0       0x00000000U
-#define FDCAN_DLC_BYTES_1       0x00010000U
-#define FDCAN_DLC_BYTES_2       0x00020000U
-#define FDCAN_DLC_BYTES_3       0x00030000U
-#define FDCAN_DLC_BYTES_4       0x00040000U
-#define FDCAN_DLC_BYTES_5       0x00050000U
-#define FDCAN_DLC_BYTES_6       0x00060000U
-#define FDCAN_DLC_BYTES_7       0x00070000U
-#define FDCAN_DLC_BYTES_8       0x00080000U
+#define FDCAN_DLC_BYTES_1       0x00000001U
+#define FDCAN_DLC_BYTES_2       0x00000002U
+#define FDCAN_DLC_BYTES_3       0x00000003U
+#define FDCAN_DLC_BYTES_4       0x00000004U
+#define FDCAN_DLC_BYTES_5       0x00000005U
+#define FDCAN_DLC_BYTES_6       0x00000006U
+#define FDCAN_DLC_BYTES_7       0x00000007U
+#define FDCAN_DLC_BYTES_8       0x00000008U
+#define FDCAN_DLC_BYTES_12      0x00000009U
+#define FDCAN_DLC_BYTES_16      0x0000000AU
+#define FDCAN_DLC_BYTES_20      0x0000000BU
+#define FDCAN_DLC_BYTES_24      0x0000000CU
+#define FDCAN_DLC_BYTES_32      0x0000000DU
+#define FDCAN_DLC_BYTES_48      0x0000000EU
+#define FDCAN_DLC_BYTES_64      0x0000000FU
+
+/* Init.FrameFormat (valores de CCCR.FDOE / CCCR.BRSE) */
+#define FDCAN_FRAME_CLASSIC     0x00000000U
+#define FDCAN_FRAME_FD_NO_BRS   0x00000100U
+#define FDCAN_FRAME_FD_BRS      0x00000300U
 
 #define FDCAN_ESI_ACTIVE        0x00000000U
 #define FDCAN_ESI_PASSIVE       0x00000001U
@@ -90,9 +102,14 @@ typedef struct {
     uint32_t IsFilterMatchingFrame;
 } FDCAN_RxHeaderTypeDef;
 
-/* Handle FDCAN mínimo (can.c sólo accede al puntero de handle) */
+/* Handle FDCAN mínimo: can.c compara punteros y lee Init.FrameFormat */
 typedef struct {
-    uint32_t Instance;   /* placeholder */
+    uint32_t FrameFormat;
+} FDCAN_InitTypeDef;
+
+typedef struct {
+    uint32_t          Instance;   /* placeholder */
+    FDCAN_InitTypeDef Init;
 } FDCAN_HandleTypeDef;
 
 /* -------------------------------------------------------------------------
@@ -102,11 +119,28 @@ HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan,
                                                   FDCAN_TxHeaderTypeDef *pTxHeader,
                                                   uint8_t *pTxData);
 
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(FDCAN_HandleTypeDef *hfdcan);
+
 HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan,
                                           uint32_t RxLocation,
                                           FDCAN_RxHeaderTypeDef *pRxHeader,
                                           uint8_t *pRxData);
 
+/* -------------------------------------------------------------------------
+   Inyección / captura SIL: una trama RX pendiente por handle (la devuelve
+   HAL_FDCAN_GetRxMessage) y las últimas 16 tramas aceptadas en TX.
+   SIL_Fdcan_TxAt(n): la n-ésima trama TX (1 = la primera, LastTx devuelve
+   el total); 0 si ya salió del registro. SIL_Fdcan_SetTxFull: ese handle
+   rechaza TX (FIFO llena), NULL para ninguno.
+   ---------------------------------------------------------------------- */
+void SIL_Fdcan_InjectRx(FDCAN_HandleTypeDef *hfdcan, const FDCAN_RxHeaderTypeDef *h,
+                        const uint8_t *data);
+uint32_t SIL_Fdcan_LastTx(FDCAN_HandleTypeDef **hfdcan, FDCAN_TxHeaderTypeDef *h,
+                          uint8_t data[64]);
+int SIL_Fdcan_TxAt(uint32_t n, FDCAN_HandleTypeDef **hfdcan, FDCAN_TxHeaderTypeDef *h,
+                   uint8_t data[64]);
+void SIL_Fdcan_SetTxFull(FDCAN_HandleTypeDef *hfdcan);
+
 /* -------------------------------------------------------------------------
    Error handler (stub)
    ---------------------------------------------------------------------- */
@@ -11,14 +11,28 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/socket.h>
 
 #include "app_state.h"
 #include "control.h"
+#include "calib.h"
+#include "xcp.h"
+#include "uds.h"
+#include "fwu.h"
+#include "gateway.h"
+#include "can_map.h"
+#include "inv_backend.h"
+#include "freshness.h"
+#include "tx_sched.h"
 #include "test_integration.h"   /* suites S1-S10, Test_IntegrationRunAll() */
 #include "sil_hal_mocks.h"
 #include "sil_can_simulator.h"
 #include "sil_boot_sequence.h"
 #include "sil_results.h"
+#include "sil_plant.h"
 
 /* Declarada en mocks/diag_sil.c: redirige Diag_Log al fichero especificado */
 extern void SIL_DiagSetFile(FILE *f);
@@ -30,6 +44,10 @@ static volatile uint32_t sil_tick_ms = 0;
 static volatile int sil_simulation_running = 0;
 static volatile uint32_t sil_test_duration_ms = 0;
 
+/* Closed-loop scenarios (plant tests) count failed checks here; main()
+ * returns non-zero so CTest reports them. */
+static int sil_failures = 0;
+
 /* ===== Test: Suites de integración S1-S10 (test_integration.c) ===== */
 
 /**
@@ -450,6 +468,2383 @@ static void test_dynamic_state_transitions(void)
     SIL_Results_Close();
 }
 
+/* ===== Closed-loop helpers (control + plant) ===== */
+
+/**
+ * Drives the control FSM BOOT → RUN with precharge ACK, start button and
+ * brake, then releases the brake. Uses the simulated kernel tick.
+ */
+static void sil_control_to_run(app_inputs_t *in, control_out_t *out)
+{
+    Control_Init();
+    in->ok_precarga    = 1;
+    in->boton_arranque = 1;
+    in->s_freno        = 3500;
+    Control_Step10ms(in, out);   /* BOOT → WAIT_START_BRAKE  */
+    Control_Step10ms(in, out);   /* → R2D_DELAY              */
+    SIL_AdvanceTick(2100);
+    in->boton_arranque = 0;
+    in->s_freno        = 0;
+    Control_Step10ms(in, out);   /* → READY                  */
+    Control_Step10ms(in, out);   /* → RUN                    */
+}
+
+static void sil_check(const char *tag, int ok, const char *what)
+{
+    printf("[%s] %s %s\n", tag, ok ? "✅" : "❌", what);
+    SIL_Results_Log(tag, ok ? "PASS" : "FAIL", what);
+    if (!ok) sil_failures++;
+}
+
+/**
+ * Test: 80 kW power limit held at high rpm (full throttle acceleration)
+ */
+static void test_power_limit(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: 80 kW Power Limit (plant)    ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("power_limit_test.log");
+    SIL_Results_Log("POWER_LIMIT", "STARTED", "Full throttle run against the 80 kW limit");
+
+    const uint32_t period_us = 1000u;      /* 1 kHz executive */
+    const float    dt        = (float)period_us * 1e-6f;
+    const float    p_rule    = 80000.0f;
+
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(period_us);
+
+    app_inputs_t  in;
+    control_out_t out;
+    sil_plant_t   plant;
+    AppState_Snapshot(&in);
+    SIL_Plant_Init(&plant);
+    SIL_Plant_Publish(&plant, &in);
+    sil_control_to_run(&in, &out);
+
+    in.s1_aceleracion = 2950;   /* 100 % APPS */
+    in.s2_aceleracion = 2570;
+
+    float    p_peak = 0.0f, p_sum_last = 0.0f;
+    uint32_t n_last = 0, t_engage = 0, engaged = 0;
+    const uint32_t steps = 6000u;
+
+    for (uint32_t k = 0; k < steps; k++) {
+        SIL_Plant_Publish(&plant, &in);
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+
+        if (!engaged && plant.p_elec_w > 0.95f * p_rule) { engaged = 1; t_engage = k; }
+        /* Ignore the first 200 ms after reaching the limit (PI settling) */
+        if (engaged && k > t_engage + 200u && plant.p_elec_w > p_peak) p_peak = plant.p_elec_w;
+        if (k >= steps - 1000u) { p_sum_last += plant.p_elec_w; n_last++; }
+
+        if ((k % 1000u) == 0u) {
+            printf("[PLIM] t=%4u ms rpm=%5.0f torque=%3d%% P=%6.1f kW Vdc=%5.1f\n",
+                   k, SIL_Plant_MotorRpm(&plant), out.torque_pct,
+                   plant.p_elec_w / 1000.0f, plant.v_dc);
+        }
+    }
+
+    float p_mean = p_sum_last / (float)(n_last ? n_last : 1u);
+    char buf[128];
+    snprintf(buf, sizeof(buf), "rpm=%.0f peak=%.1f kW mean(last 1s)=%.1f kW",
+             SIL_Plant_MotorRpm(&plant), p_peak / 1000.0f, p_mean / 1000.0f);
+    printf("[PLIM] %s\n", buf);
+    SIL_Results_LogEvent(steps, "RESULT", buf);
+
+    sil_check("PLIM", SIL_Plant_MotorRpm(&plant) > 4000.0f, "reached high rpm (>4000)");
+    sil_check("PLIM", engaged, "limit engaged");
+    sil_check("PLIM", p_peak <= p_rule * 1.02f, "peak power <= 80 kW + 2 %");
+    sil_check("PLIM", p_mean >= 76000.0f && p_mean <= p_rule, "mean power in [76, 80] kW");
+
+    SIL_Results_Close();
+}
+
+/* Thermal scenario: 10 min full throttle from a hot motor. With `feedback`
+ * cleared the controller sees coolant temperature instead (reference run
+ * without derating). The thermal limit is sampled every 100 ms into
+ * lim_trace[], motor temperature into t_motor_trace[]. */
+#define THERM_STEPS      600000u
+#define THERM_TRACE_DIV  100u
+
+static void sil_thermal_run(int feedback, float *lim_trace, float *t_motor_trace, float *torque_tail)
+{
+    const uint32_t period_us = 1000u;
+    const float    dt        = (float)period_us * 1e-6f;
+
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(period_us);
+
+    app_inputs_t  in;
+    control_out_t out;
+    sil_plant_t   plant;
+    AppState_Snapshot(&in);
+    SIL_Plant_Init(&plant);
+    plant.t_motor_c = 80.0f;             /* warm after a previous stint */
+    plant.t_igbt_c  = 60.0f;
+    SIL_Plant_Publish(&plant, &in);
+    sil_control_to_run(&in, &out);
+
+    in.s1_aceleracion = 2950;
+    in.s2_aceleracion = 2570;
+
+    float    torque_sum = 0.0f;
+    uint32_t n_tail = 0;
+
+    for (uint32_t k = 0; k < THERM_STEPS; k++) {
+        SIL_Plant_Publish(&plant, &in);
+        if (!feedback) {
+            in.inv_motor_temp = (int16_t)plant.t_cool_c;
+            in.inv_igbt_temp  = (int16_t)plant.t_cool_c;
+        }
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+
+        if ((k % THERM_TRACE_DIV) == 0u) {
+            lim_trace[k / THERM_TRACE_DIV] = Control_GetThermalLimitPct();
+            t_motor_trace[k / THERM_TRACE_DIV] = plant.t_motor_c;
+        }
+        if (k >= THERM_STEPS - 30000u) { torque_sum += (float)out.torque_pct; n_tail++; }
+        if (feedback && (k % 60000u) == 0u) {
+            printf("[THERM] t=%3u s rpm=%5.0f torque=%3d%% lim=%5.1f%% Tmot=%5.1f Tigbt=%5.1f I=%5.1f\n",
+                   k / 1000u, SIL_Plant_MotorRpm(&plant), out.torque_pct,
+                   Control_GetThermalLimitPct(), plant.t_motor_c, plant.t_igbt_c, plant.i_ph);
+        }
+    }
+    *torque_tail = torque_sum / (float)(n_tail ? n_tail : 1u);
+}
+
+/**
+ * Test: thermal derating holds the motor below its hard limit in endurance
+ */
+static void test_thermal_derate(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Thermal Derating (plant)     ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("thermal_derate_test.log");
+    SIL_Results_Log("THERMAL", "STARTED", "Sustained full throttle from a warm motor");
+
+    enum { N = THERM_STEPS / THERM_TRACE_DIV };
+    static float lim_ref[N], lim[N], tm_ref[N], tm[N];
+    const float  t_hard = 120.0f;        /* EMRAX winding limit / inverter trip */
+    float torque_tail_ref, torque_tail;
+
+    sil_thermal_run(0, lim_ref, tm_ref, &torque_tail_ref);
+    sil_thermal_run(1, lim, tm, &torque_tail);
+
+    float    t_max = 0.0f, t_max_ref = 0.0f;
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < N; i++) {
+        if (tm[i] > t_max) t_max = tm[i];
+        if (tm_ref[i] > t_max_ref) t_max_ref = tm_ref[i];
+        if (!first && lim[i] < 100.0f) first = i;
+    }
+
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+             "Tmax=%.1f C (no derate %.1f C) derate@%.1f s T=%.1f C torque(last 30s)=%.1f %%",
+             t_max, t_max_ref, first * THERM_TRACE_DIV / 1000.0f, tm[first], torque_tail);
+    printf("[THERM] %s\n", buf);
+    SIL_Results_LogEvent(THERM_STEPS, "RESULT", buf);
+
+    sil_check("THERM", t_max_ref > t_hard, "reference run (no derating) overheats");
+    sil_check("THERM", first != 0u, "derating engaged");
+    sil_check("THERM", first != 0u && tm[first] < 90.0f, "prediction derates before the 90 C breakpoint");
+    sil_check("THERM", t_max < t_hard, "motor stays below 120 C");
+    sil_check("THERM", torque_tail > 10.0f, "car keeps driving (no thermal trip)");
+
+    SIL_Results_Close();
+}
+
+/* Step response of the control pipeline at one executive rate. */
+typedef struct {
+    float    t10_s, t90_s;        /* 0 → 100 step, 10 % / 90 % crossing  */
+    float    fall_s;              /* 100 → 0 step, time to reach 0       */
+    float    max_slope_pct_s;     /* steepest 10 ms window               */
+    int16_t  first_10ms;          /* torque 10 ms after the step         */
+    int16_t  brake_cut;           /* torque on the first braked cycle    */
+} sil_step_result_t;
+
+static void sil_torque_step(uint32_t period_us, sil_step_result_t *r)
+{
+    const uint32_t tick_ms = period_us / 1000u;
+    const uint32_t n10     = 10000u / period_us;    /* cycles per 10 ms */
+    static int16_t hist[2000];
+
+    memset(r, 0, sizeof(*r));
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(period_us);
+
+    app_inputs_t  in;
+    control_out_t out;
+    AppState_Snapshot(&in);
+    sil_control_to_run(&in, &out);
+
+    /* 0 → 100 % step, 1 s */
+    in.s1_aceleracion = 2950;
+    in.s2_aceleracion = 2570;
+    uint32_t n = 1000000u / period_us;
+    for (uint32_t k = 0; k < n; k++) {
+        Control_Step10ms(&in, &out);
+        SIL_AdvanceTick(tick_ms);
+        hist[k] = out.torque_pct;
+        float t = (float)(k + 1u) * (float)period_us * 1e-6f;
+        if (!r->t10_s && out.torque_pct >= 10) r->t10_s = t;
+        if (!r->t90_s && out.torque_pct >= 90) r->t90_s = t;
+    }
+    r->first_10ms = hist[n10 - 1u];
+    for (uint32_t k = n10; k < n; k++) {
+        float slope = (float)(hist[k] - hist[k - n10]) * 100.0f;   /* %/s over 10 ms */
+        if (slope > r->max_slope_pct_s) r->max_slope_pct_s = slope;
+    }
+
+    /* 100 → 0 % (pedal released) */
+    in.s1_aceleracion = 2050;
+    in.s2_aceleracion = 1915;
+    for (uint32_t k = 0; k < n; k++) {
+        Control_Step10ms(&in, &out);
+        SIL_AdvanceTick(tick_ms);
+        if (out.torque_pct == 0) { r->fall_s = (float)(k + 1u) * (float)period_us * 1e-6f; break; }
+    }
+
+    /* 20 % pedal, then brake: torque must drop to 0 in the same cycle */
+    in.s1_aceleracion = 2230;
+    in.s2_aceleracion = 2046;
+    for (uint32_t k = 0; k < n; k++) {
+        Control_Step10ms(&in, &out);
+        SIL_AdvanceTick(tick_ms);
+    }
+    in.s_freno = 3500;
+    Control_Step10ms(&in, &out);
+    r->brake_cut = out.torque_pct;
+    in.s_freno = 0;
+}
+
+/**
+ * Test: torque slew / jerk limiter step response at 1 kHz and 100 Hz
+ */
+static void test_torque_step(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Torque Step Response         ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("torque_step_test.log");
+    SIL_Results_Log("TORQUE_STEP", "STARTED", "Pedal steps through the slew/jerk limiter");
+
+    const uint32_t periods[2] = { 1000u, 10000u };
+    sil_step_result_t r[2];
+    char buf[160];
+
+    for (uint32_t i = 0; i < 2u; i++) {
+        sil_torque_step(periods[i], &r[i]);
+        snprintf(buf, sizeof(buf),
+                 "%5u us: t10=%.3f s t90=%.3f s slope=%.0f %%/s fall=%.3f s @10ms=%d brake=%d",
+                 periods[i], r[i].t10_s, r[i].t90_s, r[i].max_slope_pct_s,
+                 r[i].fall_s, r[i].first_10ms, r[i].brake_cut);
+        printf("[STEP] %s\n", buf);
+        SIL_Results_LogEvent(0, "RESULT", buf);
+
+        sil_check("STEP", r[i].first_10ms <= 1, "jerk-limited onset (<= 1 % after 10 ms)");
+        sil_check("STEP", r[i].t90_s - r[i].t10_s > 0.18f && r[i].t90_s - r[i].t10_s < 0.24f,
+                  "10-90 % rise time 0.18..0.24 s");
+        sil_check("STEP", r[i].max_slope_pct_s <= 400.0f + 100.0f, "slope within rise rate");
+        sil_check("STEP", r[i].fall_s > 0.12f && r[i].fall_s < 0.20f, "release 100 -> 0 in 0.12..0.20 s");
+        sil_check("STEP", r[i].brake_cut == 0, "brake cuts torque in the same cycle");
+    }
+
+    float d = r[0].t90_s - r[1].t90_s;
+    if (d < 0.0f) d = -d;
+    sil_check("STEP", d <= 0.015f, "same response at 1 kHz and 100 Hz");
+
+    SIL_Results_Close();
+}
+
+/* Regen scenario: accelerate 5 s, then full brake pedal until (nearly)
+ * stopped. Returns the metrics of the braking phase. */
+typedef struct {
+    int16_t  torque_min;          /* most negative command              */
+    float    i_dc_min;            /* most negative (charging) current   */
+    float    e_regen_kj;          /* recovered electrical energy        */
+    float    max_step_pct;        /* largest command change in 10 ms    */
+    int16_t  torque_end;          /* command at the end (low speed)     */
+    float    v_end_mps;
+} sil_regen_result_t;
+
+static void sil_regen_run(uint16_t v_celda_min_mv, sil_regen_result_t *r)
+{
+    const uint32_t period_us = 1000u;
+    const float    dt        = (float)period_us * 1e-6f;
+    static int16_t hist[30000];
+
+    memset(r, 0, sizeof(*r));
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(period_us);
+
+    app_inputs_t  in;
+    control_out_t out;
+    sil_plant_t   plant;
+    AppState_Snapshot(&in);
+    SIL_Plant_Init(&plant);
+    SIL_Plant_Publish(&plant, &in);
+    in.v_celda_min = v_celda_min_mv;
+    sil_control_to_run(&in, &out);
+
+    in.s1_aceleracion = 2950;
+    in.s2_aceleracion = 2570;
+    for (uint32_t k = 0; k < 5000u; k++) {
+        SIL_Plant_Publish(&plant, &in);
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+    }
+    printf("[REGEN] braking from %.1f km/h (v_celda_min=%u mV)\n",
+           plant.v_mps * 3.6f, v_celda_min_mv);
+
+    in.s1_aceleracion = 2050;
+    in.s2_aceleracion = 1915;
+    in.s_freno        = 3800;
+    uint32_t n = 0;
+    for (; n < 30000u && plant.v_mps > 0.5f; n++) {
+        SIL_Plant_Publish(&plant, &in);
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+
+        hist[n] = out.torque_pct;
+        if (out.torque_pct < r->torque_min) r->torque_min = out.torque_pct;
+        if (plant.i_dc < r->i_dc_min) r->i_dc_min = plant.i_dc;
+        if (plant.p_elec_w < 0.0f) r->e_regen_kj -= plant.p_elec_w * dt * 1e-3f;
+        if (n >= 10u) {
+            float d = (float)(hist[n] - hist[n - 10u]);
+            if (d < 0.0f) d = -d;
+            if (d > r->max_step_pct) r->max_step_pct = d;
+        }
+    }
+    r->torque_end = out.torque_pct;
+    r->v_end_mps  = plant.v_mps;
+    in.s_freno = 0;
+}
+
+/**
+ * Test: regenerative braking limited by charge current and cell voltage
+ */
+static void test_regen(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Regenerative Braking (plant) ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("regen_test.log");
+    SIL_Results_Log("REGEN", "STARTED", "Brake from speed with regen blending");
+
+    sil_regen_result_t r, full;
+    char buf[160];
+
+    sil_regen_run(3900u, &r);
+    snprintf(buf, sizeof(buf),
+             "torque_min=%d %% i_min=%.1f A E=%.1f kJ step10ms=%.0f %% end=%d %% v_end=%.1f m/s",
+             r.torque_min, r.i_dc_min, r.e_regen_kj, r.max_step_pct, r.torque_end, r.v_end_mps);
+    printf("[REGEN] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+
+    sil_check("REGEN", r.torque_min < -10, "negative torque while braking");
+    sil_check("REGEN", r.i_dc_min >= -60.0f * 1.05f, "charge current within 60 A (+5 %)");
+    sil_check("REGEN", r.e_regen_kj > 10.0f, "energy recovered");
+    sil_check("REGEN", r.max_step_pct <= 8.0f, "smooth blend (<= 8 % per 10 ms)");
+    sil_check("REGEN", r.torque_end == 0, "regen faded out at low speed");
+
+    sil_regen_run(4180u, &full);
+    snprintf(buf, sizeof(buf), "full pack: torque_min=%d %% E=%.1f kJ", full.torque_min, full.e_regen_kj);
+    printf("[REGEN] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+    sil_check("REGEN", full.torque_min == 0, "no regen with a full pack");
+
+    SIL_Results_Close();
+}
+
+/* 75 m acceleration run on a slipping tyre. With `launch` set the driver
+ * arms launch control with the brake held before flooring the pedal; with
+ * `tc` clear the wheel speed source is reported dead (no traction control). */
+typedef struct {
+    float t75_s;                  /* time to 75 m                        */
+    float slip_mean;              /* mean slip, 0.5..2.5 s               */
+    float slip_peak;
+} sil_accel_result_t;
+
+static void sil_accel_run(int launch, int tc, float mu, sil_accel_result_t *r)
+{
+    const float dt = 0.001f;
+
+    memset(r, 0, sizeof(*r));
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(1000u);
+
+    app_inputs_t  in;
+    control_out_t out;
+    sil_plant_t   plant;
+    AppState_Snapshot(&in);
+    SIL_Plant_Init(&plant);
+    plant.mu_peak = mu;
+    SIL_Plant_Publish(&plant, &in);
+    sil_control_to_run(&in, &out);
+
+    if (launch) {
+        in.s_freno = 3500;
+        Control_Step10ms(&in, &out);
+        in.dash_input_1 = 1;             /* arm */
+        Control_Step10ms(&in, &out);
+        in.dash_input_1 = 0;
+        Control_Step10ms(&in, &out);
+        in.s_freno = 0;
+    }
+
+    in.s1_aceleracion = 2950;
+    in.s2_aceleracion = 2570;
+    float slip_sum = 0.0f;
+    uint32_t k = 0;
+    for (; k < 10000u && plant.x_m < 75.0f; k++) {
+        SIL_Plant_Publish(&plant, &in);
+        if (!tc) in.wheel_ok = 0;
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+
+        float s = SIL_Plant_Slip(&plant);
+        if (k >= 500u && k < 2500u) slip_sum += s;
+        if (s > r->slip_peak) r->slip_peak = s;
+    }
+    r->t75_s = (float)k * dt;
+    r->slip_mean = slip_sum / 2000.0f;
+}
+
+/**
+ * Test: launch control vs plain full throttle, and EV2.3 override
+ */
+static void test_launch(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Launch Control (75 m)        ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("launch_test.log");
+    SIL_Results_Log("LAUNCH", "STARTED", "75 m acceleration with and without launch control");
+
+    sil_accel_result_t base, lc;
+    char buf[160];
+
+    sil_accel_run(0, 0, 1.5f, &base);
+    sil_accel_run(1, 0, 1.5f, &lc);
+    snprintf(buf, sizeof(buf),
+             "plain: %.3f s slip mean=%.2f peak=%.2f | launch: %.3f s slip mean=%.2f peak=%.2f",
+             base.t75_s, base.slip_mean, base.slip_peak, lc.t75_s, lc.slip_mean, lc.slip_peak);
+    printf("[LAUNCH] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+
+    sil_check("LAUNCH", lc.t75_s < base.t75_s - 0.05f, "launch control is faster over 75 m");
+    sil_check("LAUNCH", lc.slip_mean > 0.03f && lc.slip_mean < 0.20f, "slip held near target");
+    sil_check("LAUNCH", lc.slip_peak < base.slip_peak, "less wheelspin than plain launch");
+
+    /* EV2.3: brake + pedal mid-launch cuts torque in the same cycle */
+    {
+        app_inputs_t  in;
+        control_out_t out;
+        sil_plant_t   plant;
+        SIL_RTOS_Init();
+        AppState_Init();
+        Control_SetPeriodUs(1000u);
+        AppState_Snapshot(&in);
+        SIL_Plant_Init(&plant);
+        plant.mu_peak = 1.5f;
+        SIL_Plant_Publish(&plant, &in);
+        sil_control_to_run(&in, &out);
+        in.s_freno = 3500;
+        Control_Step10ms(&in, &out);
+        in.dash_input_1 = 1;
+        Control_Step10ms(&in, &out);
+        in.dash_input_1 = 0;
+        in.s_freno = 0;
+        in.s1_aceleracion = 2950;
+        in.s2_aceleracion = 2570;
+        int16_t before = 0;
+        for (uint32_t k = 0; k < 500u; k++) {
+            SIL_Plant_Publish(&plant, &in);
+            Control_Step10ms(&in, &out);
+            SIL_Plant_Step(&plant, out.torque_pct, 0.001f);
+            SIL_AdvanceTick(1);
+            before = out.torque_pct;
+        }
+        in.s_freno = 3500;
+        SIL_Plant_Publish(&plant, &in);
+        Control_Step10ms(&in, &out);
+        printf("[LAUNCH] EV2.3 mid-launch: torque %d%% -> %d%%\n", before, out.torque_pct);
+        sil_check("LAUNCH", before > 50 && out.torque_pct == 0, "EV2.3 overrides launch");
+        in.s_freno = 0;
+    }
+
+    SIL_Results_Close();
+}
+
+/**
+ * Test: slip-based traction control on full throttle, high and low grip
+ */
+static void test_traction(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Traction Control (75 m)      ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("traction_test.log");
+    SIL_Results_Log("TRACTION", "STARTED", "Full throttle 75 m with and without traction control");
+
+    static const float mus[2] = { 1.5f, 0.8f };
+    char buf[160];
+
+    for (uint32_t i = 0; i < 2u; i++) {
+        sil_accel_result_t base, tc;
+        sil_accel_run(0, 0, mus[i], &base);
+        sil_accel_run(0, 1, mus[i], &tc);
+        snprintf(buf, sizeof(buf),
+                 "mu=%.1f off: %.3f s slip mean=%.2f peak=%.2f | TC: %.3f s slip mean=%.2f peak=%.2f",
+                 mus[i], base.t75_s, base.slip_mean, base.slip_peak,
+                 tc.t75_s, tc.slip_mean, tc.slip_peak);
+        printf("[TRACTION] %s\n", buf);
+        SIL_Results_LogEvent(0, "RESULT", buf);
+
+        sil_check("TRACTION", tc.t75_s < base.t75_s, "traction control is faster over 75 m");
+        sil_check("TRACTION", tc.slip_peak < base.slip_peak, "lower slip peak with TC");
+        sil_check("TRACTION", tc.slip_mean < 0.20f, "slip held near target");
+    }
+
+    /* Cut latency: a slip step is answered in the same control cycle */
+    {
+        app_inputs_t  in;
+        control_out_t out;
+        sil_plant_t   plant;
+        SIL_RTOS_Init();
+        AppState_Init();
+        Control_SetPeriodUs(1000u);
+        AppState_Snapshot(&in);
+        SIL_Plant_Init(&plant);
+        plant.v_mps = 10.0f;
+        SIL_Plant_Publish(&plant, &in);
+        sil_control_to_run(&in, &out);
+        in.s1_aceleracion = 2950;
+        in.s2_aceleracion = 2570;
+        for (uint32_t k = 0; k < 500u; k++) {
+            SIL_Plant_Publish(&plant, &in);
+            Control_Step10ms(&in, &out);
+            SIL_AdvanceTick(1);
+        }
+        int16_t before = out.torque_pct;
+        in.inv_rpm = (int16_t)(in.inv_rpm * 13 / 10);   /* 30 % slip */
+        Control_Step10ms(&in, &out);
+        printf("[TRACTION] slip step: torque %d%% -> %d%% (slip %.2f)\n",
+               before, out.torque_pct, Control_GetTractionSlip());
+        sil_check("TRACTION", before > 90 && out.torque_pct < 60, "torque cut in the same cycle");
+    }
+
+    SIL_Results_Close();
+}
+
+/* Full-throttle run with an offset accelerometer; returns speed error of
+ * the estimator and of the naive motor-speed conversion. */
+typedef struct {
+    float err_max;                /* |v_est - v| max                     */
+    float err_rms;
+    float motor_err_max;          /* |v from inv_rpm - v| max            */
+    float slip_err_max;           /* |slip_est - slip| max, v > 5 m/s    */
+} sil_est_result_t;
+
+static void sil_estimator_run(int wheels, sil_est_result_t *r)
+{
+    const float dt = 0.001f;
+    memset(r, 0, sizeof(*r));
+    SIL_RTOS_Init();
+    AppState_Init();
+    Control_SetPeriodUs(1000u);
+
+    app_inputs_t  in;
+    control_out_t out;
+    sil_plant_t   plant;
+    AppState_Snapshot(&in);
+    SIL_Plant_Init(&plant);
+    plant.mu_peak = 1.5f;
+    plant.imu_bias_mg = 40.0f;
+    SIL_Plant_Publish(&plant, &in);
+    sil_control_to_run(&in, &out);
+
+    in.s1_aceleracion = 2950;
+    in.s2_aceleracion = 2570;
+    float sq = 0.0f;
+    uint32_t k = 0;
+    for (; k < 6000u; k++) {
+        SIL_Plant_Publish(&plant, &in);
+        if (!wheels) in.wheel_ok = 0;
+        Control_Step10ms(&in, &out);
+        SIL_Plant_Step(&plant, out.torque_pct, dt);
+        SIL_AdvanceTick(1);
+
+        const vehicle_state_t *vs = Control_GetVehicleState();
+        float e  = fabsf(vs->v_mps - plant.v_mps);
+        float em = fabsf((float)in.inv_rpm * 0.10471976f / plant.gear * plant.r_wheel - plant.v_mps);
+        sq += e * e;
+        if (e  > r->err_max)       r->err_max = e;
+        if (em > r->motor_err_max) r->motor_err_max = em;
+        if (plant.v_mps > 5.0f) {
+            float es = fabsf(vs->slip - SIL_Plant_Slip(&plant));
+            if (es > r->slip_err_max) r->slip_err_max = es;
+        }
+    }
+    r->err_rms = sqrtf(sq / (float)k);
+}
+
+static double sil_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * Test: vehicle state estimator accuracy (closed loop) and host benchmark
+ */
+static void test_estimator(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Vehicle State Estimator      ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("estimator_test.log");
+    SIL_Results_Log("ESTIMATOR", "STARTED", "Speed/slip estimate on a wheelspin run + timing");
+
+    char buf[200];
+    sil_est_result_t ww, nw;
+    sil_estimator_run(1, &ww);
+    sil_estimator_run(0, &nw);
+    snprintf(buf, sizeof(buf),
+             "wheels+IMU: err max=%.3f rms=%.3f slip err=%.3f | IMU only: err max=%.3f rms=%.3f (motor-speed err max=%.2f)",
+             ww.err_max, ww.err_rms, ww.slip_err_max, nw.err_max, nw.err_rms, nw.motor_err_max);
+    printf("[ESTIMATOR] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+
+    sil_check("ESTIMATOR", ww.err_rms < 0.10f && ww.err_max < 0.30f, "speed within 0.1 m/s rms with wheel speeds");
+    sil_check("ESTIMATOR", ww.slip_err_max < 0.05f, "slip estimate tracks the plant");
+    sil_check("ESTIMATOR", nw.err_max < 0.25f * nw.motor_err_max, "wheelspin rejected without wheel speeds");
+
+    /* Host benchmark: same work for every input combination */
+    static const uint8_t combos[4][2] = { {1, 1}, {0, 1}, {1, 0}, {0, 0} };
+    const uint32_t n = 1000000u;
+    double ns[4];
+    vehicle_state_t vs;
+    app_inputs_t in;
+    memset(&in, 0, sizeof(in));
+    /* Best of 3 passes per combination; pass 0 of the first one also
+     * warms caches and the CPU clock */
+    for (uint32_t c = 0; c < 4u; c++) {
+        ns[c] = 1e9;
+        for (uint32_t rep = 0; rep < 3u; rep++) {
+            VehState_Init(&vs);
+            in.wheel_ok = combos[c][0];
+            in.imu_ok   = combos[c][1];
+            double t0 = sil_now_ns();
+            for (uint32_t i = 0; i < n; i++) {
+                in.inv_rpm        = (int16_t)(1000 + (i & 1023u));
+                in.wheel_fl_cmps  = (uint16_t)(600u + (i & 511u));
+                in.wheel_fr_cmps  = (uint16_t)(600u + (i & 255u));
+                in.imu_acc_mg[0]  = (int16_t)(i & 511u);
+                VehState_Update(&vs, &VEHICLE_STATE_CFG_DEFAULT, &in, 0.001f);
+            }
+            double t = (sil_now_ns() - t0) / (double)n;
+            if (t < ns[c]) ns[c] = t;
+        }
+    }
+    double lo = ns[0], hi = ns[0];
+    for (uint32_t c = 1; c < 4u; c++) {
+        if (ns[c] < lo) lo = ns[c];
+        if (ns[c] > hi) hi = ns[c];
+    }
+    snprintf(buf, sizeof(buf),
+             "VehState_Update ns/call: all=%.1f no-wheels=%.1f no-imu=%.1f none=%.1f (v=%.2f)",
+             ns[0], ns[1], ns[2], ns[3], (double)vs.v_mps);
+    printf("[ESTIMATOR] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("ESTIMATOR", hi < 1000.0, "under 1 us per call on host");
+    /* Wide margin: host timing noise, not the code, dominates the spread */
+    sil_check("ESTIMATOR", hi < 2.0 * lo, "execution time independent of sensor availability");
+
+    SIL_Results_Close();
+}
+
+/* ===== Test: independent control contexts (fleet + checkpoint) ===== */
+
+#define FLEET_N        256u
+#define FLEET_THREADS  8u
+#define FLEET_STEPS    3000u   /* 3 s at 1 kHz */
+
+typedef struct
+{
+    ctrl_ctx_t    ctx;
+    sil_plant_t   plant;
+    app_inputs_t  in;
+    uint32_t      now_ms;      /* per-vehicle clock, no shared tick */
+    uint32_t      hash;        /* FNV-1a of every torque command    */
+} sil_vehicle_t;
+
+static void sil_vehicle_step(sil_vehicle_t *v, control_out_t *out)
+{
+    SIL_Plant_Publish(&v->plant, &v->in);
+    Control_StepCtx(&v->ctx, &v->in, out, v->now_ms);
+    SIL_Plant_Step(&v->plant, out->torque_pct, 0.001f);
+    v->now_ms++;
+    v->hash = (v->hash ^ (uint16_t)out->torque_pct) * 16777619u;
+}
+
+/* BOOT → RUN on the vehicle's own clock, then a throttle/grip mix per id */
+static void sil_vehicle_init(sil_vehicle_t *v, uint32_t id)
+{
+    control_out_t out;
+    memset(v, 0, sizeof(*v));
+    v->hash = 2166136261u;
+    Control_CtxInit(&v->ctx, 1000u);
+    SIL_Plant_Init(&v->plant);
+    v->plant.mu_peak = 0.8f + 0.1f * (float)(id % 8u);
+
+    v->in.ok_precarga = 1; v->in.boton_arranque = 1; v->in.s_freno = 3500;
+    sil_vehicle_step(v, &out);
+    sil_vehicle_step(v, &out);
+    v->now_ms += 2100u;
+    v->in.boton_arranque = 0; v->in.s_freno = 0;
+    sil_vehicle_step(v, &out);
+    sil_vehicle_step(v, &out);
+
+    v->in.s1_aceleracion = (uint16_t)(2300u + 25u * (id % 28u));
+    v->in.s2_aceleracion = (uint16_t)(2100u + 18u * (id % 28u));
+}
+
+static void sil_vehicle_run(sil_vehicle_t *v, uint32_t steps)
+{
+    control_out_t out;
+    for (uint32_t k = 0; k < steps; k++) {
+        /* Brake + throttle mid-run: EV2.3 latch, per instance */
+        v->in.s_freno = (k >= 1500u && k < 1520u) ? 3500u : 0u;
+        sil_vehicle_step(v, &out);
+    }
+}
+
+typedef struct
+{
+    sil_vehicle_t *fleet;
+    uint32_t       first;
+} sil_fleet_job_t;
+
+static void *sil_fleet_worker(void *arg)
+{
+    const sil_fleet_job_t *job = (const sil_fleet_job_t *)arg;
+    for (uint32_t i = job->first; i < FLEET_N; i += FLEET_THREADS) {
+        sil_vehicle_init(&job->fleet[i], i);
+        sil_vehicle_run(&job->fleet[i], FLEET_STEPS);
+    }
+    return NULL;
+}
+
+/**
+ * Test: many control instances side by side. A fleet stepped in threads
+ * must match the same fleet stepped one by one, and a checkpointed vehicle
+ * must continue bit-identically after a restore.
+ */
+static void test_parallel_ctx(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Parallel Control Contexts    ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("parallel_ctx_test.log");
+    SIL_Results_Log("PARALLEL", "STARTED", "Threaded fleet vs sequential, checkpoint/restore");
+
+    char buf[200];
+    sil_vehicle_t *seq = calloc(FLEET_N, sizeof(*seq));
+    sil_vehicle_t *par = calloc(FLEET_N, sizeof(*par));
+    if (!seq || !par) {
+        sil_check("PARALLEL", 0, "fleet allocation");
+        free(seq); free(par);
+        SIL_Results_Close();
+        return;
+    }
+
+    double t0 = sil_now_ns();
+    for (uint32_t i = 0; i < FLEET_N; i++) {
+        sil_vehicle_init(&seq[i], i);
+        sil_vehicle_run(&seq[i], FLEET_STEPS);
+    }
+    double t_seq = sil_now_ns() - t0;
+
+    pthread_t th[FLEET_THREADS];
+    sil_fleet_job_t jobs[FLEET_THREADS];
+    uint32_t started = 0;
+    t0 = sil_now_ns();
+    for (uint32_t t = 0; t < FLEET_THREADS; t++) {
+        jobs[t].fleet = par;
+        jobs[t].first = t;
+        if (pthread_create(&th[t], NULL, sil_fleet_worker, &jobs[t]) == 0) started++;
+        else sil_fleet_worker(&jobs[t]);
+    }
+    for (uint32_t t = 0; t < started; t++) pthread_join(th[t], NULL);
+    double t_par = sil_now_ns() - t0;
+
+    uint32_t same = 0, distinct = 0;
+    for (uint32_t i = 0; i < FLEET_N; i++) {
+        if (seq[i].hash == par[i].hash &&
+            memcmp(&seq[i].ctx, &par[i].ctx, sizeof(ctrl_ctx_t)) == 0) same++;
+        if (i > 0 && seq[i].hash != seq[i - 1u].hash) distinct++;
+    }
+    snprintf(buf, sizeof(buf), "%u vehicles x %u steps: sequential %.1f ms, %u threads %.1f ms",
+             FLEET_N, FLEET_STEPS, t_seq * 1e-6, FLEET_THREADS, t_par * 1e-6);
+    printf("[PARALLEL] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("PARALLEL", same == FLEET_N, "threaded fleet identical to sequential");
+    sil_check("PARALLEL", distinct > FLEET_N / 2u, "instances evolve independently");
+
+    /* Checkpoint mid-run, continue, then restore a copy and replay */
+    static uint8_t blob[CONTROL_CTX_BLOB_SIZE];
+    sil_vehicle_t *a = &seq[0], *b = &par[0];
+    sil_vehicle_init(a, 5u);
+    sil_vehicle_run(a, 1000u);
+    uint32_t n = Control_CtxSerialize(&a->ctx, blob, sizeof(blob));
+    *b = *a;
+    Control_CtxInit(&b->ctx, 1000u);
+    int rc = Control_CtxRestore(&b->ctx, blob, n);
+    sil_vehicle_run(a, 2000u);
+    sil_vehicle_run(b, 2000u);
+    sil_check("PARALLEL", n == CONTROL_CTX_BLOB_SIZE && rc == 0, "checkpoint written and restored");
+    sil_check("PARALLEL", a->hash == b->hash && a->plant.v_mps == b->plant.v_mps,
+              "restored vehicle continues bit-identically");
+
+    blob[CONTROL_CTX_BLOB_SIZE - 1u] ^= 0x01u;
+    sil_check("PARALLEL", Control_CtxRestore(&b->ctx, blob, n) != 0, "corrupted checkpoint rejected");
+
+    free(seq);
+    free(par);
+    SIL_Results_Close();
+}
+
+/* ===== Test: batch pedal map vs scalar path ===== */
+
+#define BATCH_N      (1u << 20)   /* samples per run       */
+#define BATCH_CHUNK  4093u        /* odd chunk: tails too  */
+
+/**
+ * Test: Control_ComputeTorqueBatch over a full 12-bit sweep with the brake
+ * toggling (EV2.3 latch set and cleared across the batch): bit-identical to
+ * Control_ComputeTorqueCtx sample by sample, also when fed in chunks, and
+ * faster per sample.
+ */
+static void test_batch_torque(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: Batch Torque Map (SoA)       ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("batch_torque_test.log");
+    SIL_Results_Log("BATCH", "STARTED", "SoA batch vs scalar torque map + EV2.3 latch");
+
+    char buf[200];
+    uint16_t *s1  = malloc(BATCH_N * sizeof(uint16_t));
+    uint16_t *s2  = malloc(BATCH_N * sizeof(uint16_t));
+    uint16_t *fr  = malloc(BATCH_N * sizeof(uint16_t));
+    uint16_t *tq  = malloc(BATCH_N * sizeof(uint16_t));
+    uint16_t *tqc = malloc(BATCH_N * sizeof(uint16_t));
+    uint8_t  *ev  = malloc(BATCH_N);
+    uint8_t  *evc = malloc(BATCH_N);
+    if (!s1 || !s2 || !fr || !tq || !tqc || !ev || !evc) {
+        sil_check("BATCH", 0, "buffer allocation");
+        goto out;
+    }
+
+    /* s1 sweeps the ADC range, s2 follows with a spread, the brake crosses
+     * the 3000 threshold (equal included) in bursts */
+    uint32_t x = 12345u;
+    for (uint32_t i = 0; i < BATCH_N; i++) {
+        x = x * 1664525u + 1013904223u;
+        s1[i] = (uint16_t)(i & 4095u);
+        s2[i] = (uint16_t)((s1[i] * 3u / 4u + (x >> 20)) & 4095u);
+        fr[i] = ((i >> 9) % 5u == 0u) ? (uint16_t)(2999u + ((x >> 8) & 3u)) : (uint16_t)(x >> 21);
+    }
+
+    /* Scalar reference */
+    ctrl_ctx_t ref, bat, chk;
+    app_inputs_t in;
+    memset(&in, 0, sizeof(in));
+    Control_CtxInit(&ref, 1000u);
+    uint32_t diff = 0, latched = 0, toggles = 0;
+    uint8_t prev = 0;
+    double t0 = sil_now_ns();
+    for (uint32_t i = 0; i < BATCH_N; i++) {
+        uint8_t e = 0;
+        in.s1_aceleracion = s1[i];
+        in.s2_aceleracion = s2[i];
+        in.s_freno        = fr[i];
+        tqc[i] = Control_ComputeTorqueCtx(&ref, &in, &e, NULL);
+        evc[i] = e;
+    }
+    double t_scalar = (sil_now_ns() - t0) / (double)BATCH_N;
+
+    /* One call */
+    const control_batch_in_t bin = { s1, s2, fr };
+    Control_CtxInit(&bat, 1000u);
+    t0 = sil_now_ns();
+    Control_ComputeTorqueBatch(&bat, &bin, BATCH_N, tq, ev);
+    double t_batch = (sil_now_ns() - t0) / (double)BATCH_N;
+
+    for (uint32_t i = 0; i < BATCH_N; i++) {
+        if (tq[i] != tqc[i] || ev[i] != evc[i]) diff++;
+        latched += evc[i];
+        if (evc[i] != prev) toggles++;
+        prev = evc[i];
+    }
+    snprintf(buf, sizeof(buf), "%u samples: %u latched, %u latch edges, %u mismatches",
+             BATCH_N, latched, toggles, diff);
+    printf("[BATCH] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+    sil_check("BATCH", toggles > 100u, "EV2.3 latch exercised across the batch");
+    sil_check("BATCH", diff == 0u && bat.lat_ev23 == ref.lat_ev23, "bit-identical to the scalar path");
+
+    /* Chunked: the latch carries over between calls */
+    Control_CtxInit(&chk, 1000u);
+    diff = 0;
+    for (uint32_t i = 0; i < BATCH_N; i += BATCH_CHUNK) {
+        uint32_t n = (BATCH_N - i < BATCH_CHUNK) ? (BATCH_N - i) : BATCH_CHUNK;
+        const control_batch_in_t cin = { s1 + i, s2 + i, fr + i };
+        Control_ComputeTorqueBatch(&chk, &cin, n, tq + i, ev + i);
+    }
+    for (uint32_t i = 0; i < BATCH_N; i++) {
+        if (tq[i] != tqc[i] || ev[i] != evc[i]) diff++;
+    }
+    sil_check("BATCH", diff == 0u, "chunked batches match (latch carried between calls)");
+
+    /* APPS implausible (one sensor inside the dead band) with a low max_pct:
+     * the mean is above max_pct but the pedal is rejected, 0 on both paths */
+    {
+        apps_cal_t low = APPS_CAL_DEFAULT;
+        low.deadband_pct = 30.0f;
+        low.min_pct      = 40;
+        low.max_pct      = 50;
+        const uint16_t a1[4] = {
+            (uint16_t)(low.s1_offset_adc + 100.0f * low.s1_adc_per_pct),
+            (uint16_t)(low.s1_offset_adc +  20.0f * low.s1_adc_per_pct),
+            (uint16_t)(low.s1_offset_adc + 100.0f * low.s1_adc_per_pct),
+            (uint16_t)(low.s1_offset_adc +  70.0f * low.s1_adc_per_pct) };
+        const uint16_t a2[4] = {
+            (uint16_t)(low.s2_offset_adc +  20.0f * low.s2_adc_per_pct),
+            (uint16_t)(low.s2_offset_adc + 100.0f * low.s2_adc_per_pct),
+            (uint16_t)(low.s2_offset_adc + 100.0f * low.s2_adc_per_pct),
+            (uint16_t)(low.s2_offset_adc +  70.0f * low.s2_adc_per_pct) };
+        const uint16_t af[4] = { 0u, 0u, 0u, 0u };
+        uint16_t at[4];
+        uint8_t  ae[4];
+        const control_batch_in_t ain = { a1, a2, af };
+        Control_CtxInit(&chk, 1000u);
+        int cal_ok = Control_CtxSetAppsCal(&chk, &low) == 0;
+        Control_ComputeTorqueBatch(&chk, &ain, 4u, at, ae);
+        sil_check("BATCH", cal_ok && at[0] == 0u && at[1] == 0u && at[2] == 100u && at[3] == 100u,
+                  "one APPS in the dead band gives 0, not max_pct's 100 %");
+    }
+
+    snprintf(buf, sizeof(buf), "ns/sample: scalar %.2f, batch %.2f (x%.1f)",
+             t_scalar, t_batch, t_scalar / t_batch);
+    printf("[BATCH] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("BATCH", t_batch < t_scalar, "batch faster than per-sample calls");
+
+out:
+    free(s1); free(s2); free(fr); free(tq); free(tqc); free(ev); free(evc);
+    SIL_Results_Close();
+}
+
+/* ===== Test: XCP-on-CAN slave over a socket ===== */
+
+#define XCP_TEST_CYCLES   200u
+#define XCP_BENCH_CYCLES  100000u
+
+/* Datagram socket pair standing in for the dashboard bus: the slave end
+ * (0) carries the packed 16-byte CAN queue items the firmware would put
+ * in canTxQueue / take from canRxQueue, the master end (1) is the tool. */
+static int sil_xcp_fd[2] = { -1, -1 };
+static uint32_t sil_xcp_null_frames;
+
+static void sil_xcp_tx(const can_msg_t *m)
+{
+    can_qitem_t q;
+    CAN_Pack(m, &q);
+    (void)send(sil_xcp_fd[0], &q, sizeof(q), 0);
+}
+
+static void sil_xcp_null_tx(const can_msg_t *m)
+{
+    (void)m;
+    sil_xcp_null_frames++;
+}
+
+/* Slave side of CanRxTask: everything the master sent */
+static void sil_xcp_pump(void)
+{
+    can_qitem_t q;
+    can_msg_t m;
+    while (recv(sil_xcp_fd[0], &q, sizeof(q), MSG_DONTWAIT) == (ssize_t)sizeof(q)) {
+        CAN_Unpack(&q, &m);
+        (void)Xcp_Rx(&m);
+    }
+}
+
+/* Master side: next frame from the slave, 0 if none */
+static int sil_xcp_recv(can_msg_t *m)
+{
+    can_qitem_t q;
+    if (recv(sil_xcp_fd[1], &q, sizeof(q), MSG_DONTWAIT) != (ssize_t)sizeof(q)) return 0;
+    CAN_Unpack(&q, m);
+    return 1;
+}
+
+/* One command round trip; returns the response length (0 = no answer) */
+static uint8_t sil_xcp_cmd(const uint8_t *cro, uint8_t n, can_msg_t *res)
+{
+    can_msg_t m;
+    memset(&m, 0, sizeof(m));
+    m.bus = CAN_BUS_DASH;
+    m.id  = XCP_CRO_ID;
+    m.dlc = n;
+    memcpy(m.data, cro, n);
+    can_qitem_t q;
+    CAN_Pack(&m, &q);
+    (void)send(sil_xcp_fd[1], &q, sizeof(q), 0);
+    sil_xcp_pump();
+    memset(res, 0, sizeof(*res));
+    return sil_xcp_recv(res) ? res->dlc : 0u;
+}
+
+static int sil_xcp_ok(const uint8_t *cro, uint8_t n)
+{
+    can_msg_t r;
+    return sil_xcp_cmd(cro, n, &r) >= 1u && r.data[0] == XCP_PID_RES;
+}
+
+/* ERR code of a command, -1 if it was accepted */
+static int sil_xcp_err(const uint8_t *cro, uint8_t n)
+{
+    can_msg_t r;
+    if (sil_xcp_cmd(cro, n, &r) >= 2u && r.data[0] == XCP_PID_ERR) return r.data[1];
+    return -1;
+}
+
+static void sil_xcp_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static int sil_xcp_write_daq(uint8_t size, uint32_t addr)
+{
+    uint8_t c[8] = { XCP_CMD_WRITE_DAQ, 0xFFu, size, 0u };
+    sil_xcp_put32(&c[4], addr);
+    return sil_xcp_ok(c, 8u);
+}
+
+static int sil_xcp_download_u16(uint32_t addr, uint16_t v)
+{
+    uint8_t mta[8] = { XCP_CMD_SET_MTA, 0u, 0u, 0u };
+    sil_xcp_put32(&mta[4], addr);
+    if (!sil_xcp_ok(mta, 8u)) return -2;
+    const uint8_t dl[4] = { XCP_CMD_DOWNLOAD, 2u, (uint8_t)v, (uint8_t)(v >> 8) };
+    return sil_xcp_err(dl, 4u);
+}
+
+static int16_t sil_le16(const uint8_t *p) { return (int16_t)(p[0] | (p[1] << 8)); }
+
+/**
+ * Test: XCP master on the other end of a socket. Connect and upload,
+ * calibration downloads through the parameter table (range, whole
+ * parameters, busy retry, hot reload into the control context), then two
+ * dynamic DAQ lists sampled by the control cycle in closed loop: every DTO
+ * must carry exactly the inputs/outputs of the cycle that produced it.
+ */
+static void test_xcp(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: XCP-on-CAN slave (socket)    ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("xcp_test.log");
+    SIL_Results_Log("XCP", "STARTED", "XCP slave: connect, upload, calibration, DAQ");
+
+    char buf[200];
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, sil_xcp_fd) != 0) {
+        sil_check("XCP", 0, "socket pair");
+        SIL_Results_Close();
+        return;
+    }
+
+    remove("xcp_calib_flash.bin");
+    Calib_SilSetFlashFile("xcp_calib_flash.bin");
+    Calib_Init();
+    Xcp_Init();
+    Xcp_SetTransport(sil_xcp_tx);
+
+    app_inputs_t in;
+    control_out_t out;
+    memset(&in, 0, sizeof(in));
+    sil_control_to_run(&in, &out);
+
+    /* --- Session ------------------------------------------------------- */
+    can_msg_t r;
+    const uint8_t get_status[1] = { XCP_CMD_GET_STATUS };
+    sil_check("XCP", sil_xcp_cmd(get_status, 1u, &r) == 0u, "no answer before CONNECT");
+    const uint8_t connect[2] = { XCP_CMD_CONNECT, 0u };
+    sil_check("XCP", sil_xcp_cmd(connect, 2u, &r) == 8u && r.data[0] == XCP_PID_RES &&
+              (r.data[1] & 0x05u) == 0x05u && r.data[3] == 8u,
+              "CONNECT: CAL/PAG + DAQ, MAX_CTO 8");
+    const uint8_t info[1] = { XCP_CMD_GET_DAQ_PROCESSOR_INFO };
+    sil_check("XCP", sil_xcp_cmd(info, 1u, &r) == 8u && r.data[2] == XCP_MAX_DAQ &&
+              (r.data[1] & 0x01u), "dynamic DAQ processor");
+
+    osMutexAcquire(g_inMutex, osWaitForever);
+    g_in.s_freno = 1234u;
+    osMutexRelease(g_inMutex);
+    uint8_t su[8] = { XCP_CMD_SHORT_UPLOAD, 2u, 0u, 0u };
+    sil_xcp_put32(&su[4], XCP_ADDR_INPUTS + (uint32_t)offsetof(app_inputs_t, s_freno));
+    sil_check("XCP", sil_xcp_cmd(su, 8u, &r) == 3u && sil_le16(&r.data[1]) == 1234,
+              "SHORT_UPLOAD reads the shared inputs");
+
+    /* --- Calibration --------------------------------------------------- */
+    const uint32_t a_brake = XCP_ADDR_CALIB + (uint32_t)offsetof(calib_data_t, apps.brake_adc);
+    sil_check("XCP", sil_xcp_download_u16(a_brake, 3300u) < 0 &&
+              Calib_Peek()->apps.brake_adc == 3300u, "DOWNLOAD commits the parameter");
+    Control_Step10ms(&in, &out);
+    sil_check("XCP", Control_DefaultCtx()->apps.brake_adc == 3300u,
+              "control picks the value up on the next cycle");
+    sil_check("XCP", sil_xcp_download_u16(a_brake, 3400u) < 0 &&
+              sil_xcp_download_u16(a_brake, 3500u) == XCP_ERR_CMD_BUSY,
+              "second commit before the control cycle: ERR_CMD_BUSY");
+    Control_Step10ms(&in, &out);
+    sil_check("XCP", sil_xcp_download_u16(a_brake, 3500u) < 0 &&
+              Calib_Peek()->apps.brake_adc == 3500u, "retry after one cycle succeeds");
+    Control_Step10ms(&in, &out);
+    sil_check("XCP", sil_xcp_download_u16(a_brake, 5000u) == XCP_ERR_OUT_OF_RANGE &&
+              Calib_Peek()->apps.brake_adc == 3500u, "out-of-range value rejected");
+    sil_check("XCP", sil_xcp_download_u16(a_brake - 1u, 0u) == XCP_ERR_ACCESS_DENIED,
+              "write across a parameter boundary rejected");
+    sil_check("XCP", sil_xcp_download_u16(XCP_ADDR_INPUTS, 0u) == XCP_ERR_WRITE_PROTECTED,
+              "inputs are read-only");
+    const uint8_t up[2] = { XCP_CMD_UPLOAD, 2u };
+    uint8_t mta[8] = { XCP_CMD_SET_MTA, 0u, 0u, 0u };
+    sil_xcp_put32(&mta[4], a_brake);
+    sil_check("XCP", sil_xcp_ok(mta, 8u) && sil_xcp_cmd(up, 2u, &r) == 3u &&
+              sil_le16(&r.data[1]) == 3500, "UPLOAD reads the live calibration");
+    const uint8_t store[2] = { XCP_CMD_SET_REQUEST, XCP_SESSION_STORE_CAL_REQ };
+    calib_stats_t cs;
+    Calib_GetStats(&cs);
+    const uint32_t saves = cs.saves;
+    Calib_Service();
+    Calib_GetStats(&cs);
+    sil_check("XCP", Control_IsRunning() && sil_xcp_err(store, 2u) == XCP_ERR_ACCESS_DENIED &&
+              cs.saves == saves, "STORE_CAL_REQ refused while the car is running");
+
+    /* --- DAQ setup ------------------------------------------------------ */
+    const uint8_t free_daq[1]  = { XCP_CMD_FREE_DAQ };
+    const uint8_t alloc_daq[4] = { XCP_CMD_ALLOC_DAQ, 0u, 2u, 0u };
+    const uint8_t odt0[5]      = { XCP_CMD_ALLOC_ODT, 0u, 0u, 0u, 2u };
+    const uint8_t odt1[5]      = { XCP_CMD_ALLOC_ODT, 0u, 1u, 0u, 1u };
+    const uint8_t ent00[6]     = { XCP_CMD_ALLOC_ODT_ENTRY, 0u, 0u, 0u, 0u, 3u };
+    const uint8_t ent01[6]     = { XCP_CMD_ALLOC_ODT_ENTRY, 0u, 0u, 0u, 1u, 2u };
+    const uint8_t ent10[6]     = { XCP_CMD_ALLOC_ODT_ENTRY, 0u, 1u, 0u, 0u, 1u };
+    int ok = sil_xcp_ok(free_daq, 1u) && sil_xcp_ok(alloc_daq, 4u) &&
+             sil_xcp_ok(odt0, 5u) && sil_xcp_ok(odt1, 5u);
+    sil_check("XCP", ok && sil_xcp_err(alloc_daq, 4u) == XCP_ERR_SEQUENCE,
+              "ALLOC_DAQ after ALLOC_ODT: ERR_SEQUENCE");
+    ok = sil_xcp_ok(ent00, 6u) && sil_xcp_ok(ent01, 6u) && sil_xcp_ok(ent10, 6u);
+
+    /* List 0, ODT 0: the three pedal/brake words (adjacent: one copy)
+     * List 0, ODT 1: torque command (output) and rpm (input)
+     * List 1, ODT 0: live brake threshold, every 10th cycle */
+    const uint8_t ptr00[6] = { XCP_CMD_SET_DAQ_PTR, 0u, 0u, 0u, 0u, 0u };
+    const uint8_t ptr01[6] = { XCP_CMD_SET_DAQ_PTR, 0u, 0u, 0u, 1u, 0u };
+    const uint8_t ptr10[6] = { XCP_CMD_SET_DAQ_PTR, 0u, 1u, 0u, 0u, 0u };
+    ok = ok && sil_xcp_ok(ptr00, 6u) &&
+         sil_xcp_write_daq(2u, XCP_ADDR_INPUTS + (uint32_t)offsetof(app_inputs_t, s1_aceleracion)) &&
+         sil_xcp_write_daq(2u, XCP_ADDR_INPUTS + (uint32_t)offsetof(app_inputs_t, s2_aceleracion)) &&
+         sil_xcp_write_daq(2u, XCP_ADDR_INPUTS + (uint32_t)offsetof(app_inputs_t, s_freno)) &&
+         sil_xcp_ok(ptr01, 6u) &&
+         sil_xcp_write_daq(2u, XCP_ADDR_OUTPUT + (uint32_t)offsetof(control_out_t, torque_pct)) &&
+         sil_xcp_write_daq(2u, XCP_ADDR_INPUTS + (uint32_t)offsetof(app_inputs_t, inv_rpm)) &&
+         sil_xcp_ok(ptr10, 6u) &&
+         sil_xcp_write_daq(2u, a_brake);
+    sil_check("XCP", ok, "two lists, three ODTs, six entries written");
+
+    uint8_t bad[8] = { XCP_CMD_WRITE_DAQ, 0xFFu, 4u, 0u };
+    sil_xcp_put32(&bad[4], XCP_ADDR_INPUTS + (uint32_t)sizeof(app_inputs_t) - 2u);
+    sil_check("XCP", sil_xcp_ok(ptr10, 6u) && sil_xcp_err(bad, 8u) == XCP_ERR_OUT_OF_RANGE &&
+              sil_xcp_write_daq(2u, a_brake), "entry past the end of a segment rejected");
+
+    const uint8_t mode0[8] = { XCP_CMD_SET_DAQ_LIST_MODE, 0u, 0u, 0u, XCP_EVENT_CTRL, 0u, 1u, 0u };
+    const uint8_t mode1[8] = { XCP_CMD_SET_DAQ_LIST_MODE, 0u, 1u, 0u, XCP_EVENT_CTRL, 0u, 10u, 0u };
+    const uint8_t mode_ts[8] = { XCP_CMD_SET_DAQ_LIST_MODE, 0x10u, 1u, 0u, XCP_EVENT_CTRL, 0u, 1u, 0u };
+    sil_check("XCP", sil_xcp_ok(mode0, 8u) && sil_xcp_ok(mode1, 8u) &&
+              sil_xcp_err(mode_ts, 8u) == XCP_ERR_MODE_NOT_VALID,
+              "list modes set, timestamp mode refused");
+
+    const uint8_t sel0[4] = { XCP_CMD_START_STOP_DAQ_LIST, 2u, 0u, 0u };
+    const uint8_t sel1[4] = { XCP_CMD_START_STOP_DAQ_LIST, 2u, 1u, 0u };
+    const uint8_t synch_start[2] = { XCP_CMD_START_STOP_SYNCH, 1u };
+    uint8_t pid0 = 0xFFu, pid1 = 0xFFu;
+    if (sil_xcp_cmd(sel0, 4u, &r) == 2u && r.data[0] == XCP_PID_RES) pid0 = r.data[1];
+    if (sil_xcp_cmd(sel1, 4u, &r) == 2u && r.data[0] == XCP_PID_RES) pid1 = r.data[1];
+    sil_check("XCP", pid0 == 0u && pid1 == 2u && sil_xcp_ok(synch_start, 2u),
+              "lists selected (first PIDs 0 and 2) and started together");
+    sil_check("XCP", sil_xcp_cmd(get_status, 1u, &r) == 6u &&
+              (r.data[1] & XCP_SESSION_DAQ_RUNNING), "GET_STATUS: DAQ running");
+
+    /* --- Closed loop: every DTO against the cycle that produced it ------ */
+    uint32_t frames[3] = { 0u, 0u, 0u }, mismatch = 0, stray = 0;
+    for (uint32_t k = 0; k < XCP_TEST_CYCLES; k++) {
+        in.s1_aceleracion = (uint16_t)(2050u + (k * 37u) % 900u);
+        in.s2_aceleracion = (uint16_t)(1915u + (k * 29u) % 700u);
+        in.s_freno        = (uint16_t)((k * 13u) % 400u);
+        in.inv_rpm        = (int16_t)(k * 25u);
+        Control_Step10ms(&in, &out);
+        Xcp_Event(XCP_EVENT_CTRL, &in, &out);
+        SIL_AdvanceTick(1);
+
+        while (sil_xcp_recv(&r)) {
+            const uint8_t pid = r.data[0];
+            if (pid == 0u && r.dlc == 7u) {
+                frames[0]++;
+                if ((uint16_t)sil_le16(&r.data[1]) != in.s1_aceleracion ||
+                    (uint16_t)sil_le16(&r.data[3]) != in.s2_aceleracion ||
+                    (uint16_t)sil_le16(&r.data[5]) != in.s_freno) mismatch++;
+            } else if (pid == 1u && r.dlc == 5u) {
+                frames[1]++;
+                if (sil_le16(&r.data[1]) != out.torque_pct ||
+                    sil_le16(&r.data[3]) != in.inv_rpm) mismatch++;
+            } else if (pid == 2u && r.dlc == 3u) {
+                frames[2]++;
+                if (sil_le16(&r.data[1]) != 3500) mismatch++;
+            } else {
+                stray++;
+            }
+        }
+    }
+    snprintf(buf, sizeof(buf), "%u cycles: PID0 %u, PID1 %u, PID2 %u frames, %u mismatches, %u stray",
+             XCP_TEST_CYCLES, frames[0], frames[1], frames[2], mismatch, stray);
+    printf("[XCP] %s\n", buf);
+    SIL_Results_LogEvent(0, "RESULT", buf);
+    sil_check("XCP", frames[0] == XCP_TEST_CYCLES && frames[1] == XCP_TEST_CYCLES &&
+              frames[2] == XCP_TEST_CYCLES / 10u && stray == 0u,
+              "one sample per cycle, prescaler 10 on list 1");
+    sil_check("XCP", mismatch == 0u, "DTOs carry the same cycle's inputs and outputs");
+
+    /* Per-cycle cost of the compiled copy lists (frames to a null sink) */
+    Xcp_SetTransport(sil_xcp_null_tx);
+    sil_xcp_null_frames = 0;
+    double t0 = sil_now_ns();
+    for (uint32_t k = 0; k < XCP_BENCH_CYCLES; k++) {
+        in.s1_aceleracion = (uint16_t)k;
+        Xcp_Event(XCP_EVENT_CTRL, &in, &out);
+    }
+    double t_cycle = (sil_now_ns() - t0) / (double)XCP_BENCH_CYCLES;
+    Xcp_SetTransport(sil_xcp_tx);
+    snprintf(buf, sizeof(buf), "DAQ sample: %.1f ns/cycle (%u frames)", t_cycle, sil_xcp_null_frames);
+    printf("[XCP] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("XCP", t_cycle < 1000.0, "DAQ sampling well below 1 us per cycle");
+
+    /* --- Stop ----------------------------------------------------------- */
+    const uint8_t synch_stop[2] = { XCP_CMD_START_STOP_SYNCH, 0u };
+    const uint8_t disconnect[1] = { XCP_CMD_DISCONNECT };
+    ok = sil_xcp_ok(synch_stop, 2u);
+    Control_Step10ms(&in, &out);
+    Xcp_Event(XCP_EVENT_CTRL, &in, &out);
+    sil_check("XCP", ok && !sil_xcp_recv(&r), "no DTO after START_STOP_SYNCH stop");
+    sil_check("XCP", sil_xcp_ok(disconnect, 1u) && !Xcp_IsConnected() &&
+              sil_xcp_cmd(get_status, 1u, &r) == 0u, "DISCONNECT ends the session");
+
+    /* Leave the defaults live for whoever runs next */
+    Calib_StageDefaults();
+    (void)Calib_Commit();
+    Control_Step10ms(&in, &out);
+    Xcp_SetTransport(NULL);
+    close(sil_xcp_fd[0]);
+    close(sil_xcp_fd[1]);
+    remove("xcp_calib_flash.bin");
+    SIL_Results_Close();
+}
+
+/* ===== Test: UDS server over ISO-TP (host tester, simulated bus) ===== */
+
+#define SIL_BUS_FRAME_US   240u    /* 8-byte std frame at 500 kbit/s, ~10 stuff bits */
+#define SIL_RX_PASS_US     5000u   /* CanRxTask period                        */
+#define SIL_HW_TX_FIFO     16u     /* FDCAN3 TX FIFO elements                 */
+
+typedef struct
+{
+    can_msg_t f[128];
+    uint32_t  head, n, cap;
+} sil_fifo_t;
+
+static sil_fifo_t   sil_ecu_tx, sil_tst_tx, sil_ecu_rx;
+static isotp_link_t sil_tst;          /* the tester's end of the link */
+static uint32_t     sil_uds_now, sil_uds_pass;
+static uint8_t      sil_uds_rsp[ISOTP_MAX_PAYLOAD];
+
+static int sil_fifo_push(sil_fifo_t *q, const can_msg_t *m)
+{
+    if (q->n >= q->cap) return -1;
+    q->f[(q->head + q->n) % 128u] = *m;
+    q->n++;
+    return 0;
+}
+
+static int sil_fifo_pop(sil_fifo_t *q, can_msg_t *m)
+{
+    if (q->n == 0u) return 0;
+    *m = q->f[q->head];
+    q->head = (q->head + 1u) % 128u;
+    q->n--;
+    return 1;
+}
+
+static int sil_ecu_tx_fn(const can_msg_t *m) { return sil_fifo_push(&sil_ecu_tx, m); }
+static int sil_tst_tx_fn(const can_msg_t *m) { return sil_fifo_push(&sil_tst_tx, m); }
+
+static uint32_t sil_null_frames;
+static int sil_null_tx_fn(const can_msg_t *m) { (void)m; sil_null_frames++; return 0; }
+
+static void sil_uds_bus_reset(void)
+{
+    memset(&sil_ecu_tx, 0, sizeof(sil_ecu_tx));
+    memset(&sil_tst_tx, 0, sizeof(sil_tst_tx));
+    memset(&sil_ecu_rx, 0, sizeof(sil_ecu_rx));
+    sil_ecu_tx.cap = SIL_HW_TX_FIFO;
+    sil_tst_tx.cap = 64u;
+    sil_ecu_rx.cap = 128u;                       /* canRxQueue depth */
+}
+
+/* One bus slot: the tester's 0x7E0 wins arbitration over the ECU's 0x7E8.
+ * The ECU sees its frames at the next CanRxTask pass, the tester at once. */
+static void sil_uds_slot(void)
+{
+    can_msg_t m;
+    if (sil_fifo_pop(&sil_tst_tx, &m)) {
+        (void)sil_fifo_push(&sil_ecu_rx, &m);
+    } else if (sil_fifo_pop(&sil_ecu_tx, &m)) {
+        (void)Isotp_OnFrame(&sil_tst, &m, sil_uds_now);
+    }
+    (void)Isotp_Poll(&sil_tst, sil_uds_now, 4u);
+
+    if ((int32_t)(sil_uds_now - sil_uds_pass) >= 0) {
+        sil_uds_pass += SIL_RX_PASS_US;
+        while (sil_fifo_pop(&sil_ecu_rx, &m)) (void)Uds_Rx(&m, sil_uds_now);
+        const uint32_t queued = sil_ecu_tx.n;
+        Uds_Service(sil_uds_now, (queued < UDS_TX_FIFO_SHARE) ? UDS_TX_FIFO_SHARE - queued : 0u);
+    }
+    sil_uds_now += SIL_BUS_FRAME_US;
+}
+
+/* Request → response (copied to sil_uds_rsp). Returns its length, 0 if
+ * nothing came back within wait_us; *t_us = time to the last frame. */
+static uint16_t sil_uds_xfer(const uint8_t *req, uint16_t n, uint32_t wait_us, uint32_t *t_us)
+{
+    uint8_t *b = Isotp_BufAlloc();
+    if (!b) return 0;
+    memcpy(b, req, n);
+    const uint32_t t0 = sil_uds_now;
+    (void)Isotp_Send(&sil_tst, b, n, sil_uds_now);
+    while ((int32_t)(sil_uds_now - t0) < (int32_t)wait_us) {
+        sil_uds_slot();
+        uint16_t rn = 0;
+        uint8_t *r = Isotp_Receive(&sil_tst, &rn);
+        if (r) {
+            memcpy(sil_uds_rsp, r, rn);
+            Isotp_BufFree(r);
+            if (t_us) *t_us = sil_uds_now - t0;
+            return rn;
+        }
+    }
+    return 0;
+}
+
+static int sil_uds_nrc(const uint8_t *req, uint16_t n)
+{
+    uint16_t rn = sil_uds_xfer(req, n, 200000u, NULL);
+    return (rn == 3u && sil_uds_rsp[0] == 0x7Fu && sil_uds_rsp[1] == req[0]) ? sil_uds_rsp[2] : -1;
+}
+
+/**
+ * Test: UDS server behind ISO-TP against a host tester on a simulated
+ * 500 kbit/s bus (frame-time slots, tester wins arbitration, the ECU
+ * serviced every CanRxTask pass with its TX FIFO share): services,
+ * fault memory, routines, then throughput of 4 KB transfers in both
+ * directions with the tuned flow control against a conservative one.
+ */
+static void test_uds(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: UDS over ISO-TP (tester)     ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("uds_test.log");
+    SIL_Results_Log("UDS", "STARTED", "UDS server: services, DTCs, routines, ISO-TP throughput");
+
+    char buf[200];
+    remove("uds_calib_flash.bin");
+    Calib_SilSetFlashFile("uds_calib_flash.bin");
+    Calib_Init();
+    Uds_Init();
+    Uds_SetTransport(sil_ecu_tx_fn);
+    sil_uds_bus_reset();
+    Isotp_Init(&sil_tst, CAN_BUS_DASH, UDS_REQ_ID, UDS_RSP_ID, sil_tst_tx_fn);
+    sil_uds_now = 0u;
+    sil_uds_pass = 0u;
+
+    app_inputs_t in;
+    control_out_t out;
+    memset(&in, 0, sizeof(in));
+    Control_Init();
+    Control_Step10ms(&in, &out);
+
+    /* --- ReadDataByIdentifier ------------------------------------------ */
+    osMutexAcquire(g_inMutex, osWaitForever);
+    g_in.s_freno = 0x0ABCu;
+    g_in.inv_rpm = -1234;
+    g_in.imu_acc_mg[0] = 10; g_in.imu_acc_mg[1] = -20; g_in.imu_acc_mg[2] = 1000;
+    osMutexRelease(g_inMutex);
+
+    const uint8_t rd2[5] = { 0x22u, 0x01u, 0x02u, 0x01u, 0x15u };
+    uint16_t rn = sil_uds_xfer(rd2, 5u, 200000u, NULL);
+    sil_check("UDS", rn == 9u && sil_uds_rsp[0] == 0x62u &&
+              sil_uds_rsp[3] == 0x0Au && sil_uds_rsp[4] == 0xBCu &&
+              (int16_t)((sil_uds_rsp[7] << 8) | sil_uds_rsp[8]) == -1234,
+              "RDBI: two DIDs, big endian");
+    const uint8_t rd_imu[3] = { 0x22u, 0x01u, 0x30u };
+    rn = sil_uds_xfer(rd_imu, 3u, 200000u, NULL);
+    sil_check("UDS", rn == 9u && (int16_t)((sil_uds_rsp[5] << 8) | sil_uds_rsp[6]) == -20 &&
+              sil_uds_rsp[7] == 0x03u && sil_uds_rsp[8] == 0xE8u, "RDBI: array DID (IMU accel)");
+    const uint8_t rd_snap[3] = { 0x22u, 0x01u, 0xFFu };
+    rn = sil_uds_xfer(rd_snap, 3u, 200000u, NULL);
+    app_inputs_t snap;
+    memcpy(&snap, &sil_uds_rsp[3], sizeof(snap));
+    sil_check("UDS", rn == 3u + sizeof(app_inputs_t) && snap.s_freno == 0x0ABCu &&
+              snap.inv_rpm == -1234, "RDBI 0x01FF: whole snapshot, multi-frame");
+    const uint8_t rd_bad[3] = { 0x22u, 0x12u, 0x34u };
+    const uint8_t rd_len[2] = { 0x22u, 0x01u };
+    sil_check("UDS", sil_uds_nrc(rd_bad, 3u) == UDS_NRC_REQUEST_OUT_OF_RANGE &&
+              sil_uds_nrc(rd_len, 2u) == UDS_NRC_INCORRECT_LENGTH,
+              "unknown DID / odd length: NRC 0x31 / 0x13");
+    const uint8_t unknown[2] = { 0x27u, 0x01u };
+    sil_check("UDS", sil_uds_nrc(unknown, 2u) == UDS_NRC_SERVICE_NOT_SUPPORTED,
+              "SecurityAccess not supported: NRC 0x11");
+
+    /* --- Sessions, TesterPresent, functional addressing ----------------- */
+    const uint8_t tp_supp[2] = { 0x3Eu, 0x80u };
+    sil_check("UDS", sil_uds_xfer(tp_supp, 2u, 50000u, NULL) == 0u,
+              "TesterPresent with suppress bit: no response");
+    const uint8_t rc_apps[4] = { 0x31u, 0x01u, 0x03u, 0x01u };
+    sil_check("UDS", sil_uds_nrc(rc_apps, 4u) == UDS_NRC_NOT_IN_ACTIVE_SESSION,
+              "RoutineControl in default session: NRC 0x7F");
+    const uint8_t prog[2] = { 0x10u, 0x02u };
+    sil_check("UDS", sil_uds_nrc(prog, 2u) == UDS_NRC_CONDITIONS_NOT_CORRECT,
+              "programming session from default: NRC 0x22");
+    const uint8_t ext[2] = { 0x10u, 0x03u };
+    rn = sil_uds_xfer(ext, 2u, 200000u, NULL);
+    uds_stats_t us;
+    Uds_GetStats(&us);
+    sil_check("UDS", rn == 6u && sil_uds_rsp[0] == 0x50u && us.session == 3u,
+              "extended session entered");
+
+    /* --- Routines -------------------------------------------------------- */
+    rn = sil_uds_xfer(rc_apps, 4u, 200000u, NULL);
+    sil_check("UDS", rn == 7u && sil_uds_rsp[0] == 0x71u && sil_uds_rsp[5] == 0u,
+              "pedal map self-test passes with the default calibration");
+    const uint8_t rc_save[4]  = { 0x31u, 0x01u, 0x02u, 0x01u };
+    const uint8_t rc_saveq[4] = { 0x31u, 0x03u, 0x02u, 0x01u };
+    sil_check("UDS", sil_uds_nrc(rc_saveq, 4u) == UDS_NRC_REQUEST_SEQUENCE_ERROR,
+              "save results before start: NRC 0x24");
+    rn = sil_uds_xfer(rc_save, 4u, 200000u, NULL);
+    int pending = (sil_uds_xfer(rc_saveq, 4u, 200000u, NULL) == 6u && sil_uds_rsp[5] == 1u);
+    Calib_Service();                             /* diag task */
+    calib_stats_t cs;
+    Calib_GetStats(&cs);
+    sil_check("UDS", rn == 5u && pending && sil_uds_xfer(rc_saveq, 4u, 200000u, NULL) == 6u &&
+              sil_uds_rsp[5] == 0u && cs.saves == 1u,
+              "calibration save: in progress, then done");
+
+    /* --- Fault memory ---------------------------------------------------- */
+    Control_DefaultCtx()->lat_ev23 = 1u;
+    for (uint32_t i = 0; i < UDS_DTC_CONFIRM; i++) Uds_Monitor(&in);
+    Control_DefaultCtx()->lat_ev23 = 0u;
+    Uds_Monitor(&in);
+    const uint8_t dtc_conf[3] = { 0x19u, 0x02u, UDS_DTC_CONFIRMED };
+    rn = sil_uds_xfer(dtc_conf, 3u, 200000u, NULL);
+    sil_check("UDS", rn == 7u && sil_uds_rsp[3] == 0x22u && sil_uds_rsp[4] == 0x99u &&
+              (sil_uds_rsp[6] & (UDS_DTC_CONFIRMED | UDS_DTC_TEST_FAILED)) == UDS_DTC_CONFIRMED,
+              "EV2.3 DTC confirmed after 3 failing runs, no longer failing");
+    const uint8_t dtc_all[2] = { 0x19u, 0x0Au };
+    rn = sil_uds_xfer(dtc_all, 2u, 200000u, NULL);
+    sil_check("UDS", rn == 3u + 4u * UDS_DTC_COUNT, "0x19 0A lists every supported DTC");
+    const uint8_t clr[4] = { 0x14u, 0xFFu, 0xFFu, 0xFFu };
+    const uint8_t dtc_cnt[3] = { 0x19u, 0x01u, UDS_DTC_FAILED_SINCE_CLEAR };
+    rn = sil_uds_xfer(clr, 4u, 200000u, NULL);
+    const int clr_ok = (rn == 1u && sil_uds_rsp[0] == 0x54u);
+    rn = sil_uds_xfer(dtc_cnt, 3u, 200000u, NULL);
+    sil_check("UDS", clr_ok && rn == 6u &&
+              sil_uds_rsp[4] == 0u && sil_uds_rsp[5] == 0u, "ClearDiagnosticInformation empties the memory");
+
+    /* --- Throughput: ECU → tester (4095-byte pattern) -------------------- */
+    const uint8_t rd_pat[3] = { 0x22u, 0xF1u, 0xF0u };
+    uint32_t t_fast = 0, t_slow = 0;
+    rn = sil_uds_xfer(rd_pat, 3u, 3000000u, &t_fast);
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < UDS_PATTERN_LEN; i++) bad += sil_uds_rsp[3u + i] != (uint8_t)(i ^ (i >> 8));
+    const double kbs_read = (double)rn / ((double)t_fast * 1e-6) / 1024.0;
+    sil_tst.bs = 8u;                              /* conservative tester FC */
+    sil_tst.stmin = 5u;
+    (void)sil_uds_xfer(rd_pat, 3u, 10000000u, &t_slow);
+    sil_tst.bs = ISOTP_DEFAULT_BS;
+    sil_tst.stmin = ISOTP_DEFAULT_STMIN;
+    snprintf(buf, sizeof(buf), "read 4095 B: %.1f ms (%.1f KB/s), tester FC BS 8/STmin 5: %.1f ms",
+             t_fast * 1e-3, kbs_read, t_slow * 1e-3);
+    printf("[UDS] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("UDS", rn == ISOTP_MAX_PAYLOAD && bad == 0u, "4095-byte response intact");
+    sil_check("UDS", kbs_read > 12.0, "ECU to tester above 12 KB/s (12 frames per 5 ms pass)");
+
+    /* --- Throughput: tester → ECU (4095-byte request) -------------------- */
+    static uint8_t big[ISOTP_MAX_PAYLOAD];
+    big[0] = 0x22u;
+    for (uint32_t i = 1; i + 1u < sizeof(big); i += 2u) { big[i] = 0x01u; big[i + 1u] = 0x00u; }
+    uint32_t t_up = 0, t_up_slow = 0;
+    int nrc_ok = (sil_uds_xfer(big, ISOTP_MAX_PAYLOAD, 3000000u, &t_up) == 3u &&
+                  sil_uds_rsp[2] == UDS_NRC_RESPONSE_TOO_LONG);
+    Uds_Link()->bs = 8u;                          /* conservative ECU FC */
+    Uds_Link()->stmin = 5u;
+    (void)sil_uds_xfer(big, ISOTP_MAX_PAYLOAD, 10000000u, &t_up_slow);
+    Uds_Link()->bs = ISOTP_DEFAULT_BS;
+    Uds_Link()->stmin = ISOTP_DEFAULT_STMIN;
+    const double kbs_up = (double)ISOTP_MAX_PAYLOAD / ((double)t_up * 1e-6) / 1024.0;
+    snprintf(buf, sizeof(buf), "write 4095 B: %.1f ms (%.1f KB/s), ECU FC BS 8/STmin 5: %.1f ms",
+             t_up * 1e-3, kbs_up, t_up_slow * 1e-3);
+    printf("[UDS] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("UDS", nrc_ok, "2047-DID request reassembled, NRC 0x14 response too long");
+    sil_check("UDS", kbs_up > 25.0 && t_up * 3u < t_up_slow,
+              "BS 0 / STmin 0 runs at bus speed, 3x the conservative setting");
+
+    /* Segmentation cost on the host (frames to a null sink) */
+    isotp_link_t bench;
+    Isotp_Init(&bench, CAN_BUS_DASH, UDS_RSP_ID, UDS_REQ_ID, sil_null_tx_fn);
+    const can_msg_t fc = { .bus = CAN_BUS_DASH, .id = UDS_REQ_ID, .dlc = 8u, .data = { 0x30u, 0u, 0u } };
+    sil_null_frames = 0;
+    double t0 = sil_now_ns();
+    for (uint32_t k = 0; k < 200u; k++) {
+        uint8_t *b = Isotp_BufAlloc();
+        (void)Isotp_Send(&bench, b, ISOTP_MAX_PAYLOAD, 0u);
+        (void)Isotp_OnFrame(&bench, &fc, 0u);
+        (void)Isotp_Poll(&bench, 0u, UINT32_MAX);
+    }
+    const double ns_frame = (sil_now_ns() - t0) / (double)sil_null_frames;
+    snprintf(buf, sizeof(buf), "segmentation: %.1f ns/frame (%u frames)", ns_frame, sil_null_frames);
+    printf("[UDS] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+
+    /* --- Programming session: reset into the bootloader ------------------ */
+    (void)sil_uds_xfer(ext, 2u, 200000u, NULL);
+    rn = sil_uds_xfer(prog, 2u, 200000u, NULL);
+    const uint8_t boot_now = Fwu_SilBootRequested();
+    for (uint32_t k = 0; k < 40000u / SIL_BUS_FRAME_US; k++) sil_uds_slot();
+    sil_check("UDS", rn == 6u && sil_uds_rsp[0] == 0x50u && sil_uds_rsp[1] == 0x02u &&
+              !boot_now && Fwu_SilBootRequested(),
+              "10 02 answered first, then reset into the bootloader");
+
+    /* --- Session timeout, pool ------------------------------------------- */
+    for (uint32_t k = 0; k < UDS_S3_US / SIL_BUS_FRAME_US + 50u; k++) sil_uds_slot();
+    Uds_GetStats(&us);
+    sil_check("UDS", us.session == 1u, "S3 timeout: back to the default session");
+    sil_check("UDS", Isotp_BufFreeCount() == ISOTP_POOL_BUFS, "every pool buffer returned");
+
+    Uds_SetTransport(NULL);
+    remove("uds_calib_flash.bin");
+    SIL_Results_Close();
+}
+
+/* Frame time on the bus, µs, with one stuff bit in ten of the stuffed
+ * fields. Classic: the whole frame at 500 kbit/s (240 µs for 8 bytes, as
+ * SIL_BUS_FRAME_US). FD: arbitration, ACK, EOF and IFS at 500 kbit/s
+ * (32 bits); ESI, DLC, data, stuff count, CRC 17/21 with its fixed stuff
+ * bits and delimiter at data_kbps. */
+static double sil_frame_us(uint8_t len, int fd, uint32_t data_kbps)
+{
+    if (!fd) {
+        return (double)(47u + 8u * len + (34u + 8u * len) / 10u) * 2.0;
+    }
+    const uint32_t crc = (len > 16u) ? 21u : 17u;
+    uint32_t data_bits = 1u + 4u + 8u * len + 4u + crc + (crc + 4u + 3u) / 4u + 1u;
+    data_bits += (5u + 8u * len) / 10u;
+    return 32.0 * 2.0 + (double)data_bits * 1000.0 / (double)data_kbps;
+}
+
+/**
+ * Test: CAN-FD end to end without hardware. DLC tables, 72-byte queue
+ * items through canRxQueue, CanTx_SendHal header mapping on the FD bus
+ * (FDCAN3) and on the classic inverter bus (FDCAN1), the RX ISR path with
+ * 64-byte frames, then payload throughput per bus time and pack/unpack
+ * cost.
+ */
+static void test_canfd(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: CAN-FD 64-byte frames + BRS   ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("canfd_test.log");
+    SIL_Results_Log("CANFD", "STARTED", "DLC mapping, queue items, TX header, RX ISR, throughput");
+
+    extern FDCAN_HandleTypeDef hfdcan1, hfdcan3;
+    char buf[200];
+    SIL_RTOS_Init();
+
+    /* --- DLC tables ------------------------------------------------------- */
+    static const uint8_t fd_len[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+    int dlc_ok = 1;
+    for (uint32_t d = 0; d < 16u; d++) {
+        if (Can_DlcToLen((uint8_t)d) != fd_len[d] || Can_LenToDlc(fd_len[d]) != d) dlc_ok = 0;
+    }
+    for (uint32_t len = 0; len <= CAN_MAX_DLEN; len++) {
+        const uint8_t got = Can_DlcToLen(Can_LenToDlc((uint8_t)len));
+        if (got < len || (Can_LenToDlc((uint8_t)len) > 0u &&
+                          Can_DlcToLen((uint8_t)(Can_LenToDlc((uint8_t)len) - 1u)) >= len)) dlc_ok = 0;
+    }
+    sil_check("CANFD", dlc_ok && Can_LenToDlc(200u) == 15u,
+              "DLC <-> length tables: exact for valid lengths, others round up");
+    sil_check("CANFD", Can_BusIsFd(CAN_BUS_DASH) && !Can_BusIsFd(CAN_BUS_INV) && !Can_BusIsFd(CAN_BUS_ACU),
+              "FDCAN3 runs FD + BRS, inverter and ACU buses stay classic");
+
+    /* --- Queue items --------------------------------------------------------- */
+    can_msg_t fdm, back;
+    memset(&fdm, 0, sizeof(fdm));
+    fdm.bus = CAN_BUS_DASH;
+    fdm.id  = 0x321u;
+    fdm.dlc = 64u;
+    fdm.fd  = 1u;
+    for (uint32_t i = 0; i < 64u; i++) fdm.data[i] = (uint8_t)(i * 7u + 1u);
+    can_qitem_t qi;
+    CAN_Pack(&fdm, &qi);
+    int q_ok = osMessageQueuePut(canRxQueueHandle, &qi, 0, 0) == osOK;
+    memset(&qi, 0, sizeof(qi));
+    q_ok = q_ok && osMessageQueueGet(canRxQueueHandle, &qi, NULL, 0) == osOK;
+    memset(&back, 0, sizeof(back));
+    CAN_Unpack(&qi, &back);
+    sil_check("CANFD", q_ok && sizeof(can_qitem_t) == 72u && back.id == fdm.id && back.dlc == 64u &&
+              back.fd == 1u && back.bus == CAN_BUS_DASH && memcmp(back.data, fdm.data, 64u) == 0,
+              "64-byte FD frame through a 72-byte canRxQueue item");
+
+    can_msg_t cm;
+    memset(&cm, 0, sizeof(cm));
+    cm.bus = CAN_BUS_INV; cm.id = 0x201u; cm.dlc = 3u; cm.ide = 0u; cm.burst = 4u;
+    for (uint32_t i = 0; i < 8u; i++) cm.data[i] = (uint8_t)(0xA0u + i);
+    CAN_Pack(&cm, &qi);
+    CAN_Unpack(&qi, &back);
+    sil_check("CANFD", back.dlc == 3u && back.fd == 0u && back.burst == 4u &&
+              memcmp(back.data, cm.data, 8u) == 0,
+              "classic frame: fields and data[0..7] kept as before");
+
+    /* --- TX header mapping --------------------------------------------------- */
+    FDCAN_HandleTypeDef *h = NULL;
+    FDCAN_TxHeaderTypeDef th;
+    uint8_t td[64];
+    uint32_t n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    HAL_StatusTypeDef st = CanTx_SendHal(&fdm);
+    uint32_t n1 = SIL_Fdcan_LastTx(&h, &th, td);
+    sil_check("CANFD", st == HAL_OK && n1 == n0 + 1u && h == &hfdcan3 && th.DataLength == FDCAN_DLC_BYTES_64 &&
+              th.FDFormat == FDCAN_FD_CAN && th.BitRateSwitch == FDCAN_BRS_ON &&
+              memcmp(td, fdm.data, 64u) == 0,
+              "FD frame on FDCAN3: DLC 15, FD format, BRS on, 64 bytes out");
+
+    fdm.dlc = 10u;
+    st = CanTx_SendHal(&fdm);
+    (void)SIL_Fdcan_LastTx(&h, &th, td);
+    sil_check("CANFD", st == HAL_OK && th.DataLength == FDCAN_DLC_BYTES_12 &&
+              memcmp(td, fdm.data, 10u) == 0 && td[10] == 0xCCu && td[11] == 0xCCu,
+              "10-byte FD payload: DLC 9 (12 bytes), tail padded 0xCC");
+
+    fdm.bus = CAN_BUS_INV;
+    fdm.dlc = 64u;
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    st = CanTx_SendHal(&fdm);
+    n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_check("CANFD", st == HAL_ERROR && n1 == n0, "64 bytes on the classic inverter bus refused");
+
+    fdm.dlc = 8u;
+    st = CanTx_SendHal(&fdm);
+    (void)SIL_Fdcan_LastTx(&h, &th, td);
+    sil_check("CANFD", st == HAL_OK && h == &hfdcan1 && th.FDFormat == FDCAN_CLASSIC_CAN &&
+              th.BitRateSwitch == FDCAN_BRS_OFF && th.DataLength == FDCAN_DLC_BYTES_8,
+              "fd = 1 with 8 bytes on the inverter bus goes out classic");
+
+    cm.dlc = 8u;
+    st = CanTx_SendHal(&cm);
+    (void)SIL_Fdcan_LastTx(&h, &th, td);
+    sil_check("CANFD", st == HAL_OK && th.FDFormat == FDCAN_CLASSIC_CAN && th.DataLength == 8u &&
+              memcmp(td, cm.data, 8u) == 0,
+              "classic inverter frame unchanged (unshifted HAL DLC code)");
+
+    /* --- RX ISR path --------------------------------------------------------- */
+    FDCAN_RxHeaderTypeDef rh;
+    memset(&rh, 0, sizeof(rh));
+    rh.Identifier = 0x322u;
+    rh.IdType     = FDCAN_STANDARD_ID;
+    rh.DataLength = FDCAN_DLC_BYTES_48;
+    rh.FDFormat   = FDCAN_FD_CAN;
+    rh.BitRateSwitch = FDCAN_BRS_ON;
+    uint8_t rd[64];
+    for (uint32_t i = 0; i < 64u; i++) rd[i] = (uint8_t)(0xFFu - i);
+    SIL_Fdcan_InjectRx(&hfdcan3, &rh, rd);
+    Can_ISR_PushRxFifo0(&hfdcan3);
+    rh.Identifier = 0x181u;
+    rh.DataLength = FDCAN_DLC_BYTES_8;
+    rh.FDFormat   = FDCAN_CLASSIC_CAN;
+    rh.BitRateSwitch = FDCAN_BRS_OFF;
+    SIL_Fdcan_InjectRx(&hfdcan1, &rh, rd);
+    Can_ISR_PushRxFifo0(&hfdcan1);
+
+    can_msg_t r1, r2;
+    int rx_ok = osMessageQueueGet(canRxQueueHandle, &qi, NULL, 0) == osOK;
+    CAN_Unpack(&qi, &r1);
+    rx_ok = rx_ok && osMessageQueueGet(canRxQueueHandle, &qi, NULL, 0) == osOK;
+    CAN_Unpack(&qi, &r2);
+    sil_check("CANFD", rx_ok && r1.bus == CAN_BUS_DASH && r1.id == 0x322u && r1.dlc == 48u && r1.fd == 1u &&
+              memcmp(r1.data, rd, 48u) == 0,
+              "ISR: 48-byte FD frame from FDCAN3 queued whole");
+    sil_check("CANFD", rx_ok && r2.bus == CAN_BUS_INV && r2.id == 0x181u && r2.dlc == 8u && r2.fd == 0u &&
+              memcmp(r2.data, rd, 8u) == 0,
+              "ISR: classic inverter frame unchanged");
+
+    /* --- Throughput and cost ------------------------------------------------- */
+    const double us_classic = sil_frame_us(8u, 0, 500u);
+    const double us_fd      = sil_frame_us(64u, 1, 2000u);
+    const double kbs_classic = 8.0 / us_classic * 1e3;
+    const double kbs_fd      = 64.0 / us_fd * 1e3;
+    snprintf(buf, sizeof(buf), "payload per bus time: classic 8 B %.0f us %.1f KB/s, FD 64 B %.0f us %.1f KB/s (x%.1f)",
+             us_classic, kbs_classic, us_fd, kbs_fd, kbs_fd / kbs_classic);
+    printf("[CANFD] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("CANFD", kbs_fd > 4.0 * kbs_classic, "64-byte FD frames carry over 4x the payload per bus second");
+
+    enum { CANFD_BENCH_N = 200000 };
+    volatile uint32_t sink = 0;
+    cm.dlc = 8u;
+    fdm.dlc = 64u;
+    double t0 = sil_now_ns();
+    for (uint32_t k = 0; k < CANFD_BENCH_N; k++) {
+        cm.data[0] = (uint8_t)k;
+        CAN_Pack(&cm, &qi);
+        CAN_Unpack(&qi, &back);
+        sink += back.data[0];
+    }
+    const double ns_classic = (sil_now_ns() - t0) / (double)CANFD_BENCH_N;
+    t0 = sil_now_ns();
+    for (uint32_t k = 0; k < CANFD_BENCH_N; k++) {
+        fdm.data[0] = (uint8_t)k;
+        CAN_Pack(&fdm, &qi);
+        CAN_Unpack(&qi, &back);
+        sink += back.data[0];
+    }
+    const double ns_fd = (sil_now_ns() - t0) / (double)CANFD_BENCH_N;
+    (void)sink;
+    snprintf(buf, sizeof(buf), "pack+unpack: classic %.1f ns, FD 64 B %.1f ns", ns_classic, ns_fd);
+    printf("[CANFD] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+
+    SIL_Results_Close();
+}
+
+/* Synthetic microsecond clock for the gateway: each read advances it by
+ * s_gw_tick, so the measured latency of a forward is a known number */
+static uint32_t s_gw_now;
+static uint32_t s_gw_tick;
+
+static uint32_t sil_gw_clock(void)
+{
+    const uint32_t t = s_gw_now;
+    s_gw_now += s_gw_tick;
+    return t;
+}
+
+/* One frame into the RX ISR of a bus */
+static void sil_gw_rx(FDCAN_HandleTypeDef *h, uint32_t id, uint8_t ide, uint32_t dlc_code,
+                      uint8_t fd, const uint8_t *data)
+{
+    FDCAN_RxHeaderTypeDef rh;
+    memset(&rh, 0, sizeof(rh));
+    rh.Identifier = id;
+    rh.IdType     = ide ? FDCAN_EXTENDED_ID : FDCAN_STANDARD_ID;
+    rh.DataLength = dlc_code;
+    rh.FDFormat   = fd ? FDCAN_FD_CAN : FDCAN_CLASSIC_CAN;
+    SIL_Fdcan_InjectRx(h, &rh, data);
+    Can_ISR_PushRxFifo0(h);
+}
+
+/**
+ * CAN gateway: routing table checks, ID / mask match, multi-destination
+ * forwarding, ID remap, rate limit, transit-only routes, drops on a full
+ * FIFO or an FD frame for a classic bus, latency accounting, then the
+ * cost per forwarded frame in the RX interrupt.
+ */
+static void test_gateway(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: CAN gateway (routing table)   ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("gateway_test.log");
+    SIL_Results_Log("GATEWAY", "STARTED", "routes, remap, rate limit, drops, latency");
+
+    extern FDCAN_HandleTypeDef hfdcan1, hfdcan2, hfdcan3;
+    char buf[200];
+    SIL_RTOS_Init();
+    (void)osMessageQueueReset(canRxQueueHandle);
+    s_gw_now  = 1000u;
+    s_gw_tick = 3u;
+    Gateway_SetClock(sil_gw_clock);
+
+    /* --- Table checks -------------------------------------------------------- */
+    const gw_route_t routes[] =
+    {
+        /* 0: inverter feedback block to both other buses */
+        { CAN_BUS_INV,  0u, GW_BUS(CAN_BUS_ACU) | GW_BUS(CAN_BUS_DASH), 0u, 0x180u, 0x7F8u, GW_NO_REMAP, 0u },
+        /* 1: ACU 0x200..0x20F moved to 0x500..0x50F on the dashboard, 100 Hz max */
+        { CAN_BUS_ACU,  0u, GW_BUS(CAN_BUS_DASH), 0u, 0x200u, 0x7F0u, 0x500u, 10000u },
+        /* 2: dashboard 0x300 to the inverter only, the ECU does not use it */
+        { CAN_BUS_DASH, 0u, GW_BUS(CAN_BUS_INV), GW_NO_LOCAL, 0x300u, 0x7FFu, GW_NO_REMAP, 0u },
+        /* 3: extended J1939-style PGN block from the inverter bus to the ACU */
+        { CAN_BUS_INV,  1u, GW_BUS(CAN_BUS_ACU), 0u, 0x18FF0000u, 0x1FFF0000u, GW_NO_REMAP, 0u },
+    };
+    const uint32_t nroutes = (uint32_t)(sizeof(routes) / sizeof(routes[0]));
+
+    gw_route_t bad = routes[0];
+    bad.dst = GW_BUS(CAN_BUS_INV);
+    int init_ok = Gateway_Init(&bad, 1u) == -1;
+    bad = routes[0];
+    bad.id = 0x181u;                            /* bit outside the mask */
+    init_ok = init_ok && Gateway_Init(&bad, 1u) == -1;
+    bad = routes[1];
+    bad.remap = 0x501u;                         /* remap outside the mask */
+    init_ok = init_ok && Gateway_Init(&bad, 1u) == -1;
+    init_ok = init_ok && Gateway_Init(routes, GW_MAX_ROUTES + 1u) == -1;
+    init_ok = init_ok && Gateway_Init(NULL, 0u) == 0 && Gateway_RouteCount() == GW_ROUTE_COUNT;
+    init_ok = init_ok && Gateway_Init(routes, nroutes) == 0 && Gateway_RouteCount() == nroutes;
+    bad = routes[0];
+    bad.id = CANMAP_REF(CANMAP_COUNT);          /* no such map key */
+    init_ok = init_ok && Gateway_Init(&bad, 1u) == -1;
+    sil_check("GATEWAY", init_ok, "malformed routes and oversized tables refused, default and test tables load");
+
+    uint8_t d[64];
+    for (uint32_t i = 0; i < 64u; i++) d[i] = (uint8_t)(0x40u + i);
+    FDCAN_HandleTypeDef *h1 = NULL, *h2 = NULL;
+    FDCAN_TxHeaderTypeDef t1, t2;
+    uint8_t o1[64], o2[64];
+    can_qitem_t qi;
+    can_msg_t q;
+    gw_stats_t st;
+
+    /* --- Default routes follow the CAN map ---------------------------------- */
+    canmap_ids_t ids = CANMAP_DEFAULT;
+    ids.id[CANMAP_S1_ACELERACION] = 0x111u;
+    int map_ok = CanMap_Init(&ids) == 0 && Gateway_Init(NULL, 0u) == 0;
+    uint32_t n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan3, 0x101u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    uint32_t n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan3, 0x111u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    uint32_t n2 = SIL_Fdcan_LastTx(&h1, &t1, NULL);
+    Gateway_GetStats(1u, &st);
+    sil_check("GATEWAY", map_ok && n1 == n0 && n2 == n0 + 1u && h1 == &hfdcan2 &&
+              t1.Identifier == 0x111u && st.forwarded == 1u,
+              "S1 moved to 0x111 in the map: dashboard 0x111 reaches the ACU, 0x101 no longer does");
+    (void)CanMap_Init(NULL);
+    (void)osMessageQueueReset(canRxQueueHandle);
+    (void)Gateway_Init(routes, nroutes);
+
+    /* --- Match and multi-destination ---------------------------------------- */
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan1, 0x183u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    int fw_ok = n1 == n0 + 2u && SIL_Fdcan_TxAt(n0 + 1u, &h1, &t1, o1) && SIL_Fdcan_TxAt(n0 + 2u, &h2, &t2, o2);
+    fw_ok = fw_ok && h1 == &hfdcan2 && h2 == &hfdcan3 && t1.Identifier == 0x183u && t2.Identifier == 0x183u &&
+            t1.DataLength == FDCAN_DLC_BYTES_8 && t2.FDFormat == FDCAN_CLASSIC_CAN &&
+            memcmp(o1, d, 8u) == 0 && memcmp(o2, d, 8u) == 0;
+    int local_ok = osMessageQueueGet(canRxQueueHandle, &qi, NULL, 0) == osOK;
+    CAN_Unpack(&qi, &q);
+    local_ok = local_ok && q.bus == CAN_BUS_INV && q.id == 0x183u && memcmp(q.data, d, 8u) == 0;
+    Gateway_GetStats(0u, &st);
+    sil_check("GATEWAY", fw_ok && st.matched == 1u && st.forwarded == 2u,
+              "inverter 0x183 (0x180/0x7F8) forwarded to ACU and dashboard, same header and data");
+    sil_check("GATEWAY", local_ok && osMessageQueueGetCount(canRxQueueHandle) == 0u,
+              "forwarded frame still reaches the application unchanged");
+
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan1, 0x190u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    sil_gw_rx(&hfdcan2, 0x183u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_check("GATEWAY", n1 == n0 && osMessageQueueGetCount(canRxQueueHandle) == 2u,
+              "no forward for an ID outside the mask or the same ID on another bus");
+    (void)osMessageQueueReset(canRxQueueHandle);
+
+    /* --- Remap and rate limit ----------------------------------------------- */
+    s_gw_now = 50000u;
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan2, 0x203u, 0u, FDCAN_DLC_BYTES_4, 0u, d);
+    n1 = SIL_Fdcan_LastTx(&h1, &t1, o1);
+    local_ok = osMessageQueueGet(canRxQueueHandle, &qi, NULL, 0) == osOK;
+    CAN_Unpack(&qi, &q);
+    sil_check("GATEWAY", n1 == n0 + 1u && h1 == &hfdcan3 && t1.Identifier == 0x503u &&
+              t1.DataLength == FDCAN_DLC_BYTES_4 && memcmp(o1, d, 4u) == 0 &&
+              local_ok && q.id == 0x203u && q.bus == CAN_BUS_ACU,
+              "ACU 0x203 remapped to 0x503 on the dashboard, local copy keeps 0x203");
+
+    s_gw_now = 55000u;
+    sil_gw_rx(&hfdcan2, 0x20Au, 0u, FDCAN_DLC_BYTES_4, 0u, d);
+    n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    s_gw_now = 60000u;
+    sil_gw_rx(&hfdcan2, 0x20Au, 0u, FDCAN_DLC_BYTES_4, 0u, d);
+    n2 = SIL_Fdcan_LastTx(&h1, &t1, NULL);
+    Gateway_GetStats(1u, &st);
+    sil_check("GATEWAY", n1 == n0 + 1u && n2 == n0 + 2u && t1.Identifier == 0x50Au &&
+              st.matched == 3u && st.forwarded == 2u && st.limited == 1u &&
+              osMessageQueueGetCount(canRxQueueHandle) == 2u,
+              "10 ms route: frame 5 ms after the last one limited, 10 ms after forwarded");
+    (void)osMessageQueueReset(canRxQueueHandle);
+
+    /* --- Transit only, extended IDs ----------------------------------------- */
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan3, 0x300u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    n1 = SIL_Fdcan_LastTx(&h1, &t1, NULL);
+    sil_check("GATEWAY", n1 == n0 + 1u && h1 == &hfdcan1 && t1.Identifier == 0x300u &&
+              osMessageQueueGetCount(canRxQueueHandle) == 0u,
+              "GW_NO_LOCAL route: dashboard 0x300 on the inverter bus, not queued locally");
+
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan1, 0x18FF1234u, 1u, FDCAN_DLC_BYTES_8, 0u, d);
+    n1 = SIL_Fdcan_LastTx(&h1, &t1, NULL);
+    sil_gw_rx(&hfdcan1, 0x18FE1234u, 1u, FDCAN_DLC_BYTES_8, 0u, d);
+    sil_gw_rx(&hfdcan1, 0x180u, 1u, FDCAN_DLC_BYTES_8, 0u, d);
+    n2 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_check("GATEWAY", n1 == n0 + 1u && h1 == &hfdcan2 && t1.IdType == FDCAN_EXTENDED_ID &&
+              t1.Identifier == 0x18FF1234u && n2 == n1,
+              "extended route matches on IDE too: 0x18FF1234 forwarded, 0x18FE1234 and ext 0x180 not");
+    (void)osMessageQueueReset(canRxQueueHandle);
+
+    /* --- Drops --------------------------------------------------------------- */
+    Gateway_ResetStats();
+    SIL_Fdcan_SetTxFull(&hfdcan2);
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan1, 0x181u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    n1 = SIL_Fdcan_LastTx(&h1, NULL, NULL);
+    SIL_Fdcan_SetTxFull(NULL);
+    Gateway_GetStats(0u, &st);
+    sil_check("GATEWAY", n1 == n0 + 1u && h1 == &hfdcan3 && st.forwarded == 1u && st.dropped == 1u,
+              "ACU TX FIFO full: that copy dropped and counted, dashboard copy still sent");
+
+    n0 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    sil_gw_rx(&hfdcan3, 0x300u, 0u, FDCAN_DLC_BYTES_64, 1u, d);
+    n1 = SIL_Fdcan_LastTx(NULL, NULL, NULL);
+    Gateway_GetStats(2u, &st);
+    sil_check("GATEWAY", n1 == n0 && st.matched == 1u && st.dropped == 1u && st.forwarded == 0u,
+              "64-byte FD frame for the classic inverter bus dropped, not truncated");
+    (void)osMessageQueueReset(canRxQueueHandle);
+
+    /* --- Latency ------------------------------------------------------------- */
+    Gateway_ResetStats();
+    s_gw_tick = 3u;
+    sil_gw_rx(&hfdcan1, 0x184u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    s_gw_tick = 7u;
+    sil_gw_rx(&hfdcan1, 0x184u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    s_gw_tick = 2u;
+    sil_gw_rx(&hfdcan1, 0x184u, 0u, FDCAN_DLC_BYTES_8, 0u, d);
+    Gateway_GetStats(0u, &st);
+    sil_check("GATEWAY", st.lat_last_us == 2u && st.lat_max_us == 7u && st.forwarded == 6u,
+              "latency per route: last and worst case kept");
+    (void)osMessageQueueReset(canRxQueueHandle);
+
+    /* --- Cost ---------------------------------------------------------------- */
+    enum { GW_BENCH_N = 200000 };
+    can_msg_t m;
+    memset(&m, 0, sizeof(m));
+    m.bus = CAN_BUS_INV;
+    m.dlc = 8u;
+    memcpy(m.data, d, 8u);
+    s_gw_tick = 0u;
+    volatile uint32_t sink = 0;
+    m.id = 0x185u;
+    double t0 = sil_now_ns();
+    for (uint32_t k = 0; k < GW_BENCH_N; k++) {
+        m.data[0] = (uint8_t)k;
+        sink += (uint32_t)Gateway_Forward(&m);
+    }
+    const double ns_fwd = (sil_now_ns() - t0) / (double)GW_BENCH_N;
+    m.id = 0x190u;
+    t0 = sil_now_ns();
+    for (uint32_t k = 0; k < GW_BENCH_N; k++) {
+        m.data[0] = (uint8_t)k;
+        sink += (uint32_t)Gateway_Forward(&m);
+    }
+    const double ns_miss = (sil_now_ns() - t0) / (double)GW_BENCH_N;
+    (void)sink;
+    Gateway_GetStats(0u, &st);
+    snprintf(buf, sizeof(buf), "forward to 2 buses %.1f ns/frame, no match %.1f ns/frame (%u routes on the bus)",
+             ns_fwd, ns_miss, 2u);
+    printf("[GATEWAY] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+    sil_check("GATEWAY", st.forwarded == 6u + 2u * GW_BENCH_N && m.id == 0x190u && m.bus == CAN_BUS_INV,
+              "every bench frame forwarded twice, message handed back unchanged");
+
+    /* Leave the tree as the other scenarios expect it: no routes */
+    (void)Gateway_Init(routes, 0u);
+    Gateway_SetClock(NULL);
+    SIL_Results_Close();
+}
+
+#if INV_BACKEND == INV_BACKEND_EPL
+/* The nine ePowerLabs state frames of drive 0, one set of values */
+static void sil_epl_stream(app_inputs_t *in, int16_t rpm, uint8_t alive)
+{
+    static const uint8_t f[EPL_TX_FRAMES][8] = {
+        { 0x05, 0x00, 0x00, 0x00, 0x10, 0x00 },   /* state 5, no error, warning 0x0010 */
+        { 0x00, 0x00, 0x2C, 0x01 },               /* rpm (set below), 30.0 Nm */
+        { 0xA0, 0x0F, 0x96, 0x00 },               /* 400.0 V, 15.0 A */
+        { 0xE8, 0x03 },                           /* 100.0 A */
+        { 0xBC, 0x02, 0x58, 0x02, 0x2C, 0x01 },   /* 70.0 / 60.0 / 30.0 degC */
+        { 0x10, 0x27, 0xF0, 0xD8 },               /* +1000.0 / -1000.0 Nm */
+        { 100 },                                  /* no derating */
+        { 0x00, 0x00 },                           /* no fault latched */
+        { 0 },                                    /* heartbeat (set below) */
+    };
+    const inv_node_t *nd = &Inv_GetLayout()->node[0];
+    for (uint32_t i = 0; i < EPL_TX_FRAMES; i++) {
+        can_msg_t m;
+        memset(&m, 0, sizeof(m));
+        m.bus = nd->bus;
+        m.id  = nd->fb_id + i;
+        m.dlc = 8u;
+        memcpy(m.data, f[i], 8u);
+        if (i == 1u) { m.data[0] = (uint8_t)((uint16_t)rpm & 0xFFu); m.data[1] = (uint8_t)((uint16_t)rpm >> 8); }
+        if (i == 8u) m.data[0] = alive;
+        CanRx_ParseAndUpdate(&m, in);
+    }
+}
+#endif
+
+/**
+ * ePowerLabs backend end to end (ecu08_sil_epl, INV_BACKEND_EPL): the nine
+ * TX_STATE frames through the CAN parser into the shared model, the drive
+ * streaming unasked (no READ frames), RX_SETPOINT_1/2 as the RUN command
+ * burst, link loss, then the decode cost of both backends per frame.
+ */
+static void test_epl(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: ePowerLabs inverter backend   ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+#if INV_BACKEND != INV_BACKEND_EPL
+    printf("[EPL] built with the BAMOCAR backend: run ecu08_sil_epl --test-epl\n");
+#else
+    SIL_Results_Init("epl_test.log");
+    SIL_Results_Log("EPL", "STARTED", "TX_STATE decode, setpoints, link, cost");
+
+    char buf[200];
+    SIL_RTOS_Init();
+    Inv_SetLayout(NULL);
+    const inv_node_t *nd = &Inv_GetLayout()->node[0];
+    sil_check("EPL", Inv_GetLayout() == &INV_LAYOUT_EPL && nd->fb_id == 0x460u && nd->cmd_id == 0x360u,
+              "default layout: one drive, TX_STATE from 0x460, RX_SETPOINT from 0x360");
+
+    /* --- Decode into the shared model --------------------------------------- */
+    app_inputs_t in;
+    memset(&in, 0, sizeof(in));
+    sil_epl_stream(&in, -1200, 7u);
+    const inv_fb_t *fb = &in.inv[0];
+    sil_check("EPL", fb->fld_seen == (uint16_t)((1u << INV_FB_COUNT) - 1u),
+              "all nine frames decoded: every field of the model reported");
+    sil_check("EPL", fb->rpm == -1200 && fb->torque_dnm == 300 && fb->dc_bus_v == 400 && fb->i_dc == 15 &&
+              fb->i_actual == 100 && fb->torque_max_dnm == 10000 && fb->torque_min_dnm == -10000,
+              "signed and tenths scaling: rpm, torque, DC link, currents, limits");
+    sil_check("EPL", fb->motor_temp == 70 && fb->igbt_temp == 60 && fb->air_temp == 30 &&
+              fb->state == 5u && fb->warning == 0x10u && fb->derate_pct == 100u && fb->alive == 7u,
+              "temperatures, state word, warnings, derating, heartbeat");
+    sil_check("EPL", in.inv_rpm == -1200 && in.inv_motor_temp == 70 && in.inv_state == 5u &&
+              (in.sig_seen & FRESH_BIT(SIG_INV_STATE)) && in.inv_dc_bus_voltage == 0u,
+              "legacy scalars and inv_state freshness from the model, ACU DC bus untouched");
+
+    /* --- Control: no requests, setpoints as the command burst --------------- */
+    control_out_t out;
+    Control_Init();
+    in.ok_precarga = 1; in.boton_arranque = 1; in.s_freno = 3500u;
+    Control_Step10ms(&in, &out);
+    uint32_t inv_frames = 0;
+    for (uint32_t j = 0; j < out.count; j++) if (out.msgs[j].bus == CAN_BUS_INV) inv_frames++;
+    sil_check("EPL", inv_frames == 0u && Control_GetInverterLink(0) == INV_LINK_SUBSCRIBED,
+              "boot: the drive streams unasked, nothing to arm");
+    /* The other ECUs answer their handshakes: no repeats from here on */
+    Fresh_Stamp(&in, SIG_ACK_TELEMETRIA, osKernelGetTickCount());
+    Fresh_Stamp(&in, SIG_ACK_CAJA_NEGRA, osKernelGetTickCount());
+    Fresh_Stamp(&in, SIG_ACK_PANTALLA, osKernelGetTickCount());
+    Control_Step10ms(&in, &out);
+    osDelay(2100);
+    in.boton_arranque = 0; in.s_freno = 0u;
+    in.s1_aceleracion = 3000u; in.s2_aceleracion = 2600u;
+    for (uint32_t i = 0; i < 60u; i++) {
+        sil_epl_stream(&in, 1500, (uint8_t)i);
+        Control_Step10ms(&in, &out);
+        osDelay(10);
+    }
+    epl_setpoint_t sp;
+    memset(&sp, 0, sizeof(sp));
+    int ok = out.count == EPL_CMD_FRAMES && out.msgs[0].burst == EPL_CMD_FRAMES &&
+             Epl_DecodeSetpoint(&out.msgs[0], nd, &sp) == 0 && Epl_DecodeSetpoint(&out.msgs[1], nd, &sp) == 1;
+    snprintf(buf, sizeof(buf), "RUN: RX_SETPOINT_1/2 in one burst, ctrl 0x%02x, torque %d.%d %% (cmd %d %%)",
+             sp.ctrl, sp.torque_pmil / 10, abs(sp.torque_pmil % 10), out.motor_pct[0]);
+    sil_check("EPL", ok && sp.ctrl == (EPL_CTRL_ENABLE | EPL_CTRL_RUN) && sp.mode == EPL_MODE_TORQUE &&
+              out.motor_pct[0] > 0 && sp.torque_pmil == out.motor_pct[0] * 10, buf);
+    sil_check("EPL", Control_GetInverterLink(0) == INV_LINK_ONLINE, "streaming drive: link online");
+
+    /* --- Drive goes silent: zero torque request ----------------------------- */
+    for (uint32_t i = 0; i < 15u; i++) {
+        Control_Step10ms(&in, &out);
+        osDelay(10);
+    }
+    memset(&sp, 0, sizeof(sp));
+    (void)Epl_DecodeSetpoint(&out.msgs[1], nd, &sp);
+    sil_check("EPL", Control_GetInverterLink(0) == INV_LINK_LOST && sp.torque_pmil == 0,
+              "silent drive: link lost, torque setpoint 0");
+
+    /* --- Setpoint table both ways -------------------------------------------- */
+    epl_setpoint_t a = { EPL_CTRL_ENABLE | EPL_CTRL_FAULT_RST, EPL_MODE_TORQUE, -455, 6500, -200,
+                         1800, -900, 250, -60, 280u, 600u };
+    epl_setpoint_t b;
+    memset(&b, 0, sizeof(b));
+    ok = 1;
+    for (uint8_t i = 0; i < EPL_SP_FRAMES; i++) {
+        can_msg_t m;
+        Epl_PackSetpoint(nd, &a, i, &m);
+        ok = ok && m.id == 0x360u + i && Epl_DecodeSetpoint(&m, nd, &b) == (int)i;
+    }
+    sil_check("EPL", ok && memcmp(&a, &b, sizeof(a)) == 0, "RX_SETPOINT_1..6 pack / decode round trip");
+
+    /* --- Cost per frame, both decoders --------------------------------------- */
+    enum { EPL_BENCH_N = 200000 };
+    volatile uint32_t sink = 0;
+    can_msg_t m;
+    memset(&m, 0, sizeof(m));
+    m.bus = CAN_BUS_INV;
+    m.dlc = 8u;
+    m.data[0] = 0xBC; m.data[1] = 0x02; m.data[2] = 0x58; m.data[3] = 0x02;
+    double t0 = sil_now_ns();
+    for (uint32_t k = 0; k < EPL_BENCH_N; k++) {
+        m.id = 0x460u + k % EPL_TX_FRAMES;
+        sink += Epl_Decode(&m, &in, k);
+    }
+    const double ns_epl = (sil_now_ns() - t0) / (double)EPL_BENCH_N;
+    m.data[0] = BAMO_REG_T_MOTOR;
+    t0 = sil_now_ns();
+    for (uint32_t k = 0; k < EPL_BENCH_N; k++) {
+        m.data[1] = (uint8_t)k;
+        sink += Bamo_Decode(&m, &in, 0u, k);
+    }
+    const double ns_bamo = (sil_now_ns() - t0) / (double)EPL_BENCH_N;
+    (void)sink;
+    snprintf(buf, sizeof(buf), "decode per frame: ePowerLabs %.1f ns (1-3 signals), BAMOCAR %.1f ns (1 register)",
+             ns_epl, ns_bamo);
+    printf("[EPL] %s\n", buf);
+    SIL_Results_LogEvent(0, "BENCH", buf);
+
+    Control_Init();
+    SIL_Results_Close();
+#endif
+}
+
+/**
+ * Time-triggered TX schedule: table checks, phases spread over the
+ * hyperperiod (worst slot vs. every frame released together), exact
+ * periods at the 1 ms tick, payloads, late ticks keeping the phase, a gap
+ * skipping lost periods instead of bursting, the per-tick room limit.
+ */
+static void sil_txs_pack(const txs_entry_t *e, const app_inputs_t *in, const control_out_t *out, uint8_t *d)
+{
+    (void)e; (void)in; (void)out;
+    d[0] = 0xA5u;
+}
+
+static void test_tx_sched(void)
+{
+    printf("\n");
+    printf("╔══════════════════════════════════════════╗\n");
+    printf("║  SIL TEST: time-triggered TX schedule    ║\n");
+    printf("╚══════════════════════════════════════════╝\n\n");
+
+    SIL_Results_Init("tx_sched_test.log");
+    SIL_Results_Log("TXS", "STARTED", "phases, periods, payloads, late ticks, gaps");
+
+    char buf[200];
+    SIL_RTOS_Init();
+    Inv_SetLayout(NULL);
+
+    /* --- Table checks -------------------------------------------------------- */
+    const txs_entry_t t_ok[] = {
+        { CAN_BUS_DASH, 0x700u, 1u, 0u, 10u, sil_txs_pack },
+        { CAN_BUS_DASH, 0x701u, 1u, 0u, 10u, sil_txs_pack },
+        { CAN_BUS_ACU,  0x700u, 1u, 0u, 25u, sil_txs_pack },
+    };
+    txs_entry_t bad[2] = { t_ok[0], t_ok[1] };
+    bad[1].id = 0x700u;                                   /* same bus and ID */
+    int init_ok = TxSched_Init(bad, 2u) == -1;
+    bad[1] = t_ok[1];
+    bad[1].period_ms = 0u;
+    init_ok = init_ok && TxSched_Init(bad, 2u) == -1;
+    bad[1].period_ms = 999u;                              /* LCM 9990 ms */
+    init_ok = init_ok && TxSched_Init(bad, 2u) == -1;
+    bad[1] = t_ok[1];
+    bad[1].dlc = 9u;
+    init_ok = init_ok && TxSched_Init(bad, 2u) == -1;
+    init_ok = init_ok && TxSched_Init(t_ok, TXS_MAX + 1u) == -1;
+    init_ok = init_ok && TxSched_Init(t_ok, 3u) == 0;
+    txs_stats_t ts;
+    TxSched_GetStats(&ts);
+    sil_check("TXS", init_ok && ts.hyper_ms == 50u && ts.max_load == 1u &&
+              TxSched_Phase(0) != TxSched_Phase(1),
+              "bad tables refused; two 10 ms and a 25 ms frame never share a slot");
+
+    /* --- Default table: spread ------------------------------------------------ */
+    sil_check("TXS", TxSched_Init(NULL, 0u) == 0, "default table loads");
+    TxSched_GetStats(&ts);
+    const uint32_t unspread = TXS_TABLE_COUNT;            /* all on phase 0 */
+    int n = snprintf(buf, sizeof(buf), "%lu frames, hyperperiod %lu ms, phases",
+                     (unsigned long)TXS_TABLE_COUNT, (unsigned long)ts.hyper_ms);
+    for (uint32_t i = 0; i < TXS_TABLE_COUNT && n < (int)sizeof(buf) - 16; i++) {
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n, " 0x%03lx@%lu",
+                      (unsigned long)CanMap_Resolve(TXS_TABLE[i].id), (unsigned long)TxSched_Phase(i));
+    }
+    printf("[TXS] %s\n", buf);
+    SIL_Results_LogEvent(0, "PHASES", buf);
+    snprintf(buf, sizeof(buf), "worst slot: %lu frame(s) spread, %lu if released together",
+             (unsigned long)ts.max_load, (unsigned long)unspread);
+    sil_check("TXS", ts.max_load == 1u, buf);
+
+    /* --- 2 s at the 1 ms tick --------------------------------------------------- */
+    app_inputs_t in;
+    control_out_t out;
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+    Inv_FbSet(&in, 0u, INV_FB_RPM, 4321, 0u);
+    Inv_FbSet(&in, 0u, INV_FB_T_MOTOR, 71, 0u);
+    out.torque_pct = -12;
+
+    enum { TXS_RUN_MS = 2000 };
+    can_msg_t m[TXS_TICK_MAX];
+    uint32_t cnt[TXS_MAX] = { 0u }, last[TXS_MAX] = { 0u }, bad_gap = 0, worst_tick = 0;
+    int pay_ok = 1;
+    const uint32_t t0 = 10000u;
+    for (uint32_t t = t0; t < t0 + TXS_RUN_MS; t++) {
+        const uint32_t k = TxSched_Tick(t, &in, &out, m, TXS_TICK_MAX);
+        if (k > worst_tick) worst_tick = k;
+        for (uint32_t j = 0; j < k; j++) {
+            for (uint32_t i = 0; i < TXS_TABLE_COUNT; i++) {
+                if (m[j].id != CanMap_Resolve(TXS_TABLE[i].id)) continue;
+                if (cnt[i] && t - last[i] != TXS_TABLE[i].period_ms) bad_gap++;
+                cnt[i]++;
+                last[i] = t;
+            }
+            if (m[j].id == 0x304u) pay_ok = pay_ok && m[j].bus == CAN_BUS_DASH && m[j].dlc == 8u &&
+                                            m[j].data[0] == 0xE1u && m[j].data[1] == 0x10u && m[j].data[2] == 0u;
+            if (m[j].id == 0x301u) pay_ok = pay_ok && m[j].data[0] == 71u;
+            if (m[j].id == 0x106u) pay_ok = pay_ok && m[j].dlc == 2u && (int16_t)(m[j].data[0] | (m[j].data[1] << 8)) == -12;
+            if (m[j].id == 0x080u) pay_ok = pay_ok && m[j].dlc == 1u && m[j].data[0] == 0u;
+        }
+    }
+    uint32_t cnt_ok = 1;
+    for (uint32_t i = 0; i < TXS_TABLE_COUNT; i++) cnt_ok = cnt_ok && cnt[i] == TXS_RUN_MS / TXS_TABLE[i].period_ms;
+    TxSched_GetStats(&ts);
+    snprintf(buf, sizeof(buf), "1 ms tick: %lu frames, at most %lu per tick, %lu off-period intervals",
+             (unsigned long)ts.sent, (unsigned long)worst_tick, (unsigned long)bad_gap);
+    sil_check("TXS", cnt_ok && worst_tick == 1u && bad_gap == 0u && ts.late == 0u, buf);
+    sil_check("TXS", pay_ok, "payloads: drive 0 rpm / temperature, torque request, ready-to-drive");
+
+    /* --- Ticks every 3 ms: late but on phase, nothing lost ----------------------- */
+    (void)TxSched_Init(NULL, 0u);
+    memset(cnt, 0, sizeof(cnt));
+    for (uint32_t t = t0; t < t0 + TXS_RUN_MS; t += 3u) {
+        const uint32_t k = TxSched_Tick(t, &in, &out, m, TXS_TICK_MAX);
+        for (uint32_t j = 0; j < k; j++) {
+            for (uint32_t i = 0; i < TXS_TABLE_COUNT; i++) if (m[j].id == CanMap_Resolve(TXS_TABLE[i].id)) cnt[i]++;
+        }
+    }
+    TxSched_GetStats(&ts);
+    cnt_ok = 1;
+    for (uint32_t i = 0; i < TXS_TABLE_COUNT; i++) {
+        const uint32_t want = TXS_RUN_MS / TXS_TABLE[i].period_ms;
+        cnt_ok = cnt_ok && cnt[i] + 1u >= want && cnt[i] <= want;
+    }
+    snprintf(buf, sizeof(buf), "3 ms ticks: %lu late, %lu skipped, every period still sent",
+             (unsigned long)ts.late, (unsigned long)ts.skipped);
+    sil_check("TXS", cnt_ok && ts.late > 0u && ts.skipped == 0u, buf);
+
+    /* --- 100 ms gap: lost periods skipped, one frame per ID, rest next tick ---- */
+    (void)TxSched_Init(NULL, 0u);
+    for (uint32_t t = t0; t < t0 + 200u; t++) (void)TxSched_Tick(t, &in, &out, m, TXS_TICK_MAX);
+    TxSched_GetStats(&ts);
+    const uint32_t sent0 = ts.sent;
+    uint32_t k1 = TxSched_Tick(t0 + 300u, &in, &out, m, TXS_TICK_MAX);
+    uint32_t k2 = TxSched_Tick(t0 + 301u, &in, &out, m, TXS_TICK_MAX);
+    TxSched_GetStats(&ts);
+    snprintf(buf, sizeof(buf), "100 ms gap: %lu + %lu frames after it, %lu releases skipped",
+             (unsigned long)k1, (unsigned long)k2, (unsigned long)ts.skipped);
+    sil_check("TXS", k1 == TXS_TICK_MAX && ts.sent - sent0 <= TXS_TABLE_COUNT && ts.skipped > 0u, buf);
+    int phase_ok = 1;
+    for (uint32_t t = t0 + 302u; t < t0 + 600u; t++) {
+        const uint32_t k = TxSched_Tick(t, &in, &out, m, TXS_TICK_MAX);
+        for (uint32_t j = 0; j < k; j++) {
+            for (uint32_t i = 0; i < TXS_TABLE_COUNT; i++) {
+                if (m[j].id == CanMap_Resolve(TXS_TABLE[i].id))
+                    phase_ok = phase_ok && (t - t0) % TXS_TABLE[i].period_ms == TxSched_Phase(i);
+            }
+        }
+    }
+    sil_check("TXS", phase_ok, "back on the original phases after the gap: no catch-up burst");
+
+    (void)TxSched_Init(NULL, 0u);
+    SIL_Results_Close();
+}
+
 /**
  * Print usage
  */
@@ -462,6 +2857,21 @@ static void print_usage(const char *prog)
     printf("  --test-error-temp        High temperature fault test\n");
     printf("  --test-safety-brake      EV 2.3 brake+throttle test\n");
     printf("  --test-dynamic-states    Dynamic state transition test\n");
+    printf("  --test-power-limit       80 kW power limit (closed loop plant)\n");
+    printf("  --test-thermal           Thermal derating (closed loop plant)\n");
+    printf("  --test-torque-step       Torque slew/jerk step response\n");
+    printf("  --test-regen             Regenerative braking (closed loop plant)\n");
+    printf("  --test-launch            Launch control 75 m run (closed loop plant)\n");
+    printf("  --test-traction          Traction control 75 m run (closed loop plant)\n");
+    printf("  --test-estimator         Vehicle state estimator accuracy + benchmark\n");
+    printf("  --test-parallel          Independent control contexts (threads, checkpoint)\n");
+    printf("  --test-batch             Batch SoA torque map vs scalar (bit-exact + timing)\n");
+    printf("  --test-xcp               XCP-on-CAN slave over a socket (calibration + DAQ)\n");
+    printf("  --test-uds               UDS over ISO-TP: host tester, simulated 500 kbit/s bus\n");
+    printf("  --test-canfd             CAN-FD: DLC tables, 64-byte queue items, TX/RX mapping\n");
+    printf("  --test-gateway           CAN gateway: routes, remap, rate limit, drops, latency\n");
+    printf("  --test-epl               ePowerLabs backend end to end (ecu08_sil_epl)\n");
+    printf("  --test-tx-sched          time-triggered TX schedule: phases, periods, gaps\n");
     printf("  --test-integration       Suites S1-S10 (test_integration.c)\n");
     printf("                           → genera results/integration_test.log\n");
     printf("  --test-all               Run ALL tests (incluyendo S1-S10)\n");
@@ -497,6 +2907,36 @@ int main(int argc, char *argv[])
         test_safety_brake_throttle();
     } else if (strcmp(test_name, "--test-dynamic-states") == 0) {
         test_dynamic_state_transitions();
+    } else if (strcmp(test_name, "--test-power-limit") == 0) {
+        test_power_limit();
+    } else if (strcmp(test_name, "--test-thermal") == 0) {
+        test_thermal_derate();
+    } else if (strcmp(test_name, "--test-torque-step") == 0) {
+        test_torque_step();
+    } else if (strcmp(test_name, "--test-regen") == 0) {
+        test_regen();
+    } else if (strcmp(test_name, "--test-launch") == 0) {
+        test_launch();
+    } else if (strcmp(test_name, "--test-traction") == 0) {
+        test_traction();
+    } else if (strcmp(test_name, "--test-estimator") == 0) {
+        test_estimator();
+    } else if (strcmp(test_name, "--test-parallel") == 0) {
+        test_parallel_ctx();
+    } else if (strcmp(test_name, "--test-batch") == 0) {
+        test_batch_torque();
+    } else if (strcmp(test_name, "--test-xcp") == 0) {
+        test_xcp();
+    } else if (strcmp(test_name, "--test-uds") == 0) {
+        test_uds();
+    } else if (strcmp(test_name, "--test-canfd") == 0) {
+        test_canfd();
+    } else if (strcmp(test_name, "--test-gateway") == 0) {
+        test_gateway();
+    } else if (strcmp(test_name, "--test-epl") == 0) {
+        test_epl();
+    } else if (strcmp(test_name, "--test-tx-sched") == 0) {
+        test_tx_sched();
     } else if (strcmp(test_name, "--test-integration") == 0) {
         test_integration_suite();
     } else if (strcmp(test_name, "--test-all") == 0) {
@@ -507,6 +2947,19 @@ int main(int argc, char *argv[])
         test_error_high_temperature();
         test_safety_brake_throttle();
         test_dynamic_state_transitions();
+        test_power_limit();
+        test_thermal_derate();
+        test_torque_step();
+        test_regen();
+        test_launch();
+        test_traction();
+        test_estimator();
+        test_parallel_ctx();
+        test_batch_torque();
+        test_xcp();
+        test_uds();
+        test_canfd();
+        test_gateway();
         test_integration_suite();   /* S1-S10 al final, genera integration_test.log */
     } else if (strcmp(test_name, "--help") == 0) {
         print_usage(argv[0]);
@@ -517,7 +2970,7 @@ int main(int argc, char *argv[])
     }
     
     printf("\n[SIL] Test execution completed\n\n");
-    return 0;
+    return sil_failures ? 1 : 0;
 }
 
 /* ===== Stub for FreeRTOS panic ===== */
@@ -0,0 +1,148 @@
+/**
+ * sil_plant.c
+ * Longitudinal vehicle + powertrain plant (see sil_plant.h)
+ */
+
+#include "sil_plant.h"
+#include "inv_backend.h"
+#include <math.h>
+#include <string.h>
+
+#define RAD_S_TO_RPM 9.5492966f   /* 60/(2*pi) */
+
+void SIL_Plant_Init(sil_plant_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->t_max_nm = 230.0f;     /* EMRAX 228 peak                            */
+    p->eff      = 0.90f;      /* deliberately below the controller's 0.93 */
+    p->v_ocv    = 560.0f;
+    p->r_int    = 0.30f;
+    p->gear     = 3.5f;
+    p->r_wheel  = 0.23f;
+    p->mass     = 300.0f;
+    p->c_drag   = 0.9f;
+    p->f_roll   = 60.0f;
+    p->mu_peak   = 0.0f;
+    p->fz_driven = 1650.0f;   /* 56 % rear                                */
+    p->j_wheel   = 1.2f;      /* wheels + motor rotor reflected (x gear^2)*/
+    p->v_dc     = p->v_ocv;
+
+    /* Thermal: runs hotter than the controller's model on purpose */
+    p->t_cool_c   = 40.0f;
+    p->mot_k_i2   = 1.3e-5f;   /* per A^2 of phase current (peak)         */
+    p->mot_k_rpm  = 6.0e-6f;
+    p->mot_tau_s  = 240.0f;
+    p->igbt_k_i2  = 1.4e-5f;
+    p->igbt_tau_s = 18.0f;
+    p->t_motor_c  = p->t_cool_c;
+    p->t_igbt_c   = p->t_cool_c;
+
+    p->kt_nm_per_a = 0.68f;   /* 230 Nm at 340 A peak                     */
+    p->pf          = 0.90f;
+}
+
+float SIL_Plant_MotorRpm(const sil_plant_t *p)
+{
+    if (p->mu_peak > 0.0f) return p->w_wheel * p->gear * RAD_S_TO_RPM;
+    return p->v_mps / p->r_wheel * p->gear * RAD_S_TO_RPM;
+}
+
+float SIL_Plant_Slip(const sil_plant_t *p)
+{
+    if (p->mu_peak <= 0.0f) return 0.0f;
+    /* Low-speed floor keeps slip finite at standstill (tyre relaxation) */
+    float v = (p->v_mps > 3.0f) ? p->v_mps : 3.0f;
+    return (p->w_wheel * p->r_wheel - p->v_mps) / v;
+}
+
+/* Magic Formula, B = 12, C = 1.5: peak near 12 % slip, ~30 % less grip
+ * at full wheelspin */
+static float tyre_force(const sil_plant_t *p, float slip)
+{
+    return p->fz_driven * p->mu_peak * sinf(1.5f * atanf(12.0f * slip));
+}
+
+void SIL_Plant_Step(sil_plant_t *p, int16_t torque_pct, float dt_s)
+{
+    float w_m = SIL_Plant_MotorRpm(p) / RAD_S_TO_RPM;
+    const float v0 = p->v_mps;
+
+    p->t_nm = (float)torque_pct * 0.01f * p->t_max_nm;
+
+    /* Electrical power: losses add when driving, subtract when regenerating */
+    float p_mech = p->t_nm * w_m;
+    p->p_elec_w = (p_mech >= 0.0f) ? (p_mech / p->eff) : (p_mech * p->eff);
+
+    /* Accumulator: P = (Vocv - R*I) * I  →  I = (Vocv - sqrt(Vocv^2 - 4RP)) / 2R */
+    float disc = p->v_ocv * p->v_ocv - 4.0f * p->r_int * p->p_elec_w;
+    if (disc < 0.0f) disc = 0.0f;
+    p->i_dc = (p->v_ocv - sqrtf(disc)) / (2.0f * p->r_int);
+    p->v_dc = p->v_ocv - p->r_int * p->i_dc;
+
+    /* Phase current: torque current below base speed; above it the drive
+     * is voltage limited (sqrt(3)/2 * V_dc amplitude at power factor pf)
+     * and needs more current for the same power */
+    float i_tq = fabsf(p->t_nm) / p->kt_nm_per_a;
+    float i_fw = fabsf(p->p_elec_w) / (0.8660254f * p->v_dc * p->pf);
+    p->i_ph = copysignf((i_tq > i_fw) ? i_tq : i_fw, p->t_nm);
+
+    /* Temperatures: phase-current I^2 (+ speed) heating against the coolant */
+    float i2  = p->i_ph * p->i_ph;
+    float rpm = SIL_Plant_MotorRpm(p);
+    p->t_motor_c += (p->mot_k_i2 * i2 + p->mot_k_rpm * rpm
+                     - (p->t_motor_c - p->t_cool_c) / p->mot_tau_s) * dt_s;
+    p->t_igbt_c  += (p->igbt_k_i2 * i2
+                     - (p->t_igbt_c - p->t_cool_c) / p->igbt_tau_s) * dt_s;
+
+    /* Vehicle */
+    float f = p->t_nm * p->gear / p->r_wheel - p->c_drag * p->v_mps * p->v_mps;
+    if (p->v_mps > 0.0f) f -= p->f_roll;
+    if (p->mu_peak <= 0.0f)
+    {
+        p->v_mps += f / p->mass * dt_s;
+        if (p->v_mps < 0.0f) p->v_mps = 0.0f;
+        p->x_m += p->v_mps * dt_s;
+        p->a_mps2 = (p->v_mps - v0) / dt_s;
+        return;
+    }
+
+    /* Slip model: stiff at low speed, integrate in 0.1 ms sub-steps */
+    const uint32_t n = 10u;
+    const float h = dt_s / (float)n;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        float fx = tyre_force(p, SIL_Plant_Slip(p));
+        float fr = p->c_drag * p->v_mps * p->v_mps + ((p->v_mps > 0.0f) ? p->f_roll : 0.0f);
+        p->w_wheel += (p->t_nm * p->gear - fx * p->r_wheel) / p->j_wheel * h;
+        if (p->w_wheel < 0.0f) p->w_wheel = 0.0f;
+        p->v_mps += (fx - fr) / p->mass * h;
+        if (p->v_mps < 0.0f) p->v_mps = 0.0f;
+        p->x_m += p->v_mps * h;
+    }
+    p->a_mps2 = (p->v_mps - v0) / dt_s;
+}
+
+void SIL_Plant_Publish(const sil_plant_t *p, app_inputs_t *in)
+{
+    in->inv_rpm            = (int16_t)SIL_Plant_MotorRpm(p);
+    in->inv_dc_bus_voltage = (uint16_t)(p->v_dc + 0.5f);
+    /* Currents as the drive reports them: phase (BAMOCAR 0x5F, EPL
+     * TX_STATE_4), DC link only on the ePowerLabs drive (TX_STATE_3) */
+    in->inv_i_actual       = (int16_t)lroundf(p->i_ph);
+    in->inv[0].i_actual    = in->inv_i_actual;
+    in->inv[0].fld_seen   |= (uint16_t)(1u << INV_FB_I_ACTUAL);
+#if INV_BACKEND == INV_BACKEND_EPL
+    in->inv[0].i_dc        = (int16_t)lroundf(p->i_dc);
+    in->inv[0].fld_seen   |= (uint16_t)(1u << INV_FB_I_DC);
+#endif
+    in->inv_motor_temp     = (int16_t)p->t_motor_c;
+    in->inv_igbt_temp      = (int16_t)p->t_igbt_c;
+    in->inv_air_temp       = (int16_t)p->t_cool_c;
+    /* Undriven front wheels roll at vehicle speed */
+    in->wheel_fl_cmps      = (uint16_t)(p->v_mps * 100.0f + 0.5f);
+    in->wheel_fr_cmps      = in->wheel_fl_cmps;
+    in->wheel_ok           = 1;
+    /* IMU x forward; gyro idle on a straight line */
+    in->imu_acc_mg[0]      = (int16_t)lroundf(p->a_mps2 / 9.80665f * 1000.0f + p->imu_bias_mg);
+    in->imu_ok             = 1;
+}
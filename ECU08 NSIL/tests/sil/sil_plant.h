@@ -0,0 +1,69 @@
+/**
+ * sil_plant.h
+ * Longitudinal vehicle + powertrain plant for closed-loop SIL scenarios
+ *
+ * Motor torque → vehicle speed → motor rpm, accumulator modelled as an
+ * open-circuit voltage behind an internal resistance. Feeds app_inputs_t the
+ * same way the inverter/AMS frames would (rpm, DC voltage, phase current,
+ * DC current where the drive reports it, motor and IGBT temperatures).
+ */
+
+#ifndef SIL_PLANT_H
+#define SIL_PLANT_H
+
+#include <stdint.h>
+#include "app_state.h"
+
+typedef struct {
+    /* Parameters */
+    float t_max_nm;       /* torque at torque_pct = 100     */
+    float eff;            /* motor + inverter efficiency     */
+    float v_ocv;          /* accumulator open-circuit [V]    */
+    float r_int;          /* accumulator resistance [ohm]    */
+    float gear;           /* motor:wheel ratio               */
+    float r_wheel;        /* wheel radius [m]                */
+    float mass;           /* vehicle + driver [kg]           */
+    float c_drag;         /* 0.5*rho*Cd*A [N/(m/s)^2]        */
+    float f_roll;         /* rolling resistance [N]          */
+    float mu_peak;        /* tyre peak friction, 0 = no slip */
+    float fz_driven;      /* driven axle normal load [N]     */
+    float j_wheel;        /* driven axle inertia at wheel    */
+    float t_cool_c;       /* coolant temperature [degC]      */
+    float mot_k_i2;       /* motor heating per A^2 [degC/s]  */
+    float mot_k_rpm;      /* motor iron loss per rpm         */
+    float mot_tau_s;      /* motor thermal time constant     */
+    float igbt_k_i2;      /* IGBT heating per A^2            */
+    float igbt_tau_s;     /* IGBT thermal time constant      */
+    float imu_bias_mg;    /* accelerometer x offset          */
+    float kt_nm_per_a;    /* torque per A of phase current   */
+    float pf;             /* power factor in field weakening */
+
+    /* State */
+    float v_mps;          /* vehicle speed                   */
+    float a_mps2;         /* vehicle acceleration (last step)*/
+    float w_wheel;        /* driven wheel speed [rad/s]      */
+    float x_m;            /* distance travelled              */
+    float t_nm;           /* applied motor torque            */
+    float p_elec_w;       /* DC power drawn                  */
+    float v_dc;           /* DC bus voltage                  */
+    float i_dc;           /* DC current                      */
+    float i_ph;           /* phase current (peak amplitude)  */
+    float t_motor_c;      /* winding temperature             */
+    float t_igbt_c;       /* IGBT junction temperature       */
+} sil_plant_t;
+
+/* Init leaves the slip model off (rigid tyre); set mu_peak > 0 to enable
+ * it: driven wheel speed becomes a state and tyre force follows a
+ * simplified Magic Formula on longitudinal slip. */
+void  SIL_Plant_Init(sil_plant_t *p);
+void  SIL_Plant_Step(sil_plant_t *p, int16_t torque_pct, float dt_s);
+float SIL_Plant_MotorRpm(const sil_plant_t *p);
+float SIL_Plant_Slip(const sil_plant_t *p);
+
+/* Writes rpm, DC bus voltage, current, temperatures, front wheel speeds
+ * and IMU longitudinal acceleration into the inputs. Drive currents are
+ * those the selected backend decodes: phase current for the BAMOCAR,
+ * phase and DC current for the ePowerLabs drive (inv[0], fld_seen). */
+void  SIL_Plant_Publish(const sil_plant_t *p, app_inputs_t *in);
+
+#endif /* SIL_PLANT_H */
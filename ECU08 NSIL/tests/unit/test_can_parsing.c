@@ -185,14 +185,14 @@ TEST(CAN_Packing, roundtrip_pack_unpack)
         .ide = 0,
         .data = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08}
     };
-    can_qitem16_t packed;
+    can_qitem_t packed;
     
     /* Act: Pack */
-    CAN_Pack16(&original, &packed);
+    CAN_Pack(&original, &packed);
     
     /* Act: Unpack */
     can_msg_t unpacked;
-    CAN_Unpack16(&packed, &unpacked);
+    CAN_Unpack(&packed, &unpacked);
     
     /* Assert */
     TEST_ASSERT_EQUAL_INT(original.id, unpacked.id);
@@ -215,14 +215,14 @@ TEST(CAN_Packing, roundtrip_dlc_4)
         .ide = 0,
         .data = {0xAA, 0xBB, 0xCC, 0xDD, 0x00, 0x00, 0x00, 0x00}
     };
-    can_qitem16_t packed;
+    can_qitem_t packed;
     
     /* Act: Pack */
-    CAN_Pack16(&original, &packed);
+    CAN_Pack(&original, &packed);
     
     /* Act: Unpack */
     can_msg_t unpacked;
-    CAN_Unpack16(&packed, &unpacked);
+    CAN_Unpack(&packed, &unpacked);
     
     /* Assert */
     TEST_ASSERT_EQUAL_INT(4, unpacked.dlc);
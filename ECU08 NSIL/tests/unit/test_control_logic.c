@@ -137,8 +137,13 @@ TEST(ControlLogic, control_step_boot_to_precharge)
     /* Act */
     Control_Step10ms(&in, &out);
     
-    /* Assert: en BOOT sin precarga, no hay TX messages */
-    TEST_ASSERT_EQUAL_INT(0, out.count);
+    /* Assert: en BOOT sin precarga no hay torque; sólo se arman las
+     * suscripciones BAMOCAR (READ 0x3D) y salen los ok de handshake de
+     * telemetría, caja negra y pantalla */
+    TEST_ASSERT_EQUAL_INT(0, out.torque_pct);
+    TEST_ASSERT_EQUAL_INT(BAMO_REG_COUNT + 3, out.count);
+    TEST_ASSERT_EQUAL_HEX8(0x3D, out.msgs[0].data[0]);
+    TEST_ASSERT_EQUAL_HEX32(0xA0, out.msgs[BAMO_REG_COUNT].id);
 }
 
 /**